@@ -28,11 +28,18 @@
 #define _CONFIGURATION_
 
 #include <HBSocket.h>
+#include <HBThread.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
 #include <string>
 #include "BuildConfigHomer.h"
 
 #include <QSettings>
 #include <QString>
+#include <QHash>
+#include <QVariant>
+#include <QSharedPointer>
+#include <list>
 
 namespace Homer { namespace Gui {
 
@@ -44,6 +51,9 @@ namespace Homer { namespace Gui {
 // debug GUI timer?
 //#define DEBUG_TIMING
 
+// de/activates debugging of the asynchronous write-back of settings
+//#define DEBUG_CONFIGURATION_WRITE_BACK
+
 // version string which is checked/used in the whole application
 //#define HOMER_VERSION -> is now defined automatically via build system
 #define RELEASE_VERSION_STRING          "Beta "HOMER_VERSION
@@ -69,6 +79,9 @@ namespace Homer { namespace Gui {
 // size of the pre-buffer during a live conference
 #define CONF_AV_DEFAULT_CONFERENCE_PRE_BUFFER					          0.34 // seconds  - 1/24s time per frames * 8 frames =0.33333
 
+// delay before changed settings are written back to QSettings, further changes within this time are batched
+#define CONF_WRITE_BACK_DELAY                                             500 // ms
+
 ///////////////////////////////////////////////////////////////////////////////
 #ifdef USE_NATIVE_DIALOGS
 	#define CONF_NATIVE_DIALOGS			(QFileDialog::DontResolveSymlinks)
@@ -78,7 +91,174 @@ namespace Homer { namespace Gui {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class Configuration
+// typed copy of all settings, replaced as a whole on every change and never modified after it was published,
+// string settings with a default which depends on the runtime environment are null if they were never set
+struct ConfigurationValues
+{
+    unsigned int                        Revision;
+
+    /* Broadcast */
+    bool                                BroadcastAudioPlaybackMuted;
+
+    /* Capturing */
+    bool                                LocalVideoSourceHFlip;
+    QString                             LocalAudioSource;
+    QString                             LocalVideoSource;
+    bool                                LocalVideoSourceVFlip;
+
+    /* ConfigurationDialog */
+    int                                 ConfigurationSelection;
+
+    /* Global */
+    bool                                AutoUpdateCheck;
+    QString                             ConferenceAvailability;
+    QString                             ContactFile;
+    QString                             DataDirectory;
+    bool                                FeatureAutoLogging;
+    bool                                FeatureConferencing;
+    QString                             Language;
+    int                                 MainWindowHeight;
+    bool                                MainWindowMinimized;
+    int                                 MainWindowPositionX;
+    int                                 MainWindowPositionY;
+    int                                 MainWindowWidth;
+    int                                 MediaMemoryBudget;
+    bool                                ParticipantWidgetsCloseImmediately;
+    bool                                ParticipantWidgetsSeparation;
+    bool                                PreventScreensaverInFullscreenMode;
+    bool                                SmoothVideoPresentation;
+    bool                                VisibilityBroadcastAudio;
+    bool                                VisibilityBroadcastMessageWidget;
+    bool                                VisibilityBroadcastVideo;
+    bool                                VisibilityBroadcastWidget;
+    bool                                VisibilityContactsWidget;
+    bool                                VisibilityDataStreamsWidget;
+    bool                                VisibilityErrorsWidget;
+    bool                                VisibilityFileTransfersWidget;
+    bool                                VisibilityMenuBar;
+    bool                                VisibilityNetworkSimulationWidget;
+    bool                                VisibilityNetworkStreamsWidget;
+    bool                                VisibilityPlaylistWidgetAudio;
+    bool                                VisibilityPlaylistWidgetMovie;
+    bool                                VisibilityPlaylistWidgetVideo;
+    bool                                VisibilityStatusBar;
+    bool                                VisibilityThreadsWidget;
+    bool                                VisibilityToolBarMediaSources;
+    bool                                VisibilityToolBarOnlineStatus;
+
+    /* Network */
+    QString                             AppDataNAPIImpl;
+    enum Homer::Base::TransportType     AppDataTransportType;
+    bool                                SipContactsProbing;
+    bool                                MediaBundlingActivation;
+    bool                                MediaLoopbackActivation;
+    bool                                NatSupportActivation;
+    int                                 SipInfrastructureMode;
+    QString                             SipListenerAddress;
+    int                                 SipStartPort;
+    enum Homer::Base::TransportType     SipListenerTransport;
+    QString                             SipPassword;
+    QString                             SipServer;
+    int                                 SipServerPort;
+    QString                             SipUserName;
+    QString                             StunServer;
+    bool                                SipUnknownContactsProbing;
+    int                                 VideoAudioStartPort;
+
+    /* Notification */
+    bool                                CallAcknowledgeSound;
+    QString                             CallAcknowledgeSoundFile;
+    bool                                CallAcknowledgeSystray;
+    bool                                CallDenySound;
+    QString                             CallDenySoundFile;
+    bool                                CallDenySystray;
+    bool                                CallHangupSound;
+    QString                             CallHangupSoundFile;
+    bool                                CallHangupSystray;
+    bool                                CallSound;
+    QString                             CallSoundFile;
+    bool                                CallSystray;
+    bool                                ErrorSound;
+    QString                             ErrorSoundFile;
+    bool                                ErrorSystray;
+    bool                                ImSound;
+    QString                             ImSoundFile;
+    bool                                ImSystray;
+    bool                                RegistrationFailedSound;
+    QString                             RegistrationFailedSoundFile;
+    bool                                RegistrationFailedSystray;
+    bool                                RegistrationSuccessfulSound;
+    QString                             RegistrationSuccessfulSoundFile;
+    bool                                RegistrationSuccessfulSystray;
+    bool                                StartSound;
+    QString                             StartSoundFile;
+    bool                                StartSystray;
+    bool                                StopSound;
+    QString                             StopSoundFile;
+    bool                                StopSystray;
+
+    /* Playback */
+    bool                                AVSyncDuringConference;
+    QString                             LocalAudioSink;
+    double                              PreBufferTimeDuringConference;
+
+    /* PreviewDialog */
+    bool                                PreviewPreBufferingActivation;
+    int                                 PreviewSelection;
+    bool                                PreviewSelectionAudio;
+    bool                                PreviewSelectionVideo;
+
+    /* Streaming */
+    bool                                AudioActivation;
+    bool                                AudioActivationPushToTalk;
+    int                                 AudioBitRate;
+    QString                             AudioCodec;
+    int                                 AudioMaxPacketSize;
+    QString                             AudioStreamingNAPIImpl;
+    bool                                AudioRtp;
+    bool                                AudioSkipSilence;
+    int                                 AudioSkipSilenceThreshold;
+    enum Homer::Base::TransportType     AudioTransportType;
+    int                                 VideoFps;
+    bool                                VideoActivation;
+    int                                 VideoBitRate;
+    QString                             VideoCodec;
+    bool                                VideoIntraRefresh;
+    int                                 VideoMaxPacketSize;
+    QString                             VideoStreamingNAPIImpl;
+    int                                 VideoQuality;
+    bool                                VideoRealtimeRateControl;
+    QString                             VideoResolution;
+    bool                                VideoRtp;
+    bool                                VideoSkipIdleFrames;
+    float                               VideoSkipIdleFramesKeepAliveFps;
+    enum Homer::Base::TransportType     VideoTransportType;
+    int                                 VideoVbvBufferTime;
+
+    /* User */
+    QString                             UserMail;
+    QString                             UserName;
+};
+
+// stays valid as long as it is referenced, also if the settings are changed meanwhile
+typedef QSharedPointer<const ConfigurationValues> ConfigurationSnapshot;
+
+class ConfigurationObserver
+{
+public:
+    ConfigurationObserver(){ }
+    virtual ~ConfigurationObserver(){ }
+
+    /* called from the thread which changed a setting, must not call back into the configuration's notification interface */
+    virtual void ConfigurationChanged(unsigned int pRevision) = 0;
+};
+
+typedef std::list<ConfigurationObserver*> ConfigurationObservers;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class Configuration:
+    public Homer::Base::Thread
 {
 public:
     Configuration();
@@ -145,6 +325,7 @@ public:
     bool GetParticipantWidgetsCloseImmediately();
 
     bool GetSmoothVideoPresentation();
+    int GetMediaMemoryBudget(); // in MB, 0 means unlimited
     bool GetAutoUpdateCheck();
     bool GetFeatureConferencing();
     bool GetFeatureAutoLogging();
@@ -169,6 +350,11 @@ public:
     QString GetVideoResolution();
     bool GetLocalVideoSourceHFlip();
     bool GetLocalVideoSourceVFlip();
+    bool GetVideoSkipIdleFrames();
+    float GetVideoSkipIdleFramesKeepAliveFps();
+    bool GetVideoRealtimeRateControl();
+    int GetVideoVbvBufferTime(); // in ms
+    bool GetVideoIntraRefresh();
 
     /* audio settings */
     bool GetAudioActivation();
@@ -202,6 +388,8 @@ public:
     bool GetSipUnknownContactsProbing();
     int GetSipInfrastructureMode();
     bool GetNatSupportActivation();
+    bool GetMediaBundlingActivation();
+    bool GetMediaLoopbackActivation();
     QString GetStunServer();
     /* SIP network listener */
     QString GetSipListenerAddress();
@@ -315,6 +503,7 @@ public:
     void SetConfigurationSelection(int pSelection);
 
     void SetSmoothVideoPresentation(bool pActive);
+    void SetMediaMemoryBudget(int pBudget);
     void SetAutoUpdateCheck(bool pActive);
     void SetFeatureConferencing(bool pActive);
     void SetFeatureAutoLogging(bool pActive);
@@ -338,6 +527,11 @@ public:
     void SetVideoFps(int pFps);
     void SetLocalVideoSourceHFlip(bool pHFlip);
     void SetLocalVideoSourceVFlip(bool pVFlip);
+    void SetVideoSkipIdleFrames(bool pActivation);
+    void SetVideoSkipIdleFramesKeepAliveFps(float pFps);
+    void SetVideoRealtimeRateControl(bool pActivation);
+    void SetVideoVbvBufferTime(int pTime);
+    void SetVideoIntraRefresh(bool pActivation);
 
     /* audio settings */
     void SetAudioActivation(bool pActivation);
@@ -372,6 +566,8 @@ public:
     void SetSipUnknownContactsProbing(bool pActivation);
     void SetStunServer(QString pServer);
     void SetNatSupportActivation(bool pActivation);
+    void SetMediaBundlingActivation(bool pActivation);
+    void SetMediaLoopbackActivation(bool pActivation);
     void SetSipListenerAddress(QString pAddress);
     void SetSipListenerTransport(enum Homer::Base::TransportType pType);
     void SetSipStartPort(int pPort);
@@ -433,6 +629,35 @@ public:
     // important because some write operations might be delayed
     void Sync();
 
+    /* consistent view of all settings */
+    ConfigurationSnapshot GetSnapshot();
+
+    /* change notification: the revision is incremented with every changed setting */
+    unsigned int GetRevision();
+    void AddObserver(ConfigurationObserver *pObserver);
+    void RemoveObserver(ConfigurationObserver *pObserver);
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    /* read of one setting from a reference to the current snapshot */
+    template <typename T> T GetValue(T ConfigurationValues::*pField);
+    /* publishes a new snapshot and schedules the write-back */
+    template <typename T> void SetValue(T ConfigurationValues::*pField, const QString &pKey, const T &pValue);
+    template <typename T> void SetValue(T ConfigurationValues::*pField, const QString &pKey, const T &pValue, const QVariant &pStoredValue);
+    void LoadValues(ConfigurationValues &pValues);
+    void PublishSnapshot(ConfigurationValues *pValues);
+    void NotifyObservers(unsigned int pRevision);
+    void WriteBack();
+
+    ConfigurationSnapshot   mSnapshot; // owning reference of the current snapshot, swapped and copied under mSnapshotMutex, publishers are serialized by mSettingsMutex
+    Homer::Base::Mutex      mSnapshotMutex; // held only while a reference is swapped or copied
+    QHash<QString, QVariant> mPendingWrites;
+    Homer::Base::Mutex      mSettingsMutex; // protects mQSettings, mPendingWrites and the publishing of snapshots
+    ConfigurationObservers  mObservers;
+    Homer::Base::Mutex      mObserversMutex;
+    Homer::Base::Condition  mPendingWritesCondition;
+    bool                    mWriteBackNeeded;
 
     QString		            mAbsBinPath;
     QSettings               *mQSettings;
@@ -50,6 +50,10 @@
 
 #include <QMeetingEvents.h>
 
+#include <HBThread.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
+
 #include <QMainWindow>
 #include <QMenu>
 #include <QMutex>
@@ -75,8 +79,56 @@ using namespace Homer::Conference;
 
 #define SCREEN_CAPTURE_FPS					(29.97)
 
+// de/activates the parallel initialization of stages which don't depend on the GUI
+#define STARTUP_PARALLEL_STAGES
+
+// startup time from the start of main() until the main window should be painted the first time, a warning is logged if it is exceeded
+// the deferred stages are started after the first paint event or after this time at the latest
+#define STARTUP_TIME_BUDGET                 1500 // ms
+
+// delay between the main window becoming visible and the registration at STUN/SIP server
+#define STARTUP_REGISTRATION_DELAY          2000 // ms
+
+// period for checking if the capture devices are probed, they are added to the muxers afterwards
+#define STARTUP_PROBING_CHECK_PERIOD        50 // ms
+
 ///////////////////////////////////////////////////////////////////////////////
 class StreamingControlWidget;
+class MainWindow;
+
+typedef void (MainWindow::*StartupStageFunction)();
+
+/*
+ * Runs an initialization stage of the main window in a separate thread. Only stages
+ * which neither create nor access Qt GUI objects may be executed this way.
+ */
+class StartupStage:
+    public Homer::Base::Thread
+{
+public:
+    StartupStage(MainWindow *pMainWindow, StartupStageFunction pFunction, QString pName);
+
+    virtual ~StartupStage();
+
+    void Start();
+    /* returns true if the stage has finished and Finish() won't block */
+    bool IsFinished();
+    /* waits until the stage has finished */
+    void Finish();
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    MainWindow                  *mMainWindow;
+    StartupStageFunction        mFunction;
+    QString                     mName;
+    bool                        mStarted;
+    bool                        mFinished;
+    Homer::Base::Mutex          mFinishedMutex;
+    Homer::Base::Condition      mFinishedCondition;
+};
+
+///////////////////////////////////////////////////////////////////////////////
 class MainWindow:
         public QMainWindow,
         AudioPlayback,
@@ -98,9 +150,14 @@ public:
     void AddGlobalContextMenu(QMenu *pMenu);
 
     static void removeArguments(QStringList &pArguments, QString pFilter);
+    /* the time to the first paint is measured from here, called at the start of main() */
+    static void SetProcessStartTime(int64_t pTime /* in us */);
 
     ParticipantWidget* GetParticipantWidget(QString pParticipant, enum TransportType pTransport);
 
+private:
+    friend class StartupStage;
+
 public slots:
     void actionOpenVideoAudioPreview();
 
@@ -141,6 +198,9 @@ private slots:
     void RegisterAtStunSipServer();
     void UpdateSysTrayContextMenu();
 
+    void initializeDeferredStages();
+    void checkCaptureDeviceProbing();
+
 private:
     void initializeConfiguration(QStringList &pArguments);
     void initializeGUI();
@@ -148,12 +208,18 @@ private:
     void initializeFeatureDisablers(QStringList &pArguments);
     void initializeDebugging(QStringList &pArguments);
     void ShowFfmpegCaps(QStringList &pArguments);
+    void probeNetworkInterfaces();
+    void probeCaptureDevices();
     void initializeConferenceManagement();
     void initializeVideoAudioIO();
+    void finishCaptureDeviceProbing();
+    void selectCaptureDevices();
+    void finishStartupStage(QString pName);
     void initializeColoring();
     void initializeWidgetsAndMenus();
     void initializeScreenCapturing();
     void initializeNetworkSimulator(QStringList &pArguments, bool pForce = false);
+    void initializeNetworkImpairment(QStringList &pArguments);
     void inititalizeDisplayParameters(QStringList &pArguments);
     void LogArguments(QStringList pArguments);
     void ProcessRemainingArguments(QStringList &pArguments);
@@ -165,6 +231,7 @@ private:
     virtual void dragEnterEvent(QDragEnterEvent *pEvent);
     virtual void dropEvent(QDropEvent *pEvent);
     virtual void changeEvent (QEvent *pEvent);
+    virtual void paintEvent(QPaintEvent *pEvent);
     virtual void customEvent(QEvent* pEvent);
     virtual QMenu* createPopupMenu();
 
@@ -214,6 +281,20 @@ private:
     static bool                 mStarting;
     /* program timing */
     QTime                       mStartTime;
+    static int64_t              mProcessStartTime; // in us
+    int64_t                     mStartupTime; // in us
+    bool                        mStartupMeasurement; // print the time to the first paint and quit
+    int64_t                     mStartupStageStartTime; // in us
+    bool                        mStartupPainted;
+    bool                        mDeferredStagesInitialized;
+    /* parallel startup stages and their results */
+    StartupStage                *mNetworkProbing;
+    StartupStage                *mCaptureDeviceProbing;
+    QString                     mProbedLocalSourceIp;
+    QString                     mProbedLocalLoopIp;
+    bool                        mProbedNetworkInterface;
+    MediaSource                 *mProbedVideoCaptureSource;
+    MediaSource                 *mProbedAudioCaptureSource;
     /* network simulator */
     #if HOMER_NETWORK_SIMULATOR
         NetworkSimulator            *mNetworkSimulator;
@@ -30,6 +30,11 @@
 #include <MediaFilter.h>
 #include <Header_Ffmpeg.h>
 
+#include <QImage>
+#include <QFont>
+#include <QDate>
+#include <QTime>
+
 namespace Homer { namespace Multimedia {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -44,7 +49,28 @@ public:
 
     // filter a chunk: either an RGB32 picture or a raw audio chunk
     virtual void FilterChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkbufferNumber, AVStream *pStream, bool pIsKeyFrame);
+
 protected:
+    virtual void ChunkFormatChanged(int pResX, int pResY, unsigned int pChunkBufferSize);
+
+private:
+    void RenderOverlay(QImage &pOverlay, QString pText);
+    void BlendOverlay(char* pChunkBuffer, const QImage &pOverlay, int pPosX, int pPosY);
+
+    /* pre-rendered text, updated once per second (time) or day (date) */
+    bool                mOverlayValid;
+    int                 mResX;
+    int                 mResY;
+    QFont               mFont;
+    int                 mFontAscent;
+    QImage              mTimeOverlay;
+    int                 mTimePosX;
+    int                 mTimePosY;
+    int                 mTimeSecond;
+    QImage              mDateOverlay;
+    int                 mDatePosX;
+    int                 mDatePosY;
+    QDate               mDate;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -63,6 +63,7 @@ public:
     virtual std::string GetSourceCodecStr();
     virtual std::string GetSourceCodecDescription();
     virtual bool HasVariableOutputFrameRate();
+    virtual bool IsVideoFrameUnchanged();
 
     /* device control */
     virtual void getVideoDevices(VideoDevices &pVList);
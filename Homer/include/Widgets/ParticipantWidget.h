@@ -39,6 +39,7 @@
 #include <MediaSourceMuxer.h>
 #include <MeetingEvents.h>
 #include <MediaSource.h>
+#include <MediaSynchronizer.h>
 #include <MediaSinkNet.h>
 #include <WaveOut.h>
 
@@ -134,7 +135,7 @@ public:
     void HandleCallUnavailable(bool pIncoming, int pStatusCode, QString pDescription);
     void HandleCallRinging(bool pIncoming);
     void HandleCallDenied(bool pIncoming);
-    void HandleMediaUpdate(bool pIncoming, QString pRemoteAudioAdr, unsigned int pRemoteAudioPort, QString pRemoteAudioCodec, unsigned int pNegotiatedRTPAudioPayloadID, QString pRemoteVideoAdr, unsigned int pRemoteVideoPort, QString pRemoteVideoCodec, unsigned int pNegotiatedRTPVideoPayloadID);
+    void HandleMediaUpdate(bool pIncoming, QString pRemoteAudioAdr, unsigned int pRemoteAudioPort, QString pRemoteAudioCodec, unsigned int pNegotiatedRTPAudioPayloadID, QString pRemoteVideoAdr, unsigned int pRemoteVideoPort, QString pRemoteVideoCodec, unsigned int pNegotiatedRTPVideoPayloadID, int pNegotiatedAudioPtime = 0, int pNegotiatedAudioMaxPtime = 0);
 
     void SetVideoStreamPreferences(QString pCodec, bool pJustReset = false);
     void SetAudioStreamPreferences(QString pCodec, bool pJustReset = false);
@@ -277,13 +278,9 @@ private:
     QAction					*mAssignedActionAVControls;
     int                     mPlayPauseButtonIsPaused; // used to avoid unnecessary periodic updates
     /* A/V synch. */
-    int64_t                 mAVSyncCounter;
-    int64_t					mLastAudioSynchronizationTimestamp;
-    int64_t					mLastVideoSynchronizationTimestamp;
+    MediaSynchronizer       *mAVSynchronizer;
     float                   mVideoDelayAVDrift;
     int64_t					mTimeOfLastAVSynch;
-    int 					mAVAsyncCounterSinceLastSynchronization;
-    int						mAVASyncCounter;
     MovieControlWidget      *mFullscreeMovieControlWidget;
     bool                    mAVSynchActive; //controls A/V synch.
     bool                    mAVPreBuffering; // only for GUI output
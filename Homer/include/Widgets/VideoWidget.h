@@ -51,6 +51,7 @@
 #include <MediaFilterSystemState.h>
 
 #include <MediaSourceGrabberThread.h>
+#include <Configuration.h>
 
 namespace Homer { namespace Gui {
 
@@ -81,7 +82,8 @@ class ParticipantWidget;
 class VideoWorkerThread;
 
 class VideoWidget:
-    public QWidget
+    public QWidget,
+    public ConfigurationObserver
 {
     Q_OBJECT;
 
@@ -123,6 +125,8 @@ private slots:
     void ShowHourGlass();
 
 private:
+    virtual void ConfigurationChanged(unsigned int pRevision);
+
     void SendActivityToSystem(); // informs the system that there is still activity and screensaver/sleep mode isn't needed, has to be called periodically
     void DialogAddNetworkSink();
     void ShowFrame(void* pBuffer);
@@ -180,6 +184,7 @@ private:
     int                 mHourGlassOffset;
     bool                mSystemStatePresentation;
     bool                mSmoothPresentation;
+    bool                mPreventScreensaver;
     bool                mRecorderStarted;
     bool                mInsideDockWidget;
     bool                mVideoPaused;
@@ -46,6 +46,7 @@ namespace Homer { namespace Gui {
 using namespace std;
 using namespace Homer::Conference;
 using namespace Homer::Multimedia;
+using namespace Homer::Base;
 
 Configuration sConfiguration;
 
@@ -107,13 +108,25 @@ Configuration::Configuration()
     mAudioCaptureEnabled = true;
     mConferencingEnabled = true;
     mDebuggingEnabled = false;
+    mWriteBackNeeded = false;
     mQSettings = new QSettings("Homer Software", "Homer");
+    ConfigurationValues *tValues = new ConfigurationValues();
+    LoadValues(*tValues);
+    PublishSnapshot(tValues);
     LOG(LOG_VERBOSE, "Created");
     LOG(LOG_VERBOSE, "Program settings are stored in: %s", mQSettings->fileName().toStdString().c_str());
 }
 
 Configuration::~Configuration()
 {
+    if (IsRunning())
+    {
+        mSettingsMutex.lock();
+        mWriteBackNeeded = false;
+        mPendingWritesCondition.Signal();
+        mSettingsMutex.unlock();
+        StopThread(3000);
+    }
 	Sync();
 	LOG(LOG_VERBOSE, "Destroyed");
 }
@@ -141,16 +154,327 @@ void Configuration::Init(QString &pAbsBinPath)
 			pAbsBinPath = mAbsBinPath;
 		}
 	#endif
+
+    // start the asynchronous write-back of changed settings
+    if (!IsRunning())
+    {
+        mWriteBackNeeded = true;
+        StartThread();
+    }
 }
 
 void Configuration::SetDefaults()
 {
 	LOG(LOG_VERBOSE, "Setting program defaults");
 	printf("Setting program defaults\n");
+	mSettingsMutex.lock();
+	mPendingWrites.clear();
 	mQSettings->clear();
+	ConfigurationValues *tValues = new ConfigurationValues();
+	LoadValues(*tValues);
+	tValues->Revision = mSnapshot->Revision + 1;
+	unsigned int tRevision = tValues->Revision;
+	PublishSnapshot(tValues);
+	mSettingsMutex.unlock();
+	NotifyObservers(tRevision);
 	Sync();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+// caller has to hold mSettingsMutex or has to be the constructor
+void Configuration::LoadValues(ConfigurationValues &pValues)
+{
+    pValues.Revision = 0;
+
+    /* Broadcast */
+    pValues.BroadcastAudioPlaybackMuted = mQSettings->value("Broadcast/AudioPlaybackMuted", true).toBool();
+
+    /* Capturing */
+    pValues.LocalVideoSourceHFlip = mQSettings->value("Capturing/HorizontallyFlipInput", false).toBool();
+    pValues.LocalAudioSource = mQSettings->value("Capturing/LocalAudioDevice", QString("auto")).toString();
+    pValues.LocalVideoSource = mQSettings->value("Capturing/LocalVideoDevice", QString("auto")).toString();
+    pValues.LocalVideoSourceVFlip = mQSettings->value("Capturing/VerticallyFlipInput", false).toBool();
+
+    /* ConfigurationDialog */
+    pValues.ConfigurationSelection = mQSettings->value("ConfigurationDialog/Selection", 0).toInt();
+
+    /* Global */
+    pValues.AutoUpdateCheck = mQSettings->value("Global/AutomaticUpdateCheck", false).toBool();
+    pValues.ConferenceAvailability = mQSettings->value("Global/Availability").toString();
+    pValues.ContactFile = mQSettings->value("Global/ContactFile").toString();
+    pValues.DataDirectory = mQSettings->value("Global/DataDirectory").toString();
+    pValues.FeatureAutoLogging = mQSettings->value("Global/FeatureAutoLogging", false).toBool();
+    pValues.FeatureConferencing = mQSettings->value("Global/FeatureConferencing", true).toBool();
+    pValues.Language = mQSettings->value("Global/Language").toString();
+    pValues.MainWindowHeight = mQSettings->value("Global/MainWindowHeight", 0).toInt();
+    pValues.MainWindowMinimized = mQSettings->value("Global/MainWindowMinimized", false).toBool();
+    pValues.MainWindowPositionX = mQSettings->value("Global/MainWindowPositionX", 0).toInt();
+    pValues.MainWindowPositionY = mQSettings->value("Global/MainWindowPositionY", 0).toInt();
+    pValues.MainWindowWidth = mQSettings->value("Global/MainWindowWidth", 0).toInt();
+    pValues.MediaMemoryBudget = mQSettings->value("Global/MediaMemoryBudget", 0).toInt();
+    pValues.ParticipantWidgetsCloseImmediately = mQSettings->value("Global/ParticipantWidgetsCloseImmediately", true).toBool();
+    pValues.ParticipantWidgetsSeparation = mQSettings->value("Global/ParticipantWidgetsSeparation", false).toBool();
+    pValues.PreventScreensaverInFullscreenMode = mQSettings->value("Global/PreventScreensaverInFullscreenMode", true).toBool();
+    pValues.SmoothVideoPresentation = mQSettings->value("Global/SmoothVideoPresentation", false).toBool();
+    pValues.VisibilityBroadcastAudio = mQSettings->value("Global/VisibilityBroadcastAudio", true).toBool();
+    pValues.VisibilityBroadcastMessageWidget = mQSettings->value("Global/VisibilityBroadcastMessageWidget", false).toBool();
+    pValues.VisibilityBroadcastVideo = mQSettings->value("Global/VisibilityBroadcastVideo", true).toBool();
+    pValues.VisibilityBroadcastWidget = mQSettings->value("Global/VisibilityBroadcastWidget", true).toBool();
+    pValues.VisibilityContactsWidget = mQSettings->value("Global/VisibilityContactsWidget", true).toBool();
+    pValues.VisibilityDataStreamsWidget = mQSettings->value("Global/VisibilityDataStreamsWidget", false).toBool();
+    pValues.VisibilityErrorsWidget = mQSettings->value("Global/VisibilityErrorsWidget", false).toBool();
+    pValues.VisibilityFileTransfersWidget = mQSettings->value("Global/VisibilityFileTransfersWidget", false).toBool();
+    pValues.VisibilityMenuBar = mQSettings->value("Global/VisibilityMenuBar", true).toBool();
+    pValues.VisibilityNetworkSimulationWidget = mQSettings->value("Global/VisibilityNetworkSimulationWidget", false).toBool();
+    pValues.VisibilityNetworkStreamsWidget = mQSettings->value("Global/VisibilityNetworkStreamsWidget", false).toBool();
+    pValues.VisibilityPlaylistWidgetAudio = mQSettings->value("Global/VisibilityPlaylistWidgetAudio", false).toBool();
+    pValues.VisibilityPlaylistWidgetMovie = mQSettings->value("Global/VisibilityPlaylistWidgetMovie", false).toBool();
+    pValues.VisibilityPlaylistWidgetVideo = mQSettings->value("Global/VisibilityPlaylistWidgetVideo", false).toBool();
+    pValues.VisibilityStatusBar = mQSettings->value("Global/VisibilityStatusBar", false).toBool();
+    pValues.VisibilityThreadsWidget = mQSettings->value("Global/VisibilityThreadsWidget", false).toBool();
+    pValues.VisibilityToolBarMediaSources = mQSettings->value("Global/VisibilityToolBarMediaSources", true).toBool();
+    pValues.VisibilityToolBarOnlineStatus = mQSettings->value("Global/VisibilityToolBarOnlineStatus", true).toBool();
+
+    /* Network */
+    pValues.AppDataNAPIImpl = mQSettings->value("Network/AppDataNAPIImpl", QString(BERKEYLEY_SOCKETS)).toString();
+    pValues.AppDataTransportType = Socket::String2TransportType(mQSettings->value("Network/AppDataTransportType", QString("UDP")).toString().toStdString());
+    pValues.SipContactsProbing = mQSettings->value("Network/ContactsProbing", true).toBool();
+    pValues.MediaBundlingActivation = mQSettings->value("Network/MediaBundlingActivation", false).toBool();
+    pValues.MediaLoopbackActivation = mQSettings->value("Network/MediaLoopbackActivation", false).toBool();
+    pValues.NatSupportActivation = mQSettings->value("Network/NatSupportActivation", true).toBool();
+    pValues.SipInfrastructureMode = mQSettings->value("Network/SipInfrastructureMode", 0).toInt();
+    pValues.SipListenerAddress = mQSettings->value("Network/SipListenerAddress", QString("")).toString();
+    pValues.SipStartPort = mQSettings->value("Network/SipListenerStartPort", 5060).toInt();
+    pValues.SipListenerTransport = Socket::String2TransportType(mQSettings->value("Network/SipListenerTransportType", QString("auto")).toString().toStdString());
+    pValues.SipPassword = mQSettings->value("Network/SipPassword", QString("")).toString();
+    pValues.SipServer = mQSettings->value("Network/SipServer", QString("sip2sip.info")).toString();
+    pValues.SipServerPort = mQSettings->value("Network/SipServerPort", 5060).toInt();
+    pValues.SipUserName = mQSettings->value("Network/SipUserName").toString();
+    pValues.StunServer = mQSettings->value("Network/StunServer", QString("stun.voipbuster.com")).toString();
+    pValues.SipUnknownContactsProbing = mQSettings->value("Network/UnknownContactsProbing", true).toBool();
+    pValues.VideoAudioStartPort = mQSettings->value("Network/VideoAudioListenerStartPort", 5000).toInt();
+
+    /* Notification */
+    pValues.CallAcknowledgeSound = mQSettings->value("Notification/CallAcknowledgeSound", false).toBool();
+    pValues.CallAcknowledgeSoundFile = mQSettings->value("Notification/CallAcknowledgeSoundFile").toString();
+    pValues.CallAcknowledgeSystray = mQSettings->value("Notification/CallAcknowledgeSystray", true).toBool();
+    pValues.CallDenySound = mQSettings->value("Notification/CallDenySound", false).toBool();
+    pValues.CallDenySoundFile = mQSettings->value("Notification/CallDenySoundFile").toString();
+    pValues.CallDenySystray = mQSettings->value("Notification/CallDenySystray", true).toBool();
+    pValues.CallHangupSound = mQSettings->value("Notification/CallHangupSound", false).toBool();
+    pValues.CallHangupSoundFile = mQSettings->value("Notification/CallHangupSoundFile").toString();
+    pValues.CallHangupSystray = mQSettings->value("Notification/CallHangupSystray", true).toBool();
+    pValues.CallSound = mQSettings->value("Notification/CallSound", false).toBool();
+    pValues.CallSoundFile = mQSettings->value("Notification/CallSoundFile").toString();
+    pValues.CallSystray = mQSettings->value("Notification/CallSystray", true).toBool();
+    pValues.ErrorSound = mQSettings->value("Notification/ErrorSound", false).toBool();
+    pValues.ErrorSoundFile = mQSettings->value("Notification/ErrorSoundFile").toString();
+    pValues.ErrorSystray = mQSettings->value("Notification/ErrorSystray", true).toBool();
+    pValues.ImSound = mQSettings->value("Notification/ImSound", false).toBool();
+    pValues.ImSoundFile = mQSettings->value("Notification/ImSoundFile").toString();
+    pValues.ImSystray = mQSettings->value("Notification/ImSystray", true).toBool();
+    pValues.RegistrationFailedSound = mQSettings->value("Notification/RegistrationFailedSound", false).toBool();
+    pValues.RegistrationFailedSoundFile = mQSettings->value("Notification/RegistrationFailedSoundFile").toString();
+    pValues.RegistrationFailedSystray = mQSettings->value("Notification/RegistrationFailedSystray", true).toBool();
+    pValues.RegistrationSuccessfulSound = mQSettings->value("Notification/RegistrationSuccessfulSound", false).toBool();
+    pValues.RegistrationSuccessfulSoundFile = mQSettings->value("Notification/RegistrationSuccessfulSoundFile").toString();
+    pValues.RegistrationSuccessfulSystray = mQSettings->value("Notification/RegistrationSuccessfulSystray", true).toBool();
+    pValues.StartSound = mQSettings->value("Notification/StartSound", false).toBool();
+    pValues.StartSoundFile = mQSettings->value("Notification/StartSoundFile").toString();
+    pValues.StartSystray = mQSettings->value("Notification/StartSystray", true).toBool();
+    pValues.StopSound = mQSettings->value("Notification/StopSound", false).toBool();
+    pValues.StopSoundFile = mQSettings->value("Notification/StopSoundFile").toString();
+    pValues.StopSystray = mQSettings->value("Notification/StopSystray", true).toBool();
+
+    /* Playback */
+    pValues.AVSyncDuringConference = mQSettings->value("Playback/AVSyncDuringConference", false).toBool();
+    pValues.LocalAudioSink = mQSettings->value("Playback/LocalAudioDevice", QString("auto")).toString();
+    pValues.PreBufferTimeDuringConference = mQSettings->value("Playback/PreBufferTimeDuringConference", CONF_AV_DEFAULT_CONFERENCE_PRE_BUFFER).toDouble();
+
+    /* PreviewDialog */
+    pValues.PreviewPreBufferingActivation = mQSettings->value("PreviewDialog/PreBufferingActivation", true).toBool();
+    pValues.PreviewSelection = mQSettings->value("PreviewDialog/Selection", 2).toInt();
+    pValues.PreviewSelectionAudio = mQSettings->value("PreviewDialog/SelectionAudio", true).toBool();
+    pValues.PreviewSelectionVideo = mQSettings->value("PreviewDialog/SelectionVideo", true).toBool();
+
+    /* Streaming */
+    pValues.AudioActivation = mQSettings->value("Streaming/AudioStreamActivation", true).toBool();
+    pValues.AudioActivationPushToTalk = mQSettings->value("Streaming/AudioStreamActivationPushToTalk", false).toBool();
+    pValues.AudioBitRate = mQSettings->value("Streaming/AudioStreamBitRate", 256 * 1024).toInt();
+    pValues.AudioCodec = mQSettings->value("Streaming/AudioStreamCodec", QString("G722 adpcm")).toString();
+    pValues.AudioMaxPacketSize = mQSettings->value("Streaming/AudioStreamMaxPacketSize", 1280).toInt();
+    pValues.AudioStreamingNAPIImpl = mQSettings->value("Streaming/AudioStreamNAPIImpl", QString(BERKEYLEY_SOCKETS)).toString();
+    pValues.AudioRtp = mQSettings->value("Streaming/AudioStreamRtp", true).toBool();
+    pValues.AudioSkipSilence = mQSettings->value("Streaming/AudioStreamSkipSilence", false).toBool();
+    pValues.AudioSkipSilenceThreshold = mQSettings->value("Streaming/AudioStreamSkipSilenceThreshold", 128).toInt();
+    pValues.AudioTransportType = Socket::String2TransportType(mQSettings->value("Streaming/AudioStreamTransportType", QString("UDP")).toString().toStdString());
+    pValues.VideoFps = mQSettings->value("Streaming/VideoFps", 0).toInt();
+    pValues.VideoActivation = mQSettings->value("Streaming/VideoStreamActivation", true).toBool();
+    pValues.VideoBitRate = mQSettings->value("Streaming/VideoStreamBitRate", 90 * 1024).toInt();
+    pValues.VideoCodec = mQSettings->value("Streaming/VideoStreamCodec", QString("H.263+")).toString();
+    pValues.VideoIntraRefresh = mQSettings->value("Streaming/VideoStreamIntraRefresh", true).toBool();
+    pValues.VideoMaxPacketSize = mQSettings->value("Streaming/VideoStreamMaxPacketSize", 1280).toInt();
+    pValues.VideoStreamingNAPIImpl = mQSettings->value("Streaming/VideoStreamNAPIImpl", QString(BERKEYLEY_SOCKETS)).toString();
+    pValues.VideoQuality = mQSettings->value("Streaming/VideoStreamQuality", 10).toInt();
+    pValues.VideoRealtimeRateControl = mQSettings->value("Streaming/VideoStreamRealtimeRateControl", false).toBool();
+    pValues.VideoResolution = mQSettings->value("Streaming/VideoStreamResolution", QString("auto")).toString();
+    pValues.VideoRtp = mQSettings->value("Streaming/VideoStreamRtp", true).toBool();
+    pValues.VideoSkipIdleFrames = mQSettings->value("Streaming/VideoStreamSkipIdleFrames", true).toBool();
+    pValues.VideoSkipIdleFramesKeepAliveFps = mQSettings->value("Streaming/VideoStreamSkipIdleFramesKeepAliveFps", 1.0).toDouble();
+    pValues.VideoTransportType = Socket::String2TransportType(mQSettings->value("Streaming/VideoStreamTransportType", QString("UDP")).toString().toStdString());
+    pValues.VideoVbvBufferTime = mQSettings->value("Streaming/VideoStreamVbvBufferTime", 250).toInt();
+
+    /* User */
+    pValues.UserMail = mQSettings->value("User/UserMail").toString();
+    pValues.UserName = mQSettings->value("User/UserName").toString();
+}
+
+// caller has to hold mSettingsMutex or has to be the constructor
+void Configuration::PublishSnapshot(ConfigurationValues *pValues)
+{
+    ConfigurationSnapshot tPreviousSnapshot;
+
+    // only the references are swapped, nobody waits for the users of the previous snapshot
+    mSnapshotMutex.lock();
+    tPreviousSnapshot = mSnapshot;
+    mSnapshot = ConfigurationSnapshot(pValues);
+    mSnapshotMutex.unlock();
+
+    // drops the reference to the previous snapshot outside of the lock, it is freed with its last reference
+}
+
+template <typename T>
+T Configuration::GetValue(T ConfigurationValues::*pField)
+{
+    // the reference keeps the snapshot alive while the value is copied, also if a new one is published meanwhile
+    ConfigurationSnapshot tSnapshot = GetSnapshot();
+
+    return tSnapshot.data()->*pField;
+}
+
+template <typename T>
+void Configuration::SetValue(T ConfigurationValues::*pField, const QString &pKey, const T &pValue)
+{
+    SetValue(pField, pKey, pValue, QVariant(pValue));
+}
+
+template <typename T>
+void Configuration::SetValue(T ConfigurationValues::*pField, const QString &pKey, const T &pValue, const QVariant &pStoredValue)
+{
+    mSettingsMutex.lock();
+
+    // nothing to do if the value didn't change
+    if (mSnapshot.data()->*pField == pValue)
+    {
+        mSettingsMutex.unlock();
+        return;
+    }
+
+    // the copy shares the string data with the previous snapshot
+    ConfigurationValues *tValues = new ConfigurationValues(*mSnapshot);
+    tValues->*pField = pValue;
+    tValues->Revision++;
+    unsigned int tRevision = tValues->Revision;
+    PublishSnapshot(tValues);
+
+    // schedule the write-back
+    mPendingWrites[pKey] = pStoredValue;
+    if (mWriteBackNeeded)
+        mPendingWritesCondition.Signal();
+    else
+        WriteBack();
+
+    mSettingsMutex.unlock();
+
+    NotifyObservers(tRevision);
+}
+
+ConfigurationSnapshot Configuration::GetSnapshot()
+{
+    ConfigurationSnapshot tResult;
+
+    mSnapshotMutex.lock();
+    tResult = mSnapshot;
+    mSnapshotMutex.unlock();
+
+    return tResult;
+}
+
+unsigned int Configuration::GetRevision()
+{
+    return GetValue(&ConfigurationValues::Revision);
+}
+
+void Configuration::AddObserver(ConfigurationObserver *pObserver)
+{
+    mObserversMutex.lock();
+    mObservers.push_back(pObserver);
+    mObserversMutex.unlock();
+}
+
+void Configuration::RemoveObserver(ConfigurationObserver *pObserver)
+{
+    mObserversMutex.lock();
+    mObservers.remove(pObserver);
+    mObserversMutex.unlock();
+}
+
+void Configuration::NotifyObservers(unsigned int pRevision)
+{
+    ConfigurationObservers::iterator tIt;
+
+    mObserversMutex.lock();
+    for (tIt = mObservers.begin(); tIt != mObservers.end(); tIt++)
+        (*tIt)->ConfigurationChanged(pRevision);
+    mObserversMutex.unlock();
+}
+
+// caller has to hold mSettingsMutex
+void Configuration::WriteBack()
+{
+    if (mPendingWrites.isEmpty())
+        return;
+
+    #ifdef DEBUG_CONFIGURATION_WRITE_BACK
+        LOG(LOG_VERBOSE, "Writing back %d changed program settings", mPendingWrites.size());
+    #endif
+
+    QHash<QString, QVariant>::const_iterator tIt;
+    for (tIt = mPendingWrites.constBegin(); tIt != mPendingWrites.constEnd(); tIt++)
+    {
+        mQSettings->setValue(tIt.key(), tIt.value());
+    }
+    mPendingWrites.clear();
+}
+
+void* Configuration::Run(void* pArgs)
+{
+    LOG(LOG_VERBOSE, "Write-back of program settings started");
+
+    mSettingsMutex.lock();
+    while (mWriteBackNeeded)
+    {
+        if (mPendingWrites.isEmpty())
+        {
+            mPendingWritesCondition.Wait(&mSettingsMutex);
+            continue;
+        }
+
+        // give further changes the chance to join the batch
+        mSettingsMutex.unlock();
+        Suspend(CONF_WRITE_BACK_DELAY * 1000);
+        mSettingsMutex.lock();
+
+        WriteBack();
+    }
+    mSettingsMutex.unlock();
+
+    LOG(LOG_VERBOSE, "Write-back of program settings finished");
+
+    return NULL;
+}
+
 static int sGifIsSupported = -1;
 bool Configuration::IsGifReadingSupported()
 {
@@ -175,798 +499,614 @@ bool Configuration::IsGifReadingSupported()
 
 void Configuration::SetConferenceAvailability(QString pState)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("Availability", pState);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ConferenceAvailability, "Global/Availability", pState);
 }
 
 void Configuration::SetContactFile(QString pContactFile)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("ContactFile", pContactFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ContactFile, "Global/ContactFile", pContactFile);
 }
 
 void Configuration::SetDataDirectory(QString pDataDirectory)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("DataDirectory", pDataDirectory);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::DataDirectory, "Global/DataDirectory", pDataDirectory);
 }
 
 void Configuration::SetMainWindowPosition(QPoint pPos)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("MainWindowPositionX", pPos.x());
-    mQSettings->setValue("MainWindowPositionY", pPos.y());
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::MainWindowPositionX, "Global/MainWindowPositionX", pPos.x());
+    SetValue(&ConfigurationValues::MainWindowPositionY, "Global/MainWindowPositionY", pPos.y());
 }
 
 void Configuration::SetMainWindowSize(QSize pSize)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("MainWindowWidth", pSize.width());
-    mQSettings->setValue("MainWindowHeight", pSize.height());
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::MainWindowWidth, "Global/MainWindowWidth", pSize.width());
+    SetValue(&ConfigurationValues::MainWindowHeight, "Global/MainWindowHeight", pSize.height());
 }
 
 void Configuration::SetMainWindowMinimized(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("MainWindowMinimized", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::MainWindowMinimized, "Global/MainWindowMinimized", pActive);
 }
 
 void Configuration::SetParticipantWidgetsSeparation(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("ParticipantWidgetsSeparation", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ParticipantWidgetsSeparation, "Global/ParticipantWidgetsSeparation", pActive);
 }
 
 void Configuration::SetParticipantWidgetsCloseImmediately(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("ParticipantWidgetsCloseImmediately", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ParticipantWidgetsCloseImmediately, "Global/ParticipantWidgetsCloseImmediately", pActive);
 }
 
 void Configuration::SetPreventScreensaverInFullscreenMode(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("PreventScreensaverInFullscreenMode", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::PreventScreensaverInFullscreenMode, "Global/PreventScreensaverInFullscreenMode", pActive);
 }
 
 void Configuration::SetBroadcastAudioPlaybackMuted(bool pActive)
 {
-    mQSettings->beginGroup("Broadcast");
-    mQSettings->setValue("AudioPlaybackMuted", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::BroadcastAudioPlaybackMuted, "Broadcast/AudioPlaybackMuted", pActive);
 }
 
 void Configuration::SetVisibilityContactsWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityContactsWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityContactsWidget, "Global/VisibilityContactsWidget", pActive);
 }
 
 void Configuration::SetVisibilityErrorsWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityErrorsWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityErrorsWidget, "Global/VisibilityErrorsWidget", pActive);
 }
 
 void Configuration::SetVisibilityFileTransfersWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityFileTransfersWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityFileTransfersWidget, "Global/VisibilityFileTransfersWidget", pActive);
 }
 
 void Configuration::SetVisibilityPlaylistWidgetAudio(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityPlaylistWidgetAudio", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityPlaylistWidgetAudio, "Global/VisibilityPlaylistWidgetAudio", pActive);
 }
 
 void Configuration::SetVisibilityPlaylistWidgetVideo(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityPlaylistWidgetVideo", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityPlaylistWidgetVideo, "Global/VisibilityPlaylistWidgetVideo", pActive);
 }
 
 void Configuration::SetVisibilityPlaylistWidgetMovie(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityPlaylistWidgetMovie", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityPlaylistWidgetMovie, "Global/VisibilityPlaylistWidgetMovie", pActive);
 }
 
 void Configuration::SetVisibilityThreadsWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityThreadsWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityThreadsWidget, "Global/VisibilityThreadsWidget", pActive);
 }
 
 void Configuration::SetVisibilityNetworkSimulationWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityNetworkSimulationWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityNetworkSimulationWidget, "Global/VisibilityNetworkSimulationWidget", pActive);
 }
 
 void Configuration::SetVisibilityNetworkStreamsWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityNetworkStreamsWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityNetworkStreamsWidget, "Global/VisibilityNetworkStreamsWidget", pActive);
 }
 
 void Configuration::SetVisibilityDataStreamsWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityDataStreamsWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityDataStreamsWidget, "Global/VisibilityDataStreamsWidget", pActive);
 }
 
 void Configuration::SetVisibilityBroadcastMessageWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityBroadcastMessageWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityBroadcastMessageWidget, "Global/VisibilityBroadcastMessageWidget", pActive);
 }
 
 void Configuration::SetVisibilityBroadcastWidget(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityBroadcastWidget", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityBroadcastWidget, "Global/VisibilityBroadcastWidget", pActive);
 }
 
 void Configuration::SetVisibilityToolBarMediaSources(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityToolBarMediaSources", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityToolBarMediaSources, "Global/VisibilityToolBarMediaSources", pActive);
 }
 
 void Configuration::SetVisibilityToolBarOnlineStatus(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityToolBarOnlineStatus", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityToolBarOnlineStatus, "Global/VisibilityToolBarOnlineStatus", pActive);
 }
 
 void Configuration::SetVisibilityMenuBar(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityMenuBar", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityMenuBar, "Global/VisibilityMenuBar", pActive);
 }
 
 void Configuration::SetVisibilityStatusBar(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityStatusBar", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityStatusBar, "Global/VisibilityStatusBar", pActive);
 }
 
 void Configuration::SetVisibilityBroadcastAudio(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityBroadcastAudio", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityBroadcastAudio, "Global/VisibilityBroadcastAudio", pActive);
 }
 
 void Configuration::SetVisibilityBroadcastVideo(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("VisibilityBroadcastVideo", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VisibilityBroadcastVideo, "Global/VisibilityBroadcastVideo", pActive);
 }
 
 void Configuration::SetPreviewSelection(int pSelection)
 {
-    mQSettings->beginGroup("PreviewDialog");
-    mQSettings->setValue("Selection", pSelection);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::PreviewSelection, "PreviewDialog/Selection", pSelection);
 }
 
 void Configuration::SetPreviewSelectionVideo(bool pActive)
 {
-    mQSettings->beginGroup("PreviewDialog");
-    mQSettings->setValue("SelectionVideo", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::PreviewSelectionVideo, "PreviewDialog/SelectionVideo", pActive);
 }
 
 void Configuration::SetPreviewSelectionAudio(bool pActive)
 {
-    mQSettings->beginGroup("PreviewDialog");
-    mQSettings->setValue("SelectionAudio", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::PreviewSelectionAudio, "PreviewDialog/SelectionAudio", pActive);
 }
 
 void Configuration::SetPreviewPreBufferingActivation(bool pActivation)
 {
-    mQSettings->beginGroup("PreviewDialog");
-    mQSettings->setValue("PreBufferingActivation", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::PreviewPreBufferingActivation, "PreviewDialog/PreBufferingActivation", pActivation);
 }
 
 void Configuration::SetConfigurationSelection(int pSelection)
 {
-    mQSettings->beginGroup("ConfigurationDialog");
-    mQSettings->setValue("Selection", pSelection);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ConfigurationSelection, "ConfigurationDialog/Selection", pSelection);
 }
 
 void Configuration::SetSmoothVideoPresentation(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("SmoothVideoPresentation", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SmoothVideoPresentation, "Global/SmoothVideoPresentation", pActive);
+}
+
+void Configuration::SetMediaMemoryBudget(int pBudget)
+{
+    SetValue(&ConfigurationValues::MediaMemoryBudget, "Global/MediaMemoryBudget", pBudget);
 }
 
 void Configuration::SetAutoUpdateCheck(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("AutomaticUpdateCheck", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AutoUpdateCheck, "Global/AutomaticUpdateCheck", pActive);
 }
 
 void Configuration::SetFeatureConferencing(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("FeatureConferencing", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::FeatureConferencing, "Global/FeatureConferencing", pActive);
 }
 
 void Configuration::SetFeatureAutoLogging(bool pActive)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("FeatureAutoLogging", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::FeatureAutoLogging, "Global/FeatureAutoLogging", pActive);
 }
 
 void Configuration::SetLanguage(QString pLanguage)
 {
-    mQSettings->beginGroup("Global");
-    mQSettings->setValue("Language", pLanguage);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::Language, "Global/Language", pLanguage);
 }
 
 void Configuration::SetUserName(QString pUserName)
 {
-    mQSettings->beginGroup("User");
-    mQSettings->setValue("UserName", pUserName);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::UserName, "User/UserName", pUserName);
 }
 
 void Configuration::SetUserMail(QString pUserMail)
 {
-    mQSettings->beginGroup("User");
-    mQSettings->setValue("UserMail", pUserMail);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::UserMail, "User/UserMail", pUserMail);
 }
 
 void Configuration::SetVideoActivation(bool pActivation)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamActivation", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoActivation, "Streaming/VideoStreamActivation", pActivation);
 }
 
 void Configuration::SetVideoRtp(bool pActivation)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamRtp", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoRtp, "Streaming/VideoStreamRtp", pActivation);
 }
 
 void Configuration::SetVideoCodec(QString pCodec)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamCodec", pCodec);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoCodec, "Streaming/VideoStreamCodec", pCodec);
 }
 
 void Configuration::SetVideoQuality(int pQuality)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamQuality", pQuality);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoQuality, "Streaming/VideoStreamQuality", pQuality);
 }
 
 void Configuration::SetVideoBitRate(int pBitRate)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamBitRate", pBitRate);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoBitRate, "Streaming/VideoStreamBitRate", pBitRate);
 }
 
 void Configuration::SetVideoMaxPacketSize(int pSize)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamMaxPacketSize", pSize);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoMaxPacketSize, "Streaming/VideoStreamMaxPacketSize", pSize);
 }
 
 void Configuration::SetVideoTransport(enum TransportType pType)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamTransportType", QString(Socket::TransportType2String(pType).c_str()));
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoTransportType, "Streaming/VideoStreamTransportType", pType, QString(Socket::TransportType2String(pType).c_str()));
 }
 
 void Configuration::SetVideoStreamingNAPIImpl(QString pImpl)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamNAPIImpl", pImpl);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoStreamingNAPIImpl, "Streaming/VideoStreamNAPIImpl", pImpl);
 }
 
 void Configuration::SetVideoResolution(QString pResolution)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoStreamResolution", pResolution);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoResolution, "Streaming/VideoStreamResolution", pResolution);
 }
 
 void Configuration::SetLocalVideoSource(QString pVSource)
 {
-    mQSettings->beginGroup("Capturing");
-    mQSettings->setValue("LocalVideoDevice", pVSource);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::LocalVideoSource, "Capturing/LocalVideoDevice", pVSource);
 }
 
 void Configuration::SetVideoFps(int pFps)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("VideoFps", pFps);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoFps, "Streaming/VideoFps", pFps);
 }
 
 void Configuration::SetLocalVideoSourceHFlip(bool pHFlip)
 {
-    mQSettings->beginGroup("Capturing");
-    mQSettings->setValue("HorizontallyFlipInput", pHFlip);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::LocalVideoSourceHFlip, "Capturing/HorizontallyFlipInput", pHFlip);
 }
 
 void Configuration::SetLocalVideoSourceVFlip(bool pVFlip)
 {
-    mQSettings->beginGroup("Capturing");
-    mQSettings->setValue("VerticallyFlipInput", pVFlip);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::LocalVideoSourceVFlip, "Capturing/VerticallyFlipInput", pVFlip);
+}
+
+void Configuration::SetVideoSkipIdleFrames(bool pActivation)
+{
+    SetValue(&ConfigurationValues::VideoSkipIdleFrames, "Streaming/VideoStreamSkipIdleFrames", pActivation);
+}
+
+void Configuration::SetVideoSkipIdleFramesKeepAliveFps(float pFps)
+{
+    SetValue(&ConfigurationValues::VideoSkipIdleFramesKeepAliveFps, "Streaming/VideoStreamSkipIdleFramesKeepAliveFps", pFps);
+}
+
+void Configuration::SetVideoRealtimeRateControl(bool pActivation)
+{
+    SetValue(&ConfigurationValues::VideoRealtimeRateControl, "Streaming/VideoStreamRealtimeRateControl", pActivation);
+}
+
+void Configuration::SetVideoVbvBufferTime(int pTime)
+{
+    SetValue(&ConfigurationValues::VideoVbvBufferTime, "Streaming/VideoStreamVbvBufferTime", pTime);
+}
+
+void Configuration::SetVideoIntraRefresh(bool pActivation)
+{
+    SetValue(&ConfigurationValues::VideoIntraRefresh, "Streaming/VideoStreamIntraRefresh", pActivation);
 }
 
 void Configuration::SetAudioActivation(bool pActivation)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamActivation", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioActivation, "Streaming/AudioStreamActivation", pActivation);
 }
 
 void Configuration::SetAudioActivationPushToTalk(bool pActivation)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamActivationPushToTalk", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioActivationPushToTalk, "Streaming/AudioStreamActivationPushToTalk", pActivation);
 }
 
 void Configuration::SetAudioSkipSilence(bool pActivation)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamSkipSilence", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioSkipSilence, "Streaming/AudioStreamSkipSilence", pActivation);
 }
 
 void Configuration::SetAudioSkipSilenceThreshold(int pThreshold)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamSkipSilenceThreshold", pThreshold);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioSkipSilenceThreshold, "Streaming/AudioStreamSkipSilenceThreshold", pThreshold);
 }
 
 void Configuration::SetAudioRtp(bool pActivation)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamRtp", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioRtp, "Streaming/AudioStreamRtp", pActivation);
 }
 
 void Configuration::SetAudioCodec(QString pCodec)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamCodec", pCodec);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioCodec, "Streaming/AudioStreamCodec", pCodec);
 }
 
 void Configuration::SetAudioBitRate(int pBitRate)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamBitRate", pBitRate);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioBitRate, "Streaming/AudioStreamBitRate", pBitRate);
 }
 
 void Configuration::SetAudioMaxPacketSize(int pSize)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamMaxPacketSize", pSize);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioMaxPacketSize, "Streaming/AudioStreamMaxPacketSize", pSize);
 }
 
 void Configuration::SetAudioTransport(enum TransportType pType)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamTransportType", QString(Socket::TransportType2String(pType).c_str()));
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioTransportType, "Streaming/AudioStreamTransportType", pType, QString(Socket::TransportType2String(pType).c_str()));
 }
 
 void Configuration::SetAudioStreamingNAPIImpl(QString pImpl)
 {
-    mQSettings->beginGroup("Streaming");
-    mQSettings->setValue("AudioStreamNAPIImpl", pImpl);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AudioStreamingNAPIImpl, "Streaming/AudioStreamNAPIImpl", pImpl);
 }
 
 void Configuration::SetAppDataTransport(enum TransportType pType)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("AppDataTransportType", QString(Socket::TransportType2String(pType).c_str()));
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AppDataTransportType, "Network/AppDataTransportType", pType, QString(Socket::TransportType2String(pType).c_str()));
 }
 
 void Configuration::SetAppDataNAPIImpl(QString pImpl)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("AppDataNAPIImpl", pImpl);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AppDataNAPIImpl, "Network/AppDataNAPIImpl", pImpl);
 }
 
 void Configuration::SetLocalAudioSource(QString pASource)
 {
-    mQSettings->beginGroup("Capturing");
-    mQSettings->setValue("LocalAudioDevice", pASource);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::LocalAudioSource, "Capturing/LocalAudioDevice", pASource);
 }
 
 void Configuration::SetLocalAudioSink(QString pASink)
 {
-    mQSettings->beginGroup("Playback");
-    mQSettings->setValue("LocalAudioDevice", pASink);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::LocalAudioSink, "Playback/LocalAudioDevice", pASink);
 }
 
 void Configuration::SetAVSyncDuringConference(bool pActive)
 {
-    mQSettings->beginGroup("Playback");
-    mQSettings->setValue("AVSyncDuringConference", pActive);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::AVSyncDuringConference, "Playback/AVSyncDuringConference", pActive);
 }
 
 void Configuration::SetPreBufferTimeDuringConference(double pValue)
 {
-    mQSettings->beginGroup("Playback");
-    mQSettings->setValue("PreBufferTimeDuringConference", pValue);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::PreBufferTimeDuringConference, "Playback/PreBufferTimeDuringConference", pValue);
 }
 
 void Configuration::SetVideoAudioStartPort(int pPort)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("VideoAudioListenerStartPort", pPort);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::VideoAudioStartPort, "Network/VideoAudioListenerStartPort", pPort);
 }
 
 void Configuration::SetSipStartPort(int pPort)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipListenerStartPort", pPort);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipStartPort, "Network/SipListenerStartPort", pPort);
 }
 
 void Configuration::SetSipUserName(QString pUserName)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipUserName", pUserName);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipUserName, "Network/SipUserName", pUserName);
 }
 
 void Configuration::SetSipPassword(QString pPassword)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipPassword", pPassword);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipPassword, "Network/SipPassword", pPassword);
 }
 
 void Configuration::SetSipServer(QString pServer)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipServer", pServer);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipServer, "Network/SipServer", pServer);
 }
 
 void Configuration::SetSipServerPort(int pPort)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipServerPort", pPort);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipServerPort, "Network/SipServerPort", pPort);
 }
 
 void Configuration::SetSipInfrastructureMode(int pMode)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipInfrastructureMode", pMode);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipInfrastructureMode, "Network/SipInfrastructureMode", pMode);
 }
 
 void Configuration::SetSipContactsProbing(bool pActivation)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("ContactsProbing", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipContactsProbing, "Network/ContactsProbing", pActivation);
 }
 
 void Configuration::SetSipUnknownContactsProbing(bool pActivation)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("UnknownContactsProbing", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipUnknownContactsProbing, "Network/UnknownContactsProbing", pActivation);
 }
 
 void Configuration::SetSipListenerAddress(QString pAddress)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipListenerAddress", pAddress);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipListenerAddress, "Network/SipListenerAddress", pAddress);
 }
 
 void Configuration::SetSipListenerTransport(enum TransportType pType)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("SipListenerTransportType", QString(Socket::TransportType2String(pType).c_str()));
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::SipListenerTransport, "Network/SipListenerTransportType", pType, QString(Socket::TransportType2String(pType).c_str()));
 }
 
 void Configuration::SetStunServer(QString pServer)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("StunServer", pServer);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::StunServer, "Network/StunServer", pServer);
 }
 
 void Configuration::SetNatSupportActivation(bool pActivation)
 {
-    mQSettings->beginGroup("Network");
-    mQSettings->setValue("NatSupportActivation", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::NatSupportActivation, "Network/NatSupportActivation", pActivation);
+}
+
+void Configuration::SetMediaBundlingActivation(bool pActivation)
+{
+    SetValue(&ConfigurationValues::MediaBundlingActivation, "Network/MediaBundlingActivation", pActivation);
+}
+
+void Configuration::SetMediaLoopbackActivation(bool pActivation)
+{
+    SetValue(&ConfigurationValues::MediaLoopbackActivation, "Network/MediaLoopbackActivation", pActivation);
 }
 
 void Configuration::SetStartSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("StartSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::StartSoundFile, "Notification/StartSoundFile", pSoundFile);
 }
 
 void Configuration::SetStartSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("StartSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::StartSound, "Notification/StartSound", pActivation);
 }
 
 void Configuration::SetStartSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("StartSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::StartSystray, "Notification/StartSystray", pActivation);
 }
 
 void Configuration::SetStopSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("StopSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::StopSoundFile, "Notification/StopSoundFile", pSoundFile);
 }
 
 void Configuration::SetStopSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("StopSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::StopSound, "Notification/StopSound", pActivation);
 }
 
 void Configuration::SetStopSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("StopSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::StopSystray, "Notification/StopSystray", pActivation);
 }
 
 void Configuration::SetImSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("ImSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ImSoundFile, "Notification/ImSoundFile", pSoundFile);
 }
 
 void Configuration::SetImSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("ImSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ImSound, "Notification/ImSound", pActivation);
 }
 
 void Configuration::SetImSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("ImSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ImSystray, "Notification/ImSystray", pActivation);
 }
 
 void Configuration::SetCallSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallSoundFile, "Notification/CallSoundFile", pSoundFile);
 }
 
 void Configuration::SetCallSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallSound, "Notification/CallSound", pActivation);
 }
 
 void Configuration::SetCallSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallSystray, "Notification/CallSystray", pActivation);
 }
 
 void Configuration::SetCallAcknowledgeSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallAcknowledgeSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallAcknowledgeSoundFile, "Notification/CallAcknowledgeSoundFile", pSoundFile);
 }
 
 void Configuration::SetCallAcknowledgeSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallAcknowledgeSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallAcknowledgeSound, "Notification/CallAcknowledgeSound", pActivation);
 }
 
 void Configuration::SetCallAcknowledgeSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallAcknowledgeSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallAcknowledgeSystray, "Notification/CallAcknowledgeSystray", pActivation);
 }
 
 void Configuration::SetCallDenySoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallDenySoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallDenySoundFile, "Notification/CallDenySoundFile", pSoundFile);
 }
 
 void Configuration::SetCallDenySound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallDenySound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallDenySound, "Notification/CallDenySound", pActivation);
 }
 
 void Configuration::SetCallDenySystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallDenySystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallDenySystray, "Notification/CallDenySystray", pActivation);
 }
 
 void Configuration::SetCallHangupSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallHangupSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallHangupSoundFile, "Notification/CallHangupSoundFile", pSoundFile);
 }
 
 void Configuration::SetCallHangupSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallHangupSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallHangupSound, "Notification/CallHangupSound", pActivation);
 }
 
 void Configuration::SetCallHangupSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("CallHangupSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::CallHangupSystray, "Notification/CallHangupSystray", pActivation);
 }
 
 void Configuration::SetErrorSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("ErrorSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ErrorSoundFile, "Notification/ErrorSoundFile", pSoundFile);
 }
 
 void Configuration::SetErrorSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("ErrorSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ErrorSound, "Notification/ErrorSound", pActivation);
 }
 
 void Configuration::SetErrorSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("ErrorSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::ErrorSystray, "Notification/ErrorSystray", pActivation);
 }
 
 void Configuration::SetRegistrationFailedSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("RegistrationFailedSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::RegistrationFailedSoundFile, "Notification/RegistrationFailedSoundFile", pSoundFile);
 }
 
 void Configuration::SetRegistrationFailedSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("RegistrationFailedSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::RegistrationFailedSound, "Notification/RegistrationFailedSound", pActivation);
 }
 
 void Configuration::SetRegistrationFailedSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("RegistrationFailedSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::RegistrationFailedSystray, "Notification/RegistrationFailedSystray", pActivation);
 }
 
 void Configuration::SetRegistrationSuccessfulSoundFile(QString pSoundFile)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("RegistrationSuccessfulSoundFile", pSoundFile);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::RegistrationSuccessfulSoundFile, "Notification/RegistrationSuccessfulSoundFile", pSoundFile);
 }
 
 void Configuration::SetRegistrationSuccessfulSound(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("RegistrationSuccessfulSound", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::RegistrationSuccessfulSound, "Notification/RegistrationSuccessfulSound", pActivation);
 }
 
 void Configuration::SetRegistrationSuccessfulSystray(bool pActivation)
 {
-    mQSettings->beginGroup("Notification");
-    mQSettings->setValue("RegistrationSuccessfulSystray", pActivation);
-    mQSettings->endGroup();
+    SetValue(&ConfigurationValues::RegistrationSuccessfulSystray, "Notification/RegistrationSuccessfulSystray", pActivation);
 }
 
 QString Configuration::GetSipListenerAddress()
 {
-    return mQSettings->value("Network/SipListenerAddress", QString("")).toString();
+    return GetValue(&ConfigurationValues::SipListenerAddress);
 }
 
 enum TransportType Configuration::GetSipListenerTransport()
 {
-    return Socket::String2TransportType(mQSettings->value("Network/SipListenerTransportType", QString("auto")).toString().toStdString());
+    return GetValue(&ConfigurationValues::SipListenerTransport);
 }
 
 QString Configuration::GetBinaryPath()
@@ -976,17 +1116,26 @@ QString Configuration::GetBinaryPath()
 
 QString Configuration::GetConferenceAvailability()
 {
-    return mQSettings->value("Global/Availability", QString(MEETING.GetAvailabilityStateStr().c_str())).toString();
+    QString tResult = GetValue(&ConfigurationValues::ConferenceAvailability);
+    if (tResult.isNull())
+        tResult = QString(MEETING.GetAvailabilityStateStr().c_str());
+    return tResult;
 }
 
 QString Configuration::GetContactFile()
 {
-    return mQSettings->value("Global/ContactFile", mAbsBinPath + "Homer-Contacts.xml").toString();
+    QString tResult = GetValue(&ConfigurationValues::ContactFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "Homer-Contacts.xml";
+    return tResult;
 }
 
 QString Configuration::GetDataDirectory()
 {
-    return mQSettings->value("Global/DataDirectory", QDir::homePath()).toString();
+    QString tResult = GetValue(&ConfigurationValues::DataDirectory);
+    if (tResult.isNull())
+        tResult = QDir::homePath();
+    return tResult;
 }
 
 QString Configuration::GetLanguagePath()
@@ -1008,8 +1157,8 @@ QPoint Configuration::GetMainWindowPosition()
     int tScreenResX = QApplication::desktop()->screenGeometry().width();
     int tScreenResY = QApplication::desktop()->screenGeometry().height();
 
-    int tPosX = mQSettings->value("Global/MainWindowPositionX", 0).toInt();
-    int tPosY = mQSettings->value("Global/MainWindowPositionY", 0).toInt();
+    int tPosX = GetValue(&ConfigurationValues::MainWindowPositionX);
+    int tPosY = GetValue(&ConfigurationValues::MainWindowPositionY);
     if (tPosX < 0)
         tPosX = 0;
     if (tPosY < 0)
@@ -1024,175 +1173,183 @@ QPoint Configuration::GetMainWindowPosition()
 
 QSize Configuration::GetMainWindowSize()
 {
-    int tWidth = mQSettings->value("Global/MainWindowWidth", 0).toInt();
-    int tHeight = mQSettings->value("Global/MainWindowHeight", 0).toInt();
+    int tWidth = GetValue(&ConfigurationValues::MainWindowWidth);
+    int tHeight = GetValue(&ConfigurationValues::MainWindowHeight);
 
     return QSize(tWidth, tHeight);
 }
 
 bool Configuration::GetMainWindowMinimized()
 {
-    return mQSettings->value("Global/MainWindowMinimized", false).toBool();
+    return GetValue(&ConfigurationValues::MainWindowMinimized);
 }
 
 bool Configuration::GetParticipantWidgetsSeparation()
 {
-    return mQSettings->value("Global/ParticipantWidgetsSeparation", false).toBool();
+    return GetValue(&ConfigurationValues::ParticipantWidgetsSeparation);
 }
 
 bool Configuration::GetParticipantWidgetsCloseImmediately()
 {
-    return mQSettings->value("Global/ParticipantWidgetsCloseImmediately", true).toBool();
+    return GetValue(&ConfigurationValues::ParticipantWidgetsCloseImmediately);
 }
 
 bool Configuration::GetPreventScreensaverInFullscreenMode()
 {
-    return mQSettings->value("Global/PreventScreensaverInFullscreenMode", true).toBool();
+    return GetValue(&ConfigurationValues::PreventScreensaverInFullscreenMode);
 }
 
 bool Configuration::GetBroadcastAudioPlaybackMuted()
 {
-    return mQSettings->value("Broadcast/AudioPlaybackMuted", true).toBool();
+    return GetValue(&ConfigurationValues::BroadcastAudioPlaybackMuted);
 }
 
 bool Configuration::GetVisibilityContactsWidget()
 {
-    return mQSettings->value("Global/VisibilityContactsWidget", true).toBool();
+    return GetValue(&ConfigurationValues::VisibilityContactsWidget);
 }
 
 bool Configuration::GetVisibilityErrorsWidget()
 {
-    return mQSettings->value("Global/VisibilityErrorsWidget", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityErrorsWidget);
 }
 
 bool Configuration::GetVisibilityFileTransfersWidget()
 {
-    return mQSettings->value("Global/VisibilityFileTransfersWidget", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityFileTransfersWidget);
 }
 
 bool Configuration::GetVisibilityPlaylistWidgetAudio()
 {
-    return mQSettings->value("Global/VisibilityPlaylistWidgetAudio", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityPlaylistWidgetAudio);
 }
 
 bool Configuration::GetVisibilityPlaylistWidgetVideo()
 {
-    return mQSettings->value("Global/VisibilityPlaylistWidgetVideo", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityPlaylistWidgetVideo);
 }
 
 bool Configuration::GetVisibilityPlaylistWidgetMovie()
 {
-    return mQSettings->value("Global/VisibilityPlaylistWidgetMovie", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityPlaylistWidgetMovie);
 }
 
 bool Configuration::GetVisibilityThreadsWidget()
 {
-    return mQSettings->value("Global/VisibilityThreadsWidget", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityThreadsWidget);
 }
 
 bool Configuration::GetVisibilityNetworkSimulationWidget()
 {
-    return mQSettings->value("Global/VisibilityNetworkSimulationWidget", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityNetworkSimulationWidget);
 }
 
 bool Configuration::GetVisibilityNetworkStreamsWidget()
 {
-    return mQSettings->value("Global/VisibilityNetworkStreamsWidget", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityNetworkStreamsWidget);
 }
 
 bool Configuration::GetVisibilityDataStreamsWidget()
 {
-    return mQSettings->value("Global/VisibilityDataStreamsWidget", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityDataStreamsWidget);
 }
 
 bool Configuration::GetVisibilityBroadcastMessageWidget()
 {
-    return mQSettings->value("Global/VisibilityBroadcastMessageWidget", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityBroadcastMessageWidget);
 }
 
 bool Configuration::GetVisibilityBroadcastWidget()
 {
-    return mQSettings->value("Global/VisibilityBroadcastWidget", true).toBool();
+    return GetValue(&ConfigurationValues::VisibilityBroadcastWidget);
 }
 
 bool Configuration::GetVisibilityToolBarMediaSources()
 {
-    return mQSettings->value("Global/VisibilityToolBarMediaSources", true).toBool();
+    return GetValue(&ConfigurationValues::VisibilityToolBarMediaSources);
 }
 
 bool Configuration::GetVisibilityToolBarOnlineStatus()
 {
-    return mQSettings->value("Global/VisibilityToolBarOnlineStatus", true).toBool();
+    return GetValue(&ConfigurationValues::VisibilityToolBarOnlineStatus);
 }
 
 bool Configuration::GetVisibilityMenuBar()
 {
-    return mQSettings->value("Global/VisibilityMenuBar", true).toBool();
+    return GetValue(&ConfigurationValues::VisibilityMenuBar);
 }
 
 bool Configuration::GetVisibilityStatusBar()
 {
-    return mQSettings->value("Global/VisibilityStatusBar", false).toBool();
+    return GetValue(&ConfigurationValues::VisibilityStatusBar);
 }
 
 int Configuration::GetPreviewSelection()
 {
-    return mQSettings->value("PreviewDialog/Selection", 2).toInt();
+    return GetValue(&ConfigurationValues::PreviewSelection);
 }
 
 bool Configuration::GetPreviewSelectionVideo()
 {
-    return mQSettings->value("PreviewDialog/SelectionVideo", true).toBool();
+    return GetValue(&ConfigurationValues::PreviewSelectionVideo);
 }
 
 bool Configuration::GetPreviewSelectionAudio()
 {
-    return mQSettings->value("PreviewDialog/SelectionAudio", true).toBool();
+    return GetValue(&ConfigurationValues::PreviewSelectionAudio);
 }
 
 bool Configuration::GetPreviewPreBufferingActivation()
 {
-    return mQSettings->value("PreviewDialog/PreBufferingActivation", true).toBool();
+    return GetValue(&ConfigurationValues::PreviewPreBufferingActivation);
 }
 
 int Configuration::GetConfigurationSelection()
 {
-    return mQSettings->value("ConfigurationDialog/Selection", 0).toInt();
+    return GetValue(&ConfigurationValues::ConfigurationSelection);
 }
 
 bool Configuration::GetSmoothVideoPresentation()
 {
-    return mQSettings->value("Global/SmoothVideoPresentation", false).toBool();
+    return GetValue(&ConfigurationValues::SmoothVideoPresentation);
+}
+
+int Configuration::GetMediaMemoryBudget()
+{
+    return GetValue(&ConfigurationValues::MediaMemoryBudget);
 }
 
 bool Configuration::GetVisibilityBroadcastAudio()
 {
-    return mQSettings->value("Global/VisibilityBroadcastAudio", true).toBool();
+    return GetValue(&ConfigurationValues::VisibilityBroadcastAudio);
 }
 
 bool Configuration::GetVisibilityBroadcastVideo()
 {
-    return mQSettings->value("Global/VisibilityBroadcastVideo", true).toBool();
+    return GetValue(&ConfigurationValues::VisibilityBroadcastVideo);
 }
 
 bool Configuration::GetAutoUpdateCheck()
 {
-    return mQSettings->value("Global/AutomaticUpdateCheck", false).toBool();
+    return GetValue(&ConfigurationValues::AutoUpdateCheck);
 }
 
 bool Configuration::GetFeatureConferencing()
 {
-    return mQSettings->value("Global/FeatureConferencing", true).toBool();
+    return GetValue(&ConfigurationValues::FeatureConferencing);
 }
 
 bool Configuration::GetFeatureAutoLogging()
 {
-    return mQSettings->value("Global/FeatureAutoLogging", false).toBool();
+    return GetValue(&ConfigurationValues::FeatureAutoLogging);
 }
 
 QString Configuration::GetLanguage()
 {
-	return mQSettings->value("Global/Language", GetSystemLanguage()).toString();
+    QString tResult = GetValue(&ConfigurationValues::Language);
+    if (tResult.isNull())
+        tResult = GetSystemLanguage();
+    return tResult;
 }
 
 QString Configuration::GetSystemLanguage()
@@ -1206,27 +1363,33 @@ QString Configuration::GetSystemLanguage()
 
 QString Configuration::GetUserName()
 {
-    return mQSettings->value("User/UserName", QString::fromLatin1(MEETING.GetUserName().c_str())).toString();
+    QString tResult = GetValue(&ConfigurationValues::UserName);
+    if (tResult.isNull())
+        tResult = QString::fromLatin1(MEETING.GetUserName().c_str());
+    return tResult;
 }
 
 QString Configuration::GetUserMail()
 {
-    return mQSettings->value("User/UserMail", QString(MEETING.SipCreateId(MEETING.GetUserName(), QHostInfo::localHostName().toStdString()).c_str())).toString();
+    QString tResult = GetValue(&ConfigurationValues::UserMail);
+    if (tResult.isNull())
+        tResult = QString(MEETING.SipCreateId(MEETING.GetUserName(), QHostInfo::localHostName().toStdString()).c_str());
+    return tResult;
 }
 
 bool Configuration::GetVideoActivation()
 {
-    return mQSettings->value("Streaming/VideoStreamActivation", true).toBool();
+    return GetValue(&ConfigurationValues::VideoActivation);
 }
 
 bool Configuration::GetVideoRtp()
 {
-    return mQSettings->value("Streaming/VideoStreamRtp", true).toBool();
+    return GetValue(&ConfigurationValues::VideoRtp);
 }
 
 QString Configuration::GetVideoCodec()
 {
-    QString tResult = mQSettings->value("Streaming/VideoStreamCodec", QString("H.263+")).toString();
+    QString tResult = GetValue(&ConfigurationValues::VideoCodec);
     if(!MediaSourceMuxer::IsOutputCodecSupported(tResult.toStdString()))
     {
         tResult = "H.261";
@@ -1236,82 +1399,107 @@ QString Configuration::GetVideoCodec()
 
 int Configuration::GetVideoQuality()
 {
-    return mQSettings->value("Streaming/VideoStreamQuality", 10).toInt();
+    return GetValue(&ConfigurationValues::VideoQuality);
 }
 
 int Configuration::GetVideoBitRate()
 {
-    return mQSettings->value("Streaming/VideoStreamBitRate", 90 * 1024).toInt();
+    return GetValue(&ConfigurationValues::VideoBitRate);
 }
 
 int Configuration::GetVideoMaxPacketSize()
 {
-    return mQSettings->value("Streaming/VideoStreamMaxPacketSize", 1280).toInt();
+    return GetValue(&ConfigurationValues::VideoMaxPacketSize);
 }
 
 enum TransportType Configuration::GetVideoTransportType()
 {
-    return Socket::String2TransportType(mQSettings->value("Streaming/VideoStreamTransportType", QString("UDP")).toString().toStdString());
+    return GetValue(&ConfigurationValues::VideoTransportType);
 }
 
 QString Configuration::GetVideoStreamingNAPIImpl()
 {
-    return mQSettings->value("Streaming/VideoStreamNAPIImpl", QString(BERKEYLEY_SOCKETS)).toString();
+    return GetValue(&ConfigurationValues::VideoStreamingNAPIImpl);
 }
 
 QString Configuration::GetVideoResolution()
 {
-    return mQSettings->value("Streaming/VideoStreamResolution", QString("auto")).toString();
+    return GetValue(&ConfigurationValues::VideoResolution);
 }
 
 bool Configuration::GetLocalVideoSourceHFlip()
 {
-    return mQSettings->value("Capturing/HorizontallyFlipInput", false).toBool();
+    return GetValue(&ConfigurationValues::LocalVideoSourceHFlip);
 }
 
 bool Configuration::GetLocalVideoSourceVFlip()
 {
-    return mQSettings->value("Capturing/VerticallyFlipInput", false).toBool();
+    return GetValue(&ConfigurationValues::LocalVideoSourceVFlip);
+}
+
+bool Configuration::GetVideoSkipIdleFrames()
+{
+    return GetValue(&ConfigurationValues::VideoSkipIdleFrames);
+}
+
+float Configuration::GetVideoSkipIdleFramesKeepAliveFps()
+{
+    return GetValue(&ConfigurationValues::VideoSkipIdleFramesKeepAliveFps);
+}
+
+bool Configuration::GetVideoRealtimeRateControl()
+{
+    return GetValue(&ConfigurationValues::VideoRealtimeRateControl);
+}
+
+int Configuration::GetVideoVbvBufferTime()
+{
+    return GetValue(&ConfigurationValues::VideoVbvBufferTime);
+}
+
+bool Configuration::GetVideoIntraRefresh()
+{
+    return GetValue(&ConfigurationValues::VideoIntraRefresh);
 }
 
 QString Configuration::GetLocalVideoSource()
 {
-    return mQSettings->value("Capturing/LocalVideoDevice", QString("auto")).toString();
+    return GetValue(&ConfigurationValues::LocalVideoSource);
 }
 
 int Configuration::GetVideoFps()
 {
-    return mQSettings->value("Streaming/VideoFps", 0).toInt();
+    return GetValue(&ConfigurationValues::VideoFps);
 }
 
 bool Configuration::GetAudioActivation()
 {
-    return mQSettings->value("Streaming/AudioStreamActivation", true).toBool();
+    return GetValue(&ConfigurationValues::AudioActivation);
 }
 
 bool Configuration::GetAudioActivationPushToTalk()
 {
-    return mQSettings->value("Streaming/AudioStreamActivationPushToTalk", false).toBool();
+    return GetValue(&ConfigurationValues::AudioActivationPushToTalk);
 }
 
 bool Configuration::GetAudioSkipSilence()
 {
-    return mQSettings->value("Streaming/AudioStreamSkipSilence", false).toBool();
+    return GetValue(&ConfigurationValues::AudioSkipSilence);
 }
 
 int Configuration::GetAudioSkipSilenceThreshold()
 {
-    return mQSettings->value("Streaming/AudioStreamSkipSilenceThreshold", 128).toInt();
+    return GetValue(&ConfigurationValues::AudioSkipSilenceThreshold);
 }
 
 bool Configuration::GetAudioRtp()
 {
-    return mQSettings->value("Streaming/AudioStreamRtp", true).toBool();
+    return GetValue(&ConfigurationValues::AudioRtp);
 }
 
 QString Configuration::GetAudioCodec()
 {
-    QString tResult = mQSettings->value("Streaming/AudioStreamCodec", QString("G722 adpcm")).toString();
+    QString tResult = GetValue(&ConfigurationValues::AudioCodec);
     if(!MediaSourceMuxer::IsOutputCodecSupported(tResult.toStdString()))
     {
         tResult = "G722 adpcm";
@@ -1321,264 +1509,310 @@ QString Configuration::GetAudioCodec()
 
 int Configuration::GetAudioBitRate()
 {
-    return mQSettings->value("Streaming/AudioStreamBitRate", 256 * 1024).toInt();
+    return GetValue(&ConfigurationValues::AudioBitRate);
 }
 
 int Configuration::GetAudioMaxPacketSize()
 {
-    return mQSettings->value("Streaming/AudioStreamMaxPacketSize", 1280).toInt();
+    return GetValue(&ConfigurationValues::AudioMaxPacketSize);
 }
 
 enum TransportType Configuration::GetAudioTransportType()
 {
-    return Socket::String2TransportType(mQSettings->value("Streaming/AudioStreamTransportType", QString("UDP")).toString().toStdString());
+    return GetValue(&ConfigurationValues::AudioTransportType);
 }
 
 QString Configuration::GetAudioStreamingNAPIImpl()
 {
-    return mQSettings->value("Streaming/AudioStreamNAPIImpl", QString(BERKEYLEY_SOCKETS)).toString();
+    return GetValue(&ConfigurationValues::AudioStreamingNAPIImpl);
 }
 
 enum TransportType Configuration::GetAppDataTransportType()
 {
-    return Socket::String2TransportType(mQSettings->value("Network/AppDataTransportType", QString("UDP")).toString().toStdString());
+    return GetValue(&ConfigurationValues::AppDataTransportType);
 }
 
 QString Configuration::GetAppDataNAPIImpl()
 {
-    return mQSettings->value("Network/AppDataNAPIImpl", QString(BERKEYLEY_SOCKETS)).toString();
+    return GetValue(&ConfigurationValues::AppDataNAPIImpl);
 }
 
 int Configuration::GetVideoAudioStartPort()
 {
-    return mQSettings->value("Network/VideoAudioListenerStartPort", 5000).toInt();
+    return GetValue(&ConfigurationValues::VideoAudioStartPort);
 }
 
 QString Configuration::GetLocalAudioSource()
 {
-    return mQSettings->value("Capturing/LocalAudioDevice", QString("auto")).toString();
+    return GetValue(&ConfigurationValues::LocalAudioSource);
 }
 
 QString Configuration::GetLocalAudioSink()
 {
-    return mQSettings->value("Playback/LocalAudioDevice", QString("auto")).toString();
+    return GetValue(&ConfigurationValues::LocalAudioSink);
 }
 
 bool Configuration::GetAVSyncDuringConference()
 {
-    return mQSettings->value("Playback/AVSyncDuringConference", false).toBool();
+    return GetValue(&ConfigurationValues::AVSyncDuringConference);
 }
 
 double Configuration::GetPreBufferTimeDuringConference()
 {
-    return mQSettings->value("Playback/PreBufferTimeDuringConference", CONF_AV_DEFAULT_CONFERENCE_PRE_BUFFER).toDouble();
+    return GetValue(&ConfigurationValues::PreBufferTimeDuringConference);
 }
 
 int Configuration::GetSipStartPort()
 {
-    return mQSettings->value("Network/SipListenerStartPort", 5060).toInt();
+    return GetValue(&ConfigurationValues::SipStartPort);
 }
 
 QString Configuration::GetSipUserName()
 {
-    return mQSettings->value("Network/SipUserName", QString::fromLatin1(MEETING.GetUserName().c_str())).toString();
+    QString tResult = GetValue(&ConfigurationValues::SipUserName);
+    if (tResult.isNull())
+        tResult = QString::fromLatin1(MEETING.GetUserName().c_str());
+    return tResult;
 }
 
 QString Configuration::GetSipPassword()
 {
-    return mQSettings->value("Network/SipPassword", QString("")).toString();
+    return GetValue(&ConfigurationValues::SipPassword);
 }
 
 QString Configuration::GetSipServer()
 {
-    return mQSettings->value("Network/SipServer", QString("sip2sip.info")).toString();
+    return GetValue(&ConfigurationValues::SipServer);
 }
 
 int Configuration::GetSipServerPort()
 {
-    return mQSettings->value("Network/SipServerPort", 5060).toInt();
+    return GetValue(&ConfigurationValues::SipServerPort);
 }
 
 bool Configuration::GetSipContactsProbing()
 {
-    return mQSettings->value("Network/ContactsProbing", true).toBool();
+    return GetValue(&ConfigurationValues::SipContactsProbing);
 }
 
 bool Configuration::GetSipUnknownContactsProbing()
 {
-    return mQSettings->value("Network/UnknownContactsProbing", true).toBool();
+    return GetValue(&ConfigurationValues::SipUnknownContactsProbing);
 }
 
 int Configuration::GetSipInfrastructureMode()
 {
-    return mQSettings->value("Network/SipInfrastructureMode", 0).toInt();
+    return GetValue(&ConfigurationValues::SipInfrastructureMode);
 }
 
 bool Configuration::GetNatSupportActivation()
 {
-    return mQSettings->value("Network/NatSupportActivation", true).toBool();
+    return GetValue(&ConfigurationValues::NatSupportActivation);
+}
+
+bool Configuration::GetMediaBundlingActivation()
+{
+    return GetValue(&ConfigurationValues::MediaBundlingActivation);
+}
+
+bool Configuration::GetMediaLoopbackActivation()
+{
+    return GetValue(&ConfigurationValues::MediaLoopbackActivation);
 }
 
 QString Configuration::GetStunServer()
 {
-    return mQSettings->value("Network/StunServer", QString("stun.voipbuster.com")).toString();
+    return GetValue(&ConfigurationValues::StunServer);
 }
 
 QString Configuration::GetStartSoundFile()
 {
-    return mQSettings->value("Notification/StartSoundFile", mAbsBinPath + "sounds/Start.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::StartSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Start.wav";
+    return tResult;
 }
 
 bool Configuration::GetStartSound()
 {
-    return mQSettings->value("Notification/StartSound", false).toBool();
+    return GetValue(&ConfigurationValues::StartSound);
 }
 
 bool Configuration::GetStartSystray()
 {
-    return mQSettings->value("Notification/StartSystray", true).toBool();
+    return GetValue(&ConfigurationValues::StartSystray);
 }
 
 QString Configuration::GetStopSoundFile()
 {
-    return mQSettings->value("Notification/StopSoundFile", mAbsBinPath + "sounds/Stop.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::StopSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Stop.wav";
+    return tResult;
 }
 
 bool Configuration::GetStopSound()
 {
-    return mQSettings->value("Notification/StopSound", false).toBool();
+    return GetValue(&ConfigurationValues::StopSound);
 }
 
 bool Configuration::GetStopSystray()
 {
-    return mQSettings->value("Notification/StopSystray", true).toBool();
+    return GetValue(&ConfigurationValues::StopSystray);
 }
 
 QString Configuration::GetImSoundFile()
 {
-    return mQSettings->value("Notification/ImSoundFile", mAbsBinPath + "sounds/Message.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::ImSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Message.wav";
+    return tResult;
 }
 
 bool Configuration::GetImSound()
 {
-    return mQSettings->value("Notification/ImSound", false).toBool();
+    return GetValue(&ConfigurationValues::ImSound);
 }
 
 bool Configuration::GetImSystray()
 {
-    return mQSettings->value("Notification/ImSystray", true).toBool();
+    return GetValue(&ConfigurationValues::ImSystray);
 }
 
 QString Configuration::GetCallSoundFile()
 {
-    return mQSettings->value("Notification/CallSoundFile", mAbsBinPath + "sounds/Call.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::CallSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Call.wav";
+    return tResult;
 }
 
 bool Configuration::GetCallSound()
 {
-    return mQSettings->value("Notification/CallSound", false).toBool();
+    return GetValue(&ConfigurationValues::CallSound);
 }
 
 bool Configuration::GetCallSystray()
 {
-    return mQSettings->value("Notification/CallSystray", true).toBool();
+    return GetValue(&ConfigurationValues::CallSystray);
 }
 
 QString Configuration::GetCallAcknowledgeSoundFile()
 {
-    return mQSettings->value("Notification/CallAcknowledgeSoundFile", mAbsBinPath + "sounds/Call_Acknowledge.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::CallAcknowledgeSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Call_Acknowledge.wav";
+    return tResult;
 }
 
 bool Configuration::GetCallAcknowledgeSound()
 {
-    return mQSettings->value("Notification/CallAcknowledgeSound", false).toBool();
+    return GetValue(&ConfigurationValues::CallAcknowledgeSound);
 }
 
 bool Configuration::GetCallAcknowledgeSystray()
 {
-    return mQSettings->value("Notification/CallAcknowledgeSystray", true).toBool();
+    return GetValue(&ConfigurationValues::CallAcknowledgeSystray);
 }
 
 QString Configuration::GetCallDenySoundFile()
 {
-    return mQSettings->value("Notification/CallDenySoundFile", mAbsBinPath + "sounds/Call_Deny.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::CallDenySoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Call_Deny.wav";
+    return tResult;
 }
 
 bool Configuration::GetCallDenySound()
 {
-    return mQSettings->value("Notification/CallDenySound", false).toBool();
+    return GetValue(&ConfigurationValues::CallDenySound);
 }
 
 bool Configuration::GetCallDenySystray()
 {
-    return mQSettings->value("Notification/CallDenySystray", true).toBool();
+    return GetValue(&ConfigurationValues::CallDenySystray);
 }
 
 QString Configuration::GetCallHangupSoundFile()
 {
-    return mQSettings->value("Notification/CallHangupSoundFile", mAbsBinPath + "sounds/Call_Hangup.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::CallHangupSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Call_Hangup.wav";
+    return tResult;
 }
 
 bool Configuration::GetCallHangupSound()
 {
-    return mQSettings->value("Notification/CallHangupSound", false).toBool();
+    return GetValue(&ConfigurationValues::CallHangupSound);
 }
 
 bool Configuration::GetCallHangupSystray()
 {
-    return mQSettings->value("Notification/CallHangupSystray", true).toBool();
+    return GetValue(&ConfigurationValues::CallHangupSystray);
 }
 
 QString Configuration::GetErrorSoundFile()
 {
-    return mQSettings->value("Notification/ErrorSoundFile", mAbsBinPath + "sounds/Error.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::ErrorSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Error.wav";
+    return tResult;
 }
 
 bool Configuration::GetErrorSound()
 {
-    return mQSettings->value("Notification/ErrorSound", false).toBool();
+    return GetValue(&ConfigurationValues::ErrorSound);
 }
 
 bool Configuration::GetErrorSystray()
 {
-    return mQSettings->value("Notification/ErrorSystray", true).toBool();
+    return GetValue(&ConfigurationValues::ErrorSystray);
 }
 
 QString Configuration::GetRegistrationFailedSoundFile()
 {
-    return mQSettings->value("Notification/RegistrationFailedSoundFile", mAbsBinPath + "sounds/Registration_Failed.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::RegistrationFailedSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Registration_Failed.wav";
+    return tResult;
 }
 
 bool Configuration::GetRegistrationFailedSound()
 {
-    return mQSettings->value("Notification/RegistrationFailedSound", false).toBool();
+    return GetValue(&ConfigurationValues::RegistrationFailedSound);
 }
 
 bool Configuration::GetRegistrationFailedSystray()
 {
-    return mQSettings->value("Notification/RegistrationFailedSystray", true).toBool();
+    return GetValue(&ConfigurationValues::RegistrationFailedSystray);
 }
 
 QString Configuration::GetRegistrationSuccessfulSoundFile()
 {
-    return mQSettings->value("Notification/RegistrationSuccessfulSoundFile", mAbsBinPath + "sounds/Registration_Successful.wav").toString();
+    QString tResult = GetValue(&ConfigurationValues::RegistrationSuccessfulSoundFile);
+    if (tResult.isNull())
+        tResult = mAbsBinPath + "sounds/Registration_Successful.wav";
+    return tResult;
 }
 
 bool Configuration::GetRegistrationSuccessfulSound()
 {
-    return mQSettings->value("Notification/RegistrationSuccessfulSound", false).toBool();
+    return GetValue(&ConfigurationValues::RegistrationSuccessfulSound);
 }
 
 bool Configuration::GetRegistrationSuccessfulSystray()
 {
-    return mQSettings->value("Notification/RegistrationSuccessfulSystray", true).toBool();
+    return GetValue(&ConfigurationValues::RegistrationSuccessfulSystray);
 }
 
 void Configuration::Sync()
 {
     LOG(LOG_VERBOSE, "Synch. program settings with: %s", mQSettings->fileName().toStdString().c_str());
     printf("Synch. program settings with: %s\n", mQSettings->fileName().toStdString().c_str());
+    mSettingsMutex.lock();
+    WriteBack();
     mQSettings->sync();
+    mSettingsMutex.unlock();
 }
 
 bool Configuration::DebuggingEnabled()
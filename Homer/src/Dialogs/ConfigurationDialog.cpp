@@ -131,6 +131,12 @@ void ConfigurationDialog::initializeGUI()
     // add H.265 only if it is supported by the used ffmpeg version
     if(MediaSource::IsHEVCEncodingSupported())
         mCbVideoCodec->insertItem(4, "HEVC");
+
+    // add VP9 and AV1 only if a real-time capable encoder is available
+    if(MediaSource::IsVP9EncodingSupported())
+        mCbVideoCodec->addItem("VP9");
+    if(MediaSource::IsAV1EncodingSupported())
+        mCbVideoCodec->addItem("AV1");
 }
 
 int ConfigurationDialog::exec()
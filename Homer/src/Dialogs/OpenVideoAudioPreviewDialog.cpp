@@ -87,6 +87,12 @@ void OpenVideoAudioPreviewDialog::initializeGUI()
     if(MediaSource::IsHEVCDecodingSupported())
         mCbCodecVideo->insertItem(4, "HEVC");
 
+    // add VP9 and AV1 only if the decoders and their demuxers are available
+    if(MediaSource::IsVP9DecodingSupported())
+        mCbCodecVideo->addItem("VP9");
+    if(MediaSource::IsAV1DecodingSupported())
+        mCbCodecVideo->addItem("AV1");
+
     LoadConfiguration();
 }
 
@@ -53,10 +53,12 @@
 #include <MediaSourceFile.h>
 #include <MediaSourceDesktop.h>
 #include <MediaSourceLogo.h>
+#include <MediaMemoryBudget.h>
 #include <WaveOutPulseAudio.h>
 #include <Header_NetworkSimulator.h>
 #include <ProcessStatisticService.h>
 #include <Snippets.h>
+#include <HBTime.h>
 
 #if not defined(HOMER_QT5)
 	#include <QPlastiqueStyle>
@@ -74,6 +76,7 @@
 #include <QStatusBar>
 #include <QStringList>
 #include <QLabel>
+#include <QPaintEvent>
 
 using namespace Homer::Monitor;
 using namespace Homer::Multimedia;
@@ -90,6 +93,78 @@ namespace Homer { namespace Gui {
 
 bool MainWindow::mShuttingDown = false;
 bool MainWindow::mStarting = true;
+int64_t MainWindow::mProcessStartTime = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+
+StartupStage::StartupStage(MainWindow *pMainWindow, StartupStageFunction pFunction, QString pName)
+{
+    mMainWindow = pMainWindow;
+    mFunction = pFunction;
+    mName = pName;
+    mStarted = false;
+    mFinished = false;
+}
+
+StartupStage::~StartupStage()
+{
+    Finish();
+}
+
+void StartupStage::Start()
+{
+    #ifdef STARTUP_PARALLEL_STAGES
+        if (StartThread())
+        {
+            mStarted = true;
+            return;
+        }
+        LOG(LOG_WARN, "Failed to start thread for startup stage \"%s\", executing it sequentially", mName.toStdString().c_str());
+    #endif
+
+    Run();
+}
+
+bool StartupStage::IsFinished()
+{
+    bool tResult;
+
+    mFinishedMutex.lock();
+    tResult = mFinished;
+    mFinishedMutex.unlock();
+
+    return tResult;
+}
+
+void StartupStage::Finish()
+{
+    if (!mStarted)
+        return;
+
+    mFinishedMutex.lock();
+    while (!mFinished)
+        mFinishedCondition.Wait(&mFinishedMutex);
+    mFinishedMutex.unlock();
+
+    StopThread();
+    mStarted = false;
+}
+
+void* StartupStage::Run(void* pArgs)
+{
+    int64_t tStartTime = Homer::Base::Time::GetTimeStamp();
+
+    (mMainWindow->*mFunction)();
+
+    LOG(LOG_VERBOSE, "Startup stage \"%s\" took %d ms (in parallel to the GUI thread)", mName.toStdString().c_str(), (int)((Homer::Base::Time::GetTimeStamp() - tStartTime) / 1000));
+
+    mFinishedMutex.lock();
+    mFinished = true;
+    mFinishedCondition.Signal();
+    mFinishedMutex.unlock();
+
+    return NULL;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -100,6 +175,8 @@ MainWindow::MainWindow(QStringList pArguments, QString pAbsBinPath) :
     MeetingObserver()
 {
     mStartTime = QTime::currentTime();
+    mStartupStageStartTime = Homer::Base::Time::GetTimeStamp();
+    mStartupTime = (mProcessStartTime != 0) ? mProcessStartTime : mStartupStageStartTime;
     QApplication::setWindowIcon(QPixmap(":/images/LogoHomer3.png"));
 
     SVC_PROCESS_STATISTIC.AssignThreadName("Qt-MainLoop");
@@ -117,6 +194,14 @@ MainWindow::MainWindow(QStringList pArguments, QString pAbsBinPath) :
     mOverviewFileTransfersWidget = NULL;
     mOnlineStatusWidget = NULL;
     mMosaicModeActive = false;
+    mStartupPainted = false;
+    mStartupMeasurement = false;
+    mDeferredStagesInitialized = false;
+    mNetworkProbing = NULL;
+    mCaptureDeviceProbing = NULL;
+    mProbedNetworkInterface = false;
+    mProbedVideoCaptureSource = NULL;
+    mProbedAudioCaptureSource = NULL;
 
     QCoreApplication::setApplicationName("Homer");
     QCoreApplication::setApplicationVersion(HOMER_VERSION);
@@ -128,12 +213,27 @@ MainWindow::MainWindow(QStringList pArguments, QString pAbsBinPath) :
 
     //remove the self pointer
     pArguments.erase(pArguments.begin());
+    // measurement of the startup time
+    if (pArguments.contains("-MeasureStartup"))
+    {
+        mStartupMeasurement = true;
+        removeArguments(pArguments, "-MeasureStartup");
+    }
     // init program configuration
     initializeConfiguration(pArguments);
     // disabling of features
     initializeFeatureDisablers(pArguments);
+    // impairment of network transmissions
+    initializeNetworkImpairment(pArguments);
     // show ffmpeg data
     ShowFfmpegCaps(pArguments);
+    finishStartupStage("configuration");
+
+    // start the stages which don't depend on the GUI, they run in parallel to the GUI creation and are finished when their results are needed
+    mNetworkProbing = new StartupStage(this, &MainWindow::probeNetworkInterfaces, "network interfaces");
+    mCaptureDeviceProbing = new StartupStage(this, &MainWindow::probeCaptureDevices, "capture devices");
+    mNetworkProbing->Start();
+    mCaptureDeviceProbing->Start();
 
     // audio playback - start sound
     #ifndef DEBUG_VERSION
@@ -147,32 +247,30 @@ MainWindow::MainWindow(QStringList pArguments, QString pAbsBinPath) :
     initializeGUI();
     // set language
     initializeLanguage();
-    // retrieve info about network devices and init Meeting
-    initializeConferenceManagement();
-    // init audio/video muxers
+    finishStartupStage("GUI");
+    // init audio/video muxers, the capture devices are added as soon as they are probed
     initializeVideoAudioIO();
     // configure Meeting and video/audio muxers
     loadSettings();
+    finishStartupStage("video/audio I/O");
     // create additional widgets and menus
     initializeWidgetsAndMenus();
     // set coloring for GUI objects
     initializeColoring();
-    // init contact database
-    CONTACTS.Init(CONF.GetContactFile().toStdString());
     // connect signals and slots, set visibility of some GUI objects
     connectSignalsSlots();
-    // auto update check
-    triggerUpdateCheck();
+    finishStartupStage("widgets and menus");
     // init screen capturing
     initializeScreenCapturing();
     // init network simulator
     initializeNetworkSimulator(pArguments);
     // init display parameters
     inititalizeDisplayParameters(pArguments);
-    // delayed call to register at Stun and Sip server
-    QTimer::singleShot(2000, this, SLOT(RegisterAtStunSipServer()));
     ProcessRemainingArguments(pArguments);
-    mStarting = false;
+    finishStartupStage("remaining");
+    // Meeting, capture devices, contacts, update check and server registration aren't needed for the first frame: the first paint event triggers them
+    // HINT: a minimized main window isn't painted
+    QTimer::singleShot(STARTUP_TIME_BUDGET, this, SLOT(initializeDeferredStages()));
 }
 
 MainWindow::~MainWindow()
@@ -199,6 +297,11 @@ void MainWindow::LogArguments(QStringList pArguments)
     }
 }
 
+void MainWindow::SetProcessStartTime(int64_t pTime)
+{
+    mProcessStartTime = pTime;
+}
+
 void MainWindow::removeArguments(QStringList &pArguments, QString pFilter)
 {
     QString tArgument;
@@ -394,6 +497,24 @@ void MainWindow::initializeNetworkSimulator(QStringList &pArguments, bool pForce
     #endif
 }
 
+void MainWindow::initializeNetworkImpairment(QStringList &pArguments)
+{
+    // built-in deterministic impairment of datagram sockets, e.g., "-Impair=seed:1,loss:0.02,delay:50,jitter:10"
+    QStringList tImpairments = pArguments.filter("-Impair=");
+    if (tImpairments.size())
+    {
+        ImpairmentSettings tImpairmentSettings;
+        QString tDescription = tImpairments.last().remove("-Impair=");
+        if (SocketImpairment::ParseDescription(tDescription.toStdString(), tImpairmentSettings))
+        {
+            LOG(LOG_WARN, "Activating NETWORK IMPAIRMENT for datagram sockets..");
+            Socket::SetDefaultImpairment(tImpairmentSettings);
+        }else
+            LOG(LOG_ERROR, "Invalid network impairment description: %s", tDescription.toStdString().c_str());
+    }
+    removeArguments(pArguments, "-Impair=");
+}
+
 void MainWindow::inititalizeDisplayParameters(QStringList &pArguments)
 {
     unsigned int tVideoPort = 5000;
@@ -557,11 +678,132 @@ void MainWindow::initializeDebugging(QStringList &pArguments)
     LOG(LOG_VERBOSE, "#############################################");
 }
 
+void MainWindow::finishStartupStage(QString pName)
+{
+    int64_t tNow = Homer::Base::Time::GetTimeStamp();
+
+    LOG(LOG_VERBOSE, "Startup stage \"%s\" took %d ms", pName.toStdString().c_str(), (int)((tNow - mStartupStageStartTime) / 1000));
+    mStartupStageStartTime = tNow;
+}
+
+void MainWindow::paintEvent(QPaintEvent *pEvent)
+{
+    QMainWindow::paintEvent(pEvent);
+
+    if (mStartupPainted)
+        return;
+    mStartupPainted = true;
+
+    int tStartupTime = (int)((Homer::Base::Time::GetTimeStamp() - mStartupTime) / 1000);
+    if (tStartupTime > STARTUP_TIME_BUDGET)
+        LOG(LOG_WARN, "Main window was painted the first time after %d ms, the startup time budget is %d ms", tStartupTime, STARTUP_TIME_BUDGET);
+    else
+        LOG(LOG_VERBOSE, "Main window was painted the first time after %d ms", tStartupTime);
+
+    // a headless run (e.g. "-platform offscreen") reports the time and quits, the exit code tells if the budget was kept
+    if (mStartupMeasurement)
+    {
+        printf("Time from program start to first paint: %d ms, budget: %d ms\n", tStartupTime, STARTUP_TIME_BUDGET);
+        fflush(stdout);
+        exit((tStartupTime > STARTUP_TIME_BUDGET) ? 1 : 0);
+    }
+
+    // continue after the painted frame has been delivered to the window system
+    QTimer::singleShot(0, this, SLOT(initializeDeferredStages()));
+}
+
+void MainWindow::initializeDeferredStages()
+{
+    if (mDeferredStagesInitialized)
+        return;
+    mDeferredStagesInitialized = true;
+    mStartupStageStartTime = Homer::Base::Time::GetTimeStamp();
+
+    LOG(LOG_VERBOSE, "Initialization of deferred stages..");
+    // init Meeting based on the found network devices
+    mNetworkProbing->Finish();
+    delete mNetworkProbing;
+    mNetworkProbing = NULL;
+    initializeConferenceManagement();
+    // init contact database
+    CONTACTS.Init(CONF.GetContactFile().toStdString());
+    // auto update check
+    triggerUpdateCheck();
+    // delayed call to register at Stun and Sip server
+    QTimer::singleShot(STARTUP_REGISTRATION_DELAY, this, SLOT(RegisterAtStunSipServer()));
+    // add the capture devices without blocking the GUI thread
+    checkCaptureDeviceProbing();
+    finishStartupStage("deferred");
+    mStarting = false;
+}
+
+void MainWindow::checkCaptureDeviceProbing()
+{
+    if (mCaptureDeviceProbing == NULL)
+        return;
+
+    if (mCaptureDeviceProbing->IsFinished())
+        finishCaptureDeviceProbing();
+    else
+        QTimer::singleShot(STARTUP_PROBING_CHECK_PERIOD, this, SLOT(checkCaptureDeviceProbing()));
+}
+
+void MainWindow::finishCaptureDeviceProbing()
+{
+    if (mCaptureDeviceProbing == NULL)
+        return;
+
+    // blocks only if the capture devices are used before their probing has finished
+    mCaptureDeviceProbing->Finish();
+    delete mCaptureDeviceProbing;
+    mCaptureDeviceProbing = NULL;
+
+    LOG(LOG_VERBOSE, "Adding probed capture devices..");
+    // the capture devices are preferred for "auto" device selection
+    if (mProbedVideoCaptureSource != NULL)
+        mOwnVideoMuxer->RegisterMediaSource(mProbedVideoCaptureSource, true);
+    if (mProbedAudioCaptureSource != NULL)
+        mOwnAudioMuxer->RegisterMediaSource(mProbedAudioCaptureSource, true);
+    if (!mShuttingDown)
+        selectCaptureDevices();
+}
+
+void MainWindow::probeNetworkInterfaces()
+{
+    LOG(LOG_VERBOSE, "Probing network interfaces..");
+    mProbedLocalSourceIp = "";
+    mProbedLocalLoopIp = "";
+    mProbedNetworkInterface = GetNetworkInfo(mLocalAddresses, mLocalAddressesNetmask, mProbedLocalSourceIp, mProbedLocalLoopIp);
+}
+
+void MainWindow::probeCaptureDevices()
+{
+    LOG(LOG_VERBOSE, "Probing capture devices..");
+
+    // the creation of a device source includes the enumeration of the available devices
+    #ifdef LINUX
+        mProbedVideoCaptureSource = new MediaSourceV4L2();
+    #endif
+    // DirectShow relies on COM, which is initialized only for the GUI thread, hence it is created in initializeVideoAudioIO()
+
+    if (CONF.AudioCaptureEnabled())
+    {
+		#if defined(LINUX) && FEATURE_PULSEAUDIO
+            if (!(WaveOutPulseAudio::PulseAudioAvailable()))
+                mProbedAudioCaptureSource = new MediaSourcePortAudio();
+            else
+                mProbedAudioCaptureSource = new MediaSourcePulseAudio();
+		#else
+            mProbedAudioCaptureSource = new MediaSourcePortAudio();
+		#endif
+    }
+}
+
 void MainWindow::initializeConferenceManagement()
 {
-    QString tLocalSourceIp = "";
-    QString tLocalLoopIp = "";
-    bool tInterfaceFound = GetNetworkInfo(mLocalAddresses, mLocalAddressesNetmask, tLocalSourceIp, tLocalLoopIp);
+    QString tLocalSourceIp = mProbedLocalSourceIp;
+    QString tLocalLoopIp = mProbedLocalLoopIp;
+    bool tInterfaceFound = mProbedNetworkInterface;
 
     LOG(LOG_VERBOSE, "Initialization of conference management..");
     if (!tInterfaceFound)
@@ -612,9 +854,7 @@ void MainWindow::initializeVideoAudioIO()
     // ############################
     LOG(LOG_VERBOSE, "Creating video media objects..");
     mOwnVideoMuxer = new MediaSourceMuxer();
-    #ifdef LINUX
-        mOwnVideoMuxer->RegisterMediaSource(new MediaSourceV4L2());
-    #endif
+    // the probed capture devices are added by finishCaptureDeviceProbing()
     #ifdef WIN32
         mOwnVideoMuxer->RegisterMediaSource(new MediaSourceDShow());
     #endif
@@ -631,17 +871,6 @@ void MainWindow::initializeVideoAudioIO()
     // ############################
     LOG(LOG_VERBOSE, "Creating audio media objects..");
     mOwnAudioMuxer = new MediaSourceMuxer();
-    if (CONF.AudioCaptureEnabled())
-    {
-		#if defined(LINUX) && FEATURE_PULSEAUDIO
-            if (!(WaveOutPulseAudio::PulseAudioAvailable()))
-                mOwnAudioMuxer->RegisterMediaSource(new MediaSourcePortAudio());
-            else
-                mOwnAudioMuxer->RegisterMediaSource(new MediaSourcePulseAudio());
-		#else
-        	mOwnAudioMuxer->RegisterMediaSource(new MediaSourcePortAudio());
-		#endif
-    }
 }
 
 void MainWindow::initializeColoring()
@@ -950,6 +1179,15 @@ void MainWindow::loadSettings()
     MEETING.SetAudioCodec(SDP::GetSDPCodecIDFromGuiName(tAudioStreamCodec.toStdString()));
     MEETING.SetAudioTransportType(MEDIA_TRANSPORT_RTP_UDP); // always use RTP/AVP as profile (RTP/UDP)
 
+    // audio and video of a participant share one port
+    MEETING.SetMediaBundling(CONF.GetMediaBundlingActivation());
+
+    // media streams between endpoints of this process bypass the network stack
+    MEETING.SetMediaLoopback(CONF.GetMediaLoopbackActivation());
+
+    // limit the memory of all media buffers
+    SVC_MEDIA_MEMORY_BUDGET.SetBudget((int64_t)CONF.GetMediaMemoryBudget() * 1024 * 1024);
+
     LOG(LOG_VERBOSE, "..video/audio settings");
     QString tVideoStreamResolution = CONF.GetVideoResolution();
 
@@ -957,27 +1195,41 @@ void MainWindow::loadSettings()
     MediaSource::VideoString2Resolution(tVideoStreamResolution.toStdString(), tX, tY);
 
     // init video muxer
+    mOwnVideoMuxer->SetRealtimeRateControl(CONF.GetVideoRealtimeRateControl(), CONF.GetVideoVbvBufferTime(), CONF.GetVideoIntraRefresh());
     mOwnVideoMuxer->SetOutputStreamPreferences(tVideoStreamCodec.toStdString(), CONF.GetVideoQuality(), CONF.GetVideoBitRate(), CONF.GetVideoMaxPacketSize(), false, tX, tY, CONF.GetVideoFps());
     mOwnVideoMuxer->SetRelayActivation(CONF.GetVideoActivation());
+    mOwnVideoMuxer->SetVideoFlipping(CONF.GetLocalVideoSourceHFlip(), CONF.GetLocalVideoSourceVFlip());
+    mOwnVideoMuxer->SetRelaySkipIdleFrames(CONF.GetVideoSkipIdleFrames());
+    mOwnVideoMuxer->SetRelaySkipIdleFramesKeepAliveFps(CONF.GetVideoSkipIdleFramesKeepAliveFps());
+    // the configured device is selected after the capture devices are probed, until then we show the logo
+    bool tNewDeviceSelected = false;
+    mOwnVideoMuxer->SelectDevice(MEDIA_SOURCE_HOMER_LOGO, MEDIA_VIDEO, tNewDeviceSelected);
+
+    // init audio muxer
+    mOwnAudioMuxer->SetOutputStreamPreferences(tAudioStreamCodec.toStdString(), 100, CONF.GetAudioBitRate(), CONF.GetAudioMaxPacketSize(), false, 0, 0);
+    mOwnAudioMuxer->SetRelayActivation(CONF.GetAudioActivation() && !CONF.GetAudioActivationPushToTalk());
+    mOwnAudioMuxer->SetRelaySkipSilence(CONF.GetAudioSkipSilence());
+    mOwnAudioMuxer->SetRelaySkipSilenceThreshold(CONF.GetAudioSkipSilenceThreshold());
+}
+
+void MainWindow::selectCaptureDevices()
+{
+    LOG(LOG_VERBOSE, "Selecting configured capture devices..");
+
     bool tNewDeviceSelected = false;
     QString tLastVideoSource = CONF.GetLocalVideoSource();
     if (tLastVideoSource == "auto")
         tLastVideoSource = MEDIA_SOURCE_HOMER_LOGO;
     mOwnVideoMuxer->SelectDevice(tLastVideoSource.toStdString(), MEDIA_VIDEO, tNewDeviceSelected);
     // if former selected device isn't available we use one of the available instead
-    if (!tNewDeviceSelected)
+    // HINT: the logo was already selected by loadSettings(), hence its re-selection doesn't result in a new device
+    if ((!tNewDeviceSelected) && (tLastVideoSource != MEDIA_SOURCE_HOMER_LOGO))
     {
         ShowWarning("Video device not available", "Can't use formerly selected video device: \"" + CONF.GetLocalVideoSource() + "\", will use one of the available devices instead!");
         CONF.SetLocalVideoSource("auto");
         mOwnVideoMuxer->SelectDevice("auto", MEDIA_VIDEO, tNewDeviceSelected);
     }
-    mOwnVideoMuxer->SetVideoFlipping(CONF.GetLocalVideoSourceHFlip(), CONF.GetLocalVideoSourceVFlip());
 
-    // init audio muxer
-    mOwnAudioMuxer->SetOutputStreamPreferences(tAudioStreamCodec.toStdString(), 100, CONF.GetAudioBitRate(), CONF.GetAudioMaxPacketSize(), false, 0, 0);
-    mOwnAudioMuxer->SetRelayActivation(CONF.GetAudioActivation() && !CONF.GetAudioActivationPushToTalk());
-    mOwnAudioMuxer->SetRelaySkipSilence(CONF.GetAudioSkipSilence());
-    mOwnAudioMuxer->SetRelaySkipSilenceThreshold(CONF.GetAudioSkipSilenceThreshold());
     mOwnAudioMuxer->SelectDevice(CONF.GetLocalAudioSource().toStdString(), MEDIA_AUDIO, tNewDeviceSelected);
     // if former selected device isn't available we use one of the available instead
     if (!tNewDeviceSelected)
@@ -1012,6 +1264,9 @@ void MainWindow::closeEvent(QCloseEvent* pEvent)
 
     LOG(LOG_VERBOSE, "Got signal for closing main window");
 
+    // the muxers take over the probed capture sources and delete them below
+    finishCaptureDeviceProbing();
+
     // audio playback - stop sound
     #ifndef DEBUG_VERSION
         if (CONF.GetStopSound())
@@ -1648,7 +1903,7 @@ void MainWindow::customEvent(QEvent* pEvent)
                         tKnownParticipant = true;
                         if (tCMUEvent->SenderName.size())
                             tParticipantWidget->UpdateParticipantName(QString(tCMUEvent->SenderName.c_str()));
-                        tParticipantWidget->HandleMediaUpdate(tCMUEvent->IsIncomingEvent, QString(tCMUEvent->RemoteAudioAddress.c_str()), tCMUEvent->RemoteAudioPort, QString(tCMUEvent->RemoteAudioCodec.c_str()), tCMUEvent->NegotiatedRTPAudioPayloadID, QString(tCMUEvent->RemoteVideoAddress.c_str()), tCMUEvent->RemoteVideoPort, QString(tCMUEvent->RemoteVideoCodec.c_str()), tCMUEvent->NegotiatedRTPVideoPayloadID);
+                        tParticipantWidget->HandleMediaUpdate(tCMUEvent->IsIncomingEvent, QString(tCMUEvent->RemoteAudioAddress.c_str()), tCMUEvent->RemoteAudioPort, QString(tCMUEvent->RemoteAudioCodec.c_str()), tCMUEvent->NegotiatedRTPAudioPayloadID, QString(tCMUEvent->RemoteVideoAddress.c_str()), tCMUEvent->RemoteVideoPort, QString(tCMUEvent->RemoteVideoCodec.c_str()), tCMUEvent->NegotiatedRTPVideoPayloadID, tCMUEvent->NegotiatedAudioPacketizationTime, tCMUEvent->NegotiatedAudioMaxPacketizationTime);
                     }
                     break;
         case REGISTRATION:
@@ -1847,11 +2102,13 @@ void MainWindow::DeleteParticipantSession(ParticipantWidget *pParticipantWidget)
 
 MediaSourceMuxer* MainWindow::GetVideoMuxer()
 {
+    finishCaptureDeviceProbing();
     return mOwnVideoMuxer;
 }
 
 MediaSourceMuxer* MainWindow::GetAudioMuxer()
 {
+    finishCaptureDeviceProbing();
     return mOwnAudioMuxer;
 }
 
@@ -1891,6 +2148,9 @@ void MainWindow::actionConfiguration()
 {
     bool tFormerStateMeetingProbeContacts = CONF.GetSipContactsProbing();
 
+    // the dialog lists the capture devices
+    finishCaptureDeviceProbing();
+
     ConfigurationDialog tConfigurationDialog(this, mLocalAddresses, mLocalUserParticipantWidget->GetVideoWorker(), mLocalUserParticipantWidget->GetAudioWorker());
 
     // inform the whole multimedia system about new settings if user has acknowledged the dialog settings
@@ -1909,8 +2169,12 @@ void MainWindow::actionConfiguration()
         string tVideoCodec = CONF.GetVideoCodec().toStdString();
         string tAudioCodec = CONF.GetAudioCodec().toStdString();
 
+        /* memory budget */
+        SVC_MEDIA_MEMORY_BUDGET.SetBudget((int64_t)CONF.GetMediaMemoryBudget() * 1024 * 1024);
+
         /* video */
         tNeedUpdate = mOwnVideoMuxer->SetOutputStreamPreferences(tVideoCodec, CONF.GetVideoQuality(), CONF.GetVideoBitRate(), CONF.GetVideoMaxPacketSize(), false, tX, tY, CONF.GetVideoFps());
+        tNeedUpdate = mOwnVideoMuxer->SetRealtimeRateControl(CONF.GetVideoRealtimeRateControl(), CONF.GetVideoVbvBufferTime(), CONF.GetVideoIntraRefresh()) || tNeedUpdate;
         mOwnVideoMuxer->SetRelayActivation(CONF.GetVideoActivation());
         if (tNeedUpdate)
             mLocalUserParticipantWidget->GetVideoWorker()->ResetSource();
@@ -1918,6 +2182,8 @@ void MainWindow::actionConfiguration()
         //tNeedUpdate =
                 //mOwnVideoMuxer->SelectDevice(CONF.GetLocalVideoSource().toStdString(), MEDIA_VIDEO);// || tNeedUpdate;
         mOwnVideoMuxer->SetVideoFlipping(CONF.GetLocalVideoSourceHFlip(), CONF.GetLocalVideoSourceVFlip());
+        mOwnVideoMuxer->SetRelaySkipIdleFrames(CONF.GetVideoSkipIdleFrames());
+        mOwnVideoMuxer->SetRelaySkipIdleFramesKeepAliveFps(CONF.GetVideoSkipIdleFramesKeepAliveFps());
         if (tNeedUpdate)
         {
             LOG(LOG_VERBOSE, "Local user's video source should have a settings update with reset");
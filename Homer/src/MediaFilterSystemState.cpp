@@ -26,6 +26,7 @@
 
 #include <QImage>
 #include <QPainter>
+#include <QFontMetrics>
 #include <QDate>
 #include <QTime>
 
@@ -46,6 +47,15 @@ MediaFilterSystemState::MediaFilterSystemState(MediaSource *pMediaSource):
 
 {
     mMediaId = "Date";
+    mOverlayValid = false;
+    mResX = 0;
+    mResY = 0;
+    mFontAscent = 0;
+    mTimePosX = 0;
+    mTimePosY = 0;
+    mTimeSecond = -1;
+    mDatePosX = 0;
+    mDatePosY = 0;
 }
 
 MediaFilterSystemState::~MediaFilterSystemState()
@@ -54,32 +64,97 @@ MediaFilterSystemState::~MediaFilterSystemState()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void MediaFilterSystemState::ChunkFormatChanged(int pResX, int pResY, unsigned int pChunkBufferSize)
+{
+    mOverlayValid = false;
+    if ((pResX <= 0) || (pResY <= 0) || (pChunkBufferSize < (unsigned int)(pResX * pResY * 4)))
+    {
+        LOG(LOG_WARN, "Chunk of %u bytes isn't an RGB32 picture of %d*%d, overlay deactivated", pChunkBufferSize, pResX, pResY);
+        return;
+    }
+
+    mResX = pResX;
+    mResY = pResY;
+
+    float tScalingFactor = ((float)pResY / 400);
+    mFont = QFont("Arial", 8 * tScalingFactor, QFont::Normal);
+    mFont.setFixedPitch(true);
+    QFontMetrics tMetrics(mFont);
+    mFontAscent = tMetrics.ascent();
+
+    // one additional pixel for the shadow
+    mTimeOverlay = QImage(tMetrics.width("00:00:00") + 2, tMetrics.height() + 1, QImage::Format_ARGB32);
+    mTimePosX = pResX - 60 * tScalingFactor - 1;
+    mTimePosY = 20 * tScalingFactor - 1 - mFontAscent;
+    mTimeSecond = -1;
+
+    mDateOverlay = QImage(tMetrics.width("00.00.0000") + 2, tMetrics.height() + 1, QImage::Format_ARGB32);
+    mDatePosX = pResX - 70 * tScalingFactor - 1;
+    mDatePosY = pResY - 10 * tScalingFactor - 1 - mFontAscent;
+    mDate = QDate();
+
+    mOverlayValid = true;
+}
+
+void MediaFilterSystemState::RenderOverlay(QImage &pOverlay, QString pText)
+{
+    pOverlay.fill(0);
+
+    QPainter tPainter(&pOverlay);
+    tPainter.setRenderHint(QPainter::TextAntialiasing, false);
+    tPainter.setFont(mFont);
+    tPainter.setPen(QColor(Qt::black));
+    tPainter.drawText(1, mFontAscent + 1, pText);
+    tPainter.setPen(QColor(Qt::white));
+    tPainter.drawText(0, mFontAscent, pText);
+}
+
+void MediaFilterSystemState::BlendOverlay(char* pChunkBuffer, const QImage &pOverlay, int pPosX, int pPosY)
+{
+    uint32_t *tPicture = (uint32_t*)pChunkBuffer;
+
+    // text is drawn without antialiasing, hence each overlay pixel is either transparent or opaque
+    for (int y = 0; y < pOverlay.height(); y++)
+    {
+        int tY = pPosY + y;
+        if ((tY < 0) || (tY >= mResY))
+            continue;
+
+        const QRgb *tLine = (const QRgb*)pOverlay.constScanLine(y);
+        uint32_t *tTarget = tPicture + tY * mResX;
+        for (int x = 0; x < pOverlay.width(); x++)
+        {
+            int tX = pPosX + x;
+            if ((tX >= 0) && (tX < mResX) && (qAlpha(tLine[x]) != 0))
+                tTarget[tX] = tLine[x] | 0xFF000000;
+        }
+    }
+}
+
 void MediaFilterSystemState::FilterChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkbufferNumber, AVStream *pStream, bool pIsKeyFrame)
 {
-    int tResX;
-    int tResY;
-    mMediaSource->GetVideoGrabResolution(tResX, tResY);
-
-    //LOG(LOG_VERBOSE, "Got %d bytes of %s video chunk %"PRId64" with resolution %dx%d", pChunkBufferSize, mMediaSource->GetSourceTypeStr().c_str(), pChunkbufferNumber, tResX, tResY);
-    QImage tImage = QImage((unsigned char*)pChunkBuffer, tResX, tResY, QImage::Format_RGB32);
-    QPainter *tPainter = new QPainter(&tImage);
-
-    float tScalingFactor = ((float)tResY / 400);
-    QFont tFont = QFont("Arial", 8 * tScalingFactor, QFont::Normal);
-    tFont.setFixedPitch(true);
-    tPainter->setRenderHint(QPainter::TextAntialiasing, false);
-    tPainter->setFont(tFont);
-    QDate tDate = QDate::currentDate();
-    QTime tTime = QTime::currentTime();
-    tPainter->setPen(QColor(Qt::black));
-    tPainter->drawText(tResX - 60 * tScalingFactor, 20 * tScalingFactor, tTime.toString("hh:mm:ss"));
-    tPainter->drawText(tResX - 70 * tScalingFactor, tResY - 10 * tScalingFactor, tDate.toString("dd.MM.yyyy"));
-    tPainter->setPen(QColor(Qt::white));
-    tPainter->drawText(tResX - 60 * tScalingFactor - 1, 20 * tScalingFactor - 1, tTime.toString("hh:mm:ss"));
-    tPainter->drawText(tResX - 70 * tScalingFactor - 1, tResY - 10 * tScalingFactor - 1, tDate.toString("dd.MM.yyyy"));
+    if (!mOverlayValid)
+        return;
 
+    //LOG(LOG_VERBOSE, "Got %d bytes of %s video chunk %"PRId64" with resolution %dx%d", pChunkBufferSize, mMediaSource->GetSourceTypeStr().c_str(), pChunkbufferNumber, mResX, mResY);
 
-    delete tPainter;
+    // the text is only rendered if it changes, each frame gets the cached overlay
+    QTime tTime = QTime::currentTime();
+    if (tTime.second() != mTimeSecond)
+    {
+        mTimeSecond = tTime.second();
+        RenderOverlay(mTimeOverlay, tTime.toString("hh:mm:ss"));
+
+        QDate tDate = QDate::currentDate();
+        if (tDate != mDate)
+        {
+            mDate = tDate;
+            RenderOverlay(mDateOverlay, tDate.toString("dd.MM.yyyy"));
+        }
+    }
+
+    BlendOverlay(pChunkBuffer, mTimeOverlay, mTimePosX, mTimePosY);
+    BlendOverlay(pChunkBuffer, mDateOverlay, mDatePosX, mDatePosY);
 }
 
 }} //namespace
@@ -235,6 +235,12 @@ bool MediaSourceLogo::HasVariableOutputFrameRate()
 	return true;
 }
 
+bool MediaSourceLogo::IsVideoFrameUnchanged()
+{
+	// the same pre-rendered logo is delivered for each frame after the first one
+	return (mFrameNumber > 1);
+}
+
 int MediaSourceLogo::GrabChunk(void* pChunkBuffer, int& pChunkSize, bool pDropChunk)
 {
     // lock grabbing
@@ -567,11 +567,14 @@ QStringList AudioWidget::GetAudioInfo()
     if (mAudioSource->GetFrameBufferSize() > 0)
     {
         tLine_Fps += " (" + QString("%1").arg(mAudioSource->GetFrameBufferCounter()) + "/" + QString("%1").arg(mAudioSource->GetFrameBufferSize()) + ", " + QString("%1").arg(mAudioSource->GetFrameBufferTime(), 2, 'f', 2, (QLatin1Char)' ') + " s " + Homer::Gui::AudioWidget::tr("buffered");
-    	float tPreBufferTime = mAudioSource->GetFrameBufferPreBufferingTime();
+    	float tPreBufferTime = mAudioSource->GetFrameBufferActivePreBufferingTime();
     	if (tPreBufferTime > 0)
             tLine_Fps += " [" + QString("%1").arg(tPreBufferTime, 2, 'f', 2, (QLatin1Char)' ') + " s " + Homer::Gui::AudioWidget::tr("pre-buffer") + "])";
     	else
     	    tLine_Fps += ")";
+        int tTimeToFirstFrame = mAudioSource->GetTimeToFirstFrame();
+        if (tTimeToFirstFrame >= 0)
+            tLine_Fps += ", " + Homer::Gui::AudioWidget::tr("first frame after") + " " + QString("%1").arg(tTimeToFirstFrame) + " ms";
     }
 
     //############################################
@@ -483,7 +483,10 @@ void OverviewDataStreamsWidget::FillRow(QTableWidget *pTable, int pRow, PacketSt
     FillCellText(pTable, pRow, 3, Int2ByteExpression(tStatValues.AvgPacketSize) + " bytes");
     FillCellText(pTable, pRow, 4, Int2ByteExpression(tStatValues.ByteCount) + " bytes");
     FillCellText(pTable, pRow, 5, Int2ByteExpression(tStatValues.PacketCount));
-    FillCellText(pTable, pRow, 6, Int2ByteExpression((int64_t)tStatValues.LostPacketCount));
+    QString tLostPackets = Int2ByteExpression((int64_t)tStatValues.LostPacketCount);
+    if (tStatValues.ReceiveQueueDropCount > 0)
+        tLostPackets += " (" + Int2ByteExpression((int64_t)tStatValues.ReceiveQueueDropCount) + " dropped in socket buffer)";
+    FillCellText(pTable, pRow, 6, tLostPackets);
     FillCellText(pTable, pRow, 8, QString(pStats->GetTransportTypeStr().c_str()));
     pTable->item(pRow, 8)->setTextAlignment(Qt::AlignCenter|Qt::AlignVCenter);
     FillCellText(pTable, pRow, 9, QString(pStats->GetNetworkTypeStr().c_str()));
@@ -87,10 +87,6 @@ namespace Homer { namespace Gui {
 
 // min. time difference between two synch. processes
 #define AV_SYNC_MIN_PERIOD                                         500 // ms
-// how many times do we have to detect continuous asynch. A/V playback before we synch. audio and video? (to avoid false-positives)
-#define AV_SYNC_CONSECUTIVE_ASYNC_THRESHOLD                          3 // checked every STREAM_POS_UPDATE_DELAY ms
-// how many times should we try to adapt the A/V synch bei waiting cycles? afterwards we try a reset of both the video and audio source
-#define AV_SYNC_CONSECUTIVE_ASYNC_THRESHOLD_TRY_RESET               32
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -103,18 +99,14 @@ ParticipantWidget::ParticipantWidget(enum SessionType pSessionType, MainWindow *
     mMosaicMode = false;
     mMosaicModeAVControlsWereVisible = true;
     mMosaicModeGenericTitleWidget = NULL;
-    mLastAudioSynchronizationTimestamp = 0;
-    mLastVideoSynchronizationTimestamp = 0;
     mAVSynchActive = false;
+    mAVSynchronizer = NULL;
     mAVPreBuffering = false;
-    mAVSyncCounter = 0;
     mAVPreBufferingAutoRestart = false;
     mMainWindow = pMainWindow;
     mMovieSliderPosition = 0;
     mRemoteVideoAdr = "";
     mRemoteAudioAdr = "";
-    mAVAsyncCounterSinceLastSynchronization = 0;
-    mAVASyncCounter = 0;
     mVideoDelayAVDrift = 0;
     mRemoteVideoPort = 0;
     mRemoteAudioPort = 0;
@@ -187,6 +179,15 @@ ParticipantWidget::~ParticipantWidget()
 
     ResetMediaSinks();
 
+    if (mAVSynchronizer != NULL)
+    {
+        LOG(LOG_VERBOSE, "..destroying A/V synchronizer");
+        // returns after the video decoder thread left the synchronizer
+        if (mVideoSource != NULL)
+            mVideoSource->SetSynchronizer(NULL);
+        delete mAVSynchronizer;
+    }
+
     if (mSessionType != BROADCAST)
     {
 		LOG(LOG_VERBOSE, "..destroying video source");
@@ -259,6 +260,8 @@ ParticipantWidget* ParticipantWidget::CreatePreviewNetworkStreams(MainWindow *pM
 
 void ParticipantWidget::Init(QMenu *pVideoMenu, QMenu *pAudioMenu, QMenu *pAVControlsMenu, QMenu *pMessageMenu, MediaSourceMuxer *pVideoSourceMuxer, MediaSourceMuxer *pAudioSourceMuxer, QString pParticipant, enum TransportType pTransport)
 {
+    Socket *tBundleReceiveSocket;
+
     LOG(LOG_VERBOSE, "Initiating new participant widget for %s..", pParticipant.toStdString().c_str());
     mVideoSourceMuxer = pVideoSourceMuxer;
     mAudioSourceMuxer = pAudioSourceMuxer;
@@ -349,9 +352,11 @@ void ParticipantWidget::Init(QMenu *pVideoMenu, QMenu *pAudioMenu, QMenu *pAVCon
 					mAudioSendSocket = MEETING.GetAudioSendSocket(mSessionName.toStdString(), mSessionTransport);
 					mVideoReceiveSocket = MEETING.GetVideoReceiveSocket(mSessionName.toStdString(), mSessionTransport);
 					mAudioReceiveSocket = MEETING.GetAudioReceiveSocket(mSessionName.toStdString(), mSessionTransport);
+					tBundleReceiveSocket = MEETING.GetBundleReceiveSocket(mSessionName.toStdString(), mSessionTransport);
 					if (mVideoReceiveSocket != NULL)
 					{
-						mVideoSource = new MediaSourceNet(mVideoReceiveSocket);
+						// bundling offered: audio and video may share one socket and its receiver thread
+						mVideoSource = new MediaSourceNet(mVideoReceiveSocket, tBundleReceiveSocket);
 						mVideoSource->SetPreBufferingActivation(true);
 						mVideoSource->SetPreBufferingAutoRestartActivation(true);
 						mVideoSource->SetFrameBufferPreBufferingTime(CONF.GetPreBufferTimeDuringConference());
@@ -362,7 +367,7 @@ void ParticipantWidget::Init(QMenu *pVideoMenu, QMenu *pAudioMenu, QMenu *pAVCon
 						LOG(LOG_ERROR, "Determined video socket is NULL");
 					if (mAudioReceiveSocket != NULL)
 					{
-						mAudioSource = new MediaSourceNet(mAudioReceiveSocket);
+						mAudioSource = new MediaSourceNet(mAudioReceiveSocket, tBundleReceiveSocket);
 						mAudioSource->SetPreBufferingActivation(true);
 						mAudioSource->SetPreBufferingAutoRestartActivation(true);
 						mAudioSource->SetFrameBufferPreBufferingTime(CONF.GetPreBufferTimeDuringConference());
@@ -463,6 +468,14 @@ void ParticipantWidget::Init(QMenu *pVideoMenu, QMenu *pAudioMenu, QMenu *pAVCon
                     break;
     }
 
+    // the video presentation follows the audio clock
+    if ((mVideoSource != NULL) && (mAudioSource != NULL))
+    {
+        mAVSynchronizer = new MediaSynchronizer(mAudioSource, mSessionName.toStdString());
+        mAVSynchronizer->SetActivation(mAVSynchActive);
+        mVideoSource->SetSynchronizer(mAVSynchronizer);
+    }
+
     mSessionInfoWidget->Init(mSessionName, mSessionTransport, false);
     mSplitter->setStretchFactor(0, 1);
     mSplitter->setStretchFactor(1, 0);
@@ -1412,7 +1425,7 @@ void ParticipantWidget::HandleCallAccept(bool pIncoming)
     }
 }
 
-void ParticipantWidget::HandleMediaUpdate(bool pIncoming, QString pRemoteAudioAdr, unsigned int pRemoteAudioPort, QString pRemoteAudioCodec, unsigned int pNegotiatedRTPAudioPayloadID, QString pRemoteVideoAdr, unsigned int pRemoteVideoPort, QString pRemoteVideoCodec, unsigned int pNegotiatedRTPVideoPayloadID)
+void ParticipantWidget::HandleMediaUpdate(bool pIncoming, QString pRemoteAudioAdr, unsigned int pRemoteAudioPort, QString pRemoteAudioCodec, unsigned int pNegotiatedRTPAudioPayloadID, QString pRemoteVideoAdr, unsigned int pRemoteVideoPort, QString pRemoteVideoCodec, unsigned int pNegotiatedRTPVideoPayloadID, int pNegotiatedAudioPtime, int pNegotiatedAudioMaxPtime)
 {
     LOG(LOG_VERBOSE, "Media update");
 
@@ -1440,6 +1453,7 @@ void ParticipantWidget::HandleMediaUpdate(bool pIncoming, QString pRemoteAudioAd
         LOG(LOG_VERBOSE, "Audio sink set to %s:%u", pRemoteAudioAdr.toStdString().c_str(), pRemoteAudioPort);
         LOG(LOG_VERBOSE, "Audio sink uses codec: \"%s\"", pRemoteAudioCodec.toStdString().c_str());
         LOG(LOG_VERBOSE, "Audio sink uses payload ID: %u", pNegotiatedRTPAudioPayloadID);
+        LOG(LOG_VERBOSE, "Audio sink uses packetization time: %d ms (max.: %d ms)", pNegotiatedAudioPtime, pNegotiatedAudioMaxPtime);
 
         if ((pRemoteVideoPort != 0) && (mParticipantVideoSink == NULL))
         {
@@ -1447,11 +1461,17 @@ void ParticipantWidget::HandleMediaUpdate(bool pIncoming, QString pRemoteAudioAd
             if(pNegotiatedRTPVideoPayloadID > 0)
             	mParticipantVideoSink->SetExternallyNegotiatedPayloadID(pNegotiatedRTPVideoPayloadID);
         }
+        // packets of a bundle are routed by the negotiated payload types
+        if ((mSessionType == PARTICIPANT) && (mVideoSource != NULL) && (pNegotiatedRTPVideoPayloadID > 0))
+            ((MediaSourceNet*)mVideoSource)->SetNegotiatedPayloadId(pNegotiatedRTPVideoPayloadID);
+        if ((mSessionType == PARTICIPANT) && (mAudioSource != NULL) && (pNegotiatedRTPAudioPayloadID > 0))
+            ((MediaSourceNet*)mAudioSource)->SetNegotiatedPayloadId(pNegotiatedRTPAudioPayloadID);
         if ((pRemoteAudioPort != 0) && (mParticipantAudioSink == NULL))
         {
             mParticipantAudioSink = mAudioSourceMuxer->RegisterMediaSink(mRemoteAudioAdr.toStdString(), mRemoteAudioPort, mAudioSendSocket, true); // always use RTP/AVP profile (RTP/UDP)
             if(pNegotiatedRTPAudioPayloadID > 0)
             	mParticipantAudioSink->SetExternallyNegotiatedPayloadID(pNegotiatedRTPAudioPayloadID);
+            mParticipantAudioSink->SetAudioPacketizationTime(pNegotiatedAudioPtime, pNegotiatedAudioMaxPtime);
         }
 
         // activate the A/V media sinks
@@ -1539,12 +1559,22 @@ void ParticipantWidget::ResetAVSync()
 
     // avoid A/V sync. in the near future
     mTimeOfLastAVSynch = Time::GetTimeStamp();
-    mAVAsyncCounterSinceLastSynchronization = 0;
 }
 
 void ParticipantWidget::AVSync()
 {
     #ifdef PARTICIPANT_WIDGET_AV_SYNC
+        //############################
+        //### synch. audio and video
+        //############################
+        // the video presentation follows the audio clock, this is done by the media layer, we only update the desired A/V offset here
+        if (mAVSynchronizer != NULL)
+        {
+            mAVSynchronizer->SetActivation(mAVSynchActive);
+            if (mAudioWidget->GetWorker() != NULL)
+                mAVSynchronizer->SetTargetOffset((int64_t)((mAudioWidget->GetWorker()->GetUserAVDrift() + mAudioWidget->GetWorker()->GetVideoDelayAVDrift()) * 1000 * 1000));
+        }
+
         int64_t tCurTime = Time::GetTimeStamp();
         if ((tCurTime - mTimeOfLastAVSynch  >= AV_SYNC_MIN_PERIOD * 1000))
         {
@@ -1603,78 +1633,6 @@ void ParticipantWidget::AVSync()
 			}
 
             //HINT: we have to keep the audio buffering flexible! otherwise, the A/V synchronization won't work anymore
-
-            // only try to synch. if it is desired
-            if (!mAVSynchActive)
-                return;
-
-            //############################
-            //### synch. audio and video
-            //############################
-            // synch. video and audio by seeking in video stream based to the position of the audio stream, the other way around it would be more obvious to the user because he would hear audio gaps
-            int64_t tAudioSyncTime;
-            int64_t tVideoSyncTime;
-            double tTimeDiff = GetAVDrift(&tVideoSyncTime, &tAudioSyncTime);
-            #ifdef PARTICIPANT_WIDGET_DEBUG_AV_SYNC
-                LOG(LOG_VERBOSE, "Drift: %.2f", (float)tTimeDiff);
-            #endif
-            // is video and audio stream still active and their synch. times are still changing?
-            if ((mLastVideoSynchronizationTimestamp != tVideoSyncTime) && ((mLastAudioSynchronizationTimestamp != tAudioSyncTime) || (IsPlayingMovieFile())))
-            {// video and audio stream are still active
-                // are audio and video playback out of synch.?
-                if (((tTimeDiff < -AV_SYNC_MAX_DRIFT_UNTIL_RESYNC) || (tTimeDiff > AV_SYNC_MAX_DRIFT_UNTIL_RESYNC)))
-                {
-                    if ((mSessionType != BROADCAST) || ((!mVideoWidget->GetWorker()->EofReached()) && (!isVideoFilePaused()) && (mVideoWidget->GetWorker()->GetCurrentDevice() == mAudioWidget->GetWorker()->GetCurrentDevice())))
-                    {
-                        if (mAVAsyncCounterSinceLastSynchronization >= AV_SYNC_CONSECUTIVE_ASYNC_THRESHOLD)
-                        {
-                            if (mAVASyncCounter < AV_SYNC_CONSECUTIVE_ASYNC_THRESHOLD * (AV_SYNC_CONSECUTIVE_ASYNC_THRESHOLD_TRY_RESET + 1))
-                            {// try to adapt waiting times
-                                if (tTimeDiff > 0)
-                                    LOG(LOG_WARN, "Detected asynchronous A/V playback, drift is %f seconds (video before audio), max. allowed drift is %3.2f seconds, last synch. was at %"PRId64", synchronizing now..", tTimeDiff, AV_SYNC_MAX_DRIFT_UNTIL_RESYNC, mTimeOfLastAVSynch);
-                                else
-                                    LOG(LOG_WARN, "Detected asynchronous A/V playback, drift is %f seconds (audio before video), max. allowed drift is %3.2f seconds, last synch. was at %"PRId64", synchronizing now..", tTimeDiff, AV_SYNC_MAX_DRIFT_UNTIL_RESYNC, mTimeOfLastAVSynch);
-
-                                mAudioWidget->GetWorker()->SyncClock(mVideoSource);
-                                mAVSyncCounter++;
-                                ResetAVSync();
-                            }else
-                            {// we tried to adapt waiting times for AV_SYNC_CONTINUOUS_ASYNC_THRESHOLD_TRY_RESET times, now we try to reset the A/V media sources
-                                LOG(LOG_WARN, "Detected asynchronous A/V playback, drift is %3.2f seconds, max. allowed drift is %3.2f seconds, tried synchronization %d times, reset audio and video source now..", tTimeDiff, AV_SYNC_MAX_DRIFT_UNTIL_RESYNC, AV_SYNC_CONSECUTIVE_ASYNC_THRESHOLD_TRY_RESET);
-                                mVideoWidget->GetWorker()->ResetSource();
-                                mAudioWidget->GetWorker()->ResetSource();
-                                ResetAVSync();
-                                mAVASyncCounter = 0;
-                            }
-                        }else
-                        {
-                            mAVAsyncCounterSinceLastSynchronization++;
-                            mAVASyncCounter++;
-                            #ifdef PARTICIPANT_WIDGET_DEBUG_AV_SYNC
-                                if (tTimeDiff > 0)
-                                    LOG(LOG_WARN, "Detected asynchronous A/V playback %d times, drift is %3.2f seconds (video before audio), max. allowed drift is %3.2f seconds, last synch. was at %"PRId64, mAVAsyncCounterSinceLastSynchronization, tTimeDiff, AV_SYNC_MAX_DRIFT_UNTIL_RESYNC, mTimeOfLastAVSynch);
-                                else
-                                    LOG(LOG_WARN, "Detected asynchronous A/V playback %d times, drift is %3.2f seconds (audio before video), max. allowed drift is %3.2f seconds, last synch. was at %"PRId64, mAVAsyncCounterSinceLastSynchronization, tTimeDiff, AV_SYNC_MAX_DRIFT_UNTIL_RESYNC, mTimeOfLastAVSynch);
-                            #endif
-                        }
-                    }
-                }else
-                {
-                    #ifdef PARTICIPANT_WIDGET_DEBUG_AV_SYNC
-                        LOG(LOG_VERBOSE, "Reseting A/V synch. counter");
-                    #endif
-                    mAVASyncCounter = 0;
-                    mAVAsyncCounterSinceLastSynchronization = 0;
-                }
-                mLastAudioSynchronizationTimestamp = tAudioSyncTime;
-                mLastVideoSynchronizationTimestamp = tVideoSyncTime;
-            }else
-            {// either the video or the audio stream is broken
-                // do not try to synchronize!
-                #ifdef PARTICIPANT_WIDGET_DEBUG_AV_SYNC
-                    LOG(LOG_VERBOSE, "We don't synchronize audio and video");
-                #endif
-            }
         }
 
     #endif
@@ -2388,7 +2346,10 @@ void ParticipantWidget::UpdateAVInfo()
 			tAVStats += Homer::Gui::ParticipantWidget::tr("inactive");
 
         tAVStats += "\n     " + Homer::Gui::ParticipantWidget::tr("A/V synchronizations:") + " ";
-		tAVStats += QString("%1").arg(mAVSyncCounter);
+		if (mAVSynchronizer != NULL)
+		    tAVStats += QString("%1").arg(mAVSynchronizer->GetAdjustmentCounter()) + " (" + QString("%1").arg(mAVSynchronizer->GetResynchronizationCounter()) + " " + Homer::Gui::ParticipantWidget::tr("re-synchronizations") + ", " + Homer::Gui::ParticipantWidget::tr("residual offset:") + " " + QString("%1").arg(mAVSynchronizer->GetOffset() * 1000, 0, 'f', 1) + " ms)";
+		else
+		    tAVStats += "0";
 
 		tAVStats += "\n\n";
 
@@ -209,6 +209,8 @@ VideoWidget::VideoWidget(QWidget* pParent):
     mMainWindow = NULL;
     mAssignedAction = NULL;
     mSmoothPresentation = CONF.GetSmoothVideoPresentation();
+    mPreventScreensaver = CONF.GetPreventScreensaverInFullscreenMode();
+    CONF.AddObserver(this);
     mSystemStatePresentation = false;
     parentWidget()->hide();
     hide();
@@ -276,6 +278,8 @@ VideoWidget::~VideoWidget()
 {
     LOG(LOG_VERBOSE, "Going to destroy video widget..");
 
+    CONF.RemoveObserver(this);
+
     if (mTimerId != -1)
         killTimer(mTimerId);
 
@@ -308,6 +312,11 @@ VideoWidget::~VideoWidget()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void VideoWidget::ConfigurationChanged(unsigned int /* pRevision */)
+{
+    mPreventScreensaver = CONF.GetPreventScreensaverInFullscreenMode();
+}
+
 int64_t sLastSendActivityToSystem = 0;
 void VideoWidget::SendActivityToSystem()
 {
@@ -842,11 +851,14 @@ QStringList VideoWidget::GetVideoInfo()
     if (mVideoSource->GetFrameBufferSize() > 0)
     {
     	tLine_Fps += " (" + QString("%1").arg(mVideoSource->GetFrameBufferCounter()) + "/" + QString("%1").arg(mVideoSource->GetFrameBufferSize()) + ", " + QString("%1").arg(mVideoSource->GetFrameBufferTime(), 2, 'f', 2, (QLatin1Char)' ') + " s " + Homer::Gui::VideoWidget::tr("buffered");
-    	float tPreBufferTime = mVideoSource->GetFrameBufferPreBufferingTime();
+    	float tPreBufferTime = mVideoSource->GetFrameBufferActivePreBufferingTime();
     	if (tPreBufferTime > 0)
     	    tLine_Fps += " [" + QString("%1").arg(tPreBufferTime, 2, 'f', 2, (QLatin1Char)' ') + " s " + Homer::Gui::VideoWidget::tr("pre-buffer") + "])";
     	else
     	    tLine_Fps += ")";
+    	int tTimeToFirstFrame = mVideoSource->GetTimeToFirstFrame();
+    	if (tTimeToFirstFrame >= 0)
+    	    tLine_Fps += ", " + Homer::Gui::VideoWidget::tr("first frame after") + " " + QString("%1").arg(tTimeToFirstFrame) + " ms";
     }
 
     //############################################
@@ -909,6 +921,11 @@ QStringList VideoWidget::GetVideoInfo()
     {
         tLine_OutputCodec = Homer::Gui::VideoWidget::tr("Streaming codec:")+ " " + ((tMuxCodecName != "") ? tMuxCodecName : Homer::Gui::VideoWidget::tr("unknown")) + " (" + QString("%1").arg(tMuxResX) + "*" + QString("%1").arg(tMuxResY);
         tLine_OutputCodec += ", " + QString("%1").arg(mVideoSource->GetEncoderBufferedFrames()) + " " + Homer::Gui::VideoWidget::tr("frames buffered");
+        MediaSourceMuxer *tMuxer = (MediaSourceMuxer*)mVideoSource;
+        if (tMuxer->GetRelaySkipIdleFramesSkippedFrames() > 0)
+            tLine_OutputCodec += ", " + QString("%1").arg(tMuxer->GetRelaySkipIdleFramesSkippedFrames()) + " " + Homer::Gui::VideoWidget::tr("idle frames skipped") + (tMuxer->IsRelayIdle() ? " (" + Homer::Gui::VideoWidget::tr("idle") + ")" : QString(""));
+        if (tMuxer->GetEncodedFrameSizePeak() > 0)
+            tLine_OutputCodec += ", " + Homer::Gui::VideoWidget::tr("frame size") + " " + QString("%1").arg(tMuxer->GetEncodedFrameSizeAverage()) + "+-" + QString("%1").arg(tMuxer->GetEncodedFrameSizeDeviation()) + " " + Homer::Gui::VideoWidget::tr("bytes") + " (" + Homer::Gui::VideoWidget::tr("peak") + " " + QString("%1").arg(tMuxer->GetEncodedFrameSizePeak()) + ")";
         tLine_OutputCodec += (mVideoSource->GetMuxingBufferCounter() ? (", " + QString("%1").arg(mVideoSource->GetMuxingBufferCounter()) + "/" + QString("%1").arg(mVideoSource->GetMuxingBufferSize()) + " " + Homer::Gui::VideoWidget::tr("buffered frames") + ")") : ")");
     }
 
@@ -943,6 +960,13 @@ QStringList VideoWidget::GetVideoInfo()
         tLine_RecorderTime = Homer::Gui::VideoWidget::tr("Recorded:") + "  " + QString("%1:%2:%3").arg(tHour, 2, 10, (QLatin1Char)'0').arg(tMin, 2, 10, (QLatin1Char)'0').arg(tSec, 2, 10, (QLatin1Char)'0');
     }
 
+    //############################################
+    //### Line 10: memory usage of the media stream
+    QString tLine_Memory = "";
+    int64_t tMemoryUsage = mVideoSource->GetMemoryUsage();
+    if (tMemoryUsage > 0)
+        tLine_Memory = Homer::Gui::VideoWidget::tr("Memory:") + " " + QString("%1 MB").arg((double)tMemoryUsage / 1024 / 1024, 2, 'f', 1, (QLatin1Char)' ') + (mVideoSource->IsBackground() ? " (" + Homer::Gui::VideoWidget::tr("background") + ")" : "");
+
 
     //derive resulting video statistic
     if (tLine_Source != "")
@@ -963,6 +987,8 @@ QStringList VideoWidget::GetVideoInfo()
         tVideoInfo += tLine_Peer;
     if (tLine_RecorderTime != "")
         tVideoInfo += tLine_RecorderTime;
+    if (tLine_Memory != "")
+        tVideoInfo += tLine_Memory;
 
     return tVideoInfo;
 }
@@ -1186,7 +1212,7 @@ void VideoWidget::ShowFrame(void* pBuffer)
     //#############################################################
     //### prevent system sleep mode
     //#############################################################
-    if (CONF.GetPreventScreensaverInFullscreenMode())
+    if (mPreventScreensaver)
     {
         if (IsFullScreen())
             SendActivityToSystem();
@@ -1499,6 +1525,10 @@ void VideoWidget::ToggleVisibility()
 
 void VideoWidget::SetVisible(bool pVisible)
 {
+    // hidden video streams may give up buffer memory first
+    if (mVideoSource != NULL)
+        mVideoSource->SetBackground(!pVisible);
+
     if (pVisible)
     {
         if (!isVisible())
@@ -521,6 +521,9 @@ int WINAPI WinMain(HINSTANCE pInstance,	HINSTANCE pPrevInstance, LPSTR pCmdLine,
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
+	// the time to the first paint of the main window is measured from here
+	MainWindow::SetProcessStartTime(Time::GetTimeStamp());
+
 	// active memory debugger as early as possible
 	Thread::ActivateMemoryDebugger();
 
@@ -573,6 +576,9 @@ int WINAPI WinMain(HINSTANCE pInstance,	HINSTANCE pPrevInstance, LPSTR pCmdLine,
 		printf("   -ShowPreviewInFullScreen            show the preview view in fullscreen mode\n");
 		printf("   -ShowPreviewNetworkStreams          show a preview of network streams\n");
 		printf("\n");
+		printf("Options for testing:\n");
+		printf("   -MeasureStartup                     print the time from program start to the first paint of the main window and quit, exit code 1 if it exceeds the startup budget, e.g. headless with \"-platform offscreen\"\n");
+		printf("\n");
 		#ifdef RELEASE_VERSION
 			#ifdef WINDOWS
 				while(true)
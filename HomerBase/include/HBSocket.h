@@ -49,6 +49,8 @@
 #include <list>
 
 #include <HBSocketQoSSettings.h>
+#include <HBSocketTuningSettings.h>
+#include <HBSocketImpairment.h>
 #include <socket_ext.h>
 
 namespace Homer { namespace Base {
@@ -146,6 +148,24 @@ public:
     static QoSProfileList GetQoSProfiles();
     bool SetQoS(const std::string &pProfileName);
 
+    /* tuning interface */
+    bool SetTuning(const SocketTuningSettings &pSettings);
+    bool GetTuning(SocketTuningSettings &pSettings);
+    static bool CreateTuningProfile(const std::string &pProfileName, const SocketTuningSettings &pSettings);
+    static SocketTuningProfileList GetTuningProfiles();
+    bool SetTuning(const std::string &pProfileName);
+    uint64_t GetReceiveQueueDropCount(); // packets dropped by the OS because of a full receive buffer
+
+    /* path MTU discovery, only for datagram based sockets with tuning option "PathMtuDiscovery" */
+    int GetPathMtu(std::string pTargetHost); // in bytes, 0 if unknown, cached value which never waits for the network
+    int GetPathMaxPayloadSize(std::string pTargetHost); // largest datagram which isn't fragmented on the path, 0 if unknown
+
+    /* network impairment, only for datagram based sockets */
+    bool SetImpairment(const ImpairmentSettings &pSettings);
+    bool GetImpairment(ImpairmentSettings &pSettings);
+    SocketImpairment* GetImpairment(int pDirection);
+    static void SetDefaultImpairment(const ImpairmentSettings &pSettings);
+
 	/* allow reusing a port */
     bool EnableReuse(bool pActive = true);
 
@@ -179,15 +199,29 @@ public:
     static bool FillAddrDescriptor(std::string pHost, unsigned int pPort, SocketAddressDescriptor *tAddressDescriptor, unsigned int &tAddressDescriptorSize);
 
 private:
+    friend class SocketImpairmentService;
+
     Socket(enum NetworkType pIpVersion, enum TransportType pTransportType, unsigned int pSenderPort, bool pReusable, unsigned int pProbeStepping, unsigned int pHighestPossibleSenderPort);
 
     void SetDefaults(enum TransportType pTransportType);
+    static void CreateDefaultTuningProfiles();
 
     bool CreateSocket(enum NetworkType pIpVersion = SOCKET_IPv6);
     bool BindSocket(unsigned int pPort = 0, unsigned int pProbeStepping = 1, unsigned int pHighesPossiblePort = 0);
     static void CloseSocket(int pHandle);
 
+    /* transmission without impairment */
+    bool SendNow(std::string pTargetHost, unsigned int pTargetPort, void *pBuffer, ssize_t pBufferSize);
+    bool ReceiveNow(std::string &pSourceHost, unsigned int &pSourcePort, void *pBuffer, ssize_t &pBufferSize);
+    bool WaitForData(int64_t pTimeout /* in us */);
+    void DestroyImpairment();
+
+    /* path MTU discovery */
+    bool EnablePathMtuDiscovery();
+
     QoSSettings			mQoSSettings;
+    SocketTuningSettings mTuningSettings;
+    uint64_t            mReceiveQueueDropCount;
     int 			    mUdpLiteChecksumCoverage;
     enum TransportType	mSocketTransportType;
     enum NetworkType    mSocketNetworkType;
@@ -200,6 +234,11 @@ private:
     bool 				mNonBlockingMode;
     bool				mWasClosed;
 
+    /* network impairment */
+    SocketImpairment    *mSendImpairment, *mReceiveImpairment;
+    ImpairedPacketQueue mReceiveDelayLine;
+    Mutex               mImpairmentMutex;
+
     /* peer data */
     std::string         mPeerHost;
     unsigned int        mPeerPort;
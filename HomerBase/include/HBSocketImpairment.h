@@ -0,0 +1,186 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2013 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: deterministic network impairment for datagram sockets
+ * Since:   2014-01-11
+ */
+
+#ifndef _BASE_SOCKET_IMPAIRMENT_
+#define _BASE_SOCKET_IMPAIRMENT_
+
+#include <HBThread.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
+#include <Header_Windows.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string>
+#include <map>
+
+namespace Homer { namespace Base {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of impaired packets
+//#define HBSI_DEBUG_PACKETS
+
+#define SVC_SOCKET_IMPAIRMENT                           SocketImpairmentService::GetInstance()
+
+// directions where an impairment is applied
+#define IMPAIRMENT_DIRECTION_NONE                       0x00
+#define IMPAIRMENT_DIRECTION_SEND                       0x01
+#define IMPAIRMENT_DIRECTION_RECEIVE                    0x02
+
+// how many copies of one packet an impairment can produce (original + duplicate)
+#define IMPAIRMENT_MAX_COPIES                           2
+
+enum ImpairmentDelayDistribution{
+    IMPAIRMENT_DELAY_UNIFORM = 0,
+    IMPAIRMENT_DELAY_NORMAL,
+    IMPAIRMENT_DELAY_PARETO
+};
+
+struct ImpairmentSettings
+{
+    unsigned int Seed; /* start value of the pseudo random number generator */
+    int Directions; /* IMPAIRMENT_DIRECTION_* flags */
+    /* Gilbert-Elliott loss model */
+    float LossGoodToBad; /* probability of a transition from "good" to "bad" state per packet */
+    float LossBadToGood; /* probability of a transition from "bad" to "good" state per packet */
+    float LossInGood; /* loss probability while in "good" state */
+    float LossInBad; /* loss probability while in "bad" state */
+    /* delay line */
+    unsigned int Delay; /* in ms */
+    unsigned int Jitter; /* in ms */
+    enum ImpairmentDelayDistribution DelayDistribution;
+    float Reordering; /* probability that a packet bypasses the delay line */
+    float Duplication; /* probability that a packet is delivered twice */
+    /* rate limiter */
+    unsigned int DataRate; /* in KB/s, 0 means unlimited */
+    unsigned int QueueSize; /* in bytes */
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Decides about the fate of each packet which passes a socket: it may be
+ * dropped, duplicated, delayed or reordered. Each decision is derived from
+ * a seeded generator, so the same packet sequence is always impaired in the
+ * same way - only the release times depend on the real clock.
+ */
+class SocketImpairment
+{
+public:
+    SocketImpairment(const ImpairmentSettings &pSettings, unsigned int pSeedOffset = 0);
+
+    virtual ~SocketImpairment( );
+
+    static void SetDefaults(ImpairmentSettings &pSettings);
+    static bool IsActive(const ImpairmentSettings &pSettings);
+    static bool ParseDescription(std::string pDescription, ImpairmentSettings &pSettings);
+    static std::string GetDescription(const ImpairmentSettings &pSettings);
+
+    ImpairmentSettings GetSettings();
+
+    /* returns the amount of packet copies which have to be delivered (0 if dropped) and their release times in us */
+    int Process(int64_t pNow, int pPacketSize, int64_t *pReleaseTimes);
+
+    /* statistic */
+    int64_t GetPacketCount();
+    int64_t GetLostPacketCount();
+    int64_t GetQueueDroppedPacketCount();
+    int64_t GetDuplicatedPacketCount();
+    int64_t GetReorderedPacketCount();
+
+private:
+    double GetUniform();
+    double GetNormal();
+    int64_t GetDelay();
+
+    ImpairmentSettings  mSettings;
+    Mutex               mMutex;
+    uint64_t            mRandomState;
+    bool                mLossStateBad;
+    int64_t             mLinkBusyUntil; // in us
+    int64_t             mLastReleaseTime; // in us, keeps the packet order if no reordering is desired
+    /* statistic */
+    int64_t             mPacketCount;
+    int64_t             mLostPacketCount;
+    int64_t             mQueueDroppedPacketCount;
+    int64_t             mDuplicatedPacketCount;
+    int64_t             mReorderedPacketCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class Socket;
+
+struct ImpairedPacket
+{
+    Socket          *Origin;
+    std::string     Host;
+    unsigned int    Port;
+    char            *Data;
+    ssize_t         Size;
+};
+
+typedef std::multimap<int64_t, ImpairedPacket> ImpairedPacketQueue;
+
+/*
+ * Delay line for the sending direction: delayed packets are handed over to a
+ * common thread which releases them towards the network at their release time.
+ */
+class SocketImpairmentService:
+    public Thread
+{
+public:
+    /// The default constructor
+    SocketImpairmentService();
+
+    /// The destructor.
+    virtual ~SocketImpairmentService();
+
+    static SocketImpairmentService& GetInstance();
+
+    void Stop();
+
+    /* delay line interface */
+    void Enqueue(int64_t pReleaseTime, Socket *pOrigin, std::string pTargetHost, unsigned int pTargetPort, void *pBuffer, ssize_t pBufferSize);
+    void Cancel(Socket *pOrigin);
+
+    static void FreePackets(ImpairedPacketQueue &pQueue, Socket *pOrigin = NULL);
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    ImpairedPacketQueue mQueue;
+    Mutex               mQueueMutex;
+    Condition           mQueueCondition;
+    bool                mWorkerNeeded;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: path MTU discovery for datagram sockets
+ * Since:   2014-02-20
+ */
+
+#ifndef _BASE_SOCKET_PATH_MTU_
+#define _BASE_SOCKET_PATH_MTU_
+
+#include <HBThread.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
+
+#include <stdint.h>
+#include <string>
+#include <list>
+#include <map>
+
+namespace Homer { namespace Base {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define SVC_PATH_MTU_DISCOVERY                          PathMtuDiscoveryService::GetInstance()
+
+// the kernel is asked again and the result is confirmed by a probe after this period, so a path MTU can grow again
+#define SOCKET_PATH_MTU_REFRESH_PERIOD                  10 // seconds
+// a limit found by searching a black hole is kept for this period before larger packets are probed again (PMTU_RAISE_TIMER of RFC 8899)
+#define SOCKET_PATH_MTU_RAISE_PERIOD                    600 // seconds
+// smallest MTUs which every host has to support
+#define SOCKET_PATH_MTU_IPv4_MIN                        576
+#define SOCKET_PATH_MTU_IPv6_MIN                        1280
+// largest MTU which can be probed, the IP length field limits each packet to 64 KB
+#define SOCKET_PATH_MTU_MAX                             65535
+// probes are acknowledged by the ICMP "port unreachable" of the target, hence a port is used which is most likely closed (traceroute)
+#define SOCKET_PATH_MTU_PROBE_PORT                      33434
+// time to wait for the acknowledgment of a probe and amount of probes before a size is considered as lost
+#define SOCKET_PATH_MTU_PROBE_TIMEOUT                   200 // ms
+#define SOCKET_PATH_MTU_PROBE_ATTEMPTS                  2
+// the search within a black hole stops if the range is smaller than this
+#define SOCKET_PATH_MTU_SEARCH_ACCURACY                 16 // bytes
+
+enum PathMtuProbeResult{
+    PATH_MTU_PROBE_ACKNOWLEDGED = 0,
+    PATH_MTU_PROBE_TOO_BIG, // ICMP "fragmentation needed"/"packet too big" or bigger than the MTU of the outgoing interface
+    PATH_MTU_PROBE_LOST
+};
+
+struct PathMtuDescriptor
+{
+    int         Mtu; // in bytes, 0 if unknown
+    int64_t     Timestamp; // in us, time of the last discovery, 0 if only the kernel's value is known
+    bool        Pending; // queued for a discovery or currently discovered
+    int         SearchedMtu; // in bytes, limit found by a search within a black hole, 0 if none
+    bool        ProbesAcknowledged; // false if the target doesn't answer probes at all, the kernel's value is used without confirmation
+    int64_t     SearchTimestamp; // in us
+};
+
+typedef std::map<std::string, PathMtuDescriptor> PathMtuCache;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * The path MTU is a property of the destination, not of a socket, hence one
+ * common thread probes each destination and all sockets read the cached
+ * results. Reading never waits for the network: a new destination starts
+ * with the kernel's value and the probes confirm or correct it later.
+ */
+class PathMtuDiscoveryService:
+    public Thread
+{
+public:
+    /// The default constructor
+    PathMtuDiscoveryService();
+
+    /// The destructor.
+    virtual ~PathMtuDiscoveryService();
+
+    static PathMtuDiscoveryService& GetInstance();
+
+    void Stop();
+
+    /* returns the cached path MTU in bytes (0 if unknown) and triggers a discovery in the background if the value is outdated */
+    int GetPathMtu(std::string pTargetHost);
+    /* true if at least one discovery by probes has finished for this destination */
+    bool IsDiscovered(std::string pTargetHost);
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    static int QueryPathMtu(std::string pTargetHost);
+    static enum PathMtuProbeResult ProbePathMtu(std::string pTargetHost, int pMtu);
+    static int SearchPathMtu(std::string pTargetHost, int pMtu, bool &pProbesAcknowledged);
+    static void Discover(std::string pTargetHost, PathMtuDescriptor &pDescriptor);
+
+    PathMtuCache        mCache;
+    std::list<std::string> mPendingHosts;
+    Mutex               mCacheMutex;
+    Condition           mCacheCondition;
+    bool                mWorkerNeeded;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
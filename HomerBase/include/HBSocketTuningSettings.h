@@ -0,0 +1,75 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2013 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+
+/*
+ * Purpose: socket tuning settings
+ * Since:   2014-01-12
+ */
+
+#ifndef _BASE_SOCKET_TUNING_SETTINGS_
+#define _BASE_SOCKET_TUNING_SETTINGS_
+
+#include <string>
+#include <list>
+
+namespace Homer { namespace Base {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// built-in tuning profiles
+#define SOCKET_TUNING_PROFILE_MEDIA_RX                  "media-rx"
+#define SOCKET_TUNING_PROFILE_MEDIA_TX                  "media-tx"
+#define SOCKET_TUNING_PROFILE_SIGNALLING                "signalling"
+#define SOCKET_TUNING_PROFILE_BULK                      "bulk"
+
+// DiffServ code points (RFC 4594)
+#define SOCKET_TUNING_DSCP_DEFAULT                      -1 // keep the marking of the OS
+#define SOCKET_TUNING_DSCP_CS1                          8  // lower effort
+#define SOCKET_TUNING_DSCP_CS3                          24 // signalling
+#define SOCKET_TUNING_DSCP_AF41                         34 // interactive video
+#define SOCKET_TUNING_DSCP_EF                           46 // interactive audio
+
+struct SocketTuningSettings
+{
+    int ReceiveBufferSize; /* in bytes, 0 keeps the current size */
+    int SendBufferSize; /* in bytes, 0 keeps the current size */
+    bool ForceBufferSizes; /* exceed the system limits via SO_RCVBUFFORCE/SO_SNDBUFFORCE if the process is permitted to */
+    int BusyPoll; /* in us, busy polling of the device queue while waiting for data, 0 deactivates it */
+    int Dscp; /* marking within IP_TOS/IPV6_TCLASS, SOCKET_TUNING_DSCP_DEFAULT keeps the marking of the OS */
+    int Priority; /* queueing priority of outgoing packets (SO_PRIORITY), -1 keeps the default */
+    bool CountReceiveQueueDrops; /* count the packets dropped because of a full receive buffer (SO_RXQ_OVFL) */
+    bool PathMtuDiscovery; /* set the DF bit and learn the path MTU of each destination (IP_MTU_DISCOVER) and by probes, bigger datagrams are fragmented locally */
+};
+
+struct SocketTuningProfileDescriptor
+{
+    std::string Name;
+    SocketTuningSettings Settings;
+};
+
+typedef std::list<SocketTuningProfileDescriptor*> SocketTuningProfileList;
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
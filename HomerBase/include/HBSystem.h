@@ -45,13 +45,29 @@ public:
     static bool GetWindowsKernelVersion(int &pMajor, int &pMinor);
     static std::string GetKernelVersion();
     static int GetMachineCores();
+    /* cores this process may really use: affinity mask and cgroup CPU quota are considered */
+    static int GetEffectiveCores();
     static std::string GetMachineType();
     static std::string GetTargetMachineType();
     static int64_t GetMachineMemoryPhysical();
+    /* physical memory limited by the cgroup memory limit */
+    static int64_t GetEffectiveMemoryPhysical();
+    /* cgroup memory limit in bytes, 0 if unlimited */
+    static int64_t GetMemoryLimit();
     static int64_t GetMachineMemorySwap();
     static std::list<std::string> GetStackTrace();
 
+    /* drops all cached resource values, e.g., after the container was resized */
+    static void RefreshResourceLimits();
+    /* mount point of the cgroup hierarchy, can be redirected to a fake file system which then provides the membership in <root>/proc/self/cgroup, too */
+    static void SetControlGroupRoot(std::string pRoot);
+    static std::string GetControlGroupRoot();
+
 private:
+    static bool ReadControlGroupValue(std::string pFile, std::string &pValue);
+    static std::list<std::string> GetControlGroupDirectories(std::string pController);
+    static int GetControlGroupCores();
+    static int64_t GetControlGroupMemoryLimit();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -27,6 +27,8 @@
 #include <Logger.h>
 #include <HBSocket.h>
 #include <HBSocketControlService.h>
+#include <HBSocketImpairment.h>
+#include <HBSocketPathMtu.h>
 #include <HBSystem.h>
 #include <HBMutex.h>
 #include <HBTime.h>
@@ -55,6 +57,16 @@ using namespace std;
 // de/activate flexible socket buffering
 #define SOCKETS_FLEXIBLE_BUFFERING
 
+// socket options which are missing in the headers of older Linux systems
+#if defined(LINUX)
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL                     40
+#endif
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL                    46
+#endif
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #if defined(WINDOWS)
@@ -74,6 +86,9 @@ int sUDPliteSupported = -1;
 int sDCCPSupported = -1;
 int sSCTPSupported = -1;
 
+ImpairmentSettings sDefaultImpairment;
+bool sDefaultImpairmentActive = false;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void Socket::SetDefaults(enum TransportType pTransportType)
@@ -91,6 +106,17 @@ void Socket::SetDefaults(enum TransportType pTransportType)
     mPeerHost = "";
     mPeerPort = 0;
     mUdpLiteChecksumCoverage = UDP_LITE_HEADER_SIZE;
+    mSendImpairment = NULL;
+    mReceiveImpairment = NULL;
+    mTuningSettings.ReceiveBufferSize = 0;
+    mTuningSettings.SendBufferSize = 0;
+    mTuningSettings.ForceBufferSizes = false;
+    mTuningSettings.BusyPoll = 0;
+    mTuningSettings.Dscp = SOCKET_TUNING_DSCP_DEFAULT;
+    mTuningSettings.Priority = -1;
+    mTuningSettings.CountReceiveQueueDrops = false;
+    mTuningSettings.PathMtuDiscovery = false;
+    mReceiveQueueDropCount = 0;
 
     #if defined(WINDOWS) || defined(APPLE) || defined(BSD)
 		if (pTransportType == SOCKET_UDP_LITE)
@@ -214,6 +240,10 @@ Socket::Socket(enum NetworkType pIpVersion, enum TransportType pTransportType, u
     // per default we set receive/send buffer of SOCKET_IO_BUFFER_SIZE bytes
     SetReceiveBufferSize(SOCKET_IO_BUFFER_SIZE);
     SetSendBufferSize(SOCKET_IO_BUFFER_SIZE);
+
+    // apply the process wide network impairment, e.g., for reproducible tests via loopback
+    if ((sDefaultImpairmentActive) && (mSocketHandle != -1) && (mSocketTransportType != SOCKET_TCP))
+        SetImpairment(sDefaultImpairment);
 }
 
 Socket::~Socket()
@@ -222,6 +252,7 @@ Socket::~Socket()
         SVC_SOCKET_CONTROL.UnregisterClientSocket(this);
 
     Close();
+    DestroyImpairment();
     LOG(LOG_VERBOSE, "Destroyed %d", mSocketHandle);
 }
 
@@ -500,6 +531,446 @@ bool Socket::SetQoS(const std::string &pProfileName)
 	return false;
 }
 
+bool Socket::SetTuning(const SocketTuningSettings &pSettings)
+{
+    bool tResult = true;
+    bool tCountedReceiveQueueDrops = mTuningSettings.CountReceiveQueueDrops;
+    int tValue;
+
+    if (mSocketHandle == -1)
+    {
+        LOG(LOG_ERROR, "Socket is invalid");
+        return false;
+    }
+
+    LOG(LOG_VERBOSE, "Desired tuning of socket %d: %d bytes receive buffer, %d bytes send buffer, forced buffer sizes: %d, %d us busy polling, DSCP %d, priority %d, receive queue drop counter: %d, path MTU discovery: %d", mSocketHandle, pSettings.ReceiveBufferSize, pSettings.SendBufferSize, pSettings.ForceBufferSizes, pSettings.BusyPoll, pSettings.Dscp, pSettings.Priority, pSettings.CountReceiveQueueDrops, pSettings.PathMtuDiscovery);
+
+    mTuningSettings = pSettings;
+
+    /* buffer sizes */
+    if (pSettings.ReceiveBufferSize > 0)
+    {
+        bool tForced = false;
+        #if defined(LINUX)
+            // exceeding net.core.rmem_max needs CAP_NET_ADMIN
+            tValue = pSettings.ReceiveBufferSize;
+            if ((pSettings.ForceBufferSizes) && (setsockopt(mSocketHandle, SOL_SOCKET, SO_RCVBUFFORCE, (char*)&tValue, sizeof(tValue)) == 0))
+                tForced = true;
+        #endif
+        if (!tForced)
+            SetReceiveBufferSize(pSettings.ReceiveBufferSize);
+        tValue = GetReceiveBufferSize();
+        if (tValue < pSettings.ReceiveBufferSize)
+        {
+            LOG(LOG_WARN, "Socket %d uses a receive buffer of %d bytes instead of the desired %d bytes, the system limit might be too low", mSocketHandle, tValue, pSettings.ReceiveBufferSize);
+            tResult = false;
+        }
+    }
+    if (pSettings.SendBufferSize > 0)
+    {
+        bool tForced = false;
+        #if defined(LINUX)
+            // exceeding net.core.wmem_max needs CAP_NET_ADMIN
+            tValue = pSettings.SendBufferSize;
+            if ((pSettings.ForceBufferSizes) && (setsockopt(mSocketHandle, SOL_SOCKET, SO_SNDBUFFORCE, (char*)&tValue, sizeof(tValue)) == 0))
+                tForced = true;
+        #endif
+        if (!tForced)
+            SetSendBufferSize(pSettings.SendBufferSize);
+        tValue = GetSendBufferSize();
+        if (tValue < pSettings.SendBufferSize)
+        {
+            LOG(LOG_WARN, "Socket %d uses a send buffer of %d bytes instead of the desired %d bytes, the system limit might be too low", mSocketHandle, tValue, pSettings.SendBufferSize);
+            tResult = false;
+        }
+    }
+
+    /* packet marking */
+    if (pSettings.Dscp != SOCKET_TUNING_DSCP_DEFAULT)
+    {
+        #if defined(LINUX) || defined(APPLE) || defined(BSD)
+            // the DSCP occupies the upper 6 bits of the former TOS byte
+            tValue = pSettings.Dscp << 2;
+            if (mSocketNetworkType == SOCKET_IPv6)
+            {
+                if (setsockopt(mSocketHandle, IPPROTO_IPV6, IPV6_TCLASS, (char*)&tValue, sizeof(tValue)) < 0)
+                {
+                    LOG(LOG_ERROR, "Failed to set traffic class %d on socket %d because %s(%d)", tValue, mSocketHandle, strerror(errno), errno);
+                    tResult = false;
+                }
+                // IPv4 packets of a dual stack socket are marked via IP_TOS, errors are expected for pure IPv6 sockets
+                setsockopt(mSocketHandle, IPPROTO_IP, IP_TOS, (char*)&tValue, sizeof(tValue));
+            }else
+            {
+                if (setsockopt(mSocketHandle, IPPROTO_IP, IP_TOS, (char*)&tValue, sizeof(tValue)) < 0)
+                {
+                    LOG(LOG_ERROR, "Failed to set TOS %d on socket %d because %s(%d)", tValue, mSocketHandle, strerror(errno), errno);
+                    tResult = false;
+                }
+            }
+        #else
+            LOG(LOG_WARN, "Packet marking isn't supported for this platform, DSCP %d will be ignored", pSettings.Dscp);
+        #endif
+    }
+
+    /* Linux specific options */
+    #if defined(LINUX)
+        if (pSettings.Priority >= 0)
+        {
+            tValue = pSettings.Priority;
+            if (setsockopt(mSocketHandle, SOL_SOCKET, SO_PRIORITY, (char*)&tValue, sizeof(tValue)) < 0)
+            {
+                LOG(LOG_ERROR, "Failed to set priority %d on socket %d because %s(%d)", tValue, mSocketHandle, strerror(errno), errno);
+                tResult = false;
+            }
+        }
+        if (pSettings.BusyPoll > 0)
+        {
+            tValue = pSettings.BusyPoll;
+            // might fail without CAP_NET_ADMIN, the socket works as before in this case
+            if (setsockopt(mSocketHandle, SOL_SOCKET, SO_BUSY_POLL, (char*)&tValue, sizeof(tValue)) < 0)
+                LOG(LOG_WARN, "Failed to activate busy polling of %d us on socket %d because %s(%d)", tValue, mSocketHandle, strerror(errno), errno);
+        }
+        if ((mSocketTransportType == SOCKET_UDP) || (mSocketTransportType == SOCKET_UDP_LITE))
+        {
+            // the drop counter is only evaluated for received datagrams, the option is touched only if it gets de/activated
+            if ((pSettings.CountReceiveQueueDrops) || (tCountedReceiveQueueDrops))
+            {
+                tValue = (pSettings.CountReceiveQueueDrops ? 1 : 0);
+                if (setsockopt(mSocketHandle, SOL_SOCKET, SO_RXQ_OVFL, (char*)&tValue, sizeof(tValue)) < 0)
+                {
+                    LOG(LOG_WARN, "Failed to de/activate receive queue drop counter on socket %d because %s(%d)", mSocketHandle, strerror(errno), errno);
+                    mTuningSettings.CountReceiveQueueDrops = false;
+                }
+            }
+            if ((pSettings.PathMtuDiscovery) && (!EnablePathMtuDiscovery()))
+                mTuningSettings.PathMtuDiscovery = false;
+        }else
+        {
+            mTuningSettings.CountReceiveQueueDrops = false;
+            mTuningSettings.PathMtuDiscovery = false;
+        }
+    #else
+        if ((pSettings.Priority >= 0) || (pSettings.BusyPoll > 0) || (pSettings.CountReceiveQueueDrops) || (pSettings.PathMtuDiscovery))
+            LOG(LOG_WARN, "Priority, busy polling, receive queue drop counter and path MTU discovery are only supported for Linux");
+        mTuningSettings.CountReceiveQueueDrops = false;
+        mTuningSettings.PathMtuDiscovery = false;
+    #endif
+
+    return tResult;
+}
+
+bool Socket::GetTuning(SocketTuningSettings &pSettings)
+{
+    LOG(LOG_VERBOSE, "Getting current tuning settings");
+
+    pSettings = mTuningSettings;
+
+    return true;
+}
+
+uint64_t Socket::GetReceiveQueueDropCount()
+{
+    return mReceiveQueueDropCount;
+}
+
+bool Socket::EnablePathMtuDiscovery()
+{
+    bool tResult = true;
+
+    #if defined(LINUX)
+        // DF bit is set but packets bigger than the known path MTU are fragmented locally instead of being dropped,
+        // the mode isn't switched per packet because concurrent senders would race for it
+        //HINT: "want" is the default of Linux, but a system wide "ip_no_pmtu_disc" might have changed it
+        int tValue = IP_PMTUDISC_WANT;
+        if (mSocketNetworkType == SOCKET_IPv6)
+        {
+            int tValue6 = IPV6_PMTUDISC_WANT;
+            if (setsockopt(mSocketHandle, IPPROTO_IPV6, IPV6_MTU_DISCOVER, (char*)&tValue6, sizeof(tValue6)) < 0)
+            {
+                LOG(LOG_ERROR, "Failed to set IPv6 path MTU discovery mode on socket %d because %s(%d)", mSocketHandle, strerror(errno), errno);
+                tResult = false;
+            }
+            // IPv4 packets of a dual stack socket are controlled via IP_MTU_DISCOVER, errors are expected for pure IPv6 sockets
+            setsockopt(mSocketHandle, IPPROTO_IP, IP_MTU_DISCOVER, (char*)&tValue, sizeof(tValue));
+        }else
+        {
+            if (setsockopt(mSocketHandle, IPPROTO_IP, IP_MTU_DISCOVER, (char*)&tValue, sizeof(tValue)) < 0)
+            {
+                LOG(LOG_ERROR, "Failed to set path MTU discovery mode on socket %d because %s(%d)", mSocketHandle, strerror(errno), errno);
+                tResult = false;
+            }
+        }
+    #else
+        tResult = false;
+    #endif
+
+    return tResult;
+}
+
+int Socket::GetPathMtu(string pTargetHost)
+{
+    if (!mTuningSettings.PathMtuDiscovery)
+        return 0;
+
+    // never blocks: the probes run in the background and the cached value is used meanwhile
+    return SVC_PATH_MTU_DISCOVERY.GetPathMtu(pTargetHost);
+}
+
+int Socket::GetPathMaxPayloadSize(string pTargetHost)
+{
+    int tResult = GetPathMtu(pTargetHost);
+
+    if (tResult <= 0)
+        return 0;
+
+    // IPv4 mapped addresses are sent via IPv4
+    tResult -= ((IS_IPV6_ADDRESS(pTargetHost) && (pTargetHost.find("::ffff:") != 0)) ? IP6_HEADER_SIZE : IP4_HEADER_SIZE);
+    tResult -= IP_OPTIONS_SIZE; // IP options size: used for QoS signaling
+    tResult -= UDP_HEADER_SIZE;
+
+    return tResult;
+}
+
+static list<SocketTuningProfileDescriptor*> sTuningProfiles;
+static Mutex sTuningProfileMutex("TuningProfileMutex");
+static bool sTuningProfilesCreated = false;
+
+void Socket::CreateDefaultTuningProfiles()
+{
+    SocketTuningSettings tSettings;
+
+    // lock the static list of tuning profiles
+    sTuningProfileMutex.lock();
+    if (sTuningProfilesCreated)
+    {
+        // unlock the static list of tuning profiles
+        sTuningProfileMutex.unlock();
+        return;
+    }
+    sTuningProfilesCreated = true;
+    // unlock the static list of tuning profiles
+    sTuningProfileMutex.unlock();
+
+    // incoming media: absorb bursts of key frame packets and make losses inside the host visible
+    tSettings.ReceiveBufferSize = 4 * 1024 * 1024;
+    tSettings.SendBufferSize = 0;
+    tSettings.ForceBufferSizes = true;
+    tSettings.BusyPoll = 50;
+    tSettings.Dscp = SOCKET_TUNING_DSCP_DEFAULT;
+    tSettings.Priority = -1;
+    tSettings.CountReceiveQueueDrops = true;
+    tSettings.PathMtuDiscovery = false;
+    CreateTuningProfile(SOCKET_TUNING_PROFILE_MEDIA_RX, tSettings);
+
+    // outgoing media: send key frames without blocking and mark them as interactive
+    tSettings.ReceiveBufferSize = 0;
+    tSettings.SendBufferSize = 1024 * 1024;
+    tSettings.ForceBufferSizes = true;
+    tSettings.BusyPoll = 0;
+    tSettings.Dscp = SOCKET_TUNING_DSCP_AF41;
+    tSettings.Priority = 5;
+    tSettings.CountReceiveQueueDrops = false;
+    tSettings.PathMtuDiscovery = true;
+    CreateTuningProfile(SOCKET_TUNING_PROFILE_MEDIA_TX, tSettings);
+
+    // signalling: small messages with short delay
+    tSettings.ReceiveBufferSize = 0;
+    tSettings.SendBufferSize = 0;
+    tSettings.ForceBufferSizes = false;
+    tSettings.BusyPoll = 0;
+    tSettings.Dscp = SOCKET_TUNING_DSCP_CS3;
+    tSettings.Priority = 4;
+    tSettings.CountReceiveQueueDrops = true;
+    tSettings.PathMtuDiscovery = false;
+    CreateTuningProfile(SOCKET_TUNING_PROFILE_SIGNALLING, tSettings);
+
+    // bulk data: large buffers but no precedence over interactive traffic
+    tSettings.ReceiveBufferSize = 1024 * 1024;
+    tSettings.SendBufferSize = 1024 * 1024;
+    tSettings.ForceBufferSizes = false;
+    tSettings.BusyPoll = 0;
+    tSettings.Dscp = SOCKET_TUNING_DSCP_CS1;
+    tSettings.Priority = 0;
+    tSettings.CountReceiveQueueDrops = true;
+    tSettings.PathMtuDiscovery = false;
+    CreateTuningProfile(SOCKET_TUNING_PROFILE_BULK, tSettings);
+}
+
+bool Socket::CreateTuningProfile(const std::string &pProfileName, const SocketTuningSettings &pSettings)
+{
+    SocketTuningProfileDescriptor *tDescriptor;
+    SocketTuningProfileList::iterator tIt, tItEnd;
+
+    LOGEX(Socket, LOG_VERBOSE, "Creating tuning profile %s with parameters: %d bytes receive buffer, %d bytes send buffer, %d us busy polling, DSCP %d, priority %d", pProfileName.c_str(), pSettings.ReceiveBufferSize, pSettings.SendBufferSize, pSettings.BusyPoll, pSettings.Dscp, pSettings.Priority);
+
+    // lock the static list of tuning profiles
+    sTuningProfileMutex.lock();
+
+    tItEnd = sTuningProfiles.end();
+    for (tIt = sTuningProfiles.begin(); tIt != tItEnd; tIt++)
+    {
+        if ((*tIt)->Name == pProfileName)
+        {
+            // unlock the static list of tuning profiles
+            sTuningProfileMutex.unlock();
+
+            LOGEX(Socket, LOG_WARN, "Tuning profile of name \"%s\" already registered", pProfileName.c_str());
+
+            return false;
+        }
+    }
+
+    tDescriptor = new SocketTuningProfileDescriptor;
+    tDescriptor->Name = pProfileName;
+    tDescriptor->Settings = pSettings;
+    sTuningProfiles.push_back(tDescriptor);
+
+    // unlock the static list of tuning profiles
+    sTuningProfileMutex.unlock();
+
+    return true;
+}
+
+SocketTuningProfileList Socket::GetTuningProfiles()
+{
+    SocketTuningProfileDescriptor *tDescriptor;
+    SocketTuningProfileList tResult;
+    SocketTuningProfileList::iterator tIt, tItEnd;
+
+    CreateDefaultTuningProfiles();
+
+    // lock the static list of tuning profiles
+    sTuningProfileMutex.lock();
+
+    tItEnd = sTuningProfiles.end();
+    for (tIt = sTuningProfiles.begin(); tIt != tItEnd; tIt++)
+    {
+        tDescriptor = new SocketTuningProfileDescriptor;
+        tDescriptor->Name = (*tIt)->Name;
+        tDescriptor->Settings = (*tIt)->Settings;
+        tResult.push_back(tDescriptor);
+    }
+
+    // unlock the static list of tuning profiles
+    sTuningProfileMutex.unlock();
+
+    return tResult;
+}
+
+bool Socket::SetTuning(const std::string &pProfileName)
+{
+    SocketTuningProfileList::iterator tIt, tItEnd;
+
+    LOG(LOG_VERBOSE, "Desired tuning profile: %s", pProfileName.c_str());
+
+    CreateDefaultTuningProfiles();
+
+    // lock the static list of tuning profiles
+    sTuningProfileMutex.lock();
+
+    tItEnd = sTuningProfiles.end();
+    for (tIt = sTuningProfiles.begin(); tIt != tItEnd; tIt++)
+    {
+        if ((*tIt)->Name == pProfileName)
+        {
+            SocketTuningSettings tSettings = (*tIt)->Settings;
+
+            // unlock the static list of tuning profiles
+            sTuningProfileMutex.unlock();
+
+            return SetTuning(tSettings);
+        }
+    }
+
+    // unlock the static list of tuning profiles
+    sTuningProfileMutex.unlock();
+
+    LOG(LOG_WARN, "Tuning profile \"%s\" is unknown", pProfileName.c_str());
+
+    return false;
+}
+
+bool Socket::SetImpairment(const ImpairmentSettings &pSettings)
+{
+    if ((mSocketTransportType == SOCKET_TCP) && (SocketImpairment::IsActive(pSettings)))
+    {
+        LOG(LOG_ERROR, "Network impairment is only supported for datagram based sockets, will ignore the settings for socket %d", mSocketHandle);
+        return false;
+    }
+
+    DestroyImpairment();
+
+    LOG(LOG_WARN, "Setting network impairment for socket %d: %s", mSocketHandle, SocketImpairment::GetDescription(pSettings).c_str());
+
+    mImpairmentMutex.lock();
+    if (SocketImpairment::IsActive(pSettings))
+    {
+        // both directions use different random sequences
+        if (pSettings.Directions & IMPAIRMENT_DIRECTION_SEND)
+            mSendImpairment = new SocketImpairment(pSettings, 0);
+        if (pSettings.Directions & IMPAIRMENT_DIRECTION_RECEIVE)
+            mReceiveImpairment = new SocketImpairment(pSettings, 1);
+    }
+    mImpairmentMutex.unlock();
+
+    return true;
+}
+
+bool Socket::GetImpairment(ImpairmentSettings &pSettings)
+{
+    bool tResult = false;
+
+    mImpairmentMutex.lock();
+    if (mSendImpairment != NULL)
+    {
+        pSettings = mSendImpairment->GetSettings();
+        tResult = true;
+    }else if (mReceiveImpairment != NULL)
+    {
+        pSettings = mReceiveImpairment->GetSettings();
+        tResult = true;
+    }
+    mImpairmentMutex.unlock();
+
+    return tResult;
+}
+
+SocketImpairment* Socket::GetImpairment(int pDirection)
+{
+    switch(pDirection)
+    {
+        case IMPAIRMENT_DIRECTION_SEND:
+            return mSendImpairment;
+        case IMPAIRMENT_DIRECTION_RECEIVE:
+            return mReceiveImpairment;
+        default:
+            return NULL;
+    }
+}
+
+void Socket::SetDefaultImpairment(const ImpairmentSettings &pSettings)
+{
+    LOGEX(Socket, LOG_WARN, "Setting default network impairment for new datagram sockets: %s", SocketImpairment::GetDescription(pSettings).c_str());
+
+    sDefaultImpairment = pSettings;
+    sDefaultImpairmentActive = SocketImpairment::IsActive(pSettings);
+}
+
+void Socket::DestroyImpairment()
+{
+    mImpairmentMutex.lock();
+    SocketImpairmentService::FreePackets(mReceiveDelayLine);
+    delete mSendImpairment;
+    mSendImpairment = NULL;
+    delete mReceiveImpairment;
+    mReceiveImpairment = NULL;
+    mImpairmentMutex.unlock();
+
+    // drop all delayed packets of this socket, Send() can't enqueue new ones anymore
+    SVC_SOCKET_IMPAIRMENT.Cancel(this);
+}
+
 void Socket::UDPLiteSetCheckLength(int pBytes)
 {
     /* Checksum coverage:
@@ -555,6 +1026,42 @@ void Socket::StopReceiving()
 }
 
 bool Socket::Send(string pTargetHost, unsigned int pTargetPort, void *pBuffer, ssize_t pBufferSize)
+{
+    int64_t tReleaseTimes[IMPAIRMENT_MAX_COPIES];
+    int64_t tNow;
+    int tCopies;
+    bool tResult = true;
+
+    if ((mWasClosed) || (mSocketHandle == -1))
+        return false;
+
+    //HINT: the lock keeps the impairment alive while this packet is processed and prevents DestroyImpairment() from missing a delayed copy
+    mImpairmentMutex.lock();
+    if (mSendImpairment == NULL)
+    {
+        mImpairmentMutex.unlock();
+        return SendNow(pTargetHost, pTargetPort, pBuffer, pBufferSize);
+    }
+    tNow = Time::GetTimeStamp();
+    tCopies = mSendImpairment->Process(tNow, (int)pBufferSize, tReleaseTimes);
+    for (int i = 0; i < tCopies; i++)
+    {
+        if (tReleaseTimes[i] > tNow)
+            SVC_SOCKET_IMPAIRMENT.Enqueue(tReleaseTimes[i], this, pTargetHost, pTargetPort, pBuffer, pBufferSize);
+    }
+    mImpairmentMutex.unlock();
+
+    for (int i = 0; i < tCopies; i++)
+    {
+        if (tReleaseTimes[i] <= tNow)
+            tResult = SendNow(pTargetHost, pTargetPort, pBuffer, pBufferSize);
+    }
+
+    // a lost packet is a successful transmission from the application's point of view
+    return tResult;
+}
+
+bool Socket::SendNow(string pTargetHost, unsigned int pTargetPort, void *pBuffer, ssize_t pBufferSize)
 {
     SocketAddressDescriptor   tAddressDescriptor;
     unsigned int        tAddressDescriptorSize;
@@ -681,6 +1188,112 @@ bool Socket::Send(string pTargetHost, unsigned int pTargetPort, void *pBuffer, s
 }
 
 bool Socket::Receive(string &pSourceHost, unsigned int &pSourcePort, void *pBuffer, ssize_t &pBufferSize)
+{
+    int64_t tReleaseTimes[IMPAIRMENT_MAX_COPIES];
+    int64_t tNow, tWaitTime;
+    ImpairedPacketQueue::iterator tIt;
+    ImpairedPacket tPacket;
+    int tCopies;
+
+    for(;;)
+    {
+        if ((mWasClosed) || (mSocketHandle == -1))
+            return false;
+
+        /*
+         * release a delayed packet if its time has come
+         */
+        tWaitTime = -1;
+        tNow = Time::GetTimeStamp();
+        mImpairmentMutex.lock();
+        if ((mReceiveImpairment == NULL) && (mReceiveDelayLine.empty()))
+        {
+            mImpairmentMutex.unlock();
+            return ReceiveNow(pSourceHost, pSourcePort, pBuffer, pBufferSize);
+        }
+        if (!mReceiveDelayLine.empty())
+        {
+            tIt = mReceiveDelayLine.begin();
+            if (tIt->first <= tNow)
+            {
+                if (tIt->second.Size > pBufferSize)
+                {
+                    LOG(LOG_ERROR, "Delayed packet of %d bytes is truncated to %d bytes", (int)tIt->second.Size, (int)pBufferSize);
+                    tIt->second.Size = pBufferSize;
+                }
+                memcpy(pBuffer, tIt->second.Data, tIt->second.Size);
+                pBufferSize = tIt->second.Size;
+                pSourceHost = tIt->second.Host;
+                pSourcePort = tIt->second.Port;
+                free(tIt->second.Data);
+                mReceiveDelayLine.erase(tIt);
+                mImpairmentMutex.unlock();
+                return true;
+            }
+            tWaitTime = tIt->first - tNow;
+        }
+        mImpairmentMutex.unlock();
+
+        /*
+         * wait for new data from the network as long as the delay line has nothing to release
+         */
+        if ((tWaitTime >= 0) && (!WaitForData(tWaitTime)))
+            continue;
+
+        /*
+         * receive the next packet and put it into the delay line
+         */
+        ssize_t tReceivedBytes = pBufferSize;
+        if (!ReceiveNow(tPacket.Host, tPacket.Port, pBuffer, tReceivedBytes))
+        {
+            pSourceHost = tPacket.Host;
+            pSourcePort = tPacket.Port;
+            pBufferSize = tReceivedBytes;
+            return false;
+        }
+        tNow = Time::GetTimeStamp();
+        mImpairmentMutex.lock();
+        if (mReceiveImpairment == NULL)
+        {// the impairment was removed meanwhile
+            mImpairmentMutex.unlock();
+            pSourceHost = tPacket.Host;
+            pSourcePort = tPacket.Port;
+            pBufferSize = tReceivedBytes;
+            return true;
+        }
+        tCopies = mReceiveImpairment->Process(tNow, (int)tReceivedBytes, tReleaseTimes);
+        for (int i = 0; i < tCopies; i++)
+        {
+            tPacket.Origin = this;
+            tPacket.Size = tReceivedBytes;
+            tPacket.Data = (char*)malloc(tReceivedBytes);
+            memcpy(tPacket.Data, pBuffer, tReceivedBytes);
+            mReceiveDelayLine.insert(ImpairedPacketQueue::value_type(tReleaseTimes[i], tPacket));
+        }
+        mImpairmentMutex.unlock();
+    }
+}
+
+bool Socket::WaitForData(int64_t pTimeout)
+{
+    fd_set tReadSet;
+    struct timeval tTimeout;
+    int tResult;
+
+    do
+    {
+        FD_ZERO(&tReadSet);
+        FD_SET(mSocketHandle, &tReadSet);
+        tTimeout.tv_sec = (long)(pTimeout / 1000000);
+        tTimeout.tv_usec = (long)(pTimeout % 1000000);
+        tResult = select(mSocketHandle + 1, &tReadSet, NULL, NULL, &tTimeout);
+    }while ((tResult < 0) && (errno == EINTR));
+
+    // errors (e.g., a closed socket) and timeouts mean: no data
+    return (tResult > 0);
+}
+
+bool Socket::ReceiveNow(string &pSourceHost, unsigned int &pSourcePort, void *pBuffer, ssize_t &pBufferSize)
 {
     ssize_t                 tReceivedBytes = 0;
     SocketAddressDescriptor tAddressDescriptor;
@@ -716,7 +1329,41 @@ bool Socket::Receive(string &pSourceHost, unsigned int &pSourcePort, void *pBuff
              * receive data
              */
             #if defined(LINUX)
-				tReceivedBytes = recvfrom(mSocketHandle, pBuffer, (size_t)pBufferSize, MSG_NOSIGNAL, &tAddressDescriptor.sa, &tAddressDescriptorSize);
+                if (mTuningSettings.CountReceiveQueueDrops)
+                {
+                    // the drop counter of the receive queue is delivered as ancillary data
+                    struct iovec tIoVector;
+                    struct msghdr tMessage;
+                    char tControlData[CMSG_SPACE(sizeof(uint32_t))];
+                    tIoVector.iov_base = pBuffer;
+                    tIoVector.iov_len = (size_t)pBufferSize;
+                    memset(&tMessage, 0, sizeof(tMessage));
+                    tMessage.msg_name = &tAddressDescriptor.sa_stor;
+                    tMessage.msg_namelen = tAddressDescriptorSize;
+                    tMessage.msg_iov = &tIoVector;
+                    tMessage.msg_iovlen = 1;
+                    tMessage.msg_control = tControlData;
+                    tMessage.msg_controllen = sizeof(tControlData);
+                    tReceivedBytes = recvmsg(mSocketHandle, &tMessage, MSG_NOSIGNAL);
+                    if (tReceivedBytes >= 0)
+                    {
+                        tAddressDescriptorSize = tMessage.msg_namelen;
+                        for (struct cmsghdr *tControlMessage = CMSG_FIRSTHDR(&tMessage); tControlMessage != NULL; tControlMessage = CMSG_NXTHDR(&tMessage, tControlMessage))
+                        {
+                            if ((tControlMessage->cmsg_level == SOL_SOCKET) && (tControlMessage->cmsg_type == SO_RXQ_OVFL))
+                            {
+                                uint32_t tDropCount;
+                                memcpy(&tDropCount, CMSG_DATA(tControlMessage), sizeof(tDropCount));
+                                if (tDropCount != mReceiveQueueDropCount)
+                                {
+                                    LOG(LOG_WARN, "Receive buffer of socket %d overflowed, %u packets were dropped so far", mSocketHandle, tDropCount);
+                                    mReceiveQueueDropCount = tDropCount;
+                                }
+                            }
+                        }
+                    }
+                }else
+                    tReceivedBytes = recvfrom(mSocketHandle, pBuffer, (size_t)pBufferSize, MSG_NOSIGNAL, &tAddressDescriptor.sa, &tAddressDescriptorSize);
 			#endif
             #if defined(APPLE) || defined(BSD)
                 tReceivedBytes = recvfrom(mSocketHandle, pBuffer, (size_t)pBufferSize, 0, &tAddressDescriptor.sa, &tAddressDescriptorSize);
@@ -0,0 +1,526 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2013 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of deterministic network impairment for datagram sockets
+ * Since:   2014-01-11
+ */
+
+#include <Logger.h>
+#include <HBSocket.h>
+#include <HBSocketImpairment.h>
+#include <HBTime.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+namespace Homer { namespace Base {
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// shape of the Pareto distribution which is used for heavy tailed delays
+#define IMPAIRMENT_PARETO_SHAPE                         3.0
+
+SocketImpairmentService sSocketImpairmentService;
+
+///////////////////////////////////////////////////////////////////////////////
+
+SocketImpairment::SocketImpairment(const ImpairmentSettings &pSettings, unsigned int pSeedOffset)
+{
+    mSettings = pSettings;
+    mRandomState = ((uint64_t)pSettings.Seed + pSeedOffset) * 0x9E3779B97F4A7C15ULL;
+    if (mRandomState == 0)
+        mRandomState = 0x2545F4914F6CDD1DULL;
+    mLossStateBad = false;
+    mLinkBusyUntil = 0;
+    mLastReleaseTime = 0;
+    mPacketCount = 0;
+    mLostPacketCount = 0;
+    mQueueDroppedPacketCount = 0;
+    mDuplicatedPacketCount = 0;
+    mReorderedPacketCount = 0;
+
+    LOG(LOG_VERBOSE, "Created network impairment: %s", GetDescription(mSettings).c_str());
+}
+
+SocketImpairment::~SocketImpairment()
+{
+    LOG(LOG_VERBOSE, "Destroyed network impairment after %"PRId64" packets (lost: %"PRId64", queue drops: %"PRId64", duplicates: %"PRId64", reordered: %"PRId64")", mPacketCount, mLostPacketCount, mQueueDroppedPacketCount, mDuplicatedPacketCount, mReorderedPacketCount);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SocketImpairment::SetDefaults(ImpairmentSettings &pSettings)
+{
+    pSettings.Seed = 1;
+    pSettings.Directions = IMPAIRMENT_DIRECTION_SEND;
+    pSettings.LossGoodToBad = 0;
+    pSettings.LossBadToGood = 1.0;
+    pSettings.LossInGood = 0;
+    pSettings.LossInBad = 1.0;
+    pSettings.Delay = 0;
+    pSettings.Jitter = 0;
+    pSettings.DelayDistribution = IMPAIRMENT_DELAY_UNIFORM;
+    pSettings.Reordering = 0;
+    pSettings.Duplication = 0;
+    pSettings.DataRate = 0;
+    pSettings.QueueSize = 64 * 1024;
+}
+
+bool SocketImpairment::IsActive(const ImpairmentSettings &pSettings)
+{
+    if (pSettings.Directions == IMPAIRMENT_DIRECTION_NONE)
+        return false;
+
+    return ((pSettings.LossGoodToBad > 0) || (pSettings.LossInGood > 0) || (pSettings.Delay > 0) || (pSettings.Jitter > 0) ||
+            (pSettings.Reordering > 0) || (pSettings.Duplication > 0) || (pSettings.DataRate > 0));
+}
+
+/*
+ * Description format: comma separated list of "key:value" pairs, e.g.,
+ *      "seed:42,dir:both,loss:0.01,p:0.02,r:0.3,delay:80,jitter:20,dist:normal,reorder:0.01,dup:0.001,rate:256,queue:32768"
+ */
+bool SocketImpairment::ParseDescription(string pDescription, ImpairmentSettings &pSettings)
+{
+    bool tResult = true;
+    string tEntry, tKey, tValue;
+    size_t tPos = 0, tEnd, tSeparator;
+
+    SetDefaults(pSettings);
+
+    while (tPos < pDescription.size())
+    {
+        tEnd = pDescription.find(',', tPos);
+        if (tEnd == string::npos)
+            tEnd = pDescription.size();
+        tEntry = pDescription.substr(tPos, tEnd - tPos);
+        tPos = tEnd + 1;
+
+        if (tEntry == "")
+            continue;
+
+        tSeparator = tEntry.find(':');
+        if (tSeparator == string::npos)
+        {
+            LOGEX(SocketImpairment, LOG_ERROR, "Invalid impairment parameter \"%s\"", tEntry.c_str());
+            tResult = false;
+            continue;
+        }
+        tKey = tEntry.substr(0, tSeparator);
+        tValue = tEntry.substr(tSeparator + 1);
+
+        if (tKey == "seed")
+            pSettings.Seed = (unsigned int)strtoul(tValue.c_str(), NULL, 10);
+        else if (tKey == "dir")
+        {
+            if (tValue == "send")
+                pSettings.Directions = IMPAIRMENT_DIRECTION_SEND;
+            else if (tValue == "receive")
+                pSettings.Directions = IMPAIRMENT_DIRECTION_RECEIVE;
+            else if (tValue == "both")
+                pSettings.Directions = IMPAIRMENT_DIRECTION_SEND | IMPAIRMENT_DIRECTION_RECEIVE;
+            else
+            {
+                LOGEX(SocketImpairment, LOG_ERROR, "Invalid impairment direction \"%s\"", tValue.c_str());
+                tResult = false;
+            }
+        }
+        else if (tKey == "loss")
+            pSettings.LossInGood = (float)atof(tValue.c_str());
+        else if (tKey == "lossbad")
+            pSettings.LossInBad = (float)atof(tValue.c_str());
+        else if (tKey == "p")
+            pSettings.LossGoodToBad = (float)atof(tValue.c_str());
+        else if (tKey == "r")
+            pSettings.LossBadToGood = (float)atof(tValue.c_str());
+        else if (tKey == "delay")
+            pSettings.Delay = (unsigned int)strtoul(tValue.c_str(), NULL, 10);
+        else if (tKey == "jitter")
+            pSettings.Jitter = (unsigned int)strtoul(tValue.c_str(), NULL, 10);
+        else if (tKey == "dist")
+        {
+            if (tValue == "uniform")
+                pSettings.DelayDistribution = IMPAIRMENT_DELAY_UNIFORM;
+            else if (tValue == "normal")
+                pSettings.DelayDistribution = IMPAIRMENT_DELAY_NORMAL;
+            else if (tValue == "pareto")
+                pSettings.DelayDistribution = IMPAIRMENT_DELAY_PARETO;
+            else
+            {
+                LOGEX(SocketImpairment, LOG_ERROR, "Invalid delay distribution \"%s\"", tValue.c_str());
+                tResult = false;
+            }
+        }
+        else if (tKey == "reorder")
+            pSettings.Reordering = (float)atof(tValue.c_str());
+        else if (tKey == "dup")
+            pSettings.Duplication = (float)atof(tValue.c_str());
+        else if (tKey == "rate")
+            pSettings.DataRate = (unsigned int)strtoul(tValue.c_str(), NULL, 10);
+        else if (tKey == "queue")
+            pSettings.QueueSize = (unsigned int)strtoul(tValue.c_str(), NULL, 10);
+        else
+        {
+            LOGEX(SocketImpairment, LOG_ERROR, "Unknown impairment parameter \"%s\"", tKey.c_str());
+            tResult = false;
+        }
+    }
+
+    return tResult;
+}
+
+string SocketImpairment::GetDescription(const ImpairmentSettings &pSettings)
+{
+    string tResult;
+    string tDirection = "none";
+    string tDistribution = "uniform";
+
+    switch(pSettings.Directions)
+    {
+        case IMPAIRMENT_DIRECTION_SEND:
+            tDirection = "send";
+            break;
+        case IMPAIRMENT_DIRECTION_RECEIVE:
+            tDirection = "receive";
+            break;
+        case IMPAIRMENT_DIRECTION_SEND | IMPAIRMENT_DIRECTION_RECEIVE:
+            tDirection = "both";
+            break;
+        default:
+            break;
+    }
+    switch(pSettings.DelayDistribution)
+    {
+        case IMPAIRMENT_DELAY_NORMAL:
+            tDistribution = "normal";
+            break;
+        case IMPAIRMENT_DELAY_PARETO:
+            tDistribution = "pareto";
+            break;
+        default:
+            break;
+    }
+
+    tResult = "seed:" + toString(pSettings.Seed) + ",dir:" + tDirection +
+              ",loss:" + toString(pSettings.LossInGood) + ",lossbad:" + toString(pSettings.LossInBad) +
+              ",p:" + toString(pSettings.LossGoodToBad) + ",r:" + toString(pSettings.LossBadToGood) +
+              ",delay:" + toString(pSettings.Delay) + ",jitter:" + toString(pSettings.Jitter) + ",dist:" + tDistribution +
+              ",reorder:" + toString(pSettings.Reordering) + ",dup:" + toString(pSettings.Duplication) +
+              ",rate:" + toString(pSettings.DataRate) + ",queue:" + toString(pSettings.QueueSize);
+
+    return tResult;
+}
+
+ImpairmentSettings SocketImpairment::GetSettings()
+{
+    return mSettings;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+double SocketImpairment::GetUniform()
+{
+    // xorshift64*
+    mRandomState ^= mRandomState >> 12;
+    mRandomState ^= mRandomState << 25;
+    mRandomState ^= mRandomState >> 27;
+
+    return (double)((mRandomState * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53);
+}
+
+double SocketImpairment::GetNormal()
+{
+    // Box-Muller transform, consumes always two uniform values
+    double tU1 = GetUniform();
+    double tU2 = GetUniform();
+
+    if (tU1 < 1e-12)
+        tU1 = 1e-12;
+
+    return sqrt(-2.0 * log(tU1)) * cos(2.0 * M_PI * tU2);
+}
+
+int64_t SocketImpairment::GetDelay()
+{
+    double tResult = (double)mSettings.Delay;
+    double tJitter = (double)mSettings.Jitter;
+
+    switch(mSettings.DelayDistribution)
+    {
+        case IMPAIRMENT_DELAY_UNIFORM:
+            tResult += (2.0 * GetUniform() - 1.0) * tJitter;
+            break;
+        case IMPAIRMENT_DELAY_NORMAL:
+            tResult += GetNormal() * tJitter;
+            break;
+        case IMPAIRMENT_DELAY_PARETO:
+            // heavy tail towards higher delays, jitter scales the mean of the additional delay
+            tResult += tJitter * (IMPAIRMENT_PARETO_SHAPE - 1.0) * (pow(1.0 - GetUniform(), -1.0 / IMPAIRMENT_PARETO_SHAPE) - 1.0);
+            break;
+    }
+
+    if (tResult < 0)
+        tResult = 0;
+
+    // ms => us
+    return (int64_t)(tResult * 1000);
+}
+
+int SocketImpairment::Process(int64_t pNow, int pPacketSize, int64_t *pReleaseTimes)
+{
+    int tResult = 0;
+    int64_t tDeparture = pNow;
+
+    mMutex.lock();
+
+    mPacketCount++;
+
+    // draw all random values in advance, so the random sequence doesn't depend on the timing of the rate limiter
+    double tStateDraw = GetUniform();
+    double tLossDraw = GetUniform();
+    double tDuplicationDraw = GetUniform();
+    double tReorderDraw[IMPAIRMENT_MAX_COPIES];
+    int64_t tDelay[IMPAIRMENT_MAX_COPIES];
+    for (int i = 0; i < IMPAIRMENT_MAX_COPIES; i++)
+    {
+        tReorderDraw[i] = GetUniform();
+        tDelay[i] = GetDelay();
+    }
+
+    // Gilbert-Elliott: state transition
+    if (mLossStateBad)
+    {
+        if (tStateDraw < mSettings.LossBadToGood)
+            mLossStateBad = false;
+    }else
+    {
+        if (tStateDraw < mSettings.LossGoodToBad)
+            mLossStateBad = true;
+    }
+
+    // Gilbert-Elliott: loss decision
+    if (tLossDraw < (mLossStateBad ? mSettings.LossInBad : mSettings.LossInGood))
+    {
+        mLostPacketCount++;
+        mMutex.unlock();
+        #ifdef HBSI_DEBUG_PACKETS
+            LOG(LOG_VERBOSE, "Dropped packet %"PRId64" of %d bytes", mPacketCount, pPacketSize);
+        #endif
+        return 0;
+    }
+
+    // rate limiter with limited queue
+    if (mSettings.DataRate > 0)
+    {
+        int64_t tBytesPerSecond = (int64_t)mSettings.DataRate * 1024;
+
+        if (mLinkBusyUntil < pNow)
+            mLinkBusyUntil = pNow;
+
+        int64_t tBacklog = (mLinkBusyUntil - pNow) * tBytesPerSecond / 1000000;
+        if ((mSettings.QueueSize > 0) && (tBacklog + pPacketSize > (int64_t)mSettings.QueueSize))
+        {
+            mQueueDroppedPacketCount++;
+            mMutex.unlock();
+            #ifdef HBSI_DEBUG_PACKETS
+                LOG(LOG_VERBOSE, "Dropped packet %"PRId64" of %d bytes because of a queue overflow (backlog: %"PRId64" bytes)", mPacketCount, pPacketSize, tBacklog);
+            #endif
+            return 0;
+        }
+
+        mLinkBusyUntil += (int64_t)pPacketSize * 1000000 / tBytesPerSecond;
+        tDeparture = mLinkBusyUntil;
+    }
+
+    // delay line, duplication and reordering
+    tResult = (tDuplicationDraw < mSettings.Duplication) ? 2 : 1;
+    if (tResult > 1)
+        mDuplicatedPacketCount++;
+    for (int i = 0; i < tResult; i++)
+    {
+        if (tReorderDraw[i] < mSettings.Reordering)
+        {
+            // bypass the delay line and overtake the waiting packets
+            pReleaseTimes[i] = tDeparture;
+            mReorderedPacketCount++;
+        }else
+        {
+            pReleaseTimes[i] = tDeparture + tDelay[i];
+            if (pReleaseTimes[i] < mLastReleaseTime)
+                pReleaseTimes[i] = mLastReleaseTime;
+            mLastReleaseTime = pReleaseTimes[i];
+        }
+    }
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+int64_t SocketImpairment::GetPacketCount()
+{
+    return mPacketCount;
+}
+
+int64_t SocketImpairment::GetLostPacketCount()
+{
+    return mLostPacketCount;
+}
+
+int64_t SocketImpairment::GetQueueDroppedPacketCount()
+{
+    return mQueueDroppedPacketCount;
+}
+
+int64_t SocketImpairment::GetDuplicatedPacketCount()
+{
+    return mDuplicatedPacketCount;
+}
+
+int64_t SocketImpairment::GetReorderedPacketCount()
+{
+    return mReorderedPacketCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SocketImpairmentService::SocketImpairmentService()
+{
+    mWorkerNeeded = false;
+}
+
+SocketImpairmentService::~SocketImpairmentService()
+{
+    Stop();
+}
+
+SocketImpairmentService& SocketImpairmentService::GetInstance()
+{
+    return sSocketImpairmentService;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SocketImpairmentService::Stop()
+{
+    mQueueMutex.lock();
+    bool tWasRunning = mWorkerNeeded;
+    mWorkerNeeded = false;
+    mQueueCondition.Signal();
+    mQueueMutex.unlock();
+
+    if (tWasRunning)
+        StopThread(1000);
+
+    mQueueMutex.lock();
+    FreePackets(mQueue);
+    mQueueMutex.unlock();
+}
+
+void SocketImpairmentService::Enqueue(int64_t pReleaseTime, Socket *pOrigin, string pTargetHost, unsigned int pTargetPort, void *pBuffer, ssize_t pBufferSize)
+{
+    ImpairedPacket tPacket;
+
+    tPacket.Origin = pOrigin;
+    tPacket.Host = pTargetHost;
+    tPacket.Port = pTargetPort;
+    tPacket.Size = pBufferSize;
+    tPacket.Data = (char*)malloc(pBufferSize);
+    memcpy(tPacket.Data, pBuffer, pBufferSize);
+
+    mQueueMutex.lock();
+
+    mQueue.insert(ImpairedPacketQueue::value_type(pReleaseTime, tPacket));
+
+    if (!mWorkerNeeded)
+    {
+        mWorkerNeeded = true;
+        StartThread();
+    }
+    mQueueCondition.Signal();
+
+    mQueueMutex.unlock();
+}
+
+void SocketImpairmentService::Cancel(Socket *pOrigin)
+{
+    // the worker holds the lock while sending, so the socket isn't used anymore afterwards
+    mQueueMutex.lock();
+    FreePackets(mQueue, pOrigin);
+    mQueueMutex.unlock();
+}
+
+void SocketImpairmentService::FreePackets(ImpairedPacketQueue &pQueue, Socket *pOrigin)
+{
+    ImpairedPacketQueue::iterator tIt;
+
+    for (tIt = pQueue.begin(); tIt != pQueue.end();)
+    {
+        if ((pOrigin == NULL) || (tIt->second.Origin == pOrigin))
+        {
+            free(tIt->second.Data);
+            pQueue.erase(tIt++);
+        }else
+            tIt++;
+    }
+}
+
+void* SocketImpairmentService::Run(void* /* pArgs */)
+{
+    ImpairedPacketQueue::iterator tIt;
+    int64_t tNow;
+
+    mQueueMutex.lock();
+    while (mWorkerNeeded)
+    {
+        if (mQueue.empty())
+        {
+            mQueueCondition.Wait(&mQueueMutex);
+            continue;
+        }
+
+        tIt = mQueue.begin();
+        tNow = Time::GetTimeStamp();
+        if (tIt->first > tNow)
+        {
+            int tWaitTime = (int)((tIt->first - tNow) / 1000);
+            mQueueCondition.Wait(&mQueueMutex, (tWaitTime > 0) ? tWaitTime : 1);
+            continue;
+        }
+
+        #ifdef HBSI_DEBUG_PACKETS
+            LOG(LOG_VERBOSE, "Releasing %d delayed bytes towards %s<%u> with a lateness of %"PRId64" us", (int)tIt->second.Size, tIt->second.Host.c_str(), tIt->second.Port, tNow - tIt->first);
+        #endif
+        tIt->second.Origin->SendNow(tIt->second.Host, tIt->second.Port, tIt->second.Data, tIt->second.Size);
+        free(tIt->second.Data);
+        mQueue.erase(tIt);
+    }
+    mQueueMutex.unlock();
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
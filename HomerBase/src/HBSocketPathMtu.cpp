@@ -0,0 +1,391 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of path MTU discovery for datagram sockets
+ * Since:   2014-02-20
+ */
+
+#include <Logger.h>
+#include <HBSocket.h>
+#include <HBSocketPathMtu.h>
+#include <HBTime.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#ifndef WINDOWS
+#include <unistd.h>
+#endif
+
+namespace Homer { namespace Base {
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+PathMtuDiscoveryService sPathMtuDiscoveryService;
+
+///////////////////////////////////////////////////////////////////////////////
+
+PathMtuDiscoveryService::PathMtuDiscoveryService()
+{
+    mWorkerNeeded = false;
+}
+
+PathMtuDiscoveryService::~PathMtuDiscoveryService()
+{
+    Stop();
+}
+
+PathMtuDiscoveryService& PathMtuDiscoveryService::GetInstance()
+{
+    return sPathMtuDiscoveryService;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PathMtuDiscoveryService::Stop()
+{
+    mCacheMutex.lock();
+    bool tWasRunning = mWorkerNeeded;
+    mWorkerNeeded = false;
+    mCacheCondition.Signal();
+    mCacheMutex.unlock();
+
+    // a running search ends after its current probe
+    if (tWasRunning)
+        StopThread(SOCKET_PATH_MTU_PROBE_TIMEOUT * SOCKET_PATH_MTU_PROBE_ATTEMPTS + 1000);
+}
+
+int PathMtuDiscoveryService::GetPathMtu(string pTargetHost)
+{
+    PathMtuCache::iterator tIt;
+    int64_t tNow = Time::GetTimeStamp();
+    int tResult = 0;
+
+    mCacheMutex.lock();
+
+    tIt = mCache.find(pTargetHost);
+    if (tIt == mCache.end())
+    {
+        // the kernel's value is available without any network traffic, the probes follow in the background
+        PathMtuDescriptor tDescriptor;
+        tDescriptor.Mtu = QueryPathMtu(pTargetHost);
+        if (tDescriptor.Mtu > 0)
+        {
+            int tMinMtu = (IS_IPV6_ADDRESS(pTargetHost) ? SOCKET_PATH_MTU_IPv6_MIN : SOCKET_PATH_MTU_IPv4_MIN);
+            if (tDescriptor.Mtu < tMinMtu)
+                tDescriptor.Mtu = tMinMtu;
+        }
+        tDescriptor.Timestamp = 0;
+        tDescriptor.Pending = false;
+        tDescriptor.SearchedMtu = 0;
+        tDescriptor.ProbesAcknowledged = true;
+        tDescriptor.SearchTimestamp = 0;
+        tIt = mCache.insert(PathMtuCache::value_type(pTargetHost, tDescriptor)).first;
+    }
+
+    if ((!tIt->second.Pending) && ((tIt->second.Timestamp == 0) || (tNow - tIt->second.Timestamp > SOCKET_PATH_MTU_REFRESH_PERIOD * 1000 * 1000)))
+    {
+        tIt->second.Pending = true;
+        mPendingHosts.push_back(pTargetHost);
+        if (!mWorkerNeeded)
+        {
+            mWorkerNeeded = true;
+            StartThread();
+        }
+        mCacheCondition.Signal();
+    }
+    tResult = tIt->second.Mtu;
+
+    mCacheMutex.unlock();
+
+    return tResult;
+}
+
+bool PathMtuDiscoveryService::IsDiscovered(string pTargetHost)
+{
+    bool tResult = false;
+
+    mCacheMutex.lock();
+    PathMtuCache::iterator tIt = mCache.find(pTargetHost);
+    if (tIt != mCache.end())
+        tResult = (tIt->second.Timestamp != 0);
+    mCacheMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int PathMtuDiscoveryService::QueryPathMtu(string pTargetHost)
+{
+    int tResult = 0;
+
+    #if defined(LINUX)
+        SocketAddressDescriptor tAddressDescriptor;
+        unsigned int tAddressDescriptorSize;
+
+        // the kernel stores the path MTU per destination, a connected helper socket can read it via IP_MTU
+        if (!Socket::FillAddrDescriptor(pTargetHost, 9 /* discard port, nothing is sent */, &tAddressDescriptor, tAddressDescriptorSize))
+            return 0;
+
+        int tHandle = socket(tAddressDescriptor.sa.sa_family, SOCK_DGRAM, 0);
+        if (tHandle < 0)
+            return 0;
+
+        if (connect(tHandle, &tAddressDescriptor.sa, tAddressDescriptorSize) == 0)
+        {
+            int tValue = 0;
+            socklen_t tValueSize = sizeof(tValue);
+            if (tAddressDescriptor.sa.sa_family == AF_INET6)
+            {
+                if (getsockopt(tHandle, IPPROTO_IPV6, IPV6_MTU, (char*)&tValue, &tValueSize) == 0)
+                    tResult = tValue;
+            }else
+            {
+                if (getsockopt(tHandle, IPPROTO_IP, IP_MTU, (char*)&tValue, &tValueSize) == 0)
+                    tResult = tValue;
+            }
+        }else
+            LOGEX(PathMtuDiscoveryService, LOG_VERBOSE, "Failed to connect path MTU helper socket to %s because %s(%d)", pTargetHost.c_str(), strerror(errno), errno);
+
+        close(tHandle);
+    #endif
+
+    if (tResult > SOCKET_PATH_MTU_MAX)
+        tResult = SOCKET_PATH_MTU_MAX;
+
+    return tResult;
+}
+
+enum PathMtuProbeResult PathMtuDiscoveryService::ProbePathMtu(string pTargetHost, int pMtu)
+{
+    enum PathMtuProbeResult tResult = PATH_MTU_PROBE_LOST;
+
+    #if defined(LINUX)
+        SocketAddressDescriptor tAddressDescriptor;
+        unsigned int tAddressDescriptorSize;
+
+        if (!Socket::FillAddrDescriptor(pTargetHost, SOCKET_PATH_MTU_PROBE_PORT, &tAddressDescriptor, tAddressDescriptorSize))
+            return PATH_MTU_PROBE_LOST;
+
+        int tHandle = socket(tAddressDescriptor.sa.sa_family, SOCK_DGRAM, 0);
+        if (tHandle < 0)
+            return PATH_MTU_PROBE_LOST;
+
+        // DF bit is set and the path MTU known by the kernel is ignored, so a probe may be bigger than it
+        int tValue;
+        if (tAddressDescriptor.sa.sa_family == AF_INET6)
+        {
+            tValue = IPV6_PMTUDISC_PROBE;
+            setsockopt(tHandle, IPPROTO_IPV6, IPV6_MTU_DISCOVER, (char*)&tValue, sizeof(tValue));
+        }else
+        {
+            tValue = IP_PMTUDISC_PROBE;
+            setsockopt(tHandle, IPPROTO_IP, IP_MTU_DISCOVER, (char*)&tValue, sizeof(tValue));
+        }
+
+        int tPayloadSize = pMtu - (tAddressDescriptor.sa.sa_family == AF_INET6 ? IP6_HEADER_SIZE : IP4_HEADER_SIZE) - UDP_HEADER_SIZE;
+        char *tPayload = (char*)calloc(tPayloadSize > 0 ? tPayloadSize : 1, 1);
+
+        // ICMP errors are reported to connected sockets only
+        if ((tPayloadSize > 0) && (connect(tHandle, &tAddressDescriptor.sa, tAddressDescriptorSize) == 0))
+        {
+            for (int i = 0; (i < SOCKET_PATH_MTU_PROBE_ATTEMPTS) && (tResult == PATH_MTU_PROBE_LOST); i++)
+            {
+                if (send(tHandle, tPayload, (size_t)tPayloadSize, MSG_NOSIGNAL) < 0)
+                {
+                    // a pending error of the previous probe of the same size is reported here
+                    if (errno == ECONNREFUSED)
+                        tResult = PATH_MTU_PROBE_ACKNOWLEDGED;
+                    else if (errno == EMSGSIZE)
+                        tResult = PATH_MTU_PROBE_TOO_BIG;
+                    else
+                        break;
+                    continue;
+                }
+
+                fd_set tReadSet;
+                struct timeval tTimeout;
+                int tReady;
+                do
+                {
+                    FD_ZERO(&tReadSet);
+                    FD_SET(tHandle, &tReadSet);
+                    tTimeout.tv_sec = 0;
+                    tTimeout.tv_usec = SOCKET_PATH_MTU_PROBE_TIMEOUT * 1000;
+                    tReady = select(tHandle + 1, &tReadSet, NULL, NULL, &tTimeout);
+                }while ((tReady < 0) && (errno == EINTR));
+                if (tReady <= 0)
+                    continue;
+
+                // a pending ICMP error signals readable data
+                int tError = 0;
+                socklen_t tErrorSize = sizeof(tError);
+                getsockopt(tHandle, SOL_SOCKET, SO_ERROR, (char*)&tError, &tErrorSize);
+                switch(tError)
+                {
+                    case 0: // an answer of a service at the target port
+                    case ECONNREFUSED:
+                        tResult = PATH_MTU_PROBE_ACKNOWLEDGED;
+                        break;
+                    case EMSGSIZE:
+                        tResult = PATH_MTU_PROBE_TOO_BIG;
+                        break;
+                    default:
+                        // e.g., host unreachable: further probes would fail the same way
+                        i = SOCKET_PATH_MTU_PROBE_ATTEMPTS;
+                        break;
+                }
+            }
+        }
+
+        free(tPayload);
+        close(tHandle);
+
+        #ifdef HBS_DEBUG_PACKETS
+            LOGEX(PathMtuDiscoveryService, LOG_VERBOSE, "Probe of %d bytes towards %s: %s", pMtu, pTargetHost.c_str(), (tResult == PATH_MTU_PROBE_ACKNOWLEDGED) ? "acknowledged" : ((tResult == PATH_MTU_PROBE_TOO_BIG) ? "too big" : "lost"));
+        #endif
+    #endif
+
+    return tResult;
+}
+
+int PathMtuDiscoveryService::SearchPathMtu(string pTargetHost, int pMtu, bool &pProbesAcknowledged)
+{
+    int tMinMtu = (IS_IPV6_ADDRESS(pTargetHost) ? SOCKET_PATH_MTU_IPv6_MIN : SOCKET_PATH_MTU_IPv4_MIN);
+    int tFailedMtu = pMtu;
+    enum PathMtuProbeResult tProbeResult;
+
+    pProbesAcknowledged = true;
+
+    // the usual case: the known value is acknowledged, otherwise an ICMP "packet too big" has lowered the kernel's value meanwhile
+    while ((tProbeResult = ProbePathMtu(pTargetHost, tFailedMtu)) == PATH_MTU_PROBE_TOO_BIG)
+    {
+        int tKernelMtu = QueryPathMtu(pTargetHost);
+        if ((tKernelMtu <= 0) || (tKernelMtu >= tFailedMtu))
+            break;
+        tFailedMtu = tKernelMtu;
+    }
+    if (tProbeResult == PATH_MTU_PROBE_ACKNOWLEDGED)
+        return tFailedMtu;
+    if (tFailedMtu <= tMinMtu)
+        return tMinMtu;
+
+    // without any acknowledgment the target filters ICMP or drops the probes, a search wouldn't find anything
+    if (ProbePathMtu(pTargetHost, tMinMtu) != PATH_MTU_PROBE_ACKNOWLEDGED)
+    {
+        LOGEX(PathMtuDiscoveryService, LOG_VERBOSE, "Path MTU probes towards %s aren't acknowledged, using %d bytes without confirmation", pTargetHost.c_str(), pMtu);
+        pProbesAcknowledged = false;
+        return pMtu;
+    }
+
+    // black hole: bigger packets vanish without ICMP feedback, hence the largest acknowledged size is searched
+    //HINT: targets rate limit their ICMP errors, a rate limited acknowledgment only leads to a smaller result
+    int tAcknowledgedMtu = tMinMtu;
+    while (tFailedMtu - tAcknowledgedMtu > SOCKET_PATH_MTU_SEARCH_ACCURACY)
+    {
+        int tMtu = (tAcknowledgedMtu + tFailedMtu) / 2;
+        if (ProbePathMtu(pTargetHost, tMtu) == PATH_MTU_PROBE_ACKNOWLEDGED)
+            tAcknowledgedMtu = tMtu;
+        else
+            tFailedMtu = tMtu;
+    }
+    LOGEX(PathMtuDiscoveryService, LOG_WARN, "Found black hole towards %s: packets bigger than %d bytes vanish without ICMP feedback, the kernel assumes %d bytes", pTargetHost.c_str(), tAcknowledgedMtu, pMtu);
+
+    return tAcknowledgedMtu;
+}
+
+void PathMtuDiscoveryService::Discover(string pTargetHost, PathMtuDescriptor &pDescriptor)
+{
+    int64_t tNow = Time::GetTimeStamp();
+
+    if (tNow - pDescriptor.SearchTimestamp > SOCKET_PATH_MTU_RAISE_PERIOD * 1000 * 1000)
+    {
+        pDescriptor.SearchedMtu = 0;
+        pDescriptor.ProbesAcknowledged = true;
+        pDescriptor.SearchTimestamp = 0;
+    }
+
+    int tMtu = QueryPathMtu(pTargetHost);
+    if (tMtu > 0)
+    {
+        // a black hole limit stays until the raise period is over
+        if ((pDescriptor.SearchedMtu > 0) && (pDescriptor.SearchedMtu < tMtu))
+            tMtu = pDescriptor.SearchedMtu;
+
+        // the value of the kernel only reflects ICMP feedback, a probe confirms it
+        if (pDescriptor.ProbesAcknowledged)
+        {
+            int tSearchedMtu = SearchPathMtu(pTargetHost, tMtu, pDescriptor.ProbesAcknowledged);
+            if ((tSearchedMtu < tMtu) || (!pDescriptor.ProbesAcknowledged))
+            {
+                pDescriptor.SearchedMtu = (tSearchedMtu < tMtu ? tSearchedMtu : 0);
+                pDescriptor.SearchTimestamp = tNow;
+            }
+            tMtu = tSearchedMtu;
+        }
+
+        int tMinMtu = (IS_IPV6_ADDRESS(pTargetHost) ? SOCKET_PATH_MTU_IPv6_MIN : SOCKET_PATH_MTU_IPv4_MIN);
+        if (tMtu < tMinMtu)
+            tMtu = tMinMtu;
+    }
+
+    pDescriptor.Mtu = tMtu;
+    pDescriptor.Timestamp = tNow;
+}
+
+void* PathMtuDiscoveryService::Run(void* /* pArgs */)
+{
+    mCacheMutex.lock();
+    while (mWorkerNeeded)
+    {
+        if (mPendingHosts.empty())
+        {
+            mCacheCondition.Wait(&mCacheMutex);
+            continue;
+        }
+
+        string tHost = mPendingHosts.front();
+        mPendingHosts.pop_front();
+        PathMtuDescriptor tDescriptor = mCache[tHost];
+
+        // the probes take up to seconds, readers of the cache mustn't wait for them
+        mCacheMutex.unlock();
+        int tOldMtu = tDescriptor.Mtu;
+        Discover(tHost, tDescriptor);
+        if (tDescriptor.Mtu != tOldMtu)
+            LOG(LOG_INFO, "Path MTU towards %s changed from %d to %d bytes", tHost.c_str(), tOldMtu, tDescriptor.Mtu);
+        mCacheMutex.lock();
+
+        tDescriptor.Pending = false;
+        mCache[tHost] = tDescriptor;
+    }
+    mCacheMutex.unlock();
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -29,6 +29,7 @@
 #include <Logger.h>
 #include <HBSystem.h>
 #include <HBThread.h>
+#include <HBMutex.h>
 
 #include <stdio.h>
 #include <string.h>
@@ -37,6 +38,7 @@
 
 #if defined(LINUX)
 #include <sys/sysinfo.h>
+#include <sched.h>
 #endif
 
 #if defined(LINUX) || defined(APPLE)
@@ -61,6 +63,20 @@ using namespace std;
 #define MAX_STACK_TRACE_DEPTH             200
 #define MAX_STACK_TRACE_STEP_LENGTH       512
 
+// the following de/activates debugging of cgroup limits
+//#define HBS_DEBUG_CGROUP
+
+#define CGROUP_DEFAULT_ROOT               "/sys/fs/cgroup"
+#define CGROUP_PROCESS_MEMBERSHIP         "/proc/self/cgroup"
+
+// resource values are cached until RefreshResourceLimits() is called
+static Mutex sResourceMutex;
+static string sControlGroupRoot = CGROUP_DEFAULT_ROOT;
+static string sControlGroupMembership = CGROUP_PROCESS_MEMBERSHIP;
+static int sMachineCores = -1;
+static int sEffectiveCores = -1;
+static int64_t sMemoryLimit = -1;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 System::System()
@@ -138,7 +154,11 @@ string System::GetKernelVersion()
 
 int System::GetMachineCores()
 {
-    static int tResult = -1;
+    int tResult;
+
+    sResourceMutex.lock();
+    tResult = sMachineCores;
+    sResourceMutex.unlock();
 
     if (tResult == -1)
     {
@@ -154,6 +174,69 @@ int System::GetMachineCores()
 		#endif
 
 		//LOGEX(System, LOG_VERBOSE, "Found machine cores: %d", tResult);
+
+        sResourceMutex.lock();
+        sMachineCores = tResult;
+        sResourceMutex.unlock();
+    }
+
+    return tResult;
+}
+
+/*
+ * The effective core count is the minimum of:
+ *          - the online cores of the machine
+ *          - the cores of the process' affinity mask (taskset, cpusets)
+ *          - the cgroup CPU quota (cpu.max or cpu.cfs_quota_us/cpu.cfs_period_us), rounded up
+ */
+int System::GetEffectiveCores()
+{
+    int tResult;
+
+    sResourceMutex.lock();
+    tResult = sEffectiveCores;
+    sResourceMutex.unlock();
+
+    if (tResult == -1)
+    {
+        tResult = GetMachineCores();
+
+		#if defined(LINUX)
+			cpu_set_t tCpuSet;
+			CPU_ZERO(&tCpuSet);
+			if (sched_getaffinity(0, sizeof(tCpuSet), &tCpuSet) == 0)
+			{
+				int tAffinityCores = CPU_COUNT(&tCpuSet);
+				if ((tAffinityCores > 0) && (tAffinityCores < tResult))
+					tResult = tAffinityCores;
+			}else
+				LOGEX(System, LOG_WARN, "Failed to determine the CPU affinity of this process");
+
+			int tQuotaCores = GetControlGroupCores();
+			if ((tQuotaCores > 0) && (tQuotaCores < tResult))
+				tResult = tQuotaCores;
+		#endif
+		#if defined(WINDOWS)
+			DWORD_PTR tProcessMask, tSystemMask;
+			if (GetProcessAffinityMask(GetCurrentProcess(), &tProcessMask, &tSystemMask))
+			{
+				int tAffinityCores = 0;
+				for (; tProcessMask != 0; tProcessMask >>= 1)
+					if (tProcessMask & 1)
+						tAffinityCores++;
+				if ((tAffinityCores > 0) && (tAffinityCores < tResult))
+					tResult = tAffinityCores;
+			}
+		#endif
+
+        if (tResult < 1)
+            tResult = 1;
+
+        LOGEX(System, LOG_VERBOSE, "Found effective cores: %d of %d", tResult, GetMachineCores());
+
+        sResourceMutex.lock();
+        sEffectiveCores = tResult;
+        sResourceMutex.unlock();
     }
 
     return tResult;
@@ -276,6 +359,44 @@ int64_t System::GetMachineMemoryPhysical()
     return tResult;
 }
 
+int64_t System::GetMemoryLimit()
+{
+    int64_t tResult;
+
+    sResourceMutex.lock();
+    tResult = sMemoryLimit;
+    sResourceMutex.unlock();
+
+    if (tResult == -1)
+    {
+        tResult = GetControlGroupMemoryLimit();
+
+        // a limit beyond the physical memory doesn't limit anything
+        if (tResult >= GetMachineMemoryPhysical())
+            tResult = 0;
+
+        if (tResult > 0)
+            LOGEX(System, LOG_VERBOSE, "Found memory limit: %"PRId64" MB", tResult / 1024 / 1024);
+
+        sResourceMutex.lock();
+        sMemoryLimit = tResult;
+        sResourceMutex.unlock();
+    }
+
+    return tResult;
+}
+
+int64_t System::GetEffectiveMemoryPhysical()
+{
+    int64_t tResult = GetMachineMemoryPhysical();
+    int64_t tLimit = GetMemoryLimit();
+
+    if ((tLimit > 0) && (tLimit < tResult))
+        tResult = tLimit;
+
+    return tResult;
+}
+
 int64_t System::GetMachineMemorySwap()
 {
     int64_t tResult = 0;
@@ -309,6 +430,236 @@ int64_t System::GetMachineMemorySwap()
     return tResult;
 }
 
+void System::RefreshResourceLimits()
+{
+    sResourceMutex.lock();
+    sMachineCores = -1;
+    sEffectiveCores = -1;
+    sMemoryLimit = -1;
+    sResourceMutex.unlock();
+}
+
+void System::SetControlGroupRoot(string pRoot)
+{
+    LOGEX(System, LOG_VERBOSE, "Setting cgroup root to \"%s\"", pRoot.c_str());
+
+    sResourceMutex.lock();
+    sControlGroupRoot = pRoot;
+    // a fake file system provides the membership of this process as well, e.g., "<root>/proc/self/cgroup"
+    if (pRoot != CGROUP_DEFAULT_ROOT)
+        sControlGroupMembership = pRoot + CGROUP_PROCESS_MEMBERSHIP;
+    else
+        sControlGroupMembership = CGROUP_PROCESS_MEMBERSHIP;
+    sResourceMutex.unlock();
+
+    RefreshResourceLimits();
+}
+
+string System::GetControlGroupRoot()
+{
+    string tResult;
+
+    sResourceMutex.lock();
+    tResult = sControlGroupRoot;
+    sResourceMutex.unlock();
+
+    return tResult;
+}
+
+bool System::ReadControlGroupValue(string pFile, string &pValue)
+{
+    char tLine[256];
+    bool tResult = false;
+
+    pValue = "";
+
+    FILE *tFile = fopen(pFile.c_str(), "r");
+    if (tFile == NULL)
+        return false;
+
+    if (fgets(tLine, sizeof(tLine), tFile) != NULL)
+    {
+        pValue = string(tLine);
+        size_t tEnd = pValue.find_last_not_of(" \t\r\n");
+        if (tEnd != string::npos)
+            pValue.erase(tEnd + 1);
+        else
+            pValue = "";
+        tResult = (pValue != "");
+    }
+    fclose(tFile);
+
+    #ifdef HBS_DEBUG_CGROUP
+        LOGEX(System, LOG_VERBOSE, "Read from %s: \"%s\"", pFile.c_str(), pValue.c_str());
+    #endif
+
+    return tResult;
+}
+
+/*
+ * Returns the directories which may contain limits for this process, the most
+ * specific one first. The membership is taken from /proc/self/cgroup, below a
+ * redirected root from <root>/proc/self/cgroup:
+ *          cgroup v2 => "0::/path"
+ *          cgroup v1 => "<id>:<controller list>:/path"
+ * Inside a container with its own cgroup namespace the membership path is not
+ * visible in the mounted hierarchy, hence each parent directory and the mount
+ * points themselves are checked as well.
+ */
+list<string> System::GetControlGroupDirectories(string pController)
+{
+    list<string> tResult;
+    list<string> tMountPoints;
+    list<string> tPaths;
+    string tRoot, tMembership;
+
+    sResourceMutex.lock();
+    tRoot = sControlGroupRoot;
+    tMembership = sControlGroupMembership;
+    sResourceMutex.unlock();
+
+    // v2: unified hierarchy at the root, v1: controller specific hierarchy
+    tMountPoints.push_back(tRoot);
+    tMountPoints.push_back(tRoot + "/" + pController);
+
+    FILE *tFile = fopen(tMembership.c_str(), "r");
+    if (tFile != NULL)
+    {
+        char tLine[1024];
+        while (fgets(tLine, sizeof(tLine), tFile) != NULL)
+        {
+            string tEntry = string(tLine);
+            size_t tFirstColon = tEntry.find(':');
+            size_t tSecondColon = tEntry.find(':', tFirstColon + 1);
+            if ((tFirstColon == string::npos) || (tSecondColon == string::npos))
+                continue;
+
+            string tControllers = tEntry.substr(tFirstColon + 1, tSecondColon - tFirstColon - 1);
+            string tPath = tEntry.substr(tSecondColon + 1);
+            size_t tEnd = tPath.find_last_not_of(" \t\r\n");
+            tPath = (tEnd != string::npos) ? tPath.substr(0, tEnd + 1) : "";
+
+            if (tControllers == "")
+            {// v2
+                tPaths.push_back(tPath);
+            }else
+            {// v1
+                bool tFound = false;
+                size_t tPos = 0;
+                while (tPos != string::npos)
+                {
+                    size_t tNext = tControllers.find(',', tPos);
+                    string tController = tControllers.substr(tPos, (tNext == string::npos) ? string::npos : tNext - tPos);
+                    if (tController == pController)
+                        tFound = true;
+                    tPos = (tNext == string::npos) ? string::npos : tNext + 1;
+                }
+                if (tFound)
+                {
+                    // mounts like "cpu,cpuacct" are often only available via the combined name
+                    if (tControllers != pController)
+                        tMountPoints.push_back(tRoot + "/" + tControllers);
+                    tPaths.push_back(tPath);
+                }
+            }
+        }
+        fclose(tFile);
+    }
+
+    list<string>::iterator tMountPointIt;
+    for (tMountPointIt = tMountPoints.begin(); tMountPointIt != tMountPoints.end(); tMountPointIt++)
+    {
+        list<string>::iterator tPathIt;
+        for (tPathIt = tPaths.begin(); tPathIt != tPaths.end(); tPathIt++)
+        {
+            string tPath = *tPathIt;
+            while ((tPath != "") && (tPath != "/"))
+            {
+                tResult.push_back(*tMountPointIt + tPath);
+                size_t tSlash = tPath.rfind('/');
+                tPath = (tSlash != string::npos) ? tPath.substr(0, tSlash) : "";
+            }
+        }
+        tResult.push_back(*tMountPointIt);
+    }
+
+    return tResult;
+}
+
+int System::GetControlGroupCores()
+{
+    int tResult = 0;
+
+	#if defined(LINUX)
+		list<string> tDirectories = GetControlGroupDirectories("cpu");
+		list<string>::iterator tIt;
+		for (tIt = tDirectories.begin(); tIt != tDirectories.end(); tIt++)
+		{
+			int64_t tQuota = -1, tPeriod = 0;
+			string tValue;
+
+			if (ReadControlGroupValue(*tIt + "/cpu.max", tValue))
+			{// v2: "<quota> <period>" or "max <period>"
+				size_t tSpace = tValue.find(' ');
+				string tQuotaStr = tValue.substr(0, tSpace);
+				if (tQuotaStr != "max")
+					tQuota = strtoll(tQuotaStr.c_str(), NULL, 10);
+				tPeriod = (tSpace != string::npos) ? strtoll(tValue.substr(tSpace + 1).c_str(), NULL, 10) : 100000;
+			}else if (ReadControlGroupValue(*tIt + "/cpu.cfs_quota_us", tValue))
+			{// v1: quota is -1 if unlimited
+				tQuota = strtoll(tValue.c_str(), NULL, 10);
+				if (ReadControlGroupValue(*tIt + "/cpu.cfs_period_us", tValue))
+					tPeriod = strtoll(tValue.c_str(), NULL, 10);
+			}
+
+			if ((tQuota > 0) && (tPeriod > 0))
+			{
+				int tCores = (int)((tQuota + tPeriod - 1) / tPeriod);
+				#ifdef HBS_DEBUG_CGROUP
+					LOGEX(System, LOG_VERBOSE, "Found CPU quota of %d cores in %s", tCores, (*tIt).c_str());
+				#endif
+				if ((tResult == 0) || (tCores < tResult))
+					tResult = tCores;
+			}
+		}
+	#endif
+
+    return tResult;
+}
+
+int64_t System::GetControlGroupMemoryLimit()
+{
+    int64_t tResult = 0;
+
+	#if defined(LINUX)
+		list<string> tDirectories = GetControlGroupDirectories("memory");
+		list<string>::iterator tIt;
+		for (tIt = tDirectories.begin(); tIt != tDirectories.end(); tIt++)
+		{
+			int64_t tLimit = 0;
+			string tValue;
+
+			// v2: "max" if unlimited, v1: a huge value if unlimited
+			if ((ReadControlGroupValue(*tIt + "/memory.max", tValue)) || (ReadControlGroupValue(*tIt + "/memory.limit_in_bytes", tValue)))
+			{
+				if (tValue != "max")
+					tLimit = strtoll(tValue.c_str(), NULL, 10);
+			}
+
+			if (tLimit > 0)
+			{
+				#ifdef HBS_DEBUG_CGROUP
+					LOGEX(System, LOG_VERBOSE, "Found memory limit of %"PRId64" bytes in %s", tLimit, (*tIt).c_str());
+				#endif
+				if ((tResult == 0) || (tLimit < tResult))
+					tResult = tLimit;
+			}
+		}
+	#endif
+
+    return tResult;
+}
+
 list<string> System::GetStackTrace()
 {
     list<string> tResult;
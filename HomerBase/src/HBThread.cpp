@@ -537,8 +537,8 @@ bool Thread::GetThreadStatistic(int pTid, unsigned long &pMemVirtual, unsigned l
 							tThreadBasicInfo = (thread_basic_info_t)tThreadInfoData;
 							pPriority = tThreadBasicInfo->policy;
 
-							// we need to know how many cores we have to scale the cpu usage
-							int tCores = System::GetMachineCores();
+							// we need to know how many cores we may use to scale the cpu usage
+							int tCores = System::GetEffectiveCores();
 
 							tTimeUserMode = tThreadBasicInfo->user_time.seconds * 1000 * 1000 + tThreadBasicInfo->user_time.microseconds;
 							tTimeKernelMode = tThreadBasicInfo->system_time.seconds * 1000 * 1000 + tThreadBasicInfo->system_time.microseconds;
@@ -107,8 +107,12 @@ public:
 
     /* local I/O interfaces and state */
     bool IsLocalAddress(std::string pHost, std::string pPort, enum TransportType pTransport);
+    /* media receiver in this process, packets towards it bypass the network stack */
+    void SetMediaLoopback(bool pActive); // media streams between endpoints of this process bypass the network stack
+    bool IsLocalMediaEndpoint(std::string pHost, unsigned int pPort, enum TransportType pTransport);
     Socket* GetAudioReceiveSocket(std::string pParticipant, enum TransportType pParticipantTransport);
     Socket* GetVideoReceiveSocket(std::string pParticipant, enum TransportType pParticipantTransport);
+    Socket* GetBundleReceiveSocket(std::string pParticipant, enum TransportType pParticipantTransport); // NULL if bundling wasn't offered to this participant
     Socket* GetAudioSendSocket(std::string pParticipant, enum TransportType pParticipantTransport);
     Socket* GetVideoSendSocket(std::string pParticipant, enum TransportType pParticipantTransport);
     int GetCallState(std::string pParticipant, enum TransportType pParticipantTransport);
@@ -140,7 +144,7 @@ private:
     bool SearchParticipantAndSetOwnContactAddress(std::string pParticipant, enum TransportType pParticipantTransport, std::string pOwnNatIp, unsigned int pOwnNatPort);
     bool SearchParticipantAndSetNuaHandleForMsgs(std::string pParticipant, enum TransportType pParticipantTransport, nua_handle_t *pNuaHandle);
     bool SearchParticipantAndSetNuaHandleForCalls(std::string pParticipant, enum TransportType pParticipantTransport, nua_handle_t *pNuaHandle);
-    bool SearchParticipantAndSetRemoteMediaInformation(std::string pParticipant, enum TransportType pParticipantTransport, std::string pVideoHost, unsigned int pVideoPort, std::string pVideoCodec, unsigned int pPayloadIDVideo, std::string pAudioHost, unsigned int pAudioPort, std::string pAudioCodec, unsigned int pPayloadIDAudio);
+    bool SearchParticipantAndSetRemoteMediaInformation(std::string pParticipant, enum TransportType pParticipantTransport, std::string pVideoHost, unsigned int pVideoPort, std::string pVideoCodec, unsigned int pPayloadIDVideo, std::string pAudioHost, unsigned int pAudioPort, std::string pAudioCodec, unsigned int pPayloadIDAudio, int pAudioPtime = 0, int pAudioMaxPtime = 0, bool pMediaBundling = false);
     nua_handle_t ** SearchParticipantAndGetNuaHandleForCalls(string pParticipant, enum TransportType pParticipantTransport);
     bool SearchParticipantByNuaHandleOrName(string &pUser, string &pHost, string &pPort, nua_handle_t *pNuaHandle);
 
@@ -279,11 +279,15 @@ public:
     unsigned int RemoteAudioPort;
     string RemoteAudioCodec;
     unsigned int NegotiatedRTPAudioPayloadID;
+    int NegotiatedAudioPacketizationTime; // in ms, 0 if not signaled
+    int NegotiatedAudioMaxPacketizationTime; // in ms, 0 if not signaled
 
     string RemoteVideoAddress;
     unsigned int RemoteVideoPort;
     string RemoteVideoCodec;
     unsigned int NegotiatedRTPVideoPayloadID;
+
+    bool RemoteMediaBundling; // audio and video are sent to one port, RTCP multiplexed (RFC 8843)
 };
 
 class CallUnavailableEvent:
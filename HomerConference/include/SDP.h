@@ -55,7 +55,9 @@ namespace Homer { namespace Conference {
 #define CODEC_THEORA                            128
 #define CODEC_VP8                               256
 #define CODEC_HEVC                              512
-#define CODEC_ALL                               0x3FF
+#define CODEC_VP9                               1024
+#define CODEC_AV1                               2048
+#define CODEC_ALL                               0xFFF
 
 enum MediaTransportType{
 	MEDIA_TRANSPORT_UDP = 1,
@@ -66,6 +68,10 @@ enum MediaTransportType{
 	MEDIA_TRANSPORT_RTP_UDP_LITE = 64,
 };
 
+// media identifications for grouping audio and video within one transport flow (RFC 5888, BUNDLE)
+#define SDP_MEDIA_ID_AUDIO                      "audio"
+#define SDP_MEDIA_ID_VIDEO                      "video"
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class SDP
@@ -88,17 +94,27 @@ public:
     void SetAudioTransportType(enum MediaTransportType pType = MEDIA_TRANSPORT_RTP_UDP);
     enum MediaTransportType GetVideoTransportType();
     enum MediaTransportType GetAudioTransportType();
+    /* offer to receive audio and video at one port with RTCP multiplexed, used only if the remote side agrees */
+    void SetMediaBundling(bool pActive = true);
+    bool GetMediaBundling();
+    /* audio packetization time in ms which is desired/accepted for received audio, 0 means not signaled */
+    void SetAudioPacketizationTime(int pPtime, int pMaxPtime);
+    int GetAudioPacketizationTime();
+    int GetAudioMaxPacketizationTime();
 
 private:
     std::string GetMediaTransportStr(enum MediaTransportType pType);
 
 protected:
-    std::string CreateSdpData(int pAudioPort, int pVideoPort);
+    std::string CreateSdpData(int pAudioPort, int pVideoPort, bool pBundled = false); // a bundled description groups audio and video (RFC 8843) and multiplexes RTCP with RTP
 
     int             			mVideoCodec;
     int             			mAudioCodec;
     enum MediaTransportType 	mVideoTransportType;
     enum MediaTransportType 	mAudioTransportType;
+    bool                        mMediaBundling;
+    int                         mAudioPtime;
+    int                         mAudioMaxPtime;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <time.h>
 #include <HBSocket.h>
+#include <MediaLoopback.h>
 
 namespace Homer { namespace Conference {
 
@@ -61,6 +62,10 @@ struct ParticipantDescriptor
     unsigned int   RemoteAudioPort;
     std::string    RemoteAudioCodec;
     unsigned int   RTPPayloadIDAudio;
+    int            AudioPacketizationTime; // in ms, desired by the remote side
+    int            AudioMaxPacketizationTime; // in ms, accepted by the remote side
+    bool           MediaBundling; // offered by us: audio and video may arrive at the video receive socket
+    bool           RemoteMediaBundling; // accepted by the remote side: audio and video are sent to the bundle port
     nua_handle_t   *SipNuaHandleForCalls;
     nua_handle_t   *SipNuaHandleForMsgs;
     nua_handle_t   *SipNuaHandleForOptions;
@@ -83,6 +88,9 @@ Meeting::Meeting() :
 {
     mMeetingInitiated = false;
     mVideoAudioStartPort = 0;
+    // HINT: the local user settings may be applied before Init()
+    mOwnName = "user";
+    mOwnMail = "user@host.com";
 }
 
 Meeting::~Meeting()
@@ -107,6 +115,9 @@ void Meeting::Init(string pLocalGatewayAddress, AddressesList pLocalAddresses, A
 
     mBroadcastIdentifier = pBroadcastIdentifier;
 
+    // media streams towards these addresses can stay inside the process
+    SVC_MEDIA_LOOPBACK.SetLocalAddresses(pLocalAddresses);
+
     ParticipantDescriptor tParticipantDescriptor;
 
     LOG(LOG_VERBOSE, "Setting up session manager..");
@@ -127,9 +138,6 @@ void Meeting::Init(string pLocalGatewayAddress, AddressesList pLocalAddresses, A
     //###################################################################
     //### initiate internal database
     //###################################################################
-    mOwnName = "user";
-    mOwnMail = "user@host.com";
-
     tParticipantDescriptor.User = GetUserName();
     tParticipantDescriptor.Host = pLocalGatewayAddress;
     tParticipantDescriptor.Port = toString(mSipHostPort);
@@ -330,6 +338,10 @@ bool Meeting::OpenParticipantSession(string pUser, string pHost, string pPort, e
         tParticipantDescriptor.RemoteAudioPort = 0;
         tParticipantDescriptor.RemoteAudioCodec = "";
         tParticipantDescriptor.RTPPayloadIDAudio = 0;
+        tParticipantDescriptor.AudioPacketizationTime = 0;
+        tParticipantDescriptor.AudioMaxPacketizationTime = 0;
+        tParticipantDescriptor.MediaBundling = GetMediaBundling();
+        tParticipantDescriptor.RemoteMediaBundling = false;
         tParticipantDescriptor.SipNuaHandleForCalls = NULL;
         tParticipantDescriptor.SipNuaHandleForMsgs = NULL;
         tParticipantDescriptor.SipNuaHandleForOptions = NULL;
@@ -734,6 +746,9 @@ bool Meeting::SendCallAccept(string pParticipant, enum TransportType pParticipan
                 tCMUEvent->RemoteAudioAddress = tIt->RemoteAudioHost;
                 tCMUEvent->RemoteAudioPort = tIt->RemoteAudioPort;
                 tCMUEvent->NegotiatedRTPAudioPayloadID = tIt->RTPPayloadIDAudio;
+                tCMUEvent->NegotiatedAudioPacketizationTime = tIt->AudioPacketizationTime;
+                tCMUEvent->NegotiatedAudioMaxPacketizationTime = tIt->AudioMaxPacketizationTime;
+                tCMUEvent->RemoteMediaBundling = tIt->RemoteMediaBundling;
                 tCMUEvent->RemoteAudioCodec = tIt->RemoteAudioCodec;
                 tCMUEvent->RemoteVideoAddress = tIt->RemoteVideoHost;
                 tCMUEvent->RemoteVideoPort = tIt->RemoteVideoPort;
@@ -755,7 +770,7 @@ bool Meeting::SendCallAccept(string pParticipant, enum TransportType pParticipan
     if(tNeedLoopbackMediaUpdate)
     {
         LOG(LOG_WARN, "Doing loopback media update signaling now..");
-        SearchParticipantAndSetRemoteMediaInformation(tCMUEvent->Sender, tCMUEvent->Transport, tCMUEvent->RemoteVideoAddress, tCMUEvent->RemoteVideoPort, tCMUEvent->RemoteVideoCodec, tCMUEvent->NegotiatedRTPVideoPayloadID, tCMUEvent->RemoteAudioAddress, tCMUEvent->RemoteAudioPort, tCMUEvent->RemoteAudioCodec, tCMUEvent->NegotiatedRTPAudioPayloadID);
+        SearchParticipantAndSetRemoteMediaInformation(tCMUEvent->Sender, tCMUEvent->Transport, tCMUEvent->RemoteVideoAddress, tCMUEvent->RemoteVideoPort, tCMUEvent->RemoteVideoCodec, tCMUEvent->NegotiatedRTPVideoPayloadID, tCMUEvent->RemoteAudioAddress, tCMUEvent->RemoteAudioPort, tCMUEvent->RemoteAudioCodec, tCMUEvent->NegotiatedRTPAudioPayloadID, tCMUEvent->NegotiatedAudioPacketizationTime, tCMUEvent->NegotiatedAudioMaxPacketizationTime, tCMUEvent->RemoteMediaBundling);
         notifyObservers(tCMUEvent);
     }
 
@@ -974,6 +989,7 @@ const char* Meeting::GetSdpData(std::string pParticipant, enum TransportType pPa
     ParticipantList::iterator tIt;
     int tLocalAudioPort;
     int tLocalVideoPort;
+    bool tBundled;
 
 
     LOG(LOG_VERBOSE, "GetSdp for: %s", pParticipant.c_str());
@@ -1002,9 +1018,16 @@ const char* Meeting::GetSdpData(std::string pParticipant, enum TransportType pPa
             tLocalVideoPort = tIt->VideoReceiveSocket->GetLocalPort();
             tLocalAudioPort = tIt->AudioReceiveSocket->GetLocalPort();
 
+            // ##################### bundling ################################
+            // offer bundling as long as the remote side hasn't answered, otherwise only if it agreed
+            tBundled = (tIt->MediaBundling) && (((tIt->RemoteVideoPort == 0) && (tIt->RemoteAudioPort == 0)) || (tIt->RemoteMediaBundling));
+            // the answer to an accepted bundle uses the bundle port for audio, too
+            if ((tBundled) && (tIt->RemoteMediaBundling))
+                tLocalAudioPort = tLocalVideoPort;
+
             // ##################### create SDP string #######################
             // set sdp string
-            tIt->Sdp = CreateSdpData(tLocalAudioPort, tLocalVideoPort);
+            tIt->Sdp = CreateSdpData(tLocalAudioPort, tLocalVideoPort, tBundled);
 
             tResult = tIt->Sdp.c_str();
             //LOG(LOG_VERBOSE, "VPort: %d\n APort: %d\n SDP: %s\n", tLocalVideoPort, tLocalAudioPort, tResult);
@@ -1182,7 +1205,7 @@ bool Meeting::SearchParticipantByNuaHandleOrName(string &pUser, string &pHost, s
     return tFound;
 }
 
-bool Meeting::SearchParticipantAndSetRemoteMediaInformation(std::string pParticipant, enum TransportType pParticipantTransport, std::string pVideoHost, unsigned int pVideoPort, std::string pVideoCodec, unsigned int pPayloadIDVideo, std::string pAudioHost, unsigned int pAudioPort, std::string pAudioCodec, unsigned int pPayloadIDAudio)
+bool Meeting::SearchParticipantAndSetRemoteMediaInformation(std::string pParticipant, enum TransportType pParticipantTransport, std::string pVideoHost, unsigned int pVideoPort, std::string pVideoCodec, unsigned int pPayloadIDVideo, std::string pAudioHost, unsigned int pAudioPort, std::string pAudioCodec, unsigned int pPayloadIDAudio, int pAudioPtime, int pAudioMaxPtime, bool pMediaBundling)
 {
     bool tFound = false;
     ParticipantList::iterator tIt;
@@ -1204,10 +1227,18 @@ bool Meeting::SearchParticipantAndSetRemoteMediaInformation(std::string pPartici
             tIt->RemoteAudioPort = pAudioPort;
             tIt->RemoteAudioCodec = pAudioCodec;
             tIt->RTPPayloadIDAudio = pPayloadIDAudio;
+            tIt->AudioPacketizationTime = pAudioPtime;
+            tIt->AudioMaxPacketizationTime = pAudioMaxPtime;
+            tIt->RemoteMediaBundling = (pMediaBundling) && (tIt->MediaBundling);
             tFound = true;
             LOG(LOG_VERBOSE, "...found");
             LOG(LOG_VERBOSE, "...set remote video information to: %s:%u with codec %s", pVideoHost.c_str(), pVideoPort, pVideoCodec.c_str());
             LOG(LOG_VERBOSE, "...set remote audio information to: %s:%u with codec %s", pAudioHost.c_str(), pAudioPort, pAudioCodec.c_str());
+            LOG(LOG_VERBOSE, "...set media bundling to: %d", tIt->RemoteMediaBundling);
+            if ((tIt->VideoSendSocket != NULL) && (IsLocalMediaEndpoint(pVideoHost, pVideoPort, tIt->VideoSendSocket->GetTransportType())))
+                LOG(LOG_INFO, "...remote video receiver is part of this process, using in-process loopback");
+            if ((tIt->AudioSendSocket != NULL) && (IsLocalMediaEndpoint(pAudioHost, pAudioPort, tIt->AudioSendSocket->GetTransportType())))
+                LOG(LOG_INFO, "...remote audio receiver is part of this process, using in-process loopback");
             break;
         }
     }
@@ -1240,6 +1271,18 @@ bool Meeting::IsLocalAddress(string pHost, string pPort, enum TransportType pTra
     return tFound;
 }
 
+void Meeting::SetMediaLoopback(bool pActive)
+{
+    LOG(LOG_VERBOSE, "Setting media loopback to: %d", pActive);
+    SVC_MEDIA_LOOPBACK.SetEnabled(pActive);
+}
+
+bool Meeting::IsLocalMediaEndpoint(string pHost, unsigned int pPort, enum TransportType pTransport)
+{
+    // the receiver has to be a network listener of this process
+    return SVC_MEDIA_LOOPBACK.IsEnabled() && SVC_MEDIA_LOOPBACK.HasReceiver(pHost, pPort, pTransport);
+}
+
 Socket* Meeting::GetAudioReceiveSocket(string pParticipant, enum TransportType pParticipantTransport)
 {
     Socket *tResult = NULL;
@@ -1274,6 +1317,34 @@ Socket* Meeting::GetAudioReceiveSocket(string pParticipant, enum TransportType p
     return tResult;
 }
 
+Socket* Meeting::GetBundleReceiveSocket(string pParticipant, enum TransportType pParticipantTransport)
+{
+    Socket *tResult = NULL;
+    ParticipantList::iterator tIt;
+
+    LOG(LOG_VERBOSE, "GetBundleSocket for: %s", pParticipant.c_str());
+
+    // lock
+    mParticipantsMutex.lock();
+
+    LOG(LOG_VERBOSE, "Search matching database entry for GetBundleReceiveSocket()");
+    for (tIt = mParticipants.begin(); tIt != mParticipants.end(); tIt++)
+    {
+        if (IsThisParticipant(pParticipant, pParticipantTransport, tIt->User, tIt->Host, tIt->Port, tIt->Transport))
+        {
+            // bundled media arrives at the video receive socket
+            if (tIt->MediaBundling)
+                tResult = tIt->VideoReceiveSocket;
+            LOG(LOG_VERBOSE, "...found");
+        }
+    }
+
+    // unlock
+    mParticipantsMutex.unlock();
+
+    return tResult;
+}
+
 Socket* Meeting::GetVideoReceiveSocket(string pParticipant, enum TransportType pParticipantTransport)
 {
     Socket *tResult = NULL;
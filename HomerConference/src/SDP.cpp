@@ -46,6 +46,9 @@ SDP::SDP()
     mAudioCodec = 0;
     mVideoTransportType = MEDIA_TRANSPORT_RTP_UDP;
     mAudioTransportType = MEDIA_TRANSPORT_RTP_UDP;
+    mMediaBundling = false;
+    mAudioPtime = RTP_AUDIO_PTIME_DEFAULT;
+    mAudioMaxPtime = RTP_AUDIO_PTIME_MAX;
 }
 
 SDP::~SDP()
@@ -133,6 +136,34 @@ enum MediaTransportType SDP::GetAudioTransportType()
     return mAudioTransportType;
 }
 
+void SDP::SetMediaBundling(bool pActive)
+{
+    LOG(LOG_VERBOSE, "Setting media bundling to: %d", pActive);
+    mMediaBundling = pActive;
+}
+
+bool SDP::GetMediaBundling()
+{
+    return mMediaBundling;
+}
+
+void SDP::SetAudioPacketizationTime(int pPtime, int pMaxPtime)
+{
+    LOG(LOG_VERBOSE, "Setting audio packetization time to: %d ms (max.: %d ms)", pPtime, pMaxPtime);
+    mAudioPtime = pPtime;
+    mAudioMaxPtime = pMaxPtime;
+}
+
+int SDP::GetAudioPacketizationTime()
+{
+    return mAudioPtime;
+}
+
+int SDP::GetAudioMaxPacketizationTime()
+{
+    return mAudioMaxPtime;
+}
+
 string SDP::GetMediaTransportStr(enum MediaTransportType pType)
 {
     string tResult = "";
@@ -190,6 +221,10 @@ int SDP::GetSDPCodecIDFromGuiName(std::string pCodecName)
         tResult = CODEC_THEORA;
     if (pCodecName == "VP8")
         tResult = CODEC_VP8;
+    if (pCodecName == "VP9")
+        tResult = CODEC_VP9;
+    if (pCodecName == "AV1")
+        tResult = CODEC_AV1;
 
     // set settings within meeting management
     if (pCodecName == "AMR")
@@ -225,6 +260,8 @@ int SDP::GetSDPCodecIDFromGuiName(std::string pCodecName)
  *        CODEC_MPEG4                   mpeg4
  *        CODEC_THEORA                  theora
  *        CODEC_VP8                     vp8
+ *        CODEC_VP9                     vp9
+ *        CODEC_AV1                     av1
  *
  ****************************************************/
 unsigned int SDP::GetRTPVideoPayloadID(int pCodecID)
@@ -251,6 +288,10 @@ unsigned int SDP::GetRTPVideoPayloadID(int pCodecID)
         tResult = RTP::GetPreferedRTPPayloadIDForCodec("theora");
     if (pCodecID & CODEC_VP8)
         tResult = RTP::GetPreferedRTPPayloadIDForCodec("vp8");
+    if (pCodecID & CODEC_VP9)
+        tResult = RTP::GetPreferedRTPPayloadIDForCodec("vp9");
+    if (pCodecID & CODEC_AV1)
+        tResult = RTP::GetPreferedRTPPayloadIDForCodec("av1");
 
     return tResult;
 }
@@ -292,15 +333,24 @@ unsigned int SDP::GetRTPAudioPayloadID(int pCodecID)
     return tResult;
 }
 
-string SDP::CreateSdpData(int pAudioPort, int pVideoPort)
+string SDP::CreateSdpData(int pAudioPort, int pVideoPort, bool pBundled)
 {
     string tResult = "";
     unsigned int tAudioCodec = GetAudioCodec();
     unsigned int tVideoCodec = GetVideoCodec();
+    bool tBundled = (pBundled) && (tAudioCodec) && (tVideoCodec);
 
     LOG(LOG_VERBOSE, "Create SDP packet for audio port: %d and video port: %d", pAudioPort, pVideoPort);
     LOG(LOG_VERBOSE, "Supported audio codecs: %d and video codecs: %d", tAudioCodec, tVideoCodec);
 
+    // group audio and video within one transport flow
+    if (tBundled)
+    {
+        //HINT: the video port is the bundle port, therefore video is the first (tagged) media description of the group
+        LOG(LOG_VERBOSE, "Bundling audio and video at port: %d", pVideoPort);
+        tResult += "a=group:BUNDLE " SDP_MEDIA_ID_VIDEO " " SDP_MEDIA_ID_AUDIO "\r\n";
+    }
+
     // calculate the new audio sdp string
     if (tAudioCodec)
     {
@@ -309,6 +359,18 @@ string SDP::CreateSdpData(int pAudioPort, int pVideoPort)
 
         tResult += "\r\n";
 
+        if (tBundled)
+        {
+            tResult += "a=mid:" SDP_MEDIA_ID_AUDIO "\r\n";
+            tResult += "a=rtcp-mux\r\n";
+        }
+
+        // packetization time (RFC 4566, 6) and its upper limit (RFC 3267, 8.1)
+        if (mAudioPtime > 0)
+            tResult += "a=ptime:" + toString(mAudioPtime) + "\r\n";
+        if (mAudioMaxPtime > 0)
+            tResult += "a=maxptime:" + toString(mAudioMaxPtime) + "\r\n";
+
         if (tAudioCodec & CODEC_G711ULAW)
             tResult += "a=rtpmap:" + toString(RTP::GetPreferedRTPPayloadIDForCodec("ulaw")) + " PCMU/8000/1\r\n";
         if (tAudioCodec & CODEC_GSM)
@@ -335,6 +397,12 @@ string SDP::CreateSdpData(int pAudioPort, int pVideoPort)
 
         tResult += "\r\n";
 
+        if (tBundled)
+        {
+            tResult += "a=mid:" SDP_MEDIA_ID_VIDEO "\r\n";
+            tResult += "a=rtcp-mux\r\n";
+        }
+
         if (tVideoCodec & CODEC_H261)
             tResult += "a=rtpmap:" + toString(RTP::GetPreferedRTPPayloadIDForCodec("h261")) + " H261/90000\r\n";
         if (tVideoCodec & CODEC_H263)
@@ -355,6 +423,10 @@ string SDP::CreateSdpData(int pAudioPort, int pVideoPort)
             tResult += "a=rtpmap:" + toString(RTP::GetPreferedRTPPayloadIDForCodec("theora")) + " theora/90000\r\n";
         if (tVideoCodec & CODEC_VP8)
             tResult += "a=rtpmap:" + toString(RTP::GetPreferedRTPPayloadIDForCodec("vp8")) + " VP8/90000\r\n";
+        if (tVideoCodec & CODEC_VP9)
+            tResult += "a=rtpmap:" + toString(RTP::GetPreferedRTPPayloadIDForCodec("vp9")) + " VP9/90000\r\n";
+        if (tVideoCodec & CODEC_AV1)
+            tResult += "a=rtpmap:" + toString(RTP::GetPreferedRTPPayloadIDForCodec("av1")) + " AV1/90000\r\n";
     }
 
     LOG(LOG_VERBOSE, "..result: %s", tResult.c_str());
@@ -2891,9 +2891,12 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
     tCMUEvent->RemoteAudioPort = 0;
     tCMUEvent->RemoteAudioAddress = "";
     tCMUEvent->RemoteAudioCodec = "";
+    tCMUEvent->NegotiatedAudioPacketizationTime = 0;
+    tCMUEvent->NegotiatedAudioMaxPacketizationTime = 0;
     tCMUEvent->RemoteVideoPort = 0;
     tCMUEvent->RemoteVideoAddress = "";
     tCMUEvent->RemoteVideoCodec = "";
+    tCMUEvent->RemoteMediaBundling = false;
 
     string tSourceIpStr = InitGeneralEvent_FromSipReceivedResponseEvent(pSipRemote, pSipLocal, pNuaHandle, pSip, tCMUEvent, "CallStateChange", pSourceIp, pSourcePort, pSourcePortTransport);
 
@@ -2948,6 +2951,9 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
             else
             {
                 bool tFoundAudioVideo = false;
+                bool tAudioBundled = false, tVideoBundled = false;
+                string tBundleGroup = "", tBundleTag = "", tBundleAddress = "";
+                unsigned int tBundlePort = 0;
                 sdp_connection_t *tSdpConnection;
                 sdp_media_t *tMedia = tSdpSession->sdp_media;
 
@@ -2957,6 +2963,23 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
                     LOG(LOG_INFO, "CallStateChange-RemoteConnection: %s", tSdpSession->sdp_connection->c_address);
                 }
 
+                // audio and video bundled within one transport flow? (RFC 8843)
+                for (sdp_attribute_t *tSdpGroup = tSdpSession->sdp_attributes; tSdpGroup != NULL; tSdpGroup = tSdpGroup->a_next)
+                {
+                    if ((tSdpGroup->a_name == NULL) || (string(tSdpGroup->a_name) != "group") || (tSdpGroup->a_value == NULL))
+                        continue;
+                    LOG(LOG_INFO, "CallStateChange-Media group: %s", tSdpGroup->a_value);
+                    string tGroup = tSdpGroup->a_value;
+                    if (tGroup.compare(0, 7, "BUNDLE ") == 0)
+                    {
+                        tBundleGroup = " " + tGroup.substr(7) + " ";
+                        // the first identification tag names the m-line whose address and port are shared
+                        size_t tTagStart = tBundleGroup.find_first_not_of(' ');
+                        if (tTagStart != string::npos)
+                            tBundleTag = tBundleGroup.substr(tTagStart, tBundleGroup.find(' ', tTagStart) - tTagStart);
+                    }
+                }
+
                 while (tMedia != NULL)
                 {
                     LOG(LOG_INFO, "CallStateChange-Media type: %s", tMedia->m_type_name);
@@ -2964,6 +2987,7 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
                     LOG(LOG_INFO, "CallStateChange-Media port count: %"PRIu64"", tMedia->m_number_of_ports);
                     LOG(LOG_INFO, "CallStateChange-Media information: %s", tMedia->m_information);
                     LOG(LOG_INFO, "CallStateChange-Transport type: %s", tMedia->m_proto_name);
+                    LOG(LOG_INFO, "CallStateChange-RTCP multiplexed: %d", (sdp_attribute_find(tMedia->m_attributes, "rtcp-mux") != NULL));
                     if (tMedia->m_rtpmaps)
                     {
                         LOG(LOG_INFO, "CallStateChange-RtpMap codec: %s", tMedia->m_rtpmaps->rm_encoding);
@@ -2973,14 +2997,29 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
                         LOG(LOG_INFO, "CallStateChange-RtpMap known entry: %d", tMedia->m_rtpmaps->rm_predef);
                         LOG(LOG_INFO, "CallStateChange-RtpMap payload: %d", tMedia->m_rtpmaps->rm_pt);
                     }
+                    sdp_attribute_t *tSdpAttribute;
                     tSdpConnection = sdp_media_connections(tMedia);
                     if (tSdpConnection == NULL)
                         LOG(LOG_ERROR, "Error when searching SDP media connections data from SDP session media data");
                     else
                     {
+                        // part of the remote bundle? needs its identification tag within the group and RTCP multiplexed with RTP
+                        bool tMediaBundled = false;
+                        tSdpAttribute = sdp_attribute_find(tMedia->m_attributes, "mid");
+                        if ((tSdpAttribute != NULL) && (tSdpAttribute->a_value != NULL) && (tBundleGroup.find(" " + string(tSdpAttribute->a_value) + " ") != string::npos) && (sdp_attribute_find(tMedia->m_attributes, "rtcp-mux") != NULL))
+                        {
+                            tMediaBundled = true;
+                            if (tBundleTag == tSdpAttribute->a_value)
+                            {
+                                tBundleAddress = tSdpConnection->c_address;
+                                tBundlePort = tMedia->m_port;
+                            }
+                        }
+
                         switch (tMedia->m_type)
                         {
                             case sdp_media_audio:
+                                tAudioBundled = tMediaBundled;
                                 tCMUEvent->RemoteAudioAddress = tSdpConnection->c_address;
                                 tCMUEvent->RemoteAudioPort = tMedia->m_port;
                                 tCMUEvent->NegotiatedRTPAudioPayloadID = tMedia->m_rtpmaps->rm_pt;
@@ -2988,6 +3027,15 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
                                     tCMUEvent->RemoteAudioCodec = string(tMedia->m_proto_name) + "(" + string(tMedia->m_rtpmaps->rm_encoding) + ")";
                                 else
                                     tCMUEvent->RemoteAudioCodec = "incompatibly transported. Local transport is " + string(tMedia->m_proto_name);
+                                // packetization time which is desired by the remote side
+                                tSdpAttribute = sdp_attribute_find(tMedia->m_attributes, "ptime");
+                                if ((tSdpAttribute != NULL) && (tSdpAttribute->a_value != NULL))
+                                    tCMUEvent->NegotiatedAudioPacketizationTime = atoi(tSdpAttribute->a_value);
+                                tSdpAttribute = sdp_attribute_find(tMedia->m_attributes, "maxptime");
+                                if ((tSdpAttribute != NULL) && (tSdpAttribute->a_value != NULL))
+                                    tCMUEvent->NegotiatedAudioMaxPacketizationTime = atoi(tSdpAttribute->a_value);
+                                if ((tCMUEvent->NegotiatedAudioPacketizationTime > 0) || (tCMUEvent->NegotiatedAudioMaxPacketizationTime > 0))
+                                    LOG(LOG_INFO, "Remote audio sink for \"%s\" wants packetization time: %d ms (max.: %d ms)", tCMUEvent->Sender.c_str(), tCMUEvent->NegotiatedAudioPacketizationTime, tCMUEvent->NegotiatedAudioMaxPacketizationTime);
                                 tFoundAudioVideo = true;
                                 if (tMedia->m_number_of_ports)
                                     LOG(LOG_INFO, "Remote audio sink for \"%s\" is now at: %s:%u with: %"PRId64" ports", tCMUEvent->Sender.c_str(), tCMUEvent->RemoteAudioAddress.c_str(), tCMUEvent->RemoteAudioPort, tMedia->m_number_of_ports);
@@ -2995,6 +3043,7 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
                                     LOG(LOG_INFO, "Remote audio sink for \"%s\" is now at: %s:%u", tCMUEvent->Sender.c_str(), tCMUEvent->RemoteAudioAddress.c_str(), tCMUEvent->RemoteAudioPort);
                                 break;
                             case sdp_media_video:
+                                tVideoBundled = tMediaBundled;
                                 tCMUEvent->RemoteVideoAddress = tSdpConnection->c_address;
                                 tCMUEvent->RemoteVideoPort = tMedia->m_port;
                                 tCMUEvent->NegotiatedRTPVideoPayloadID = tMedia->m_rtpmaps->rm_pt;
@@ -3012,11 +3061,21 @@ void SIP::SipReceivedCallStateChange(const sip_to_t *pSipRemote, const sip_to_t
                     }
                     tMedia = tMedia->m_next;
                 }
+                // use the bundle only if we offered it to this participant, otherwise audio and video keep their own ports
+                if ((tAudioBundled) && (tVideoBundled) && (tBundlePort != 0) && (MEETING.GetBundleReceiveSocket(tCMUEvent->Sender, tCMUEvent->Transport) != NULL))
+                {
+                    LOG(LOG_INFO, "Remote audio and video sinks for \"%s\" are bundled at: %s:%u", tCMUEvent->Sender.c_str(), tBundleAddress.c_str(), tBundlePort);
+                    tCMUEvent->RemoteMediaBundling = true;
+                    tCMUEvent->RemoteAudioAddress = tBundleAddress;
+                    tCMUEvent->RemoteAudioPort = tBundlePort;
+                    tCMUEvent->RemoteVideoAddress = tBundleAddress;
+                    tCMUEvent->RemoteVideoPort = tBundlePort;
+                }
                 if (tFoundAudioVideo)
                 {
                     LOG(LOG_VERBOSE, "Audio codec: %s", tCMUEvent->RemoteAudioCodec.c_str());
                     LOG(LOG_VERBOSE, "Video codec: %s", tCMUEvent->RemoteVideoCodec.c_str());
-                    MEETING.SearchParticipantAndSetRemoteMediaInformation(tCMUEvent->Sender, tCMUEvent->Transport, tCMUEvent->RemoteVideoAddress, tCMUEvent->RemoteVideoPort, tCMUEvent->RemoteVideoCodec, tCMUEvent->NegotiatedRTPVideoPayloadID, tCMUEvent->RemoteAudioAddress, tCMUEvent->RemoteAudioPort, tCMUEvent->RemoteAudioCodec, tCMUEvent->NegotiatedRTPAudioPayloadID);
+                    MEETING.SearchParticipantAndSetRemoteMediaInformation(tCMUEvent->Sender, tCMUEvent->Transport, tCMUEvent->RemoteVideoAddress, tCMUEvent->RemoteVideoPort, tCMUEvent->RemoteVideoCodec, tCMUEvent->NegotiatedRTPVideoPayloadID, tCMUEvent->RemoteAudioAddress, tCMUEvent->RemoteAudioPort, tCMUEvent->RemoteAudioCodec, tCMUEvent->NegotiatedRTPAudioPayloadID, tCMUEvent->NegotiatedAudioPacketizationTime, tCMUEvent->NegotiatedAudioMaxPacketizationTime, tCMUEvent->RemoteMediaBundling);
                     MEETING.notifyObservers(tCMUEvent);
                 }
             }
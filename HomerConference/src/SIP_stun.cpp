@@ -96,6 +96,9 @@ void SIP_stun::Init(su_root_t* pSipRoot)
     	// get port number after auto-probing available ports
     	mStunHostPort = tSocket->GetLocalPort();
 
+    	// mark STUN packets as signalling
+    	tSocket->SetTuning(SOCKET_TUNING_PROFILE_SIGNALLING);
+
     	// store the handle for the created socket
     	mStunContext->Socket = tSocket->GetHandle();
     }else
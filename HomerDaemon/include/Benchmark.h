@@ -0,0 +1,138 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: micro benchmarks of the media processing, started via the command line of the daemon
+ * Since:   2014-02-13
+ */
+
+#ifndef _DAEMON_BENCHMARK_
+#define _DAEMON_BENCHMARK_
+
+#include <string>
+
+namespace Homer { namespace Daemon {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// audio packetization: simulated audio duration per stream in s
+#define BENCHMARK_AUDIO_DURATION                    60
+// audio packetization: amount of simultaneously packetized streams
+#define BENCHMARK_AUDIO_STREAMS                     16
+
+// video codecs: resolution, frame rate and amount of frames of the synthetic test sequence
+#define BENCHMARK_VIDEO_WIDTH                       640
+#define BENCHMARK_VIDEO_HEIGHT                      480
+#define BENCHMARK_VIDEO_FPS                         30
+#define BENCHMARK_VIDEO_FRAMES                      300
+
+// reliable transport: amount of transferred messages, first probed local port and max. transfer duration in s
+#define BENCHMARK_RDT_MESSAGES                      600
+#define BENCHMARK_RDT_PORT                          5300
+#define BENCHMARK_RDT_TIMEOUT                       60
+
+// shared memory: amount and size of the transferred packets and first probed local port of the network sink
+#define BENCHMARK_SHM_PACKETS                       100000
+#define BENCHMARK_SHM_PACKET_SIZE                   1200
+#define BENCHMARK_SHM_PORT                          5400
+
+// path MTU: amount of transferred datagrams per size and first probed local port, the MTU of the loopback device has to be reduced to at most BENCHMARK_PMTU_DEVICE_MTU_MAX
+#define BENCHMARK_PMTU_PACKETS                      100
+#define BENCHMARK_PMTU_PORT                         5500
+#define BENCHMARK_PMTU_DEVICE_MTU_MAX               4096
+
+// encoder switch: grabbed frames per step, each step starts with a live reconfiguration of the encoder
+#define BENCHMARK_SWITCH_STEP_FRAMES                90
+
+// shared demuxer: duration of the synthetic test file with one video and one audio stream in s
+#define BENCHMARK_DEMUXER_DURATION                  20
+
+// rate control: grabbed frames per setting, long enough for several periodic key frames
+#define BENCHMARK_RATE_CONTROL_FRAMES               300
+
+// A/V synchronization: simulated duration per offset and the final part of it which has to be in sync, in s
+#define BENCHMARK_AV_SYNC_DURATION                  20
+#define BENCHMARK_AV_SYNC_EVALUATION_TIME           5
+
+// bundling: amount of participants which send audio and video, duration of the transfer in s and first probed local port
+#define BENCHMARK_BUNDLE_PARTICIPANTS               20
+#define BENCHMARK_BUNDLE_DURATION                   10
+#define BENCHMARK_BUNDLE_PORT                       5600
+
+// memory budget: amount of synthetic streams with one FIFO each, every second one is in the background, and entries per FIFO
+#define BENCHMARK_BUDGET_STREAMS                    8
+#define BENCHMARK_BUDGET_FIFO_ENTRIES               32
+
+// first frame: amount of opened receivers per mode and first probed local port
+#define BENCHMARK_FIRST_FRAME_RUNS                  5
+#define BENCHMARK_FIRST_FRAME_PORT                  5700
+
+// media loopback: duration of the stream in s per path and first probed local port
+#define BENCHMARK_LOOPBACK_DURATION                 10
+#define BENCHMARK_LOOPBACK_PORT                     5800
+
+///////////////////////////////////////////////////////////////////////////////
+
+class Benchmark
+{
+public:
+    /* returns false if the benchmark is unknown or failed */
+    static bool Run(std::string pName);
+    static std::string GetNames();
+
+private:
+    /* packet rate and CPU time per audio stream depending on the packetization time */
+    static bool AudioPacketization();
+    /* quality (PSNR) and encoding time per video codec depending on the bit rate, encoded and decoded on the CPU */
+    static bool VideoCodecs();
+    /* completeness, integrity, order and per message latency of a loopback transfer via the reliable datagram transport under loss, reordering and duplication, compared to TCP */
+    static bool ReliableTransport();
+    /* throughput and loss of the shared memory sink compared to the network sink via loopback */
+    static bool SharedMemory();
+    /* discovered path MTU compared to the reduced MTU of the loopback device and delivery of datagrams at and beyond the discovered limit */
+    static bool PathMtu();
+    /* gap in the outgoing stream and blocking of the capture thread during live reconfigurations of the encoder, fed by a synthetic camera */
+    static bool EncoderSwitch();
+    /* bytes read from the file and demuxer calls for a video and an audio source of the same file, with a shared demuxer and with one demuxer per source */
+    static bool SharedDemuxer();
+    /* frame size deviation and peak burst of the encoder output with and without real-time rate control (VBV, intra refresh), fed by a synthetic camera */
+    static bool RateControl();
+    /* residual skew, convergence time and adjustments of the A/V synchronization for a video and an audio source with known offsets, simulated loopback on a virtual clock */
+    static bool AvSync();
+    /* receive sockets, threads, wakeups and CPU time for participants with audio and video via UDP loopback, with one bundle socket per participant and with one socket per medium */
+    static bool Bundling();
+    /* memory of the media FIFOs of foreground and background streams for several budgets, the budget has to hold and the background streams have to be shrunk first */
+    static bool MemoryBudget();
+    /* time from opening a receiver of a running RTP stream via UDP loopback to its first frame, with the stream described by the negotiated codec and with FFmpeg probing */
+    static bool FirstFrame();
+    /* effective cores and memory limit for fake cgroup v1 and v2 file systems in a temporary directory, compared to the written quotas and limits */
+    static bool ControlGroups();
+    /* notifications, generation bumps and probes of the device registry while fake device files are added to and removed from a temporary device directory */
+    static bool DeviceHotplug();
+    /* sent, received and lost packets of an RTP stream from a network sink to a receiver in the same process, through the UDP stack and via the media loopback */
+    static bool Loopback();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
@@ -0,0 +1,124 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: headless conference and streaming node without any GUI
+ * Since:   2014-02-10
+ */
+
+#ifndef _DAEMON_DAEMON_
+#define _DAEMON_DAEMON_
+
+#include <DaemonConfiguration.h>
+#include <StreamRelay.h>
+#include <Meeting.h>
+#include <MeetingEvents.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
+
+#include "BuildConfigHomer.h"
+
+#include <list>
+#include <string>
+
+namespace Homer { namespace Daemon {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define DAEMON_USER_AGENT_SUFFIX                    "/"HOMER_VERSION" (daemon)"
+
+// how long the main loop waits for meeting events before it checks for shutdown requests and statistic periods
+#define DAEMON_EVENT_WAIT_TIME                      250 // in ms
+
+// default period for logging the statistic
+#define DAEMON_DEFAULT_STATISTIC_PERIOD             30 // in s
+
+struct DaemonParticipant
+{
+    std::string         Name;
+    enum Homer::Base::TransportType Transport;
+    Homer::Multimedia::MediaSinkNet *VideoSink;
+    Homer::Multimedia::MediaSinkNet *AudioSink;
+};
+
+typedef std::list<DaemonParticipant> DaemonParticipants;
+typedef std::list<Homer::Conference::GeneralEvent*> DaemonMeetingEvents;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Replaces MainWindow for server deployments: wires the conference
+ * management and the configured stream relays together. Meeting events are
+ * queued by the SIP thread and processed in the main loop, like the GUI does
+ * it via the Qt event loop.
+ */
+class Daemon:
+    public Homer::Conference::MeetingObserver
+{
+public:
+    Daemon();
+
+    virtual ~Daemon();
+
+    bool Init(std::string pConfigurationFile);
+    void Run(); // returns after a shutdown was requested
+    void Deinit();
+
+    /* can be called from a signal handler */
+    void RequestShutdown();
+
+private:
+    void InitLogging();
+    bool InitConference();
+    void InitEncoderCalibration();
+    void InitStreams();
+    bool GetNetworkInfo(Homer::Conference::AddressesList &pLocalAddressesList, Homer::Conference::AddressesList &pLocalAddressesNetmaskList, std::string &pLocalGatewayIp, std::string &pLocalLoopIp);
+
+    /* meeting events */
+    virtual void handleMeetingEvent(Homer::Conference::GeneralEvent *pEvent);
+    void ProcessMeetingEvent(Homer::Conference::GeneralEvent *pEvent);
+    DaemonParticipant* GetParticipant(std::string pParticipant, enum Homer::Base::TransportType pTransport);
+    void AddParticipant(std::string pParticipant, enum Homer::Base::TransportType pTransport);
+    void UpdateParticipantMedia(Homer::Conference::CallMediaUpdateEvent *pEvent);
+    void RemoveParticipant(std::string pParticipant, enum Homer::Base::TransportType pTransport);
+
+    /* statistic */
+    void LogStatistic();
+
+    DaemonConfiguration mConfiguration;
+    StreamRelays        mStreamRelays;
+    StreamRelay         *mConferenceVideo;
+    StreamRelay         *mConferenceAudio;
+    DaemonParticipants  mParticipants;
+    DaemonMeetingEvents mMeetingEvents;
+    Homer::Base::Mutex  mMeetingEventsMutex;
+    Homer::Base::Condition mMeetingEventsCondition;
+    bool                mConferenceEnabled;
+    bool                mAcceptCalls;
+    int                 mStatisticPeriod;
+    volatile bool       mShutdownRequested;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespaces
+
+#endif
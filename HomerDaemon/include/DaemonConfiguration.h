@@ -0,0 +1,120 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: settings of the headless daemon, read from a configuration file
+ * Since:   2014-02-10
+ */
+
+#ifndef _DAEMON_CONFIGURATION_
+#define _DAEMON_CONFIGURATION_
+
+#include <MediaSource.h>
+
+#include <list>
+#include <string>
+
+namespace Homer { namespace Daemon {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define DAEMON_CONFIGURATION_DEFAULT_FILE           "HomerDaemon.conf"
+
+// sections of the configuration file
+#define DAEMON_SECTION_GENERAL                      "General"
+#define DAEMON_SECTION_CONFERENCE                   "Conference"
+#define DAEMON_SECTION_STREAM                       "Stream"
+
+struct StreamDescriptor
+{
+    std::string         Name;
+    enum Homer::Multimedia::MediaType Type;
+    /* input: "FILE: <file>", "NET: <port>/<transport>" or "SHM: <name>" */
+    std::string         Input;
+    std::string         InputCodec; /* only for NET and SHM inputs */
+    bool                InputRtp;
+    bool                Loop; /* restart FILE inputs at EOF */
+    /* encoder */
+    std::string         Codec;
+    int                 Quality;
+    int                 BitRate;
+    int                 MaxPacketSize;
+    int                 ResX;
+    int                 ResY;
+    int                 Fps;
+    int                 SampleRate;
+    int                 Channels;
+    bool                Rtp;
+    /* outputs: "NET: <host>:<port>/<transport>", "FILE: <file>" or "SHM: <name>" */
+    std::list<std::string> Outputs;
+    bool                Conference; /* send this stream to each conference participant */
+};
+
+typedef std::list<StreamDescriptor> StreamDescriptors;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Reads an INI-like file: "[Section]" headers followed by "Key = Value"
+ * lines, '#' and ';' start a comment line. A key may be repeated, e.g., for
+ * multiple outputs of one stream.
+ */
+class DaemonConfiguration
+{
+public:
+    DaemonConfiguration();
+
+    virtual ~DaemonConfiguration();
+
+    bool Load(std::string pFileName);
+    std::string GetFileName();
+
+    /* raw access */
+    std::list<std::string> GetSections(std::string pPrefix = "");
+    std::string GetString(std::string pSection, std::string pKey, std::string pDefault = "");
+    std::list<std::string> GetStrings(std::string pSection, std::string pKey);
+    int GetInt(std::string pSection, std::string pKey, int pDefault = 0);
+    bool GetBool(std::string pSection, std::string pKey, bool pDefault = false);
+
+    /* streams */
+    StreamDescriptors GetStreams();
+
+private:
+    struct ConfigurationEntry
+    {
+        std::string     Section;
+        std::string     Key;
+        std::string     Value;
+    };
+    typedef std::list<ConfigurationEntry> ConfigurationEntries;
+
+    static std::string Trim(std::string pString);
+    static std::string ToLower(std::string pString);
+
+    std::string         mFileName;
+    ConfigurationEntries mEntries;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespaces
+
+#endif
@@ -0,0 +1,106 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: relays one configured input stream via a muxer towards its outputs
+ * Since:   2014-02-10
+ */
+
+#ifndef _DAEMON_STREAM_RELAY_
+#define _DAEMON_STREAM_RELAY_
+
+#include <DaemonConfiguration.h>
+#include <MediaSourceMuxer.h>
+#include <MediaSinkNet.h>
+#include <HBThread.h>
+#include <HBSocket.h>
+
+#include <list>
+#include <string>
+
+namespace Homer { namespace Daemon {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of grabbed chunks
+//#define DAEMON_DEBUG_RELAY
+
+// how long do we wait before we try to reopen a failed input
+#define STREAM_RELAY_REOPEN_DELAY                   (1000 * 1000) // in us
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Replaces the GUI's video/audio worker threads: grabs chunks from the
+ * muxer, which encodes them and distributes the packets to all registered
+ * sinks. Nothing is rendered, the grabbed chunk is only used for statistics.
+ */
+class StreamRelay:
+    public Homer::Base::Thread
+{
+public:
+    StreamRelay(StreamDescriptor pDescriptor);
+
+    virtual ~StreamRelay();
+
+    bool Start();
+    void Stop();
+
+    std::string GetName();
+    enum Homer::Multimedia::MediaType GetMediaType();
+    bool IsConferenceFeed();
+    Homer::Multimedia::MediaSourceMuxer* GetMuxer();
+
+    /* conference participants */
+    Homer::Multimedia::MediaSinkNet* AddParticipant(std::string pParticipant, std::string pHost, unsigned int pPort, Homer::Base::Socket *pSocket, unsigned int pPayloadId, int pAudioPtime = 0, int pAudioMaxPtime = 0);
+    void RemoveParticipant(Homer::Multimedia::MediaSinkNet *pSink);
+
+    /* statistic */
+    void LogStatistic();
+
+private:
+    Homer::Multimedia::MediaSource* CreateInput();
+    bool OpenInput();
+    void RegisterOutputs();
+    Homer::Multimedia::MediaSink* RegisterOutput(std::string pOutput);
+
+    virtual void* Run(void* pArgs = NULL);
+
+    StreamDescriptor    mDescriptor;
+    Homer::Multimedia::MediaSource *mInput;
+    Homer::Multimedia::MediaSourceMuxer *mMuxer;
+    void                *mChunkBuffer;
+    int                 mChunkBufferSize;
+    bool                mInputOpened;
+    bool                mRelayNeeded;
+    int64_t             mGrabbedChunks;
+    int64_t             mLostChunks;
+    int64_t             mInputRestarts;
+    int                 mLastChunkNumber;
+};
+
+typedef std::list<StreamRelay*> StreamRelays;
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespaces
+
+#endif
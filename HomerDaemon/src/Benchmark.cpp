@@ -0,0 +1,2940 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of micro benchmarks
+ * Since:   2014-02-13
+ */
+
+#include <Benchmark.h>
+#include <MediaSource.h>
+#include <MediaDemuxer.h>
+#include <MediaDeviceRegistry.h>
+#include <MediaEncoderCalibration.h>
+#include <MediaFifo.h>
+#include <MediaLoopback.h>
+#include <MediaMemoryBudget.h>
+#include <MediaShmRing.h>
+#include <MediaSink.h>
+#include <MediaSinkNet.h>
+#include <MediaSinkShm.h>
+#include <MediaSourceNet.h>
+#include <MediaSourceMuxer.h>
+#include <MediaSynchronizer.h>
+#include <RTP.h>
+#include <Berkeley/ReliableDatagramTransport.h>
+#include <HBSocket.h>
+#include <HBSocketImpairment.h>
+#include <HBSocketPathMtu.h>
+#include <HBMutex.h>
+#include <HBSystem.h>
+#include <HBThread.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#if defined(LINUX)
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Homer { namespace Daemon {
+
+using namespace std;
+using namespace Homer::Base;
+using namespace Homer::Multimedia;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// size of IPv4 and UDP header, added to each packet for calculating the data rate on the wire
+#define BENCHMARK_IP_UDP_HEADER_SIZE                28
+
+// max. RTP packet size of the benchmarked streams
+#define BENCHMARK_RTP_PACKET_SIZE                   1280
+
+// PSNR value which is reported for lossless pictures
+#define BENCHMARK_PSNR_MAX                          99.0
+
+// reliable transport: size of the receive buffer, smaller than most messages to receive them in several parts
+#define BENCHMARK_RDT_RECEIVE_BUFFER                1000
+// reliable transport: size of the TCP receive buffer, a stream is read in large parts because small reads keep the TCP receive window closed
+#define BENCHMARK_RDT_TCP_RECEIVE_BUFFER            (64 * 1024)
+// reliable transport: size of the message header (index, size, domain)
+#define BENCHMARK_RDT_HEADER_SIZE                   10
+// reliable transport: time in ms which the TCP receiver gets to start listening before the sender connects
+#define BENCHMARK_RDT_TCP_LISTEN_DELAY              200
+
+// shared memory: the consumer is stopped after this time without any received packet, in ms
+#define BENCHMARK_SHM_IDLE_TIMEOUT                  1000
+
+// path MTU: additional bytes of the datagrams which exceed the discovered limit
+#define BENCHMARK_PMTU_OVERSIZE                     100
+// path MTU: max. time for the background discovery, in s
+#define BENCHMARK_PMTU_DISCOVERY_TIMEOUT            10
+
+// encoder switch: codec and bit rate of the outgoing stream
+#define BENCHMARK_SWITCH_CODEC                      "H.264"
+#define BENCHMARK_SWITCH_BIT_RATE                   (500 * 1024)
+// encoder switch: max. gap in the outgoing stream in frame intervals, frames of a new grab resolution wait for the new encoder
+#define BENCHMARK_SWITCH_MAX_GAP_FRAMES             3
+
+// shared demuxer: location of the synthetic test file and the size of its raw audio packets in samples
+#define BENCHMARK_DEMUXER_FILE                      "/tmp/homer-benchmark-demuxer.mkv"
+#define BENCHMARK_DEMUXER_SAMPLE_RATE               44100
+#define BENCHMARK_DEMUXER_AUDIO_FRAME_SIZE          1024
+
+// rate control: codec and target bit rate in bit/s, time in ms which the encoder thread gets for the last frames
+#define BENCHMARK_RATE_CONTROL_CODEC                "H.264"
+#define BENCHMARK_RATE_CONTROL_BIT_RATE             (500 * 1000)
+#define BENCHMARK_RATE_CONTROL_DRAIN_TIME           500
+
+// A/V synchronization: play-out latency of the video in ms, max. jitter of the master clock in ms and the time in ms between scheduling and presenting a video frame
+#define BENCHMARK_AV_SYNC_VIDEO_LATENCY             100
+#define BENCHMARK_AV_SYNC_JITTER                    4
+#define BENCHMARK_AV_SYNC_PRESENTATION_DELAY        20
+
+// bundling: audio codec and its packetization time in ms, video codec with its resolution and bit rate in bit/s, time in ms which the receivers get for the last packets
+#define BENCHMARK_BUNDLE_AUDIO_CODEC                "G711 A-law"
+#define BENCHMARK_BUNDLE_AUDIO_PTIME                20
+#define BENCHMARK_BUNDLE_VIDEO_CODEC                "H.263"
+#define BENCHMARK_BUNDLE_VIDEO_WIDTH                352
+#define BENCHMARK_BUNDLE_VIDEO_HEIGHT               288
+#define BENCHMARK_BUNDLE_VIDEO_BIT_RATE             (256 * 1000)
+#define BENCHMARK_BUNDLE_DRAIN_TIME                 1000
+
+// memory budget: size of one FIFO entry in bytes
+#define BENCHMARK_BUDGET_FIFO_ENTRY_SIZE            (64 * 1024)
+
+// first frame: codec and bit rate in bit/s of the stream, max. time in s until the first frame and pause in ms between two receivers
+#define BENCHMARK_FIRST_FRAME_CODEC                 "H.264"
+#define BENCHMARK_FIRST_FRAME_BIT_RATE              (500 * 1000)
+#define BENCHMARK_FIRST_FRAME_TIMEOUT               10
+#define BENCHMARK_FIRST_FRAME_PAUSE                 300
+
+// control groups: template of the temporary directory which gets the fake cgroup file systems
+#define BENCHMARK_CGROUP_ROOT_TEMPLATE              "/tmp/homer-benchmark-cgroup-XXXXXX"
+
+// device hotplug: template of the temporary device directory, prefix of the fake video device files, max. time in ms until a notification and time in ms which the hotplug thread gets for further events
+#define BENCHMARK_HOTPLUG_DIRECTORY_TEMPLATE        "/tmp/homer-benchmark-devices-XXXXXX"
+#define BENCHMARK_HOTPLUG_PREFIX                    "benchmark"
+#define BENCHMARK_HOTPLUG_TIMEOUT                   2000
+#define BENCHMARK_HOTPLUG_SETTLE_TIME               300
+
+// media loopback: codec and bit rate in bit/s of the stream, time in ms which the receiver gets for the last packets
+#define BENCHMARK_LOOPBACK_CODEC                    "H.264"
+#define BENCHMARK_LOOPBACK_BIT_RATE                 (500 * 1000)
+#define BENCHMARK_LOOPBACK_DRAIN_TIME               1000
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Benchmark::Run(string pName)
+{
+    if (pName == "AudioPacketization")
+        return AudioPacketization();
+    if (pName == "VideoCodecs")
+        return VideoCodecs();
+    if (pName == "ReliableTransport")
+        return ReliableTransport();
+    if (pName == "SharedMemory")
+        return SharedMemory();
+    if (pName == "PathMtu")
+        return PathMtu();
+    if (pName == "EncoderSwitch")
+        return EncoderSwitch();
+    if (pName == "SharedDemuxer")
+        return SharedDemuxer();
+    if (pName == "RateControl")
+        return RateControl();
+    if (pName == "AvSync")
+        return AvSync();
+    if (pName == "Bundling")
+        return Bundling();
+    if (pName == "MemoryBudget")
+        return MemoryBudget();
+    if (pName == "FirstFrame")
+        return FirstFrame();
+    if (pName == "ControlGroups")
+        return ControlGroups();
+    if (pName == "DeviceHotplug")
+        return DeviceHotplug();
+    if (pName == "Loopback")
+        return Loopback();
+
+    LOGEX(Benchmark, LOG_ERROR, "Unknown benchmark \"%s\", supported are: %s", pName.c_str(), GetNames().c_str());
+
+    return false;
+}
+
+string Benchmark::GetNames()
+{
+    return "AudioPacketization, VideoCodecs, ReliableTransport, SharedMemory, PathMtu, EncoderSwitch, SharedDemuxer, RateControl, AvSync, Bundling, MemoryBudget, FirstFrame, ControlGroups, DeviceHotplug, Loopback";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Benchmark::AudioPacketization()
+{
+    static const int    sPtimes[] = {20, 40, 60, 120};
+    AVFormatContext     *tFormatContext;
+    AVStream            *tStream;
+    AVCodec             *tCodec;
+    int                 tRes;
+
+    MediaSource::FfmpegInit();
+
+    //######################################################
+    //### create the PCMA stream, which is packetized by each benchmarked RTP instance
+    //######################################################
+    tCodec = avcodec_find_encoder(AV_CODEC_ID_PCM_ALAW);
+    if (tCodec == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't find PCMA encoder");
+        return false;
+    }
+
+    tFormatContext = AV_NEW_FORMAT_CONTEXT();
+    tStream = HM_avformat_new_stream(tFormatContext, tCodec);
+    if (tStream == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Memory allocation failed");
+        av_free(tFormatContext);
+        return false;
+    }
+    tStream->codec->codec_type = AVMEDIA_TYPE_AUDIO;
+    tStream->codec->codec_id = AV_CODEC_ID_PCM_ALAW;
+    tStream->codec->sample_rate = 8000;
+    tStream->codec->channels = 1;
+    tStream->codec->channel_layout = HM_av_get_default_channel_layout(1);
+    tStream->codec->sample_fmt = AV_SAMPLE_FMT_S16;
+    tStream->codec->rtp_payload_size = BENCHMARK_RTP_PACKET_SIZE;
+    tStream->time_base = (AVRational){1, 8000};
+    if ((tRes = HM_avcodec_open(tStream->codec, tCodec, NULL)) < 0)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't open PCMA encoder because \"%s\"", strerror(AVUNERROR(tRes)));
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+
+    // one encoded frame of the default packetization time, the content doesn't influence the packetizer
+    int tFrameSize = tStream->codec->sample_rate * RTP_AUDIO_PTIME_DEFAULT / 1000;
+    int tFrames = BENCHMARK_AUDIO_DURATION * 1000 / RTP_AUDIO_PTIME_DEFAULT;
+    uint8_t *tFrame = (uint8_t*)malloc(tFrameSize);
+    memset(tFrame, 0xD5 /* A-law silence */, tFrameSize);
+
+    printf("Audio packetization of %d PCMA streams with %d s of audio each\n", BENCHMARK_AUDIO_STREAMS, BENCHMARK_AUDIO_DURATION);
+    printf("%10s %14s %16s %18s\n", "ptime [ms]", "packets/s", "kbit/s (IP/UDP)", "CPU [us/s audio]");
+
+    //######################################################
+    //### packetize the streams for each packetization time
+    //######################################################
+    for (unsigned int i = 0; i < sizeof(sPtimes) / sizeof(sPtimes[0]); i++)
+    {
+        RTP *tRtp[BENCHMARK_AUDIO_STREAMS];
+        int64_t tPackets = 0;
+        int64_t tBytes = 0;
+
+        for (int s = 0; s < BENCHMARK_AUDIO_STREAMS; s++)
+        {
+            tRtp[s] = new RTP();
+            tRtp[s]->SetAudioPacketizationTime(sPtimes[i], RTP_AUDIO_PTIME_MAX);
+            tRtp[s]->OpenRtpEncoder("127.0.0.1", 5004 + 2 * s, tStream, "");
+        }
+
+        clock_t tStartTime = clock();
+        for (int f = 0; f < tFrames; f++)
+        {
+            for (int s = 0; s < BENCHMARK_AUDIO_STREAMS; s++)
+            {
+                AVPacket tPacket;
+                char *tRtpStream = NULL;
+                unsigned int tRtpStreamSize = 0;
+
+                av_init_packet(&tPacket);
+                tPacket.data = tFrame;
+                tPacket.size = tFrameSize;
+                tPacket.pts = (int64_t)f * tFrameSize;
+                tPacket.dts = tPacket.pts;
+
+                if (!tRtp[s]->RtpCreate(&tPacket, tRtpStream, tRtpStreamSize))
+                    continue;
+
+                // go through all created packets, each one is preceded by its size in network byte order
+                char *tRtpPacket = tRtpStream;
+                while (tRtpPacket + 4 <= tRtpStream + tRtpStreamSize)
+                {
+                    unsigned char *tSize = (unsigned char*)tRtpPacket;
+                    int tRtpPacketSize = (tSize[0] << 24) | (tSize[1] << 16) | (tSize[2] << 8) | tSize[3];
+                    if (tRtpPacketSize <= 0)
+                        break;
+                    tPackets++;
+                    tBytes += tRtpPacketSize + BENCHMARK_IP_UDP_HEADER_SIZE;
+                    tRtpPacket += 4 + tRtpPacketSize;
+                }
+            }
+        }
+        clock_t tEndTime = clock();
+
+        for (int s = 0; s < BENCHMARK_AUDIO_STREAMS; s++)
+        {
+            tRtp[s]->CloseRtpEncoder();
+            delete tRtp[s];
+        }
+
+        double tStreamSeconds = (double)BENCHMARK_AUDIO_STREAMS * BENCHMARK_AUDIO_DURATION;
+        double tCpuTime = (double)(tEndTime - tStartTime) * 1000 * 1000 / CLOCKS_PER_SEC; // in us
+        printf("%10d %14.1f %16.1f %18.1f\n", sPtimes[i], tPackets / tStreamSeconds, tBytes * 8 / tStreamSeconds / 1000, tCpuTime / tStreamSeconds);
+    }
+
+    free(tFrame);
+    avcodec_close(tStream->codec);
+    avformat_free_context(tFormatContext);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// PSNR of the luminance plane
+static double CalculatePsnr(AVFrame *pReference, AVFrame *pFrame, int pWidth, int pHeight)
+{
+    int64_t tSquaredError = 0;
+
+    for (int y = 0; y < pHeight; y++)
+    {
+        uint8_t *tReferenceLine = pReference->data[0] + y * pReference->linesize[0];
+        uint8_t *tLine = pFrame->data[0] + y * pFrame->linesize[0];
+        for (int x = 0; x < pWidth; x++)
+        {
+            int tDiff = (int)tReferenceLine[x] - (int)tLine[x];
+            tSquaredError += tDiff * tDiff;
+        }
+    }
+
+    if (tSquaredError == 0)
+        return BENCHMARK_PSNR_MAX;
+
+    double tMse = (double)tSquaredError / (pWidth * pHeight);
+    return 10.0 * log10(255.0 * 255.0 / tMse);
+}
+
+// the real-time settings of the muxer, otherwise the encoders use their (slow) default presets
+static void SetRealtimeEncoderOptions(AVCodec *pCodec, AVDictionary **pOptions)
+{
+    switch(pCodec->id)
+    {
+        case AV_CODEC_ID_H264:
+                        av_dict_set(pOptions, "preset", "faster", 0);
+                        break;
+        case AV_CODEC_ID_VP8:
+        case AV_CODEC_ID_VP9:
+                        av_dict_set(pOptions, "deadline", "realtime", 0);
+                        av_dict_set(pOptions, "cpu-used", "8", 0);
+                        av_dict_set(pOptions, "lag-in-frames", "0", 0);
+                        av_dict_set(pOptions, "auto-alt-ref", "0", 0);
+                        break;
+        case AV_CODEC_ID_AV1:
+                        if (strcmp(pCodec->name, "libsvtav1") == 0)
+                        {
+                            av_dict_set(pOptions, "preset", "10", 0);
+                            av_dict_set(pOptions, "svtav1-params", "pred-struct=1:lookahead=0", 0);
+                        }else if (strcmp(pCodec->name, "librav1e") == 0)
+                        {
+                            av_dict_set(pOptions, "speed", "10", 0);
+                            av_dict_set(pOptions, "rav1e-params", "low_latency=true", 0);
+                        }else
+                        {
+                            av_dict_set(pOptions, "usage", "realtime", 0);
+                            av_dict_set(pOptions, "cpu-used", "8", 0);
+                            av_dict_set(pOptions, "lag-in-frames", "0", 0);
+                        }
+                        break;
+        default:
+                        break;
+    }
+}
+
+bool Benchmark::VideoCodecs()
+{
+    static const char   *sCodecs[] = {"VP8", "H.264", "VP9", "AV1"};
+    static const int    sBitRates[] = {250, 500, 1000, 2000}; // in kbit/s
+    int                 tWidth = BENCHMARK_VIDEO_WIDTH;
+    int                 tHeight = BENCHMARK_VIDEO_HEIGHT;
+    int                 tRes;
+
+    MediaSource::FfmpegInit();
+
+    //######################################################
+    //### allocate the source picture and the decoder output
+    //######################################################
+    int tPictureSize = avpicture_get_size(PIX_FMT_YUV420P, tWidth, tHeight);
+    uint8_t *tPicture = (uint8_t*)av_malloc(tPictureSize + FF_INPUT_BUFFER_PADDING_SIZE);
+    AVFrame *tSourceFrame = MediaSource::AllocFrame();
+    AVFrame *tReferenceFrame = MediaSource::AllocFrame();
+    AVFrame *tDecodedFrame = MediaSource::AllocFrame();
+    uint8_t *tReferencePicture = (uint8_t*)av_malloc(tPictureSize + FF_INPUT_BUFFER_PADDING_SIZE);
+    if ((tPicture == NULL) || (tReferencePicture == NULL) || (tSourceFrame == NULL) || (tReferenceFrame == NULL) || (tDecodedFrame == NULL))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Memory allocation failed");
+        return false;
+    }
+    MediaSource::FillFrame(tSourceFrame, tPicture, PIX_FMT_YUV420P, tWidth, tHeight);
+    MediaSource::FillFrame(tReferenceFrame, tReferencePicture, PIX_FMT_YUV420P, tWidth, tHeight);
+
+    printf("Video codecs with %d frames of %d * %d at %d fps, CPU only\n", BENCHMARK_VIDEO_FRAMES, tWidth, tHeight, BENCHMARK_VIDEO_FPS);
+    printf("%-6s %-12s %12s %12s %10s %18s\n", "codec", "encoder", "kbit/s (set)", "kbit/s (real)", "PSNR [dB]", "encoding [ms/frame]");
+
+    for (unsigned int c = 0; c < sizeof(sCodecs) / sizeof(sCodecs[0]); c++)
+    {
+        enum AVCodecID tCodecId = MediaSource::GetCodecIDFromGuiName(sCodecs[c]);
+        AVCodec *tEncoder = avcodec_find_encoder(tCodecId);
+        AVCodec *tDecoder = avcodec_find_decoder(tCodecId);
+        if ((tEncoder == NULL) || (tDecoder == NULL))
+        {
+            printf("%-6s not supported by the used ffmpeg build\n", sCodecs[c]);
+            continue;
+        }
+
+        for (unsigned int b = 0; b < sizeof(sBitRates) / sizeof(sBitRates[0]); b++)
+        {
+            AVDictionary *tOptions = NULL;
+            int64_t tBytes = 0;
+            int tDecodedFrames = 0;
+            double tPsnrSum = 0;
+
+            //######################################################
+            //### open the encoder and the decoder
+            //######################################################
+            AVCodecContext *tEncoderContext = avcodec_alloc_context3(tEncoder);
+            tEncoderContext->width = tWidth;
+            tEncoderContext->height = tHeight;
+            tEncoderContext->pix_fmt = PIX_FMT_YUV420P;
+            tEncoderContext->time_base = (AVRational){1, BENCHMARK_VIDEO_FPS};
+            tEncoderContext->bit_rate = sBitRates[b] * 1000;
+            tEncoderContext->gop_size = 2 * BENCHMARK_VIDEO_FPS;
+            tEncoderContext->max_b_frames = 0;
+            tEncoderContext->thread_count = 1;
+            SetRealtimeEncoderOptions(tEncoder, &tOptions);
+            if ((tRes = HM_avcodec_open(tEncoderContext, tEncoder, &tOptions)) < 0)
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Couldn't open %s encoder %s because \"%s\"", sCodecs[c], tEncoder->name, strerror(AVUNERROR(tRes)));
+                av_dict_free(&tOptions);
+                av_free(tEncoderContext);
+                break;
+            }
+            av_dict_free(&tOptions);
+
+            AVCodecContext *tDecoderContext = avcodec_alloc_context3(tDecoder);
+            tDecoderContext->thread_count = 1;
+            if ((tRes = HM_avcodec_open(tDecoderContext, tDecoder, NULL)) < 0)
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Couldn't open %s decoder %s because \"%s\"", sCodecs[c], tDecoder->name, strerror(AVUNERROR(tRes)));
+                avcodec_close(tEncoderContext);
+                av_free(tEncoderContext);
+                av_free(tDecoderContext);
+                break;
+            }
+
+            //######################################################
+            //### encode and decode the test sequence, a NULL frame at the end flushes the encoder
+            //######################################################
+            clock_t tEncodingTime = 0;
+            for (int f = 0; f <= BENCHMARK_VIDEO_FRAMES; f++)
+            {
+                bool tFlushing = (f == BENCHMARK_VIDEO_FRAMES);
+                int tGotPacket = 0;
+                AVPacket tPacket;
+
+                if (!tFlushing)
+                {
+                    MediaEncoderCalibration::CreateSyntheticPicture(tSourceFrame, tWidth, tHeight, f);
+                    tSourceFrame->pts = f;
+                }
+
+                do{
+                    av_init_packet(&tPacket);
+                    tPacket.data = NULL;
+                    tPacket.size = 0;
+
+                    clock_t tStartTime = clock();
+                    tRes = HM_avcodec_encode_video2(tEncoderContext, &tPacket, tFlushing ? NULL : tSourceFrame, &tGotPacket);
+                    tEncodingTime += clock() - tStartTime;
+                    if ((tRes < 0) || (!tGotPacket))
+                        break;
+
+                    tBytes += tPacket.size;
+
+                    // without B frames the pictures are decoded in the order in which they were created
+                    int tGotPicture = 0;
+                    if ((HM_avcodec_decode_video(tDecoderContext, tDecodedFrame, &tGotPicture, &tPacket) >= 0) && (tGotPicture))
+                    {
+                        MediaEncoderCalibration::CreateSyntheticPicture(tReferenceFrame, tWidth, tHeight, tDecodedFrames);
+                        tPsnrSum += CalculatePsnr(tReferenceFrame, tDecodedFrame, tWidth, tHeight);
+                        tDecodedFrames++;
+                    }
+                    av_free_packet(&tPacket);
+                }while ((tFlushing) && (tEncoder->capabilities & CODEC_CAP_DELAY));
+            }
+
+            avcodec_close(tDecoderContext);
+            av_free(tDecoderContext);
+            avcodec_close(tEncoderContext);
+            av_free(tEncoderContext);
+
+            double tDuration = (double)BENCHMARK_VIDEO_FRAMES / BENCHMARK_VIDEO_FPS; // in s
+            double tEncodingTimePerFrame = (double)tEncodingTime * 1000 / CLOCKS_PER_SEC / BENCHMARK_VIDEO_FRAMES; // in ms
+            printf("%-6s %-12s %12d %12.1f %10.2f %18.2f\n", sCodecs[c], tEncoder->name, sBitRates[b], tBytes * 8 / tDuration / 1000, (tDecodedFrames > 0) ? tPsnrSum / tDecodedFrames : 0.0, tEncodingTimePerFrame);
+            if (tDecodedFrames < BENCHMARK_VIDEO_FRAMES)
+                LOGEX(Benchmark, LOG_WARN, "Only %d of %d %s frames were decoded", tDecodedFrames, BENCHMARK_VIDEO_FRAMES, sCodecs[c]);
+        }
+    }
+
+    av_free(tSourceFrame);
+    av_free(tReferenceFrame);
+    av_free(tDecodedFrame);
+    av_free(tPicture);
+    av_free(tReferencePicture);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the transferred messages are derived from their index: single and multi fragment ones, spread over an unordered and two ordered domains
+static int GetRdtMessageSize(int pIndex)
+{
+    return BENCHMARK_RDT_HEADER_SIZE + (pIndex * 997) % (4 * RDT_MAX_PAYLOAD_SIZE);
+}
+
+static int GetRdtMessageDomain(int pIndex)
+{
+    return pIndex % 3;
+}
+
+static bool IsRdtMessageOrdered(int pIndex)
+{
+    return (GetRdtMessageDomain(pIndex) != 0);
+}
+
+static char GetRdtMessageByte(int pIndex, int pOffset)
+{
+    return (char)((pIndex * 7 + pOffset) & 0xFF);
+}
+
+// sends the benchmark messages via a reliable datagram transport or a TCP socket and notes when each message was handed over
+class BenchmarkMessageSender:
+    public Thread
+{
+public:
+    BenchmarkMessageSender(ReliableDatagramTransport *pTransport, Socket *pSocket, string pPeerHost, unsigned int pPeerPort):
+        mSendTimes(BENCHMARK_RDT_MESSAGES, 0)
+    {
+        mTransport = pTransport;
+        mSocket = pSocket;
+        mPeerHost = pPeerHost;
+        mPeerPort = pPeerPort;
+        mBytes = 0;
+        mFailed = false;
+    }
+
+    virtual ~BenchmarkMessageSender() { }
+
+    /* in us */
+    int64_t GetSendTime(int pIndex)
+    {
+        int64_t tResult;
+
+        mMutex.lock();
+        tResult = mSendTimes[pIndex];
+        mMutex.unlock();
+
+        return tResult;
+    }
+
+    int64_t GetBytes() { return mBytes; }
+    bool HasFailed() { return mFailed; }
+
+private:
+    /* blocks only until the acknowledgments have opened the send window or the socket buffer has space */
+    virtual void* Run(void* /* pArgs */ = NULL)
+    {
+        vector<char> tSendBuffer(BENCHMARK_RDT_HEADER_SIZE + 4 * RDT_MAX_PAYLOAD_SIZE);
+
+        // a TCP server socket starts listening with its first receive call
+        if (mTransport == NULL)
+            Thread::Suspend(BENCHMARK_RDT_TCP_LISTEN_DELAY * 1000);
+
+        for (int i = 0; i < BENCHMARK_RDT_MESSAGES; i++)
+        {
+            int32_t tIndex = i;
+            int32_t tSize = GetRdtMessageSize(i);
+            int16_t tDomain = GetRdtMessageDomain(i);
+            memcpy(&tSendBuffer[0], &tIndex, 4);
+            memcpy(&tSendBuffer[4], &tSize, 4);
+            memcpy(&tSendBuffer[8], &tDomain, 2);
+            for (int j = BENCHMARK_RDT_HEADER_SIZE; j < tSize; j++)
+                tSendBuffer[j] = GetRdtMessageByte(i, j);
+
+            mMutex.lock();
+            mSendTimes[i] = Time::GetTimeStamp();
+            mMutex.unlock();
+
+            bool tSent;
+            if (mTransport != NULL)
+                tSent = mTransport->Send(&tSendBuffer[0], tSize, tDomain, IsRdtMessageOrdered(i));
+            else
+                tSent = mSocket->Send(mPeerHost, mPeerPort, &tSendBuffer[0], tSize);
+            if (!tSent)
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Failed to send message %d", i);
+                mFailed = true;
+                break;
+            }
+            mBytes += tSize;
+        }
+
+        return NULL;
+    }
+
+    ReliableDatagramTransport   *mTransport;
+    Socket                      *mSocket;
+    string                      mPeerHost;
+    unsigned int                mPeerPort;
+    Mutex                       mMutex;
+    vector<int64_t>             mSendTimes;
+    int64_t                     mBytes;
+    volatile bool               mFailed;
+};
+
+/* receives all messages with a buffer smaller than most of them, checks each one and collects the latencies in us */
+static bool ReceiveRdtMessages(ReliableDatagramTransport *pTransport, Socket *pSocket, BenchmarkMessageSender &pSender, int64_t pStartTime, int &pReceivedMessages, vector<int64_t> &pLatencies)
+{
+    vector<int> tReceptions(BENCHMARK_RDT_MESSAGES, 0);
+    int tLastOrderedIndex[3] = {-1, -1, -1};
+    vector<char> tReceiveBuffer((pTransport != NULL) ? BENCHMARK_RDT_RECEIVE_BUFFER : BENCHMARK_RDT_TCP_RECEIVE_BUFFER);
+    string tMessage;
+
+    pReceivedMessages = 0;
+    while ((pReceivedMessages < BENCHMARK_RDT_MESSAGES) && (!pSender.HasFailed()) && (Time::GetTimeStamp() - pStartTime < (int64_t)BENCHMARK_RDT_TIMEOUT * 1000 * 1000))
+    {
+        int tReceiveSize = (int)tReceiveBuffer.size();
+        if (pTransport != NULL)
+        {
+            if (pTransport->AvailableBytes() == 0)
+            {
+                Thread::Suspend(100);
+                continue;
+            }
+            if (!pTransport->Receive(&tReceiveBuffer[0], tReceiveSize))
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Failed to receive message");
+                return false;
+            }
+        }else
+        {
+            string tSourceHost;
+            unsigned int tSourcePort;
+            ssize_t tBufferSize = (ssize_t)tReceiveBuffer.size();
+            if ((!pSocket->Receive(tSourceHost, tSourcePort, &tReceiveBuffer[0], tBufferSize)) || (tBufferSize <= 0))
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Failed to receive message");
+                return false;
+            }
+            tReceiveSize = (int)tBufferSize;
+        }
+        int64_t tReceiveTime = Time::GetTimeStamp();
+        tMessage.append(&tReceiveBuffer[0], tReceiveSize);
+
+        // a TCP stream may carry several messages in one chunk
+        while ((int)tMessage.size() >= BENCHMARK_RDT_HEADER_SIZE)
+        {
+            int32_t tIndex, tSize;
+            int16_t tDomain;
+            memcpy(&tIndex, tMessage.data(), 4);
+            memcpy(&tSize, tMessage.data() + 4, 4);
+            memcpy(&tDomain, tMessage.data() + 8, 2);
+            if ((tIndex < 0) || (tIndex >= BENCHMARK_RDT_MESSAGES) || (tSize != GetRdtMessageSize(tIndex)) || (tDomain != GetRdtMessageDomain(tIndex)))
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Received corrupted message header (index: %d, size: %d, domain: %d)", tIndex, tSize, tDomain);
+                return false;
+            }
+            if ((int)tMessage.size() < tSize)
+                break;
+            if ((pTransport != NULL) && ((int)tMessage.size() > tSize))
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Message %d of %d bytes was received with %d bytes", tIndex, tSize, (int)tMessage.size());
+                return false;
+            }
+
+            for (int j = BENCHMARK_RDT_HEADER_SIZE; j < tSize; j++)
+            {
+                if (tMessage[j] != GetRdtMessageByte(tIndex, j))
+                {
+                    LOGEX(Benchmark, LOG_ERROR, "Message %d is corrupted at offset %d", tIndex, j);
+                    return false;
+                }
+            }
+            if (++tReceptions[tIndex] > 1)
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Message %d was received %d times", tIndex, tReceptions[tIndex]);
+                return false;
+            }
+            if (IsRdtMessageOrdered(tIndex))
+            {
+                if (tIndex < tLastOrderedIndex[tDomain])
+                {
+                    LOGEX(Benchmark, LOG_ERROR, "Message %d of ordered domain %d was received after message %d", tIndex, tDomain, tLastOrderedIndex[tDomain]);
+                    return false;
+                }
+                tLastOrderedIndex[tDomain] = tIndex;
+            }
+            pLatencies.push_back(tReceiveTime - pSender.GetSendTime(tIndex));
+            pReceivedMessages++;
+            tMessage.erase(0, tSize);
+        }
+    }
+
+    if (pSender.HasFailed())
+        return false;
+    if (pReceivedMessages < BENCHMARK_RDT_MESSAGES)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Received only %d of %d messages within %d s", pReceivedMessages, BENCHMARK_RDT_MESSAGES, BENCHMARK_RDT_TIMEOUT);
+        return false;
+    }
+
+    return true;
+}
+
+/* returns the value below which the given percentage of the sorted values lies, in ms */
+static double GetPercentile(const vector<int64_t> &pSortedValues, int pPercent)
+{
+    if (pSortedValues.empty())
+        return 0;
+
+    size_t tIndex = (pSortedValues.size() * pPercent) / 100;
+    if (tIndex >= pSortedValues.size())
+        tIndex = pSortedValues.size() - 1;
+
+    return (double)pSortedValues[tIndex] / 1000;
+}
+
+bool Benchmark::ReliableTransport()
+{
+    // the reliable transport runs with and without impaired loopback, TCP serves as reference without impairment
+    static const struct
+    {
+        const char      *Name;
+        bool            Tcp;
+        bool            Impaired;
+    }sRuns[] = {
+        {"RDT impaired",        false,  true},
+        {"RDT",                 false,  false},
+        {"TCP",                 true,   false},
+    };
+    bool tResult = true;
+
+    printf("Reliable transport of %d messages via loopback, impaired by loss, reordering and duplication\n", BENCHMARK_RDT_MESSAGES);
+    printf("%-14s %10s %12s %10s %14s %14s %10s %12s %10s %10s %10s %10s %10s %8s\n", "transport", "messages", "bytes", "time [s]", "goodput [KB/s]", "retransmitted", "lost", "duplicated", "reordered", "p50 [ms]", "p90 [ms]", "p99 [ms]", "max [ms]", "result");
+
+    for (unsigned int r = 0; r < sizeof(sRuns) / sizeof(sRuns[0]); r++)
+    {
+        Socket                      *tSocket[2] = {NULL, NULL};
+        ReliableDatagramTransport   *tTransport[2] = {NULL, NULL};
+        ImpairmentSettings          tImpairment;
+        int64_t                     tImpairmentCounts[3] = {0, 0, 0};
+        string                      tPeerHost = "127.0.0.1";
+        unsigned int                tPeerPort = 0;
+
+        //######################################################
+        //### create two local endpoints, the data and the acknowledgments are impaired by the sending socket
+        //######################################################
+        if (sRuns[r].Tcp)
+        {
+            tSocket[1] = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_TCP, BENCHMARK_RDT_PORT, false, 2);
+            tSocket[0] = Socket::CreateClientSocket(SOCKET_IPv4, SOCKET_TCP);
+            if (tSocket[0] != NULL)
+                tSocket[0]->TCPDisableNagle();
+            if (tSocket[1] != NULL)
+                tPeerPort = tSocket[1]->GetLocalPort();
+        }else
+        {
+            for (int i = 0; i < 2; i++)
+            {
+                tSocket[i] = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, BENCHMARK_RDT_PORT + i, false, 2);
+                if ((tSocket[i] == NULL) || (!sRuns[r].Impaired))
+                    continue;
+
+                SocketImpairment::SetDefaults(tImpairment);
+                tImpairment.Seed = 4711 + i;
+                tImpairment.Directions = IMPAIRMENT_DIRECTION_SEND;
+                tImpairment.LossGoodToBad = 0.02;
+                tImpairment.LossBadToGood = 0.3;
+                tImpairment.LossInGood = 0.01;
+                tImpairment.LossInBad = 0.5;
+                tImpairment.Delay = 20;
+                tImpairment.Jitter = 10;
+                tImpairment.Reordering = 0.1;
+                tImpairment.Duplication = 0.05;
+                tSocket[i]->SetImpairment(tImpairment);
+            }
+            if ((tSocket[0] != NULL) && (tSocket[1] != NULL))
+            {
+                for (int i = 0; i < 2; i++)
+                    tTransport[i] = new ReliableDatagramTransport(tSocket[i], tPeerHost, tSocket[1 - i]->GetLocalPort());
+            }
+        }
+        if ((tSocket[0] == NULL) || (tSocket[1] == NULL))
+        {
+            LOGEX(Benchmark, LOG_ERROR, "Couldn't create local sockets for %s", sRuns[r].Name);
+            delete tSocket[0];
+            delete tSocket[1];
+            return false;
+        }
+
+        //######################################################
+        //### send in the background, receive and check each message as soon as it arrives
+        //######################################################
+        int tReceivedMessages = 0;
+        vector<int64_t> tLatencies;
+        BenchmarkMessageSender tSender(tTransport[0], tSocket[0], tPeerHost, tPeerPort);
+        int64_t tStartTime = Time::GetTimeStamp();
+        tSender.StartThread();
+        bool tOk = ReceiveRdtMessages(tTransport[1], tSocket[1], tSender, tStartTime, tReceivedMessages, tLatencies);
+        int64_t tEndTime = Time::GetTimeStamp();
+        tSender.StopThread();
+        if (!tOk)
+            tResult = false;
+
+        for (int i = 0; i < 2; i++)
+        {
+            SocketImpairment *tSendImpairment = tSocket[i]->GetImpairment(IMPAIRMENT_DIRECTION_SEND);
+            if (tSendImpairment != NULL)
+            {
+                tImpairmentCounts[0] += tSendImpairment->GetLostPacketCount();
+                tImpairmentCounts[1] += tSendImpairment->GetDuplicatedPacketCount();
+                tImpairmentCounts[2] += tSendImpairment->GetReorderedPacketCount();
+            }
+        }
+
+        // TCP hides its retransmissions
+        char tRetransmittedStr[32];
+        if (tTransport[0] != NULL)
+            sprintf(tRetransmittedStr, "%"PRId64, tTransport[0]->GetRetransmittedPackets());
+        else
+            sprintf(tRetransmittedStr, "-");
+
+        sort(tLatencies.begin(), tLatencies.end());
+        double tDuration = (double)(tEndTime - tSender.GetSendTime(0)) / 1000 / 1000; // in s
+        int64_t tBytes = tSender.GetBytes();
+        printf("%-14s %10d %12"PRId64" %10.2f %14.1f %14s %10"PRId64" %12"PRId64" %10"PRId64" %10.1f %10.1f %10.1f %10.1f %8s\n", sRuns[r].Name, tReceivedMessages, tBytes, tDuration, (tDuration > 0) ? tBytes / tDuration / 1024 : 0, tRetransmittedStr, tImpairmentCounts[0], tImpairmentCounts[1], tImpairmentCounts[2], GetPercentile(tLatencies, 50), GetPercentile(tLatencies, 90), GetPercentile(tLatencies, 99), GetPercentile(tLatencies, 100), tOk ? "ok" : "FAILED");
+
+        // the sender lingers until its last messages are acknowledged, hence the receiver is stopped afterwards
+        for (int i = 0; i < 2; i++)
+        {
+            delete tTransport[i];
+            delete tSocket[i];
+        }
+    }
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// counts the packets which a consumer gets from a shared memory ring or a socket
+class BenchmarkConsumer:
+    public Thread
+{
+public:
+    BenchmarkConsumer(MediaShmRing *pRing, Socket *pSocket)
+    {
+        mRing = pRing;
+        mSocket = pSocket;
+        mConsumerNeeded = true;
+        mPackets = 0;
+        mBytes = 0;
+        mLastPacketTime = 0;
+    }
+
+    virtual ~BenchmarkConsumer() { }
+
+    /* returns after nothing was received for BENCHMARK_SHM_IDLE_TIMEOUT */
+    void StopWhenIdle()
+    {
+        int64_t tPackets;
+        do
+        {
+            tPackets = mPackets;
+            Thread::Suspend(BENCHMARK_SHM_IDLE_TIMEOUT * 1000);
+        }while (mPackets != tPackets);
+
+        mConsumerNeeded = false;
+        if (mRing != NULL)
+            mRing->Interrupt();
+        else
+            mSocket->StopReceiving();
+        StopThread();
+    }
+
+    int64_t GetPackets() { return mPackets; }
+    int64_t GetBytes() { return mBytes; }
+    int64_t GetLastPacketTime() { return mLastPacketTime; }
+
+private:
+    virtual void* Run(void* /* pArgs */ = NULL)
+    {
+        char *tBuffer = (char*)malloc(MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE);
+
+        while (mConsumerNeeded)
+        {
+            int tSize = -1;
+            if (mRing != NULL)
+            {
+                int64_t tTimestamp;
+                int tFlags;
+                tSize = mRing->Read(tBuffer, MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE, tTimestamp, tFlags, 100);
+            }else
+            {
+                string tSourceHost;
+                unsigned int tSourcePort;
+                ssize_t tBufferSize = MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE;
+                if (mSocket->Receive(tSourceHost, tSourcePort, tBuffer, tBufferSize))
+                    tSize = (int)tBufferSize;
+            }
+            if ((mConsumerNeeded) && (tSize > 0))
+            {
+                mLastPacketTime = Time::GetTimeStamp();
+                mBytes += tSize;
+                mPackets++;
+            }
+        }
+
+        free(tBuffer);
+        return NULL;
+    }
+
+    MediaShmRing        *mRing;
+    Socket              *mSocket;
+    volatile bool       mConsumerNeeded;
+    volatile int64_t    mPackets;
+    int64_t             mBytes;
+    int64_t             mLastPacketTime;
+};
+
+bool Benchmark::SharedMemory()
+{
+    AVFormatContext     *tFormatContext;
+    AVStream            *tStream;
+    AVCodec             *tCodec;
+    bool                tResult = true;
+
+    MediaSource::FfmpegInit();
+
+    //######################################################
+    //### describe the stream, the packets aren't decoded
+    //######################################################
+    tCodec = avcodec_find_encoder(AV_CODEC_ID_PCM_ALAW);
+    if (tCodec == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't find PCMA encoder");
+        return false;
+    }
+
+    tFormatContext = AV_NEW_FORMAT_CONTEXT();
+    tStream = HM_avformat_new_stream(tFormatContext, tCodec);
+    if (tStream == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Memory allocation failed");
+        av_free(tFormatContext);
+        return false;
+    }
+    tStream->codec->codec_type = AVMEDIA_TYPE_AUDIO;
+    tStream->codec->codec_id = AV_CODEC_ID_PCM_ALAW;
+    tStream->codec->sample_rate = 8000;
+    tStream->codec->channels = 1;
+    tStream->codec->rtp_payload_size = BENCHMARK_SHM_PACKET_SIZE;
+
+    uint8_t *tPacketData = (uint8_t*)malloc(BENCHMARK_SHM_PACKET_SIZE);
+    memset(tPacketData, 0xD5, BENCHMARK_SHM_PACKET_SIZE);
+
+    printf("Transfer of %d packets with %d bytes from a media sink to a consumer thread\n", BENCHMARK_SHM_PACKETS, BENCHMARK_SHM_PACKET_SIZE);
+    printf("%-24s %10s %10s %10s %14s %14s\n", "sink", "received", "lost", "time [s]", "packets/s", "MB/s");
+
+    //######################################################
+    //### run the same packets through both sinks
+    //######################################################
+    for (int i = 0; i < 2; i++)
+    {
+        MediaSink *tSink = NULL;
+        MediaShmRing *tRing = NULL;
+        Socket *tReceiveSocket = NULL, *tSendSocket = NULL;
+        string tName;
+
+        if (i == 0)
+        {
+            tName = "shared memory";
+            MediaSinkShm *tShmSink = new MediaSinkShm("benchmark", MEDIA_SINK_AUDIO, false);
+            tRing = new MediaShmRing();
+            if (!tRing->Attach("benchmark"))
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Couldn't attach to the ring of the shared memory sink");
+                delete tRing;
+                delete tShmSink;
+                tResult = false;
+                continue;
+            }
+            tSink = tShmSink;
+        }else
+        {
+            // HINT: the media loopback is off by default, hence the packets go through the UDP stack
+            tName = "network (UDP loopback)";
+            tReceiveSocket = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, BENCHMARK_SHM_PORT, false, 2);
+            tSendSocket = Socket::CreateClientSocket(SOCKET_IPv4, SOCKET_UDP);
+            if ((tReceiveSocket == NULL) || (tSendSocket == NULL))
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Couldn't create the sockets of the network sink");
+                delete tReceiveSocket;
+                delete tSendSocket;
+                tResult = false;
+                continue;
+            }
+            tSink = new MediaSinkNet("127.0.0.1", tReceiveSocket->GetLocalPort(), tSendSocket, MEDIA_SINK_AUDIO, false);
+        }
+        tSink->SetActivation(true);
+
+        BenchmarkConsumer tConsumer(tRing, tReceiveSocket);
+        tConsumer.StartThread();
+
+        int64_t tStartTime = Time::GetTimeStamp();
+        for (int p = 0; p < BENCHMARK_SHM_PACKETS; p++)
+        {
+            AVPacket tPacket;
+            av_init_packet(&tPacket);
+            tPacket.data = tPacketData;
+            tPacket.size = BENCHMARK_SHM_PACKET_SIZE;
+            tPacket.pts = p;
+            tPacket.dts = p;
+            tSink->ProcessPacket(&tPacket, tStream);
+        }
+        tConsumer.StopWhenIdle();
+
+        double tDuration = (double)(tConsumer.GetLastPacketTime() - tStartTime) / 1000 / 1000; // in s
+        if (tDuration <= 0)
+            tDuration = 1.0 / 1000 / 1000;
+        printf("%-24s %10"PRId64" %10"PRId64" %10.2f %14.1f %14.1f\n", tName.c_str(), tConsumer.GetPackets(), (int64_t)BENCHMARK_SHM_PACKETS - tConsumer.GetPackets(), tDuration, tConsumer.GetPackets() / tDuration, tConsumer.GetBytes() / tDuration / 1024 / 1024);
+
+        if (tRing != NULL)
+        {
+            tRing->Close();
+            delete tRing;
+        }
+        delete tSink;
+        // HINT: the network sink doesn't delete its socket
+        delete tSendSocket;
+        delete tReceiveSocket;
+    }
+
+    free(tPacketData);
+    avformat_free_context(tFormatContext);
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Benchmark::PathMtu()
+{
+    bool tResult = true;
+
+    //######################################################
+    //### the reduced MTU of the loopback device is the expected path MTU, e.g.:
+    //### unshare -n sh -c "ip link set lo up mtu 1300; HomerDaemon -Benchmark=PathMtu"
+    //######################################################
+    int tDeviceMtu = 0;
+    #if defined(LINUX)
+        struct ifreq tInterface;
+        memset(&tInterface, 0, sizeof(tInterface));
+        strncpy(tInterface.ifr_name, "lo", IFNAMSIZ - 1);
+        int tHandle = socket(AF_INET, SOCK_DGRAM, 0);
+        if (tHandle >= 0)
+        {
+            if (ioctl(tHandle, SIOCGIFMTU, &tInterface) == 0)
+                tDeviceMtu = tInterface.ifr_mtu;
+            close(tHandle);
+        }
+    #endif
+    if (tDeviceMtu <= 0)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't determine the MTU of the loopback device");
+        return false;
+    }
+    if (tDeviceMtu > BENCHMARK_PMTU_DEVICE_MTU_MAX)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "MTU of %d bytes of the loopback device is too big, reduce it to at most %d bytes", tDeviceMtu, BENCHMARK_PMTU_DEVICE_MTU_MAX);
+        return false;
+    }
+
+    Socket *tSendSocket = Socket::CreateClientSocket(SOCKET_IPv4, SOCKET_UDP);
+    if (tSendSocket == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create the sending socket");
+        return false;
+    }
+    tSendSocket->SetTuning(SOCKET_TUNING_PROFILE_MEDIA_TX);
+
+    //######################################################
+    //### the first lookup returns the kernel's value at once, the confirming probe runs in the background
+    //######################################################
+    int64_t tStartTime = Time::GetTimeStamp();
+    int tKernelMtu = tSendSocket->GetPathMtu("127.0.0.1");
+    double tLookupTime = (double)(Time::GetTimeStamp() - tStartTime) / 1000; // in ms
+    while ((!SVC_PATH_MTU_DISCOVERY.IsDiscovered("127.0.0.1")) && (Time::GetTimeStamp() - tStartTime < BENCHMARK_PMTU_DISCOVERY_TIMEOUT * 1000 * 1000))
+        Thread::Suspend(1000);
+    double tDiscoveryTime = (double)(Time::GetTimeStamp() - tStartTime) / 1000; // in ms
+    int tPathMtu = tSendSocket->GetPathMtu("127.0.0.1");
+    int tMaxPayloadSize = tSendSocket->GetPathMaxPayloadSize("127.0.0.1");
+    bool tDiscovered = SVC_PATH_MTU_DISCOVERY.IsDiscovered("127.0.0.1");
+    if ((tKernelMtu != tDeviceMtu) || (tPathMtu != tDeviceMtu) || (!tDiscovered))
+        tResult = false;
+
+    printf("Path MTU discovery towards 127.0.0.1 with a loopback MTU of %d bytes\n", tDeviceMtu);
+    printf("%-24s %10s %10s %14s %8s\n", "", "MTU", "payload", "time [ms]", "result");
+    printf("%-24s %10d %10s %14.3f %8s\n", "first lookup", tKernelMtu, "", tLookupTime, (tKernelMtu == tDeviceMtu) ? "ok" : "FAILED");
+    printf("%-24s %10d %10d %14.3f %8s\n", "confirmed by probe", tPathMtu, tMaxPayloadSize, tDiscoveryTime, ((tDiscovered) && (tPathMtu == tDeviceMtu)) ? "ok" : "FAILED");
+    printf("\n");
+
+    //######################################################
+    //### datagrams at the limit and beyond it, the latter are fragmented locally instead of being dropped
+    //######################################################
+    printf("Transfer of %d datagrams per size\n", BENCHMARK_PMTU_PACKETS);
+    printf("%-24s %10s %10s %10s %8s\n", "datagrams", "size", "sent", "received", "result");
+    char *tPacketData = (char*)malloc(tMaxPayloadSize + BENCHMARK_PMTU_OVERSIZE);
+    memset(tPacketData, 0xD5, tMaxPayloadSize + BENCHMARK_PMTU_OVERSIZE);
+    for (int i = 0; i < 2; i++)
+    {
+        int tSize = (i == 0) ? tMaxPayloadSize : tMaxPayloadSize + BENCHMARK_PMTU_OVERSIZE;
+
+        // HINT: the consumer closes its socket when it stops
+        Socket *tReceiveSocket = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, BENCHMARK_PMTU_PORT, false, 2);
+        if (tReceiveSocket == NULL)
+        {
+            LOGEX(Benchmark, LOG_ERROR, "Couldn't create the receiving socket");
+            tResult = false;
+            continue;
+        }
+
+        BenchmarkConsumer tConsumer(NULL, tReceiveSocket);
+        tConsumer.StartThread();
+
+        int tSent = 0;
+        for (int p = 0; p < BENCHMARK_PMTU_PACKETS; p++)
+        {
+            if (tSendSocket->Send("127.0.0.1", tReceiveSocket->GetLocalPort(), tPacketData, tSize))
+                tSent++;
+        }
+        tConsumer.StopWhenIdle();
+
+        bool tComplete = (tSent == BENCHMARK_PMTU_PACKETS) && (tConsumer.GetPackets() == BENCHMARK_PMTU_PACKETS) && (tConsumer.GetBytes() == (int64_t)BENCHMARK_PMTU_PACKETS * tSize);
+        if (!tComplete)
+            tResult = false;
+        printf("%-24s %10d %10d %10"PRId64" %8s\n", (i == 0) ? "at the limit" : "beyond the limit", tSize, tSent, tConsumer.GetPackets(), tComplete ? "ok" : "FAILED");
+
+        delete tReceiveSocket;
+    }
+
+    free(tPacketData);
+    delete tSendSocket;
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// synthetic camera: delivers RGB32 frames with a moving square in real-time
+class BenchmarkVideoSource:
+    public MediaSource
+{
+public:
+    BenchmarkVideoSource():
+        MediaSource("Benchmark: synthetic camera")
+    {
+        mNextFrameTime = 0;
+        mLastWaitTime = 0;
+    }
+
+    virtual ~BenchmarkVideoSource() { }
+
+    virtual bool OpenVideoGrabDevice(int pResX = 352, int pResY = 288, float pFps = 29.97)
+    {
+        mMediaType = MEDIA_VIDEO;
+        mSourceResX = pResX;
+        mSourceResY = pResY;
+        mTargetResX = pResX;
+        mTargetResY = pResY;
+        mInputFrameRate = pFps;
+        mOutputFrameRate = pFps;
+        mFrameNumber = 0;
+        mNextFrameTime = 0;
+        MarkOpenGrabDeviceSuccessful();
+        return true;
+    }
+
+    virtual bool OpenAudioGrabDevice(int /* pSampleRate */ = 44100, int /* pChannels */ = 2)
+    {
+        return false;
+    }
+
+    virtual bool CloseGrabDevice()
+    {
+        mMediaSourceOpened = false;
+        return true;
+    }
+
+    virtual int GrabChunk(void* pChunkBuffer, int& pChunkSize, bool /* pDropChunk */ = false)
+    {
+        // a camera delivers its frames at a fixed rate
+        int64_t tTime = Time::GetTimeStamp();
+        if (mNextFrameTime == 0)
+            mNextFrameTime = tTime;
+        mLastWaitTime = 0;
+        if (mNextFrameTime > tTime)
+        {
+            mLastWaitTime = mNextFrameTime - tTime;
+            Thread::Suspend(mLastWaitTime);
+        }
+        mNextFrameTime += (int64_t)(1000 * 1000 / mInputFrameRate);
+
+        uint32_t *tPixels = (uint32_t*)pChunkBuffer;
+        int tSquareSize = mSourceResY / 4;
+        int tSquareX = (mFrameNumber * 4) % (mSourceResX - tSquareSize);
+        int tSquareY = (mFrameNumber * 2) % (mSourceResY - tSquareSize);
+        for (int y = 0; y < mSourceResY; y++)
+        {
+            for (int x = 0; x < mSourceResX; x++)
+            {
+                if ((x >= tSquareX) && (x < tSquareX + tSquareSize) && (y >= tSquareY) && (y < tSquareY + tSquareSize))
+                    tPixels[y * mSourceResX + x] = 0x00F0F0F0;
+                else
+                    tPixels[y * mSourceResX + x] = (((x + mFrameNumber) & 0xFF) << 16) | ((y & 0xFF) << 8) | 0x40;
+            }
+        }
+        pChunkSize = mSourceResX * mSourceResY * 4;
+
+        mFrameNumber++;
+        MarkGrabChunkSuccessful(mFrameNumber);
+
+        return mFrameNumber;
+    }
+
+    /* time which the last grabbing waited for the next frame, in us */
+    int64_t GetLastWaitTime() { return mLastWaitTime; }
+
+private:
+    int64_t             mNextFrameTime; // in us
+    int64_t             mLastWaitTime; // in us
+};
+
+// counts the encoded frames which a media sink gets and measures the largest gap between two of them
+class BenchmarkFrameCounter:
+    public MediaSink
+{
+public:
+    BenchmarkFrameCounter():
+        MediaSink(MEDIA_SINK_VIDEO)
+    {
+        mMediaId = "BENCHMARK-FRAME-COUNTER";
+        mFrames = 0;
+        mKeyFrames = 0;
+        mLastFrameTime = 0;
+        mMaxGap = 0;
+    }
+
+    virtual ~BenchmarkFrameCounter() { }
+
+    virtual void ProcessPacket(AVPacket *pAVPacket, AVStream * /* pStream */ = NULL, std::string /* pStreamName */ = "")
+    {
+        int64_t tTime = Time::GetTimeStamp();
+
+        mMutex.lock();
+        if ((mLastFrameTime != 0) && (tTime - mLastFrameTime > mMaxGap))
+            mMaxGap = tTime - mLastFrameTime;
+        mLastFrameTime = tTime;
+        mFrames++;
+        if (pAVPacket->flags & AV_PKT_FLAG_KEY)
+            mKeyFrames++;
+        mMutex.unlock();
+    }
+
+    /* returns the values since the last call */
+    void GetStatistic(int64_t &pFrames, int64_t &pKeyFrames, int64_t &pMaxGap)
+    {
+        mMutex.lock();
+        pFrames = mFrames;
+        pKeyFrames = mKeyFrames;
+        pMaxGap = mMaxGap;
+        mFrames = 0;
+        mKeyFrames = 0;
+        mMaxGap = 0;
+        mMutex.unlock();
+    }
+
+private:
+    Mutex               mMutex;
+    int64_t             mFrames;
+    int64_t             mKeyFrames;
+    int64_t             mLastFrameTime;
+    int64_t             mMaxGap; // in us
+};
+
+bool Benchmark::EncoderSwitch()
+{
+    // each step starts with a change of the streaming resolution or the grab resolution
+    static const struct
+    {
+        const char      *Name;
+        int             StreamResX, StreamResY;
+        int             GrabResX, GrabResY;
+    }sSteps[] = {
+        {"start",               352, 288, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT},
+        {"stream 640 * 480",    640, 480, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT},
+        {"stream 176 * 144",    176, 144, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT},
+        {"grab 320 * 240",      176, 144, 320, 240},
+        {"stream 352 * 288",    352, 288, 320, 240},
+    };
+    bool tResult = true;
+    int tResX, tResY;
+
+    MediaSource::FfmpegInit();
+
+    BenchmarkVideoSource *tCamera = new BenchmarkVideoSource();
+    MediaSourceMuxer *tMuxer = new MediaSourceMuxer(tCamera);
+    BenchmarkFrameCounter tCounter;
+
+    //######################################################
+    //### open the encoder with the settings of the first step
+    //######################################################
+    tMuxer->SetOutputStreamPreferences(BENCHMARK_SWITCH_CODEC, 10, BENCHMARK_SWITCH_BIT_RATE, BENCHMARK_RTP_PACKET_SIZE, false, sSteps[0].StreamResX, sSteps[0].StreamResY);
+    tMuxer->RegisterMediaSink(&tCounter);
+    tMuxer->OpenVideoGrabDevice(sSteps[0].GrabResX, sSteps[0].GrabResY, BENCHMARK_VIDEO_FPS);
+    tMuxer->GetMuxingResolution(tResX, tResY);
+    if ((tResX == 0) || (tResY == 0))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't open the %s encoder", BENCHMARK_SWITCH_CODEC);
+        tMuxer->UnregisterMediaSink(&tCounter, false);
+        delete tMuxer;
+        delete tCamera;
+        return false;
+    }
+    int64_t tFrameInterval = (int64_t)(1000 * 1000 / tCamera->GetInputFrameRate()); // in us
+    int tChunkSize = BENCHMARK_VIDEO_WIDTH * BENCHMARK_VIDEO_HEIGHT * 4;
+    char *tChunkBuffer = (char*)av_malloc(tChunkSize + FF_INPUT_BUFFER_PADDING_SIZE);
+
+    printf("Live reconfiguration of a %s encoder, %d frames per step from a synthetic camera, one frame every %.1f ms\n", BENCHMARK_SWITCH_CODEC, BENCHMARK_SWITCH_STEP_FRAMES, (double)tFrameInterval / 1000);
+    printf("%-18s %12s %14s %16s %14s %8s %8s %8s\n", "change", "call [ms]", "max grab [ms]", "switch gap [ms]", "max gap [ms]", "frames", "key", "result");
+
+    int64_t tSwitchGap = tMuxer->GetEncoderSwitchGap();
+    for (unsigned int s = 0; s < sizeof(sSteps) / sizeof(sSteps[0]); s++)
+    {
+        int64_t tFrames, tKeyFrames, tMaxGap;
+
+        //######################################################
+        //### the change is requested in the context of the capture thread, it mustn't wait for the new encoder
+        //######################################################
+        int64_t tStartTime = Time::GetTimeStamp();
+        if (s > 0)
+        {
+            if ((sSteps[s].GrabResX != sSteps[s - 1].GrabResX) || (sSteps[s].GrabResY != sSteps[s - 1].GrabResY))
+                tMuxer->SetVideoGrabResolution(sSteps[s].GrabResX, sSteps[s].GrabResY);
+            else
+                tMuxer->SetOutputStreamPreferences(BENCHMARK_SWITCH_CODEC, 10, BENCHMARK_SWITCH_BIT_RATE, BENCHMARK_RTP_PACKET_SIZE, true, sSteps[s].StreamResX, sSteps[s].StreamResY);
+        }
+        double tCallTime = (double)(Time::GetTimeStamp() - tStartTime) / 1000; // in ms
+        tCounter.GetStatistic(tFrames, tKeyFrames, tMaxGap);
+
+        //######################################################
+        //### grab the frames of this step
+        //######################################################
+        int64_t tMaxGrabTime = 0;
+        for (int f = 0; f < BENCHMARK_SWITCH_STEP_FRAMES; f++)
+        {
+            int tSize = tChunkSize;
+            int64_t tGrabStartTime = Time::GetTimeStamp();
+            tMuxer->GrabChunk(tChunkBuffer, tSize);
+            // the camera waits for the next frame, only the remaining time is spent in the muxer
+            int64_t tGrabTime = Time::GetTimeStamp() - tGrabStartTime - tCamera->GetLastWaitTime();
+            if ((f > 0) && (tGrabTime > tMaxGrabTime))
+                tMaxGrabTime = tGrabTime;
+        }
+        tCounter.GetStatistic(tFrames, tKeyFrames, tMaxGap);
+
+        //######################################################
+        //### the new encoder has to start with a key frame and the outgoing stream mustn't pause
+        //######################################################
+        tMuxer->GetMuxingResolution(tResX, tResY);
+        bool tSwitched = (tResX == sSteps[s].StreamResX) && (tResY == sSteps[s].StreamResY);
+        bool tNewGap = (s > 0) && (tMuxer->GetEncoderSwitchGap() != tSwitchGap);
+        tSwitchGap = tMuxer->GetEncoderSwitchGap();
+        bool tOk = (tSwitched) && (tKeyFrames > 0) && (tMaxGap < BENCHMARK_SWITCH_MAX_GAP_FRAMES * tFrameInterval);
+        if (!tOk)
+            tResult = false;
+        char tSwitchGapStr[32];
+        if (tNewGap)
+            sprintf(tSwitchGapStr, "%.1f", (double)tSwitchGap / 1000);
+        else
+            sprintf(tSwitchGapStr, "-");
+        printf("%-18s %12.3f %14.3f %16s %14.1f %8"PRId64" %8"PRId64" %8s\n", sSteps[s].Name, tCallTime, (double)tMaxGrabTime / 1000, tSwitchGapStr, (double)tMaxGap / 1000, tFrames, tKeyFrames, tOk ? "ok" : "FAILED");
+    }
+
+    tMuxer->CloseGrabDevice();
+    tMuxer->UnregisterMediaSink(&tCounter, false);
+    delete tMuxer;
+    delete tCamera;
+    av_free(tChunkBuffer);
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// writes an MPEG4 video stream with synthetic pictures and a raw stereo audio stream into one file
+static bool CreateDemuxerTestFile(string pFileName)
+{
+    int tRes;
+
+    AVFormatContext *tFormatContext = AV_NEW_FORMAT_CONTEXT();
+    tFormatContext->oformat = AV_GUESS_FORMAT(NULL, pFileName.c_str(), NULL);
+    AVCodec *tEncoder = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+    if ((tFormatContext->oformat == NULL) || (tEncoder == NULL))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Container format or MPEG4 encoder not supported by the used ffmpeg build");
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+
+    //######################################################
+    //### video stream
+    //######################################################
+    AVStream *tVideoStream = HM_avformat_new_stream(tFormatContext, tEncoder);
+    AVCodecContext *tVideoCodecContext = tVideoStream->codec;
+    tVideoCodecContext->codec_id = AV_CODEC_ID_MPEG4;
+    tVideoCodecContext->codec_type = AVMEDIA_TYPE_VIDEO;
+    tVideoCodecContext->width = BENCHMARK_VIDEO_WIDTH;
+    tVideoCodecContext->height = BENCHMARK_VIDEO_HEIGHT;
+    tVideoCodecContext->pix_fmt = PIX_FMT_YUV420P;
+    tVideoCodecContext->time_base = (AVRational){1, BENCHMARK_VIDEO_FPS};
+    tVideoStream->time_base = (AVRational){1, BENCHMARK_VIDEO_FPS};
+    tVideoCodecContext->bit_rate = 1000 * 1000;
+    tVideoCodecContext->gop_size = BENCHMARK_VIDEO_FPS;
+    tVideoCodecContext->max_b_frames = 0;
+    if (tFormatContext->oformat->flags & AVFMT_GLOBALHEADER)
+        tVideoCodecContext->flags |= CODEC_FLAG_GLOBAL_HEADER;
+    if ((tRes = HM_avcodec_open(tVideoCodecContext, tEncoder, NULL)) < 0)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't open MPEG4 encoder because \"%s\"", strerror(AVUNERROR(tRes)));
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+
+    //######################################################
+    //### audio stream, raw samples need no encoder
+    //######################################################
+    AVStream *tAudioStream = HM_avformat_new_stream(tFormatContext, NULL);
+    AVCodecContext *tAudioCodecContext = tAudioStream->codec;
+    tAudioCodecContext->codec_id = AV_CODEC_ID_PCM_S16LE;
+    tAudioCodecContext->codec_type = AVMEDIA_TYPE_AUDIO;
+    tAudioCodecContext->sample_fmt = AV_SAMPLE_FMT_S16;
+    tAudioCodecContext->sample_rate = BENCHMARK_DEMUXER_SAMPLE_RATE;
+    tAudioCodecContext->channels = 2;
+    tAudioCodecContext->time_base = (AVRational){1, BENCHMARK_DEMUXER_SAMPLE_RATE};
+    tAudioStream->time_base = (AVRational){1, BENCHMARK_DEMUXER_SAMPLE_RATE};
+
+    if ((tRes = avio_open(&tFormatContext->pb, pFileName.c_str(), AVIO_FLAG_WRITE)) < 0)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create %s because \"%s\"", pFileName.c_str(), strerror(AVUNERROR(tRes)));
+        avcodec_close(tVideoCodecContext);
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+    if ((tRes = avformat_write_header(tFormatContext, NULL)) < 0)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't write the header of %s because \"%s\"", pFileName.c_str(), strerror(AVUNERROR(tRes)));
+        avio_close(tFormatContext->pb);
+        avcodec_close(tVideoCodecContext);
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+
+    //######################################################
+    //### write each picture followed by the audio samples of its period
+    //######################################################
+    int tPictureSize = avpicture_get_size(PIX_FMT_YUV420P, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT);
+    uint8_t *tPicture = (uint8_t*)av_malloc(tPictureSize + FF_INPUT_BUFFER_PADDING_SIZE);
+    AVFrame *tFrame = MediaSource::AllocFrame();
+    MediaSource::FillFrame(tFrame, tPicture, PIX_FMT_YUV420P, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT);
+    int16_t tSamples[BENCHMARK_DEMUXER_AUDIO_FRAME_SIZE * 2];
+    int64_t tAudioSamples = 0;
+    for (int f = 0; f < BENCHMARK_DEMUXER_DURATION * BENCHMARK_VIDEO_FPS; f++)
+    {
+        int tGotPacket = 0;
+        AVPacket tPacket;
+
+        MediaEncoderCalibration::CreateSyntheticPicture(tFrame, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, f);
+        tFrame->pts = f;
+        av_init_packet(&tPacket);
+        tPacket.data = NULL;
+        tPacket.size = 0;
+        if ((HM_avcodec_encode_video2(tVideoCodecContext, &tPacket, tFrame, &tGotPacket) >= 0) && (tGotPacket))
+        {
+            tPacket.stream_index = tVideoStream->index;
+            tPacket.pts = av_rescale_q(tPacket.pts, tVideoCodecContext->time_base, tVideoStream->time_base);
+            tPacket.dts = av_rescale_q(tPacket.dts, tVideoCodecContext->time_base, tVideoStream->time_base);
+            av_write_frame(tFormatContext, &tPacket);
+            av_free_packet(&tPacket);
+        }
+
+        while (tAudioSamples * BENCHMARK_VIDEO_FPS < (int64_t)(f + 1) * BENCHMARK_DEMUXER_SAMPLE_RATE)
+        {
+            for (int s = 0; s < BENCHMARK_DEMUXER_AUDIO_FRAME_SIZE; s++)
+            {
+                tSamples[2 * s] = (int16_t)(8000 * sin(2 * M_PI * 440 * (tAudioSamples + s) / BENCHMARK_DEMUXER_SAMPLE_RATE));
+                tSamples[2 * s + 1] = tSamples[2 * s];
+            }
+            av_init_packet(&tPacket);
+            tPacket.data = (uint8_t*)tSamples;
+            tPacket.size = sizeof(tSamples);
+            tPacket.stream_index = tAudioStream->index;
+            tPacket.pts = av_rescale_q(tAudioSamples, tAudioCodecContext->time_base, tAudioStream->time_base);
+            tPacket.dts = tPacket.pts;
+            tPacket.flags |= AV_PKT_FLAG_KEY;
+            av_write_frame(tFormatContext, &tPacket);
+            tAudioSamples += BENCHMARK_DEMUXER_AUDIO_FRAME_SIZE;
+        }
+    }
+
+    av_write_trailer(tFormatContext);
+    avio_close(tFormatContext->pb);
+    avcodec_close(tVideoCodecContext);
+    avformat_free_context(tFormatContext);
+    av_free(tFrame);
+    av_free(tPicture);
+
+    return true;
+}
+
+// reads all packets of one media type from a demuxer until the end of the file is reached
+class BenchmarkDemuxerReader:
+    public Thread
+{
+public:
+    BenchmarkDemuxerReader(MediaDemuxer *pDemuxer, enum MediaType pMediaType)
+    {
+        mDemuxer = pDemuxer;
+        mMediaType = pMediaType;
+        mPackets = 0;
+        mFlushes = 0;
+    }
+
+    virtual ~BenchmarkDemuxerReader() { }
+
+    int64_t GetPackets() { return mPackets; }
+    /* how often the source would have flushed its decoder because packets were dropped */
+    int64_t GetFlushes() { return mFlushes; }
+
+private:
+    virtual void* Run(void* /* pArgs */ = NULL)
+    {
+        AVPacket tPacket;
+
+        while (mDemuxer->ReadPacket(mMediaType, &tPacket) >= 0)
+        {
+            if (mDemuxer->WasRepositioned(mMediaType))
+                mFlushes++;
+            mPackets++;
+            av_free_packet(&tPacket);
+        }
+
+        return NULL;
+    }
+
+    MediaDemuxer        *mDemuxer;
+    enum MediaType      mMediaType;
+    int64_t             mPackets;
+    int64_t             mFlushes;
+};
+
+// returns the first stream of the given type, -1 if there is none
+static int FindDemuxerTestStream(MediaDemuxer *pDemuxer, enum AVMediaType pType)
+{
+    AVFormatContext *tFormatContext = pDemuxer->GetFormatContext();
+    for (int i = 0; i < (int)tFormatContext->nb_streams; i++)
+        if (tFormatContext->streams[i]->codec->codec_type == pType)
+            return i;
+
+    return -1;
+}
+
+bool Benchmark::SharedDemuxer()
+{
+    static const enum MediaType sMediaTypes[] = {MEDIA_VIDEO, MEDIA_AUDIO};
+    static const enum AVMediaType sStreamTypes[] = {AVMEDIA_TYPE_VIDEO, AVMEDIA_TYPE_AUDIO};
+    bool tResult = true;
+    int64_t tSeparatePackets[2] = {0, 0};
+
+    MediaSource::FfmpegInit();
+
+    if (!CreateDemuxerTestFile(BENCHMARK_DEMUXER_FILE))
+        return false;
+
+    printf("Video and audio source of %s with %d s of %d * %d MPEG4 video at %d fps and %d Hz raw stereo audio\n", BENCHMARK_DEMUXER_FILE, BENCHMARK_DEMUXER_DURATION, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_VIDEO_FPS, BENCHMARK_DEMUXER_SAMPLE_RATE);
+    printf("%-10s %10s %16s %14s %16s %14s %14s %10s %10s %8s\n", "demuxer", "demuxers", "file [bytes]", "demux calls", "packets [bytes]", "video packets", "audio packets", "flushes", "time [ms]", "result");
+
+    for (int tShared = 0; tShared <= 1; tShared++)
+    {
+        MediaDemuxer *tDemuxers[2] = {NULL, NULL};
+        BenchmarkDemuxerReader *tReaders[2] = {NULL, NULL};
+        int64_t tFileBytes = 0, tDemuxCalls = 0, tPacketBytes = 0, tFlushes = 0;
+
+        //######################################################
+        //### separate: each source reads the whole file with its own demuxer, one after the other
+        //### shared: both sources read concurrently from one demuxer
+        //######################################################
+        int64_t tStartTime = Time::GetTimeStamp();
+        for (int i = 0; i < 2; i++)
+        {
+            tDemuxers[i] = MediaDemuxer::Acquire(BENCHMARK_DEMUXER_FILE, sMediaTypes[i]);
+            if (tDemuxers[i] == NULL)
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Couldn't open %s", BENCHMARK_DEMUXER_FILE);
+                tResult = false;
+                break;
+            }
+            tDemuxers[i]->Subscribe(sMediaTypes[i], FindDemuxerTestStream(tDemuxers[i], sStreamTypes[i]));
+            tReaders[i] = new BenchmarkDemuxerReader(tDemuxers[i], sMediaTypes[i]);
+            tReaders[i]->StartThread();
+            if (!tShared)
+            {
+                tReaders[i]->StopThread();
+                tFileBytes += avio_tell(tDemuxers[i]->GetFormatContext()->pb);
+                tDemuxCalls += tDemuxers[i]->GetReadPackets();
+                tPacketBytes += tDemuxers[i]->GetReadBytes();
+                MediaDemuxer::Release(tDemuxers[i], sMediaTypes[i]);
+            }
+        }
+        if (tShared)
+        {
+            for (int i = 0; i < 2; i++)
+                if (tReaders[i] != NULL)
+                    tReaders[i]->StopThread();
+            if ((tDemuxers[0] != NULL) && (tDemuxers[0] != tDemuxers[1]))
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Video and audio source got different demuxers");
+                tResult = false;
+            }
+            if (tDemuxers[0] != NULL)
+            {
+                tFileBytes = avio_tell(tDemuxers[0]->GetFormatContext()->pb);
+                tDemuxCalls = tDemuxers[0]->GetReadPackets();
+                tPacketBytes = tDemuxers[0]->GetReadBytes();
+            }
+            for (int i = 0; i < 2; i++)
+                MediaDemuxer::Release(tDemuxers[i], sMediaTypes[i]);
+        }
+        double tTime = (double)(Time::GetTimeStamp() - tStartTime) / 1000; // in ms
+
+        //######################################################
+        //### the shared demuxer has to deliver the same packets as the separate ones, without drops
+        //######################################################
+        int64_t tPackets[2] = {0, 0};
+        for (int i = 0; i < 2; i++)
+        {
+            if (tReaders[i] == NULL)
+                continue;
+            tPackets[i] = tReaders[i]->GetPackets();
+            tFlushes += tReaders[i]->GetFlushes();
+            delete tReaders[i];
+        }
+        bool tOk = (tPackets[0] > 0) && (tPackets[1] > 0) && (tFlushes == 0);
+        if (!tShared)
+        {
+            tSeparatePackets[0] = tPackets[0];
+            tSeparatePackets[1] = tPackets[1];
+        }else
+            tOk = (tOk) && (tPackets[0] == tSeparatePackets[0]) && (tPackets[1] == tSeparatePackets[1]);
+        if (!tOk)
+            tResult = false;
+        printf("%-10s %10d %16"PRId64" %14"PRId64" %16"PRId64" %14"PRId64" %14"PRId64" %10"PRId64" %10.1f %8s\n", tShared ? "shared" : "separate", tShared ? 1 : 2, tFileBytes, tDemuxCalls, tPacketBytes, tPackets[0], tPackets[1], tFlushes, tTime, tOk ? "ok" : "FAILED");
+    }
+
+    unlink(BENCHMARK_DEMUXER_FILE);
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Benchmark::RateControl()
+{
+    // the quality driven encoder serves as reference for the real-time rate control
+    static const struct
+    {
+        const char      *Name;
+        bool            Realtime;
+        bool            IntraRefresh;
+    }sRuns[] = {
+        {"quality driven",      false,  false},
+        {"VBV",                 true,   false},
+        {"VBV + intra refresh", true,   true},
+    };
+    bool tResult = true;
+    int tResX, tResY;
+
+    MediaSource::FfmpegInit();
+
+    int tVbvBufferSize = (int)((int64_t)BENCHMARK_RATE_CONTROL_BIT_RATE * MEDIA_SOURCE_MUX_DEFAULT_VBV_BUFFER_TIME / 1000 / 8); // in bytes
+    int tChunkSize = BENCHMARK_VIDEO_WIDTH * BENCHMARK_VIDEO_HEIGHT * 4;
+    char *tChunkBuffer = (char*)av_malloc(tChunkSize + FF_INPUT_BUFFER_PADDING_SIZE);
+
+    printf("Rate control of a %s encoder at %d kbit/s, %d frames of %d * %d from a synthetic camera, VBV buffer of %d ms (%d bytes)\n", BENCHMARK_RATE_CONTROL_CODEC, BENCHMARK_RATE_CONTROL_BIT_RATE / 1000, BENCHMARK_RATE_CONTROL_FRAMES, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, MEDIA_SOURCE_MUX_DEFAULT_VBV_BUFFER_TIME, tVbvBufferSize);
+    printf("%-20s %12s %14s %18s %10s %14s %10s %8s %8s %8s\n", "rate control", "kbit/s", "avg [bytes]", "deviation [bytes]", "cv", "peak [bytes]", "peak/avg", "frames", "key", "result");
+
+    for (unsigned int r = 0; r < sizeof(sRuns) / sizeof(sRuns[0]); r++)
+    {
+        BenchmarkVideoSource *tCamera = new BenchmarkVideoSource();
+        MediaSourceMuxer *tMuxer = new MediaSourceMuxer(tCamera);
+        BenchmarkFrameCounter tCounter;
+
+        //######################################################
+        //### open a fresh encoder for each setting
+        //######################################################
+        tMuxer->SetOutputStreamPreferences(BENCHMARK_RATE_CONTROL_CODEC, 10, BENCHMARK_RATE_CONTROL_BIT_RATE, BENCHMARK_RTP_PACKET_SIZE, false, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT);
+        tMuxer->SetRealtimeRateControl(sRuns[r].Realtime, MEDIA_SOURCE_MUX_DEFAULT_VBV_BUFFER_TIME, sRuns[r].IntraRefresh);
+        tMuxer->RegisterMediaSink(&tCounter);
+        tMuxer->OpenVideoGrabDevice(BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_VIDEO_FPS);
+        tMuxer->GetMuxingResolution(tResX, tResY);
+        if ((tResX == 0) || (tResY == 0))
+        {
+            LOGEX(Benchmark, LOG_ERROR, "Couldn't open the %s encoder", BENCHMARK_RATE_CONTROL_CODEC);
+            tMuxer->UnregisterMediaSink(&tCounter, false);
+            delete tMuxer;
+            delete tCamera;
+            av_free(tChunkBuffer);
+            return false;
+        }
+
+        for (int f = 0; f < BENCHMARK_RATE_CONTROL_FRAMES; f++)
+        {
+            int tSize = tChunkSize;
+            tMuxer->GrabChunk(tChunkBuffer, tSize);
+        }
+
+        // the encoder thread needs some time for the last frames
+        Thread::Suspend(BENCHMARK_RATE_CONTROL_DRAIN_TIME * 1000);
+
+        //######################################################
+        //### the frame sizes are accounted by the muxer for each encoded frame
+        //######################################################
+        int64_t tFrames, tKeyFrames, tMaxGap;
+        tCounter.GetStatistic(tFrames, tKeyFrames, tMaxGap);
+        int tAverage = tMuxer->GetEncodedFrameSizeAverage();
+        int tDeviation = tMuxer->GetEncodedFrameSizeDeviation();
+        int tPeak = tMuxer->GetEncodedFrameSizePeak();
+
+        // with VBV no frame may exceed the buffer
+        bool tOk = (tFrames > 0) && ((!sRuns[r].Realtime) || (tPeak <= tVbvBufferSize));
+        if (!tOk)
+            tResult = false;
+        printf("%-20s %12.1f %14d %18d %10.2f %14d %10.2f %8"PRId64" %8"PRId64" %8s\n", sRuns[r].Name, (double)tAverage * 8 * BENCHMARK_VIDEO_FPS / 1000, tAverage, tDeviation, (tAverage > 0) ? (double)tDeviation / tAverage : 0.0, tPeak, (tAverage > 0) ? (double)tPeak / tAverage : 0.0, tFrames, tKeyFrames, tOk ? "ok" : "FAILED");
+
+        tMuxer->CloseGrabDevice();
+        tMuxer->UnregisterMediaSink(&tCounter, false);
+        delete tMuxer;
+        delete tCamera;
+    }
+
+    av_free(tChunkBuffer);
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// synthetic master: the sender time of the currently played audio, set by the benchmark for each video frame
+class BenchmarkClockSource:
+    public MediaSource
+{
+public:
+    BenchmarkClockSource():
+        MediaSource("Benchmark: synthetic master clock")
+    {
+        mSynchronizationTimestamp = 0;
+    }
+
+    virtual ~BenchmarkClockSource() { }
+
+    virtual bool OpenVideoGrabDevice(int /* pResX */ = 352, int /* pResY */ = 288, float /* pFps */ = 29.97)
+    {
+        return false;
+    }
+
+    virtual bool OpenAudioGrabDevice(int /* pSampleRate */ = 44100, int /* pChannels */ = 2)
+    {
+        return false;
+    }
+
+    virtual bool CloseGrabDevice()
+    {
+        return true;
+    }
+
+    virtual int GrabChunk(void* /* pChunkBuffer */, int& /* pChunkSize */, bool /* pDropChunk */ = false)
+    {
+        return GRAB_RES_INVALID;
+    }
+
+    virtual int64_t GetSynchronizationTimestamp()
+    {
+        return mSynchronizationTimestamp;
+    }
+
+    void SetSynchronizationTimestamp(int64_t pTimestamp)
+    {
+        mSynchronizationTimestamp = pTimestamp;
+    }
+
+private:
+    int64_t             mSynchronizationTimestamp; // in us
+};
+
+bool Benchmark::AvSync()
+{
+    // the audio latency is the video latency plus the offset: with a positive offset the video runs ahead of the audio
+    static const struct
+    {
+        const char      *Name;
+        int             Offset; // in ms
+    }sRuns[] = {
+        {"video ahead",         40},
+        {"video behind",        -40},
+        {"video far ahead",     120},
+        {"video far behind",    -300},
+        {"after seeking",       800},
+    };
+    bool tResult = true;
+
+    //HINT: sender and receiver share the clock in a loopback, hence the synchronization timestamps are simulated
+    //      on a virtual clock instead of sleeping through the play-out: the slave presents a frame at its sender
+    //      time plus the video latency plus the shifts of the synchronizer, the master reports the sender time of
+    //      the audio which is played at that time
+    int64_t tFramePeriod = 1000 * 1000 / BENCHMARK_VIDEO_FPS; // in us
+    int tFrames = BENCHMARK_AV_SYNC_DURATION * BENCHMARK_VIDEO_FPS;
+    int tEvaluationFrames = BENCHMARK_AV_SYNC_EVALUATION_TIME * BENCHMARK_VIDEO_FPS;
+    int64_t tTolerance = (int64_t)(MEDIA_SYNC_DEAD_BAND * 1000 * 1000) + BENCHMARK_AV_SYNC_JITTER * 1000; // in us
+
+    printf("A/V synchronization of %d s video at %d fps against an audio master with %d ms jitter, residual skew within the last %d s, tolerance %.1f ms\n", BENCHMARK_AV_SYNC_DURATION, BENCHMARK_VIDEO_FPS, BENCHMARK_AV_SYNC_JITTER, BENCHMARK_AV_SYNC_EVALUATION_TIME, (float)tTolerance / 1000);
+    printf("%-20s %12s %16s %16s %18s %12s %10s %14s %8s\n", "offset", "skew [ms]", "residual [ms]", "max. res. [ms]", "convergence [ms]", "adjustments", "resyncs", "smoothed [ms]", "result");
+
+    for (unsigned int r = 0; r < sizeof(sRuns) / sizeof(sRuns[0]); r++)
+    {
+        BenchmarkClockSource tMaster;
+        MediaSynchronizer tSynchronizer(&tMaster, "benchmark");
+        int64_t tVideoLatency = BENCHMARK_AV_SYNC_VIDEO_LATENCY * 1000; // in us
+        int64_t tAudioLatency = tVideoLatency + sRuns[r].Offset * 1000; // in us
+        int64_t tSenderStartTime = Time::GetTimeStamp();
+        int64_t tShift = 0;
+        int64_t tResidualSum = 0;
+        int64_t tResidualMax = 0;
+        int tLastFrameOutOfSync = -1;
+        unsigned int tRandom = 1;
+
+        for (int f = 0; f < tFrames; f++)
+        {
+            //######################################################
+            //### schedule the next video frame
+            //######################################################
+            int64_t tSlaveTimestamp = tSenderStartTime + f * tFramePeriod;
+            int64_t tPresentationTime = tSlaveTimestamp + tVideoLatency + tShift;
+            int64_t tTime = tPresentationTime - BENCHMARK_AV_SYNC_PRESENTATION_DELAY * 1000;
+
+            // deterministic jitter, e.g., caused by the granularity of the audio frames
+            tRandom = tRandom * 1103515245 + 12345;
+            int64_t tJitter = (int64_t)((tRandom >> 16) % (2 * BENCHMARK_AV_SYNC_JITTER * 1000 + 1)) - BENCHMARK_AV_SYNC_JITTER * 1000;
+            tMaster.SetSynchronizationTimestamp(tTime - tAudioLatency + tJitter);
+
+            tShift += tSynchronizer.SchedulePresentation(tSlaveTimestamp, tPresentationTime - tTime);
+
+            //######################################################
+            //### skew at the presentation of the video frame
+            //######################################################
+            // sender time of the video frame minus sender time of the audio which is played at the same time
+            int64_t tSkew = tSlaveTimestamp - (tSlaveTimestamp + tVideoLatency + tShift - tAudioLatency);
+            int64_t tAbsSkew = (tSkew < 0) ? -tSkew : tSkew;
+            if (tAbsSkew > tTolerance)
+                tLastFrameOutOfSync = f;
+            if (f >= tFrames - tEvaluationFrames)
+            {
+                tResidualSum += tSkew;
+                if (tAbsSkew > tResidualMax)
+                    tResidualMax = tAbsSkew;
+            }
+        }
+
+        bool tOk = (tResidualMax <= tTolerance);
+        if (!tOk)
+            tResult = false;
+        printf("%-20s %12d %16.2f %16.2f %18"PRId64" %12"PRId64" %10"PRId64" %14.2f %8s\n", sRuns[r].Name, sRuns[r].Offset, (double)tResidualSum / tEvaluationFrames / 1000, (double)tResidualMax / 1000, (tLastFrameOutOfSync + 1) * tFramePeriod / 1000, tSynchronizer.GetAdjustmentCounter(), tSynchronizer.GetResynchronizationCounter(), tSynchronizer.GetOffset() * 1000, tOk ? "ok" : "FAILED");
+    }
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// plays out a media source like the grabber thread of a participant widget, the grabbed chunks are dropped
+class BenchmarkGrabber:
+    public Thread
+{
+public:
+    BenchmarkGrabber(MediaSource *pMediaSource, int pChunkBufferSize)
+    {
+        mMediaSource = pMediaSource;
+        mChunkBufferSize = pChunkBufferSize;
+        mGrabberNeeded = true;
+    }
+
+    virtual ~BenchmarkGrabber() { }
+
+    void StopGrabber()
+    {
+        mGrabberNeeded = false;
+        mMediaSource->StopGrabbing();
+        StopThread();
+    }
+
+private:
+    virtual void* Run(void* /* pArgs */ = NULL)
+    {
+        char *tChunkBuffer = (char*)av_malloc(mChunkBufferSize + FF_INPUT_BUFFER_PADDING_SIZE);
+
+        while (mGrabberNeeded)
+        {
+            int tChunkSize = mChunkBufferSize;
+            if ((mMediaSource->GrabChunk(tChunkBuffer, tChunkSize) < 0) && (mGrabberNeeded))
+                Thread::Suspend(10 * 1000);
+        }
+
+        av_free(tChunkBuffer);
+        return NULL;
+    }
+
+    MediaSource         *mMediaSource;
+    int                 mChunkBufferSize;
+    volatile bool       mGrabberNeeded;
+};
+
+bool Benchmark::Bundling()
+{
+    AVFormatContext     *tFormatContext;
+    AVStream            *tAudioStream, *tVideoStream;
+    AVCodec             *tAudioCodec, *tVideoCodec;
+    vector<AVPacket>    tVideoPackets;
+    bool                tResult = true;
+    int                 tRes;
+
+    MediaSource::FfmpegInit();
+
+    //######################################################
+    //### describe the streams, the content of the audio stream doesn't matter for A-law
+    //######################################################
+    tAudioCodec = avcodec_find_encoder(MediaSource::GetCodecIDFromGuiName(BENCHMARK_BUNDLE_AUDIO_CODEC));
+    tVideoCodec = avcodec_find_encoder(MediaSource::GetCodecIDFromGuiName(BENCHMARK_BUNDLE_VIDEO_CODEC));
+    if ((tAudioCodec == NULL) || (tVideoCodec == NULL))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't find %s or %s encoder", BENCHMARK_BUNDLE_AUDIO_CODEC, BENCHMARK_BUNDLE_VIDEO_CODEC);
+        return false;
+    }
+
+    tFormatContext = AV_NEW_FORMAT_CONTEXT();
+    tAudioStream = HM_avformat_new_stream(tFormatContext, tAudioCodec);
+    tVideoStream = HM_avformat_new_stream(tFormatContext, tVideoCodec);
+    if ((tAudioStream == NULL) || (tVideoStream == NULL))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Memory allocation failed");
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+    tAudioStream->codec->codec_type = AVMEDIA_TYPE_AUDIO;
+    tAudioStream->codec->codec_id = tAudioCodec->id;
+    tAudioStream->codec->sample_rate = 8000;
+    tAudioStream->codec->channels = 1;
+    tAudioStream->codec->rtp_payload_size = BENCHMARK_RTP_PACKET_SIZE;
+    tAudioStream->time_base = (AVRational){1, 8000};
+
+    int tAudioFrameSize = 8000 * BENCHMARK_BUNDLE_AUDIO_PTIME / 1000;
+    uint8_t *tAudioFrame = (uint8_t*)malloc(tAudioFrameSize);
+    memset(tAudioFrame, 0xD5 /* A-law silence */, tAudioFrameSize);
+
+    //######################################################
+    //### encode one second of video, it is sent in a loop and each loop starts with a key frame
+    //######################################################
+    tVideoStream->codec->codec_type = AVMEDIA_TYPE_VIDEO;
+    tVideoStream->codec->width = BENCHMARK_BUNDLE_VIDEO_WIDTH;
+    tVideoStream->codec->height = BENCHMARK_BUNDLE_VIDEO_HEIGHT;
+    tVideoStream->codec->pix_fmt = PIX_FMT_YUV420P;
+    tVideoStream->codec->time_base = (AVRational){1, BENCHMARK_VIDEO_FPS};
+    tVideoStream->codec->bit_rate = BENCHMARK_BUNDLE_VIDEO_BIT_RATE;
+    tVideoStream->codec->gop_size = BENCHMARK_VIDEO_FPS;
+    tVideoStream->codec->max_b_frames = 0;
+    tVideoStream->codec->thread_count = 1;
+    tVideoStream->codec->rtp_payload_size = BENCHMARK_RTP_PACKET_SIZE;
+    tVideoStream->time_base = (AVRational){1, BENCHMARK_VIDEO_FPS};
+    if ((tRes = HM_avcodec_open(tVideoStream->codec, tVideoCodec, NULL)) < 0)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't open %s encoder because \"%s\"", BENCHMARK_BUNDLE_VIDEO_CODEC, strerror(AVUNERROR(tRes)));
+        free(tAudioFrame);
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+    int tPictureSize = avpicture_get_size(PIX_FMT_YUV420P, BENCHMARK_BUNDLE_VIDEO_WIDTH, BENCHMARK_BUNDLE_VIDEO_HEIGHT);
+    uint8_t *tPicture = (uint8_t*)av_malloc(tPictureSize + FF_INPUT_BUFFER_PADDING_SIZE);
+    AVFrame *tSourceFrame = MediaSource::AllocFrame();
+    MediaSource::FillFrame(tSourceFrame, tPicture, PIX_FMT_YUV420P, BENCHMARK_BUNDLE_VIDEO_WIDTH, BENCHMARK_BUNDLE_VIDEO_HEIGHT);
+    for (int f = 0; f < BENCHMARK_VIDEO_FPS; f++)
+    {
+        AVPacket tPacket;
+        int tGotPacket = 0;
+
+        av_init_packet(&tPacket);
+        tPacket.data = NULL;
+        tPacket.size = 0;
+        MediaEncoderCalibration::CreateSyntheticPicture(tSourceFrame, BENCHMARK_BUNDLE_VIDEO_WIDTH, BENCHMARK_BUNDLE_VIDEO_HEIGHT, f);
+        tSourceFrame->pts = f;
+        if ((HM_avcodec_encode_video2(tVideoStream->codec, &tPacket, tSourceFrame, &tGotPacket) >= 0) && (tGotPacket))
+            tVideoPackets.push_back(tPacket);
+    }
+    av_free(tSourceFrame);
+    av_free(tPicture);
+    if (tVideoPackets.empty())
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't encode the %s test sequence", BENCHMARK_BUNDLE_VIDEO_CODEC);
+        free(tAudioFrame);
+        avcodec_close(tVideoStream->codec);
+        avformat_free_context(tFormatContext);
+        return false;
+    }
+
+    printf("Receiving of %d participants with %s audio (%d ms packets) and %s video (%d * %d, %d kbit/s) for %d s via UDP loopback\n", BENCHMARK_BUNDLE_PARTICIPANTS, BENCHMARK_BUNDLE_AUDIO_CODEC, BENCHMARK_BUNDLE_AUDIO_PTIME, BENCHMARK_BUNDLE_VIDEO_CODEC, BENCHMARK_BUNDLE_VIDEO_WIDTH, BENCHMARK_BUNDLE_VIDEO_HEIGHT, BENCHMARK_BUNDLE_VIDEO_BIT_RATE / 1000, BENCHMARK_BUNDLE_DURATION);
+    printf("%-12s %10s %10s %10s %10s %14s %10s %8s\n", "receiving", "sockets", "threads", "packets", "lost", "wakeups/s", "CPU [%]", "result");
+
+    Socket *tSendSocket = Socket::CreateClientSocket(SOCKET_IPv4, SOCKET_UDP);
+    if (tSendSocket == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create the sending socket");
+        tResult = false;
+    }
+
+    for (int b = 0; (b < 2) && (tSendSocket != NULL); b++)
+    {
+        bool tBundled = (b == 1);
+        Socket *tAudioSockets[BENCHMARK_BUNDLE_PARTICIPANTS], *tVideoSockets[BENCHMARK_BUNDLE_PARTICIPANTS];
+        MediaSourceNet *tAudioSources[BENCHMARK_BUNDLE_PARTICIPANTS], *tVideoSources[BENCHMARK_BUNDLE_PARTICIPANTS];
+        BenchmarkGrabber *tAudioGrabbers[BENCHMARK_BUNDLE_PARTICIPANTS], *tVideoGrabbers[BENCHMARK_BUNDLE_PARTICIPANTS];
+        MediaSinkNet *tAudioSinks[BENCHMARK_BUNDLE_PARTICIPANTS], *tVideoSinks[BENCHMARK_BUNDLE_PARTICIPANTS];
+        int tSockets = 0;
+        bool tSocketsCreated = true;
+
+        //######################################################
+        //### receivers: one bundle socket per participant or one socket per medium
+        //######################################################
+        for (int p = 0; p < BENCHMARK_BUNDLE_PARTICIPANTS; p++)
+        {
+            tVideoSockets[p] = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, BENCHMARK_BUNDLE_PORT, false, 2);
+            tAudioSockets[p] = tBundled ? tVideoSockets[p] : Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, BENCHMARK_BUNDLE_PORT, false, 2);
+            tSockets += tBundled ? 1 : 2;
+            if ((tVideoSockets[p] == NULL) || (tAudioSockets[p] == NULL))
+                tSocketsCreated = false;
+        }
+        if (!tSocketsCreated)
+        {
+            LOGEX(Benchmark, LOG_ERROR, "Couldn't create the receiving sockets");
+            for (int p = 0; p < BENCHMARK_BUNDLE_PARTICIPANTS; p++)
+            {
+                if (!tBundled)
+                    delete tAudioSockets[p];
+                delete tVideoSockets[p];
+            }
+            tResult = false;
+            continue;
+        }
+
+        int tThreads = (int)Thread::GetTIds().size();
+        for (int p = 0; p < BENCHMARK_BUNDLE_PARTICIPANTS; p++)
+        {
+            if (tBundled)
+            {
+                tVideoSources[p] = new MediaSourceNet(tVideoSockets[p], tVideoSockets[p]);
+                tAudioSources[p] = new MediaSourceNet(tAudioSockets[p], tAudioSockets[p]);
+            }else
+            {
+                tVideoSources[p] = new MediaSourceNet(tVideoSockets[p]);
+                tAudioSources[p] = new MediaSourceNet(tAudioSockets[p]);
+            }
+            tVideoSources[p]->SetInputStreamPreferences(BENCHMARK_BUNDLE_VIDEO_CODEC, true);
+            tVideoSources[p]->OpenVideoGrabDevice(BENCHMARK_BUNDLE_VIDEO_WIDTH, BENCHMARK_BUNDLE_VIDEO_HEIGHT, BENCHMARK_VIDEO_FPS);
+            tAudioSources[p]->SetInputStreamPreferences(BENCHMARK_BUNDLE_AUDIO_CODEC, true);
+            tAudioSources[p]->OpenAudioGrabDevice();
+            tVideoGrabbers[p] = new BenchmarkGrabber(tVideoSources[p], BENCHMARK_BUNDLE_VIDEO_WIDTH * BENCHMARK_BUNDLE_VIDEO_HEIGHT * 4);
+            tVideoGrabbers[p]->StartThread();
+            tAudioGrabbers[p] = new BenchmarkGrabber(tAudioSources[p], MEDIA_SOURCE_SAMPLES_MULTI_BUFFER_SIZE);
+            tAudioGrabbers[p]->StartThread();
+        }
+        // listeners, decoders and grabbers
+        tThreads = (int)Thread::GetTIds().size() - tThreads;
+
+        //######################################################
+        //### senders: the same RTP streams in both cases
+        //######################################################
+        // HINT: the media loopback is off by default, hence the packets go through the UDP stack
+        for (int p = 0; p < BENCHMARK_BUNDLE_PARTICIPANTS; p++)
+        {
+            tVideoSinks[p] = new MediaSinkNet("127.0.0.1", tVideoSockets[p]->GetLocalPort(), tSendSocket, MEDIA_SINK_VIDEO, true);
+            tVideoSinks[p]->SetActivation(true);
+            tAudioSinks[p] = new MediaSinkNet("127.0.0.1", tAudioSockets[p]->GetLocalPort(), tSendSocket, MEDIA_SINK_AUDIO, true);
+            tAudioSinks[p]->SetActivation(true);
+        }
+
+        //######################################################
+        //### stream in real-time and account the resources of the whole process
+        //######################################################
+        double tCpuTime = 0; // in s
+        int64_t tWakeups = 0;
+        #if defined(LINUX)
+            struct rusage tUsageStart, tUsageEnd;
+            getrusage(RUSAGE_SELF, &tUsageStart);
+        #endif
+        int64_t tStartTime = Time::GetTimeStamp();
+        int64_t tAudioTime = 0, tVideoTime = 0; // in us
+        int64_t tAudioFrames = 0, tVideoFrames = 0;
+        while ((tAudioTime < BENCHMARK_BUNDLE_DURATION * 1000 * 1000) || (tVideoTime < BENCHMARK_BUNDLE_DURATION * 1000 * 1000))
+        {
+            bool tAudio = (tAudioTime <= tVideoTime);
+            int64_t tWaitTime = tStartTime + (tAudio ? tAudioTime : tVideoTime) - Time::GetTimeStamp();
+            if (tWaitTime > 0)
+                Thread::Suspend(tWaitTime);
+
+            for (int p = 0; p < BENCHMARK_BUNDLE_PARTICIPANTS; p++)
+            {
+                AVPacket tPacket;
+                if (tAudio)
+                {
+                    av_init_packet(&tPacket);
+                    tPacket.data = tAudioFrame;
+                    tPacket.size = tAudioFrameSize;
+                    tPacket.pts = tAudioFrames * tAudioFrameSize;
+                    tPacket.dts = tPacket.pts;
+                    tAudioSinks[p]->ProcessPacket(&tPacket, tAudioStream);
+                }else
+                {
+                    tPacket = tVideoPackets[tVideoFrames % tVideoPackets.size()];
+                    tPacket.pts = tVideoFrames;
+                    tPacket.dts = tPacket.pts;
+                    tVideoSinks[p]->ProcessPacket(&tPacket, tVideoStream);
+                }
+            }
+            if (tAudio)
+            {
+                tAudioFrames++;
+                tAudioTime = tAudioFrames * BENCHMARK_BUNDLE_AUDIO_PTIME * 1000;
+            }else
+            {
+                tVideoFrames++;
+                tVideoTime = tVideoFrames * 1000 * 1000 / BENCHMARK_VIDEO_FPS;
+            }
+        }
+        #if defined(LINUX)
+            getrusage(RUSAGE_SELF, &tUsageEnd);
+            tCpuTime = (double)(tUsageEnd.ru_utime.tv_sec - tUsageStart.ru_utime.tv_sec + tUsageEnd.ru_stime.tv_sec - tUsageStart.ru_stime.tv_sec) + (double)(tUsageEnd.ru_utime.tv_usec - tUsageStart.ru_utime.tv_usec + tUsageEnd.ru_stime.tv_usec - tUsageStart.ru_stime.tv_usec) / 1000 / 1000;
+            // a thread which blocks in a receive call gives up the CPU voluntarily
+            tWakeups = (int64_t)(tUsageEnd.ru_nvcsw - tUsageStart.ru_nvcsw);
+        #endif
+        double tDuration = (double)(Time::GetTimeStamp() - tStartTime) / 1000 / 1000; // in s
+
+        // the receivers get some time for the last packets
+        Thread::Suspend(BENCHMARK_BUNDLE_DRAIN_TIME * 1000);
+
+        //######################################################
+        //### compare sent and received packets and release everything
+        //######################################################
+        int64_t tSentPackets = 0, tReceivedPackets = 0;
+        for (int p = 0; p < BENCHMARK_BUNDLE_PARTICIPANTS; p++)
+        {
+            tSentPackets += tAudioSinks[p]->GetPacketCount() + tVideoSinks[p]->GetPacketCount();
+            tReceivedPackets += tAudioSources[p]->GetPacketCount() + tVideoSources[p]->GetPacketCount();
+
+            delete tAudioSinks[p];
+            delete tVideoSinks[p];
+            tAudioGrabbers[p]->StopGrabber();
+            tVideoGrabbers[p]->StopGrabber();
+            delete tAudioGrabbers[p];
+            delete tVideoGrabbers[p];
+            delete tAudioSources[p];
+            delete tVideoSources[p];
+            // HINT: a source doesn't delete a socket which was given to it
+            if (!tBundled)
+                delete tAudioSockets[p];
+            delete tVideoSockets[p];
+        }
+
+        int64_t tLostPackets = tSentPackets - tReceivedPackets;
+
+        // UDP via loopback may lose hardly any packets at this load
+        bool tOk = (tReceivedPackets > 0) && (tLostPackets <= tSentPackets / 100);
+        if (!tOk)
+            tResult = false;
+        printf("%-12s %10d %10d %10"PRId64" %10"PRId64" %14.1f %10.1f %8s\n", tBundled ? "bundled" : "unbundled", tSockets, tThreads, tReceivedPackets, tLostPackets, tWakeups / tDuration, tCpuTime * 100 / tDuration, tOk ? "ok" : "FAILED");
+    }
+
+    for (unsigned int i = 0; i < tVideoPackets.size(); i++)
+        av_free_packet(&tVideoPackets[i]);
+    delete tSendSocket;
+    free(tAudioFrame);
+    avcodec_close(tVideoStream->codec);
+    avformat_free_context(tFormatContext);
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Benchmark::MemoryBudget()
+{
+    int64_t tFifoMax = (int64_t)BENCHMARK_BUDGET_FIFO_ENTRIES * BENCHMARK_BUDGET_FIFO_ENTRY_SIZE;
+    int64_t tFifoMin = (int64_t)MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES * BENCHMARK_BUDGET_FIFO_ENTRY_SIZE;
+    int tBackgroundStreams = BENCHMARK_BUDGET_STREAMS / 2;
+    int tForegroundStreams = BENCHMARK_BUDGET_STREAMS - tBackgroundStreams;
+    // each budget is given on top of the memory which is already accounted, -1 for "unlimited"
+    const struct
+    {
+        const char      *Name;
+        int64_t         Budget; // in bytes
+    }tRuns[] = {
+        {"unlimited",                   -1},
+        {"everything fits",             BENCHMARK_BUDGET_STREAMS * tFifoMax},
+        {"background shrunk",           tForegroundStreams * tFifoMax + tBackgroundStreams * (tFifoMin + tFifoMax) / 2},
+        {"foreground shrunk",           tForegroundStreams * (tFifoMin + tFifoMax) / 2 + tBackgroundStreams * tFifoMin},
+        {"below the minimum",           BENCHMARK_BUDGET_STREAMS * tFifoMin / 2},
+    };
+    MediaSource *tStreams[BENCHMARK_BUDGET_STREAMS];
+    MediaFifo *tFifos[BENCHMARK_BUDGET_STREAMS];
+    int64_t tPreviousBudget = SVC_MEDIA_MEMORY_BUDGET.GetBudget();
+    bool tResult = true;
+
+    // memory of other FIFOs and buffers, e.g., of the shared memory sink
+    SVC_MEDIA_MEMORY_BUDGET.SetBudget(MEDIA_MEMORY_BUDGET_UNLIMITED);
+    int64_t tOtherUsage = SVC_MEDIA_MEMORY_BUDGET.GetUsage();
+
+    //######################################################
+    //### one FIFO per synthetic stream, every second stream is in the background
+    //######################################################
+    for (int i = 0; i < BENCHMARK_BUDGET_STREAMS; i++)
+    {
+        tStreams[i] = new BenchmarkVideoSource();
+        tFifos[i] = new MediaFifo(BENCHMARK_BUDGET_FIFO_ENTRIES, BENCHMARK_BUDGET_FIFO_ENTRY_SIZE, "Benchmark-" + toString(i));
+        SVC_MEDIA_MEMORY_BUDGET.AssignFifo(tFifos[i], tStreams[i]);
+        SVC_MEDIA_MEMORY_BUDGET.SetStreamBackground(tStreams[i], (i % 2 == 1));
+    }
+
+    printf("Media memory budget for %d streams (%d in the background) with one FIFO of %d entries of %d KB each, at least %d entries per FIFO, %"PRId64" KB accounted before\n", BENCHMARK_BUDGET_STREAMS, tBackgroundStreams, BENCHMARK_BUDGET_FIFO_ENTRIES, BENCHMARK_BUDGET_FIFO_ENTRY_SIZE / 1024, MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES, tOtherUsage / 1024);
+    printf("%-20s %14s %14s %14s %20s %20s %8s\n", "budget", "budget [KB]", "effective [KB]", "usage [KB]", "foreground entries", "background entries", "result");
+
+    for (unsigned int r = 0; r < sizeof(tRuns) / sizeof(tRuns[0]); r++)
+    {
+        SVC_MEDIA_MEMORY_BUDGET.SetBudget((tRuns[r].Budget < 0) ? MEDIA_MEMORY_BUDGET_UNLIMITED : tOtherUsage + tRuns[r].Budget);
+        int64_t tBudget = SVC_MEDIA_MEMORY_BUDGET.GetEffectiveBudget();
+        int64_t tUsage = SVC_MEDIA_MEMORY_BUDGET.GetUsage();
+
+        //######################################################
+        //### range of the FIFO sizes per class
+        //######################################################
+        int tForegroundMin = BENCHMARK_BUDGET_FIFO_ENTRIES, tForegroundMax = 0;
+        int tBackgroundMin = BENCHMARK_BUDGET_FIFO_ENTRIES, tBackgroundMax = 0;
+        for (int i = 0; i < BENCHMARK_BUDGET_STREAMS; i++)
+        {
+            int tEntries = tFifos[i]->GetSize();
+            if (SVC_MEDIA_MEMORY_BUDGET.IsStreamBackground(tStreams[i]))
+            {
+                tBackgroundMin = min(tBackgroundMin, tEntries);
+                tBackgroundMax = max(tBackgroundMax, tEntries);
+            }else
+            {
+                tForegroundMin = min(tForegroundMin, tEntries);
+                tForegroundMax = max(tForegroundMax, tEntries);
+            }
+        }
+
+        //######################################################
+        //### the budget holds as long as the minimum fits and the foreground is only shrunk if the background is at its minimum
+        //######################################################
+        bool tOk = true;
+        if ((tBudget != MEDIA_MEMORY_BUDGET_UNLIMITED) && (tBudget >= tOtherUsage + BENCHMARK_BUDGET_STREAMS * tFifoMin) && (tUsage > tBudget))
+            tOk = false;
+        if ((tBudget == MEDIA_MEMORY_BUDGET_UNLIMITED) && (tForegroundMin + tBackgroundMin < 2 * BENCHMARK_BUDGET_FIFO_ENTRIES))
+            tOk = false;
+        if ((tForegroundMin < BENCHMARK_BUDGET_FIFO_ENTRIES) && (tBackgroundMax > MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES))
+            tOk = false;
+        if ((tForegroundMin < MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES) || (tBackgroundMin < MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES))
+            tOk = false;
+        if (!tOk)
+            tResult = false;
+
+        string tForegroundEntries = toString(tForegroundMin) + " - " + toString(tForegroundMax);
+        string tBackgroundEntries = toString(tBackgroundMin) + " - " + toString(tBackgroundMax);
+        printf("%-20s %14"PRId64" %14"PRId64" %14"PRId64" %20s %20s %8s\n", tRuns[r].Name, (tRuns[r].Budget < 0) ? (int64_t)0 : (tOtherUsage + tRuns[r].Budget) / 1024, tBudget / 1024, tUsage / 1024, tForegroundEntries.c_str(), tBackgroundEntries.c_str(), tOk ? "ok" : "FAILED");
+    }
+
+    for (int i = 0; i < BENCHMARK_BUDGET_STREAMS; i++)
+    {
+        delete tFifos[i];
+        SVC_MEDIA_MEMORY_BUDGET.UnregisterStream(tStreams[i]);
+        delete tStreams[i];
+    }
+    SVC_MEDIA_MEMORY_BUDGET.SetBudget(tPreviousBudget);
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Benchmark::FirstFrame()
+{
+    bool tResult = true;
+    int tResX, tResY;
+    double tAverageFirstFrame[2] = {0, 0}; // in ms
+
+    MediaSource::FfmpegInit();
+
+    //######################################################
+    //### the sender streams all the time, each receiver joins a running stream
+    //######################################################
+    // find a free port, each receiver gets its own socket at this port because a stopped listener closes its socket
+    Socket *tReceiveSocket = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, BENCHMARK_FIRST_FRAME_PORT, true, 2);
+    Socket *tSendSocket = Socket::CreateClientSocket(SOCKET_IPv4, SOCKET_UDP);
+    if ((tReceiveSocket == NULL) || (tSendSocket == NULL))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create the sockets");
+        delete tReceiveSocket;
+        delete tSendSocket;
+        return false;
+    }
+    unsigned int tReceivePort = tReceiveSocket->GetLocalPort();
+    delete tReceiveSocket;
+
+    BenchmarkVideoSource *tCamera = new BenchmarkVideoSource();
+    MediaSourceMuxer *tMuxer = new MediaSourceMuxer(tCamera);
+    tMuxer->SetOutputStreamPreferences(BENCHMARK_FIRST_FRAME_CODEC, 10, BENCHMARK_FIRST_FRAME_BIT_RATE, BENCHMARK_RTP_PACKET_SIZE, false, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT);
+    // HINT: the media loopback is off by default, hence the packets go through the UDP stack
+    MediaSinkNet *tSink = tMuxer->RegisterMediaSink("127.0.0.1", tReceivePort, tSendSocket, true);
+    tMuxer->OpenVideoGrabDevice(BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_VIDEO_FPS);
+    tMuxer->GetMuxingResolution(tResX, tResY);
+    if ((tResX == 0) || (tResY == 0) || (tSink == NULL))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't open the %s encoder", BENCHMARK_FIRST_FRAME_CODEC);
+        if (tSink != NULL)
+            tMuxer->UnregisterMediaSink(tSink);
+        delete tMuxer;
+        delete tCamera;
+        delete tSendSocket;
+        return false;
+    }
+    BenchmarkGrabber tSender(tMuxer, BENCHMARK_VIDEO_WIDTH * BENCHMARK_VIDEO_HEIGHT * 4);
+    tSender.StartThread();
+
+    int tChunkSize = BENCHMARK_VIDEO_WIDTH * BENCHMARK_VIDEO_HEIGHT * 4;
+    char *tChunkBuffer = (char*)av_malloc(tChunkSize + FF_INPUT_BUFFER_PADDING_SIZE);
+
+    printf("Time to the first frame of a running %s stream (%d * %d, %d kbit/s) via UDP loopback, %d receivers per mode\n", BENCHMARK_FIRST_FRAME_CODEC, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_FIRST_FRAME_BIT_RATE / 1000, BENCHMARK_FIRST_FRAME_RUNS);
+    printf("%-12s %14s %18s %18s %18s %8s\n", "stream", "open [ms]", "first frame [ms]", "max. first [ms]", "decoder [ms]", "result");
+
+    for (int m = 0; m < 2; m++)
+    {
+        bool tFastOpen = (m == 0);
+        double tOpenTimeSum = 0, tFirstFrameSum = 0, tFirstFrameMax = 0, tDecoderSum = 0;
+        int tFrames = 0;
+
+        for (int r = 0; r < BENCHMARK_FIRST_FRAME_RUNS; r++)
+        {
+            // join at different positions of the GOP
+            Thread::Suspend((BENCHMARK_FIRST_FRAME_PAUSE + r * 1000 / BENCHMARK_VIDEO_FPS) * 1000);
+
+            //######################################################
+            //### open a receiver and wait for its first frame
+            //######################################################
+            tReceiveSocket = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, tReceivePort, true);
+            if (tReceiveSocket == NULL)
+            {
+                LOGEX(Benchmark, LOG_ERROR, "Couldn't create the receiving socket at port %u", tReceivePort);
+                continue;
+            }
+            MediaSourceNet *tSource = new MediaSourceNet(tReceiveSocket);
+            tSource->SetInputStreamPreferences(BENCHMARK_FIRST_FRAME_CODEC, true);
+            tSource->SetFastOpen(tFastOpen);
+            int64_t tStartTime = Time::GetTimeStamp();
+            bool tOpened = tSource->OpenVideoGrabDevice(BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_VIDEO_FPS);
+            int64_t tOpenTime = Time::GetTimeStamp() - tStartTime;
+            int64_t tFirstFrameTime = -1;
+            while ((tOpened) && (Time::GetTimeStamp() - tStartTime < BENCHMARK_FIRST_FRAME_TIMEOUT * 1000 * 1000))
+            {
+                int tSize = tChunkSize;
+                if (tSource->GrabChunk(tChunkBuffer, tSize) >= 0)
+                {
+                    tFirstFrameTime = Time::GetTimeStamp() - tStartTime;
+                    break;
+                }
+            }
+            if (tFirstFrameTime >= 0)
+            {
+                tFrames++;
+                tOpenTimeSum += (double)tOpenTime / 1000;
+                tFirstFrameSum += (double)tFirstFrameTime / 1000;
+                tFirstFrameMax = max(tFirstFrameMax, (double)tFirstFrameTime / 1000);
+                tDecoderSum += tSource->GetTimeToFirstFrame();
+            }else
+                LOGEX(Benchmark, LOG_ERROR, "No frame received within %d s", BENCHMARK_FIRST_FRAME_TIMEOUT);
+            // HINT: the source doesn't delete a socket which was given to it
+            delete tSource;
+            delete tReceiveSocket;
+        }
+
+        bool tOk = (tFrames == BENCHMARK_FIRST_FRAME_RUNS);
+        if (tFrames > 0)
+            tAverageFirstFrame[m] = tFirstFrameSum / tFrames;
+        // describing the negotiated stream mustn't be slower than probing it, one frame interval is tolerated
+        if ((!tFastOpen) && (tAverageFirstFrame[0] > tAverageFirstFrame[1] + 1000.0 / BENCHMARK_VIDEO_FPS))
+            tOk = false;
+        if (!tOk)
+            tResult = false;
+        printf("%-12s %14.1f %18.1f %18.1f %18.1f %8s\n", tFastOpen ? "described" : "probed", (tFrames > 0) ? tOpenTimeSum / tFrames : 0.0, tAverageFirstFrame[m], tFirstFrameMax, (tFrames > 0) ? tDecoderSum / tFrames : 0.0, tOk ? "ok" : "FAILED");
+    }
+
+    tSender.StopGrabber();
+    tMuxer->CloseGrabDevice();
+    tMuxer->UnregisterMediaSink(tSink);
+    delete tMuxer;
+    delete tCamera;
+    av_free(tChunkBuffer);
+    // HINT: the network sink doesn't delete its socket
+    delete tSendSocket;
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(LINUX)
+// creates the file and its parent directories below the root, remembers everything created for the clean up
+static bool WriteControlGroupFile(string pRoot, string pFile, string pContent, list<string> &pCreated)
+{
+    size_t tPos = 0;
+    while ((tPos = pFile.find('/', tPos)) != string::npos)
+    {
+        string tDirectory = pRoot + "/" + pFile.substr(0, tPos);
+        if (mkdir(tDirectory.c_str(), 0700) == 0)
+            pCreated.push_front(tDirectory);
+        tPos++;
+    }
+
+    string tFileName = pRoot + "/" + pFile;
+    FILE *tFile = fopen(tFileName.c_str(), "w");
+    if (tFile == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create %s", tFileName.c_str());
+        return false;
+    }
+    pCreated.push_front(tFileName);
+    fprintf(tFile, "%s\n", pContent.c_str());
+    fclose(tFile);
+
+    return true;
+}
+#endif
+
+bool Benchmark::ControlGroups()
+{
+#if defined(LINUX)
+    // the membership is written to <root>/proc/self/cgroup, 0 as expected value means "unlimited"
+    static const struct
+    {
+        const char      *Name;
+        const char      *Membership;
+        const char      *Files[4][2]; // path below the root and content
+        int             Cores;
+        int64_t         MemoryLimit; // in bytes
+    }sRuns[] = {
+        {"v2 limited",              "0::/homer/session",                            {{"homer/session/cpu.max", "150000 100000"}, {"homer/session/memory.max", "268435456"}, {NULL, NULL}, {NULL, NULL}},                                           2, 256 * 1024 * 1024},
+        {"v2 parent limited",       "0::/homer/session",                            {{"homer/cpu.max", "100000 100000"}, {"homer/session/cpu.max", "max 100000"}, {"homer/memory.max", "134217728"}, {"homer/session/memory.max", "max"}},   1, 128 * 1024 * 1024},
+        {"v2 namespace",            "0::/",                                         {{"cpu.max", "250000 100000"}, {"memory.max", "67108864"}, {NULL, NULL}, {NULL, NULL}},                                                                3, 64 * 1024 * 1024},
+        {"v2 unlimited",            "0::/homer/session",                            {{"homer/session/cpu.max", "max 100000"}, {"homer/session/memory.max", "max"}, {NULL, NULL}, {NULL, NULL}},                                             0, 0},
+        {"v1 limited",              "5:memory:/homer\n4:cpu,cpuacct:/homer",        {{"cpu,cpuacct/homer/cpu.cfs_quota_us", "200000"}, {"cpu,cpuacct/homer/cpu.cfs_period_us", "100000"}, {"memory/homer/memory.limit_in_bytes", "201326592"}, {NULL, NULL}},         2, 192 * 1024 * 1024},
+        {"v1 unlimited",            "5:memory:/homer\n4:cpu,cpuacct:/homer",        {{"cpu,cpuacct/homer/cpu.cfs_quota_us", "-1"}, {"cpu,cpuacct/homer/cpu.cfs_period_us", "100000"}, {"memory/homer/memory.limit_in_bytes", "9223372036854771712"}, {NULL, NULL}}, 0, 0},
+    };
+    string tPreviousRoot = System::GetControlGroupRoot();
+    bool tResult = true;
+
+    char tRootTemplate[] = BENCHMARK_CGROUP_ROOT_TEMPLATE;
+    if (mkdtemp(tRootTemplate) == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create a temporary directory");
+        return false;
+    }
+    string tRoot = string(tRootTemplate);
+
+    //######################################################
+    //### an empty fake root leaves only the machine cores and the affinity mask
+    //######################################################
+    System::SetControlGroupRoot(tRoot);
+    int tUnlimitedCores = System::GetEffectiveCores();
+
+    printf("Effective resources derived from fake cgroup file systems in %s, %d cores without quota, %"PRId64" MB physical memory\n", tRoot.c_str(), tUnlimitedCores, System::GetMachineMemoryPhysical() / 1024 / 1024);
+    printf("%-20s %12s %12s %12s %18s %18s %8s\n", "hierarchy", "quota cores", "expected", "effective", "expected [MB]", "limit [MB]", "result");
+
+    for (unsigned int r = 0; r < sizeof(sRuns) / sizeof(sRuns[0]); r++)
+    {
+        list<string> tCreated;
+        bool tOk = WriteControlGroupFile(tRoot, "proc/self/cgroup", sRuns[r].Membership, tCreated);
+        for (int f = 0; (f < 4) && (sRuns[r].Files[f][0] != NULL); f++)
+            tOk &= WriteControlGroupFile(tRoot, sRuns[r].Files[f][0], sRuns[r].Files[f][1], tCreated);
+
+        // drops the cached values of the previous run
+        System::SetControlGroupRoot(tRoot);
+        int tExpectedCores = ((sRuns[r].Cores > 0) && (sRuns[r].Cores < tUnlimitedCores)) ? sRuns[r].Cores : tUnlimitedCores;
+        int tCores = System::GetEffectiveCores();
+        int64_t tMemoryLimit = System::GetMemoryLimit();
+
+        if ((tCores != tExpectedCores) || (tMemoryLimit != sRuns[r].MemoryLimit))
+            tOk = false;
+        if (!tOk)
+            tResult = false;
+
+        printf("%-20s %12d %12d %12d %18"PRId64" %18"PRId64" %8s\n", sRuns[r].Name, sRuns[r].Cores, tExpectedCores, tCores, sRuns[r].MemoryLimit / 1024 / 1024, tMemoryLimit / 1024 / 1024, tOk ? "ok" : "FAILED");
+
+        // files before their directories
+        list<string>::iterator tIt;
+        for (tIt = tCreated.begin(); tIt != tCreated.end(); tIt++)
+            remove(tIt->c_str());
+    }
+
+    rmdir(tRoot.c_str());
+    System::SetControlGroupRoot(tPreviousRoot);
+
+    return tResult;
+#else
+    LOGEX(Benchmark, LOG_ERROR, "Control groups are only supported on Linux");
+    return false;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// probes of the fake video device files, from the enumeration and from the hotplug thread
+static Mutex sHotplugProbesMutex;
+static int sHotplugProbes = 0;
+
+// a fake device file is a usable video device if it contains "valid"
+static bool ProbeHotplugDevice(string pDeviceFile, VideoDeviceDescriptor &pDevice, VideoDeviceCapabilities & /* pCapabilities */)
+{
+    char tLine[64] = "";
+
+    sHotplugProbesMutex.lock();
+    sHotplugProbes++;
+    sHotplugProbesMutex.unlock();
+
+    FILE *tFile = fopen(pDeviceFile.c_str(), "r");
+    if (tFile == NULL)
+        return false;
+    if (fgets(tLine, sizeof(tLine), tFile) == NULL)
+        tLine[0] = 0;
+    fclose(tFile);
+
+    string tDeviceId = pDeviceFile.substr(pDeviceFile.rfind(BENCHMARK_HOTPLUG_PREFIX) + strlen(BENCHMARK_HOTPLUG_PREFIX));
+    pDevice.Name = "Benchmark device " + tDeviceId;
+    pDevice.Card = pDeviceFile;
+    pDevice.Desc = "Fake video device " + tDeviceId;
+    pDevice.Type = GeneralVideoDevice;
+
+    return (strncmp(tLine, "valid", 5) == 0);
+}
+
+static int GetHotplugProbes()
+{
+    int tResult;
+
+    sHotplugProbesMutex.lock();
+    tResult = sHotplugProbes;
+    sHotplugProbes = 0;
+    sHotplugProbesMutex.unlock();
+
+    return tResult;
+}
+
+class BenchmarkDeviceObserver:
+    public MediaDeviceObserver
+{
+public:
+    BenchmarkDeviceObserver()
+    {
+        mVideoNotifications = 0;
+        mAudioNotifications = 0;
+    }
+
+    virtual ~BenchmarkDeviceObserver() { }
+
+    virtual void MediaDevicesChanged(enum MediaType pMediaType)
+    {
+        mMutex.lock();
+        if (pMediaType == MEDIA_VIDEO)
+            mVideoNotifications++;
+        if (pMediaType == MEDIA_AUDIO)
+            mAudioNotifications++;
+        mMutex.unlock();
+    }
+
+    /* returns the values since the last call */
+    void GetNotifications(int &pVideo, int &pAudio)
+    {
+        mMutex.lock();
+        pVideo = mVideoNotifications;
+        pAudio = mAudioNotifications;
+        mVideoNotifications = 0;
+        mAudioNotifications = 0;
+        mMutex.unlock();
+    }
+
+    bool HasNotifications()
+    {
+        bool tResult;
+
+        mMutex.lock();
+        tResult = ((mVideoNotifications > 0) || (mAudioNotifications > 0));
+        mMutex.unlock();
+
+        return tResult;
+    }
+
+private:
+    Mutex               mMutex;
+    int                 mVideoNotifications;
+    int                 mAudioNotifications;
+};
+
+bool Benchmark::DeviceHotplug()
+{
+#if defined(LINUX)
+    enum HotplugAction
+    {
+        HOTPLUG_NONE = 0,
+        HOTPLUG_ADD,
+        HOTPLUG_ADD_DIRECTORY,
+        HOTPLUG_REMOVE
+    };
+    // each step is followed by an enumeration, the probes of the hotplug thread and of the enumeration are counted together
+    static const struct
+    {
+        const char      *Name;
+        enum HotplugAction Action;
+        const char      *File; // below the device directory
+        const char      *Content;
+        bool            VideoChanged;
+        bool            AudioChanged;
+        int             Probes;
+        int             Devices;
+    }sSteps[] = {
+        {"add before scan",         HOTPLUG_ADD,            BENCHMARK_HOTPLUG_PREFIX "0",   "valid",    false,  false,  1,  1},
+        {"unchanged",               HOTPLUG_NONE,           NULL,                           NULL,       false,  false,  0,  1},
+        {"add device",              HOTPLUG_ADD,            BENCHMARK_HOTPLUG_PREFIX "1",   "valid",    true,   false,  1,  2},
+        {"add other file",          HOTPLUG_ADD,            "other0",                       "valid",    false,  false,  0,  2},
+        {"add invalid device",      HOTPLUG_ADD,            BENCHMARK_HOTPLUG_PREFIX "2",   "invalid",  true,   false,  1,  2},
+        {"remove device",           HOTPLUG_REMOVE,         BENCHMARK_HOTPLUG_PREFIX "0",   NULL,       true,   false,  0,  1},
+        {"add sound directory",     HOTPLUG_ADD_DIRECTORY,  MEDIA_DEVICE_REGISTRY_SOUND_DIRECTORY, NULL, false, true,   0,  1},
+        {"add sound device",        HOTPLUG_ADD,            MEDIA_DEVICE_REGISTRY_SOUND_DIRECTORY "/pcmC0D0p", "", false, true, 0, 1},
+        {"remove sound device",     HOTPLUG_REMOVE,         MEDIA_DEVICE_REGISTRY_SOUND_DIRECTORY "/pcmC0D0p", NULL, false, true, 0, 1},
+        {"remove invalid device",   HOTPLUG_REMOVE,         BENCHMARK_HOTPLUG_PREFIX "2",   NULL,       true,   false,  0,  1},
+    };
+    string tPreviousDirectory = SVC_MEDIA_DEVICE_REGISTRY.GetDeviceDirectory();
+    bool tWasActive = SVC_MEDIA_DEVICE_REGISTRY.IsHotplugDetectionActive();
+    BenchmarkDeviceObserver tObserver;
+    list<string> tCreated;
+    bool tResult = true;
+
+    char tDirectoryTemplate[] = BENCHMARK_HOTPLUG_DIRECTORY_TEMPLATE;
+    if (mkdtemp(tDirectoryTemplate) == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create a temporary directory");
+        return false;
+    }
+    string tDirectory = string(tDirectoryTemplate);
+
+    //######################################################
+    //### redirect the registry to the empty directory and watch it
+    //######################################################
+    SVC_MEDIA_DEVICE_REGISTRY.SetDeviceDirectory(tDirectory);
+    if ((!SVC_MEDIA_DEVICE_REGISTRY.IsHotplugDetectionActive()) && (!SVC_MEDIA_DEVICE_REGISTRY.StartHotplugDetection()))
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't start the hotplug detection for %s", tDirectory.c_str());
+        SVC_MEDIA_DEVICE_REGISTRY.SetDeviceDirectory(tPreviousDirectory);
+        rmdir(tDirectory.c_str());
+        return false;
+    }
+    SVC_MEDIA_DEVICE_REGISTRY.AddObserver(&tObserver);
+    GetHotplugProbes();
+
+    printf("Notifications and probes of the device registry for fake device files in %s\n", tDirectory.c_str());
+    printf("%-22s %14s %14s %12s %8s %10s %8s\n", "step", "video changed", "audio changed", "generation", "probes", "devices", "result");
+
+    for (unsigned int s = 0; s < sizeof(sSteps) / sizeof(sSteps[0]); s++)
+    {
+        int64_t tGeneration = SVC_MEDIA_DEVICE_REGISTRY.GetGeneration();
+        string tFileName = (sSteps[s].File != NULL) ? tDirectory + "/" + sSteps[s].File : "";
+        bool tOk = true;
+
+        //######################################################
+        //### change the device directory, new device files appear complete like with udev
+        //######################################################
+        switch(sSteps[s].Action)
+        {
+            case HOTPLUG_ADD:
+                {
+                    string tTempFileName = tDirectory + "/.creating";
+                    FILE *tFile = fopen(tTempFileName.c_str(), "w");
+                    if (tFile != NULL)
+                    {
+                        fprintf(tFile, "%s\n", sSteps[s].Content);
+                        fclose(tFile);
+                    }
+                    if ((tFile == NULL) || (rename(tTempFileName.c_str(), tFileName.c_str()) != 0))
+                    {
+                        LOGEX(Benchmark, LOG_ERROR, "Couldn't create %s", tFileName.c_str());
+                        tOk = false;
+                    }else
+                        tCreated.push_front(tFileName);
+                }
+                break;
+            case HOTPLUG_ADD_DIRECTORY:
+                if (mkdir(tFileName.c_str(), 0700) != 0)
+                {
+                    LOGEX(Benchmark, LOG_ERROR, "Couldn't create %s", tFileName.c_str());
+                    tOk = false;
+                }else
+                    tCreated.push_front(tFileName);
+                break;
+            case HOTPLUG_REMOVE:
+                if (remove(tFileName.c_str()) != 0)
+                    tOk = false;
+                tCreated.remove(tFileName);
+                break;
+            default:
+                break;
+        }
+
+        // wait for the expected notification, afterwards the hotplug thread may report further events
+        if ((sSteps[s].VideoChanged) || (sSteps[s].AudioChanged))
+        {
+            int64_t tStartTime = Time::GetTimeStamp();
+            while ((!tObserver.HasNotifications()) && (Time::GetTimeStamp() - tStartTime < BENCHMARK_HOTPLUG_TIMEOUT * 1000))
+                Thread::Suspend(10 * 1000);
+        }
+        Thread::Suspend(BENCHMARK_HOTPLUG_SETTLE_TIME * 1000);
+
+        VideoDevices tDevices;
+        SVC_MEDIA_DEVICE_REGISTRY.GetVideoDevices(BENCHMARK_HOTPLUG_PREFIX, ProbeHotplugDevice, tDevices);
+        int tProbes = GetHotplugProbes();
+        int tVideoNotifications, tAudioNotifications;
+        tObserver.GetNotifications(tVideoNotifications, tAudioNotifications);
+        int64_t tGenerationBump = SVC_MEDIA_DEVICE_REGISTRY.GetGeneration() - tGeneration;
+
+        //######################################################
+        //### only real changes are notified and bump the generation, only new device files are probed
+        //######################################################
+        if (((tVideoNotifications > 0) != sSteps[s].VideoChanged) || ((tAudioNotifications > 0) != sSteps[s].AudioChanged))
+            tOk = false;
+        if ((tGenerationBump > 0) != ((sSteps[s].VideoChanged) || (sSteps[s].AudioChanged)))
+            tOk = false;
+        if ((tProbes != sSteps[s].Probes) || ((int)tDevices.size() != sSteps[s].Devices))
+            tOk = false;
+        if (!tOk)
+            tResult = false;
+
+        printf("%-22s %14d %14d %12"PRId64" %8d %4d of %3d %8s\n", sSteps[s].Name, tVideoNotifications, tAudioNotifications, tGenerationBump, tProbes, (int)tDevices.size(), sSteps[s].Devices, tOk ? "ok" : "FAILED");
+    }
+
+    //######################################################
+    //### restore the device directory
+    //######################################################
+    SVC_MEDIA_DEVICE_REGISTRY.RemoveObserver(&tObserver);
+    if (!tWasActive)
+        SVC_MEDIA_DEVICE_REGISTRY.StopHotplugDetection();
+    SVC_MEDIA_DEVICE_REGISTRY.SetDeviceDirectory(tPreviousDirectory);
+
+    // files before their directories
+    list<string>::iterator tIt;
+    for (tIt = tCreated.begin(); tIt != tCreated.end(); tIt++)
+        remove(tIt->c_str());
+    rmdir(tDirectory.c_str());
+
+    return tResult;
+#else
+    LOGEX(Benchmark, LOG_ERROR, "Hotplug detection is only supported on Linux");
+    return false;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Benchmark::Loopback()
+{
+    bool tWasEnabled = SVC_MEDIA_LOOPBACK.IsEnabled();
+    bool tResult = true;
+    int64_t tSocketLostPackets = 0;
+
+    MediaSource::FfmpegInit();
+
+    // find a free port, each receiver gets its own socket at this port because a stopped listener closes its socket
+    Socket *tReceiveSocket = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, BENCHMARK_LOOPBACK_PORT, true, 2);
+    if (tReceiveSocket == NULL)
+    {
+        LOGEX(Benchmark, LOG_ERROR, "Couldn't create the receiving socket");
+        return false;
+    }
+    unsigned int tReceivePort = tReceiveSocket->GetLocalPort();
+    delete tReceiveSocket;
+
+    printf("Packets of a %s stream (%d * %d, %d kbit/s) from a network sink to a receiver in the same process via port %u for %d s, through the UDP stack and via the media loopback\n", BENCHMARK_LOOPBACK_CODEC, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_LOOPBACK_BIT_RATE / 1000, tReceivePort, BENCHMARK_LOOPBACK_DURATION);
+    printf("%-12s %10s %10s %12s %14s %8s\n", "path", "sent", "received", "lost (RTP)", "via loopback", "result");
+
+    for (int m = 0; m < 2; m++)
+    {
+        bool tLoopback = (m == 1);
+
+        SVC_MEDIA_LOOPBACK.SetEnabled(tLoopback);
+
+        //######################################################
+        //### the receiver is running before the first packet is sent
+        //######################################################
+        tReceiveSocket = Socket::CreateServerSocket(SOCKET_IPv4, SOCKET_UDP, tReceivePort, true);
+        Socket *tSendSocket = Socket::CreateClientSocket(SOCKET_IPv4, SOCKET_UDP);
+        if ((tReceiveSocket == NULL) || (tSendSocket == NULL))
+        {
+            LOGEX(Benchmark, LOG_ERROR, "Couldn't create the sockets");
+            delete tReceiveSocket;
+            delete tSendSocket;
+            tResult = false;
+            break;
+        }
+        MediaSourceNet *tSource = new MediaSourceNet(tReceiveSocket);
+        tSource->SetInputStreamPreferences(BENCHMARK_LOOPBACK_CODEC, true);
+        bool tOpened = tSource->OpenVideoGrabDevice(BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_VIDEO_FPS);
+        BenchmarkGrabber tReceiver(tSource, BENCHMARK_VIDEO_WIDTH * BENCHMARK_VIDEO_HEIGHT * 4);
+        if (tOpened)
+            tReceiver.StartThread();
+
+        BenchmarkVideoSource *tCamera = new BenchmarkVideoSource();
+        MediaSourceMuxer *tMuxer = new MediaSourceMuxer(tCamera);
+        tMuxer->SetOutputStreamPreferences(BENCHMARK_LOOPBACK_CODEC, 10, BENCHMARK_LOOPBACK_BIT_RATE, BENCHMARK_RTP_PACKET_SIZE, false, BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT);
+        MediaSinkNet *tSink = tMuxer->RegisterMediaSink("127.0.0.1", tReceivePort, tSendSocket, true);
+        int tResX = 0, tResY = 0;
+        if (tSink != NULL)
+        {
+            tMuxer->OpenVideoGrabDevice(BENCHMARK_VIDEO_WIDTH, BENCHMARK_VIDEO_HEIGHT, BENCHMARK_VIDEO_FPS);
+            tMuxer->GetMuxingResolution(tResX, tResY);
+        }
+        if ((!tOpened) || (tResX == 0) || (tResY == 0))
+            LOGEX(Benchmark, LOG_ERROR, "Couldn't open the %s %s", BENCHMARK_LOOPBACK_CODEC, tOpened ? "encoder" : "decoder");
+
+        //######################################################
+        //### stream and count the packets of both sides
+        //######################################################
+        int64_t tDeliveredPackets = SVC_MEDIA_LOOPBACK.GetDeliveredPackets();
+        int64_t tSentPackets = 0, tReceivedPackets = 0, tLostPackets = 0;
+        if ((tOpened) && (tResX != 0) && (tResY != 0))
+        {
+            BenchmarkGrabber tSender(tMuxer, BENCHMARK_VIDEO_WIDTH * BENCHMARK_VIDEO_HEIGHT * 4);
+            tSender.StartThread();
+            Thread::Suspend(BENCHMARK_LOOPBACK_DURATION * 1000 * 1000);
+            tSender.StopGrabber();
+
+            // the receiver gets some time for the last packets
+            Thread::Suspend(BENCHMARK_LOOPBACK_DRAIN_TIME * 1000);
+
+            tSentPackets = tSink->GetPacketCount();
+            tReceivedPackets = tSource->GetPacketCount();
+            tLostPackets = tSource->GetLostPacketsFromRTP();
+        }
+        tDeliveredPackets = SVC_MEDIA_LOOPBACK.GetDeliveredPackets() - tDeliveredPackets;
+
+        if (tOpened)
+            tReceiver.StopGrabber();
+        tMuxer->CloseGrabDevice();
+        if (tSink != NULL)
+            tMuxer->UnregisterMediaSink(tSink);
+        delete tMuxer;
+        delete tCamera;
+        delete tSource;
+        // HINT: neither the source nor the network sink deletes a socket which was given to it
+        delete tReceiveSocket;
+        delete tSendSocket;
+
+        //######################################################
+        //### the loopback delivers every packet, the RTP loss detection works like with the socket path
+        //######################################################
+        bool tOk = (tSentPackets > 0) && (tReceivedPackets > 0);
+        if (tLoopback)
+        {
+            if ((tDeliveredPackets != tSentPackets) || (tReceivedPackets != tSentPackets) || (tLostPackets > tSocketLostPackets))
+                tOk = false;
+        }else
+        {
+            tSocketLostPackets = tLostPackets;
+            // UDP via loopback may lose hardly any packets at this load, nothing is delivered past the sockets
+            if ((tDeliveredPackets != 0) || (tSentPackets - tReceivedPackets > tSentPackets / 100))
+                tOk = false;
+        }
+        if (!tOk)
+            tResult = false;
+        printf("%-12s %10"PRId64" %10"PRId64" %12"PRId64" %14"PRId64" %8s\n", tLoopback ? "loopback" : "socket", tSentPackets, tReceivedPackets, tLostPackets, tDeliveredPackets, tOk ? "ok" : "FAILED");
+    }
+
+    SVC_MEDIA_LOOPBACK.SetEnabled(tWasEnabled);
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
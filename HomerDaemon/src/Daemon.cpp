@@ -0,0 +1,612 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of the headless daemon
+ * Since:   2014-02-10
+ */
+
+#include <Daemon.h>
+#include <MediaEncoderCalibration.h>
+#include <PacketStatisticService.h>
+#include <ProcessStatisticService.h>
+#include <HBSystem.h>
+#include <HBTime.h>
+#include <Logger.h>
+#include <LogSinkFile.h>
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+
+#if defined(LINUX) || defined(APPLE) || defined(BSD)
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#endif
+
+namespace Homer { namespace Daemon {
+
+using namespace std;
+using namespace Homer::Base;
+using namespace Homer::Monitor;
+using namespace Homer::Multimedia;
+using namespace Homer::Conference;
+
+///////////////////////////////////////////////////////////////////////////////
+
+Daemon::Daemon()
+{
+    mConferenceVideo = NULL;
+    mConferenceAudio = NULL;
+    mConferenceEnabled = false;
+    mAcceptCalls = false;
+    mStatisticPeriod = DAEMON_DEFAULT_STATISTIC_PERIOD;
+    mShutdownRequested = false;
+}
+
+Daemon::~Daemon()
+{
+    LOG(LOG_VERBOSE, "Destroyed");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool Daemon::Init(string pConfigurationFile)
+{
+    LOG(LOG_VERBOSE, "Initialization of daemon with configuration %s..", pConfigurationFile.c_str());
+
+    if (!mConfiguration.Load(pConfigurationFile))
+        return false;
+
+    InitLogging();
+
+    SVC_PROCESS_STATISTIC.AssignThreadName("Daemon-MainLoop");
+
+    if (!InitConference())
+        return false;
+
+    InitEncoderCalibration();
+    InitStreams();
+
+    return true;
+}
+
+void Daemon::InitLogging()
+{
+    string tLevel = mConfiguration.GetString(DAEMON_SECTION_GENERAL, "LogLevel");
+    list<string> tFiles = mConfiguration.GetStrings(DAEMON_SECTION_GENERAL, "LogFile");
+    list<string>::iterator tIt;
+
+    if ((tLevel == "Error") || (tLevel == "error"))
+        LOGGER.SetLogLevel(LOG_ERROR);
+    else if ((tLevel == "Warn") || (tLevel == "warn"))
+        LOGGER.SetLogLevel(LOG_WARN);
+    else if ((tLevel == "Info") || (tLevel == "info"))
+        LOGGER.SetLogLevel(LOG_INFO);
+    else if ((tLevel == "Verbose") || (tLevel == "verbose"))
+        LOGGER.SetLogLevel(LOG_VERBOSE);
+    else if ((tLevel == "World") || (tLevel == "world"))
+        LOGGER.SetLogLevel(LOG_WORLD);
+    else if (tLevel != "")
+        LOG(LOG_WARN, "Unsupported log level \"%s\"", tLevel.c_str());
+
+    // file based log sinks
+    for (tIt = tFiles.begin(); tIt != tFiles.end(); tIt++)
+        LOGGER.RegisterLogSink(new LogSinkFile(*tIt));
+
+    mStatisticPeriod = mConfiguration.GetInt(DAEMON_SECTION_GENERAL, "StatisticPeriod", DAEMON_DEFAULT_STATISTIC_PERIOD);
+}
+
+void Daemon::InitEncoderCalibration()
+{
+    EncoderCalibrationFormats tFormats;
+    StreamDescriptors tStreams = mConfiguration.GetStreams();
+    StreamDescriptors::iterator tIt;
+
+    string tFile = mConfiguration.GetString(DAEMON_SECTION_GENERAL, "EncoderCalibrationFile");
+    if (tFile != "")
+        SVC_MEDIA_ENCODER_CALIBRATION.SetTableFile(tFile);
+
+    if (!mConfiguration.GetBool(DAEMON_SECTION_GENERAL, "EncoderCalibration", true))
+    {
+        LOG(LOG_INFO, "Encoder calibration is deactivated");
+        return;
+    }
+
+    // the formats of the configured video streams
+    for (tIt = tStreams.begin(); tIt != tStreams.end(); tIt++)
+    {
+        if (tIt->Type != MEDIA_VIDEO)
+            continue;
+
+        EncoderCalibrationFormat tFormat;
+        tFormat.ResX = tIt->ResX;
+        tFormat.ResY = tIt->ResY;
+        tFormat.Fps = (tIt->Fps > 0) ? tIt->Fps : 30;
+
+        bool tKnownFormat = false;
+        for (EncoderCalibrationFormats::iterator tFormatIt = tFormats.begin(); tFormatIt != tFormats.end(); tFormatIt++)
+        {
+            if ((tFormatIt->ResX == tFormat.ResX) && (tFormatIt->ResY == tFormat.ResY) && (tFormatIt->Fps == tFormat.Fps))
+                tKnownFormat = true;
+        }
+        if (!tKnownFormat)
+            tFormats.push_back(tFormat);
+    }
+
+    // only missing formats are measured, this happens before any stream occupies the CPU
+    if (tFormats.size() > 0)
+        SVC_MEDIA_ENCODER_CALIBRATION.Calibrate(tFormats);
+}
+
+bool Daemon::GetNetworkInfo(AddressesList &pLocalAddressesList, AddressesList &pLocalAddressesNetmaskList, string &pLocalGatewayIp, string &pLocalLoopIp)
+{
+    pLocalGatewayIp = "";
+    pLocalLoopIp = "";
+
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        struct ifaddrs *tInterfaces = NULL;
+        struct ifaddrs *tInterface;
+        char tAddress[NI_MAXHOST];
+        char tNetmask[NI_MAXHOST];
+
+        if (getifaddrs(&tInterfaces) != 0)
+        {
+            LOG(LOG_ERROR, "Cannot determine the local network interfaces because \"%s\"", strerror(errno));
+            return false;
+        }
+
+        LOG(LOG_INFO, "Locally usable IPv4/6 addresses are:");
+        for (tInterface = tInterfaces; tInterface != NULL; tInterface = tInterface->ifa_next)
+        {
+            if ((tInterface->ifa_addr == NULL) || ((tInterface->ifa_addr->sa_family != AF_INET) && (tInterface->ifa_addr->sa_family != AF_INET6)))
+                continue;
+            if ((!(tInterface->ifa_flags & IFF_UP)) || (!(tInterface->ifa_flags & IFF_RUNNING)))
+                continue;
+
+            socklen_t tAddressSize = (tInterface->ifa_addr->sa_family == AF_INET) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6);
+            if (getnameinfo(tInterface->ifa_addr, tAddressSize, tAddress, sizeof(tAddress), NULL, 0, NI_NUMERICHOST) != 0)
+                continue;
+            tNetmask[0] = 0;
+            if (tInterface->ifa_netmask != NULL)
+                getnameinfo(tInterface->ifa_netmask, tAddressSize, tNetmask, sizeof(tNetmask), NULL, 0, NI_NUMERICHOST);
+
+            // strip the scope of IPv6 addresses
+            string tHost = tAddress;
+            if (tHost.find('%') != string::npos)
+                tHost = tHost.substr(0, tHost.find('%'));
+
+            if (tInterface->ifa_flags & IFF_LOOPBACK)
+            {
+                LOG(LOG_INFO, "Found working loopback network interface: \"%s\" with %s", tInterface->ifa_name, tHost.c_str());
+                if ((pLocalLoopIp == "") && (tInterface->ifa_addr->sa_family == AF_INET))
+                    pLocalLoopIp = tHost;
+                continue;
+            }
+
+            if ((tInterface->ifa_addr->sa_family == AF_INET6) && (Socket::IsIPv6LinkLocal(tHost)))
+                continue;
+
+            LOG(LOG_INFO, "...%s (%s)", tHost.c_str(), tInterface->ifa_name);
+            if (tInterface->ifa_addr->sa_family == AF_INET)
+            {
+                pLocalAddressesList.push_front(tHost);
+                pLocalAddressesNetmaskList.push_front(tNetmask);
+                if (pLocalGatewayIp == "")
+                    pLocalGatewayIp = tHost;
+            }else
+            {
+                pLocalAddressesList.push_back(tHost);
+                pLocalAddressesNetmaskList.push_back(tNetmask);
+            }
+        }
+
+        freeifaddrs(tInterfaces);
+    #else
+        LOG(LOG_WARN, "Interface enumeration isn't supported on this platform, define \"ListenerAddress\" in the configuration");
+    #endif
+
+    return (pLocalGatewayIp != "");
+}
+
+bool Daemon::InitConference()
+{
+    AddressesList tLocalAddresses, tLocalAddressesNetmask;
+    string tLocalSourceIp, tLocalLoopIp;
+
+    mConferenceEnabled = mConfiguration.GetBool(DAEMON_SECTION_CONFERENCE, "Enabled", false);
+    mAcceptCalls = mConfiguration.GetBool(DAEMON_SECTION_CONFERENCE, "AcceptCalls", true);
+    if (!mConferenceEnabled)
+    {
+        LOG(LOG_INFO, "Conference management is deactivated");
+        return true;
+    }
+
+    LOG(LOG_VERBOSE, "Initialization of conference management..");
+    bool tInterfaceFound = GetNetworkInfo(tLocalAddresses, tLocalAddressesNetmask, tLocalSourceIp, tLocalLoopIp);
+
+    // an explicitly configured address overrides the probed one
+    string tListenerAddress = mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "ListenerAddress");
+    if (tListenerAddress != "")
+    {
+        tLocalSourceIp = tListenerAddress;
+        tInterfaceFound = true;
+        if (find(tLocalAddresses.begin(), tLocalAddresses.end(), tListenerAddress) == tLocalAddresses.end())
+        {
+            tLocalAddresses.push_front(tListenerAddress);
+            tLocalAddressesNetmask.push_front("");
+        }
+    }
+
+    if (!tInterfaceFound)
+    {
+        if (tLocalLoopIp != "")
+        {
+            LOG(LOG_INFO, "No fitting network interface towards outside found");
+            LOG(LOG_INFO, "Using loopback interface with IP address: %s", tLocalLoopIp.c_str());
+            tLocalSourceIp = tLocalLoopIp;
+            tLocalAddresses.push_front(tLocalLoopIp);
+            tLocalAddressesNetmask.push_front("255.0.0.0");
+        }else
+        {
+            LOG(LOG_ERROR, "No fitting network interface present");
+            return false;
+        }
+    }
+
+    int tSipStartPort = mConfiguration.GetInt(DAEMON_SECTION_CONFERENCE, "SipStartPort", 5060);
+    enum TransportType tSipTransport = Socket::String2TransportType(mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "SipTransport", "UDP"));
+    if (tSipTransport == SOCKET_TRANSPORT_TYPE_INVALID)
+    {
+        LOG(LOG_WARN, "Unsupported SIP transport, falling back to UDP");
+        tSipTransport = SOCKET_UDP;
+    }
+    bool tNatSupport = mConfiguration.GetBool(DAEMON_SECTION_CONFERENCE, "NatSupport", false);
+
+    LOG(LOG_INFO, "Using conference management IP address: %s", tLocalSourceIp.c_str());
+    MEETING.SetUserAgentSignatureSuffix(DAEMON_USER_AGENT_SUFFIX);
+    MEETING.Init(tLocalSourceIp, tLocalAddresses, tLocalAddressesNetmask, tSipStartPort, tSipTransport, tNatSupport, tSipStartPort + 10, mConfiguration.GetInt(DAEMON_SECTION_CONFERENCE, "VideoAudioStartPort", 5000), "BROADCAST");
+    MEETING.SetLocalUserName(mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "UserName", "Homer daemon"));
+    MEETING.SetLocalUserMailAdr(mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "UserMail"));
+    MEETING.AddObserver(this);
+
+    if (tNatSupport)
+    {
+        string tStunServer = mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "StunServer");
+        if (tStunServer != "")
+            MEETING.SetStunServer(tStunServer);
+    }
+
+    // centralized mode
+    string tSipServer = mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "SipServer");
+    if (tSipServer != "")
+        MEETING.RegisterAtServer(mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "SipUserName"), mConfiguration.GetString(DAEMON_SECTION_CONFERENCE, "SipPassword"), tSipServer, mConfiguration.GetInt(DAEMON_SECTION_CONFERENCE, "SipServerPort", 5060));
+
+    return true;
+}
+
+void Daemon::InitStreams()
+{
+    StreamDescriptors tStreams = mConfiguration.GetStreams();
+    StreamDescriptors::iterator tIt;
+
+    LOG(LOG_VERBOSE, "Initialization of %d stream relays..", (int)tStreams.size());
+
+    for (tIt = tStreams.begin(); tIt != tStreams.end(); tIt++)
+    {
+        StreamRelay *tRelay = new StreamRelay(*tIt);
+        if (!tRelay->Start())
+        {
+            LOG(LOG_ERROR, "Cannot start stream %s, ignoring it", tIt->Name.c_str());
+            delete tRelay;
+            continue;
+        }
+        mStreamRelays.push_back(tRelay);
+
+        // the first video and audio stream which are marked for conferencing are sent to the participants
+        if (tRelay->IsConferenceFeed())
+        {
+            if ((tRelay->GetMediaType() == MEDIA_VIDEO) && (mConferenceVideo == NULL))
+                mConferenceVideo = tRelay;
+            else if ((tRelay->GetMediaType() == MEDIA_AUDIO) && (mConferenceAudio == NULL))
+                mConferenceAudio = tRelay;
+            else
+                LOG(LOG_WARN, "Stream %s is ignored for conferencing because another %s stream is already used", tIt->Name.c_str(), (tRelay->GetMediaType() == MEDIA_VIDEO) ? "video" : "audio");
+        }
+    }
+
+    if ((mConferenceEnabled) && (mAcceptCalls) && (mConferenceVideo == NULL) && (mConferenceAudio == NULL))
+        LOG(LOG_WARN, "Calls are accepted but no stream is marked for conferencing");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Daemon::Run()
+{
+    int64_t tLastStatistic = Time::GetTimeStamp();
+
+    LOG(LOG_INFO, "Daemon is running with %d streams", (int)mStreamRelays.size());
+    LOG(LOG_INFO, "Usable resources: %d of %d CPU cores, %"PRId64" of %"PRId64" MB memory", System::GetEffectiveCores(), System::GetMachineCores(), System::GetEffectiveMemoryPhysical() / 1024 / 1024, System::GetMachineMemoryPhysical() / 1024 / 1024);
+
+    while (!mShutdownRequested)
+    {
+        GeneralEvent *tEvent = NULL;
+
+        mMeetingEventsMutex.lock();
+        if (mMeetingEvents.size() == 0)
+            mMeetingEventsCondition.Wait(&mMeetingEventsMutex, DAEMON_EVENT_WAIT_TIME);
+        if (mMeetingEvents.size() > 0)
+        {
+            tEvent = mMeetingEvents.front();
+            mMeetingEvents.pop_front();
+        }
+        mMeetingEventsMutex.unlock();
+
+        if (tEvent != NULL)
+        {
+            if (!mShutdownRequested)
+                ProcessMeetingEvent(tEvent);
+            delete tEvent;
+        }
+
+        if ((mStatisticPeriod > 0) && (Time::GetTimeStamp() - tLastStatistic >= (int64_t)mStatisticPeriod * 1000 * 1000))
+        {
+            LogStatistic();
+            tLastStatistic = Time::GetTimeStamp();
+        }
+    }
+
+    LOG(LOG_INFO, "Shutdown requested");
+}
+
+void Daemon::RequestShutdown()
+{
+    // only set the flag: neither mutexes nor conditions may be used within a signal handler
+    mShutdownRequested = true;
+}
+
+void Daemon::Deinit()
+{
+    StreamRelays::iterator tIt;
+    DaemonMeetingEvents::iterator tEventIt;
+
+    LOG(LOG_VERBOSE, "Deinitialization of daemon..");
+
+    // prevent the system from further incoming events
+    if (mConferenceEnabled)
+    {
+        LOG(LOG_VERBOSE, "..stopping conference manager");
+        MEETING.DeleteObserver(this);
+        MEETING.Stop();
+    }
+
+    LOG(LOG_VERBOSE, "..releasing participants");
+    while (mParticipants.size() > 0)
+        RemoveParticipant(mParticipants.front().Name, mParticipants.front().Transport);
+
+    LOG(LOG_VERBOSE, "..stopping stream relays");
+    for (tIt = mStreamRelays.begin(); tIt != mStreamRelays.end(); tIt++)
+        (*tIt)->Stop();
+    LOG(LOG_VERBOSE, "..destroying stream relays");
+    for (tIt = mStreamRelays.begin(); tIt != mStreamRelays.end(); tIt++)
+        delete (*tIt);
+    mStreamRelays.clear();
+    mConferenceVideo = NULL;
+    mConferenceAudio = NULL;
+
+    if (mConferenceEnabled)
+    {
+        LOG(LOG_VERBOSE, "..destroying conference manager");
+        MEETING.Deinit();
+    }
+
+    mMeetingEventsMutex.lock();
+    for (tEventIt = mMeetingEvents.begin(); tEventIt != mMeetingEvents.end(); tEventIt++)
+        delete (*tEventIt);
+    mMeetingEvents.clear();
+    mMeetingEventsMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Daemon::handleMeetingEvent(GeneralEvent *pEvent)
+{
+    // called from the SIP thread: the event is processed in the main loop
+    mMeetingEventsMutex.lock();
+    mMeetingEvents.push_back(pEvent);
+    mMeetingEventsCondition.Signal();
+    mMeetingEventsMutex.unlock();
+}
+
+void Daemon::ProcessMeetingEvent(GeneralEvent *pEvent)
+{
+    LOG(LOG_VERBOSE, "Processing event %s from %s", GeneralEvent::getNameFromType(pEvent->getType()).c_str(), pEvent->Sender.c_str());
+
+    switch(pEvent->getType())
+    {
+        case CALL:
+            {
+                CallEvent *tCEvent = (CallEvent*)pEvent;
+                if (!tCEvent->IsIncomingEvent)
+                    break;
+                if (!mAcceptCalls)
+                {
+                    LOG(LOG_INFO, "Denying call from %s", tCEvent->Sender.c_str());
+                    AddParticipant(tCEvent->Sender, tCEvent->Transport);
+                    MEETING.SendCallDeny(tCEvent->Sender, tCEvent->Transport);
+                    RemoveParticipant(tCEvent->Sender, tCEvent->Transport);
+                    break;
+                }
+                LOG(LOG_INFO, "Accepting call from %s (%s)", tCEvent->Sender.c_str(), tCEvent->SenderApplication.c_str());
+                AddParticipant(tCEvent->Sender, tCEvent->Transport);
+                if (!tCEvent->AutoAnswering)
+                {
+                    MEETING.SendCallAcknowledge(tCEvent->Sender, tCEvent->Transport);
+                    MEETING.SendCallAccept(tCEvent->Sender, tCEvent->Transport);
+                }
+            }
+            break;
+        case CALL_MEDIA_UPDATE:
+            UpdateParticipantMedia((CallMediaUpdateEvent*)pEvent);
+            break;
+        case CALL_CANCEL:
+        case CALL_HANGUP:
+        case CALL_TERMINATION:
+            LOG(LOG_INFO, "Call with %s ended", pEvent->Sender.c_str());
+            RemoveParticipant(pEvent->Sender, pEvent->Transport);
+            break;
+        case MESSAGE:
+            LOG(LOG_INFO, "Message from %s: %s", pEvent->Sender.c_str(), ((MessageEvent*)pEvent)->Text.c_str());
+            break;
+        case REGISTRATION:
+            LOG(LOG_INFO, "Registered at SIP server");
+            break;
+        case REGISTRATION_FAILED:
+            LOG(LOG_ERROR, "Registration at SIP server failed because \"%s\"(%d)", ((RegistrationFailedEvent*)pEvent)->Description.c_str(), ((RegistrationFailedEvent*)pEvent)->StatusCode);
+            break;
+        case GENERAL_ERROR:
+            LOG(LOG_ERROR, "Error from %s: \"%s\"(%d)", pEvent->Sender.c_str(), ((ErrorEvent*)pEvent)->Description.c_str(), ((ErrorEvent*)pEvent)->StatusCode);
+            break;
+        default:
+            break;
+    }
+}
+
+DaemonParticipant* Daemon::GetParticipant(string pParticipant, enum TransportType pTransport)
+{
+    DaemonParticipants::iterator tIt;
+
+    for (tIt = mParticipants.begin(); tIt != mParticipants.end(); tIt++)
+    {
+        if ((tIt->Name == pParticipant) && (tIt->Transport == pTransport))
+            return &(*tIt);
+    }
+
+    return NULL;
+}
+
+void Daemon::AddParticipant(string pParticipant, enum TransportType pTransport)
+{
+    string tUser, tHost, tPort;
+
+    if (GetParticipant(pParticipant, pTransport) != NULL)
+        return;
+
+    MEETING.SplitParticipantName(pParticipant, tUser, tHost, tPort);
+    if (!MEETING.OpenParticipantSession(tUser, tHost, tPort, pTransport))
+        LOG(LOG_WARN, "Participant session for %s was already open", pParticipant.c_str());
+
+    DaemonParticipant tParticipant;
+    tParticipant.Name = pParticipant;
+    tParticipant.Transport = pTransport;
+    tParticipant.VideoSink = NULL;
+    tParticipant.AudioSink = NULL;
+    mParticipants.push_back(tParticipant);
+}
+
+void Daemon::UpdateParticipantMedia(CallMediaUpdateEvent *pEvent)
+{
+    DaemonParticipant *tParticipant = GetParticipant(pEvent->Sender, pEvent->Transport);
+
+    if (tParticipant == NULL)
+    {
+        LOG(LOG_WARN, "Got media update for unknown participant %s", pEvent->Sender.c_str());
+        return;
+    }
+
+    LOG(LOG_VERBOSE, "Video sink of %s set to %s:%u with codec %s", pEvent->Sender.c_str(), pEvent->RemoteVideoAddress.c_str(), pEvent->RemoteVideoPort, pEvent->RemoteVideoCodec.c_str());
+    LOG(LOG_VERBOSE, "Audio sink of %s set to %s:%u with codec %s", pEvent->Sender.c_str(), pEvent->RemoteAudioAddress.c_str(), pEvent->RemoteAudioPort, pEvent->RemoteAudioCodec.c_str());
+
+    // replace former sinks
+    if ((mConferenceVideo != NULL) && (tParticipant->VideoSink != NULL))
+        mConferenceVideo->RemoveParticipant(tParticipant->VideoSink);
+    tParticipant->VideoSink = NULL;
+    if ((mConferenceAudio != NULL) && (tParticipant->AudioSink != NULL))
+        mConferenceAudio->RemoveParticipant(tParticipant->AudioSink);
+    tParticipant->AudioSink = NULL;
+
+    if ((mConferenceVideo != NULL) && (pEvent->RemoteVideoPort != 0))
+        tParticipant->VideoSink = mConferenceVideo->AddParticipant(pEvent->Sender, pEvent->RemoteVideoAddress, pEvent->RemoteVideoPort, MEETING.GetVideoSendSocket(pEvent->Sender, pEvent->Transport), pEvent->NegotiatedRTPVideoPayloadID);
+    if ((mConferenceAudio != NULL) && (pEvent->RemoteAudioPort != 0))
+        tParticipant->AudioSink = mConferenceAudio->AddParticipant(pEvent->Sender, pEvent->RemoteAudioAddress, pEvent->RemoteAudioPort, MEETING.GetAudioSendSocket(pEvent->Sender, pEvent->Transport), pEvent->NegotiatedRTPAudioPayloadID, pEvent->NegotiatedAudioPacketizationTime, pEvent->NegotiatedAudioMaxPacketizationTime);
+}
+
+void Daemon::RemoveParticipant(string pParticipant, enum TransportType pTransport)
+{
+    DaemonParticipants::iterator tIt;
+
+    for (tIt = mParticipants.begin(); tIt != mParticipants.end(); tIt++)
+    {
+        if ((tIt->Name == pParticipant) && (tIt->Transport == pTransport))
+        {
+            if ((mConferenceVideo != NULL) && (tIt->VideoSink != NULL))
+                mConferenceVideo->RemoveParticipant(tIt->VideoSink);
+            if ((mConferenceAudio != NULL) && (tIt->AudioSink != NULL))
+                mConferenceAudio->RemoveParticipant(tIt->AudioSink);
+            MEETING.CloseParticipantSession(pParticipant, pTransport);
+            mParticipants.erase(tIt);
+            break;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Daemon::LogStatistic()
+{
+    StreamRelays::iterator tRelayIt;
+    ProcessStatistics tThreads = SVC_PROCESS_STATISTIC.GetProcessStatistics();
+    ProcessStatistics::iterator tThreadIt;
+    PacketStatistics tStreams;
+    PacketStatistics::iterator tStreamIt;
+
+    LOG(LOG_INFO, "====== Statistic ======");
+
+    // process
+    for (tThreadIt = tThreads.begin(); tThreadIt != tThreads.end(); tThreadIt++)
+    {
+        ThreadStatisticDescriptor tStat = (*tThreadIt)->GetThreadStatistic();
+        if (tThreadIt == tThreads.begin())
+            LOG(LOG_INFO, "Process: %d threads, %lu KB virtual memory, %lu KB physical memory", tStat.ThreadCount, tStat.MemVirtual / 1024, tStat.MemPhysical / 1024);
+        LOG(LOG_VERBOSE, "Thread %s(%d): load %.2f%%", (*tThreadIt)->GetThreadName().c_str(), tStat.Tid, tStat.LoadTotal);
+    }
+
+    // network streams
+    tStreams = SVC_PACKET_STATISTIC.GetPacketStatisticsAccess();
+    for (tStreamIt = tStreams.begin(); tStreamIt != tStreams.end(); tStreamIt++)
+    {
+        PacketStatisticDescriptor tStat = (*tStreamIt)->GetPacketStatistic();
+        LOG(LOG_INFO, "%s stream %s(%s/%s): %d packets, %"PRId64" bytes, %d bytes/s, %"PRIu64" lost", tStat.Outgoing ? "Outgoing" : "Incoming", (*tStreamIt)->GetStreamName().c_str(), (*tStreamIt)->GetDataTypeStr().c_str(), (*tStreamIt)->GetTransportTypeStr().c_str(), tStat.PacketCount, tStat.ByteCount, tStat.AvgDataRate, tStat.LostPacketCount);
+    }
+    SVC_PACKET_STATISTIC.ReleasePacketStatisticsAccess();
+
+    // relays
+    for (tRelayIt = mStreamRelays.begin(); tRelayIt != mStreamRelays.end(); tRelayIt++)
+        (*tRelayIt)->LogStatistic();
+
+    LOG(LOG_INFO, "Participants: %d", (int)mParticipants.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -0,0 +1,262 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of the daemon settings
+ * Since:   2014-02-10
+ */
+
+#include <DaemonConfiguration.h>
+#include <Logger.h>
+
+#include <fstream>
+#include <stdlib.h>
+#include <ctype.h>
+
+namespace Homer { namespace Daemon {
+
+using namespace std;
+using namespace Homer::Base;
+using namespace Homer::Multimedia;
+
+///////////////////////////////////////////////////////////////////////////////
+
+DaemonConfiguration::DaemonConfiguration()
+{
+    mFileName = "";
+}
+
+DaemonConfiguration::~DaemonConfiguration()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+string DaemonConfiguration::Trim(string pString)
+{
+    size_t tStart = pString.find_first_not_of(" \t\r\n");
+    if (tStart == string::npos)
+        return "";
+    size_t tEnd = pString.find_last_not_of(" \t\r\n");
+
+    return pString.substr(tStart, tEnd - tStart + 1);
+}
+
+string DaemonConfiguration::ToLower(string pString)
+{
+    for (size_t i = 0; i < pString.size(); i++)
+        pString[i] = (char)tolower(pString[i]);
+
+    return pString;
+}
+
+bool DaemonConfiguration::Load(string pFileName)
+{
+    ifstream tFile(pFileName.c_str());
+    string tLine;
+    string tSection = "";
+    int tLineNumber = 0;
+
+    if (!tFile.is_open())
+    {
+        LOG(LOG_ERROR, "Cannot open configuration file \"%s\"", pFileName.c_str());
+        return false;
+    }
+
+    mEntries.clear();
+    mFileName = pFileName;
+
+    while (getline(tFile, tLine))
+    {
+        tLineNumber++;
+        tLine = Trim(tLine);
+
+        // skip empty lines and comments
+        if ((tLine.size() == 0) || (tLine[0] == '#') || (tLine[0] == ';'))
+            continue;
+
+        // new section
+        if (tLine[0] == '[')
+        {
+            if (tLine[tLine.size() - 1] != ']')
+            {
+                LOG(LOG_ERROR, "Invalid section header in line %d of %s: %s", tLineNumber, pFileName.c_str(), tLine.c_str());
+                return false;
+            }
+            tSection = Trim(tLine.substr(1, tLine.size() - 2));
+            LOG(LOG_VERBOSE, "Found section \"%s\"", tSection.c_str());
+            continue;
+        }
+
+        // key/value pair
+        size_t tSeparator = tLine.find('=');
+        if ((tSeparator == string::npos) || (tSeparator == 0))
+        {
+            LOG(LOG_ERROR, "Invalid entry in line %d of %s: %s", tLineNumber, pFileName.c_str(), tLine.c_str());
+            return false;
+        }
+
+        ConfigurationEntry tEntry;
+        tEntry.Section = tSection;
+        tEntry.Key = ToLower(Trim(tLine.substr(0, tSeparator)));
+        tEntry.Value = Trim(tLine.substr(tSeparator + 1));
+        mEntries.push_back(tEntry);
+    }
+
+    LOG(LOG_INFO, "Loaded %d entries from configuration file %s", (int)mEntries.size(), pFileName.c_str());
+
+    return true;
+}
+
+string DaemonConfiguration::GetFileName()
+{
+    return mFileName;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+list<string> DaemonConfiguration::GetSections(string pPrefix)
+{
+    list<string> tResult;
+    ConfigurationEntries::iterator tIt;
+
+    for (tIt = mEntries.begin(); tIt != mEntries.end(); tIt++)
+    {
+        if ((tResult.size() > 0) && (tResult.back() == tIt->Section))
+            continue;
+        if (ToLower(tIt->Section.substr(0, pPrefix.size())) != ToLower(pPrefix))
+            continue;
+        tResult.push_back(tIt->Section);
+    }
+
+    return tResult;
+}
+
+string DaemonConfiguration::GetString(string pSection, string pKey, string pDefault)
+{
+    string tResult = pDefault;
+    ConfigurationEntries::iterator tIt;
+
+    pKey = ToLower(pKey);
+    for (tIt = mEntries.begin(); tIt != mEntries.end(); tIt++)
+    {
+        // the last definition wins
+        if ((tIt->Section == pSection) && (tIt->Key == pKey))
+            tResult = tIt->Value;
+    }
+
+    return tResult;
+}
+
+list<string> DaemonConfiguration::GetStrings(string pSection, string pKey)
+{
+    list<string> tResult;
+    ConfigurationEntries::iterator tIt;
+
+    pKey = ToLower(pKey);
+    for (tIt = mEntries.begin(); tIt != mEntries.end(); tIt++)
+    {
+        if ((tIt->Section == pSection) && (tIt->Key == pKey) && (tIt->Value != ""))
+            tResult.push_back(tIt->Value);
+    }
+
+    return tResult;
+}
+
+int DaemonConfiguration::GetInt(string pSection, string pKey, int pDefault)
+{
+    string tValue = GetString(pSection, pKey);
+
+    if (tValue == "")
+        return pDefault;
+
+    return atoi(tValue.c_str());
+}
+
+bool DaemonConfiguration::GetBool(string pSection, string pKey, bool pDefault)
+{
+    string tValue = ToLower(GetString(pSection, pKey));
+
+    if (tValue == "")
+        return pDefault;
+
+    return ((tValue == "true") || (tValue == "yes") || (tValue == "on") || (tValue == "1"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+StreamDescriptors DaemonConfiguration::GetStreams()
+{
+    StreamDescriptors tResult;
+    list<string> tSections = GetSections(DAEMON_SECTION_STREAM);
+    list<string>::iterator tIt;
+
+    for (tIt = tSections.begin(); tIt != tSections.end(); tIt++)
+    {
+        StreamDescriptor tStream;
+        string tType = ToLower(GetString(*tIt, "Type", "video"));
+
+        tStream.Name = Trim(tIt->substr(string(DAEMON_SECTION_STREAM).size()));
+        if (tStream.Name == "")
+            tStream.Name = *tIt;
+        if (tType == "video")
+            tStream.Type = MEDIA_VIDEO;
+        else if (tType == "audio")
+            tStream.Type = MEDIA_AUDIO;
+        else
+        {
+            LOG(LOG_ERROR, "Stream \"%s\" has unsupported type \"%s\", ignoring it", tStream.Name.c_str(), tType.c_str());
+            continue;
+        }
+        tStream.Input = GetString(*tIt, "Input");
+        if (tStream.Input == "")
+        {
+            LOG(LOG_ERROR, "Stream \"%s\" has no input, ignoring it", tStream.Name.c_str());
+            continue;
+        }
+        tStream.InputCodec = GetString(*tIt, "InputCodec", (tStream.Type == MEDIA_VIDEO) ? "H.264" : "MP3");
+        tStream.InputRtp = GetBool(*tIt, "InputRtp", true);
+        tStream.Loop = GetBool(*tIt, "Loop", false);
+        tStream.Codec = GetString(*tIt, "Codec", (tStream.Type == MEDIA_VIDEO) ? "H.264" : "MP3");
+        tStream.Quality = GetInt(*tIt, "Quality", (tStream.Type == MEDIA_VIDEO) ? 20 : 100);
+        tStream.BitRate = GetInt(*tIt, "BitRate", (tStream.Type == MEDIA_VIDEO) ? 500000 : 128000);
+        tStream.MaxPacketSize = GetInt(*tIt, "MaxPacketSize", 1280);
+        tStream.ResX = GetInt(*tIt, "ResX", 352);
+        tStream.ResY = GetInt(*tIt, "ResY", 288);
+        tStream.Fps = GetInt(*tIt, "Fps", 0);
+        tStream.SampleRate = GetInt(*tIt, "SampleRate", 44100);
+        tStream.Channels = GetInt(*tIt, "Channels", 2);
+        tStream.Rtp = GetBool(*tIt, "Rtp", true);
+        tStream.Outputs = GetStrings(*tIt, "Output");
+        tStream.Conference = GetBool(*tIt, "Conference", false);
+
+        if ((tStream.Outputs.size() == 0) && (!tStream.Conference))
+            LOG(LOG_WARN, "Stream \"%s\" has neither outputs nor is it sent to conference participants", tStream.Name.c_str());
+
+        tResult.push_back(tStream);
+    }
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -0,0 +1,430 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a stream relay
+ * Since:   2014-02-10
+ */
+
+#include <StreamRelay.h>
+#include <MediaSourceFile.h>
+#include <MediaSourceNet.h>
+#include <MediaSourceShm.h>
+#include <MediaSinkShm.h>
+#include <ProcessStatisticService.h>
+#include <RequirementTransmitBitErrors.h>
+#include <RequirementTransmitChunks.h>
+#include <RequirementTransmitStream.h>
+#include <RequirementTargetPort.h>
+#include <Requirements.h>
+#include <RTP.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <stdlib.h>
+
+namespace Homer { namespace Daemon {
+
+using namespace std;
+using namespace Homer::Base;
+using namespace Homer::Monitor;
+using namespace Homer::Multimedia;
+
+///////////////////////////////////////////////////////////////////////////////
+
+StreamRelay::StreamRelay(StreamDescriptor pDescriptor)
+{
+    mDescriptor = pDescriptor;
+    mInput = NULL;
+    mMuxer = NULL;
+    mChunkBuffer = NULL;
+    mChunkBufferSize = 0;
+    mInputOpened = false;
+    mRelayNeeded = false;
+    mGrabbedChunks = 0;
+    mLostChunks = 0;
+    mInputRestarts = 0;
+    mLastChunkNumber = -1;
+}
+
+StreamRelay::~StreamRelay()
+{
+    LOG(LOG_VERBOSE, "Going to destroy stream relay %s", mDescriptor.Name.c_str());
+
+    Stop();
+
+    if (mMuxer != NULL)
+    {
+        if (mInputOpened)
+            mMuxer->CloseGrabDevice();
+        if (mChunkBuffer != NULL)
+            mMuxer->FreeChunkBuffer(mChunkBuffer);
+
+        // deletes all registered sinks
+        delete mMuxer;
+    }
+    if (mInput != NULL)
+        delete mInput;
+
+    LOG(LOG_VERBOSE, "Destroyed");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+string StreamRelay::GetName()
+{
+    return mDescriptor.Name;
+}
+
+enum MediaType StreamRelay::GetMediaType()
+{
+    return mDescriptor.Type;
+}
+
+bool StreamRelay::IsConferenceFeed()
+{
+    return mDescriptor.Conference;
+}
+
+MediaSourceMuxer* StreamRelay::GetMuxer()
+{
+    return mMuxer;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaSource* StreamRelay::CreateInput()
+{
+    MediaSource *tResult = NULL;
+    string tInput = mDescriptor.Input;
+
+    if ((tInput.size() > 6) && (tInput.substr(0, 6) == "FILE: "))
+    {
+        tResult = new MediaSourceFile(tInput.substr(6));
+    }else if ((tInput.size() > 5) && (tInput.substr(0, 5) == "NET: "))
+    {
+        // "<port>/<transport>"
+        string tPortStr = tInput.substr(5);
+        enum TransportType tTransport = SOCKET_UDP;
+        size_t tPos = tPortStr.find('/');
+        if (tPos != string::npos)
+        {
+            tTransport = Socket::String2TransportType(tPortStr.substr(tPos + 1));
+            tPortStr = tPortStr.substr(0, tPos);
+        }
+        int tPort = atoi(tPortStr.c_str());
+        if ((tPort <= 0) || (tPort > 65535) || (tTransport == SOCKET_TRANSPORT_TYPE_INVALID))
+        {
+            LOG(LOG_ERROR, "Invalid network input \"%s\" for stream %s", tInput.c_str(), mDescriptor.Name.c_str());
+            return NULL;
+        }
+        tResult = new MediaSourceNet(tPort, tTransport);
+        tResult->SetInputStreamPreferences(mDescriptor.InputCodec, mDescriptor.InputRtp);
+    }else if ((tInput.size() > 5) && (tInput.substr(0, 5) == "SHM: "))
+    {
+        // the producer describes the stream within the ring header
+        tResult = new MediaSourceShm(tInput.substr(5));
+    }else
+        LOG(LOG_ERROR, "Unsupported input \"%s\" for stream %s", tInput.c_str(), mDescriptor.Name.c_str());
+
+    return tResult;
+}
+
+bool StreamRelay::OpenInput()
+{
+    if (mChunkBuffer != NULL)
+    {
+        mMuxer->FreeChunkBuffer(mChunkBuffer);
+        mChunkBuffer = NULL;
+    }
+
+    if (mDescriptor.Type == MEDIA_VIDEO)
+        mInputOpened = mMuxer->OpenVideoGrabDevice(mDescriptor.ResX, mDescriptor.ResY, (mDescriptor.Fps > 0) ? (float)mDescriptor.Fps : 29.97);
+    else
+        mInputOpened = mMuxer->OpenAudioGrabDevice(mDescriptor.SampleRate, mDescriptor.Channels);
+
+    if (!mInputOpened)
+    {
+        LOG(LOG_WARN, "Cannot open input %s of stream %s", mDescriptor.Input.c_str(), mDescriptor.Name.c_str());
+        return false;
+    }
+
+    mChunkBuffer = mMuxer->AllocChunkBuffer(mChunkBufferSize, mDescriptor.Type);
+    if (mChunkBuffer == NULL)
+    {
+        LOG(LOG_ERROR, "Cannot allocate chunk buffer for stream %s", mDescriptor.Name.c_str());
+        mMuxer->CloseGrabDevice();
+        mInputOpened = false;
+        return false;
+    }
+
+    return true;
+}
+
+MediaSink* StreamRelay::RegisterOutput(string pOutput)
+{
+    MediaSink *tResult = NULL;
+    enum MediaSinkType tSinkType = (mDescriptor.Type == MEDIA_VIDEO) ? MEDIA_SINK_VIDEO : MEDIA_SINK_AUDIO;
+
+    if ((pOutput.size() > 6) && (pOutput.substr(0, 6) == "FILE: "))
+    {
+        tResult = mMuxer->RegisterMediaSink(pOutput.substr(6), false);
+    }else if ((pOutput.size() > 5) && (pOutput.substr(0, 5) == "NET: "))
+    {
+        // "<host>:<port>/<transport>", the host might be an IPv6 address
+        string tTarget = pOutput.substr(5);
+        enum TransportType tTransport = SOCKET_UDP;
+        size_t tPos = tTarget.find('/');
+        if (tPos != string::npos)
+        {
+            tTransport = Socket::String2TransportType(tTarget.substr(tPos + 1));
+            tTarget = tTarget.substr(0, tPos);
+        }
+        tPos = tTarget.rfind(':');
+        if (tPos == string::npos)
+        {
+            LOG(LOG_ERROR, "Network output \"%s\" of stream %s lacks a port", pOutput.c_str(), mDescriptor.Name.c_str());
+            return NULL;
+        }
+        string tHost = tTarget.substr(0, tPos);
+        int tPort = atoi(tTarget.substr(tPos + 1).c_str());
+        if ((tHost.size() > 1) && (tHost[0] == '[') && (tHost[tHost.size() - 1] == ']'))
+            tHost = tHost.substr(1, tHost.size() - 2);
+        if ((tHost == "") || (tPort <= 0) || (tPort > 65535))
+        {
+            LOG(LOG_ERROR, "Invalid network output \"%s\" for stream %s", pOutput.c_str(), mDescriptor.Name.c_str());
+            return NULL;
+        }
+
+        Requirements *tRequs = new Requirements();
+        switch(tTransport)
+        {
+            case SOCKET_UDP_LITE:
+                tRequs->add(new RequirementTransmitBitErrors(UDP_LITE_HEADER_SIZE + RTP_HEADER_SIZE));
+            case SOCKET_UDP:
+                tRequs->add(new RequirementTransmitChunks());
+                break;
+            case SOCKET_TCP:
+                tRequs->add(new RequirementTransmitStream());
+                break;
+            default:
+                LOG(LOG_WARN, "Unsupported transport protocol for output \"%s\", falling back to UDP", pOutput.c_str());
+                tRequs->add(new RequirementTransmitChunks());
+                break;
+        }
+        tRequs->add(new RequirementTargetPort(tPort));
+        tResult = mMuxer->RegisterMediaSink(tHost, tRequs, mDescriptor.Rtp);
+    }else if ((pOutput.size() > 5) && (pOutput.substr(0, 5) == "SHM: "))
+    {
+        tResult = mMuxer->RegisterMediaSink(new MediaSinkShm(pOutput.substr(5), tSinkType, mDescriptor.Rtp));
+    }else
+        LOG(LOG_ERROR, "Unsupported output \"%s\" for stream %s", pOutput.c_str(), mDescriptor.Name.c_str());
+
+    return tResult;
+}
+
+void StreamRelay::RegisterOutputs()
+{
+    list<string>::iterator tIt;
+
+    for (tIt = mDescriptor.Outputs.begin(); tIt != mDescriptor.Outputs.end(); tIt++)
+    {
+        MediaSink *tSink = RegisterOutput(*tIt);
+        if (tSink != NULL)
+        {
+            LOG(LOG_INFO, "Stream %s is relayed to %s", mDescriptor.Name.c_str(), tIt->c_str());
+            tSink->AssignStreamName("DAEMON-OUT: " + mDescriptor.Name);
+            tSink->SetActivation(true);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool StreamRelay::Start()
+{
+    LOG(LOG_VERBOSE, "Starting stream relay %s for %s input %s", mDescriptor.Name.c_str(), (mDescriptor.Type == MEDIA_VIDEO) ? "video" : "audio", mDescriptor.Input.c_str());
+
+    if (mMuxer != NULL)
+    {
+        LOG(LOG_WARN, "Stream relay %s was already started", mDescriptor.Name.c_str());
+        return true;
+    }
+
+    mInput = CreateInput();
+    if (mInput == NULL)
+        return false;
+
+    mMuxer = new MediaSourceMuxer(mInput);
+    if (mDescriptor.Type == MEDIA_VIDEO)
+        mMuxer->SetOutputStreamPreferences(mDescriptor.Codec, mDescriptor.Quality, mDescriptor.BitRate, mDescriptor.MaxPacketSize, false, mDescriptor.ResX, mDescriptor.ResY, mDescriptor.Fps);
+    else
+        mMuxer->SetOutputStreamPreferences(mDescriptor.Codec, mDescriptor.Quality, mDescriptor.BitRate, mDescriptor.MaxPacketSize, false, 0, 0);
+    mMuxer->SetRelayActivation(true);
+
+    RegisterOutputs();
+
+    // an input which isn't available yet is reopened by the relay thread
+    OpenInput();
+
+    mRelayNeeded = true;
+    if (!StartThread())
+    {
+        LOG(LOG_ERROR, "Cannot start relay thread for stream %s", mDescriptor.Name.c_str());
+        mRelayNeeded = false;
+        return false;
+    }
+
+    return true;
+}
+
+void StreamRelay::Stop()
+{
+    if (!mRelayNeeded)
+        return;
+
+    LOG(LOG_VERBOSE, "Stopping stream relay %s", mDescriptor.Name.c_str());
+
+    mRelayNeeded = false;
+    if (mMuxer != NULL)
+        mMuxer->StopGrabbing();
+    StopThread(3000);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaSinkNet* StreamRelay::AddParticipant(string pParticipant, string pHost, unsigned int pPort, Socket *pSocket, unsigned int pPayloadId, int pAudioPtime, int pAudioMaxPtime)
+{
+    MediaSinkNet *tResult = NULL;
+
+    if (mMuxer == NULL)
+        return NULL;
+
+    LOG(LOG_VERBOSE, "Relaying stream %s to participant %s at %s:%u", mDescriptor.Name.c_str(), pParticipant.c_str(), pHost.c_str(), pPort);
+
+    // always use RTP/AVP profile (RTP/UDP)
+    tResult = mMuxer->RegisterMediaSink(pHost, pPort, pSocket, true);
+    if (tResult != NULL)
+    {
+        if (pPayloadId > 0)
+            tResult->SetExternallyNegotiatedPayloadID(pPayloadId);
+        tResult->SetAudioPacketizationTime(pAudioPtime, pAudioMaxPtime);
+        tResult->AssignStreamName("CONF-OUT: " + pParticipant);
+        tResult->SetActivation(true);
+    }
+
+    return tResult;
+}
+
+void StreamRelay::RemoveParticipant(MediaSinkNet *pSink)
+{
+    if ((mMuxer == NULL) || (pSink == NULL))
+        return;
+
+    mMuxer->UnregisterMediaSink(pSink);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void StreamRelay::LogStatistic()
+{
+    if (mMuxer == NULL)
+        return;
+
+    LOG(LOG_INFO, "Stream %s: input %s, grabbed chunks %"PRId64", lost chunks %"PRId64", dropped chunks %d, input restarts %"PRId64"", mDescriptor.Name.c_str(), mInputOpened ? "opened" : "unavailable", mGrabbedChunks, mLostChunks, mMuxer->GetChunkDropCounter(), mInputRestarts);
+    if (mDescriptor.Type == MEDIA_VIDEO)
+        LOG(LOG_INFO, "Stream %s: encoded frame size avg. %d bytes, deviation %d bytes, peak %d bytes", mDescriptor.Name.c_str(), mMuxer->GetEncodedFrameSizeAverage(), mMuxer->GetEncodedFrameSizeDeviation(), mMuxer->GetEncodedFrameSizePeak());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void* StreamRelay::Run(void* pArgs)
+{
+    int tChunkSize;
+    int tChunkNumber;
+
+    SVC_PROCESS_STATISTIC.AssignThreadName(((mDescriptor.Type == MEDIA_VIDEO) ? "Video-Relay(" : "Audio-Relay(") + mDescriptor.Name + ")");
+
+    LOG(LOG_VERBOSE, "Relay thread for stream %s started", mDescriptor.Name.c_str());
+
+    while (mRelayNeeded)
+    {
+        if (!mInputOpened)
+        {
+            Suspend(STREAM_RELAY_REOPEN_DELAY);
+            if ((mRelayNeeded) && (OpenInput()))
+            {
+                LOG(LOG_INFO, "Input %s of stream %s is available again", mDescriptor.Input.c_str(), mDescriptor.Name.c_str());
+                mInputRestarts++;
+                mLastChunkNumber = -1;
+            }
+            continue;
+        }
+
+        tChunkSize = mChunkBufferSize;
+        tChunkNumber = mMuxer->GrabChunk(mChunkBuffer, tChunkSize);
+
+        if (tChunkNumber == GRAB_RES_EOF)
+        {
+            if ((mDescriptor.Loop) && (mMuxer->SupportsSeeking()))
+            {
+                LOG(LOG_VERBOSE, "Restarting input %s of stream %s", mDescriptor.Input.c_str(), mDescriptor.Name.c_str());
+                mMuxer->Seek(0, false);
+                mInputRestarts++;
+                mLastChunkNumber = -1;
+            }else if (mRelayNeeded)
+            {
+                LOG(LOG_WARN, "Got EOF from input %s of stream %s", mDescriptor.Input.c_str(), mDescriptor.Name.c_str());
+                mMuxer->CloseGrabDevice();
+                mInputOpened = false;
+            }
+            continue;
+        }
+
+        if ((tChunkNumber < 0) || (tChunkSize <= 0))
+        {
+            #ifdef DAEMON_DEBUG_RELAY
+                LOG(LOG_VERBOSE, "Got invalid chunk %d from stream %s", tChunkNumber, mDescriptor.Name.c_str());
+            #endif
+            // avoid busy waiting while the input is reset
+            Suspend(10 * 1000);
+            continue;
+        }
+
+        #ifdef DAEMON_DEBUG_RELAY
+            LOG(LOG_VERBOSE, "Got chunk %d with %d bytes from stream %s", tChunkNumber, tChunkSize, mDescriptor.Name.c_str());
+        #endif
+
+        // the muxer has already encoded and distributed the chunk, we only account it
+        mGrabbedChunks++;
+        if ((mLastChunkNumber >= 0) && (tChunkNumber > mLastChunkNumber + 1))
+            mLostChunks += tChunkNumber - mLastChunkNumber - 1;
+        mLastChunkNumber = tChunkNumber;
+    }
+
+    LOG(LOG_VERBOSE, "Relay thread for stream %s finished", mDescriptor.Name.c_str());
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
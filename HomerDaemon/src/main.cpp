@@ -0,0 +1,177 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: creating the context of the headless daemon
+ * Since:   2014-02-10
+ */
+
+#include <Benchmark.h>
+#include <Daemon.h>
+#include <MediaEncoderCalibration.h>
+#include <HBSystem.h>
+#include <Logger.h>
+#include <LogSinkFile.h>
+
+#include <string>
+#include <stdio.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Homer::Base;
+using namespace Homer::Daemon;
+using namespace Homer::Multimedia;
+using namespace std;
+
+static Daemon *sDaemon = NULL;
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void HandleShutdownSignal(int pSignal)
+{
+    if (sDaemon != NULL)
+        sDaemon->RequestShutdown();
+}
+
+static void HandleExceptionSignal(int pSignal)
+{
+    list<string> tStackTrace = System::GetStackTrace();
+    list<string>::iterator tIt;
+
+    LOGEX(Daemon, LOG_ERROR, "Signal %d detected, stack trace:", pSignal);
+    for(tIt = tStackTrace.begin(); tIt != tStackTrace.end(); tIt++)
+        LOGEX(Daemon, LOG_ERROR, "   %s", tIt->c_str());
+    exit(1);
+}
+
+static void SetHandlers()
+{
+    signal(SIGINT, HandleShutdownSignal);
+    signal(SIGTERM, HandleShutdownSignal);
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        signal(SIGHUP, HandleShutdownSignal);
+        // a vanished TCP peer must not terminate a relay node
+        signal(SIGPIPE, SIG_IGN);
+    #endif
+    signal(SIGILL, HandleExceptionSignal);
+    signal(SIGFPE, HandleExceptionSignal);
+    signal(SIGSEGV, HandleExceptionSignal);
+    signal(SIGABRT, HandleExceptionSignal);
+}
+
+static void ShowUsage(const char *pProgram)
+{
+    printf("Usage: %s [-Config=<file>] [-DebugLevel=<Error|Warn|Info|Verbose|World>] [-DebugOutputFile=<file>] [-Benchmark=<%s>] [-Calibration=<Show|Run>] [-CalibrationFile=<file>]\n", pProgram, Benchmark::GetNames().c_str());
+    printf("The default configuration file is \"%s\".\n", DAEMON_CONFIGURATION_DEFAULT_FILE);
+    printf("A benchmark is run instead of the daemon and prints its results.\n");
+    printf("The encoder calibration table of this host is printed (Show) or measured again for the default formats (Run) instead of running the daemon.\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int pArgc, char* pArgv[])
+{
+    string tConfigurationFile = DAEMON_CONFIGURATION_DEFAULT_FILE;
+    int tLogLevel = LOG_INFO;
+    string tBenchmark = "";
+    string tCalibration = "";
+    string tCalibrationFile = "";
+    list<string> tLogFiles;
+    list<string>::iterator tIt;
+
+    for (int i = 1; i < pArgc; i++)
+    {
+        string tArgument = pArgv[i];
+
+        if (tArgument.substr(0, 8) == "-Config=")
+            tConfigurationFile = tArgument.substr(8);
+        else if (tArgument == "-DebugLevel=Error")
+            tLogLevel = LOG_ERROR;
+        else if (tArgument == "-DebugLevel=Warn")
+            tLogLevel = LOG_WARN;
+        else if (tArgument == "-DebugLevel=Info")
+            tLogLevel = LOG_INFO;
+        else if (tArgument == "-DebugLevel=Verbose")
+            tLogLevel = LOG_VERBOSE;
+        else if (tArgument == "-DebugLevel=World")
+            tLogLevel = LOG_WORLD;
+        else if (tArgument.substr(0, 17) == "-DebugOutputFile=")
+            tLogFiles.push_back(tArgument.substr(17));
+        else if (tArgument.substr(0, 11) == "-Benchmark=")
+            tBenchmark = tArgument.substr(11);
+        else if ((tArgument == "-Calibration=Show") || (tArgument == "-Calibration=Run"))
+            tCalibration = tArgument.substr(13);
+        else if (tArgument.substr(0, 17) == "-CalibrationFile=")
+            tCalibrationFile = tArgument.substr(17);
+        else
+        {
+            ShowUsage(pArgv[0]);
+            return ((tArgument == "-help") || (tArgument == "--help")) ? 0 : 1;
+        }
+    }
+
+    LOGGER.Init(tLogLevel);
+    for (tIt = tLogFiles.begin(); tIt != tLogFiles.end(); tIt++)
+        LOGGER.RegisterLogSink(new LogSinkFile(*tIt));
+
+    LOGEX(Daemon, LOG_INFO, "Homer Conferencing daemon %s", HOMER_VERSION);
+
+    if (tBenchmark != "")
+    {
+        bool tBenchmarkResult = Benchmark::Run(tBenchmark);
+        LOGGER.Deinit();
+        return tBenchmarkResult ? 0 : 1;
+    }
+
+    if (tCalibration != "")
+    {
+        bool tCalibrationResult = true;
+        if (tCalibrationFile != "")
+            SVC_MEDIA_ENCODER_CALIBRATION.SetTableFile(tCalibrationFile);
+        if (tCalibration == "Run")
+            tCalibrationResult = SVC_MEDIA_ENCODER_CALIBRATION.Calibrate(MediaEncoderCalibration::GetDefaultFormats(), true);
+        printf("%s", SVC_MEDIA_ENCODER_CALIBRATION.GetTableDescription().c_str());
+        LOGGER.Deinit();
+        return tCalibrationResult ? 0 : 1;
+    }
+
+    sDaemon = new Daemon();
+    SetHandlers();
+
+    int tResult = 0;
+    if (sDaemon->Init(tConfigurationFile))
+        sDaemon->Run();
+    else
+    {
+        LOGEX(Daemon, LOG_ERROR, "Initialization failed, exiting");
+        tResult = 1;
+    }
+    sDaemon->Deinit();
+
+    Daemon *tDaemon = sDaemon;
+    sDaemon = NULL;
+    delete tDaemon;
+
+    LOGGER.Deinit();
+
+    return tResult;
+}
@@ -64,6 +64,7 @@ struct PacketStatisticDescriptor{
     int  PacketCount;
     int64_t ByteCount;
     uint64_t LostPacketCount;
+    uint64_t ReceiveQueueDropCount; // packets dropped by the OS because of a full socket receive buffer
     int  AvgPacketSize;
     int  AvgDataRate;
     int  MomentAvgDataRate;
@@ -97,6 +98,7 @@ public:
     int GetMinPacketSize();
     int GetMaxPacketSize();
     uint64_t GetLostPacketCount();
+    uint64_t GetReceiveQueueDropCount();
 
     /* get statistic values */
     PacketStatisticDescriptor GetPacketStatistic();
@@ -119,6 +121,7 @@ public:
     virtual void ResetPacketStatistic();
 
     void SetLostPacketCount(uint64_t pPacketCount);
+    void SetReceiveQueueDropCount(uint64_t pPacketCount);
 
 protected:
     /* update internal states */
@@ -144,6 +147,7 @@ private:
     int64_t       mStartTimeStamp;
     int64_t       mEndTimeStamp;
     uint64_t      mLostPacketCount;
+    uint64_t      mReceiveQueueDropCount;
     Time          mLastTime;
     Statistics mStatistics;
     Mutex         mStatisticsMutex;
@@ -180,6 +180,7 @@ void PacketStatistic::ResetPacketStatistic()
     mMinPacketSize = INT_MAX;
     mMaxPacketSize = 0;
     mLostPacketCount = 0;
+    mReceiveQueueDropCount = 0;
 
     mDataRateHistoryMutex.lock();
     mDataRateHistory.clear();
@@ -198,6 +199,11 @@ void PacketStatistic::SetLostPacketCount(uint64_t pPacketCount)
     mLostPacketCount = pPacketCount;
 }
 
+void PacketStatistic::SetReceiveQueueDropCount(uint64_t pPacketCount)
+{
+    mReceiveQueueDropCount = pPacketCount;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 int PacketStatistic::GetAvgPacketSize()
@@ -296,6 +302,11 @@ uint64_t PacketStatistic::GetLostPacketCount()
     return mLostPacketCount;
 }
 
+uint64_t PacketStatistic::GetReceiveQueueDropCount()
+{
+    return mReceiveQueueDropCount;
+}
+
 void PacketStatistic::AssignStreamName(std::string pName)
 {
 	mName = pName;
@@ -400,6 +411,7 @@ PacketStatisticDescriptor PacketStatistic::GetPacketStatistic()
 	tStat.PacketCount = GetPacketCount();
 	tStat.ByteCount = GetByteCount();
 	tStat.LostPacketCount = GetLostPacketCount();
+	tStat.ReceiveQueueDropCount = GetReceiveQueueDropCount();
 	tStat.AvgPacketSize = GetAvgPacketSize();
 	tStat.AvgDataRate = GetAvgDataRate();
     tStat.MomentAvgDataRate = GetMomentAvgDataRate();
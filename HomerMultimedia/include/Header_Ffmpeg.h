@@ -269,6 +269,13 @@ inline int64_t HM_av_get_default_channel_layout(int nb_channels)
     #define AV_CODEC_ID_HEVC        AV_CODEC_ID_NONE
     #define AV_CODEC_ID_H265        AV_CODEC_ID_HEVC
 #endif
+// VP9 and AV1 are unknown to older libavcodec versions: use distinct IDs which no en-/decoder will match, AV_CODEC_ID_NONE would duplicate case labels
+#if (LIBAVCODEC_VERSION_INT < AV_VERSION_INT(54, 86, 100))
+    #define AV_CODEC_ID_VP9         ((enum AVCodecID)0x7FFF0009)
+#endif
+#if (LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 89, 100))
+    #define AV_CODEC_ID_AV1         ((enum AVCodecID)0x7FFF00A1)
+#endif
 
 inline const char *HM_avcodec_get_name(enum AVCodecID id)
 {
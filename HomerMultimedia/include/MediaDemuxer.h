@@ -0,0 +1,146 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: shared demuxer for the A/V streams of one media file
+ * Since:   2014-02-11
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_DEMUXER_
+#define _MULTIMEDIA_MEDIA_DEMUXER_
+
+#include <Header_Ffmpeg.h>
+#include <MediaSource.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
+
+#include <string>
+#include <list>
+#include <map>
+#include <stdint.h>
+
+using namespace Homer::Base;
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of dispatched packets
+//#define MD_DEBUG_PACKETS
+
+// limits of the packet queue of each subscriber, the reading subscriber waits until a full queue was read
+#define MEDIA_DEMUXER_QUEUE_MAX_PACKETS                 512
+#define MEDIA_DEMUXER_QUEUE_MAX_SIZE                    (32 * 1024 * 1024) // bytes
+// a subscriber which doesn't read from its full queue within this time is stalled, its queue loses whole GOPs instead
+#define MEDIA_DEMUXER_QUEUE_TIMEOUT                     500 // ms
+
+// seek requests of different subscribers towards nearly the same position within this period are executed only once
+#define MEDIA_DEMUXER_SEEK_COALESCING_TIME              (1000 * 1000) // us
+#define MEDIA_DEMUXER_SEEK_COALESCING_DISTANCE          (AV_TIME_BASE / 2) // 0.5 seconds
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef std::list<AVPacket> MediaDemuxerPacketQueue;
+
+struct MediaDemuxerSubscriber
+{
+    int                     StreamIndex; /* -1 as long as no stream is selected */
+    MediaDemuxerPacketQueue Queue;
+    int64_t                 QueueSize; /* in bytes */
+    bool                    Repositioned; /* another subscriber has seeked */
+    bool                    CoalesceSeek; /* the next seek towards the same position can be skipped */
+    bool                    Stalled; /* hasn't read from its full queue for MEDIA_DEMUXER_QUEUE_TIMEOUT */
+    bool                    WaitForKeyFrame; /* packets were dropped, the queue continues with the next key frame */
+    int64_t                 DispatchedPackets;
+    int64_t                 DroppedPackets;
+};
+
+typedef std::map<int /* media type */, MediaDemuxerSubscriber> MediaDemuxerSubscribers;
+
+class MediaDemuxer;
+typedef std::multimap<std::string, MediaDemuxer*> MediaDemuxers;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Opens, probes and reads a media file once for its video and its audio
+ * source. Each subscriber (one per media type) reads the packets of its
+ * stream, packets of the other subscriber's stream are stored in the
+ * bounded queue of that subscriber and packets of all other streams are
+ * discarded by the demuxer itself. A full queue blocks the reading
+ * subscriber until its owner catches up, only a stalled owner loses whole
+ * GOPs and flushes its decoder. Seeking is done at the demuxer level and
+ * the other subscribers are told to flush their decoders.
+ */
+class MediaDemuxer
+{
+public:
+    /* returns a demuxer with a free slot for the media type, NULL if the file can't be opened */
+    static MediaDemuxer* Acquire(std::string pFileName, enum MediaType pMediaType);
+    static void Release(MediaDemuxer *pDemuxer, enum MediaType pMediaType);
+
+    AVFormatContext* GetFormatContext();
+    std::string GetFileName();
+
+    void Subscribe(enum MediaType pMediaType, int pStreamIndex);
+    bool IsShared(); // more than one subscriber has selected a stream
+
+    /* returns the result of av_read_frame() for the subscribed stream */
+    int ReadPacket(enum MediaType pMediaType, AVPacket *pPacket);
+    /* returns the result of avformat_seek_file() */
+    int Seek(enum MediaType pMediaType, int64_t pTimestamp /* in AV_TIME_BASE */, int pFlags = 0);
+    /* returns and resets the marker if another subscriber has seeked in the meantime */
+    bool WasRepositioned(enum MediaType pMediaType);
+
+    /* statistic */
+    int64_t GetReadPackets();
+    int64_t GetReadBytes();
+
+private:
+    MediaDemuxer(std::string pFileName);
+
+    virtual ~MediaDemuxer();
+
+    bool Open();
+    void Close();
+    void FlushQueue(MediaDemuxerSubscriber &pSubscriber);
+    MediaDemuxerSubscriber* FindSubscriber(int pStreamIndex);
+    void DropGroupOfPictures(MediaDemuxerSubscriber &pSubscriber);
+
+    std::string         mFileName;
+    AVFormatContext     *mFormatContext;
+    Mutex               mMutex;
+    Condition           mQueueCondition; // a subscriber has read from its queue
+    Condition           mReaderCondition; // the reading subscriber has queued a packet or has finished
+    bool                mReaderActive; // a subscriber reads from the file
+    MediaDemuxerSubscribers mSubscribers;
+    int64_t             mLastSeekTimestamp;
+    int64_t             mLastSeekTime; // in us
+    /* statistic */
+    int64_t             mReadPackets;
+    int64_t             mReadBytes;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
@@ -0,0 +1,201 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: cached registry of capture devices with hotplug detection
+ * Since:   2014-02-12
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_DEVICE_REGISTRY_
+#define _MULTIMEDIA_MEDIA_DEVICE_REGISTRY_
+
+#include <MediaSource.h>
+#include <HBThread.h>
+#include <HBMutex.h>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <stdint.h>
+
+using namespace Homer::Base;
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of hotplug events
+//#define MDR_DEBUG_HOTPLUG
+
+#define SVC_MEDIA_DEVICE_REGISTRY                       MediaDeviceRegistry::GetInstance()
+
+// directory which contains the device files
+#define MEDIA_DEVICE_REGISTRY_DEFAULT_DIRECTORY         "/dev"
+// sub directory (of the device directory) which contains the sound device files
+#define MEDIA_DEVICE_REGISTRY_SOUND_DIRECTORY           "snd"
+
+// without hotplug detection, the cached device lists are refreshed after this period
+#define MEDIA_DEVICE_REGISTRY_CACHE_TIMEOUT             5 * 1000 * 1000 // us
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct VideoDeviceCapability
+{
+    std::string     PixelFormat; /* fourcc */
+    int             ResX; /* for stepwise or continuous frame sizes: the maximum */
+    int             ResY;
+    bool            Discrete; /* false if any resolution up to ResX * ResY is supported */
+    std::vector<float> Fps; /* empty if unknown */
+};
+
+typedef std::vector<VideoDeviceCapability> VideoDeviceCapabilities;
+
+/* probes the given device file, returns false if it isn't a usable video device */
+typedef bool (*VideoDeviceProbe)(std::string pDeviceFile, VideoDeviceDescriptor &pDevice, VideoDeviceCapabilities &pCapabilities);
+
+struct VideoDeviceFileEntry
+{
+    bool                    Valid; /* false if the device file doesn't belong to a usable video device */
+    bool                    Dirty; /* has to be probed again */
+    VideoDeviceDescriptor   Device;
+    VideoDeviceCapabilities Capabilities;
+};
+
+// device files of one backend, indexed by their file name (without directory)
+typedef std::map<std::string, VideoDeviceFileEntry> VideoDeviceFiles;
+
+struct VideoDeviceFileBackend
+{
+    VideoDeviceProbe        Probe;
+    bool                    Scanned;
+    int64_t                 Timestamp; /* of the last scan in us */
+    VideoDeviceFiles        Files;
+};
+
+// backends with per-device-file probing, indexed by the prefix of their device files (e.g. "video")
+typedef std::map<std::string, VideoDeviceFileBackend> VideoDeviceFileBackends;
+
+template <typename DeviceList>
+struct MediaDeviceListCacheEntry
+{
+    DeviceList      Devices;
+    int64_t         Timestamp; /* in us */
+};
+
+// complete device lists of the backends, indexed by the backend name
+typedef std::map<std::string, MediaDeviceListCacheEntry<VideoDevices> > VideoDeviceListCache;
+typedef std::map<std::string, MediaDeviceListCacheEntry<AudioDevices> > AudioDeviceListCache;
+
+class MediaDeviceObserver
+{
+public:
+    MediaDeviceObserver(){ }
+    virtual ~MediaDeviceObserver(){ }
+
+    /* called from the hotplug thread, must not call back into the registry's notification interface */
+    virtual void MediaDevicesChanged(enum MediaType pMediaType) = 0;
+};
+
+typedef std::list<MediaDeviceObserver*> MediaDeviceObservers;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Capture devices are enumerated only once and their descriptions are cached
+ * afterwards. Backends with one device file per device (V4L2) are probed file
+ * by file and only the added or changed device files are probed again. The
+ * device lists of all other backends are cached as a whole and dropped if
+ * the sound devices change. On Linux, changes are detected via inotify on
+ * the device directory, which can be redirected to a fake directory. Other
+ * systems refresh the cache periodically or if a backend reports a change.
+ */
+class MediaDeviceRegistry:
+    public Thread
+{
+public:
+    /// The default constructor
+    MediaDeviceRegistry();
+
+    /// The destructor.
+    virtual ~MediaDeviceRegistry();
+
+    static MediaDeviceRegistry& GetInstance();
+
+    /* device directory */
+    void SetDeviceDirectory(std::string pDirectory);
+    std::string GetDeviceDirectory();
+
+    /* hotplug detection */
+    bool StartHotplugDetection();
+    void StopHotplugDetection();
+    bool IsHotplugDetectionActive();
+
+    /* backends with one device file per device */
+    void GetVideoDevices(std::string pDeviceFilePrefix, VideoDeviceProbe pProbe, VideoDevices &pVList);
+    bool GetVideoDeviceCapabilities(std::string pCard, VideoDeviceCapabilities &pCapabilities);
+
+    /* complete device lists of other backends, returns false if nothing (valid) is cached */
+    bool GetCachedVideoDevices(std::string pBackend, VideoDevices &pVList);
+    void CacheVideoDevices(std::string pBackend, const VideoDevices &pVList);
+    bool GetCachedAudioDevices(std::string pBackend, AudioDevices &pAList);
+    void CacheAudioDevices(std::string pBackend, const AudioDevices &pAList);
+
+    /* change notification, e.g. by a backend with own device events */
+    void Invalidate(enum MediaType pMediaType);
+    int64_t GetGeneration();
+
+    void AddObserver(MediaDeviceObserver *pObserver);
+    void RemoveObserver(MediaDeviceObserver *pObserver);
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    void RequestHotplugDetection();
+    bool IsCacheValid(int64_t pTimestamp);
+    void ScanDeviceFiles(VideoDeviceFileBackend &pBackend, std::string pDeviceFilePrefix);
+    bool InvalidateDeviceFile(std::string pFileName, bool pRemoved);
+    bool ProbeDirtyDeviceFiles(std::string pDeviceFilePrefix);
+    void NotifyObservers(enum MediaType pMediaType);
+    static bool IsDeviceFile(std::string pFileName, std::string pDeviceFilePrefix);
+
+    std::string         mDeviceDirectory;
+    VideoDeviceFileBackends mVideoDeviceFileBackends;
+    VideoDeviceListCache mVideoDeviceListCache;
+    AudioDeviceListCache mAudioDeviceListCache;
+    int64_t             mGeneration;
+    Mutex               mMutex;
+    MediaDeviceObservers mObservers;
+    Mutex               mObserversMutex;
+    /* hotplug detection */
+    bool                mHotplugDetectionRequested;
+    bool                mHotplugDetectionNeeded;
+    bool                mHotplugDetectionActive;
+    int                 mInotifyFd;
+    int                 mDeviceWatch;
+    int                 mSoundWatch;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
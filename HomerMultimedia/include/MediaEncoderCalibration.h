@@ -0,0 +1,144 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: per-host calibration of the video encoder speed settings
+ * Since:   2014-02-14
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_ENCODER_CALIBRATION_
+#define _MULTIMEDIA_MEDIA_ENCODER_CALIBRATION_
+
+#include <Header_Ffmpeg.h>
+#include <HBMutex.h>
+
+#include <string>
+#include <vector>
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of the single measurements
+//#define MEC_DEBUG_MEASUREMENTS
+
+#define SVC_MEDIA_ENCODER_CALIBRATION                   MediaEncoderCalibration::GetInstance()
+
+// file name of the calibration table within the home directory
+#define MEDIA_ENCODER_CALIBRATION_DEFAULT_FILE          ".homer-encoder-calibration"
+
+// encoded frames per measurement
+#define MEDIA_ENCODER_CALIBRATION_FRAMES                45
+
+// share of the frame period which may be used by the encoder: the rest is needed for grabbing, scaling and sending
+#define MEDIA_ENCODER_CALIBRATION_REALTIME_SHARE        0.8
+// share of the frame period which may be used by the best-affordable setting: the rest is kept for further streams and decoding
+#define MEDIA_ENCODER_CALIBRATION_AFFORDABLE_SHARE      0.5
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct EncoderCalibrationFormat
+{
+    int             ResX;
+    int             ResY;
+    int             Fps;
+};
+
+typedef std::vector<EncoderCalibrationFormat> EncoderCalibrationFormats;
+
+struct EncoderSetting
+{
+    std::string     Option; /* name of the speed option of the encoder, e.g. "preset" */
+    std::string     Value; /* "" if not available */
+    int             Threads;
+    float           FrameTime; /* in ms, 0 if not measured */
+};
+
+struct EncoderCalibrationEntry
+{
+    std::string     Encoder; /* ffmpeg name, e.g. "libx264" */
+    EncoderCalibrationFormat Format;
+    bool            Realtime; /* false if even the fastest setting misses the frame period */
+    EncoderSetting  FastestSufficient; /* cheapest setting which meets real time, the fastest setting otherwise */
+    EncoderSetting  BestAffordable; /* most efficient setting within the affordable share of the frame period */
+};
+
+typedef std::vector<EncoderCalibrationEntry> EncoderCalibrationTable;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Measures the encoding time of each available encoder on synthetic content
+ * for all of its speed settings and thread counts. The resulting table is
+ * stored per host and is used by the muxer to select the speed preset and
+ * the thread count instead of fixed defaults. The measurements are only
+ * meaningful on an otherwise idle host, hence the calibration has to be
+ * started explicitly before any stream is encoded.
+ */
+class MediaEncoderCalibration
+{
+public:
+    MediaEncoderCalibration();
+
+    virtual ~MediaEncoderCalibration();
+
+    static MediaEncoderCalibration& GetInstance();
+
+    /* persistent table of this host */
+    void SetTableFile(std::string pFileName);
+    std::string GetTableFile();
+    bool LoadTable();
+    EncoderCalibrationTable GetTable();
+    std::string GetTableDescription();
+
+    /* measures all available encoders in the given formats, formats which are already calibrated are skipped unless forced */
+    bool Calibrate(EncoderCalibrationFormats pFormats, bool pForce = false);
+    static EncoderCalibrationFormats GetDefaultFormats();
+
+    /* speed setting for the muxer, returns false if the encoder isn't calibrated for the given format */
+    bool GetSetting(std::string pEncoder, int pResX, int pResY, float pFps, EncoderSetting &pSetting, bool &pRealtime);
+    /* largest calibrated resolution which meets real time at the given frame rate, returns false if there is none */
+    bool GetMaxRealtimeResolution(std::string pEncoder, float pFps, int &pResX, int &pResY);
+
+    /* deterministic test content: a moving gradient and a textured square */
+    static void CreateSyntheticPicture(AVFrame *pFrame, int pWidth, int pHeight, int pIndex);
+
+private:
+    bool SaveTable();
+    EncoderCalibrationEntry CalibrateEncoder(int pEncoderIndex, AVCodec *pCodec, EncoderCalibrationFormat pFormat);
+    bool MeasureEncoder(int pEncoderIndex, AVCodec *pCodec, int pValueIndex, int pThreads, EncoderCalibrationFormat pFormat, float &pFrameTime);
+    EncoderCalibrationEntry *FindEntry(std::string pEncoder, EncoderCalibrationFormat pFormat);
+    static int GetEncoderIndex(std::string pEncoder);
+    static std::vector<int> GetThreadCounts();
+    static std::string GetHostDescription();
+    static std::string GetDefaultTableFile();
+
+    std::string         mTableFile;
+    bool                mTableLoaded;
+    EncoderCalibrationTable mTable;
+    Mutex               mMutex;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
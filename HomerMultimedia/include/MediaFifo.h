@@ -72,13 +72,23 @@ public:
     virtual int GetUsage();
     virtual int GetSize();
 
+    /* memory budget */
+    virtual bool Resize(int pFifoSize); // limited to the size given at construction, the newest entries are kept
+    virtual int GetMaxSize();
+    virtual int64_t GetMemoryUsage(); // in bytes
+
 protected:
+    bool DoResize(); // needs a locked FIFO mutex
+
+
     std::string         mName;
     MediaFifoEntry      *mFifo;
     int                 mFifoWritePtr;
     int                 mFifoReadPtr;
     int                 mFifoAvailableEntries;
     int                 mFifoSize;
+    int                 mFifoMaxSize; // allocated entries, only the first mFifoSize ones own a data buffer
+    int                 mFifoDesiredSize; // a resize is delayed as long as an entry is accessed
     int                 mFifoEntrySize;
     Mutex               mFifoMutex;
     Condition           mFifoDataInputCondition;
@@ -48,11 +48,39 @@ public:
     // filter a chunk: either an RGB32 picture or a raw audio chunk
     virtual void FilterChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkbufferNumber, AVStream *pStream, bool pIsKeyFrame) = 0;
 
+    // true if the filter changes the chunk (e.g., an overlay), otherwise it gets a copy of the chunk in the filter worker
+    virtual bool IsModifyingChunks();
+
     std::string GetId();
 
+    /* called by the filter pipeline: detects format changes, filters the chunk and measures the filter time */
+    void ProcessChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkbufferNumber, AVStream *pStream, bool pIsKeyFrame);
+    void CountDroppedChunk();
+
+    /* statistic */
+    int64_t GetFilteredChunks();
+    int64_t GetDroppedChunks();
+    int64_t GetFilterTimeAvg(); // in us
+    int64_t GetFilterTimeMax(); // in us
+
 protected:
+    // called before the first chunk and after each change of the resolution or chunk size, filters allocate their reusable state here instead of per chunk
+    virtual void ChunkFormatChanged(int pResX, int pResY, unsigned int pChunkBufferSize);
+
     std::string         mMediaId;
     MediaSource         *mMediaSource;
+
+private:
+    /* format of the last chunk */
+    bool                mChunkFormatValid;
+    int                 mChunkResX;
+    int                 mChunkResY;
+    unsigned int        mChunkSize;
+    /* statistic */
+    int64_t             mFilteredChunks;
+    int64_t             mDroppedChunks;
+    int64_t             mFilterTimeSum;
+    int64_t             mFilterTimeMax;
 };
 
 typedef std::vector<MediaFilter*>        MediaFilters;
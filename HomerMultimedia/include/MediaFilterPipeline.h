@@ -0,0 +1,143 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: pipeline stage which runs the media filters of a source
+ * Since:   2014-02-15
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_FILTER_PIPELINE_
+#define _MULTIMEDIA_MEDIA_FILTER_PIPELINE_
+
+#include <MediaFilter.h>
+#include <MediaFifo.h>
+#include <HBThread.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
+
+#include <string>
+#include <stdint.h>
+
+using namespace Homer::Base;
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of queued chunks
+//#define MFP_DEBUG_CHUNKS
+
+// amount of chunks which can wait for the filter worker
+#define MEDIA_FILTER_PIPELINE_QUEUE_SIZE                4
+
+// period for checking if the filtering threads left a replaced filter list
+#define MEDIA_FILTER_PIPELINE_GRACE_CHECK_PERIOD        500 // us
+
+// max. time the producer waits for a free queue entry before it filters the chunk itself
+#define MEDIA_FILTER_PIPELINE_QUEUE_TIMEOUT             100 // ms
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct MediaFilterChunk
+{
+    char            *Buffer;
+    unsigned int    BufferSize; /* allocated memory, the buffer is reused for the following chunks */
+    unsigned int    Size;
+    int64_t         Number;
+    AVStream        *Stream;
+    bool            IsKeyFrame;
+    MediaFifo       *DeliveryFifo; /* NULL if only the observing filters are applied */
+    bool            Canceled; /* the chunk is skipped by the worker */
+};
+
+/*
+ * Runs the media filters of one source. Filters which modify the chunk run
+ * before the chunk is delivered: in the producing thread if the producer
+ * owns the chunk buffer, or in the filter worker if the producer hands over
+ * its output FIFO. In the latter case the worker writes the filtered chunk
+ * into the FIFO, so the producer (e.g., a scaler) doesn't wait for the
+ * filters. Filters which only observe the chunks always run in the worker on
+ * a copy, such copies are dropped if the bounded queue is full. The filter
+ * list is replaced as a whole on each (un)registration, hence the filtering
+ * threads never wait for the registration.
+ */
+class MediaFilterPipeline:
+    public Thread
+{
+public:
+    MediaFilterPipeline();
+
+    virtual ~MediaFilterPipeline();
+
+    void SetName(std::string pName);
+    void Stop();
+
+    /* registration */
+    bool RegisterFilter(MediaFilter *pFilter);
+    bool UnregisterFilter(MediaFilter *pFilter, bool pAutoDelete);
+    void DeleteAllFilters();
+    /* hands over all filters to another pipeline, e.g., if a muxer switches its device */
+    void MoveFilters(MediaFilterPipeline &pTarget);
+    int GetFilterCount();
+
+    /* filtering: returns true if the chunk was (or will be) written into pDeliveryFifo */
+    bool FilterChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkNumber, AVStream *pStream, bool pIsKeyFrame, MediaFifo *pDeliveryFifo = NULL);
+    /* drops all queued chunks for the FIFO and waits until the worker doesn't use it anymore */
+    void CancelDelivery(MediaFifo *pDeliveryFifo);
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    /* copy-on-write filter list */
+    MediaFilters* AcquireFilters(volatile int *pReaders);
+    void ReleaseFilters(volatile int *pReaders);
+    void ReplaceFilters(MediaFilters *pFilters); // caller has to lock mRegistrationMutex
+    static void AnalyzeFilters(MediaFilters *pFilters, bool &pModifying, bool &pObserving);
+    static void ApplyFilters(MediaFilters *pFilters, bool pModifying, bool pObserving, char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkNumber, AVStream *pStream, bool pIsKeyFrame);
+
+    /* queue */
+    MediaFilterChunk* GetFreeChunk(unsigned int pSize, bool pWait); // caller has to lock mQueueMutex
+    void QueueChunk(MediaFilterChunk *pChunk, char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkNumber, AVStream *pStream, bool pIsKeyFrame, MediaFifo *pDeliveryFifo); // caller has to lock mQueueMutex
+
+    std::string         mName;
+    /* filter list */
+    MediaFilters * volatile mFilters;
+    Mutex               mRegistrationMutex;
+    volatile int        mProducerReaders;
+    volatile int        mWorkerReaders;
+    /* queue */
+    MediaFilterChunk    mChunks[MEDIA_FILTER_PIPELINE_QUEUE_SIZE];
+    int                 mQueueHead; // next chunk for the worker
+    int                 mQueueSize; // queued chunks
+    int                 mQueuedDeliveries;
+    bool                mWorkerBusy; // the worker processes the chunk at the queue head
+    MediaFifo           *mWorkerDeliveryFifo; // FIFO which is currently used by the worker
+    Mutex               mQueueMutex;
+    Condition           mQueueCondition; // new chunk queued
+    Condition           mChunkFreedCondition; // worker finished a chunk
+    bool                mWorkerNeeded;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: in-process loopback for media packets between local endpoints
+ * Since:   2014-02-16
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_LOOPBACK_
+#define _MULTIMEDIA_MEDIA_LOOPBACK_
+
+#include <HBMutex.h>
+#include <HBSocket.h>
+
+#include <string>
+#include <list>
+#include <map>
+#include <stdint.h>
+
+using namespace Homer::Base;
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of loopback packets
+//#define MLB_DEBUG_PACKETS
+
+#define SVC_MEDIA_LOOPBACK                              MediaLoopback::GetInstance()
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Interface of a network receiver which accepts packets of senders in the
+ * same process, e.g., the network listener of a MediaSourceNet.
+ */
+class MediaLoopbackReceiver
+{
+public:
+    virtual ~MediaLoopbackReceiver(){ }
+
+    /* returns false if the packet has to take the network path, e.g., because the receiving socket is impaired */
+    virtual bool ReceiveLoopbackPacket(char *pData, int pSize) = 0;
+};
+
+/* socket of a receiver: bound address ("" for any address), IP family, local port and transport */
+struct MediaLoopbackEndpoint
+{
+    std::string         Address;
+    enum NetworkType    Network;
+    unsigned int        Port;
+    enum TransportType  Transport;
+
+    bool operator<(const MediaLoopbackEndpoint &pOther) const;
+};
+
+struct MediaLoopbackRegistration
+{
+    MediaLoopbackReceiver   *Receiver;
+    int                     Deliveries; // running deliveries, guarded by the registry lock
+};
+
+typedef std::map<MediaLoopbackEndpoint, MediaLoopbackRegistration*> MediaLoopbackReceivers;
+typedef std::list<std::string> MediaLoopbackAddresses;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Registry of the datagram receivers of this process. A network sink whose
+ * target is one of the local addresses and a registered socket hands over each
+ * packet directly instead of sending it through the kernel. The packets keep
+ * their RTP framing, so both sides account and parse them exactly like
+ * packets from the network. The loopback is disabled by default, the meeting
+ * layer activates it. The registry lock is held only for the lookup, a
+ * delivery runs outside of it. UnregisterReceiver() waits for running
+ * deliveries, hence a receiver isn't used anymore after it returned.
+ */
+class MediaLoopback
+{
+public:
+    /// The default constructor
+    MediaLoopback();
+
+    /// The destructor.
+    virtual ~MediaLoopback();
+
+    static MediaLoopback& GetInstance();
+
+    /* configuration */
+    void SetEnabled(bool pEnabled);
+    bool IsEnabled();
+    void SetLocalAddresses(MediaLoopbackAddresses pAddresses);
+    bool IsLocalHost(std::string pHost);
+
+    /* receivers */
+    void RegisterReceiver(Socket *pSocket, MediaLoopbackReceiver *pReceiver);
+    void UnregisterReceiver(Socket *pSocket, MediaLoopbackReceiver *pReceiver);
+    bool HasReceiver(std::string pHost, unsigned int pPort, enum TransportType pTransport);
+
+    /* returns false if the packet has to be sent via the network */
+    bool Deliver(std::string pHost, unsigned int pPort, enum TransportType pTransport, char *pData, int pSize);
+
+    /* statistic */
+    int64_t GetDeliveredPackets();
+    int64_t GetDeliveredBytes();
+
+private:
+    static MediaLoopbackEndpoint CreateEndpoint(Socket *pSocket);
+    bool IsLocalHostLocked(std::string pHost); // caller has to lock mMutex
+    MediaLoopbackRegistration* FindReceiverLocked(std::string pHost, unsigned int pPort, enum TransportType pTransport); // caller has to lock mMutex
+
+    bool                    mEnabled;
+    MediaLoopbackAddresses  mLocalAddresses;
+    MediaLoopbackReceivers  mReceivers;
+    Mutex                   mMutex;
+    /* statistic */
+    int64_t                 mDeliveredPackets;
+    int64_t                 mDeliveredBytes;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
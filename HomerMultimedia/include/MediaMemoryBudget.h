@@ -0,0 +1,154 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: process-wide memory budget for media FIFOs and frame buffers
+ * Since:   2014-01-21
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_MEMORY_BUDGET_
+#define _MULTIMEDIA_MEDIA_MEMORY_BUDGET_
+
+#include <HBMutex.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+using namespace Homer::Base;
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of the memory budget
+//#define MMB_DEBUG
+
+#define SVC_MEDIA_MEMORY_BUDGET                         MediaMemoryBudget::GetInstance()
+
+// a budget of 0 bytes means "unlimited"
+#define MEDIA_MEMORY_BUDGET_UNLIMITED                   0
+
+// share (in percent) of a cgroup memory limit which may be used for media buffers, even if no budget was set
+#define MEDIA_MEMORY_BUDGET_LIMIT_SHARE                 50
+
+// a FIFO is never shrunk below this amount of entries
+#define MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES            2
+
+///////////////////////////////////////////////////////////////////////////////
+
+class MediaFifo;
+class MediaSource;
+
+struct MediaMemoryStreamStatistic
+{
+    MediaMemoryStreamStatistic():Stream(NULL), Background(false), Fifos(0), FifoMemory(0), FifoMemoryMax(0), Buffers(0), BufferMemory(0){ }
+
+    MediaSource     *Stream; /* NULL for memory which isn't assigned to a stream */
+    std::string     Name;
+    bool            Background;
+    int             Fifos;
+    int64_t         FifoMemory; /* in bytes, currently allocated */
+    int64_t         FifoMemoryMax; /* in bytes, without any budget limitation */
+    int             Buffers;
+    int64_t         BufferMemory; /* in bytes */
+};
+
+typedef std::vector<MediaMemoryStreamStatistic> MediaMemoryStreamStatistics;
+
+struct MediaMemoryFifoDescriptor
+{
+    MediaSource     *Stream;
+    bool            Shrinkable;
+};
+
+struct MediaMemoryBufferDescriptor
+{
+    MediaSource     *Stream;
+    int             Size;
+};
+
+typedef std::map<MediaFifo*, MediaMemoryFifoDescriptor> MediaMemoryFifos;
+typedef std::map<void*, MediaMemoryBufferDescriptor> MediaMemoryBuffers;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Every media FIFO and frame buffer is registered here and assigned to the
+ * media source it belongs to. If a budget is set, the FIFOs of background
+ * streams (e.g. the ones of hidden video widgets) are shrunk first, afterwards
+ * the FIFOs of the foreground streams are shrunk proportionally. Frame buffers
+ * are only accounted because their users rely on their size. Inside a
+ * container with a memory limit, the budget is capped to a share of it.
+ */
+class MediaMemoryBudget
+{
+public:
+    /// The default constructor
+    MediaMemoryBudget();
+
+    /// The destructor.
+    virtual ~MediaMemoryBudget();
+
+    static MediaMemoryBudget& GetInstance();
+
+    /* budget */
+    void SetBudget(int64_t pBytes);
+    int64_t GetBudget();
+    /* the configured budget, capped by the memory limit of the process' cgroup */
+    int64_t GetEffectiveBudget();
+    int64_t GetUsage();
+
+    /* streams */
+    void SetStreamBackground(MediaSource *pStream, bool pBackground);
+    bool IsStreamBackground(MediaSource *pStream);
+    void UnregisterStream(MediaSource *pStream);
+
+    /* FIFOs */
+    void RegisterFifo(MediaFifo *pFifo);
+    void AssignFifo(MediaFifo *pFifo, MediaSource *pStream, bool pShrinkable = true);
+    void UnregisterFifo(MediaFifo *pFifo);
+
+    /* frame buffers */
+    void RegisterBuffer(void *pBuffer, int pSize, MediaSource *pStream);
+    void UnregisterBuffer(void *pBuffer);
+
+    /* accounting */
+    MediaMemoryStreamStatistics GetStreamStatistics();
+    int64_t GetStreamUsage(MediaSource *pStream);
+
+private:
+    void Enforce();
+
+    int64_t             mBudget;
+    bool                mBudgetExceeded;
+    MediaMemoryFifos    mFifos;
+    MediaMemoryBuffers  mBuffers;
+    std::map<MediaSource*, bool> mBackgroundStreams;
+    Mutex               mMutex;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
@@ -0,0 +1,160 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: shared memory ring of fixed slots for exchanging media between processes
+ * Since:   2014-02-08
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_SHM_RING_
+#define _MULTIMEDIA_MEDIA_SHM_RING_
+
+#include <string>
+#include <stdint.h>
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of ring accesses
+//#define MSR_DEBUG_SLOTS
+
+#define MEDIA_SHM_RING_MAGIC                            0x484D5352 // "HMSR"
+#define MEDIA_SHM_RING_VERSION                          1
+
+// prefix of the shared memory objects in the system wide name space
+#define MEDIA_SHM_RING_OBJECT_PREFIX                    "/homer-"
+
+// slots are aligned to cache lines in order to avoid false sharing between producer and consumers
+#define MEDIA_SHM_RING_ALIGNMENT                        64
+
+// slot flags
+#define MEDIA_SHM_SLOT_KEY_FRAME                        0x01
+
+enum MediaShmContent{
+    MEDIA_SHM_CONTENT_UNKNOWN = -1,
+    MEDIA_SHM_CONTENT_RTP_PACKETS = 0, /* one RTP packet per slot */
+    MEDIA_SHM_CONTENT_PACKETS, /* one encoded packet per slot */
+    MEDIA_SHM_CONTENT_FRAMES /* one raw chunk per slot: an RGB32 picture or a chunk of signed 16 bit audio samples */
+};
+
+/*
+ * Layout of the shared memory object: one header followed by "SlotCount" slots.
+ * All fields have a fixed size because the consumer might be built with a different compiler.
+ */
+struct MediaShmRingHeader
+{
+    uint32_t            Magic;
+    uint32_t            Version;
+    uint32_t            SlotCount;
+    uint32_t            SlotSize; /* max. data size per slot */
+    /* stream description, maintained by the producer */
+    int32_t             Content; /* enum MediaShmContent */
+    int32_t             MediaType; /* 0 = video, 1 = audio */
+    int32_t             CodecId; /* enum AVCodecID */
+    int32_t             ResX;
+    int32_t             ResY;
+    int32_t             SampleRate;
+    int32_t             Channels;
+    uint32_t            DescriptionNumber; /* incremented with each change of the stream description */
+    /* producer state */
+    volatile uint32_t   ProducerPid; /* 0 if the producer is gone */
+    volatile uint32_t   WriteSignal; /* futex word, incremented with each written slot */
+    volatile uint32_t   Waiters; /* consumers which are blocked on "WriteSignal" */
+    uint32_t            Reserved;
+    volatile uint64_t   WriteCount; /* amount of written slots since creation */
+};
+
+struct MediaShmRingSlot
+{
+    volatile uint64_t   Sequence; /* number of the contained write + 1, 0 while the slot is written */
+    uint32_t            Size;
+    uint32_t            Flags; /* MEDIA_SHM_SLOT_* */
+    int64_t             Timestamp;
+    /* data follows */
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * One producer writes into the ring without ever waiting for the consumers.
+ * Each consumer keeps its own read position: a consumer which is lapped by the
+ * producer skips the overwritten slots and accounts them as lost. A slot is
+ * read in place and validated afterwards by its sequence number, so a consumer
+ * never sees data which was overwritten during reading.
+ */
+class MediaShmRing
+{
+public:
+    MediaShmRing();
+
+    virtual ~MediaShmRing();
+
+    static std::string GetObjectName(std::string pName);
+
+    /* producer side */
+    bool Create(std::string pName, int pSlotCount, int pSlotSize);
+    void Describe(enum MediaShmContent pContent, int pMediaType, int pCodecId, int pResX = 0, int pResY = 0, int pSampleRate = 0, int pChannels = 0);
+    bool Write(const char *pData, int pSize, int64_t pTimestamp, int pFlags = 0);
+
+    /* consumer side */
+    bool Attach(std::string pName);
+    const char* Acquire(int &pSize, int64_t &pTimestamp, int &pFlags, int pTimeout /* in ms */); // returns NULL if nothing arrived in time
+    bool Release(); // returns false if the acquired slot was overwritten in the meantime
+    int Read(char *pBuffer, int pBufferSize, int64_t &pTimestamp, int &pFlags, int pTimeout /* in ms */); // returns -1 if nothing valid arrived in time
+    void Interrupt(); // lets the current or next Acquire() return without data
+    int64_t GetLostSlotCount();
+    bool IsProducerAlive();
+
+    /* common */
+    void Close();
+    bool IsOpen();
+    std::string GetName();
+    const MediaShmRingHeader* GetHeader();
+    int GetSlotSize();
+    int GetSlotCount();
+    int64_t GetSize(); // in bytes
+
+private:
+    bool Map(int pFileDescriptor, int64_t pSize);
+    MediaShmRingSlot* GetSlot(uint64_t pNumber);
+    void WakeUp();
+    void WaitForWrite(uint32_t pSignal, int pTimeout /* in ms */);
+
+    std::string         mName;
+    bool                mProducer;
+    char                *mMemory;
+    int64_t             mMemorySize;
+    int64_t             mSlotStride;
+    MediaShmRingHeader  *mHeader;
+    /* consumer */
+    uint64_t            mReadCount;
+    uint64_t            mAcquiredSlot;
+    bool                mAcquired;
+    volatile bool       mInterrupted;
+    int64_t             mLostSlots;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
@@ -56,6 +56,12 @@ public:
     virtual void UpdateSynchronization(int64_t pReferenceNtpTimestamp, int64_t pReferenceFrameTimestamp);
     virtual void SetActivation(bool pState);
 
+    /* largest packet which passes the transport path without fragmentation, 0 if unknown */
+    virtual int GetPathMaxPacketSize();
+
+    /* audio: prefer fewer but larger packets, e.g., if many sinks are served */
+    virtual void SetAudioLowOverheadPacketization(bool pActive);
+
     std::string GetId();
 
     /* FPS limitation */
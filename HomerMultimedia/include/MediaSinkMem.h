@@ -55,6 +55,7 @@ public:
 
     virtual void ProcessPacket(AVPacket *pAVPacket, AVStream *pStream = NULL, std::string pStreamName = "");
     virtual void UpdateSynchronization(int64_t pReferenceNtpTimestamp, int64_t pReferenceFrameTimestamp);
+    virtual void SetAudioLowOverheadPacketization(bool pActive);
 
     virtual int GetFragmentBufferCounter();
     virtual int GetFragmentBufferSize();
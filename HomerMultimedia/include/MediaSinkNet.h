@@ -62,6 +62,9 @@ public:
 
     virtual void ProcessPacket(AVPacket *pAVPacket, AVStream *pStream = NULL, std::string pStreamName = "");
 
+    /* path MTU discovery */
+    virtual int GetPathMaxPacketSize();
+
     /* network oriented ID */
     static std::string CreateId(std::string pHost, std::string pPort, enum TransportType pSocketTransportType = SOCKET_TRANSPORT_TYPE_INVALID, bool pRtpActivated = true);
 
@@ -85,6 +88,8 @@ private:
     bool                mSenderNeeded;
     int                 mMaxNetworkPacketSize;
     bool                mBrokenPipe;
+    bool                mLoopbackActive; // the receiver is in this process
+    bool                mLoopbackTarget; // the target is a local address
     bool                mStreamedTransport;
     char                *mStreamFragmentCopyBuffer;
     /* Berkeley sockets based transport */
@@ -0,0 +1,114 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: shared memory based media sink for local consumers in other processes
+ * Since:   2014-02-08
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_SINK_SHM_
+#define _MULTIMEDIA_MEDIA_SINK_SHM_
+
+#include <MediaSinkMem.h>
+#include <MediaFilter.h>
+#include <MediaShmRing.h>
+
+#include <string>
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of sent packets
+//#define MSISHM_DEBUG_PACKETS
+
+// ring geometry for RTP packets
+#define MEDIA_SINK_SHM_RTP_SLOTS                        1024
+#define MEDIA_SINK_SHM_RTP_SLOT_SIZE                    MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE
+// ring geometry for complete encoded packets
+#define MEDIA_SINK_SHM_PACKET_SLOTS                     64
+#define MEDIA_SINK_SHM_PACKET_SLOT_SIZE                 (1024 * 1024)
+// ring geometry for raw frames: HDTV RGB32 pictures
+#define MEDIA_SINK_SHM_FRAME_SLOTS                      4
+#define MEDIA_SINK_SHM_FRAME_SLOT_SIZE                  (1920 * 1080 * 4)
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Writes the encoded packets of a media source into a shared memory ring,
+ * either RTP encapsulated or as they are delivered by the encoder. The
+ * system wide name of the ring is derived from the given name.
+ */
+class MediaSinkShm:
+    public MediaSinkMem
+{
+
+public:
+    MediaSinkShm(std::string pName, enum MediaSinkType pType, bool pRtpActivated);
+
+    virtual ~MediaSinkShm();
+
+    static std::string CreateId(std::string pName);
+
+    virtual void ProcessPacket(AVPacket *pAVPacket, AVStream *pStream = NULL, std::string pStreamName = "");
+
+    /* the ring replaces the FIFO of the memory sink */
+    virtual int GetFragmentBufferCounter();
+    virtual int GetFragmentBufferSize();
+    virtual void ReadFragment(char *pData, int &pDataSize, int64_t &pFragmentNumber);
+    virtual void StopProcessing();
+
+protected:
+    virtual void WriteFragment(char* pData, unsigned int pSize, int64_t pFragmentNumber);
+
+private:
+    MediaShmRing        mRing;
+    int64_t             mCurrentPacketPts;
+    int                 mCurrentPacketFlags;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Media sinks get only encoded packets, hence raw frames are taken from the
+ * media filter chain of a source and written into a shared memory ring.
+ */
+class MediaFilterShm:
+    public MediaFilter
+{
+
+public:
+    MediaFilterShm(MediaSource *pMediaSource, std::string pName);
+
+    virtual ~MediaFilterShm();
+
+    virtual void FilterChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkbufferNumber, AVStream *pStream, bool pIsKeyFrame);
+    virtual bool IsModifyingChunks();
+
+private:
+    MediaShmRing        mRing;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
@@ -33,6 +33,7 @@
 #include <MediaSinkFile.h>
 #include <MediaSink.h>
 #include <MediaFilter.h>
+#include <MediaFilterPipeline.h>
 #include <HBMutex.h>
 
 #include <vector>
@@ -181,11 +182,13 @@ typedef std::vector<MetaDataEntry> MetaData;
                                                             FfmpegCreateIOContext(GetObjectNameStr(this).c_str(), __LINE__, PacketBuffer, PacketBufferSize, ReadFunction, WriteFunction, Opaque, IoContext)
 #define OpenInput(InputName, InputFormat, IoContext)        FfmpegOpenInput(GetObjectNameStr(this).c_str(), __LINE__, InputName, InputFormat, IoContext)
 #define DetectAllStreams()                                  FfmpegDetectAllStreams(GetObjectNameStr(this).c_str(), __LINE__)
+#define DescribeAllStreams()                                FfmpegDescribeAllStreams(GetObjectNameStr(this).c_str(), __LINE__)
 #define SelectStream()                                      FfmpegSelectStream(GetObjectNameStr(this).c_str(), __LINE__)
 #define OpenDecoder()                                       FfmpegOpenDecoder(GetObjectNameStr(this).c_str(), __LINE__)
 #define OpenFormatConverter()                               FfmpegOpenFormatConverter(GetObjectNameStr(this).c_str(), __LINE__)
 #define CloseFormatConverter()                              FfmpegCloseFormatConverter(GetObjectNameStr(this).c_str(), __LINE__)
 #define CloseAll()                                          FfmpegCloseAll(GetObjectNameStr(this).c_str(), __LINE__)
+#define CloseInput()                                        FfmpegCloseInput(GetObjectNameStr(this).c_str(), __LINE__)
 #define EncodeAndWritePacket(FormatContext, CodecContext, InputFrame, BufferedFrames) FfmpegEncodeAndWritePacket(GetObjectNameStr(this).c_str(), __LINE__, FormatContext, CodecContext, InputFrame, BufferedFrames)
 #define DetermineMetaData(MetaDataStorage, DebugLog)        FfmpegDetermineMetaData(GetObjectNameStr(this).c_str(), __LINE__, MetaDataStorage, DebugLog)
 
@@ -195,6 +198,7 @@ typedef std::vector<MetaDataEntry> MetaData;
 typedef int (*IOFunction)(void *pOpaque, uint8_t *pBuffer, int pBufferSize);
 
 class MediaFilter;
+class MediaSynchronizer;
 
 class MediaSource :
     public Homer::Monitor::PacketStatistic
@@ -209,6 +213,10 @@ public:
 
     static bool IsHEVCEncodingSupported();
     static bool IsHEVCDecodingSupported();
+    static bool IsVP9EncodingSupported();
+    static bool IsVP9DecodingSupported();
+    static bool IsAV1EncodingSupported();
+    static bool IsAV1DecodingSupported();
 
     static void LogSupportedVideoCodecs(bool pSendToLoggerOnly = false);
     static void LogSupportedAudioCodecs(bool pSendToLoggerOnly = false);
@@ -256,6 +264,8 @@ public:
     virtual int64_t GetSynchronizationTimestamp(); // in us
     virtual int GetSynchronizationPoints(); // how many synchronization points for deriving synchronization timestamp were included in the input stream till now?
     virtual bool TimeShift(int64_t pOffset); // in us, a value of "0" leads to a re-calibration of RT grabbing
+    virtual void SetSynchronizer(MediaSynchronizer *pSynchronizer); // the presentation of this source follows the master clock of the given synchronizer
+    MediaSynchronizer* GetSynchronizer();
 
     /* transmission quality */
     virtual int64_t GetEndToEndDelay(); // in us
@@ -278,6 +288,7 @@ public:
     virtual void GetVideoSourceResolution(int &pResX, int &pResY);
     virtual void GetVideoDisplayAspectRation(int &pHoriz, int &pVert);
     virtual bool HasVariableOutputFrameRate(); // frame duration can change?
+    virtual bool IsVideoFrameUnchanged(); // is the last grabbed frame equal to its predecessor? (a hint, false if unknown)
     virtual bool IsSeeking();
 
     /* grabbing control */
@@ -297,12 +308,19 @@ public:
     virtual void SetFrameBufferPreBufferingTime(float pTime);
     virtual float GetFrameBufferTime();
     virtual float GetFrameBufferTimeMax();
+    virtual float GetFrameBufferActivePreBufferingTime(); // the pre-buffer time which is currently used, an adaptive source starts below the configured one
+    virtual int GetTimeToFirstFrame(); // in ms, -1 if no frame was grabbed yet
     virtual int GetFrameBufferCounter();
     virtual int GetFrameBufferSize();
     virtual void SetPreBufferingActivation(bool pActive);
     virtual void SetPreBufferingAutoRestartActivation(bool pActive);
     virtual int GetDecoderOutputFrameDelay();
 
+    /* media memory budget: the FIFOs of background streams are the first ones which are shrunk */
+    virtual void SetBackground(bool pBackground);
+    virtual bool IsBackground();
+    virtual int64_t GetMemoryUsage(); // in bytes
+
     /* filtering */
     virtual void RegisterMediaFilter(MediaFilter *pMediaFilter);
     virtual bool UnregisterMediaFilter(MediaFilter *pMediaFilter, bool pAutoDelete = true);
@@ -350,7 +368,7 @@ public:
     virtual std::string GetBroadcasterName();
     virtual std::string GetBroadcasterStreamName();
     virtual std::string GetCurrentDeviceName();
-    virtual bool RegisterMediaSource(MediaSource *pMediaSource);
+    virtual bool RegisterMediaSource(MediaSource *pMediaSource, bool pPreferred = false /* probed first during device selection */);
     virtual bool UnregisterMediaSource(MediaSource *pMediaSource, bool pAutoDelete = true);
 
     /* seek interface */
@@ -406,8 +424,9 @@ protected:
     virtual void DoSetVideoGrabResolution(int pResX = 352, int pResY = 288);
 
     /* filtering */
-    virtual void RelayChunkToMediaFilters(char* pPacketData, unsigned int pPacketSize, int64_t pPacketTimestamp, bool pIsKeyFrame = false);
-    friend class VideoScaler; // for access to "RelayChunkToMediaFilters()"
+    // returns true if the filter pipeline has taken over the delivery of the chunk into pDeliveryFifo
+    virtual bool RelayChunkToMediaFilters(char* pPacketData, unsigned int pPacketSize, int64_t pPacketTimestamp, bool pIsKeyFrame = false, MediaFifo *pDeliveryFifo = NULL);
+    friend class VideoScaler; // for access to "RelayChunkToMediaFilters()" and "mMediaFilterPipeline"
 
     /* internal interface for packet relaying */
     virtual void RelayAVPacketToMediaSinks(AVPacket *pAVPacket);
@@ -444,11 +463,13 @@ protected:
     /* decoder helpers */
     bool FfmpegOpenInput(string pSource /* caller source */, int pLine /* caller line */, const char *pInputName, AVInputFormat *pInputFormat = NULL, AVIOContext *pIOContext = NULL);
     bool FfmpegDetectAllStreams(string pSource /* caller source */, int pLine /* caller line */); //avformat_open_input must be called before, returns true on success
+    bool FfmpegDescribeAllStreams(string pSource /* caller source */, int pLine /* caller line */); //avformat_open_input must be called before, describes the stream based on mSourceCodecId instead of probing, returns true on success
     bool FfmpegSelectStream(string pSource /* caller source */, int pLine /* caller line */); //avformat_open_input & avformat_find_stream_info must be called before, returns true on success
     bool FfmpegOpenDecoder(string pSource /* caller source */, int pLine /* caller line */); //avformat_open_input & avformat_find_stream_info must be called before, returns true on success
     bool FfmpegOpenFormatConverter(string pSource /* caller source */, int pLine /* caller line */);
     bool FfmpegCloseFormatConverter(string pSource /* caller source */, int pLine /* caller line */);
     bool FfmpegCloseAll(string pSource /* caller source */, int pLine /* caller line */);
+    virtual void FfmpegCloseInput(string pSource /* caller source */, int pLine /* caller line */); // closes the format context, which might be shared with other sources
 
     /* encoder helpers */
     bool FfmpegEncodeAndWritePacket(string pSource /* caller source */, int pLine /* caller line */, AVFormatContext *pFormatContext, AVCodecContext *pCodecContext, AVFrame *pInputFrame, int &pBufferedFrames);
@@ -518,6 +539,8 @@ protected:
     bool                mDecoderFramePreBufferingAutoRestart;
     /* A/V synch. */
     int                 mDecoderOutputFrameDelay;
+    MediaSynchronizer   *mSynchronizer;
+    Mutex               mSynchronizerMutex; // the decoder uses the synchronizer while holding this lock
     /* live OSD marking */
     float               mMarkerRelX;
     float               mMarkerRelY;
@@ -526,9 +549,8 @@ protected:
     MediaSinks          mMediaSinks;
     Mutex               mMediaSinksMutex;
     /* filtering */
-    MediaFilters        mMediaFilters;
-    Mutex               mMediaFiltersMutex;
-    friend class MediaSourceMuxer; // for access to "mMediaFilters"
+    MediaFilterPipeline mMediaFilterPipeline;
+    friend class MediaSourceMuxer; // for access to "mMediaFilterPipeline"
 
     /* recording */
     HM_SwrContext       *mRecorderAudioResampleContext;
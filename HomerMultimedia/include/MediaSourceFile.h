@@ -29,6 +29,7 @@
 
 #include <Header_Ffmpeg.h>
 #include <MediaSourceMem.h>
+#include <MediaDemuxer.h>
 #include <MediaFifo.h>
 
 #include <vector>
@@ -86,9 +87,17 @@ protected:
     /* real-time GRABBING */
     virtual void CalibrateRTGrabbing();
 
+    /* input, local files are shared with the other A/V source of the same file */
+    bool OpenInputStreams();
+    bool JoinsSharedInput();
+    int SeekInput(int64_t pTimestamp /* in AV_TIME_BASE */, int pFlags = 0);
+    virtual int ReadInputPacket(AVPacket *pPacket);
+    virtual void FfmpegCloseInput(string pSource, int pLine);
+
 private:
     std::vector<string> mInputChannels;
     float               mLastDecoderFilePosition;
+    MediaDemuxer        *mDemuxer;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
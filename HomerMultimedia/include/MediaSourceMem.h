@@ -62,6 +62,7 @@ namespace Homer { namespace Multimedia {
 //#define MSMEM_DEBUG_TIMING
 //#define MSMEM_DEBUG_DECODER_STATE
 //#define MSMEM_DEBUG_PRE_BUFFERING
+//#define MSMEM_DEBUG_CATCH_UP
 //#define MSMEM_DEBUG_AV_SYNC
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -100,6 +101,12 @@ public:
     virtual int GetFrameBufferCounter(); // returns the currently used number of entries in the frame queue
     virtual int GetFrameBufferSize(); // returns current frame queue size
     virtual void SetFrameBufferPreBufferingTime(float pTime);
+    virtual float GetFrameBufferActivePreBufferingTime();
+    virtual int GetTimeToFirstFrame();
+
+    /* stream opening without probing if the codec is already negotiated */
+    void SetFastOpen(bool pActive);
+    bool UsesFastOpen();
 
     /* device control */
     virtual std::string GetBroadcasterName();
@@ -166,10 +173,20 @@ protected:
     VideoScaler *CreateVideoScaler();
     void CloseVideoScaler(VideoScaler *pScaler);
     void ReadFrameFromInputStream(AVPacket *pPacket, double &pPacketFrameNumber);
+    virtual int ReadInputPacket(AVPacket *pPacket); // returns the result of av_read_frame()
+
+    /* stream detection */
+    bool DetectOrDescribeAllStreams();
 
     /* buffering */
     void UpdateBufferTime();
 
+    /* adaptive pre-buffering */
+    bool UsesAdaptivePreBuffering();
+    void ResetAdaptivePreBuffering();
+    void GrowAdaptivePreBuffering(float pLateness);
+    void CatchUpRTGrabbing();
+
     /* FIFO helpers */
     double CalculateOutputFrameNumber(double pFrameNumber);
     double CalculateInputFrameNumber(double pFrameNumber);
@@ -196,12 +213,23 @@ protected:
     int                 mWrappingHeaderSize;
     int                 mPacketStatAdditionalFragmentSize; // used to adapt packet statistic to additional fragment header, which is used for TCP transmission
     enum AVCodecID      mRtpSourceCodecIdHint;
+    /* fast open */
+    bool                mFastOpen;
+    bool                mStreamDescribed; // the stream was opened without probing
+    bool                mStreamDescriptionMismatch; // the decoder delivered other parameters than described, a reset is needed
+    enum AVCodecID      mStreamDescriptionMismatchCodecId; // this codec is always probed
     /* grabber */
     double              mCurrentOutputFrameIndex; // we have to determine this manually during grabbing because cur_dts and everything else in AVStream is buggy for some video/audio files
     double              mLastBufferedOutputFrameIndex; // we use this for calibrating RT grabbing
     bool                mGrabberProvidesRTGrabbing;
     int64_t             mLastTimeWaitForRTGrabbing;
     int64_t             mTimeLastWrittenOutputChunk;
+    /* adaptive pre-buffering */
+    float               mAdaptivePreBufferTime; // starts small and grows with each underrun up to mDecoderFramePreBufferTime
+    int                 mAdaptivePreBufferUnderruns;
+    bool                mAdaptivePreBufferCatchUp;
+    int64_t             mTimeGrabbingStarted; // in us
+    int                 mTimeToFirstFrame; // in ms
     /* decoder thread */
     bool                mDecoderThreadAcountsPackets; //do we use custom I/O context? -> packet account is done there and should be done within decoder thread
     double              mFirstReceivedFrameTimestampFromRTP; //if multiple frames are delivered from the packet reciever towards the A/V frame decoder
@@ -222,6 +250,7 @@ protected:
     bool                mDecoderRecalibrateRTGrabbingAfterSeeking;
     bool                mDecoderWaitForNextKeyFrame; // after seeking we wait for next i -frames
     int64_t             mDecoderWaitForNextKeyFrameTimeout;
+    bool                mDecoderSkipNonReferenceFrames; // set during catch-up, the video decoder skips frames which aren't referenced by others
     /* picture grabbing */
     bool                mDecoderSinglePictureGrabbed;
     int                 mDecoderSinglePictureResX;
@@ -55,6 +55,40 @@ namespace Homer { namespace Multimedia {
 // amount of entries within the input FIFO
 #define MEDIA_SOURCE_MUX_INPUT_QUEUE_SIZE_LIMIT                  32
 
+// idle frame suppression: how many unchanged video frames are encoded at full rate before the keep-alive rate is used?
+#define MEDIA_SOURCE_MUX_IDLE_FRAMES_BEFORE_SUPPRESSION           8
+// default keep-alive rate for unchanged video content
+#define MEDIA_SOURCE_MUX_IDLE_FRAMES_KEEP_ALIVE_FPS               1.0
+
+// real-time rate control: default size of the VBV buffer in ms, limits the size of each encoded frame
+#define MEDIA_SOURCE_MUX_DEFAULT_VBV_BUFFER_TIME                  250
+// real-time rate control: period of key frames or intra refresh cycles in s
+#define MEDIA_SOURCE_MUX_REALTIME_KEY_FRAME_PERIOD                2
+
+// path MTU: period in s for checking the packet size limits of the registered media sinks
+#define MEDIA_SOURCE_MUX_PATH_MTU_CHECK_PERIOD                    1
+
+// audio packetization: period in s for checking the amount of registered media sinks
+#define MEDIA_SOURCE_MUX_AUDIO_PACKETIZATION_CHECK_PERIOD         1
+// audio packetization: amount of media sinks from which on the low-overhead mode is used
+#define MEDIA_SOURCE_MUX_AUDIO_LOW_OVERHEAD_SINKS                 4
+
+///////////////////////////////////////////////////////////////////////////////
+
+class VideoScaler;
+class VideoEncoderPreparer;
+
+struct VideoEncoderDescriptor
+{
+    AVFormatContext     *FormatContext;
+    AVStream            *MediaStream;
+    AVCodecContext      *CodecContext;
+    enum AVCodecID      CodecId;
+    int                 ResX;
+    int                 ResY;
+    float               Fps;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class MediaSourceMuxer:
@@ -92,6 +126,7 @@ public:
     virtual int64_t GetSynchronizationTimestamp();
     virtual int GetSynchronizationPoints(); // how many synchronization points for deriving synchronization timestamp were included in the input stream till now?
     virtual bool TimeShift(int64_t pOffset); // in us
+    virtual void SetSynchronizer(MediaSynchronizer *pSynchronizer);
 
     /* relaying */
     virtual bool SupportsRelaying();
@@ -101,6 +136,22 @@ public:
     void SetRelaySkipSilenceThreshold(int pValue);
     int GetRelaySkipSilenceThreshold();
     int GetRelaySkipSilenceSkippedChunks();
+    void SetRelaySkipIdleFrames(bool pState);
+    void SetRelaySkipIdleFramesKeepAliveFps(float pFps); // 0 means no frames are encoded until the content changes
+    float GetRelaySkipIdleFramesKeepAliveFps();
+    int64_t GetRelaySkipIdleFramesSkippedFrames();
+    bool IsRelayIdle(); // is the video content currently unchanged?
+
+    /* real-time rate control */
+    bool SetRealtimeRateControl(bool pState, int pVbvBufferTime = MEDIA_SOURCE_MUX_DEFAULT_VBV_BUFFER_TIME /* in ms */, bool pIntraRefresh = true); // returns true if the encoder has to be reset
+    bool GetRealtimeRateControl();
+    int GetRealtimeRateControlVbvBufferTime();
+    bool GetRealtimeRateControlIntraRefresh();
+
+    /* encoder output statistic */
+    int GetEncodedFrameSizeAverage(); // in bytes
+    int GetEncodedFrameSizeDeviation(); // standard deviation in bytes
+    int GetEncodedFrameSizePeak(); // largest burst in bytes
 
     /* get access to current basic media source */
     virtual MediaSource* GetMediaSource();
@@ -109,6 +160,7 @@ public:
     static bool IsOutputCodecSupported(std::string pStreamCodec);
     bool SetOutputStreamPreferences(std::string pStreamCodec, int pMediaStreamQuality, int pBitRate, int pMaxPacketSize = 1300 /* works only with RTP packetizing */, bool pDoReset = false, int pResX = 352, int pResY = 288, int pMaxFps = 0);
     enum AVCodecID GetStreamCodecId() { return mStreamCodecId; } // used in RTSPListenerMediaSession
+    int64_t GetEncoderSwitchGap(); // in us, gap between the outgoing packets of the old and the new encoder during the last live reconfiguration
 
     /* frame stats */
     virtual bool SupportsDecoderFrameStatistics();
@@ -149,12 +201,19 @@ public:
     virtual float GetFrameBufferPreBufferingTime();
     virtual void SetFrameBufferPreBufferingTime(float pTime);
     virtual float GetFrameBufferTime();
+    virtual float GetFrameBufferActivePreBufferingTime();
+    virtual int GetTimeToFirstFrame();
     virtual int GetFrameBufferCounter();
     virtual int GetFrameBufferSize();
     virtual void SetPreBufferingActivation(bool pActive);
     virtual void SetPreBufferingAutoRestartActivation(bool pActive);
     virtual int GetDecoderOutputFrameDelay();
 
+    /* media memory budget */
+    virtual void SetBackground(bool pBackground);
+    virtual bool IsBackground();
+    virtual int64_t GetMemoryUsage();
+
     /* recording control */
     virtual bool StartRecording(std::string pSaveFileName, int pSaveFileQuality = 10);
     virtual void StopRecording();
@@ -173,7 +232,7 @@ public:
     virtual std::string GetCurrentDeviceName();
     virtual void RegisterMediaFilter(MediaFilter *pMediaFilter);
     virtual bool UnregisterMediaFilter(MediaFilter *pMediaFilter, bool pAutoDelete = true);
-    virtual bool RegisterMediaSource(MediaSource *pMediaSource);
+    virtual bool RegisterMediaSource(MediaSource *pMediaSource, bool pPreferred = false /* probed first during device selection */);
     virtual bool UnregisterMediaSource(MediaSource *pMediaSource, bool pAutoDelete = true);
     virtual void DeleteAllRegisteredMediaFileSources();
 
@@ -205,9 +264,12 @@ public:
     virtual void FreeChunkBuffer(void *pChunk);
 
 private:
+    friend class VideoEncoderPreparer;
+
     /* video resolution limitation depending on video codec capabilities */
     void ValidateVideoResolutionForEncoderCodec(int &pResX, int &pResY, enum AVCodecID pCodec);
 
+    float GetVideoMuxerFrameRate(float pFps);
     bool OpenVideoMuxer(int pResX = 352, int pResY = 288, float pFps = 29.97);
     bool OpenAudioMuxer(int pSampleRate = 44100, int pChannels = 2);
     bool CloseMuxer();
@@ -223,13 +285,45 @@ private:
 
     void ResetEncoderBuffers();
 
+    /* live reconfiguration: the capture device and the media sinks stay untouched */
+    bool CreateVideoEncoder(VideoEncoderDescriptor &pEncoder, enum AVCodecID pCodecId, float pFps);
+    void DestroyVideoEncoder(VideoEncoderDescriptor &pEncoder);
+    bool ApplyLiveRateSettings(); // returns false if the running encoder can't adopt the new settings
+    bool ReconfigureVideoEncoder(); // returns false if a reset is needed, the new encoder is prepared in the background
+    void PrepareVideoEncoder(); // context of the encoder preparer thread
+    VideoScaler* RedirectVideoEncoderInput(VideoScaler *&pVideoScaler); // context of the encoder thread, returns the old scaler which has to be drained
+    void SwitchVideoEncoder(VideoScaler *pOldVideoScaler); // context of the encoder thread, after the old scaler was drained
+
     static int FfmpegWriteOneOutputPacket(AVFormatContext *pFormatContext, AVPacket *pAVPacket);
+
+    /* relaying: skip idle video frames */
+    bool SkipIdleFrame(void *pChunkBuffer, int pChunkSize);
+    static uint64_t CalculateFrameHash(void *pChunkBuffer, int pChunkSize);
+    void ResetIdleFrameDetection();
     static int FfmpegForceOneOutputStream(AVFormatContext *pFormatContext);
 
+    /* real-time rate control */
+    void ApplyRealtimeRateControl(AVCodecContext *pCodecContext, AVCodec *pCodec);
+
+    /* path MTU: packet size limits of the registered media sinks */
+    int GetStreamMaxPacketSize(); // effective max. packet size
+    bool CheckPathMaxPacketSize(); // returns true if the encoder has to be reset
+
+    /* audio packetization: low-latency or low-overhead mode depending on the amount of media sinks */
+    void CheckAudioPacketizationMode();
+
+    /* encoder output statistic */
+    void AccountEncodedFrame(int pSize);
+    void ResetEncodedFrameStatistic();
+
     MediaSource         *mMediaSource;
     AVOutputFormat      mMuxerOutFormat;
     enum AVCodecID      mStreamCodecId;
     int                 mStreamMaxPacketSize;
+    int                 mStreamPathMaxPacketSize; // smallest limit of all media sinks, 0 if unknown
+    int64_t             mStreamPathMaxPacketSizeLastCheck;
+    bool                mAudioLowOverheadPacketization;
+    int64_t             mAudioPacketizationModeLastCheck;
     int                 mStreamQuality;
     int                 mStreamBitRate;
     int                 mStreamMaxFps;
@@ -239,6 +333,23 @@ private:
     /* relaying: skip audio silence */
     bool                mRelayingSkipAudioSilence;
     int64_t             mRelayingSkipAudioSilenceSkippedChunks;
+    /* relaying: skip idle video frames */
+    bool                mRelayingSkipIdleFrames;
+    float               mRelayingSkipIdleFramesKeepAliveFps;
+    int64_t             mRelayingSkipIdleFramesSkippedFrames;
+    int                 mIdleFrameCount; // consecutive unchanged frames
+    uint64_t            mIdleFrameHash;
+    int                 mIdleFrameModifiers; // flipping and OSD of the last frame
+    int64_t             mIdleFrameLastKeepAliveTime;
+    /* real-time rate control */
+    bool                mRateControlRealtime;
+    int                 mRateControlVbvBufferTime; // in ms
+    bool                mRateControlIntraRefresh;
+    /* encoder output statistic */
+    int64_t             mEncodedFrames;
+    double              mEncodedFrameSizeMean;
+    double              mEncodedFrameSizeM2; // sum of squared differences from the mean
+    int                 mEncodedFrameSizePeak;
     /* encoding */
     Mutex               mEncoderSeekMutex;
     char                *mEncoderChunkBuffer;
@@ -248,6 +359,18 @@ private:
     Mutex               mEncoderFifoAvailableMutex;
     int                 mEncoderBufferedFrames; // in frames
     int64_t             mEncoderStartTime;
+    /* live reconfiguration */
+    VideoEncoderPreparer *mVideoEncoderPreparer;
+    VideoEncoderDescriptor mPendingVideoEncoder; // prepared, not yet used by the encoder thread
+    VideoEncoderDescriptor mNextVideoEncoder; // takes over after the old scaler was drained
+    bool                mVideoEncoderSwitchPending;
+    Mutex               mVideoEncoderSwitchMutex;
+    bool                mVideoEncoderResetNeeded; // the preparation failed
+    bool                mVideoEncoderInputChangePending; // grabbed frames don't fit to the scaler of the running encoder
+    bool                mVideoEncoderKeyFrameNeeded;
+    int64_t             mVideoEncoderSwitchTime; // in us, time of the last packet of the old encoder, 0 if nothing is measured
+    int64_t             mVideoEncoderSwitchGap; // in us
+    int64_t             mLastOutputPacketTime; // in us
     /* device control */
     MediaSources        mMediaSources;
     Mutex               mMediaSourcesMutex;
@@ -55,13 +55,14 @@ struct TCPFragmentHeader{
 ///////////////////////////////////////////////////////////////////////////////
 
 class NetworkListener;
+class NetworkDemultiplexer;
 
 class MediaSourceNet :
     public MediaSourceMem
 {
 public:
     /// The constructor
-    MediaSourceNet(Socket *pDataSocket);
+    MediaSourceNet(Socket *pDataSocket, Socket *pBundleSocket = NULL); // a bundle socket is received by one thread for all sources, e.g., audio and video of a bundled session
     MediaSourceNet(unsigned int pPortNumber, enum TransportType pTransportType);
     MediaSourceNet(std::string pLocalName, Requirements *pTransportRequirements);
 
@@ -73,6 +74,9 @@ public:
 
     unsigned int GetListenerPort();
 
+    /* payload type signaled for this source, used for routing packets of a bundle socket */
+    void SetNegotiatedPayloadId(unsigned int pPayloadId);
+
     virtual bool OpenVideoGrabDevice(int pResX = 352, int pResY = 288, float pFps = 29.97);
     virtual bool OpenAudioGrabDevice(int pSampleRate = 44100, int pChannels = 2);
     virtual bool CloseGrabDevice();
@@ -80,10 +84,12 @@ public:
 protected:
     /* network socket listener thread */
     friend class NetworkListener;
+    friend class NetworkDemultiplexer;
 
     void Init();
 
     NetworkListener     *mNetworkListener;
+    int                 mNegotiatedPayloadId;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
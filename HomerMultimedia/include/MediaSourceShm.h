@@ -0,0 +1,90 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: shared memory based media source for streams of other local processes
+ * Since:   2014-02-08
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_SOURCE_SHM_
+#define _MULTIMEDIA_MEDIA_SOURCE_SHM_
+
+#include <MediaSourceMem.h>
+#include <MediaShmRing.h>
+
+#include <string>
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of received packets
+//#define MSSHM_DEBUG_PACKETS
+
+// how long does a reader wait for new slots before it checks if it is still needed?
+#define MEDIA_SOURCE_SHM_READ_TIMEOUT                   100 // ms
+
+///////////////////////////////////////////////////////////////////////////////
+
+class ShmListener;
+
+/*
+ * Reads the ring of a MediaSinkShm or MediaFilterShm. Encoded packets are
+ * decoded like the fragments of a memory source, raw frames are delivered
+ * directly from the ring to the grabbing thread without any decoder.
+ */
+class MediaSourceShm :
+    public MediaSourceMem
+{
+public:
+    /// The constructor
+    MediaSourceShm(std::string pName);
+
+    /// The destructor
+    virtual ~MediaSourceShm();
+
+    /* grabbing control */
+    virtual void StopGrabbing();
+    virtual int GetChunkDropCounter();
+
+    virtual bool OpenVideoGrabDevice(int pResX = 352, int pResY = 288, float pFps = 29.97);
+    virtual bool OpenAudioGrabDevice(int pSampleRate = 44100, int pChannels = 2);
+    virtual bool CloseGrabDevice();
+    virtual int GrabChunk(void* pChunkBuffer, int& pChunkSize, bool pDropChunk = false);
+
+private:
+    friend class ShmListener;
+
+    bool AttachRing(enum MediaType pMediaType);
+    bool OpenRawFrames(int pResX, int pResY, float pFps, int pSampleRate, int pChannels);
+
+    std::string         mRingName;
+    MediaShmRing        mRing;
+    Mutex               mRingMutex;
+    bool                mRawFrames;
+    ShmListener         *mShmListener;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
@@ -29,6 +29,7 @@
 #define _MULTIMEDIA_MEDIA_SOURCE_V4L2_
 
 #include <MediaSource.h>
+#include <MediaDeviceRegistry.h>
 
 namespace Homer { namespace Multimedia {
 
@@ -60,6 +61,7 @@ public:
 
     /* device control */
     virtual void getVideoDevices(VideoDevices &pVList);
+    static bool ProbeVideoDevice(std::string pDeviceFile, VideoDeviceDescriptor &pDevice, VideoDeviceCapabilities &pCapabilities);
     virtual bool SelectDevice(std::string pDeviceName, enum MediaType pMediaType, bool &pIsNewDevice);
 
     /* recording */
@@ -0,0 +1,114 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2011 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+
+/*
+ * Purpose: A/V synchronization of media sources against a master clock
+ * Since:   2014-01-15
+ */
+
+#ifndef _MULTIMEDIA_MEDIA_SYNCHRONIZER_
+#define _MULTIMEDIA_MEDIA_SYNCHRONIZER_
+
+#include <HBMutex.h>
+
+#include <string>
+#include <stdint.h>
+
+using namespace Homer::Base;
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of A/V synchronization
+//#define MSYNC_DEBUG
+
+// offsets below this limit are not corrected
+#define MEDIA_SYNC_DEAD_BAND                            0.015 // seconds
+// how much may the presentation time of one slave frame be shifted?
+#define MEDIA_SYNC_MAX_ADJUSTMENT_PER_FRAME             0.002 // seconds
+// from which offset on do we shift the presentation at once instead of adjusting it frame by frame?
+#define MEDIA_SYNC_RESYNC_THRESHOLD                     0.5 // seconds
+// offsets above this limit can't be caused by the playback, the sources don't share a clock
+#define MEDIA_SYNC_MAX_OFFSET                           5.0 // seconds
+// how long may the master clock stand still before we stop adjusting the slave? (paused or interrupted master)
+#define MEDIA_SYNC_MASTER_TIMEOUT                       1.0 // seconds
+// weight of a new offset measurement in the smoothed offset
+#define MEDIA_SYNC_SMOOTHING_FACTOR                     0.1
+
+///////////////////////////////////////////////////////////////////////////////
+
+class MediaSource;
+
+/*
+ * Maps the presentation of a slave source to the clock of a master source.
+ * Both sources deliver synchronization timestamps which refer to the wall
+ * clock of the sender (derived from RTCP sender reports for RTP streams).
+ * The audio source is used as master because gaps in audio playback are
+ * more obvious than a slightly delayed video frame. The slave asks for each
+ * frame how much its presentation has to be shifted - the offset is absorbed
+ * by small adjustments instead of resetting the sources.
+ */
+class MediaSynchronizer
+{
+public:
+    MediaSynchronizer(MediaSource *pMasterSource, std::string pName = "");
+
+    virtual ~MediaSynchronizer();
+
+    void SetActivation(bool pActive);
+    bool GetActivation();
+
+    /* desired offset between slave and master, e.g., to compensate a delayed video output, in us */
+    void SetTargetOffset(int64_t pOffset);
+
+    /* called by the slave source for each frame before it waits for the presentation, returns the needed shift of the presentation time in us */
+    int64_t SchedulePresentation(int64_t pSlaveSynchronizationTimestamp, int64_t pPresentationDelay);
+
+    /* statistic */
+    float GetOffset(); // the smoothed residual offset in s, positive if the slave is ahead of the master
+    int64_t GetAdjustmentCounter();
+    int64_t GetResynchronizationCounter();
+
+private:
+    void ResetOffset();
+
+    std::string         mName;
+    MediaSource         *mMasterSource;
+    Mutex               mMutex;
+    bool                mActive;
+    int64_t             mTargetOffset; // in us
+    double              mOffset; // smoothed, in us
+    bool                mOffsetValid;
+    int64_t             mLastMasterTimestamp;
+    int64_t             mTimeLastMasterProgress; // in us
+    bool                mIncompatibleClocks;
+    /* statistic */
+    int64_t             mAdjustmentCounter;
+    int64_t             mResynchronizationCounter;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace
+
+#endif
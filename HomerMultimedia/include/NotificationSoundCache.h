@@ -0,0 +1,100 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: cache of decoded notification sounds
+ * Since:   2014-01-25
+ */
+
+#ifndef _MULTIMEDIA_NOTIFICATION_SOUND_CACHE_
+#define _MULTIMEDIA_NOTIFICATION_SOUND_CACHE_
+
+#include <HBMutex.h>
+
+#include <string>
+#include <map>
+#include <stdint.h>
+
+using namespace Homer::Base;
+
+namespace Homer { namespace Multimedia {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of the sound cache
+//#define NSC_DEBUG
+
+#define SVC_NOTIFICATION_SOUND_CACHE                    NotificationSoundCache::GetInstance()
+
+// sound files are only cached up to this duration
+#define NOTIFICATION_SOUND_MAX_DURATION                 30 // seconds
+
+// how many failed grabbing attempts are tolerated while decoding a sound file
+#define NOTIFICATION_SOUND_MAX_GRAB_FAILURES            32
+
+///////////////////////////////////////////////////////////////////////////////
+
+// PCM data of a decoded sound file: 16 bit signed, interleaved channels
+struct NotificationSound
+{
+    std::string     FileName;
+    int             SampleRate;
+    int             Channels;
+    char            *Buffer;
+    int             BufferSize; // in bytes
+};
+
+typedef std::map<std::string, NotificationSound*> NotificationSounds;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Decodes each sound file only once. The cached sounds are never changed and
+ * stay valid until the process terminates, so they can be referenced by any
+ * playback without further locking.
+ */
+class NotificationSoundCache
+{
+public:
+    NotificationSoundCache();
+
+    virtual ~NotificationSoundCache();
+
+    static NotificationSoundCache& GetInstance();
+
+    /* returns NULL if the file can't be decoded, the first request for a file decodes it */
+    NotificationSound* GetSound(std::string pFileName, int pSampleRate = 44100, int pChannels = 2);
+
+    int GetSoundCount();
+    int64_t GetMemoryUsage();
+
+private:
+    NotificationSound* DecodeSound(std::string pFileName, int pSampleRate, int pChannels);
+
+    NotificationSounds  mSounds;
+    Mutex               mSoundsMutex;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
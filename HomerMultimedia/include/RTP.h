@@ -65,6 +65,19 @@ enum RtcpType{
     RTCP_APP = 204
 };
 
+// RTCP packet types as they appear in the RTP payload type field (marker bit set)
+#define IS_RTCP_TYPE(x)                 (((x) >= 72) && ((x) <= 76))
+
+// audio packetization time in ms: the default of rfc 3551, the value for the low-overhead mode and the upper limit
+#define RTP_AUDIO_PTIME_DEFAULT                 20
+#define RTP_AUDIO_PTIME_LOW_OVERHEAD            60
+#define RTP_AUDIO_PTIME_MAX                     120
+
+enum RtpAudioPacketizationMode{
+    RTP_AUDIO_PACKETIZATION_LOW_LATENCY = 0, // the negotiated ptime
+    RTP_AUDIO_PACKETIZATION_LOW_OVERHEAD // at least RTP_AUDIO_PTIME_LOW_OVERHEAD, limited by the negotiated maxptime
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // ########################## RTCP ###########################################
@@ -157,6 +170,7 @@ public:
 
     static unsigned int GetPreferedRTPPayloadIDForCodec(std::string pName);
     static std::string GetCodecFromPreferedPayloadID(int pId);
+    static enum AVMediaType GetMediaTypeFromPreferedPayloadID(int pId);
 
     static bool IsPayloadSupported(enum AVCodecID pId);
     static int GetPayloadHeaderSizeMax(enum AVCodecID pCodec);// calculate the maximum header size of the RTP payload (not the RTP header!)
@@ -174,6 +188,12 @@ public:
     void SetExternallyNegotiatedPayloadID(unsigned int pNewID); //should be called before the first frame packet gets packetized
     bool RtpCreate(AVPacket *pAVPacket, char *&pResultingOutputData, unsigned int &pResultingOutputDataSize);
 
+    /* audio packetization: several codec frames per RTP packet */
+    void SetAudioPacketizationTime(int pPtime, int pMaxPtime = 0); // in ms, e.g., negotiated via SDP, 0 means undefined; should be called before OpenRtpEncoder()
+    void SetAudioPacketizationMode(enum RtpAudioPacketizationMode pMode);
+    enum RtpAudioPacketizationMode GetAudioPacketizationMode();
+    int GetAudioPacketizationTime(); // effective ptime in ms
+
     unsigned int GetLostPacketsFromRTP();
     static void LogRtpHeader(RtpHeader *pRtpHeader);
     bool ReceivedCorrectPayload(unsigned int pType);
@@ -209,13 +229,27 @@ private:
 
     void RtcpPatchLiveSenderReport(char *pHeader, uint32_t pTimestamp);
 
-    /* internal RTP packetizer for h.261 */
-    bool OpenRtpEncoderH261(std::string pTargetHost, unsigned int pTargetPort, AVStream *pInnerStream);
+    /* internal RTP packetizer for h.261, VP9 and AV1 */
+    bool OpenRtpEncoderInternal(std::string pTargetHost, unsigned int pTargetPort, AVStream *pInnerStream);
     bool RtpCreateH261(char *&pData, unsigned int &pDataSize, int64_t pPacketPts);
+    bool RtpCreateVP9(char *&pData, unsigned int &pDataSize, int64_t pPacketPts, bool pKeyFrame);
+    bool RtpCreateAV1(char *&pData, unsigned int &pDataSize, int64_t pPacketPts, bool pKeyFrame);
+    void RtpFinishInternalPacket(char *pPacket, unsigned int pPayloadSize, bool pMarked, int64_t pPacketPts);
     void RtcpCreateH261SenderReport(char *&pData, unsigned int &pDataSize, int64_t pCurPts);
 
+    /* VP9/AV1 RTP parser: the demuxers need entire frames */
+    bool RtpReassembleVP9Frame(char *&pData, int &pDataSize, bool pFrameStart, bool &pIsLastFragment);
+    bool RtpReassembleAV1TemporalUnit(char *&pData, int &pDataSize, uint8_t pAggregationHeader, bool &pIsLastFragment);
+    bool RtpReassembleAV1Obu(const char *pObu, int pObuSize);
+    bool RtpReassemblyLostFragment();
+
     /* RTP packet stream */
     static int StoreRtpPacket(void *pOpaque, uint8_t *pBuffer, int pBufferSize);
+
+    /* audio frame aggregation for sample based codecs */
+    static bool IsAudioAggregationSupported(enum AVCodecID pCodec);
+    bool AggregateAudioFrame(AVPacket *pAVPacket, AVPacket *&pAggregatedPacket); // returns false as long as frames are collected
+    void FinishAudioAggregation(AVPacket *pAVPacket);
     void OpenRtpPacketStream();
     void CloseRtpPacketStream(char** pBuffer, unsigned int &pBufferSize);
 
@@ -263,9 +297,33 @@ private:
     char                mH261H263EndByte;
     /* HEVC parser */
     bool                mHEVCIsUsingDonFields; //TODO: support this via SDP
-    /* H261 RTP encoder */
+    /* VP9/AV1 parser */
+    char                *mFrameReassemblyBuffer; // allocated on demand
+    int                 mFrameReassemblySize;
+    bool                mFrameReassemblyDropping; // a fragment of the current frame was lost
+    uint64_t            mFrameReassemblyLastSequenceNumber;
+    bool                mVP9IvfFileHeaderDelivered;
+    int                 mVP9ResX; // from the scalability structure
+    int                 mVP9ResY;
+    char                *mAV1ObuBuffer; // OBU which is fragmented over several packets, allocated on demand
+    int                 mAV1ObuSize;
+    /* audio packetization */
+    int                 mAudioPtime; // in ms, 0 if not negotiated
+    int                 mAudioMaxPtime; // in ms, 0 if not negotiated
+    enum RtpAudioPacketizationMode mAudioPacketizationMode;
+    char                *mAudioAggregationBuffer[2]; // one collects frames while the other one is packetized
+    int                 mAudioAggregationBufferIndex;
+    int                 mAudioAggregationSize; // in bytes
+    int                 mAudioAggregationSamples;
+    int64_t             mAudioAggregationPts;
+    AVPacket            mAudioAggregationPacket;
+    /* H261 RTP encoder, the state is shared by the internal VP9/AV1 encoders */
     static unsigned int mH261PayloadSizeMax;
     bool                mH261UseInternalEncoder;
+    unsigned int        mInternalPayloadSizeMax; // VP9/AV1
+    int                 mInternalResX;
+    int                 mInternalResY;
+    unsigned short int  mVP9PictureId;
     unsigned short int  mH261LocalSequenceNumber;
     uint64_t            mH261SentPackets;
     uint64_t            mH261SentOctets;
@@ -29,17 +29,45 @@
 
 #include <MediaSource.h>
 #include <MediaFifo.h>
-#include <MediaSourceFile.h>
+#include <NotificationSoundCache.h>
 #include <PacketStatistic.h>
 #include <HBThread.h>
 #include <HBCondition.h>
 
+#include <list>
+
 namespace Homer { namespace Multimedia {
 
 ///////////////////////////////////////////////////////////////////////////////
 
 //#define WO_DEBUG_FILE
 
+// polyphony limit for mixed notification sounds, the oldest sound is dropped first
+#define WAVEOUT_MAX_SOUNDS                              4
+
+// how many sound requests may wait for their start
+#define WAVEOUT_MAX_PENDING_SOUNDS                      16
+
+// the same sound isn't restarted more often than this
+#define WAVEOUT_SOUND_MIN_INTERVAL                      250 // ms
+
+// how many mixed chunks are written ahead of the real time
+#define WAVEOUT_SOUND_PREBUFFER_CHUNKS                  4
+
+// if chunks were written from outside within this period, the sounds are mixed into them
+#define WAVEOUT_EXTERNAL_STREAM_TIMEOUT                 250 // ms
+
+struct WaveOutSound
+{
+    std::string         FileName;
+    NotificationSound   *Sound;
+    int                 Position; // in samples
+    int                 Loops;
+    int64_t             StartTime; // in us
+};
+
+typedef std::list<WaveOutSound> WaveOutSounds;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class WaveOut:
@@ -85,15 +113,18 @@ public:
     virtual bool WriteChunk(void* pChunkBuffer, int pChunkSize = 4096);
 
 private:
-    /* playback of file */
+    /* playback of notification sounds */
     virtual void* Run(void* pArgs = NULL);
-    bool DoOpenNewFile();
+    void StartPendingSounds();
+    bool HasSounds();
+    bool IsExternalStreamActive();
 
 protected:
     virtual void DoWriteChunk(char *pChunkBuffer, int pChunkSize);
 
     /* helper functions */
     virtual void AdjustVolume(void *pBuffer, int pBufferSize);
+    virtual void MixSounds(char *pChunkBuffer, int pChunkSize);
     virtual void StopFilePlayback();
     virtual void AssignThreadName();
 
@@ -117,15 +148,17 @@ protected:
     MediaFifo           *mPlaybackFifo; // needed as FIFO buffer with prepared audio buffers for playback, avoid expensive operations like malloc/free (used when using AVFifoBuffer)
     int64_t             mPlaybackGaps;
     int64_t             mPlaybackChunks;
-    /* playback of file */
+    /* playback of notification sounds */
     std::string         mFilePlaybackFileName;
-    bool                mOpenNewFileAsap;
     bool                mFilePlaybackNeeded;
-    Mutex               mOpenNewFile;
-    MediaSourceFile     *mFilePlaybackSource;
-    int                 mFilePlaybackLoops;
     char                *mFilePlaybackBuffer;
     Condition           mFilePlaybackCondition;
+    Mutex               mSoundsMutex;
+    WaveOutSounds       mPendingSounds;
+    WaveOutSounds       mActiveSounds;
+    int64_t             mSoundsStopCounter;
+    bool                mSoundsIdleStop; // guarded by mSoundsMutex
+    int64_t             mLastExternalChunkTime; // in us
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,480 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a shared demuxer for the A/V streams of one media file
+ * Since:   2014-02-11
+ */
+
+#include <MediaDemuxer.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace Homer { namespace Multimedia {
+
+using namespace Homer::Base;
+using namespace std;
+
+// all demuxers which are currently in use, indexed by their file name
+static MediaDemuxers sDemuxers;
+static Mutex sDemuxersMutex;
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaDemuxer::MediaDemuxer(string pFileName)
+{
+    mFileName = pFileName;
+    mFormatContext = NULL;
+    mReaderActive = false;
+    mLastSeekTimestamp = 0;
+    mLastSeekTime = 0;
+    mReadPackets = 0;
+    mReadBytes = 0;
+}
+
+MediaDemuxer::~MediaDemuxer()
+{
+    Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaDemuxer* MediaDemuxer::Acquire(string pFileName, enum MediaType pMediaType)
+{
+    MediaDemuxer *tResult = NULL;
+
+    sDemuxersMutex.lock();
+
+    // search for a demuxer of this file which has no subscriber for the media type yet
+    pair<MediaDemuxers::iterator, MediaDemuxers::iterator> tRange = sDemuxers.equal_range(pFileName);
+    for (MediaDemuxers::iterator tIt = tRange.first; tIt != tRange.second; tIt++)
+    {
+        MediaDemuxer *tDemuxer = tIt->second;
+        tDemuxer->mMutex.lock();
+        if (tDemuxer->mSubscribers.find(pMediaType) == tDemuxer->mSubscribers.end())
+            tResult = tDemuxer;
+        tDemuxer->mMutex.unlock();
+        if (tResult != NULL)
+        {
+            LOGEX(MediaDemuxer, LOG_VERBOSE, "Sharing demuxer of %s with a new subscriber", pFileName.c_str());
+            break;
+        }
+    }
+
+    if (tResult == NULL)
+    {
+        tResult = new MediaDemuxer(pFileName);
+        if (!tResult->Open())
+        {
+            delete tResult;
+            sDemuxersMutex.unlock();
+            return NULL;
+        }
+        sDemuxers.insert(MediaDemuxers::value_type(pFileName, tResult));
+    }
+
+    // reserve the slot for the media type
+    tResult->mMutex.lock();
+    MediaDemuxerSubscriber &tSubscriber = tResult->mSubscribers[pMediaType];
+    tSubscriber.StreamIndex = -1;
+    tSubscriber.QueueSize = 0;
+    tSubscriber.Repositioned = false;
+    tSubscriber.CoalesceSeek = false;
+    tSubscriber.Stalled = false;
+    tSubscriber.WaitForKeyFrame = false;
+    tSubscriber.DispatchedPackets = 0;
+    tSubscriber.DroppedPackets = 0;
+    tResult->mMutex.unlock();
+
+    sDemuxersMutex.unlock();
+
+    return tResult;
+}
+
+void MediaDemuxer::Release(MediaDemuxer *pDemuxer, enum MediaType pMediaType)
+{
+    bool tUnused = false;
+
+    if (pDemuxer == NULL)
+        return;
+
+    sDemuxersMutex.lock();
+
+    pDemuxer->mMutex.lock();
+    MediaDemuxerSubscribers::iterator tIt = pDemuxer->mSubscribers.find(pMediaType);
+    if (tIt != pDemuxer->mSubscribers.end())
+    {
+        LOGEX(MediaDemuxer, LOG_VERBOSE, "Releasing stream %d of %s, %"PRId64" packets were dispatched, %"PRId64" packets were dropped", tIt->second.StreamIndex, pDemuxer->mFileName.c_str(), tIt->second.DispatchedPackets, tIt->second.DroppedPackets);
+        pDemuxer->FlushQueue(tIt->second);
+        if ((tIt->second.StreamIndex >= 0) && (tIt->second.StreamIndex < (int)pDemuxer->mFormatContext->nb_streams))
+            pDemuxer->mFormatContext->streams[tIt->second.StreamIndex]->discard = AVDISCARD_ALL;
+        pDemuxer->mSubscribers.erase(tIt);
+
+        // a reader which waits for the queue of this subscriber continues
+        pDemuxer->mQueueCondition.Signal();
+    }
+    tUnused = pDemuxer->mSubscribers.empty();
+    pDemuxer->mMutex.unlock();
+
+    if (tUnused)
+    {
+        pair<MediaDemuxers::iterator, MediaDemuxers::iterator> tRange = sDemuxers.equal_range(pDemuxer->mFileName);
+        for (MediaDemuxers::iterator tDemuxerIt = tRange.first; tDemuxerIt != tRange.second; tDemuxerIt++)
+        {
+            if (tDemuxerIt->second == pDemuxer)
+            {
+                sDemuxers.erase(tDemuxerIt);
+                break;
+            }
+        }
+        LOGEX(MediaDemuxer, LOG_VERBOSE, "Closing demuxer of %s after %"PRId64" read packets with %"PRId64" bytes", pDemuxer->mFileName.c_str(), pDemuxer->mReadPackets, pDemuxer->mReadBytes);
+        delete pDemuxer;
+    }
+
+    sDemuxersMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaDemuxer::Open()
+{
+    int tRes;
+
+    LOG(LOG_VERBOSE, "Opening demuxer for %s", mFileName.c_str());
+
+    if ((tRes = avformat_open_input(&mFormatContext, mFileName.c_str(), NULL, NULL)) < 0)
+    {
+        LOG(LOG_ERROR, "Couldn't open input \"%s\" because \"%s\"(%d)", mFileName.c_str(), strerror(AVUNERROR(tRes)), tRes);
+        mFormatContext = NULL;
+        return false;
+    }
+
+    if ((tRes = avformat_find_stream_info(mFormatContext, NULL)) < 0)
+    {
+        LOG(LOG_ERROR, "avformat_find_stream_info() could not find stream information in %s because \"%s\"(%d)", mFileName.c_str(), strerror(AVUNERROR(tRes)), tRes);
+        HM_avformat_close_input(mFormatContext);
+        mFormatContext = NULL;
+        return false;
+    }
+
+    // the demuxer skips all streams until they are subscribed
+    for (int i = 0; i < (int)mFormatContext->nb_streams; i++)
+        mFormatContext->streams[i]->discard = AVDISCARD_ALL;
+
+    LOG(LOG_VERBOSE, "Demuxer for %s opened with input format %s and %d streams", mFileName.c_str(), mFormatContext->iformat->name, mFormatContext->nb_streams);
+
+    return true;
+}
+
+void MediaDemuxer::Close()
+{
+    MediaDemuxerSubscribers::iterator tIt;
+    for (tIt = mSubscribers.begin(); tIt != mSubscribers.end(); tIt++)
+        FlushQueue(tIt->second);
+    mSubscribers.clear();
+
+    if (mFormatContext != NULL)
+    {
+        HM_avformat_close_input(mFormatContext);
+        mFormatContext = NULL;
+    }
+}
+
+void MediaDemuxer::FlushQueue(MediaDemuxerSubscriber &pSubscriber)
+{
+    MediaDemuxerPacketQueue::iterator tIt;
+    for (tIt = pSubscriber.Queue.begin(); tIt != pSubscriber.Queue.end(); tIt++)
+        av_free_packet(&(*tIt));
+    pSubscriber.Queue.clear();
+    pSubscriber.QueueSize = 0;
+    pSubscriber.WaitForKeyFrame = false;
+}
+
+MediaDemuxerSubscriber* MediaDemuxer::FindSubscriber(int pStreamIndex)
+{
+    MediaDemuxerSubscribers::iterator tIt;
+    for (tIt = mSubscribers.begin(); tIt != mSubscribers.end(); tIt++)
+    {
+        if (tIt->second.StreamIndex == pStreamIndex)
+            return &tIt->second;
+    }
+
+    return NULL;
+}
+
+void MediaDemuxer::DropGroupOfPictures(MediaDemuxerSubscriber &pSubscriber)
+{
+    int tDroppedPackets = 0;
+
+    // drop the oldest packets up to the next key frame, the decoder can continue from there
+    do
+    {
+        pSubscriber.QueueSize -= pSubscriber.Queue.front().size;
+        av_free_packet(&pSubscriber.Queue.front());
+        pSubscriber.Queue.pop_front();
+        tDroppedPackets++;
+    }while ((!pSubscriber.Queue.empty()) && (!(pSubscriber.Queue.front().flags & AV_PKT_FLAG_KEY)));
+
+    pSubscriber.DroppedPackets += tDroppedPackets;
+    pSubscriber.WaitForKeyFrame = pSubscriber.Queue.empty();
+
+    // the subscriber misses packets and has to flush its decoder
+    pSubscriber.Repositioned = true;
+
+    #ifdef MD_DEBUG_PACKETS
+        LOG(LOG_VERBOSE, "Dropped %d packets of stream %d, queue has %d packets with %"PRId64" bytes", tDroppedPackets, pSubscriber.StreamIndex, (int)pSubscriber.Queue.size(), pSubscriber.QueueSize);
+    #endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+AVFormatContext* MediaDemuxer::GetFormatContext()
+{
+    return mFormatContext;
+}
+
+string MediaDemuxer::GetFileName()
+{
+    return mFileName;
+}
+
+void MediaDemuxer::Subscribe(enum MediaType pMediaType, int pStreamIndex)
+{
+    mMutex.lock();
+
+    MediaDemuxerSubscriber &tSubscriber = mSubscribers[pMediaType];
+    if ((tSubscriber.StreamIndex >= 0) && (tSubscriber.StreamIndex != pStreamIndex))
+    {
+        FlushQueue(tSubscriber);
+        mFormatContext->streams[tSubscriber.StreamIndex]->discard = AVDISCARD_ALL;
+        mQueueCondition.Signal();
+    }
+    tSubscriber.StreamIndex = pStreamIndex;
+    if ((pStreamIndex >= 0) && (pStreamIndex < (int)mFormatContext->nb_streams))
+        mFormatContext->streams[pStreamIndex]->discard = AVDISCARD_DEFAULT;
+
+    LOG(LOG_VERBOSE, "Subscribed stream %d of %s", pStreamIndex, mFileName.c_str());
+
+    mMutex.unlock();
+}
+
+bool MediaDemuxer::IsShared()
+{
+    int tActiveSubscribers = 0;
+
+    mMutex.lock();
+    MediaDemuxerSubscribers::iterator tIt;
+    for (tIt = mSubscribers.begin(); tIt != mSubscribers.end(); tIt++)
+        if (tIt->second.StreamIndex >= 0)
+            tActiveSubscribers++;
+    mMutex.unlock();
+
+    return (tActiveSubscribers > 1);
+}
+
+int MediaDemuxer::ReadPacket(enum MediaType pMediaType, AVPacket *pPacket)
+{
+    int tResult = 0;
+
+    mMutex.lock();
+
+    MediaDemuxerSubscriber &tSubscriber = mSubscribers[pMediaType];
+
+    // the file is read by one subscriber at a time, otherwise the order of the queued packets would break
+    while ((tSubscriber.Queue.empty()) && (mReaderActive))
+        mReaderCondition.Wait(&mMutex, MEDIA_DEMUXER_QUEUE_TIMEOUT);
+
+    // was the packet already read for us?
+    if (!tSubscriber.Queue.empty())
+    {
+        *pPacket = tSubscriber.Queue.front();
+        tSubscriber.Queue.pop_front();
+        tSubscriber.QueueSize -= pPacket->size;
+        tSubscriber.Stalled = false;
+
+        // a reader which waits for free space in our queue continues
+        mQueueCondition.Signal();
+
+        mMutex.unlock();
+
+        return 0;
+    }
+    tSubscriber.Stalled = false;
+    mReaderActive = true;
+
+    while (true)
+    {
+        if ((tResult = av_read_frame(mFormatContext, pPacket)) < 0)
+            break;
+
+        mReadPackets++;
+        mReadBytes += pPacket->size;
+
+        // the packet buffer may belong to the demuxer and would be overwritten by the next read of another subscriber
+        av_dup_packet(pPacket);
+
+        if (pPacket->stream_index == tSubscriber.StreamIndex)
+        {
+            tSubscriber.DispatchedPackets++;
+            break;
+        }
+
+        // store the packet for the subscriber of its stream
+        MediaDemuxerSubscriber *tOwner = FindSubscriber(pPacket->stream_index);
+
+        // backpressure: wait until the subscriber has read from its full queue, only a stalled subscriber loses whole GOPs
+        int64_t tLastSeekTime = mLastSeekTime;
+        while ((tOwner != NULL) && (!tOwner->Queue.empty()) && ((tOwner->Queue.size() >= MEDIA_DEMUXER_QUEUE_MAX_PACKETS) || (tOwner->QueueSize + pPacket->size > MEDIA_DEMUXER_QUEUE_MAX_SIZE)))
+        {
+            if ((tOwner->Stalled) || (!mQueueCondition.Wait(&mMutex, MEDIA_DEMUXER_QUEUE_TIMEOUT)))
+            {
+                // the subscriber may have been released in the meantime
+                tOwner = FindSubscriber(pPacket->stream_index);
+                if ((tOwner == NULL) || (tOwner->Queue.empty()))
+                    break;
+                if (!tOwner->Stalled)
+                {
+                    LOG(LOG_WARN, "Stream %d in %s wasn't read for %d ms, dropping whole GOPs of its queue", tOwner->StreamIndex, mFileName.c_str(), MEDIA_DEMUXER_QUEUE_TIMEOUT);
+                    tOwner->Stalled = true;
+                }
+                DropGroupOfPictures(*tOwner);
+            }else
+                tOwner = FindSubscriber(pPacket->stream_index);
+        }
+
+        // another subscriber has seeked while we were waiting, the packet belongs to the old position
+        if (mLastSeekTime != tLastSeekTime)
+        {
+            av_free_packet(pPacket);
+            continue;
+        }
+
+        // after dropped packets the queue continues with a key frame
+        if ((tOwner != NULL) && (tOwner->WaitForKeyFrame) && (!(pPacket->flags & AV_PKT_FLAG_KEY)))
+        {
+            tOwner->DroppedPackets++;
+            av_free_packet(pPacket);
+            continue;
+        }
+
+        if (tOwner != NULL)
+        {
+            tOwner->WaitForKeyFrame = false;
+            tOwner->Queue.push_back(*pPacket);
+            tOwner->QueueSize += pPacket->size;
+            tOwner->DispatchedPackets++;
+            #ifdef MD_DEBUG_PACKETS
+                LOG(LOG_VERBOSE, "Queued packet of stream %d, queue has %d packets with %"PRId64" bytes", pPacket->stream_index, (int)tOwner->Queue.size(), tOwner->QueueSize);
+            #endif
+
+            // a subscriber which waits for the current reader continues
+            mReaderCondition.Signal();
+        }else
+        {
+            av_free_packet(pPacket);
+        }
+    }
+
+    mReaderActive = false;
+    mReaderCondition.Signal();
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+int MediaDemuxer::Seek(enum MediaType pMediaType, int64_t pTimestamp, int pFlags)
+{
+    int tResult = 0;
+    int64_t tNow = Time::GetTimeStamp();
+
+    mMutex.lock();
+
+    MediaDemuxerSubscriber &tSubscriber = mSubscribers[pMediaType];
+
+    // another subscriber has already seeked to nearly the same position
+    if ((tSubscriber.CoalesceSeek) && (tNow - mLastSeekTime < MEDIA_DEMUXER_SEEK_COALESCING_TIME) && (llabs(pTimestamp - mLastSeekTimestamp) < MEDIA_DEMUXER_SEEK_COALESCING_DISTANCE))
+    {
+        LOG(LOG_VERBOSE, "Skipping seeking in %s to %"PRId64" because it was already done for another stream", mFileName.c_str(), pTimestamp);
+        tSubscriber.CoalesceSeek = false;
+        tSubscriber.Repositioned = false;
+
+        mMutex.unlock();
+
+        return 0;
+    }
+
+    if ((tResult = avformat_seek_file(mFormatContext, -1, INT64_MIN, pTimestamp, INT64_MAX, pFlags)) >= 0)
+    {
+        mLastSeekTimestamp = pTimestamp;
+        mLastSeekTime = tNow;
+
+        // the queued packets belong to the old position
+        MediaDemuxerSubscribers::iterator tIt;
+        for (tIt = mSubscribers.begin(); tIt != mSubscribers.end(); tIt++)
+        {
+            FlushQueue(tIt->second);
+            if (tIt->first != pMediaType)
+            {
+                tIt->second.Repositioned = true;
+                tIt->second.CoalesceSeek = true;
+            }else
+            {
+                tIt->second.Repositioned = false;
+                tIt->second.CoalesceSeek = false;
+            }
+        }
+    }
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+bool MediaDemuxer::WasRepositioned(enum MediaType pMediaType)
+{
+    bool tResult;
+
+    mMutex.lock();
+    MediaDemuxerSubscriber &tSubscriber = mSubscribers[pMediaType];
+    tResult = tSubscriber.Repositioned;
+    tSubscriber.Repositioned = false;
+    mMutex.unlock();
+
+    return tResult;
+}
+
+int64_t MediaDemuxer::GetReadPackets()
+{
+    return mReadPackets;
+}
+
+int64_t MediaDemuxer::GetReadBytes()
+{
+    return mReadBytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
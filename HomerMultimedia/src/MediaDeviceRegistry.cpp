@@ -0,0 +1,644 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a cached registry of capture devices with hotplug detection
+ * Since:   2014-02-12
+ */
+
+#include <MediaDeviceRegistry.h>
+#include <ProcessStatisticService.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+
+#if defined(LINUX) || defined(APPLE) || defined(BSD)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+#if defined(LINUX)
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
+
+namespace Homer { namespace Multimedia {
+
+using namespace Homer::Base;
+using namespace Homer::Monitor;
+using namespace std;
+
+MediaDeviceRegistry sMediaDeviceRegistry;
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaDeviceRegistry::MediaDeviceRegistry()
+{
+    mDeviceDirectory = MEDIA_DEVICE_REGISTRY_DEFAULT_DIRECTORY;
+    mGeneration = 0;
+    mHotplugDetectionRequested = false;
+    mHotplugDetectionNeeded = false;
+    mHotplugDetectionActive = false;
+    mInotifyFd = -1;
+    mDeviceWatch = -1;
+    mSoundWatch = -1;
+}
+
+MediaDeviceRegistry::~MediaDeviceRegistry()
+{
+    StopHotplugDetection();
+}
+
+MediaDeviceRegistry& MediaDeviceRegistry::GetInstance()
+{
+    return sMediaDeviceRegistry;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaDeviceRegistry::SetDeviceDirectory(string pDirectory)
+{
+    VideoDeviceFileBackends::iterator tIt;
+
+    if (pDirectory == "")
+        pDirectory = MEDIA_DEVICE_REGISTRY_DEFAULT_DIRECTORY;
+
+    mMutex.lock();
+    if (mDeviceDirectory == pDirectory)
+    {
+        mMutex.unlock();
+        return;
+    }
+    mMutex.unlock();
+
+    LOG(LOG_VERBOSE, "Setting device directory to %s", pDirectory.c_str());
+
+    // the watches belong to the old directory
+    bool tWasActive = IsHotplugDetectionActive();
+    if (tWasActive)
+        StopHotplugDetection();
+
+    mMutex.lock();
+    mDeviceDirectory = pDirectory;
+    for (tIt = mVideoDeviceFileBackends.begin(); tIt != mVideoDeviceFileBackends.end(); tIt++)
+    {
+        tIt->second.Scanned = false;
+        tIt->second.Files.clear();
+    }
+    mVideoDeviceListCache.clear();
+    mAudioDeviceListCache.clear();
+    mGeneration++;
+    mMutex.unlock();
+
+    if (tWasActive)
+        StartHotplugDetection();
+
+    NotifyObservers(MEDIA_VIDEO);
+    NotifyObservers(MEDIA_AUDIO);
+}
+
+string MediaDeviceRegistry::GetDeviceDirectory()
+{
+    string tResult;
+
+    mMutex.lock();
+    tResult = mDeviceDirectory;
+    mMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaDeviceRegistry::StartHotplugDetection()
+{
+    #if defined(LINUX)
+        mMutex.lock();
+        mHotplugDetectionRequested = true;
+        if (mHotplugDetectionActive)
+        {
+            mMutex.unlock();
+            return true;
+        }
+
+        mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mInotifyFd < 0)
+        {
+            LOG(LOG_WARN, "Failed to initialize inotify because of \"%s\", hotplug detection is disabled", strerror(errno));
+            mMutex.unlock();
+            return false;
+        }
+
+        mDeviceWatch = inotify_add_watch(mInotifyFd, mDeviceDirectory.c_str(), IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO);
+        if (mDeviceWatch < 0)
+        {
+            LOG(LOG_WARN, "Failed to watch device directory %s because of \"%s\", hotplug detection is disabled", mDeviceDirectory.c_str(), strerror(errno));
+            close(mInotifyFd);
+            mInotifyFd = -1;
+            mMutex.unlock();
+            return false;
+        }
+
+        // the sound directory is optional, it appears with the first sound device
+        string tSoundDirectory = mDeviceDirectory + "/" + MEDIA_DEVICE_REGISTRY_SOUND_DIRECTORY;
+        mSoundWatch = inotify_add_watch(mInotifyFd, tSoundDirectory.c_str(), IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO);
+
+        LOG(LOG_VERBOSE, "Starting hotplug detection for %s", mDeviceDirectory.c_str());
+        mHotplugDetectionNeeded = true;
+        mHotplugDetectionActive = true;
+        mMutex.unlock();
+
+        StartThread();
+
+        return true;
+    #else
+        mHotplugDetectionRequested = true;
+        return false;
+    #endif
+}
+
+void MediaDeviceRegistry::StopHotplugDetection()
+{
+    mMutex.lock();
+    bool tWasActive = mHotplugDetectionActive;
+    mHotplugDetectionNeeded = false;
+    mMutex.unlock();
+
+    if (!tWasActive)
+        return;
+
+    LOG(LOG_VERBOSE, "Stopping hotplug detection for %s", mDeviceDirectory.c_str());
+    StopThread(1000);
+
+    mMutex.lock();
+    #if defined(LINUX)
+        close(mInotifyFd);
+    #endif
+    mInotifyFd = -1;
+    mDeviceWatch = -1;
+    mSoundWatch = -1;
+    mHotplugDetectionActive = false;
+    mMutex.unlock();
+}
+
+bool MediaDeviceRegistry::IsHotplugDetectionActive()
+{
+    return mHotplugDetectionActive;
+}
+
+void MediaDeviceRegistry::RequestHotplugDetection()
+{
+    // the hotplug thread is started with the first enumeration, never during static initialization
+    if (!mHotplugDetectionRequested)
+        StartHotplugDetection();
+}
+
+bool MediaDeviceRegistry::IsCacheValid(int64_t pTimestamp)
+{
+    if (mHotplugDetectionActive)
+        return true;
+
+    return (Time::GetTimeStamp() - pTimestamp < MEDIA_DEVICE_REGISTRY_CACHE_TIMEOUT);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaDeviceRegistry::IsDeviceFile(string pFileName, string pDeviceFilePrefix)
+{
+    if ((pFileName.size() <= pDeviceFilePrefix.size()) || (pFileName.compare(0, pDeviceFilePrefix.size(), pDeviceFilePrefix) != 0))
+        return false;
+
+    for (size_t i = pDeviceFilePrefix.size(); i < pFileName.size(); i++)
+    {
+        if ((pFileName[i] < '0') || (pFileName[i] > '9'))
+            return false;
+    }
+
+    return true;
+}
+
+static bool DeviceFileOrder(const VideoDeviceDescriptor &pA, const VideoDeviceDescriptor &pB)
+{
+    // "video2" before "video10"
+    if (pA.Card.size() != pB.Card.size())
+        return (pA.Card.size() < pB.Card.size());
+
+    return (pA.Card < pB.Card);
+}
+
+void MediaDeviceRegistry::ScanDeviceFiles(VideoDeviceFileBackend &pBackend, string pDeviceFilePrefix)
+{
+    VideoDeviceFiles tFiles;
+
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        DIR *tDir = opendir(mDeviceDirectory.c_str());
+        if (tDir == NULL)
+        {
+            LOG(LOG_WARN, "Failed to open device directory %s because of \"%s\"", mDeviceDirectory.c_str(), strerror(errno));
+        }else{
+            struct dirent *tEntry;
+            while ((tEntry = readdir(tDir)) != NULL)
+            {
+                string tFileName = tEntry->d_name;
+                if (IsDeviceFile(tFileName, pDeviceFilePrefix))
+                {
+                    VideoDeviceFileEntry tFile;
+                    tFile.Valid = false;
+                    tFile.Dirty = true;
+                    tFiles[tFileName] = tFile;
+                }
+            }
+            closedir(tDir);
+        }
+    #endif
+
+    LOG(LOG_VERBOSE, "Found %d device files with prefix \"%s\" in %s", (int)tFiles.size(), pDeviceFilePrefix.c_str(), mDeviceDirectory.c_str());
+
+    pBackend.Files = tFiles;
+    pBackend.Scanned = true;
+    pBackend.Timestamp = Time::GetTimeStamp();
+}
+
+bool MediaDeviceRegistry::ProbeDirtyDeviceFiles(string pDeviceFilePrefix)
+{
+    VideoDeviceFileBackends::iterator tBackendIt;
+    VideoDeviceFiles::iterator tFileIt;
+    vector<string> tDirtyFiles;
+    vector<string>::iterator tDirtyIt;
+    VideoDeviceProbe tProbe;
+    string tDeviceDirectory;
+
+    mMutex.lock();
+    tBackendIt = mVideoDeviceFileBackends.find(pDeviceFilePrefix);
+    if (tBackendIt == mVideoDeviceFileBackends.end())
+    {
+        mMutex.unlock();
+        return false;
+    }
+    tProbe = tBackendIt->second.Probe;
+    tDeviceDirectory = mDeviceDirectory;
+    for (tFileIt = tBackendIt->second.Files.begin(); tFileIt != tBackendIt->second.Files.end(); tFileIt++)
+    {
+        if (tFileIt->second.Dirty)
+            tDirtyFiles.push_back(tFileIt->first);
+    }
+    mMutex.unlock();
+
+    // probing opens the devices, this is done without blocking other users of the registry
+    for (tDirtyIt = tDirtyFiles.begin(); tDirtyIt != tDirtyFiles.end(); tDirtyIt++)
+    {
+        VideoDeviceFileEntry tFile;
+        tFile.Dirty = false;
+        tFile.Valid = tProbe(tDeviceDirectory + "/" + *tDirtyIt, tFile.Device, tFile.Capabilities);
+        #ifdef MDR_DEBUG_HOTPLUG
+            LOG(LOG_VERBOSE, "Probed device file %s: %s", tDirtyIt->c_str(), tFile.Valid ? "valid" : "invalid");
+        #endif
+
+        mMutex.lock();
+        tBackendIt = mVideoDeviceFileBackends.find(pDeviceFilePrefix);
+        if ((tBackendIt != mVideoDeviceFileBackends.end()) && (tDeviceDirectory == mDeviceDirectory))
+        {
+            // the file might have been removed in the meantime
+            tFileIt = tBackendIt->second.Files.find(*tDirtyIt);
+            if (tFileIt != tBackendIt->second.Files.end())
+                tFileIt->second = tFile;
+        }
+        mMutex.unlock();
+    }
+
+    return (tDirtyFiles.size() > 0);
+}
+
+void MediaDeviceRegistry::GetVideoDevices(string pDeviceFilePrefix, VideoDeviceProbe pProbe, VideoDevices &pVList)
+{
+    VideoDeviceFileBackends::iterator tBackendIt;
+    VideoDeviceFiles::iterator tFileIt;
+    VideoDevices tDevices;
+
+    RequestHotplugDetection();
+
+    mMutex.lock();
+    tBackendIt = mVideoDeviceFileBackends.find(pDeviceFilePrefix);
+    if (tBackendIt == mVideoDeviceFileBackends.end())
+    {
+        VideoDeviceFileBackend tBackend;
+        tBackend.Scanned = false;
+        tBackend.Timestamp = 0;
+        tBackendIt = mVideoDeviceFileBackends.insert(VideoDeviceFileBackends::value_type(pDeviceFilePrefix, tBackend)).first;
+    }
+    tBackendIt->second.Probe = pProbe;
+    if ((!tBackendIt->second.Scanned) || (!IsCacheValid(tBackendIt->second.Timestamp)))
+        ScanDeviceFiles(tBackendIt->second, pDeviceFilePrefix);
+    mMutex.unlock();
+
+    ProbeDirtyDeviceFiles(pDeviceFilePrefix);
+
+    mMutex.lock();
+    tBackendIt = mVideoDeviceFileBackends.find(pDeviceFilePrefix);
+    for (tFileIt = tBackendIt->second.Files.begin(); tFileIt != tBackendIt->second.Files.end(); tFileIt++)
+    {
+        if (tFileIt->second.Valid)
+            tDevices.push_back(tFileIt->second.Device);
+    }
+    mMutex.unlock();
+
+    sort(tDevices.begin(), tDevices.end(), DeviceFileOrder);
+    pVList.insert(pVList.end(), tDevices.begin(), tDevices.end());
+}
+
+bool MediaDeviceRegistry::GetVideoDeviceCapabilities(string pCard, VideoDeviceCapabilities &pCapabilities)
+{
+    VideoDeviceFileBackends::iterator tBackendIt;
+    VideoDeviceFiles::iterator tFileIt;
+    bool tResult = false;
+
+    mMutex.lock();
+    for (tBackendIt = mVideoDeviceFileBackends.begin(); tBackendIt != mVideoDeviceFileBackends.end(); tBackendIt++)
+    {
+        for (tFileIt = tBackendIt->second.Files.begin(); tFileIt != tBackendIt->second.Files.end(); tFileIt++)
+        {
+            if ((tFileIt->second.Valid) && (tFileIt->second.Device.Card == pCard) && (tFileIt->second.Capabilities.size() > 0))
+            {
+                pCapabilities = tFileIt->second.Capabilities;
+                tResult = true;
+            }
+        }
+    }
+    mMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaDeviceRegistry::GetCachedVideoDevices(string pBackend, VideoDevices &pVList)
+{
+    VideoDeviceListCache::iterator tIt;
+    bool tResult = false;
+
+    RequestHotplugDetection();
+
+    mMutex.lock();
+    tIt = mVideoDeviceListCache.find(pBackend);
+    if ((tIt != mVideoDeviceListCache.end()) && (IsCacheValid(tIt->second.Timestamp)))
+    {
+        pVList.insert(pVList.end(), tIt->second.Devices.begin(), tIt->second.Devices.end());
+        tResult = true;
+    }
+    mMutex.unlock();
+
+    return tResult;
+}
+
+void MediaDeviceRegistry::CacheVideoDevices(string pBackend, const VideoDevices &pVList)
+{
+    MediaDeviceListCacheEntry<VideoDevices> tEntry;
+
+    tEntry.Devices = pVList;
+    tEntry.Timestamp = Time::GetTimeStamp();
+
+    mMutex.lock();
+    mVideoDeviceListCache[pBackend] = tEntry;
+    mMutex.unlock();
+}
+
+bool MediaDeviceRegistry::GetCachedAudioDevices(string pBackend, AudioDevices &pAList)
+{
+    AudioDeviceListCache::iterator tIt;
+    bool tResult = false;
+
+    RequestHotplugDetection();
+
+    mMutex.lock();
+    tIt = mAudioDeviceListCache.find(pBackend);
+    if ((tIt != mAudioDeviceListCache.end()) && (IsCacheValid(tIt->second.Timestamp)))
+    {
+        pAList.insert(pAList.end(), tIt->second.Devices.begin(), tIt->second.Devices.end());
+        tResult = true;
+    }
+    mMutex.unlock();
+
+    return tResult;
+}
+
+void MediaDeviceRegistry::CacheAudioDevices(string pBackend, const AudioDevices &pAList)
+{
+    MediaDeviceListCacheEntry<AudioDevices> tEntry;
+
+    tEntry.Devices = pAList;
+    tEntry.Timestamp = Time::GetTimeStamp();
+
+    mMutex.lock();
+    mAudioDeviceListCache[pBackend] = tEntry;
+    mMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaDeviceRegistry::Invalidate(enum MediaType pMediaType)
+{
+    VideoDeviceFileBackends::iterator tIt;
+
+    LOG(LOG_VERBOSE, "Invalidating cached %s devices", (pMediaType == MEDIA_VIDEO) ? "video" : "audio");
+
+    mMutex.lock();
+    if (pMediaType == MEDIA_VIDEO)
+    {
+        for (tIt = mVideoDeviceFileBackends.begin(); tIt != mVideoDeviceFileBackends.end(); tIt++)
+            tIt->second.Scanned = false;
+        mVideoDeviceListCache.clear();
+    }
+    if (pMediaType == MEDIA_AUDIO)
+        mAudioDeviceListCache.clear();
+    mGeneration++;
+    mMutex.unlock();
+
+    NotifyObservers(pMediaType);
+}
+
+bool MediaDeviceRegistry::InvalidateDeviceFile(string pFileName, bool pRemoved)
+{
+    VideoDeviceFileBackends::iterator tIt;
+    VideoDeviceFiles::iterator tFileIt;
+    bool tResult = false;
+
+    mMutex.lock();
+    for (tIt = mVideoDeviceFileBackends.begin(); tIt != mVideoDeviceFileBackends.end(); tIt++)
+    {
+        // backends which haven't scanned yet will see the file with their first scan
+        if ((!tIt->second.Scanned) || (!IsDeviceFile(pFileName, tIt->first)))
+            continue;
+
+        tFileIt = tIt->second.Files.find(pFileName);
+        if (pRemoved)
+        {
+            if (tFileIt != tIt->second.Files.end())
+                tIt->second.Files.erase(tFileIt);
+        }else{
+            VideoDeviceFileEntry tFile;
+            tFile.Valid = false;
+            tFile.Dirty = true;
+            tIt->second.Files[pFileName] = tFile;
+        }
+        tResult = true;
+    }
+    if (tResult)
+    {
+        // the complete lists contain the per-file devices as well
+        mVideoDeviceListCache.clear();
+        mGeneration++;
+    }
+    mMutex.unlock();
+
+    return tResult;
+}
+
+int64_t MediaDeviceRegistry::GetGeneration()
+{
+    return mGeneration;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaDeviceRegistry::AddObserver(MediaDeviceObserver *pObserver)
+{
+    mObserversMutex.lock();
+    mObservers.push_back(pObserver);
+    mObserversMutex.unlock();
+}
+
+void MediaDeviceRegistry::RemoveObserver(MediaDeviceObserver *pObserver)
+{
+    mObserversMutex.lock();
+    mObservers.remove(pObserver);
+    mObserversMutex.unlock();
+}
+
+void MediaDeviceRegistry::NotifyObservers(enum MediaType pMediaType)
+{
+    MediaDeviceObservers::iterator tIt;
+
+    mObserversMutex.lock();
+    for (tIt = mObservers.begin(); tIt != mObservers.end(); tIt++)
+        (*tIt)->MediaDevicesChanged(pMediaType);
+    mObserversMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void* MediaDeviceRegistry::Run(void* pArgs)
+{
+    #if defined(LINUX)
+        VideoDeviceFileBackends::iterator tBackendIt;
+        vector<string> tPrefixes;
+        vector<string>::iterator tPrefixIt;
+        char tBuffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        struct inotify_event *tEvent;
+        struct pollfd tPollFd;
+        ssize_t tLength;
+
+        SVC_PROCESS_STATISTIC.AssignThreadName("Device-Hotplug");
+
+        while (mHotplugDetectionNeeded)
+        {
+            tPollFd.fd = mInotifyFd;
+            tPollFd.events = POLLIN;
+            tPollFd.revents = 0;
+            // the timeout allows a fast reaction on StopHotplugDetection()
+            if (poll(&tPollFd, 1, 250) <= 0)
+                continue;
+
+            tLength = read(mInotifyFd, tBuffer, sizeof(tBuffer));
+            if (tLength <= 0)
+                continue;
+
+            bool tVideoChanged = false;
+            bool tAudioChanged = false;
+            for (char *tPtr = tBuffer; tPtr < tBuffer + tLength; tPtr += sizeof(struct inotify_event) + tEvent->len)
+            {
+                tEvent = (struct inotify_event*)tPtr;
+                if ((tEvent->len == 0) || (tEvent->mask & IN_IGNORED))
+                    continue;
+
+                string tFileName = tEvent->name;
+                bool tRemoved = ((tEvent->mask & (IN_DELETE | IN_MOVED_FROM)) != 0);
+
+                #ifdef MDR_DEBUG_HOTPLUG
+                    LOG(LOG_VERBOSE, "Got inotify event 0x%x for %s%s", tEvent->mask, (tEvent->wd == mSoundWatch) ? "sound device " : "", tFileName.c_str());
+                #endif
+
+                if (tEvent->wd == mSoundWatch)
+                {
+                    tAudioChanged = true;
+                    continue;
+                }
+
+                if (tFileName == MEDIA_DEVICE_REGISTRY_SOUND_DIRECTORY)
+                {
+                    // the sound directory is created with the first sound device
+                    mMutex.lock();
+                    if (!tRemoved)
+                        mSoundWatch = inotify_add_watch(mInotifyFd, (mDeviceDirectory + "/" + MEDIA_DEVICE_REGISTRY_SOUND_DIRECTORY).c_str(), IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO);
+                    mMutex.unlock();
+                    tAudioChanged = true;
+                    continue;
+                }
+
+                // OSS devices are located directly in the device directory
+                if ((tFileName.compare(0, 3, "dsp") == 0) || (tFileName.compare(0, 5, "mixer") == 0))
+                    tAudioChanged = true;
+
+                if (InvalidateDeviceFile(tFileName, tRemoved))
+                    tVideoChanged = true;
+            }
+
+            if (tVideoChanged)
+            {
+                LOG(LOG_VERBOSE, "Video devices have changed, probing again");
+
+                mMutex.lock();
+                tPrefixes.clear();
+                for (tBackendIt = mVideoDeviceFileBackends.begin(); tBackendIt != mVideoDeviceFileBackends.end(); tBackendIt++)
+                    tPrefixes.push_back(tBackendIt->first);
+                mMutex.unlock();
+
+                // probe here instead of within the next enumeration of the user
+                for (tPrefixIt = tPrefixes.begin(); tPrefixIt != tPrefixes.end(); tPrefixIt++)
+                    ProbeDirtyDeviceFiles(*tPrefixIt);
+
+                NotifyObservers(MEDIA_VIDEO);
+            }
+            if (tAudioChanged)
+            {
+                LOG(LOG_VERBOSE, "Audio devices have changed");
+                Invalidate(MEDIA_AUDIO);
+            }
+        }
+    #endif
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -0,0 +1,681 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of the per-host calibration of the video encoder speed settings
+ * Since:   2014-02-14
+ */
+
+#include <MediaEncoderCalibration.h>
+#include <MediaSource.h>
+#include <HBSystem.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(LINUX) || defined(APPLE) || defined(BSD)
+#include <unistd.h>
+#endif
+
+namespace Homer { namespace Multimedia {
+
+using namespace Homer::Base;
+using namespace std;
+
+MediaEncoderCalibration sMediaEncoderCalibration;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// speed settings of the supported encoders, the base options correspond to the real-time settings of the muxer
+struct EncoderSpeedOptions
+{
+    const char      *Encoder;
+    const char      *Option;
+    const char      *Values[8]; /* from the fastest to the slowest setting, NULL terminated */
+    const char      *BaseOptions; /* "key=value;key=value" */
+};
+
+static const EncoderSpeedOptions sEncoderSpeedOptions[] = {
+    {"libx264",     "preset",   {"ultrafast", "superfast", "veryfast", "faster", "fast", "medium", NULL}, ""},
+    {"libx265",     "preset",   {"ultrafast", "superfast", "veryfast", "faster", "fast", "medium", NULL}, ""},
+    {"libvpx-vp9",  "cpu-used", {"8", "7", "6", "5", "4", NULL}, "deadline=realtime;lag-in-frames=0;auto-alt-ref=0;row-mt=1;error-resilient=1"},
+    {"libaom-av1",  "cpu-used", {"10", "9", "8", "7", "6", NULL}, "usage=realtime;lag-in-frames=0;row-mt=1"},
+    {"libsvtav1",   "preset",   {"13", "12", "11", "10", "9", "8", NULL}, ""},
+    {"librav1e",    "speed",    {"10", "9", "8", "7", "6", NULL}, ""},
+};
+
+#define ENCODER_SPEED_OPTIONS_COUNT                     ((int)(sizeof(sEncoderSpeedOptions) / sizeof(sEncoderSpeedOptions[0])))
+
+// calibrated formats if nothing else is configured
+static const EncoderCalibrationFormat sDefaultFormats[] = {
+    {352, 288, 30},
+    {640, 480, 30},
+    {1280, 720, 30},
+    {1920, 1080, 30},
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaEncoderCalibration::MediaEncoderCalibration()
+{
+    mTableFile = GetDefaultTableFile();
+    mTableLoaded = false;
+}
+
+MediaEncoderCalibration::~MediaEncoderCalibration()
+{
+}
+
+MediaEncoderCalibration& MediaEncoderCalibration::GetInstance()
+{
+    return sMediaEncoderCalibration;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+string MediaEncoderCalibration::GetDefaultTableFile()
+{
+    const char *tHome = getenv("HOME");
+
+    #if defined(WINDOWS)
+        if (tHome == NULL)
+            tHome = getenv("USERPROFILE");
+    #endif
+
+    if (tHome == NULL)
+        return MEDIA_ENCODER_CALIBRATION_DEFAULT_FILE;
+
+    return string(tHome) + "/" + MEDIA_ENCODER_CALIBRATION_DEFAULT_FILE;
+}
+
+string MediaEncoderCalibration::GetHostDescription()
+{
+    char tHostName[256];
+
+    tHostName[0] = 0;
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        if (gethostname(tHostName, sizeof(tHostName)) != 0)
+            tHostName[0] = 0;
+        tHostName[sizeof(tHostName) - 1] = 0;
+    #endif
+    #if defined(WINDOWS)
+        const char *tComputerName = getenv("COMPUTERNAME");
+        if (tComputerName != NULL)
+        {
+            strncpy(tHostName, tComputerName, sizeof(tHostName) - 1);
+            tHostName[sizeof(tHostName) - 1] = 0;
+        }
+    #endif
+
+    // a table of another machine or of a resized container is useless
+    return string(tHostName) + "/" + System::GetMachineType() + "/" + toString(System::GetEffectiveCores());
+}
+
+void MediaEncoderCalibration::SetTableFile(string pFileName)
+{
+    mMutex.lock();
+    if (mTableFile != pFileName)
+    {
+        LOG(LOG_VERBOSE, "Using calibration table %s", pFileName.c_str());
+        mTableFile = pFileName;
+        mTableLoaded = false;
+        mTable.clear();
+    }
+    mMutex.unlock();
+}
+
+string MediaEncoderCalibration::GetTableFile()
+{
+    string tResult;
+
+    mMutex.lock();
+    tResult = mTableFile;
+    mMutex.unlock();
+
+    return tResult;
+}
+
+bool MediaEncoderCalibration::LoadTable()
+{
+    FILE *tFile;
+    char tLine[512];
+    bool tResult = false;
+    bool tHostMatches = false;
+
+    mMutex.lock();
+
+    mTable.clear();
+    mTableLoaded = true;
+
+    if ((tFile = fopen(mTableFile.c_str(), "r")) == NULL)
+    {
+        LOG(LOG_VERBOSE, "No encoder calibration table found in %s", mTableFile.c_str());
+        mMutex.unlock();
+        return false;
+    }
+
+    string tHost = GetHostDescription();
+    while (fgets(tLine, sizeof(tLine), tFile) != NULL)
+    {
+        char tHostName[256];
+        char tEncoder[64], tFastestValue[32], tBestValue[32];
+        EncoderCalibrationEntry tEntry;
+        int tRealtime;
+
+        if ((tLine[0] == '#') || (tLine[0] == '\n'))
+            continue;
+
+        if (sscanf(tLine, "Host %255s", tHostName) == 1)
+        {
+            tHostMatches = (tHost == tHostName);
+            if (!tHostMatches)
+                LOG(LOG_WARN, "Ignoring encoder calibration table of host %s, this host is %s", tHostName, tHost.c_str());
+            continue;
+        }
+
+        if (!tHostMatches)
+            continue;
+
+        if (sscanf(tLine, "%63s %dx%d@%d %d %31s %d %f %31s %d %f", tEncoder, &tEntry.Format.ResX, &tEntry.Format.ResY, &tEntry.Format.Fps, &tRealtime, tFastestValue, &tEntry.FastestSufficient.Threads, &tEntry.FastestSufficient.FrameTime, tBestValue, &tEntry.BestAffordable.Threads, &tEntry.BestAffordable.FrameTime) != 11)
+        {
+            LOG(LOG_WARN, "Invalid line in encoder calibration table: %s", tLine);
+            continue;
+        }
+
+        int tEncoderIndex = GetEncoderIndex(tEncoder);
+        if (tEncoderIndex < 0)
+            continue;
+
+        tEntry.Encoder = tEncoder;
+        tEntry.Realtime = (tRealtime != 0);
+        tEntry.FastestSufficient.Option = sEncoderSpeedOptions[tEncoderIndex].Option;
+        tEntry.FastestSufficient.Value = (strcmp(tFastestValue, "-") != 0) ? tFastestValue : "";
+        tEntry.BestAffordable.Option = sEncoderSpeedOptions[tEncoderIndex].Option;
+        tEntry.BestAffordable.Value = (strcmp(tBestValue, "-") != 0) ? tBestValue : "";
+        mTable.push_back(tEntry);
+        tResult = true;
+    }
+    fclose(tFile);
+
+    LOG(LOG_VERBOSE, "Loaded %d entries from encoder calibration table %s", (int)mTable.size(), mTableFile.c_str());
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+// caller has to lock mMutex
+bool MediaEncoderCalibration::SaveTable()
+{
+    FILE *tFile;
+    EncoderCalibrationTable::iterator tIt;
+
+    if ((tFile = fopen(mTableFile.c_str(), "w")) == NULL)
+    {
+        LOG(LOG_ERROR, "Couldn't write encoder calibration table %s because \"%s\"", mTableFile.c_str(), strerror(errno));
+        return false;
+    }
+
+    fprintf(tFile, "# encoder calibration table: encoder, format, real-time, fastest-sufficient and best-affordable setting (value, threads, ms per frame)\n");
+    fprintf(tFile, "Host %s\n", GetHostDescription().c_str());
+    for (tIt = mTable.begin(); tIt != mTable.end(); tIt++)
+    {
+        fprintf(tFile, "%s %dx%d@%d %d %s %d %.2f %s %d %.2f\n", tIt->Encoder.c_str(), tIt->Format.ResX, tIt->Format.ResY, tIt->Format.Fps, tIt->Realtime ? 1 : 0,
+                (tIt->FastestSufficient.Value != "") ? tIt->FastestSufficient.Value.c_str() : "-", tIt->FastestSufficient.Threads, tIt->FastestSufficient.FrameTime,
+                (tIt->BestAffordable.Value != "") ? tIt->BestAffordable.Value.c_str() : "-", tIt->BestAffordable.Threads, tIt->BestAffordable.FrameTime);
+    }
+    fclose(tFile);
+
+    LOG(LOG_INFO, "Stored %d entries in encoder calibration table %s", (int)mTable.size(), mTableFile.c_str());
+
+    return true;
+}
+
+EncoderCalibrationTable MediaEncoderCalibration::GetTable()
+{
+    EncoderCalibrationTable tResult;
+
+    if (!mTableLoaded)
+        LoadTable();
+
+    mMutex.lock();
+    tResult = mTable;
+    mMutex.unlock();
+
+    return tResult;
+}
+
+string MediaEncoderCalibration::GetTableDescription()
+{
+    EncoderCalibrationTable tTable = GetTable();
+    EncoderCalibrationTable::iterator tIt;
+    char tLine[256];
+    string tResult;
+
+    tResult = "Encoder calibration of host " + GetHostDescription() + " (" + GetTableFile() + ")\n";
+    snprintf(tLine, sizeof(tLine), "%-12s %-16s %-9s %-28s %-28s\n", "encoder", "format", "real-time", "fastest-sufficient", "best-affordable");
+    tResult += tLine;
+    for (tIt = tTable.begin(); tIt != tTable.end(); tIt++)
+    {
+        char tFormat[32], tFastest[64], tBest[64];
+        snprintf(tFormat, sizeof(tFormat), "%dx%d@%d", tIt->Format.ResX, tIt->Format.ResY, tIt->Format.Fps);
+        snprintf(tFastest, sizeof(tFastest), "%s=%s, %d thr., %.1f ms", tIt->FastestSufficient.Option.c_str(), tIt->FastestSufficient.Value.c_str(), tIt->FastestSufficient.Threads, tIt->FastestSufficient.FrameTime);
+        if (tIt->BestAffordable.Value != "")
+            snprintf(tBest, sizeof(tBest), "%s=%s, %d thr., %.1f ms", tIt->BestAffordable.Option.c_str(), tIt->BestAffordable.Value.c_str(), tIt->BestAffordable.Threads, tIt->BestAffordable.FrameTime);
+        else
+            snprintf(tBest, sizeof(tBest), "-");
+        snprintf(tLine, sizeof(tLine), "%-12s %-16s %-9s %-28s %-28s\n", tIt->Encoder.c_str(), tFormat, tIt->Realtime ? "yes" : "no", tFastest, tBest);
+        tResult += tLine;
+    }
+    if (tTable.size() == 0)
+        tResult += "(not calibrated)\n";
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+EncoderCalibrationFormats MediaEncoderCalibration::GetDefaultFormats()
+{
+    EncoderCalibrationFormats tResult;
+
+    for (unsigned int i = 0; i < sizeof(sDefaultFormats) / sizeof(sDefaultFormats[0]); i++)
+        tResult.push_back(sDefaultFormats[i]);
+
+    return tResult;
+}
+
+int MediaEncoderCalibration::GetEncoderIndex(string pEncoder)
+{
+    for (int i = 0; i < ENCODER_SPEED_OPTIONS_COUNT; i++)
+    {
+        if (pEncoder == sEncoderSpeedOptions[i].Encoder)
+            return i;
+    }
+
+    return -1;
+}
+
+vector<int> MediaEncoderCalibration::GetThreadCounts()
+{
+    vector<int> tResult;
+    int tCores = System::GetEffectiveCores();
+    int tCandidates[] = {1, tCores / 2, tCores - 2 /* default of the muxer */, tCores};
+
+    for (unsigned int i = 0; i < sizeof(tCandidates) / sizeof(tCandidates[0]); i++)
+    {
+        if ((tCandidates[i] >= 1) && (find(tResult.begin(), tResult.end(), tCandidates[i]) == tResult.end()))
+            tResult.push_back(tCandidates[i]);
+    }
+    sort(tResult.begin(), tResult.end());
+
+    return tResult;
+}
+
+// caller has to lock mMutex
+EncoderCalibrationEntry *MediaEncoderCalibration::FindEntry(string pEncoder, EncoderCalibrationFormat pFormat)
+{
+    EncoderCalibrationTable::iterator tIt;
+
+    for (tIt = mTable.begin(); tIt != mTable.end(); tIt++)
+    {
+        if ((tIt->Encoder == pEncoder) && (tIt->Format.ResX == pFormat.ResX) && (tIt->Format.ResY == pFormat.ResY) && (tIt->Format.Fps == pFormat.Fps))
+            return &(*tIt);
+    }
+
+    return NULL;
+}
+
+static bool CompareFormatsByPixelRate(const EncoderCalibrationFormat &pFirst, const EncoderCalibrationFormat &pSecond)
+{
+    return ((int64_t)pFirst.ResX * pFirst.ResY * pFirst.Fps < (int64_t)pSecond.ResX * pSecond.ResY * pSecond.Fps);
+}
+
+bool MediaEncoderCalibration::Calibrate(EncoderCalibrationFormats pFormats, bool pForce)
+{
+    bool tResult = false;
+
+    if (!mTableLoaded)
+        LoadTable();
+
+    MediaSource::FfmpegInit();
+
+    // a format which isn't real-time for an encoder isn't real-time at higher pixel rates either
+    sort(pFormats.begin(), pFormats.end(), CompareFormatsByPixelRate);
+
+    mMutex.lock();
+
+    for (int e = 0; e < ENCODER_SPEED_OPTIONS_COUNT; e++)
+    {
+        AVCodec *tCodec = avcodec_find_encoder_by_name(sEncoderSpeedOptions[e].Encoder);
+        bool tRealtimePossible = true;
+
+        if (tCodec == NULL)
+        {
+            LOG(LOG_VERBOSE, "Encoder %s isn't available, skipping its calibration", sEncoderSpeedOptions[e].Encoder);
+            continue;
+        }
+
+        for (EncoderCalibrationFormats::iterator tIt = pFormats.begin(); tIt != pFormats.end(); tIt++)
+        {
+            EncoderCalibrationEntry *tExistingEntry = FindEntry(tCodec->name, *tIt);
+            EncoderCalibrationEntry tEntry;
+
+            if ((tExistingEntry != NULL) && (!pForce))
+            {
+                tRealtimePossible = tExistingEntry->Realtime;
+                continue;
+            }
+
+            if (tRealtimePossible)
+            {
+                LOG(LOG_INFO, "Calibrating encoder %s for %dx%d at %d fps..", tCodec->name, tIt->ResX, tIt->ResY, tIt->Fps);
+                tEntry = CalibrateEncoder(e, tCodec, *tIt);
+            }else
+            {// use the fastest setting without further measurements
+                tEntry.Encoder = tCodec->name;
+                tEntry.Format = *tIt;
+                tEntry.Realtime = false;
+                tEntry.FastestSufficient.Option = sEncoderSpeedOptions[e].Option;
+                tEntry.FastestSufficient.Value = sEncoderSpeedOptions[e].Values[0];
+                tEntry.FastestSufficient.Threads = GetThreadCounts().back();
+                tEntry.FastestSufficient.FrameTime = 0;
+                tEntry.BestAffordable.Option = sEncoderSpeedOptions[e].Option;
+                tEntry.BestAffordable.Value = "";
+                tEntry.BestAffordable.Threads = 0;
+                tEntry.BestAffordable.FrameTime = 0;
+            }
+            tRealtimePossible = tEntry.Realtime;
+
+            if (tExistingEntry != NULL)
+                *tExistingEntry = tEntry;
+            else
+                mTable.push_back(tEntry);
+            tResult = true;
+        }
+    }
+
+    if (tResult)
+        tResult = SaveTable();
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+EncoderCalibrationEntry MediaEncoderCalibration::CalibrateEncoder(int pEncoderIndex, AVCodec *pCodec, EncoderCalibrationFormat pFormat)
+{
+    EncoderCalibrationEntry tResult;
+    const EncoderSpeedOptions &tSpeedOptions = sEncoderSpeedOptions[pEncoderIndex];
+    vector<int> tThreadCounts = GetThreadCounts();
+    float tFramePeriod = 1000.0 / pFormat.Fps; // in ms
+    int tBestValueIndex = -1;
+    float tMinFrameTime = 0;
+
+    tResult.Encoder = pCodec->name;
+    tResult.Format = pFormat;
+    tResult.Realtime = false;
+    tResult.FastestSufficient.Option = tSpeedOptions.Option;
+    tResult.FastestSufficient.Value = "";
+    tResult.FastestSufficient.Threads = 0;
+    tResult.FastestSufficient.FrameTime = 0;
+    tResult.BestAffordable = tResult.FastestSufficient;
+
+    // more threads never make a setting more expensive in terms of latency, hence start with the cheapest combination
+    for (vector<int>::iterator tIt = tThreadCounts.begin(); tIt != tThreadCounts.end(); tIt++)
+    {
+        for (int v = 0; tSpeedOptions.Values[v] != NULL; v++)
+        {
+            float tFrameTime;
+
+            if (!MeasureEncoder(pEncoderIndex, pCodec, v, *tIt, pFormat, tFrameTime))
+                continue;
+
+            // the fastest setting at all is the fallback if nothing meets real time
+            if ((!tResult.Realtime) && ((tResult.FastestSufficient.Value == "") || (tFrameTime < tMinFrameTime)))
+            {
+                tMinFrameTime = tFrameTime;
+                tResult.FastestSufficient.Value = tSpeedOptions.Values[v];
+                tResult.FastestSufficient.Threads = *tIt;
+                tResult.FastestSufficient.FrameTime = tFrameTime;
+            }
+
+            // slower settings of this thread count won't meet real time either
+            if (tFrameTime > tFramePeriod * MEDIA_ENCODER_CALIBRATION_REALTIME_SHARE)
+                break;
+
+            if (!tResult.Realtime)
+            {// cheapest sufficient setting: fewest threads at the fastest setting
+                tResult.Realtime = true;
+                tResult.FastestSufficient.Value = tSpeedOptions.Values[v];
+                tResult.FastestSufficient.Threads = *tIt;
+                tResult.FastestSufficient.FrameTime = tFrameTime;
+            }
+
+            if ((tFrameTime <= tFramePeriod * MEDIA_ENCODER_CALIBRATION_AFFORDABLE_SHARE) && (v > tBestValueIndex))
+            {// most efficient setting so far
+                tBestValueIndex = v;
+                tResult.BestAffordable.Value = tSpeedOptions.Values[v];
+                tResult.BestAffordable.Threads = *tIt;
+                tResult.BestAffordable.FrameTime = tFrameTime;
+            }
+        }
+    }
+
+    LOG(LOG_INFO, "..%s at %dx%d@%d: fastest-sufficient %s=%s with %d threads (%.1f ms), best-affordable %s=%s with %d threads (%.1f ms), frame period: %.1f ms", pCodec->name, pFormat.ResX, pFormat.ResY, pFormat.Fps,
+            tSpeedOptions.Option, tResult.FastestSufficient.Value.c_str(), tResult.FastestSufficient.Threads, tResult.FastestSufficient.FrameTime,
+            tSpeedOptions.Option, tResult.BestAffordable.Value.c_str(), tResult.BestAffordable.Threads, tResult.BestAffordable.FrameTime, tFramePeriod);
+
+    return tResult;
+}
+
+bool MediaEncoderCalibration::MeasureEncoder(int pEncoderIndex, AVCodec *pCodec, int pValueIndex, int pThreads, EncoderCalibrationFormat pFormat, float &pFrameTime)
+{
+    const EncoderSpeedOptions &tSpeedOptions = sEncoderSpeedOptions[pEncoderIndex];
+    AVDictionary *tOptions = NULL;
+    int tRes;
+
+    AVCodecContext *tCodecContext = avcodec_alloc_context3(pCodec);
+    if (tCodecContext == NULL)
+        return false;
+    tCodecContext->width = pFormat.ResX;
+    tCodecContext->height = pFormat.ResY;
+    tCodecContext->pix_fmt = PIX_FMT_YUV420P;
+    tCodecContext->time_base = (AVRational){1, pFormat.Fps};
+    tCodecContext->bit_rate = (int64_t)pFormat.ResX * pFormat.ResY * pFormat.Fps / 10; // 0.1 bit per pixel
+    tCodecContext->gop_size = 12;
+    tCodecContext->thread_count = pThreads;
+    av_dict_parse_string(&tOptions, tSpeedOptions.BaseOptions, "=", ";", 0);
+    av_dict_set(&tOptions, "threads", toString(pThreads).c_str(), 0);
+    av_dict_set(&tOptions, tSpeedOptions.Option, tSpeedOptions.Values[pValueIndex], 0);
+    if ((tRes = HM_avcodec_open(tCodecContext, pCodec, &tOptions)) < 0)
+    {
+        LOG(LOG_WARN, "Couldn't open encoder %s with %s=%s because \"%s\"", pCodec->name, tSpeedOptions.Option, tSpeedOptions.Values[pValueIndex], strerror(AVUNERROR(tRes)));
+        av_dict_free(&tOptions);
+        av_free(tCodecContext);
+        return false;
+    }
+    av_dict_free(&tOptions);
+
+    int tPictureSize = avpicture_get_size(PIX_FMT_YUV420P, pFormat.ResX, pFormat.ResY);
+    uint8_t *tPicture = (uint8_t*)av_malloc(tPictureSize + FF_INPUT_BUFFER_PADDING_SIZE);
+    AVFrame *tFrame = MediaSource::AllocFrame();
+    if ((tPicture == NULL) || (tFrame == NULL))
+    {
+        LOG(LOG_ERROR, "Memory allocation failed");
+        av_free(tPicture);
+        av_free(tFrame);
+        avcodec_close(tCodecContext);
+        av_free(tCodecContext);
+        return false;
+    }
+    MediaSource::FillFrame(tFrame, tPicture, PIX_FMT_YUV420P, pFormat.ResX, pFormat.ResY);
+
+    // the frames are encoded as fast as possible, the time for creating the pictures isn't counted
+    int64_t tEncodingTime = 0;
+    bool tResult = true;
+    for (int f = 0; f <= MEDIA_ENCODER_CALIBRATION_FRAMES; f++)
+    {
+        bool tFlushing = (f == MEDIA_ENCODER_CALIBRATION_FRAMES);
+        int tGotPacket = 0;
+        AVPacket tPacket;
+
+        if (!tFlushing)
+        {
+            CreateSyntheticPicture(tFrame, pFormat.ResX, pFormat.ResY, f);
+            tFrame->pts = f;
+        }
+
+        do{
+            av_init_packet(&tPacket);
+            tPacket.data = NULL;
+            tPacket.size = 0;
+
+            int64_t tStartTime = Time::GetTimeStamp();
+            tRes = HM_avcodec_encode_video2(tCodecContext, &tPacket, tFlushing ? NULL : tFrame, &tGotPacket);
+            tEncodingTime += Time::GetTimeStamp() - tStartTime;
+            if (tRes < 0)
+            {
+                tResult = false;
+                break;
+            }
+            if (!tGotPacket)
+                break;
+            av_free_packet(&tPacket);
+        }while ((tFlushing) && (pCodec->capabilities & CODEC_CAP_DELAY));
+
+        if (!tResult)
+            break;
+    }
+
+    av_free(tFrame);
+    av_free(tPicture);
+    avcodec_close(tCodecContext);
+    av_free(tCodecContext);
+
+    pFrameTime = (float)tEncodingTime / 1000 / MEDIA_ENCODER_CALIBRATION_FRAMES;
+
+    #ifdef MEC_DEBUG_MEASUREMENTS
+        LOG(LOG_VERBOSE, "Encoder %s with %s=%s and %d threads needs %.2f ms per frame at %dx%d", pCodec->name, tSpeedOptions.Option, tSpeedOptions.Values[pValueIndex], pThreads, pFrameTime, pFormat.ResX, pFormat.ResY);
+    #endif
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaEncoderCalibration::GetSetting(string pEncoder, int pResX, int pResY, float pFps, EncoderSetting &pSetting, bool &pRealtime)
+{
+    EncoderCalibrationTable::iterator tIt;
+    EncoderCalibrationEntry *tEntry = NULL;
+    double tPixelRate = (double)pResX * pResY * pFps;
+
+    if (!mTableLoaded)
+        LoadTable();
+
+    mMutex.lock();
+
+    // the entry with the smallest pixel rate which isn't below the requested one
+    for (tIt = mTable.begin(); tIt != mTable.end(); tIt++)
+    {
+        double tEntryPixelRate = (double)tIt->Format.ResX * tIt->Format.ResY * tIt->Format.Fps;
+        if ((tIt->Encoder == pEncoder) && (tEntryPixelRate >= tPixelRate) && ((tEntry == NULL) || (tEntryPixelRate < (double)tEntry->Format.ResX * tEntry->Format.ResY * tEntry->Format.Fps)))
+            tEntry = &(*tIt);
+    }
+
+    if (tEntry != NULL)
+    {
+        pRealtime = tEntry->Realtime;
+        pSetting = (tEntry->BestAffordable.Value != "") ? tEntry->BestAffordable : tEntry->FastestSufficient;
+    }
+
+    mMutex.unlock();
+
+    return ((tEntry != NULL) && (pSetting.Value != ""));
+}
+
+bool MediaEncoderCalibration::GetMaxRealtimeResolution(string pEncoder, float pFps, int &pResX, int &pResY)
+{
+    EncoderCalibrationTable::iterator tIt;
+    bool tResult = false;
+
+    if (!mTableLoaded)
+        LoadTable();
+
+    mMutex.lock();
+
+    pResX = 0;
+    pResY = 0;
+    for (tIt = mTable.begin(); tIt != mTable.end(); tIt++)
+    {
+        if ((tIt->Encoder == pEncoder) && (tIt->Realtime) && (tIt->Format.Fps >= pFps) && (tIt->Format.ResX * tIt->Format.ResY > pResX * pResY))
+        {
+            pResX = tIt->Format.ResX;
+            pResY = tIt->Format.ResY;
+            tResult = true;
+        }
+    }
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaEncoderCalibration::CreateSyntheticPicture(AVFrame *pFrame, int pWidth, int pHeight, int pIndex)
+{
+    int tSquareSize = pHeight / 4;
+    int tSquareX = (pIndex * 4) % (pWidth - tSquareSize);
+    int tSquareY = (pIndex * 2) % (pHeight - tSquareSize);
+
+    for (int y = 0; y < pHeight; y++)
+    {
+        uint8_t *tLine = pFrame->data[0] + y * pFrame->linesize[0];
+        for (int x = 0; x < pWidth; x++)
+            tLine[x] = (uint8_t)(x + y + 3 * pIndex);
+    }
+    for (int y = 0; y < tSquareSize; y++)
+    {
+        uint8_t *tLine = pFrame->data[0] + (tSquareY + y) * pFrame->linesize[0] + tSquareX;
+        for (int x = 0; x < tSquareSize; x++)
+            tLine[x] = (uint8_t)(((x ^ y) * 37) & 0xFF);
+    }
+    for (int y = 0; y < pHeight / 2; y++)
+    {
+        uint8_t *tLineU = pFrame->data[1] + y * pFrame->linesize[1];
+        uint8_t *tLineV = pFrame->data[2] + y * pFrame->linesize[2];
+        for (int x = 0; x < pWidth / 2; x++)
+        {
+            tLineU[x] = (uint8_t)(128 + x / 4 - pIndex);
+            tLineV[x] = (uint8_t)(y / 2 + pIndex);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
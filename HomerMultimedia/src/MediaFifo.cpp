@@ -26,9 +26,11 @@
 
 #include <Header_Ffmpeg.h>
 #include <MediaFifo.h>
+#include <MediaMemoryBudget.h>
 #include <Logger.h>
 
 #include <string.h> // memcpy
+#include <vector>
 
 namespace Homer { namespace Multimedia {
 
@@ -41,6 +43,8 @@ MediaFifo::MediaFifo(std::string pName)
 {
     mName = pName;
     mFifoSize = 0;
+    mFifoMaxSize = 0;
+    mFifoDesiredSize = 0;
     mFifoEntrySize = 0;
     mFifoWritePtr = 0;
     mFifoReadPtr = 0;
@@ -55,6 +59,8 @@ MediaFifo::MediaFifo(int pFifoSize, int pFifoEntrySize, string pName)
 
     mName = pName;
     mFifoSize = pFifoSize;
+    mFifoMaxSize = pFifoSize;
+    mFifoDesiredSize = pFifoSize;
     mFifoEntrySize = pFifoEntrySize;
     mFifoWritePtr = 0;
     mFifoReadPtr = 0;
@@ -68,6 +74,8 @@ MediaFifo::MediaFifo(int pFifoSize, int pFifoEntrySize, string pName)
             LOG(LOG_ERROR, "Unable to allocate %d bytes of memory for FIFO %s", mFifoEntrySize, pName.c_str());
     }
     LOG(LOG_VERBOSE, "Created FIFO for %s with %d entries of %d bytes", pName.c_str(), mFifoSize, mFifoEntrySize);
+
+    SVC_MEDIA_MEMORY_BUDGET.RegisterFifo(this);
 }
 
 MediaFifo::~MediaFifo()
@@ -76,7 +84,9 @@ MediaFifo::~MediaFifo()
 
     if (mFifo != NULL)
     {
-        for (int i = 0; i < mFifoSize; i++)
+        SVC_MEDIA_MEMORY_BUDGET.UnregisterFifo(this);
+
+        for (int i = 0; i < mFifoMaxSize; i++)
         {
             mFifo[i].Size = 0;
             av_free(mFifo[i].Data);
@@ -208,6 +218,119 @@ int MediaFifo::GetSize()
     return tResult;
 }
 
+bool MediaFifo::Resize(int pFifoSize)
+{
+    bool tResult = false;
+
+    // abstract FIFOs don't own any memory
+    if (mFifoMaxSize == 0)
+        return false;
+
+    if (pFifoSize > mFifoMaxSize)
+        pFifoSize = mFifoMaxSize;
+    if (pFifoSize < 1)
+        pFifoSize = 1;
+
+    mFifoMutex.lock();
+
+    mFifoDesiredSize = pFifoSize;
+    if (mFifoDesiredSize != mFifoSize)
+        tResult = DoResize();
+    else
+        tResult = true;
+
+    mFifoMutex.unlock();
+
+    return tResult;
+}
+
+bool MediaFifo::DoResize()
+{
+    int i;
+
+    // no entry may be accessed by a reader or writer at the moment (we wait 1 ms per entry), otherwise we try it again with the next write access
+    for (i = 0; i < mFifoMaxSize; i++)
+    {
+        if (!mFifo[i].EntryMutex.lock(1))
+            break;
+    }
+    if (i < mFifoMaxSize)
+    {
+        #ifdef MF_DEBUG
+            LOG(LOG_VERBOSE, "%s-FIFO: entry %d is busy, delaying resize to %d entries", mName.c_str(), i, mFifoDesiredSize);
+        #endif
+        while (--i >= 0)
+            mFifo[i].EntryMutex.unlock();
+        return false;
+    }
+
+    LOG(LOG_VERBOSE, "%s-FIFO: resizing from %d to %d entries of %d bytes", mName.c_str(), mFifoSize, mFifoDesiredSize, mFifoEntrySize);
+
+    // keep the newest entries
+    int tKeptEntries = (mFifoAvailableEntries < mFifoDesiredSize) ? mFifoAvailableEntries : mFifoDesiredSize;
+    int tFirstKeptEntry = (mFifoReadPtr + mFifoAvailableEntries - tKeptEntries) % mFifoSize;
+    if (tKeptEntries < mFifoAvailableEntries)
+        LOG(LOG_VERBOSE, "%s-FIFO: dropping %d oldest entries because of resize", mName.c_str(), mFifoAvailableEntries - tKeptEntries);
+
+    // reorder the entries: kept entries in FIFO order first, afterwards all other buffers
+    std::vector<char*> tData;
+    std::vector<int> tSize;
+    std::vector<int64_t> tNumber;
+    for (i = 0; i < mFifoMaxSize; i++)
+    {
+        int tEntry = (i < mFifoSize) ? (tFirstKeptEntry + i) % mFifoSize : i;
+        tData.push_back(mFifo[tEntry].Data);
+        tSize.push_back(mFifo[tEntry].Size);
+        tNumber.push_back(mFifo[tEntry].Number);
+    }
+    for (i = 0; i < mFifoMaxSize; i++)
+    {
+        mFifo[i].Data = tData[i];
+        mFifo[i].Size = (i < tKeptEntries) ? tSize[i] : 0;
+        mFifo[i].Number = tNumber[i];
+
+        // release or allocate the data buffer
+        if ((i >= mFifoDesiredSize) && (mFifo[i].Data != NULL))
+        {
+            av_free(mFifo[i].Data);
+            mFifo[i].Data = NULL;
+        }
+        if ((i < mFifoDesiredSize) && (mFifo[i].Data == NULL))
+        {
+            mFifo[i].Data = (char*)av_malloc(mFifoEntrySize);
+            if (mFifo[i].Data == NULL)
+                LOG(LOG_ERROR, "Unable to allocate %d bytes of memory for FIFO %s", mFifoEntrySize, mName.c_str());
+        }
+    }
+
+    mFifoSize = mFifoDesiredSize;
+    mFifoReadPtr = 0;
+    mFifoWritePtr = tKeptEntries % mFifoSize;
+    mFifoAvailableEntries = tKeptEntries;
+
+    for (i = 0; i < mFifoMaxSize; i++)
+        mFifo[i].EntryMutex.unlock();
+
+    return true;
+}
+
+int MediaFifo::GetMaxSize()
+{
+    return mFifoMaxSize;
+}
+
+int64_t MediaFifo::GetMemoryUsage()
+{
+    int64_t tResult = 0;
+    mFifoMutex.lock();
+
+    tResult = (int64_t)mFifoSize * mFifoEntrySize;
+
+    mFifoMutex.unlock();
+
+    return tResult;
+}
+
 int MediaFifo::ReadFifoExclusive(char **pBuffer, int &pBufferSize, int64_t &pBufferTimestamp)
 {
     int tCurrentFifoReadPtr;
@@ -299,6 +422,10 @@ void MediaFifo::WriteFifo(char* pBuffer, int pBufferSize, int64_t pBufferTimesta
     if (pBufferSize == 0)
         LOG(LOG_VERBOSE, "%s-FIFO: got lock for empty chunk", mName.c_str());
 
+    // apply a delayed resize
+    if (mFifoDesiredSize != mFifoSize)
+        DoResize();
+
     if (mFifoAvailableEntries >= mFifoSize)
     {
         LOG(LOG_WARN, "%s-FIFO: buffer full (size is %d, read: %d, write %d) - dropping oldest (%d) data chunk", mName.c_str(), mFifoSize, mFifoReadPtr, mFifoWritePtr, mFifoReadPtr);
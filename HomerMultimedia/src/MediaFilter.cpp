@@ -25,12 +25,15 @@
  */
 
 #include <MediaFilter.h>
+#include <MediaSource.h>
+#include <HBTime.h>
 #include <Logger.h>
 #include <string>
 
 namespace Homer { namespace Multimedia {
 
 using namespace std;
+using namespace Homer::Base;
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -38,6 +41,14 @@ MediaFilter::MediaFilter(MediaSource *pMediaSource)
 {
     mMediaSource = pMediaSource;
     mMediaId = "";
+    mChunkFormatValid = false;
+    mChunkResX = 0;
+    mChunkResY = 0;
+    mChunkSize = 0;
+    mFilteredChunks = 0;
+    mDroppedChunks = 0;
+    mFilterTimeSum = 0;
+    mFilterTimeMax = 0;
 }
 
 MediaFilter::~MediaFilter()
@@ -51,4 +62,71 @@ string MediaFilter::GetId()
 	return mMediaId;
 }
 
+bool MediaFilter::IsModifyingChunks()
+{
+    // the safe default: the chunk is filtered before it is delivered
+    return true;
+}
+
+void MediaFilter::ChunkFormatChanged(int pResX, int pResY, unsigned int pChunkBufferSize)
+{
+}
+
+void MediaFilter::ProcessChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkbufferNumber, AVStream *pStream, bool pIsKeyFrame)
+{
+    int tResX = 0, tResY = 0;
+
+    if ((mMediaSource != NULL) && (mMediaSource->GetMediaType() == MEDIA_VIDEO))
+        mMediaSource->GetVideoGrabResolution(tResX, tResY);
+
+    if ((!mChunkFormatValid) || (tResX != mChunkResX) || (tResY != mChunkResY) || (pChunkBufferSize != mChunkSize))
+    {
+        LOG(LOG_VERBOSE, "Format of filter %s changed to %d*%d with %u bytes per chunk", mMediaId.c_str(), tResX, tResY, pChunkBufferSize);
+        mChunkFormatValid = true;
+        mChunkResX = tResX;
+        mChunkResY = tResY;
+        mChunkSize = pChunkBufferSize;
+        ChunkFormatChanged(tResX, tResY, pChunkBufferSize);
+    }
+
+    int64_t tStartTime = Time::GetTimeStamp();
+    FilterChunk(pChunkBuffer, pChunkBufferSize, pChunkbufferNumber, pStream, pIsKeyFrame);
+    int64_t tFilterTime = Time::GetTimeStamp() - tStartTime;
+
+    mFilteredChunks++;
+    mFilterTimeSum += tFilterTime;
+    if (mFilterTimeMax < tFilterTime)
+        mFilterTimeMax = tFilterTime;
+}
+
+void MediaFilter::CountDroppedChunk()
+{
+    mDroppedChunks++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int64_t MediaFilter::GetFilteredChunks()
+{
+    return mFilteredChunks;
+}
+
+int64_t MediaFilter::GetDroppedChunks()
+{
+    return mDroppedChunks;
+}
+
+int64_t MediaFilter::GetFilterTimeAvg()
+{
+    if (mFilteredChunks == 0)
+        return 0;
+
+    return mFilterTimeSum / mFilteredChunks;
+}
+
+int64_t MediaFilter::GetFilterTimeMax()
+{
+    return mFilterTimeMax;
+}
+
 }} //namespace
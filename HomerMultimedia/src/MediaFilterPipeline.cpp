@@ -0,0 +1,472 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a pipeline stage which runs the media filters of a source
+ * Since:   2014-02-15
+ */
+
+#include <MediaFilterPipeline.h>
+#include <ProcessStatisticService.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+
+namespace Homer { namespace Multimedia {
+
+using namespace std;
+using namespace Homer::Base;
+using namespace Homer::Monitor;
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaFilterPipeline::MediaFilterPipeline()
+{
+    mName = "";
+    mFilters = new MediaFilters();
+    mProducerReaders = 0;
+    mWorkerReaders = 0;
+    for (int i = 0; i < MEDIA_FILTER_PIPELINE_QUEUE_SIZE; i++)
+    {
+        mChunks[i].Buffer = NULL;
+        mChunks[i].BufferSize = 0;
+        mChunks[i].Size = 0;
+        mChunks[i].Number = 0;
+        mChunks[i].Stream = NULL;
+        mChunks[i].IsKeyFrame = false;
+        mChunks[i].DeliveryFifo = NULL;
+        mChunks[i].Canceled = false;
+    }
+    mQueueHead = 0;
+    mQueueSize = 0;
+    mQueuedDeliveries = 0;
+    mWorkerBusy = false;
+    mWorkerDeliveryFifo = NULL;
+    mWorkerNeeded = false;
+}
+
+MediaFilterPipeline::~MediaFilterPipeline()
+{
+    Stop();
+
+    delete mFilters;
+    for (int i = 0; i < MEDIA_FILTER_PIPELINE_QUEUE_SIZE; i++)
+        free(mChunks[i].Buffer);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaFilterPipeline::SetName(string pName)
+{
+    mName = pName;
+}
+
+void MediaFilterPipeline::Stop()
+{
+    mQueueMutex.lock();
+    bool tWasRunning = mWorkerNeeded;
+    mWorkerNeeded = false;
+    mQueueCondition.Signal();
+    mQueueMutex.unlock();
+
+    if (tWasRunning)
+        StopThread(1000);
+
+    // drop the remaining chunks, a later producer restarts the worker
+    mQueueMutex.lock();
+    mQueueHead = 0;
+    mQueueSize = 0;
+    mQueuedDeliveries = 0;
+    mWorkerBusy = false;
+    mWorkerDeliveryFifo = NULL;
+    mChunkFreedCondition.Signal();
+    mQueueMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaFilterPipeline::RegisterFilter(MediaFilter *pFilter)
+{
+    MediaFilters::iterator tIt;
+
+    mRegistrationMutex.lock();
+
+    for (tIt = mFilters->begin(); tIt != mFilters->end(); tIt++)
+    {
+        if ((*tIt)->GetId() == pFilter->GetId())
+        {
+            mRegistrationMutex.unlock();
+            return false;
+        }
+    }
+
+    MediaFilters *tFilters = new MediaFilters(*mFilters);
+    tFilters->push_back(pFilter);
+    ReplaceFilters(tFilters);
+
+    mRegistrationMutex.unlock();
+
+    return true;
+}
+
+bool MediaFilterPipeline::UnregisterFilter(MediaFilter *pFilter, bool pAutoDelete)
+{
+    MediaFilters::iterator tIt;
+    bool tFound = false;
+
+    mRegistrationMutex.lock();
+
+    MediaFilters *tFilters = new MediaFilters(*mFilters);
+    for (tIt = tFilters->begin(); tIt != tFilters->end(); tIt++)
+    {
+        if ((*tIt)->GetId() == pFilter->GetId())
+        {
+            tFilters->erase(tIt);
+            tFound = true;
+            break;
+        }
+    }
+
+    if (tFound)
+    {
+        // the filter isn't used anymore when ReplaceFilters returns
+        ReplaceFilters(tFilters);
+        LOG(LOG_VERBOSE, "Filter %s of %s processed %"PRId64" chunks (avg. %"PRId64" us, max. %"PRId64" us), %"PRId64" chunks were dropped", pFilter->GetId().c_str(), mName.c_str(), pFilter->GetFilteredChunks(), pFilter->GetFilterTimeAvg(), pFilter->GetFilterTimeMax(), pFilter->GetDroppedChunks());
+        if (pAutoDelete)
+            delete pFilter;
+    }else
+        delete tFilters;
+
+    mRegistrationMutex.unlock();
+
+    return tFound;
+}
+
+void MediaFilterPipeline::DeleteAllFilters()
+{
+    MediaFilters::iterator tIt;
+
+    mRegistrationMutex.lock();
+
+    MediaFilters tFilters = *mFilters;
+    ReplaceFilters(new MediaFilters());
+
+    for (tIt = tFilters.begin(); tIt != tFilters.end(); tIt++)
+        delete (*tIt);
+
+    mRegistrationMutex.unlock();
+}
+
+void MediaFilterPipeline::MoveFilters(MediaFilterPipeline &pTarget)
+{
+    MediaFilters::iterator tIt;
+
+    mRegistrationMutex.lock();
+    MediaFilters tFilters = *mFilters;
+    ReplaceFilters(new MediaFilters());
+    mRegistrationMutex.unlock();
+
+    for (tIt = tFilters.begin(); tIt != tFilters.end(); tIt++)
+    {
+        if (!pTarget.RegisterFilter(*tIt))
+        {
+            LOG(LOG_WARN, "Filter %s is already registered at %s, deleting the duplicate", (*tIt)->GetId().c_str(), pTarget.mName.c_str());
+            delete (*tIt);
+        }
+    }
+}
+
+int MediaFilterPipeline::GetFilterCount()
+{
+    int tResult;
+
+    mRegistrationMutex.lock();
+    tResult = (int)mFilters->size();
+    mRegistrationMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaFilters* MediaFilterPipeline::AcquireFilters(volatile int *pReaders)
+{
+    // announce the reader before the list is loaded (full barrier)
+    __sync_fetch_and_add(pReaders, 1);
+
+    return mFilters;
+}
+
+void MediaFilterPipeline::ReleaseFilters(volatile int *pReaders)
+{
+    __sync_fetch_and_sub(pReaders, 1);
+}
+
+void MediaFilterPipeline::ReplaceFilters(MediaFilters *pFilters)
+{
+    MediaFilters *tOldFilters = mFilters;
+    bool tProducerLeft = false, tWorkerLeft = false;
+
+    mFilters = pFilters;
+    __sync_synchronize();
+
+    // grace period: each filtering thread has to be seen outside of the filters once,
+    // afterwards nobody can reference the old list anymore
+    while (true)
+    {
+        __sync_synchronize();
+        if (mProducerReaders == 0)
+            tProducerLeft = true;
+        if (mWorkerReaders == 0)
+            tWorkerLeft = true;
+        if ((tProducerLeft) && (tWorkerLeft))
+            break;
+        Thread::Suspend(MEDIA_FILTER_PIPELINE_GRACE_CHECK_PERIOD);
+    }
+
+    delete tOldFilters;
+}
+
+void MediaFilterPipeline::AnalyzeFilters(MediaFilters *pFilters, bool &pModifying, bool &pObserving)
+{
+    MediaFilters::iterator tIt;
+
+    pModifying = false;
+    pObserving = false;
+    for (tIt = pFilters->begin(); tIt != pFilters->end(); tIt++)
+    {
+        if ((*tIt)->IsModifyingChunks())
+            pModifying = true;
+        else
+            pObserving = true;
+    }
+}
+
+void MediaFilterPipeline::ApplyFilters(MediaFilters *pFilters, bool pModifying, bool pObserving, char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkNumber, AVStream *pStream, bool pIsKeyFrame)
+{
+    MediaFilters::iterator tIt;
+
+    if ((pChunkBuffer == NULL) || (pChunkBufferSize == 0))
+        return;
+
+    for (tIt = pFilters->begin(); tIt != pFilters->end(); tIt++)
+    {
+        bool tModifying = (*tIt)->IsModifyingChunks();
+        if (((tModifying) && (pModifying)) || ((!tModifying) && (pObserving)))
+            (*tIt)->ProcessChunk(pChunkBuffer, pChunkBufferSize, pChunkNumber, pStream, pIsKeyFrame);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaFilterChunk* MediaFilterPipeline::GetFreeChunk(unsigned int pSize, bool pWait)
+{
+    int64_t tStartTime = Time::GetTimeStamp();
+
+    while (mQueueSize >= MEDIA_FILTER_PIPELINE_QUEUE_SIZE)
+    {
+        if (!pWait)
+            return NULL;
+
+        int tWaitTime = MEDIA_FILTER_PIPELINE_QUEUE_TIMEOUT - (int)((Time::GetTimeStamp() - tStartTime) / 1000);
+        if (tWaitTime <= 0)
+            return NULL;
+        mChunkFreedCondition.Wait(&mQueueMutex, tWaitTime);
+    }
+
+    MediaFilterChunk *tResult = &mChunks[(mQueueHead + mQueueSize) % MEDIA_FILTER_PIPELINE_QUEUE_SIZE];
+    if (tResult->BufferSize < pSize)
+    {
+        // grows only, afterwards the buffer is reused for all following chunks
+        char *tBuffer = (char*)realloc(tResult->Buffer, pSize);
+        if (tBuffer == NULL)
+        {
+            LOG(LOG_ERROR, "Failed to allocate %u bytes for a filter chunk of %s", pSize, mName.c_str());
+            return NULL;
+        }
+        tResult->Buffer = tBuffer;
+        tResult->BufferSize = pSize;
+    }
+
+    return tResult;
+}
+
+void MediaFilterPipeline::QueueChunk(MediaFilterChunk *pChunk, char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkNumber, AVStream *pStream, bool pIsKeyFrame, MediaFifo *pDeliveryFifo)
+{
+    if (pChunkBufferSize > 0)
+        memcpy(pChunk->Buffer, pChunkBuffer, pChunkBufferSize);
+    pChunk->Size = pChunkBufferSize;
+    pChunk->Number = pChunkNumber;
+    pChunk->Stream = pStream;
+    pChunk->IsKeyFrame = pIsKeyFrame;
+    pChunk->DeliveryFifo = pDeliveryFifo;
+    pChunk->Canceled = false;
+
+    mQueueSize++;
+    if (pDeliveryFifo != NULL)
+        mQueuedDeliveries++;
+
+    #ifdef MFP_DEBUG_CHUNKS
+        LOG(LOG_VERBOSE, "Queued chunk %"PRId64" with %u bytes for %s, queue size: %d, deliveries: %d", pChunkNumber, pChunkBufferSize, mName.c_str(), mQueueSize, mQueuedDeliveries);
+    #endif
+
+    if (!mWorkerNeeded)
+    {
+        mWorkerNeeded = true;
+        StartThread();
+    }
+    mQueueCondition.Signal();
+}
+
+bool MediaFilterPipeline::FilterChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkNumber, AVStream *pStream, bool pIsKeyFrame, MediaFifo *pDeliveryFifo)
+{
+    MediaFilterChunk *tChunk;
+    bool tModifying, tObserving;
+    bool tResult = false;
+
+    MediaFilters *tFilters = AcquireFilters(&mProducerReaders);
+    AnalyzeFilters(tFilters, tModifying, tObserving);
+
+    if (pDeliveryFifo != NULL)
+    {
+        mQueueMutex.lock();
+        // chunks have to leave in order: as long as the worker has deliveries, each following chunk has to pass the worker
+        if ((mQueuedDeliveries > 0) || ((tModifying) && (pChunkBufferSize > 0)))
+        {
+            tChunk = GetFreeChunk(pChunkBufferSize, true);
+            if (tChunk != NULL)
+            {
+                QueueChunk(tChunk, pChunkBuffer, pChunkBufferSize, pChunkNumber, pStream, pIsKeyFrame, pDeliveryFifo);
+                tResult = true;
+            }else
+                LOG(LOG_WARN, "Filter worker of %s is too slow, filtering chunk %"PRId64" in the producer", mName.c_str(), pChunkNumber);
+        }
+        mQueueMutex.unlock();
+    }
+
+    if ((!tResult) && (pChunkBufferSize > 0))
+    {
+        // the filters which modify the chunk have to finish before the producer delivers it
+        if (tModifying)
+            ApplyFilters(tFilters, true, false, pChunkBuffer, pChunkBufferSize, pChunkNumber, pStream, pIsKeyFrame);
+
+        if (tObserving)
+        {
+            mQueueMutex.lock();
+            tChunk = GetFreeChunk(pChunkBufferSize, false);
+            if (tChunk != NULL)
+                QueueChunk(tChunk, pChunkBuffer, pChunkBufferSize, pChunkNumber, pStream, pIsKeyFrame, NULL);
+            mQueueMutex.unlock();
+
+            if (tChunk == NULL)
+            {
+                MediaFilters::iterator tIt;
+                for (tIt = tFilters->begin(); tIt != tFilters->end(); tIt++)
+                {
+                    if (!(*tIt)->IsModifyingChunks())
+                        (*tIt)->CountDroppedChunk();
+                }
+            }
+        }
+    }
+
+    ReleaseFilters(&mProducerReaders);
+
+    return tResult;
+}
+
+void MediaFilterPipeline::CancelDelivery(MediaFifo *pDeliveryFifo)
+{
+    mQueueMutex.lock();
+
+    // the chunk at the queue head might be in use by the worker
+    for (int i = (mWorkerBusy ? 1 : 0); i < mQueueSize; i++)
+    {
+        MediaFilterChunk *tChunk = &mChunks[(mQueueHead + i) % MEDIA_FILTER_PIPELINE_QUEUE_SIZE];
+        if ((!tChunk->Canceled) && (tChunk->DeliveryFifo == pDeliveryFifo))
+        {
+            tChunk->Canceled = true;
+            tChunk->DeliveryFifo = NULL;
+            mQueuedDeliveries--;
+        }
+    }
+
+    while ((mWorkerNeeded) && (mWorkerDeliveryFifo == pDeliveryFifo))
+        mChunkFreedCondition.Wait(&mQueueMutex, MEDIA_FILTER_PIPELINE_QUEUE_TIMEOUT);
+
+    mQueueMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void* MediaFilterPipeline::Run(void* pArgs)
+{
+    MediaFilterChunk *tChunk;
+    MediaFifo *tDeliveryFifo;
+
+    SVC_PROCESS_STATISTIC.AssignThreadName("Media-Filters(" + mName + ")");
+
+    mQueueMutex.lock();
+    while (mWorkerNeeded)
+    {
+        if (mQueueSize == 0)
+        {
+            mQueueCondition.Wait(&mQueueMutex);
+            continue;
+        }
+
+        tChunk = &mChunks[mQueueHead];
+        tDeliveryFifo = tChunk->Canceled ? NULL : tChunk->DeliveryFifo;
+        mWorkerBusy = true;
+        mWorkerDeliveryFifo = tDeliveryFifo;
+        mQueueMutex.unlock();
+
+        if (!tChunk->Canceled)
+        {
+            MediaFilters *tFilters = AcquireFilters(&mWorkerReaders);
+            // a chunk with delivery passes all filters in registration order, otherwise only the observing filters are left
+            ApplyFilters(tFilters, (tDeliveryFifo != NULL), true, tChunk->Buffer, tChunk->Size, tChunk->Number, tChunk->Stream, tChunk->IsKeyFrame);
+            ReleaseFilters(&mWorkerReaders);
+
+            if (tDeliveryFifo != NULL)
+                tDeliveryFifo->WriteFifo(tChunk->Size > 0 ? tChunk->Buffer : NULL, (int)tChunk->Size, tChunk->Number);
+        }
+
+        mQueueMutex.lock();
+        if (tDeliveryFifo != NULL)
+            mQueuedDeliveries--;
+        mQueueHead = (mQueueHead + 1) % MEDIA_FILTER_PIPELINE_QUEUE_SIZE;
+        mQueueSize--;
+        mWorkerBusy = false;
+        mWorkerDeliveryFifo = NULL;
+        mChunkFreedCondition.Signal();
+    }
+    mQueueMutex.unlock();
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -0,0 +1,294 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of the in-process loopback for media packets
+ * Since:   2014-02-16
+ */
+
+#include <MediaLoopback.h>
+#include <HBThread.h>
+#include <Logger.h>
+
+#include <string>
+
+namespace Homer { namespace Multimedia {
+
+using namespace std;
+using namespace Homer::Base;
+
+MediaLoopback sMediaLoopback;
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaLoopback::MediaLoopback()
+{
+    mEnabled = false;
+    mDeliveredPackets = 0;
+    mDeliveredBytes = 0;
+}
+
+MediaLoopback::~MediaLoopback()
+{
+    MediaLoopbackReceivers::iterator tIt;
+
+    for (tIt = mReceivers.begin(); tIt != mReceivers.end(); tIt++)
+        delete tIt->second;
+}
+
+MediaLoopback& MediaLoopback::GetInstance()
+{
+    return sMediaLoopback;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaLoopbackEndpoint::operator<(const MediaLoopbackEndpoint &pOther) const
+{
+    if (Port != pOther.Port)
+        return Port < pOther.Port;
+    if (Transport != pOther.Transport)
+        return Transport < pOther.Transport;
+    if (Network != pOther.Network)
+        return Network < pOther.Network;
+    return Address < pOther.Address;
+}
+
+MediaLoopbackEndpoint MediaLoopback::CreateEndpoint(Socket *pSocket)
+{
+    MediaLoopbackEndpoint tResult;
+
+    tResult.Address = pSocket->GetLocalHost();
+    if ((tResult.Address == "*") || (tResult.Address == "0.0.0.0") || (tResult.Address == "::"))
+        tResult.Address = "";
+    tResult.Network = pSocket->GetNetworkType();
+    tResult.Port = pSocket->GetLocalPort();
+    tResult.Transport = pSocket->GetTransportType();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaLoopback::SetEnabled(bool pEnabled)
+{
+    if (mEnabled != pEnabled)
+        LOG(LOG_VERBOSE, "%s in-process loopback for media packets", pEnabled ? "Enabling" : "Disabling");
+    mEnabled = pEnabled;
+}
+
+bool MediaLoopback::IsEnabled()
+{
+    return mEnabled;
+}
+
+void MediaLoopback::SetLocalAddresses(MediaLoopbackAddresses pAddresses)
+{
+    MediaLoopbackAddresses::iterator tIt;
+
+    mMutex.lock();
+    mLocalAddresses = pAddresses;
+    for (tIt = mLocalAddresses.begin(); tIt != mLocalAddresses.end(); tIt++)
+        LOG(LOG_VERBOSE, "Local address for media loopback: %s", tIt->c_str());
+    mMutex.unlock();
+}
+
+bool MediaLoopback::IsLocalHost(string pHost)
+{
+    bool tResult;
+
+    mMutex.lock();
+    tResult = IsLocalHostLocked(pHost);
+    mMutex.unlock();
+
+    return tResult;
+}
+
+bool MediaLoopback::IsLocalHostLocked(string pHost)
+{
+    MediaLoopbackAddresses::iterator tIt;
+
+    if ((pHost == "127.0.0.1") || (pHost == "::1") || (pHost == "localhost"))
+        return true;
+
+    for (tIt = mLocalAddresses.begin(); tIt != mLocalAddresses.end(); tIt++)
+    {
+        if (*tIt == pHost)
+            return true;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaLoopback::RegisterReceiver(Socket *pSocket, MediaLoopbackReceiver *pReceiver)
+{
+    MediaLoopbackEndpoint tEndpoint;
+    MediaLoopbackRegistration *tRegistration;
+
+    if ((pSocket == NULL) || (pSocket->GetLocalPort() == 0) || (pSocket->GetTransportType() == SOCKET_TCP))
+        return;
+
+    tEndpoint = CreateEndpoint(pSocket);
+
+    LOG(LOG_VERBOSE, "Registering loopback receiver for local socket [%s]:%u, transport %s", (tEndpoint.Address != "") ? tEndpoint.Address.c_str() : "any", tEndpoint.Port, Socket::TransportType2String(tEndpoint.Transport).c_str());
+
+    mMutex.lock();
+    if (mReceivers.find(tEndpoint) == mReceivers.end())
+    {
+        tRegistration = new MediaLoopbackRegistration();
+        tRegistration->Receiver = pReceiver;
+        tRegistration->Deliveries = 0;
+        mReceivers[tEndpoint] = tRegistration;
+    }else
+        LOG(LOG_WARN, "Local socket at port %u is already registered for loopback", tEndpoint.Port);
+    mMutex.unlock();
+}
+
+void MediaLoopback::UnregisterReceiver(Socket *pSocket, MediaLoopbackReceiver *pReceiver)
+{
+    MediaLoopbackReceivers::iterator tIt;
+    MediaLoopbackRegistration *tRegistration = NULL;
+
+    if (pSocket == NULL)
+        return;
+
+    mMutex.lock();
+    tIt = mReceivers.find(CreateEndpoint(pSocket));
+    if ((tIt != mReceivers.end()) && (tIt->second->Receiver == pReceiver))
+    {
+        LOG(LOG_VERBOSE, "Unregistering loopback receiver for local port %u, transport %s", pSocket->GetLocalPort(), Socket::TransportType2String(pSocket->GetTransportType()).c_str());
+        tRegistration = tIt->second;
+        mReceivers.erase(tIt);
+    }
+
+    // wait until running deliveries have left the receiver
+    if (tRegistration != NULL)
+    {
+        while (tRegistration->Deliveries > 0)
+        {
+            mMutex.unlock();
+            Thread::Suspend(1000);
+            mMutex.lock();
+        }
+    }
+    mMutex.unlock();
+
+    delete tRegistration;
+}
+
+MediaLoopbackRegistration* MediaLoopback::FindReceiverLocked(string pHost, unsigned int pPort, enum TransportType pTransport)
+{
+    MediaLoopbackReceivers::iterator tIt;
+    MediaLoopbackEndpoint tEndpoint;
+
+    tEndpoint.Address = pHost;
+    tEndpoint.Network = IS_IPV6_ADDRESS(pHost) ? SOCKET_IPv6 : SOCKET_IPv4;
+    tEndpoint.Port = pPort;
+    tEndpoint.Transport = pTransport;
+
+    // a socket which is bound to exactly this address
+    tIt = mReceivers.find(tEndpoint);
+    if (tIt != mReceivers.end())
+        return tIt->second;
+
+    // a socket which is bound to any address has to be local
+    if (!IsLocalHostLocked(pHost))
+        return NULL;
+    tEndpoint.Address = "";
+    tIt = mReceivers.find(tEndpoint);
+    if (tIt != mReceivers.end())
+        return tIt->second;
+
+    //HINT: IPv6 sockets are created as dual stack sockets, they receive IPv4 packets, too
+    if (tEndpoint.Network == SOCKET_IPv4)
+    {
+        tEndpoint.Network = SOCKET_IPv6;
+        tIt = mReceivers.find(tEndpoint);
+        if (tIt != mReceivers.end())
+            return tIt->second;
+    }
+
+    return NULL;
+}
+
+bool MediaLoopback::HasReceiver(string pHost, unsigned int pPort, enum TransportType pTransport)
+{
+    bool tResult;
+
+    mMutex.lock();
+    tResult = (FindReceiverLocked(pHost, pPort, pTransport) != NULL);
+    mMutex.unlock();
+
+    return tResult;
+}
+
+bool MediaLoopback::Deliver(string pHost, unsigned int pPort, enum TransportType pTransport, char *pData, int pSize)
+{
+    MediaLoopbackRegistration *tRegistration;
+    bool tResult;
+
+    if (!mEnabled)
+        return false;
+
+    mMutex.lock();
+    tRegistration = FindReceiverLocked(pHost, pPort, pTransport);
+    if (tRegistration != NULL)
+        tRegistration->Deliveries++;
+    mMutex.unlock();
+
+    if (tRegistration == NULL)
+        return false;
+
+    #ifdef MLB_DEBUG_PACKETS
+        LOG(LOG_VERBOSE, "Delivering %d bytes to local port %u via loopback", pSize, pPort);
+    #endif
+    // senders of other streams aren't blocked by the delivery
+    tResult = tRegistration->Receiver->ReceiveLoopbackPacket(pData, pSize);
+
+    mMutex.lock();
+    tRegistration->Deliveries--;
+    if (tResult)
+    {
+        mDeliveredPackets++;
+        mDeliveredBytes += pSize;
+    }
+    mMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int64_t MediaLoopback::GetDeliveredPackets()
+{
+    return mDeliveredPackets;
+}
+
+int64_t MediaLoopback::GetDeliveredBytes()
+{
+    return mDeliveredBytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -0,0 +1,381 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a process-wide memory budget for media FIFOs and frame buffers
+ * Since:   2014-01-21
+ */
+
+#include <MediaMemoryBudget.h>
+#include <MediaFifo.h>
+#include <MediaSource.h>
+#include <HBSystem.h>
+#include <Logger.h>
+
+namespace Homer { namespace Multimedia {
+
+using namespace Homer::Base;
+using namespace std;
+
+MediaMemoryBudget sMediaMemoryBudget;
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaMemoryBudget::MediaMemoryBudget()
+{
+    mBudget = MEDIA_MEMORY_BUDGET_UNLIMITED;
+    mBudgetExceeded = false;
+}
+
+MediaMemoryBudget::~MediaMemoryBudget()
+{
+
+}
+
+MediaMemoryBudget& MediaMemoryBudget::GetInstance()
+{
+    return sMediaMemoryBudget;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaMemoryBudget::SetBudget(int64_t pBytes)
+{
+    if (pBytes < 0)
+        pBytes = MEDIA_MEMORY_BUDGET_UNLIMITED;
+
+    mMutex.lock();
+    if (mBudget != pBytes)
+    {
+        LOG(LOG_VERBOSE, "Setting media memory budget to %"PRId64" bytes", pBytes);
+        mBudget = pBytes;
+        mBudgetExceeded = false;
+        Enforce();
+    }
+    mMutex.unlock();
+}
+
+int64_t MediaMemoryBudget::GetBudget()
+{
+    return mBudget;
+}
+
+int64_t MediaMemoryBudget::GetEffectiveBudget()
+{
+    int64_t tResult = mBudget;
+    int64_t tLimit = System::GetMemoryLimit();
+
+    if (tLimit > 0)
+    {
+        tLimit = tLimit / 100 * MEDIA_MEMORY_BUDGET_LIMIT_SHARE;
+        if ((tResult == MEDIA_MEMORY_BUDGET_UNLIMITED) || (tResult > tLimit))
+            tResult = tLimit;
+    }
+
+    return tResult;
+}
+
+int64_t MediaMemoryBudget::GetUsage()
+{
+    int64_t tResult = 0;
+    MediaMemoryFifos::iterator tFifoIt;
+    MediaMemoryBuffers::iterator tBufferIt;
+
+    mMutex.lock();
+    for (tFifoIt = mFifos.begin(); tFifoIt != mFifos.end(); tFifoIt++)
+        tResult += tFifoIt->first->GetMemoryUsage();
+    for (tBufferIt = mBuffers.begin(); tBufferIt != mBuffers.end(); tBufferIt++)
+        tResult += tBufferIt->second.Size;
+    mMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaMemoryBudget::SetStreamBackground(MediaSource *pStream, bool pBackground)
+{
+    if (pStream == NULL)
+        return;
+
+    mMutex.lock();
+    if (mBackgroundStreams[pStream] != pBackground)
+    {
+        LOG(LOG_VERBOSE, "Setting stream %s to %s", pStream->GetStreamName().c_str(), pBackground ? "background" : "foreground");
+        mBackgroundStreams[pStream] = pBackground;
+        Enforce();
+    }
+    mMutex.unlock();
+}
+
+bool MediaMemoryBudget::IsStreamBackground(MediaSource *pStream)
+{
+    bool tResult = false;
+
+    mMutex.lock();
+    map<MediaSource*, bool>::iterator tIt = mBackgroundStreams.find(pStream);
+    if (tIt != mBackgroundStreams.end())
+        tResult = tIt->second;
+    mMutex.unlock();
+
+    return tResult;
+}
+
+void MediaMemoryBudget::UnregisterStream(MediaSource *pStream)
+{
+    MediaMemoryFifos::iterator tFifoIt;
+    MediaMemoryBuffers::iterator tBufferIt;
+
+    mMutex.lock();
+    mBackgroundStreams.erase(pStream);
+
+    // the remaining memory isn't assigned to a stream anymore
+    for (tFifoIt = mFifos.begin(); tFifoIt != mFifos.end(); tFifoIt++)
+    {
+        if (tFifoIt->second.Stream == pStream)
+            tFifoIt->second.Stream = NULL;
+    }
+    for (tBufferIt = mBuffers.begin(); tBufferIt != mBuffers.end(); tBufferIt++)
+    {
+        if (tBufferIt->second.Stream == pStream)
+            tBufferIt->second.Stream = NULL;
+    }
+    mMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaMemoryBudget::RegisterFifo(MediaFifo *pFifo)
+{
+    if (pFifo == NULL)
+        return;
+
+    mMutex.lock();
+    MediaMemoryFifoDescriptor &tDescriptor = mFifos[pFifo];
+    tDescriptor.Stream = NULL;
+    tDescriptor.Shrinkable = false;
+    Enforce();
+    mMutex.unlock();
+}
+
+void MediaMemoryBudget::AssignFifo(MediaFifo *pFifo, MediaSource *pStream, bool pShrinkable)
+{
+    mMutex.lock();
+    MediaMemoryFifos::iterator tIt = mFifos.find(pFifo);
+    if (tIt != mFifos.end())
+    {
+        tIt->second.Stream = pStream;
+        tIt->second.Shrinkable = pShrinkable;
+        Enforce();
+    }else
+        LOG(LOG_WARN, "Tried to assign an unregistered FIFO to a stream");
+    mMutex.unlock();
+}
+
+void MediaMemoryBudget::UnregisterFifo(MediaFifo *pFifo)
+{
+    mMutex.lock();
+    if (mFifos.erase(pFifo) > 0)
+    {
+        // the released memory can be used by the remaining FIFOs
+        Enforce();
+    }
+    mMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaMemoryBudget::RegisterBuffer(void *pBuffer, int pSize, MediaSource *pStream)
+{
+    if (pBuffer == NULL)
+        return;
+
+    mMutex.lock();
+    MediaMemoryBufferDescriptor &tDescriptor = mBuffers[pBuffer];
+    tDescriptor.Stream = pStream;
+    tDescriptor.Size = pSize;
+    Enforce();
+    mMutex.unlock();
+}
+
+void MediaMemoryBudget::UnregisterBuffer(void *pBuffer)
+{
+    mMutex.lock();
+    if (mBuffers.erase(pBuffer) > 0)
+        Enforce();
+    mMutex.unlock();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaMemoryStreamStatistics MediaMemoryBudget::GetStreamStatistics()
+{
+    MediaMemoryStreamStatistics tResult;
+    map<MediaSource*, MediaMemoryStreamStatistic> tStreams;
+    map<MediaSource*, MediaMemoryStreamStatistic>::iterator tStreamIt;
+    MediaMemoryFifos::iterator tFifoIt;
+    MediaMemoryBuffers::iterator tBufferIt;
+
+    mMutex.lock();
+
+    for (tFifoIt = mFifos.begin(); tFifoIt != mFifos.end(); tFifoIt++)
+    {
+        MediaMemoryStreamStatistic &tEntry = tStreams[tFifoIt->second.Stream];
+        tEntry.Fifos++;
+        tEntry.FifoMemory += tFifoIt->first->GetMemoryUsage();
+        tEntry.FifoMemoryMax += (int64_t)tFifoIt->first->GetMaxSize() * tFifoIt->first->GetEntrySize();
+    }
+
+    for (tBufferIt = mBuffers.begin(); tBufferIt != mBuffers.end(); tBufferIt++)
+    {
+        MediaMemoryStreamStatistic &tEntry = tStreams[tBufferIt->second.Stream];
+        tEntry.Buffers++;
+        tEntry.BufferMemory += tBufferIt->second.Size;
+    }
+
+    for (tStreamIt = tStreams.begin(); tStreamIt != tStreams.end(); tStreamIt++)
+    {
+        MediaSource *tStream = tStreamIt->first;
+        tStreamIt->second.Stream = tStream;
+        tStreamIt->second.Name = (tStream != NULL) ? tStream->GetStreamName() : "unassigned";
+        tStreamIt->second.Background = (tStream != NULL) ? mBackgroundStreams[tStream] : false;
+        tResult.push_back(tStreamIt->second);
+    }
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+int64_t MediaMemoryBudget::GetStreamUsage(MediaSource *pStream)
+{
+    int64_t tResult = 0;
+    MediaMemoryFifos::iterator tFifoIt;
+    MediaMemoryBuffers::iterator tBufferIt;
+
+    mMutex.lock();
+    for (tFifoIt = mFifos.begin(); tFifoIt != mFifos.end(); tFifoIt++)
+    {
+        if (tFifoIt->second.Stream == pStream)
+            tResult += tFifoIt->first->GetMemoryUsage();
+    }
+    for (tBufferIt = mBuffers.begin(); tBufferIt != mBuffers.end(); tBufferIt++)
+    {
+        if (tBufferIt->second.Stream == pStream)
+            tResult += tBufferIt->second.Size;
+    }
+    mMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaMemoryBudget::Enforce()
+{
+    MediaMemoryFifos::iterator tFifoIt;
+    MediaMemoryBuffers::iterator tBufferIt;
+    int64_t tFixedMemory = 0;
+    int64_t tForegroundMax = 0, tForegroundMin = 0;
+    int64_t tBackgroundMax = 0, tBackgroundMin = 0;
+    double tForegroundScale = 1.0, tBackgroundScale = 1.0;
+
+    /*
+     * sum up the memory which can't be influenced and the range of the shrinkable FIFOs
+     */
+    for (tBufferIt = mBuffers.begin(); tBufferIt != mBuffers.end(); tBufferIt++)
+        tFixedMemory += tBufferIt->second.Size;
+
+    for (tFifoIt = mFifos.begin(); tFifoIt != mFifos.end(); tFifoIt++)
+    {
+        MediaFifo *tFifo = tFifoIt->first;
+        if ((!tFifoIt->second.Shrinkable) || (tFifoIt->second.Stream == NULL))
+        {
+            tFixedMemory += tFifo->GetMemoryUsage();
+            continue;
+        }
+
+        int tMaxEntries = tFifo->GetMaxSize();
+        int tMinEntries = (tMaxEntries < MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES) ? tMaxEntries : MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES;
+        if (mBackgroundStreams[tFifoIt->second.Stream])
+        {
+            tBackgroundMax += (int64_t)tMaxEntries * tFifo->GetEntrySize();
+            tBackgroundMin += (int64_t)tMinEntries * tFifo->GetEntrySize();
+        }else
+        {
+            tForegroundMax += (int64_t)tMaxEntries * tFifo->GetEntrySize();
+            tForegroundMin += (int64_t)tMinEntries * tFifo->GetEntrySize();
+        }
+    }
+
+    /*
+     * determine how much of the shrinkable range can be kept, the background streams are shrunk first
+     */
+    int64_t tBudget = GetEffectiveBudget();
+    if (tBudget != MEDIA_MEMORY_BUDGET_UNLIMITED)
+    {
+        int64_t tAvailable = tBudget - tFixedMemory;
+        if (tAvailable < tForegroundMax + tBackgroundMax)
+        {
+            if ((tAvailable >= tForegroundMax + tBackgroundMin) && (tBackgroundMax > tBackgroundMin))
+            {
+                tBackgroundScale = (double)(tAvailable - tForegroundMax - tBackgroundMin) / (tBackgroundMax - tBackgroundMin);
+            }else
+            {
+                tBackgroundScale = 0;
+                if ((tAvailable > tBackgroundMin + tForegroundMin) && (tForegroundMax > tForegroundMin))
+                    tForegroundScale = (double)(tAvailable - tBackgroundMin - tForegroundMin) / (tForegroundMax - tForegroundMin);
+                else
+                    tForegroundScale = 0;
+            }
+        }
+
+        bool tBudgetExceeded = (tFixedMemory + tForegroundMin + tBackgroundMin > tBudget);
+        if ((tBudgetExceeded) && (!mBudgetExceeded))
+            LOG(LOG_WARN, "Media memory budget of %"PRId64" bytes is exceeded, %"PRId64" bytes are needed at least", tBudget, tFixedMemory + tForegroundMin + tBackgroundMin);
+        mBudgetExceeded = tBudgetExceeded;
+    }
+
+    #ifdef MMB_DEBUG
+        LOG(LOG_VERBOSE, "Enforcing budget of %"PRId64" bytes, fixed: %"PRId64", foreground: %"PRId64"-%"PRId64" (scale %.2f), background: %"PRId64"-%"PRId64" (scale %.2f)", tBudget, tFixedMemory, tForegroundMin, tForegroundMax, tForegroundScale, tBackgroundMin, tBackgroundMax, tBackgroundScale);
+    #endif
+
+    /*
+     * resize the FIFOs
+     */
+    for (tFifoIt = mFifos.begin(); tFifoIt != mFifos.end(); tFifoIt++)
+    {
+        MediaFifo *tFifo = tFifoIt->first;
+        if ((!tFifoIt->second.Shrinkable) || (tFifoIt->second.Stream == NULL))
+            continue;
+
+        int tMaxEntries = tFifo->GetMaxSize();
+        int tMinEntries = (tMaxEntries < MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES) ? tMaxEntries : MEDIA_MEMORY_BUDGET_MIN_FIFO_ENTRIES;
+        double tScale = mBackgroundStreams[tFifoIt->second.Stream] ? tBackgroundScale : tForegroundScale;
+        int tEntries = tMinEntries + (int)(tScale * (tMaxEntries - tMinEntries));
+        if (tEntries != tFifo->GetSize())
+            tFifo->Resize(tEntries);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -0,0 +1,555 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a shared memory ring for exchanging media between processes
+ * Since:   2014-02-08
+ */
+
+#include <MediaShmRing.h>
+#include <HBThread.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <string>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#if defined(LINUX) || defined(APPLE) || defined(BSD)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#endif
+
+#if defined(LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <limits.h>
+#endif
+
+namespace Homer { namespace Multimedia {
+
+using namespace std;
+using namespace Homer::Base;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// polling period for systems without futex support
+#define MEDIA_SHM_RING_POLLING_PERIOD                   1 // ms
+
+#define MEDIA_SHM_RING_ALIGN(x)                         (((x) + MEDIA_SHM_RING_ALIGNMENT - 1) / MEDIA_SHM_RING_ALIGNMENT * MEDIA_SHM_RING_ALIGNMENT)
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaShmRing::MediaShmRing()
+{
+    mName = "";
+    mProducer = false;
+    mMemory = NULL;
+    mMemorySize = 0;
+    mSlotStride = 0;
+    mHeader = NULL;
+    mReadCount = 0;
+    mAcquiredSlot = 0;
+    mAcquired = false;
+    mInterrupted = false;
+    mLostSlots = 0;
+}
+
+MediaShmRing::~MediaShmRing()
+{
+    Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+string MediaShmRing::GetObjectName(string pName)
+{
+    string tResult = MEDIA_SHM_RING_OBJECT_PREFIX;
+
+    // the name space of shared memory objects allows no further slashes
+    for (unsigned int i = 0; i < pName.size(); i++)
+    {
+        char tChar = pName[i];
+        if (((tChar >= 'a') && (tChar <= 'z')) || ((tChar >= 'A') && (tChar <= 'Z')) || ((tChar >= '0') && (tChar <= '9')) || (tChar == '-') || (tChar == '.'))
+            tResult += tChar;
+        else
+            tResult += '_';
+    }
+
+    return tResult;
+}
+
+bool MediaShmRing::Map(int pFileDescriptor, int64_t pSize)
+{
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        void *tMemory = mmap(NULL, (size_t)pSize, PROT_READ | PROT_WRITE, MAP_SHARED, pFileDescriptor, 0);
+        if (tMemory == MAP_FAILED)
+        {
+            LOG(LOG_ERROR, "Failed to map %"PRId64" bytes of shared memory object %s because \"%s\"", pSize, mName.c_str(), strerror(errno));
+            return false;
+        }
+        mMemory = (char*)tMemory;
+        mMemorySize = pSize;
+        mHeader = (MediaShmRingHeader*)mMemory;
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+bool MediaShmRing::Create(string pName, int pSlotCount, int pSlotSize)
+{
+    if (IsOpen())
+    {
+        LOG(LOG_ERROR, "Ring %s is already open", mName.c_str());
+        return false;
+    }
+
+    if ((pSlotCount < 2) || (pSlotSize < 1))
+    {
+        LOG(LOG_ERROR, "Invalid ring geometry of %d slots with %d bytes", pSlotCount, pSlotSize);
+        return false;
+    }
+
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        mName = GetObjectName(pName);
+        mSlotStride = MEDIA_SHM_RING_ALIGN(sizeof(MediaShmRingSlot) + pSlotSize);
+        int64_t tSize = MEDIA_SHM_RING_ALIGN(sizeof(MediaShmRingHeader)) + mSlotStride * pSlotCount;
+
+        // remove the left-over of a crashed producer, but never the ring of a running one
+        int tFd = shm_open(mName.c_str(), O_RDONLY, 0);
+        if (tFd >= 0)
+        {
+            uint32_t tProducerPid = 0;
+            struct stat tStat;
+            if ((fstat(tFd, &tStat) == 0) && (tStat.st_size >= (off_t)sizeof(MediaShmRingHeader)))
+            {
+                void *tMemory = mmap(NULL, sizeof(MediaShmRingHeader), PROT_READ, MAP_SHARED, tFd, 0);
+                if (tMemory != MAP_FAILED)
+                {
+                    MediaShmRingHeader *tHeader = (MediaShmRingHeader*)tMemory;
+                    if (tHeader->Magic == MEDIA_SHM_RING_MAGIC)
+                        tProducerPid = tHeader->ProducerPid;
+                    munmap(tMemory, sizeof(MediaShmRingHeader));
+                }
+            }
+            close(tFd);
+
+            // HINT: EPERM means the process exists but belongs to another user
+            if ((tProducerPid != 0) && ((kill((pid_t)tProducerPid, 0) == 0) || (errno == EPERM)))
+            {
+                LOG(LOG_ERROR, "Shared memory object %s is still used by the running producer %u", mName.c_str(), tProducerPid);
+                mName = "";
+                return false;
+            }
+
+            LOG(LOG_WARN, "Removing left-over shared memory object %s of a stopped producer", mName.c_str());
+            shm_unlink(mName.c_str());
+        }
+
+        tFd = shm_open(mName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (tFd < 0)
+        {
+            LOG(LOG_ERROR, "Failed to create shared memory object %s because \"%s\"", mName.c_str(), strerror(errno));
+            return false;
+        }
+        if (ftruncate(tFd, (off_t)tSize) < 0)
+        {
+            LOG(LOG_ERROR, "Failed to resize shared memory object %s to %"PRId64" bytes because \"%s\"", mName.c_str(), tSize, strerror(errno));
+            close(tFd);
+            shm_unlink(mName.c_str());
+            return false;
+        }
+        bool tMapped = Map(tFd, tSize);
+        close(tFd);
+        if (!tMapped)
+        {
+            shm_unlink(mName.c_str());
+            return false;
+        }
+
+        // HINT: ftruncate() has zeroed the memory, all slot sequences are invalid
+        mHeader->Magic = MEDIA_SHM_RING_MAGIC;
+        mHeader->Version = MEDIA_SHM_RING_VERSION;
+        mHeader->SlotCount = pSlotCount;
+        mHeader->SlotSize = pSlotSize;
+        mHeader->Content = MEDIA_SHM_CONTENT_UNKNOWN;
+        mHeader->CodecId = 0;
+        mHeader->ProducerPid = (uint32_t)getpid();
+        mProducer = true;
+
+        LOG(LOG_VERBOSE, "Created ring %s with %d slots of %d bytes (%"PRId64" KB)", mName.c_str(), pSlotCount, pSlotSize, tSize / 1024);
+
+        return true;
+    #else
+        LOG(LOG_ERROR, "Shared memory rings aren't supported on this platform");
+        return false;
+    #endif
+}
+
+bool MediaShmRing::Attach(string pName)
+{
+    if (IsOpen())
+    {
+        LOG(LOG_ERROR, "Ring %s is already open", mName.c_str());
+        return false;
+    }
+
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        mName = GetObjectName(pName);
+
+        int tFd = shm_open(mName.c_str(), O_RDWR, 0);
+        if (tFd < 0)
+        {
+            LOG(LOG_ERROR, "Failed to open shared memory object %s because \"%s\"", mName.c_str(), strerror(errno));
+            return false;
+        }
+
+        struct stat tStat;
+        if ((fstat(tFd, &tStat) < 0) || (tStat.st_size < (off_t)sizeof(MediaShmRingHeader)))
+        {
+            LOG(LOG_ERROR, "Shared memory object %s is too small for a ring", mName.c_str());
+            close(tFd);
+            return false;
+        }
+        bool tMapped = Map(tFd, (int64_t)tStat.st_size);
+        close(tFd);
+        if (!tMapped)
+            return false;
+
+        if ((mHeader->Magic != MEDIA_SHM_RING_MAGIC) || (mHeader->Version != MEDIA_SHM_RING_VERSION))
+        {
+            LOG(LOG_ERROR, "Shared memory object %s contains no ring of version %d", mName.c_str(), MEDIA_SHM_RING_VERSION);
+            Close();
+            return false;
+        }
+        mSlotStride = MEDIA_SHM_RING_ALIGN(sizeof(MediaShmRingSlot) + mHeader->SlotSize);
+        if (MEDIA_SHM_RING_ALIGN(sizeof(MediaShmRingHeader)) + mSlotStride * mHeader->SlotCount > mMemorySize)
+        {
+            LOG(LOG_ERROR, "Shared memory object %s is smaller than its ring geometry", mName.c_str());
+            Close();
+            return false;
+        }
+
+        // start with the next written slot
+        mReadCount = mHeader->WriteCount;
+        mAcquired = false;
+        mLostSlots = 0;
+        mProducer = false;
+
+        LOG(LOG_VERBOSE, "Attached to ring %s with %u slots of %u bytes", mName.c_str(), mHeader->SlotCount, mHeader->SlotSize);
+
+        return true;
+    #else
+        LOG(LOG_ERROR, "Shared memory rings aren't supported on this platform");
+        return false;
+    #endif
+}
+
+void MediaShmRing::Close()
+{
+    if (!IsOpen())
+        return;
+
+    #if defined(LINUX) || defined(APPLE) || defined(BSD)
+        if (mProducer)
+        {
+            // signal the end of the stream to all consumers
+            mHeader->ProducerPid = 0;
+            WakeUp();
+            shm_unlink(mName.c_str());
+            LOG(LOG_VERBOSE, "Removed ring %s after %"PRId64" written slots", mName.c_str(), (int64_t)mHeader->WriteCount);
+        }else
+            LOG(LOG_VERBOSE, "Detached from ring %s, lost %"PRId64" slots", mName.c_str(), mLostSlots);
+        munmap(mMemory, (size_t)mMemorySize);
+    #endif
+
+    mMemory = NULL;
+    mMemorySize = 0;
+    mHeader = NULL;
+    mProducer = false;
+    mAcquired = false;
+}
+
+bool MediaShmRing::IsOpen()
+{
+    return (mHeader != NULL);
+}
+
+string MediaShmRing::GetName()
+{
+    return mName;
+}
+
+const MediaShmRingHeader* MediaShmRing::GetHeader()
+{
+    return mHeader;
+}
+
+int MediaShmRing::GetSlotSize()
+{
+    return (mHeader != NULL) ? (int)mHeader->SlotSize : 0;
+}
+
+int MediaShmRing::GetSlotCount()
+{
+    return (mHeader != NULL) ? (int)mHeader->SlotCount : 0;
+}
+
+int64_t MediaShmRing::GetSize()
+{
+    return mMemorySize;
+}
+
+MediaShmRingSlot* MediaShmRing::GetSlot(uint64_t pNumber)
+{
+    return (MediaShmRingSlot*)(mMemory + MEDIA_SHM_RING_ALIGN(sizeof(MediaShmRingHeader)) + mSlotStride * (int64_t)(pNumber % mHeader->SlotCount));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaShmRing::WakeUp()
+{
+    __sync_fetch_and_add(&mHeader->WriteSignal, 1);
+
+    // avoid the system call as long as all consumers are busy
+    if (mHeader->Waiters == 0)
+        return;
+
+    #if defined(LINUX)
+        // HINT: no FUTEX_PRIVATE_FLAG because the futex word is shared between processes
+        syscall(SYS_futex, &mHeader->WriteSignal, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    #endif
+}
+
+void MediaShmRing::WaitForWrite(uint32_t pSignal, int pTimeout)
+{
+    __sync_fetch_and_add(&mHeader->Waiters, 1);
+
+    #if defined(LINUX)
+        struct timespec tTimeout;
+        tTimeout.tv_sec = pTimeout / 1000;
+        tTimeout.tv_nsec = (pTimeout % 1000) * 1000 * 1000;
+        // returns immediately if the producer has written something since "pSignal" was read
+        syscall(SYS_futex, &mHeader->WriteSignal, FUTEX_WAIT, pSignal, &tTimeout, NULL, 0);
+    #else
+        if (mHeader->WriteSignal == pSignal)
+            Thread::Suspend((pTimeout < MEDIA_SHM_RING_POLLING_PERIOD ? pTimeout : MEDIA_SHM_RING_POLLING_PERIOD) * 1000);
+    #endif
+
+    __sync_fetch_and_sub(&mHeader->Waiters, 1);
+}
+
+void MediaShmRing::Describe(enum MediaShmContent pContent, int pMediaType, int pCodecId, int pResX, int pResY, int pSampleRate, int pChannels)
+{
+    if ((!mProducer) || (mHeader == NULL))
+        return;
+
+    if ((mHeader->Content == pContent) && (mHeader->MediaType == pMediaType) && (mHeader->CodecId == pCodecId) && (mHeader->ResX == pResX) && (mHeader->ResY == pResY) && (mHeader->SampleRate == pSampleRate) && (mHeader->Channels == pChannels))
+        return;
+
+    LOG(LOG_VERBOSE, "Describing ring %s: content %d, media type %d, codec %d, resolution %d*%d, sample rate %d, channels %d", mName.c_str(), pContent, pMediaType, pCodecId, pResX, pResY, pSampleRate, pChannels);
+
+    mHeader->Content = pContent;
+    mHeader->MediaType = pMediaType;
+    mHeader->CodecId = pCodecId;
+    mHeader->ResX = pResX;
+    mHeader->ResY = pResY;
+    mHeader->SampleRate = pSampleRate;
+    mHeader->Channels = pChannels;
+    __sync_synchronize();
+    mHeader->DescriptionNumber++;
+}
+
+bool MediaShmRing::Write(const char *pData, int pSize, int64_t pTimestamp, int pFlags)
+{
+    if ((!mProducer) || (mHeader == NULL))
+        return false;
+
+    if ((pSize < 0) || (pSize > (int)mHeader->SlotSize))
+    {
+        LOG(LOG_ERROR, "Data of %d bytes doesn't fit into a slot of ring %s with %u bytes", pSize, mName.c_str(), mHeader->SlotSize);
+        return false;
+    }
+
+    uint64_t tNumber = mHeader->WriteCount;
+    MediaShmRingSlot *tSlot = GetSlot(tNumber);
+
+    // invalidate the slot for consumers which are still reading its former content
+    tSlot->Sequence = 0;
+    __sync_synchronize();
+
+    tSlot->Size = (uint32_t)pSize;
+    tSlot->Flags = (uint32_t)pFlags;
+    tSlot->Timestamp = pTimestamp;
+    if (pSize > 0)
+        memcpy((char*)tSlot + sizeof(MediaShmRingSlot), pData, pSize);
+    __sync_synchronize();
+
+    tSlot->Sequence = tNumber + 1;
+    __sync_synchronize();
+    mHeader->WriteCount = tNumber + 1;
+
+    #ifdef MSR_DEBUG_SLOTS
+        LOG(LOG_VERBOSE, "Wrote slot %"PRId64" with %d bytes to ring %s", (int64_t)tNumber, pSize, mName.c_str());
+    #endif
+
+    WakeUp();
+
+    return true;
+}
+
+const char* MediaShmRing::Acquire(int &pSize, int64_t &pTimestamp, int &pFlags, int pTimeout)
+{
+    if ((mProducer) || (mHeader == NULL))
+        return NULL;
+
+    int64_t tDeadline = Time::GetTimeStamp() + (int64_t)pTimeout * 1000;
+
+    while (true)
+    {
+        // HINT: read the signal before the write counter, otherwise we could miss a wake-up
+        uint32_t tSignal = mHeader->WriteSignal;
+        __sync_synchronize();
+        uint64_t tWriteCount = mHeader->WriteCount;
+
+        // lapped by the producer?
+        if (tWriteCount - mReadCount > mHeader->SlotCount)
+        {
+            uint64_t tNewReadCount = tWriteCount - mHeader->SlotCount / 2;
+            #ifdef MSR_DEBUG_SLOTS
+                LOG(LOG_VERBOSE, "Lapped by producer of ring %s, skipping %"PRId64" slots", mName.c_str(), (int64_t)(tNewReadCount - mReadCount));
+            #endif
+            mLostSlots += tNewReadCount - mReadCount;
+            mReadCount = tNewReadCount;
+        }
+
+        if (mReadCount < tWriteCount)
+        {
+            MediaShmRingSlot *tSlot = GetSlot(mReadCount);
+            uint64_t tSequence = tSlot->Sequence;
+            __sync_synchronize();
+            if (tSequence != mReadCount + 1)
+            {// already overwritten
+                mLostSlots++;
+                mReadCount++;
+                continue;
+            }
+            pSize = ((int)tSlot->Size <= (int)mHeader->SlotSize) ? (int)tSlot->Size : (int)mHeader->SlotSize;
+            pTimestamp = tSlot->Timestamp;
+            pFlags = (int)tSlot->Flags;
+            mAcquiredSlot = mReadCount;
+            mAcquired = true;
+
+            return (const char*)tSlot + sizeof(MediaShmRingSlot);
+        }
+
+        if (mHeader->ProducerPid == 0)
+            return NULL;
+
+        if (mInterrupted)
+        {
+            mInterrupted = false;
+            return NULL;
+        }
+
+        int64_t tRemaining = tDeadline - Time::GetTimeStamp();
+        if (tRemaining <= 0)
+            return NULL;
+
+        WaitForWrite(tSignal, (int)((tRemaining + 999) / 1000));
+    }
+
+    return NULL;
+}
+
+bool MediaShmRing::Release()
+{
+    if ((!mAcquired) || (mHeader == NULL))
+        return false;
+
+    __sync_synchronize();
+    bool tResult = (GetSlot(mAcquiredSlot)->Sequence == mAcquiredSlot + 1);
+    if (!tResult)
+    {
+        #ifdef MSR_DEBUG_SLOTS
+            LOG(LOG_VERBOSE, "Slot %"PRId64" of ring %s was overwritten while it was read", (int64_t)mAcquiredSlot, mName.c_str());
+        #endif
+        mLostSlots++;
+    }
+    mReadCount = mAcquiredSlot + 1;
+    mAcquired = false;
+
+    return tResult;
+}
+
+int MediaShmRing::Read(char *pBuffer, int pBufferSize, int64_t &pTimestamp, int &pFlags, int pTimeout)
+{
+    int tSize;
+    const char *tData;
+
+    while ((tData = Acquire(tSize, pTimestamp, pFlags, pTimeout)) != NULL)
+    {
+        if (tSize > pBufferSize)
+        {
+            LOG(LOG_ERROR, "Slot of %d bytes from ring %s doesn't fit into buffer of %d bytes", tSize, mName.c_str(), pBufferSize);
+            Release();
+            mLostSlots++;
+            continue;
+        }
+        memcpy(pBuffer, tData, tSize);
+        if (Release())
+            return tSize;
+    }
+
+    return -1;
+}
+
+void MediaShmRing::Interrupt()
+{
+    if (mHeader == NULL)
+        return;
+
+    mInterrupted = true;
+    __sync_fetch_and_add(&mHeader->WriteSignal, 1);
+    #if defined(LINUX)
+        syscall(SYS_futex, &mHeader->WriteSignal, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    #endif
+}
+
+int64_t MediaShmRing::GetLostSlotCount()
+{
+    return mLostSlots;
+}
+
+bool MediaShmRing::IsProducerAlive()
+{
+    return ((mHeader != NULL) && (mHeader->ProducerPid != 0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
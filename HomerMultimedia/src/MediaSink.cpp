@@ -76,6 +76,16 @@ void MediaSink::SetActivation(bool pState)
     mSinkIsActive = pState;
 }
 
+int MediaSink::GetPathMaxPacketSize()
+{
+    return 0;
+}
+
+void MediaSink::SetAudioLowOverheadPacketization(bool pActive)
+{
+    // nothing to do
+}
+
 string MediaSink::GetId()
 {
     return mMediaId;
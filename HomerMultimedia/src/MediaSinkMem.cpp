@@ -308,6 +308,12 @@ void MediaSinkMem::UpdateSynchronization(int64_t pReferenceNtpTimestamp, int64_t
         SetSynchronizationReferenceForRTP((uint64_t)pReferenceNtpTimestamp, (uint64_t)(pReferenceFrameTimestamp- mIncomingAVStreamStartPts));
 }
 
+void MediaSinkMem::SetAudioLowOverheadPacketization(bool pActive)
+{
+    if (mRtpActivated)
+        SetAudioPacketizationMode(pActive ? RTP_AUDIO_PACKETIZATION_LOW_OVERHEAD : RTP_AUDIO_PACKETIZATION_LOW_LATENCY);
+}
+
 int MediaSinkMem::GetFragmentBufferCounter()
 {
     if (mSinkFifo != NULL)
@@ -31,6 +31,7 @@
 #include <MediaSourceMem.h>
 #include <MediaSourceNet.h>
 #include <PacketStatistic.h>
+#include <MediaLoopback.h>
 #include <RTP.h>
 #include <HBSocket.h>
 #include <HBTime.h>
@@ -60,9 +61,12 @@ void MediaSinkNet::BasicInit(string pTargetHost, unsigned int pTargetPort)
     mNAPIDataSocket = NULL;
     mDataSocket = NULL;
     mBrokenPipe = false;
+    mLoopbackActive = false;
     mMaxNetworkPacketSize = -1;
     mTargetHost = pTargetHost;
     mTargetPort = pTargetPort;
+    // only a local target can have a receiver in this process, packets towards other hosts never consult the loopback
+    mLoopbackTarget = SVC_MEDIA_LOOPBACK.IsLocalHost(pTargetHost);
 }
 
 MediaSinkNet::MediaSinkNet(string pTarget, Requirements *pTransportRequirements, enum MediaSinkType pType, bool pRtpActivated):
@@ -166,6 +170,16 @@ MediaSinkNet::MediaSinkNet(string pTargetHost, unsigned int pTargetPort, Socket*
                 break;
         }
         mDataSocket->SetQoS(tQoSSettings);
+
+        // large send buffer for bursts of key frame packets, audio packets are marked for expedited forwarding
+        mDataSocket->SetTuning(SOCKET_TUNING_PROFILE_MEDIA_TX);
+        if (pType == MEDIA_SINK_AUDIO)
+        {
+            SocketTuningSettings tTuningSettings;
+            mDataSocket->GetTuning(tTuningSettings);
+            tTuningSettings.Dscp = SOCKET_TUNING_DSCP_EF;
+            mDataSocket->SetTuning(tTuningSettings);
+        }
     }
 
     mMediaId = CreateId(pTargetHost, toString(pTargetPort), tTransportType, pRtpActivated);
@@ -217,6 +231,16 @@ void MediaSinkNet::ProcessPacket(AVPacket *pAVPacket, AVStream *pStream, std::st
     MediaSinkMem::ProcessPacket(pAVPacket, pStream, pStreamName);
 }
 
+int MediaSinkNet::GetPathMaxPacketSize()
+{
+    // only known for datagram based transport via Berkeley sockets
+    //HINT: the socket returns a cached value, the muxer calls this with its sink list locked
+    if ((mDataSocket != NULL) && (!mStreamedTransport))
+        return mDataSocket->GetPathMaxPayloadSize(mTargetHost);
+    else
+        return 0;
+}
+
 string MediaSinkNet::CreateId(string pHost, string pPort, enum TransportType pSocketTransportType, bool pRtpActivated)
 {
     if (pSocketTransportType == SOCKET_TRANSPORT_TYPE_INVALID)
@@ -502,7 +526,14 @@ void MediaSinkNet::SendPacket(char* pData, unsigned int pSize)
     {
         if (mDataSocket != NULL)
         {
-            if (!mDataSocket->Send(mTargetHost, mTargetPort, pData, (ssize_t)pSize))
+            // a receiver in this process gets the packet directly, an impaired socket keeps the network path
+            bool tLoopback = (mLoopbackTarget) && (mDataSocket->GetTransportType() != SOCKET_TCP) && (mDataSocket->GetImpairment(IMPAIRMENT_DIRECTION_SEND) == NULL) && (SVC_MEDIA_LOOPBACK.Deliver(mTargetHost, mTargetPort, mDataSocket->GetTransportType(), pData, (int)pSize));
+            if (mLoopbackActive != tLoopback)
+            {
+                LOG(LOG_VERBOSE, "%s in-process loopback towards %s:%u", tLoopback ? "Using" : "Leaving", mTargetHost.c_str(), mTargetPort);
+                mLoopbackActive = tLoopback;
+            }
+            if ((!tLoopback) && (!mDataSocket->Send(mTargetHost, mTargetPort, pData, (ssize_t)pSize)))
             {
                 LOG(LOG_ERROR, "Error when sending data through %s socket to %s:%u, will skip further transmissions", GetTransportTypeStr().c_str(), mTargetHost.c_str(), mTargetPort);
                 mBrokenPipe = true;
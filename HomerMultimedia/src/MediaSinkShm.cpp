@@ -0,0 +1,181 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a shared memory based media sink
+ * Since:   2014-02-08
+ */
+
+#include <MediaSinkShm.h>
+#include <MediaSource.h>
+#include <PacketStatistic.h>
+#include <RTP.h>
+#include <Logger.h>
+
+#include <string>
+
+namespace Homer { namespace Multimedia {
+
+using namespace std;
+using namespace Homer::Monitor;
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaSinkShm::MediaSinkShm(string pName, enum MediaSinkType pType, bool pRtpActivated):
+    MediaSinkMem(CreateId(pName), pType, pRtpActivated)
+{
+    mCurrentPacketPts = 0;
+    mCurrentPacketFlags = 0;
+    AssignStreamName("SHM-OUT: " + pName);
+    switch(pType)
+    {
+        case MEDIA_SINK_VIDEO:
+            ClassifyStream(DATA_TYPE_VIDEO, SOCKET_RAW);
+            break;
+        case MEDIA_SINK_AUDIO:
+            ClassifyStream(DATA_TYPE_AUDIO, SOCKET_RAW);
+            break;
+        default:
+            break;
+    }
+
+    // the consumers read from the ring, the FIFO of the memory sink remains unused
+    delete mSinkFifo;
+    mSinkFifo = NULL;
+
+    if (pRtpActivated)
+        mRing.Create(pName, MEDIA_SINK_SHM_RTP_SLOTS, MEDIA_SINK_SHM_RTP_SLOT_SIZE);
+    else
+        mRing.Create(pName, MEDIA_SINK_SHM_PACKET_SLOTS, MEDIA_SINK_SHM_PACKET_SLOT_SIZE);
+}
+
+MediaSinkShm::~MediaSinkShm()
+{
+    mRing.Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+string MediaSinkShm::CreateId(string pName)
+{
+    return "shm://" + pName;
+}
+
+void MediaSinkShm::ProcessPacket(AVPacket *pAVPacket, AVStream *pStream, std::string pStreamName)
+{
+    if (!mRing.IsOpen())
+        return;
+
+    // publish the stream description, consumers need it for selecting their decoder
+    if ((pStream != NULL) && (pStream->codec != NULL))
+    {
+        AVCodecContext *tCodec = pStream->codec;
+        enum MediaShmContent tContent = (mRtpActivated ? MEDIA_SHM_CONTENT_RTP_PACKETS : MEDIA_SHM_CONTENT_PACKETS);
+        if (tCodec->codec_type == AVMEDIA_TYPE_VIDEO)
+            mRing.Describe(tContent, MEDIA_VIDEO, tCodec->codec_id, tCodec->width, tCodec->height);
+        else
+            mRing.Describe(tContent, MEDIA_AUDIO, tCodec->codec_id, 0, 0, tCodec->sample_rate, tCodec->channels);
+    }
+
+    mCurrentPacketPts = pAVPacket->pts;
+    mCurrentPacketFlags = (pAVPacket->flags & AV_PKT_FLAG_KEY) ? MEDIA_SHM_SLOT_KEY_FRAME : 0;
+
+    MediaSinkMem::ProcessPacket(pAVPacket, pStream, pStreamName);
+}
+
+int MediaSinkShm::GetFragmentBufferCounter()
+{
+    return 0;
+}
+
+int MediaSinkShm::GetFragmentBufferSize()
+{
+    return mRing.GetSlotCount();
+}
+
+void MediaSinkShm::ReadFragment(char *pData, int &pDataSize, int64_t &pFragmentNumber)
+{
+    LOG(LOG_WARN, "Fragments of %s are only available via the shared memory ring %s", GetId().c_str(), mRing.GetName().c_str());
+    pDataSize = 0;
+    pFragmentNumber = 0;
+}
+
+void MediaSinkShm::StopProcessing()
+{
+    LOG(LOG_VERBOSE, "Going to stop media sink \"%s\"", GetStreamName().c_str());
+    mRing.Interrupt();
+}
+
+void MediaSinkShm::WriteFragment(char* pData, unsigned int pSize, int64_t pFragmentNumber)
+{
+    #ifdef MSISHM_DEBUG_PACKETS
+        LOG(LOG_VERBOSE, "Storing packet number %6"PRId64" at %p with size %4u in ring %s", pFragmentNumber, pData, pSize, mRing.GetName().c_str());
+    #endif
+
+    AnnouncePacket(pSize);
+    mRing.Write(pData, (int)pSize, mCurrentPacketPts, mCurrentPacketFlags);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaFilterShm::MediaFilterShm(MediaSource *pMediaSource, string pName):
+    MediaFilter(pMediaSource)
+{
+    mMediaId = MediaSinkShm::CreateId(pName);
+    mRing.Create(pName, MEDIA_SINK_SHM_FRAME_SLOTS, MEDIA_SINK_SHM_FRAME_SLOT_SIZE);
+}
+
+MediaFilterShm::~MediaFilterShm()
+{
+    mRing.Close();
+}
+
+void MediaFilterShm::FilterChunk(char* pChunkBuffer, unsigned int pChunkBufferSize, int64_t pChunkbufferNumber, AVStream *pStream, bool pIsKeyFrame)
+{
+    if ((!mRing.IsOpen()) || (mMediaSource == NULL))
+        return;
+
+    // publish the stream description, consumers need it for interpreting the raw data
+    if (mMediaSource->GetMediaType() == MEDIA_VIDEO)
+    {
+        int tResX = 0, tResY = 0;
+        mMediaSource->GetVideoGrabResolution(tResX, tResY);
+        if ((unsigned int)(tResX * tResY * 4) != pChunkBufferSize)
+        {
+            LOG(LOG_WARN, "Chunk of %u bytes doesn't match the RGB32 picture size for %d*%d, ignoring it", pChunkBufferSize, tResX, tResY);
+            return;
+        }
+        mRing.Describe(MEDIA_SHM_CONTENT_FRAMES, MEDIA_VIDEO, AV_CODEC_ID_RAWVIDEO, tResX, tResY);
+    }else
+        mRing.Describe(MEDIA_SHM_CONTENT_FRAMES, MEDIA_AUDIO, AV_CODEC_ID_PCM_S16LE, 0, 0, mMediaSource->GetOutputSampleRate(), mMediaSource->GetOutputChannels());
+
+    mRing.Write(pChunkBuffer, (int)pChunkBufferSize, pChunkbufferNumber, pIsKeyFrame ? MEDIA_SHM_SLOT_KEY_FRAME : 0);
+}
+
+bool MediaFilterShm::IsModifyingChunks()
+{
+    // we only publish a copy, the filter worker can do this aside of the capture path
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -26,6 +26,7 @@
 
 #include <Header_Ffmpeg.h>
 #include <MediaSource.h>
+#include <MediaMemoryBudget.h>
 #include <Logger.h>
 #include <HBSystem.h>
 
@@ -62,6 +63,7 @@ MediaSource::MediaSource(string pName):
 {
     mFrameDuration = 1;
     mSourceTimeShiftForRTGrabbing = 0;
+    mSynchronizer = NULL;
     mDecodedIFrames = 0;
     mDecodedPFrames = 0;
     mDecodedBFrames = 0;
@@ -121,8 +123,9 @@ MediaSource::MediaSource(string pName):
     for (int i = 0; i < MEDIA_SOURCE_MAX_AUDIO_CHANNELS; i++)
         mResampleFifo[i] = NULL;
     mGrabMutex.AssignName("GrabMutex");
+    mSynchronizerMutex.AssignName("SynchronizerMutex");
     mMediaSinksMutex.AssignName("MediaSinksMutex");
-    mMediaFiltersMutex.AssignName("MediaFiltersMutex");
+    mMediaFilterPipeline.SetName(pName);
 
     FfmpegInit();
 
@@ -181,6 +184,8 @@ MediaSource::~MediaSource()
 {
     DeleteAllRegisteredMediaSinks();
     DeleteAllRegisteredMediaFilters();
+    mMediaFilterPipeline.Stop();
+    SVC_MEDIA_MEMORY_BUDGET.UnregisterStream(this);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -228,6 +233,10 @@ void MediaSource::FfmpegInit()
             LOGEX(MediaSource, LOG_WARN, "Found HEVC encoder in the linked avcodec library, support of H.265 is still experimental..");
         if(IsHEVCDecodingSupported())
             LOGEX(MediaSource, LOG_WARN, "Found HEVC decoder in the linked avcodec library, support of H.265 is still experimental..");
+        if(IsVP9EncodingSupported())
+            LOGEX(MediaSource, LOG_VERBOSE, "Found VP9 encoder in the linked avcodec library");
+        if(IsAV1EncodingSupported())
+            LOGEX(MediaSource, LOG_VERBOSE, "Found AV1 encoder in the linked avcodec library");
     }
     mFfmpegInitMutex.unlock();
 }
@@ -250,6 +259,45 @@ bool MediaSource::IsHEVCDecodingSupported()
         return false;
 }
 
+bool MediaSource::IsVP9EncodingSupported()
+{
+    AVCodec *tFoundCodec = avcodec_find_encoder(AV_CODEC_ID_VP9 /* libvpx-vp9 */);
+    if(tFoundCodec != NULL)
+        return true;
+    else
+        return false;
+}
+
+bool MediaSource::IsVP9DecodingSupported()
+{
+    AVCodec *tFoundCodec = avcodec_find_decoder(AV_CODEC_ID_VP9);
+    if((tFoundCodec != NULL) && (av_find_input_format("ivf") != NULL /* used for the depacketized stream */))
+        return true;
+    else
+        return false;
+}
+
+bool MediaSource::IsAV1EncodingSupported()
+{
+    AVCodec *tFoundCodec = avcodec_find_encoder(AV_CODEC_ID_AV1 /* libaom-av1, libsvtav1 or librav1e */);
+    if(tFoundCodec != NULL)
+        return true;
+    else
+        return false;
+}
+
+bool MediaSource::IsAV1DecodingSupported()
+{
+    // the native AV1 decoder of ffmpeg depends on hardware acceleration, hence a software decoder is needed
+    AVCodec *tFoundCodec = avcodec_find_decoder_by_name("libdav1d");
+    if(tFoundCodec == NULL)
+        tFoundCodec = avcodec_find_decoder_by_name("libaom-av1");
+    if((tFoundCodec != NULL) && (av_find_input_format("obu") != NULL /* used for the depacketized stream */))
+        return true;
+    else
+        return false;
+}
+
 void MediaSource::LogSupportedVideoCodecs(bool pSendToLoggerOnly)
 {
     FfmpegInit();
@@ -485,6 +533,8 @@ int MediaSource::FfmpegLockManager(void **pMutex, enum AVLockOp pMutexOperation)
  *        MPEG4                            CODEC_ID_MPEG4
  *        THEORA                           CODEC_ID_THEORA
  *        VP8                              CODEC_ID_VP8
+ *        VP9                              CODEC_ID_VP9
+ *        AV1                              CODEC_ID_AV1
  *
  *
  *  GUI name to audio codec ID mapping:
@@ -529,6 +579,10 @@ enum AVCodecID MediaSource::GetCodecIDFromGuiName(std::string pName)
         tResult = AV_CODEC_ID_THEORA;
     if (pName == "VP8")
         tResult = AV_CODEC_ID_VP8;
+    if (pName == "VP9")
+        tResult = AV_CODEC_ID_VP9;
+    if (pName == "AV1")
+        tResult = AV_CODEC_ID_AV1;
 
     /* audio */
     if ((pName == "G711 �-law") || (pName == "G711 �-law (PCMU)" /*historic*/))
@@ -600,6 +654,12 @@ string MediaSource::GetGuiNameFromCodecID(enum AVCodecID pCodecId)
         case AV_CODEC_ID_VP8:
                 tResult = "VP8";
                 break;
+        case AV_CODEC_ID_VP9:
+                tResult = "VP9";
+                break;
+        case AV_CODEC_ID_AV1:
+                tResult = "AV1";
+                break;
 
         /* audio */
         case AV_CODEC_ID_PCM_MULAW:
@@ -662,6 +722,8 @@ string MediaSource::GetGuiNameFromCodecID(enum AVCodecID pCodecId)
  *        AV_CODEC_ID_MJPEG                mjpeg
  *        AV_CODEC_ID_THEORA               ogg
  *        AV_CODEC_ID_VP8                  webm
+ *        AV_CODEC_ID_VP9                  ivf  // framed by the RTP parser
+ *        AV_CODEC_ID_AV1                  obu
  *
  *
  *  audio codec ID to format mapping:
@@ -720,6 +782,12 @@ string MediaSource::GetFormatName(enum AVCodecID pCodecId)
         case AV_CODEC_ID_VP8:
                 tResult = "webm";
                 break;
+        case AV_CODEC_ID_VP9:
+                tResult = "ivf";
+                break;
+        case AV_CODEC_ID_AV1:
+                tResult = "obu";
+                break;
 
         /* audio */
         case AV_CODEC_ID_PCM_MULAW:
@@ -839,6 +907,11 @@ bool MediaSource::HasVariableOutputFrameRate()
     return false;
 }
 
+bool MediaSource::IsVideoFrameUnchanged()
+{
+    return false;
+}
+
 bool MediaSource::IsSeeking()
 {
     return false;
@@ -1028,6 +1101,16 @@ float MediaSource::GetFrameBufferTimeMax()
     return mDecoderFrameBufferTimeMax;
 }
 
+float MediaSource::GetFrameBufferActivePreBufferingTime()
+{
+    return mDecoderFramePreBufferTime;
+}
+
+int MediaSource::GetTimeToFirstFrame()
+{
+    return -1;
+}
+
 int MediaSource::GetFrameBufferCounter()
 {
     return 0;
@@ -1056,6 +1139,21 @@ int MediaSource::GetDecoderOutputFrameDelay()
     return mDecoderOutputFrameDelay;
 }
 
+void MediaSource::SetBackground(bool pBackground)
+{
+    SVC_MEDIA_MEMORY_BUDGET.SetStreamBackground(this, pBackground);
+}
+
+bool MediaSource::IsBackground()
+{
+    return SVC_MEDIA_MEMORY_BUDGET.IsStreamBackground(this);
+}
+
+int64_t MediaSource::GetMemoryUsage()
+{
+    return SVC_MEDIA_MEMORY_BUDGET.GetStreamUsage(this);
+}
+
 void MediaSource::CalibrateRTGrabbing()
 {
     LOG(LOG_WARN, "Called CalibrateRTGrabbing()");
@@ -1376,8 +1474,6 @@ bool MediaSource::UnregisterMediaSink(string pTarget, Requirements *pTransportRe
 
 void MediaSource::RegisterMediaFilter(MediaFilter *pMediaFilter)
 {
-    MediaFilters::iterator tIt;
-    bool tFound = false;
     string tId = pMediaFilter->GetId();
 
     if (tId == "")
@@ -1389,24 +1485,8 @@ void MediaSource::RegisterMediaFilter(MediaFilter *pMediaFilter)
 
     LOG(LOG_VERBOSE, "Registering %s %s media filter: %s", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), tId.c_str());
 
-    // lock
-    mMediaFiltersMutex.lock();
-
-    for (tIt = mMediaFilters.begin(); tIt != mMediaFilters.end(); tIt++)
-    {
-        if ((*tIt)->GetId() == tId)
-        {
-            LOG(LOG_WARN, "Filter already registered");
-            tFound = true;
-            break;
-        }
-    }
-
-    if (!tFound)
-        mMediaFilters.push_back(pMediaFilter);
-
-    // unlock
-    mMediaFiltersMutex.unlock();
+    if (!mMediaFilterPipeline.RegisterFilter(pMediaFilter))
+        LOG(LOG_WARN, "Filter already registered");
 
 //    return pMediaFilter;
 }
@@ -1414,7 +1494,6 @@ void MediaSource::RegisterMediaFilter(MediaFilter *pMediaFilter)
 bool MediaSource::UnregisterMediaFilter(MediaFilter *pMediaFilter, bool pAutoDelete)
 {
     bool tResult = false;
-    MediaFilters::iterator tIt;
     string tId = pMediaFilter->GetId();
 
     if (tId == "")
@@ -1422,61 +1501,18 @@ bool MediaSource::UnregisterMediaFilter(MediaFilter *pMediaFilter, bool pAutoDel
 
     LOG(LOG_VERBOSE, "Unregistering %s %s media filter: %s", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), tId.c_str());
 
-    // lock
-    mMediaFiltersMutex.lock();
-
-    for (tIt = mMediaFilters.begin(); tIt != mMediaFilters.end(); tIt++)
-    {
-        if ((*tIt)->GetId() == tId)
-        {
-            LOG(LOG_VERBOSE, "Found registered sink");
-
-            tResult = true;
-            // free memory of media sink object
-            if (pAutoDelete)
-            {
-                delete (*tIt);
-                LOG(LOG_VERBOSE, "..deleted");
-            }
-            // remove registration of media sink object
-            mMediaFilters.erase(tIt);
-            LOG(LOG_VERBOSE, "..unregistered");
-            break;
-        }
-    }
-
-    // unlock
-    mMediaFiltersMutex.unlock();
+    // returns after the filter pipeline doesn't use the filter anymore
+    tResult = mMediaFilterPipeline.UnregisterFilter(pMediaFilter, pAutoDelete);
+    if (tResult)
+        LOG(LOG_VERBOSE, "..unregistered");
 
     return tResult;
 }
 
 void MediaSource::DeleteAllRegisteredMediaFilters()
 {
-    MediaFilters::iterator tIt;
-
-    // lock
-    mMediaFiltersMutex.lock();
-
-    while(mMediaFilters.size())
-    {
-        for (tIt = mMediaFilters.begin(); tIt != mMediaFilters.end(); tIt++)
-        {
-            LOG(LOG_VERBOSE, "Deleting registered sink %s", (*tIt)->GetId().c_str());
-
-            // free memory of media sink object
-            delete (*tIt);
-            LOG(LOG_VERBOSE, "..deleted");
-
-            // remove registration of media sink object
-            mMediaFilters.erase(tIt);
-            LOG(LOG_VERBOSE, "..unregistered");
-            break;
-        }
-    }
-
-    // unlock
-    mMediaFiltersMutex.unlock();
+    LOG(LOG_VERBOSE, "Deleting %d registered filters", mMediaFilterPipeline.GetFilterCount());
+    mMediaFilterPipeline.DeleteAllFilters();
 }
 
 MediaSinkNet* MediaSource::RegisterMediaSink(string pTargetHost, unsigned int pTargetPort, Socket* pSocket, bool pRtpActivation, int pMaxFps)
@@ -1819,27 +1855,13 @@ int MediaSource::GetEncoderBufferedFrames()
     return 0;
 }
 
-void MediaSource::RelayChunkToMediaFilters(char* pPacketData, unsigned int pPacketSize, int64_t pPacketTimestamp, bool pIsKeyFrame)
+bool MediaSource::RelayChunkToMediaFilters(char* pPacketData, unsigned int pPacketSize, int64_t pPacketTimestamp, bool pIsKeyFrame, MediaFifo *pDeliveryFifo)
 {
-    MediaFilters::iterator tIt;
-
-    // lock
-    mMediaFiltersMutex.lock();
-
     #ifdef MS_DEBUG_PACKETS
-        LOG(LOG_VERBOSE, "Relaying chunk for %s %s media source to %d media filters", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), mMediaFilters.size());
+        LOG(LOG_VERBOSE, "Relaying chunk for %s %s media source to %d media filters", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), mMediaFilterPipeline.GetFilterCount());
     #endif
 
-    if (mMediaFilters.size() > 0)
-    {
-        for (tIt = mMediaFilters.begin(); tIt != mMediaFilters.end(); tIt++)
-        {
-            (*tIt)->FilterChunk(pPacketData, pPacketSize, pPacketTimestamp, (mFormatContext != NULL ? mFormatContext->streams[0] : NULL), pIsKeyFrame);
-        }
-    }
-
-    // unlock
-    mMediaFiltersMutex.unlock();
+    return mMediaFilterPipeline.FilterChunk(pPacketData, pPacketSize, pPacketTimestamp, (mFormatContext != NULL ? mFormatContext->streams[0] : NULL), pIsKeyFrame, pDeliveryFifo);
 }
 
 void MediaSource::RelayAVPacketToMediaSinks(AVPacket *pAVPacket)
@@ -2140,12 +2162,12 @@ bool MediaSource::StartRecording(std::string pSaveFileName, int pSaveFileQuality
         if (tCodec->capabilities & (CODEC_CAP_FRAME_THREADS | CODEC_CAP_SLICE_THREADS))
         {// threading supported
             // active multi-threading per default for the video encoding: leave two cpus for concurrent tasks (video grabbing/decoding, audio tasks)
-            av_dict_set(&tOptions, "threads", "auto", 0);
-
-            // trigger MT usage during video encoding
-            int tThreadCount = System::GetMachineCores() - 2;
-            if (tThreadCount > 1)
-                mRecorderCodecContext->thread_count = tThreadCount;
+            // trigger MT usage during video encoding, based on the cores we may really use (affinity, cgroup quota) instead of "auto" which sees all host cores
+            int tThreadCount = System::GetEffectiveCores() - 2;
+            if (tThreadCount < 1)
+                tThreadCount = 1;
+            mRecorderCodecContext->thread_count = tThreadCount;
+            av_dict_set(&tOptions, "threads", toString(tThreadCount).c_str(), 0);
         }else
         {// threading not supported
             LOG(LOG_WARN, "Multi-threading not supported for %s codec %s", GetMediaTypeStr().c_str(), tCodec->name);
@@ -2898,7 +2920,7 @@ std::string MediaSource::GetCurrentDeviceName()
     return mCurrentDeviceName;
 }
 
-bool MediaSource::RegisterMediaSource(MediaSource* pMediaSource)
+bool MediaSource::RegisterMediaSource(MediaSource* pMediaSource, bool pPreferred)
 {
     LOG(LOG_VERBOSE, "Registering media source: 0x%x", pMediaSource);
     LOG(LOG_VERBOSE, "This is only the dummy RegisterMediaSource() function");
@@ -2947,6 +2969,21 @@ bool MediaSource::TimeShift(int64_t pOffset)
     return false;
 }
 
+void MediaSource::SetSynchronizer(MediaSynchronizer *pSynchronizer)
+{
+    LOG(LOG_VERBOSE, "Setting synchronizer for %s source to: %p", GetMediaTypeStr().c_str(), pSynchronizer);
+
+    // waits until the decoder thread left the previous synchronizer, afterwards it may be deleted
+    mSynchronizerMutex.lock();
+    mSynchronizer = pSynchronizer;
+    mSynchronizerMutex.unlock();
+}
+
+MediaSynchronizer* MediaSource::GetSynchronizer()
+{
+    return mSynchronizer;
+}
+
 float MediaSource::GetRelativeLoss()
 {
     return 0;
@@ -2955,6 +2992,7 @@ float MediaSource::GetRelativeLoss()
 void* MediaSource::AllocChunkBuffer(int& pChunkBufferSize, enum MediaType pMediaType)
 {
     enum MediaType tMediaType = mMediaType;
+    void *tResult = NULL;
 
     if ((pMediaType == MEDIA_UNKNOWN) && (!mMediaSourceOpened))
     {
@@ -2970,18 +3008,25 @@ void* MediaSource::AllocChunkBuffer(int& pChunkBufferSize, enum MediaType pMedia
         case MEDIA_VIDEO:
             pChunkBufferSize = avpicture_get_size(PIX_FMT_RGB32, mTargetResX, mTargetResY) + FF_INPUT_BUFFER_PADDING_SIZE;
             LOG(LOG_VERBOSE, "Allocating %d bytes video buffer for %d*%d RGB32 pictures", pChunkBufferSize, mTargetResX, mTargetResY);
-            return av_malloc(pChunkBufferSize);
+            tResult = av_malloc(pChunkBufferSize);
+            break;
         case MEDIA_AUDIO:
             pChunkBufferSize = MEDIA_SOURCE_SAMPLES_MULTI_BUFFER_SIZE * 2 + FF_INPUT_BUFFER_PADDING_SIZE;
-            return av_malloc(pChunkBufferSize);
+            tResult = av_malloc(pChunkBufferSize);
+            break;
         default:
             LOG(LOG_WARN, "Undefined media type, returning chunk buffer will be invalid");
             return NULL;
     }
+
+    SVC_MEDIA_MEMORY_BUDGET.RegisterBuffer(tResult, pChunkBufferSize, this);
+
+    return tResult;
 }
 
 void MediaSource::FreeChunkBuffer(void *pChunk)
 {
+    SVC_MEDIA_MEMORY_BUDGET.UnregisterBuffer(pChunk);
     av_free(pChunk);
 }
 
@@ -3359,6 +3404,14 @@ bool MediaSource::FfmpegOpenInput(string pSource, int pLine, const char *pInputN
     return true;
 }
 
+void MediaSource::FfmpegCloseInput(string pSource, int pLine)
+{
+    LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Closing %s input", GetMediaTypeStr().c_str());
+
+    HM_avformat_close_input(mFormatContext);
+    mFormatContext = NULL;
+}
+
 bool MediaSource::FfmpegDetectAllStreams(string pSource, int pLine)
 {
     int                 tRes = 0;
@@ -3417,7 +3470,7 @@ bool MediaSource::FfmpegDetectAllStreams(string pSource, int pLine)
             LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Grabbing was stopped during avformat_find_stream_info()");
 
         // Close the video stream
-        HM_avformat_close_input(mFormatContext);
+        FfmpegCloseInput(pSource, pLine);
 
         return false;
     }else
@@ -3433,6 +3486,73 @@ bool MediaSource::FfmpegDetectAllStreams(string pSource, int pLine)
     return true;
 }
 
+/*
+ * Fast alternative to FfmpegDetectAllStreams() for inputs whose codec is already known,
+ * e.g., by SDP negotiation or the RTP payload type: the demuxers of raw elementary streams
+ * create their only stream without reading any data, hence the probing via avformat_find_stream_info()
+ * can be skipped. The remaining parameters are either fixed by the codec (audio, see RTP setup
+ * in MediaSourceMem) or get corrected by the decoder based on the in-band parameter sets (video resolution).
+ */
+bool MediaSource::FfmpegDescribeAllStreams(string pSource, int pLine)
+{
+    LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Going to describe the %s stream in input based on codec %s..", GetMediaTypeStr().c_str(), HM_avcodec_get_name(mSourceCodecId));
+
+    switch(mSourceCodecId)
+    {
+        // video
+        case AV_CODEC_ID_H261:
+        case AV_CODEC_ID_H263:
+        case AV_CODEC_ID_H264:
+        case AV_CODEC_ID_HEVC:
+        case AV_CODEC_ID_MPEG1VIDEO:
+        case AV_CODEC_ID_MPEG4:
+        case AV_CODEC_ID_VP9:
+        case AV_CODEC_ID_AV1:
+        // audio
+        case AV_CODEC_ID_PCM_MULAW:
+        case AV_CODEC_ID_PCM_ALAW:
+        case AV_CODEC_ID_GSM:
+        case AV_CODEC_ID_ADPCM_G722:
+        case AV_CODEC_ID_PCM_S16BE:
+            break;
+        default:
+            // containers (MPEG-TS, Ogg, WebM) and audio codecs with variable parameters (MP3, AAC, AMR) need probing
+            LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Codec %s can't be described without probing", HM_avcodec_get_name(mSourceCodecId));
+            return false;
+    }
+
+    if ((mFormatContext->nb_streams != 1) || (mFormatContext->streams[0]->codec->codec_id != mSourceCodecId))
+    {
+        LOG_REMOTE(LOG_WARN, pSource, pLine, "Input with %d streams doesn't match the expected %s codec %s", mFormatContext->nb_streams, GetMediaTypeStr().c_str(), HM_avcodec_get_name(mSourceCodecId));
+        return false;
+    }
+
+    AVCodecContext *tCodec = mFormatContext->streams[0]->codec;
+    if (mMediaType == MEDIA_VIDEO)
+    {
+        // start with the last known resolution, the decoder signals the real one with the first frame
+        if ((tCodec->width == 0) || (tCodec->height == 0))
+        {
+            tCodec->width = mSourceResX;
+            tCodec->height = mSourceResY;
+        }
+        // all supported video codecs deliver planar YUV 4:2:0 pictures
+        if (tCodec->pix_fmt == PIX_FMT_NONE)
+            tCodec->pix_fmt = PIX_FMT_YUV420P;
+    }
+
+    // verbose timestamp debugging
+    if (LOGGER.GetLogLevel() == LOG_WORLD)
+    {
+        LOG_REMOTE(LOG_WARN, pSource, pLine, "Enabling ffmpeg timestamp debugging for %s decoder", GetMediaTypeStr().c_str());
+        mFormatContext->debug = FF_FDEBUG_TS;
+    }
+
+    LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Described %s stream without probing", GetMediaTypeStr().c_str());
+
+    return true;
+}
+
 bool MediaSource::FfmpegSelectStream(string pSource, int pLine)
 {
     LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Going to find fitting %s stream..", GetMediaTypeStr().c_str());
@@ -3487,7 +3607,7 @@ bool MediaSource::FfmpegSelectStream(string pSource, int pLine)
         LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't find a %s stream..", GetMediaTypeStr().c_str());
 
         // Close the video stream
-        HM_avformat_close_input(mFormatContext);
+        FfmpegCloseInput(pSource, pLine);
 
         return false;
     }
@@ -3554,7 +3674,7 @@ bool MediaSource::FfmpegOpenDecoder(string pSource, int pLine)
     {
         LOG_REMOTE(LOG_ERROR, pSource, pLine, "Could not allocate decoder context because \"%s\"(%d)", strerror(AVUNERROR(tRes)), tRes);
 
-        HM_avformat_close_input(mFormatContext);
+        FfmpegCloseInput(pSource, pLine);
 
         return false;
     }
@@ -3562,7 +3682,7 @@ bool MediaSource::FfmpegOpenDecoder(string pSource, int pLine)
     {
         LOG_REMOTE(LOG_ERROR, pSource, pLine, "Could not create decoder context because \"%s\"(%d)", strerror(AVUNERROR(tRes)), tRes);
 
-        HM_avformat_close_input(mFormatContext);
+        FfmpegCloseInput(pSource, pLine);
 
         return false;
     }
@@ -3598,7 +3718,7 @@ bool MediaSource::FfmpegOpenDecoder(string pSource, int pLine)
         LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't detect VIDEO resolution information within input stream");
 
         // Close the video file
-        HM_avformat_close_input(mFormatContext);
+        FfmpegCloseInput(pSource, pLine);
 
         return false;
     }
@@ -3633,6 +3753,14 @@ bool MediaSource::FfmpegOpenDecoder(string pSource, int pLine)
     #endif
     //TODO: additional VDPAU stuff needed here
 
+    // AV1: prefer the software decoders because the native one depends on hardware acceleration
+    if ((tCodec == NULL) && (mCodecContext->codec_id == AV_CODEC_ID_AV1))
+    {
+        tCodec = avcodec_find_decoder_by_name("libdav1d");
+        if (tCodec == NULL)
+            tCodec = avcodec_find_decoder_by_name("libaom-av1");
+    }
+
     // try to find a standard decoder
     if (tCodec == NULL)
         tCodec = avcodec_find_decoder(mCodecContext->codec_id);
@@ -3642,7 +3770,7 @@ bool MediaSource::FfmpegOpenDecoder(string pSource, int pLine)
         LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't find a fitting %s codec", GetMediaTypeStr().c_str());
 
         // Close the video stream
-        HM_avformat_close_input(mFormatContext);
+        FfmpegCloseInput(pSource, pLine);
 
         return false;
     }
@@ -3666,6 +3794,15 @@ bool MediaSource::FfmpegOpenDecoder(string pSource, int pLine)
             }
     }
 
+    //VP9/AV1: frame threading delays each picture by one frame per thread, tile based threading doesn't
+    if (((mCodecContext->codec_id == AV_CODEC_ID_VP9) || (mCodecContext->codec_id == AV_CODEC_ID_AV1)) && (strcmp(mFormatContext->filename, "") == 0))
+    {
+        LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Using slice based MT for %s decoder", tCodec->name);
+        mCodecContext->thread_type = FF_THREAD_SLICE;
+        // libdav1d buffers several frames per default
+        av_dict_set(&tOptions, "max_frame_delay", "1", 0);
+    }
+
     if (tCodec->capabilities & CODEC_CAP_DR1)
     {
         LOG_REMOTE(LOG_WARN, pSource, pLine, "Enabling support for CODEC_FLAG_EMU_EDGE");
@@ -3680,7 +3817,7 @@ bool MediaSource::FfmpegOpenDecoder(string pSource, int pLine)
     {
         LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't open video codec because \"%s\"(%d)", strerror(AVUNERROR(tRes)), tRes);
 
-        HM_avformat_close_input(mFormatContext);
+        FfmpegCloseInput(pSource, pLine);
 
         return false;
     }
@@ -3954,8 +4091,7 @@ bool MediaSource::FfmpegCloseAll(string pSource, int pLine)
         if (mFormatContext != NULL)
         {
             LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "    ..closing %s format context and releasing codec context", GetMediaTypeStr().c_str());
-            HM_avformat_close_input(mFormatContext);
-            mFormatContext = NULL;
+            FfmpegCloseInput(pSource, pLine);
         }else
         {
             LOG_REMOTE(LOG_WARN, pSource, pLine, "Format context found in invalid state");
@@ -3974,6 +4110,7 @@ bool MediaSource::FfmpegEncodeAndWritePacket(string pSource, int pLine, AVFormat
     int                 tEncoderResult;
     int                 tFrameFinished;
     bool                tResult = false;
+    int64_t             tInputFramePts = (pInputFrame != NULL) ? pInputFrame->pts : -1; // NULL frame: flush the encoder
 
     // #########################################
     // init. packet structure
@@ -4008,7 +4145,7 @@ bool MediaSource::FfmpegEncodeAndWritePacket(string pSource, int pLine, AVFormat
                 LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Writing %s packet..", GetMediaTypeStr().c_str());
                 LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "      ..duration: %d", tPacket->duration);
                 LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "      ..flags: %d", tPacket->flags);
-                LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "      ..pts: %"PRId64" (frame pts: %"PRId64", buffered frames: %d)", tPacket->pts, pInputFrame->pts, pBufferedFrames);
+                LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "      ..pts: %"PRId64" (frame pts: %"PRId64", buffered frames: %d)", tPacket->pts, tInputFramePts, pBufferedFrames);
                 LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "      ..dts: %"PRId64"", tPacket->dts);
                 LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "      ..size: %d", tPacket->size);
                 LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "      ..pos: %"PRId64"", tPacket->pos);
@@ -4030,11 +4167,11 @@ bool MediaSource::FfmpegEncodeAndWritePacket(string pSource, int pLine, AVFormat
     }else
         if (AVUNERROR(tEncoderResult) != EPERM)
         {// failure reason is "operation not permitted"
-            LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't re-encode current %s frame %"PRId64" because %s(%d)", GetMediaTypeStr().c_str(), pInputFrame->pts, strerror(AVUNERROR(tEncoderResult)), tEncoderResult);
+            LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't re-encode current %s frame %"PRId64" because %s(%d)", GetMediaTypeStr().c_str(), tInputFramePts, strerror(AVUNERROR(tEncoderResult)), tEncoderResult);
         }else
         {// failure reason is something different
             #ifdef MS_DEBUG_ENCODER_PACKETS
-                LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't re-encode current %s frame %"PRId64" because %s(%d)", GetMediaTypeStr().c_str(), pInputFrame->pts, strerror(AVUNERROR(tEncoderResult)), tEncoderResult);
+                LOG_REMOTE(LOG_ERROR, pSource, pLine, "Couldn't re-encode current %s frame %"PRId64" because %s(%d)", GetMediaTypeStr().c_str(), tInputFramePts, strerror(AVUNERROR(tEncoderResult)), tEncoderResult);
             #endif
         }
     av_free_packet(tPacket);
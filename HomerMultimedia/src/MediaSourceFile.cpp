@@ -71,6 +71,7 @@ MediaSourceFile::MediaSourceFile(string pSourceFile, bool pGrabInRealTime):
     mDesiredDevice = pSourceFile;
     mGrabberProvidesRTGrabbing = pGrabInRealTime;
     mCurrentDeviceName = mDesiredDevice;
+    mDemuxer = NULL;
 }
 
 MediaSourceFile::~MediaSourceFile()
@@ -123,24 +124,24 @@ bool MediaSourceFile::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
     // set category for packet statistics
     ClassifyStream(DATA_TYPE_VIDEO, SOCKET_RAW);
 
-    if (!OpenInput(mDesiredDevice.c_str(), NULL, NULL))
-        return false;
-
-    if (!DetectAllStreams())
+    if (!OpenInputStreams())
         return false;
 
     if (!SelectStream())
         return false;
 
+    if (mDemuxer != NULL)
+        mDemuxer->Subscribe(mMediaType, mMediaStreamIndex);
+
     DetermineMetaData(mFormatContext->metadata, true);
 
     if (!OpenDecoder())
         return false;
 
-    if ((SupportsSeeking() /* ignore http::// and mms:// based streams */) && (mFormatContext->streams[mMediaStreamIndex]->duration > 1 /* ignore pictures: picture files would have 1 here */))
+    if ((SupportsSeeking() /* ignore http::// and mms:// based streams */) && (mFormatContext->streams[mMediaStreamIndex]->duration > 1 /* ignore pictures: picture files would have 1 here */) && (!JoinsSharedInput()))
     {
         int tResult = 0;
-        if((tResult = avformat_seek_file(mFormatContext, -1, INT64_MIN, 0, INT64_MAX, AVSEEK_FLAG_ANY)) < 0)
+        if((tResult = SeekInput(0, AVSEEK_FLAG_ANY)) < 0)
         {
             LOG(LOG_WARN, "Couldn't seek to the start of video stream because \"%s\".", strerror(AVUNERROR(tResult)));
         }
@@ -203,15 +204,12 @@ bool MediaSourceFile::OpenAudioGrabDevice(int pSampleRate, int pChannels)
         tIsNetworkStream = true;
     }
 
-    if (!OpenInput(mDesiredDevice.c_str(), NULL, NULL))
+    if (!OpenInputStreams())
         return false;
 
     mCurrentDevice = mDesiredDevice;
     mCurrentDeviceName = mDesiredDevice;
 
-    if (!DetectAllStreams())
-        return false;
-
     // enumerate all audio streams and store them as possible input channels
     // find correct audio stream, depending on the desired input channel
     string tEntry;
@@ -291,10 +289,13 @@ bool MediaSourceFile::OpenAudioGrabDevice(int pSampleRate, int pChannels)
     {
         LOG(LOG_ERROR, "Couldn't find an audio stream");
         // Close the audio file
-        HM_avformat_close_input(mFormatContext);
+        CloseInput();
         return false;
     }
 
+    if (mDemuxer != NULL)
+        mDemuxer->Subscribe(mMediaType, mMediaStreamIndex);
+
     DetermineMetaData(mFormatContext->metadata, true);
 
     mCurrentInputChannel = mDesiredInputChannel;
@@ -304,17 +305,9 @@ bool MediaSourceFile::OpenAudioGrabDevice(int pSampleRate, int pChannels)
 
     //HINT: OpenFormatConverter() will be called by the Run() method of MediaSourceMem
 
-    if (SupportsSeeking())
+    if ((SupportsSeeking()) && (!JoinsSharedInput()))
     {
-        if((tResult = avformat_seek_file(mFormatContext, -1, INT64_MIN, 0, INT64_MAX, AVSEEK_FLAG_ANY)) < 0)
-        {
-            LOG(LOG_WARN, "Couldn't seek to the start of audio stream because \"%s\".", strerror(AVUNERROR(tResult)));
-        }
-    }
-
-    if (SupportsSeeking())
-    {
-        if((tResult = avformat_seek_file(mFormatContext, -1, INT64_MIN, 0, INT64_MAX, AVSEEK_FLAG_ANY)) < 0)
+        if((tResult = SeekInput(0, AVSEEK_FLAG_ANY)) < 0)
         {
             LOG(LOG_WARN, "Couldn't seek to the start of audio stream because \"%s\".", strerror(AVUNERROR(tResult)));
         }
@@ -448,7 +441,7 @@ bool MediaSourceFile::Seek(float pSeconds, bool pOnlyKeyFrames)
                 int tSeekFlags = (pOnlyKeyFrames ? 0 : AVSEEK_FLAG_ANY) | AVSEEK_FLAG_FRAME | (tFrameIndex < mCurrentOutputFrameIndex ? AVSEEK_FLAG_BACKWARD : 0);
                 mDecoderTargetOutputFrameIndex = rint(tFrameIndex);
 
-                if ((tRes = avformat_seek_file(mFormatContext, -1, INT64_MIN, tTargetTimestamp, INT64_MAX, 0)) < 0)
+                if ((tRes = SeekInput(tTargetTimestamp)) < 0)
                 {
                     LOG(LOG_ERROR, "Error during absolute seeking in %s source file because \"%s\"", GetMediaTypeStr().c_str(), strerror(AVUNERROR(tResult)));
                     tResult = false;
@@ -673,11 +666,12 @@ void MediaSourceFile::StartDecoder()
 {
     // setting last decoder file position
     //HINT: we can not use Seek() because this would lead to recursion
-    if (SupportsSeeking())
+    //HINT: a shared input is already positioned by the other stream
+    if ((SupportsSeeking()) && (!JoinsSharedInput()))
     {
         LOG(LOG_VERBOSE, "Seeking to last %s decoder position: %.2f", GetMediaTypeStr().c_str(), mLastDecoderFilePosition);
         int tRes;
-        if ((tRes = avformat_seek_file(mFormatContext, -1, INT64_MIN, mInputStartPts + mLastDecoderFilePosition * AV_TIME_BASE, INT64_MAX, 0)) < 0)
+        if ((tRes = SeekInput(mInputStartPts + mLastDecoderFilePosition * AV_TIME_BASE)) < 0)
             LOG(LOG_ERROR, "Error during absolute seeking in %s source file because \"%s\"", GetMediaTypeStr().c_str(), strerror(AVUNERROR(tRes)));
     }
     MediaSourceMem::StartDecoder();
@@ -695,6 +689,79 @@ void MediaSourceFile::StopDecoder()
     MediaSourceMem::StopDecoder();
 }
 
+bool MediaSourceFile::OpenInputStreams()
+{
+    // web streams are read by each source on its own because a shared reader would block both sources on network stalls
+    if (IS_WEB_LINK(mDesiredDevice))
+    {
+        if (!OpenInput(mDesiredDevice.c_str(), NULL, NULL))
+            return false;
+
+        return DetectAllStreams();
+    }
+
+    if (mMediaSourceOpened)
+    {
+        LOG(LOG_ERROR, "%s source already open", GetMediaTypeStr().c_str());
+        return false;
+    }
+
+    // the container is opened, probed and read only once for both the video and the audio source
+    mDemuxer = MediaDemuxer::Acquire(mDesiredDevice, mMediaType);
+    if (mDemuxer == NULL)
+        return false;
+
+    mFormatContext = mDemuxer->GetFormatContext();
+    mCurrentDevice = mDesiredDevice;
+    mCurrentDeviceName = mDesiredDevice;
+
+    return true;
+}
+
+bool MediaSourceFile::JoinsSharedInput()
+{
+    return ((mDemuxer != NULL) && (mDemuxer->IsShared()));
+}
+
+int MediaSourceFile::SeekInput(int64_t pTimestamp, int pFlags)
+{
+    if (mDemuxer != NULL)
+        return mDemuxer->Seek(mMediaType, pTimestamp, pFlags);
+    else
+        return avformat_seek_file(mFormatContext, -1, INT64_MIN, pTimestamp, INT64_MAX, pFlags);
+}
+
+int MediaSourceFile::ReadInputPacket(AVPacket *pPacket)
+{
+    if (mDemuxer == NULL)
+        return MediaSourceMem::ReadInputPacket(pPacket);
+
+    // the other stream has seeked in the shared input, we continue at the new position
+    if (mDemuxer->WasRepositioned(mMediaType))
+    {
+        LOG(LOG_VERBOSE, "Shared input of %s source was repositioned by another stream", GetMediaTypeStr().c_str());
+        ResetDecoderBuffers();
+        mDecoderRecalibrateRTGrabbingAfterSeeking = true;
+        mEOFReached = false;
+    }
+
+    return mDemuxer->ReadPacket(mMediaType, pPacket);
+}
+
+void MediaSourceFile::FfmpegCloseInput(string pSource, int pLine)
+{
+    if (mDemuxer == NULL)
+    {
+        MediaSourceMem::FfmpegCloseInput(pSource, pLine);
+        return;
+    }
+
+    LOG_REMOTE(LOG_VERBOSE, pSource, pLine, "Releasing shared %s input", GetMediaTypeStr().c_str());
+    MediaDemuxer::Release(mDemuxer, mMediaType);
+    mDemuxer = NULL;
+    mFormatContext = NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }} //namespace
@@ -29,6 +29,8 @@
 
 #include <MediaSourceMem.h>
 #include <MediaSource.h>
+#include <MediaSynchronizer.h>
+#include <MediaMemoryBudget.h>
 #include <ProcessStatisticService.h>
 #include <RTP.h>
 
@@ -68,6 +70,19 @@ using namespace Homer::Base;
 // how much delay for frame playback do we allow before we drop the frame?
 #define MEDIA_SOURCE_MEM_FRAME_DROP_THRESHOLD                               0.4 // seconds
 
+// adaptive pre-buffering for memory/network sources: start with a small pre-buffer and grow it only if underruns occur
+#define MEDIA_SOURCE_MEM_FAST_START_PRE_BUFFER_TIME                         0.02 // seconds
+#define MEDIA_SOURCE_MEM_PRE_BUFFER_GROWTH_STEP                             0.05 // seconds
+// how late may a frame be before we count it as underrun?
+#define MEDIA_SOURCE_MEM_UNDERRUN_TOLERANCE                                 0.01 // seconds
+
+// how much more than the pre-buffer time may be buffered before we catch up by playing faster?
+#define MEDIA_SOURCE_MEM_CATCH_UP_THRESHOLD                                 0.15 // seconds
+// how much faster do we play while catching up?
+#define MEDIA_SOURCE_MEM_CATCH_UP_SPEED_UP                                  0.05 // 5 %
+// how much more than the pre-buffer time may be buffered before the video decoder skips non-reference frames?
+#define MEDIA_SOURCE_MEM_CATCH_UP_SKIP_THRESHOLD                            0.5 // seconds
+
 ///////////////////////////////////////////////////////////////////////////////
 
 MediaSourceMem::MediaSourceMem(string pName):
@@ -92,6 +107,7 @@ MediaSourceMem::MediaSourceMem(string pName):
     mLastBufferedOutputFrameIndex = 0;
     mLastTimeWaitForRTGrabbing = 0;
     mTimeLastWrittenOutputChunk = 0;
+    ResetAdaptivePreBuffering();
     mWrappingHeaderSize= 0;
     mGrabberProvidesRTGrabbing = true;
     mSourceType = SOURCE_MEMORY;
@@ -104,8 +120,14 @@ MediaSourceMem::MediaSourceMem(string pName):
 
     mRtpSourceCodecIdHint = AV_CODEC_ID_NONE;
     mSourceCodecId = AV_CODEC_ID_NONE;
+    mFastOpen = true;
+    mStreamDescribed = false;
+    mStreamDescriptionMismatch = false;
+    mStreamDescriptionMismatchCodecId = AV_CODEC_ID_NONE;
 
     mDecoderFragmentFifo = new MediaFifo(MEDIA_SOURCE_MEM_FRAGMENT_INPUT_QUEUE_SIZE_LIMIT, MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE, "MediaSourceMem-Fragments");
+    // the input FIFO is only accounted, shrinking it would cause packet loss
+    SVC_MEDIA_MEMORY_BUDGET.AssignFifo(mDecoderFragmentFifo, this, false);
     LOG(LOG_VERBOSE, "Listen for video/audio frames with queue of %d bytes", MEDIA_SOURCE_MEM_FRAGMENT_INPUT_QUEUE_SIZE_LIMIT * MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE);
 }
 
@@ -559,6 +581,10 @@ bool MediaSourceMem::SupportsRelaying()
 
 bool MediaSourceMem::HasInputStreamChanged()
 {
+    // a stream which doesn't match its description has to be reopened with probing
+    if (mStreamDescriptionMismatch)
+        return true;
+
     bool tResult = HasSourceChangedFromRTP();
     enum AVCodecID tNewCodecId = AV_CODEC_ID_NONE;
 
@@ -596,6 +622,12 @@ bool MediaSourceMem::HasInputStreamChanged()
             case 124:
                     tNewCodecId = AV_CODEC_ID_HEVC;
                     break;
+            case 125:
+                    tNewCodecId = AV_CODEC_ID_VP9;
+                    break;
+            case 126:
+                    tNewCodecId = AV_CODEC_ID_AV1;
+                    break;
 
             //audio
             case 0:
@@ -803,6 +835,61 @@ void MediaSourceMem::SetFrameBufferPreBufferingTime(float pTime)
     MediaSource::SetFrameBufferPreBufferingTime(pTime);
 }
 
+float MediaSourceMem::GetFrameBufferActivePreBufferingTime()
+{
+    if (!UsesAdaptivePreBuffering())
+        return mDecoderFramePreBufferTime;
+
+    // the configured pre-buffer time is the upper limit
+    if (mAdaptivePreBufferTime > mDecoderFramePreBufferTime)
+        return mDecoderFramePreBufferTime;
+    else
+        return mAdaptivePreBufferTime;
+}
+
+int MediaSourceMem::GetTimeToFirstFrame()
+{
+    return mTimeToFirstFrame;
+}
+
+void MediaSourceMem::SetFastOpen(bool pActive)
+{
+    if (mFastOpen != pActive)
+    {
+        LOG(LOG_VERBOSE, "Setting fast open for %s source to: %d", GetMediaTypeStr().c_str(), pActive);
+        mFastOpen = pActive;
+    }
+}
+
+bool MediaSourceMem::UsesFastOpen()
+{
+    return mFastOpen;
+}
+
+/*
+ * For RTP streams the codec is known from the negotiation and the RTP payload type,
+ * so the input is described without probing. Probing is used as fall back if the
+ * input doesn't fit to the description or if the decoder reported a mismatch before.
+ */
+bool MediaSourceMem::DetectOrDescribeAllStreams()
+{
+    mStreamDescribed = false;
+
+    if ((mFastOpen) && (mRtpActivated) && (mSourceCodecId != mStreamDescriptionMismatchCodecId))
+    {
+        if (DescribeAllStreams())
+        {
+            mStreamDescribed = true;
+            mStreamDescriptionMismatch = false;
+            return true;
+        }
+        LOG(LOG_VERBOSE, "Falling back to probing of %s stream", GetMediaTypeStr().c_str());
+    }
+    mStreamDescriptionMismatch = false;
+
+    return DetectAllStreams();
+}
+
 bool MediaSourceMem::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
 {
     AVIOContext         *tIoContext;
@@ -847,8 +934,8 @@ bool MediaSourceMem::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
     if (!tRes)
         return false;
 
-    // detect all available video/audio streams in the input
-    if (!DetectAllStreams())
+    // describe the stream based on the negotiated codec or detect all available video/audio streams in the input
+    if (!DetectOrDescribeAllStreams())
         return false;
 
     // select the first matching stream according to mMediaType
@@ -870,6 +957,9 @@ bool MediaSourceMem::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
 
     MarkOpenGrabDeviceSuccessful();
 
+    // start with a small pre-buffer, the playback begins with the first decodable key frame
+    ResetAdaptivePreBuffering();
+
     if (!mGrabbingStopped)
         StartDecoder();
 
@@ -917,8 +1007,8 @@ bool MediaSourceMem::OpenAudioGrabDevice(int pSampleRate, int pChannels)
     if (!tRes)
         return false;
 
-    // detect all available video/audio streams in the input
-    if (!DetectAllStreams())
+    // describe the stream based on the negotiated codec or detect all available video/audio streams in the input
+    if (!DetectOrDescribeAllStreams())
         return false;
 
     // select the first matching stream according to mMediaType
@@ -984,6 +1074,9 @@ bool MediaSourceMem::OpenAudioGrabDevice(int pSampleRate, int pChannels)
 
     MarkOpenGrabDeviceSuccessful();
 
+    // start with a small pre-buffer, the playback begins with the first decodable key frame
+    ResetAdaptivePreBuffering();
+
     if (!mGrabbingStopped)
         StartDecoder();
 
@@ -1134,8 +1227,8 @@ int MediaSourceMem::GrabChunk(void* pChunkBuffer, int& pChunkSize, bool pDropChu
             }
         }
 
-        // should we restart pre-buffering?
-        if ((mDecoderFramePreBufferingAutoRestart) && (mDecoderFramePreBufferTime > 0) && (mDecoderFrameBufferTime < MEDIA_SOURCE_MEM_DEFAULT_E2E_DELAY_JITER))
+        // should we restart pre-buffering? (an adaptive pre-buffer grows on underruns instead)
+        if ((mDecoderFramePreBufferingAutoRestart) && (mDecoderFramePreBufferTime > 0) && (!UsesAdaptivePreBuffering()) && (mDecoderFrameBufferTime < MEDIA_SOURCE_MEM_DEFAULT_E2E_DELAY_JITER))
         {// time to restart pre-buffering
             LOG(LOG_VERBOSE, "Pre-buffering will be restarted now..");
 
@@ -1265,6 +1358,13 @@ int MediaSourceMem::GrabChunk(void* pChunkBuffer, int& pChunkSize, bool pDropChu
         }
     }while (tShouldGrabNext);
 
+    // report the join latency once
+    if (mTimeToFirstFrame < 0)
+    {
+        mTimeToFirstFrame = (int)((Time::GetTimeStamp() - mTimeGrabbingStarted) / 1000);
+        LOG(LOG_VERBOSE, "First %s frame from %s source grabbed after %d ms, pre-buffer time: %.0f ms, buffered: %.0f ms", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), mTimeToFirstFrame, GetFrameBufferActivePreBufferingTime() * 1000, mDecoderFrameBufferTime * 1000);
+    }
+
     // acknowledge success
     MarkGrabChunkSuccessful(mFrameNumber);
 
@@ -1360,6 +1460,11 @@ void MediaSourceMem::CloseVideoScaler(VideoScaler *pScaler)
     pScaler->StopScaler();
 }
 
+int MediaSourceMem::ReadInputPacket(AVPacket *pPacket)
+{
+    return av_read_frame(mFormatContext, pPacket);
+}
+
 void MediaSourceMem::ReadFrameFromInputStream(AVPacket *pPacket, double &pFrameTimestamp)
 {
     int             tRes;
@@ -1401,7 +1506,7 @@ void MediaSourceMem::ReadFrameFromInputStream(AVPacket *pPacket, double &pFrameT
         // #########################################
         // read next sample from source - BLOCKING
         // #########################################
-        tRes = av_read_frame(mFormatContext, pPacket);
+        tRes = ReadInputPacket(pPacket);
         if (tRes < 0)
         {// failed to read frame
             #ifdef MSMEM_DEBUG_PACKETS
@@ -1694,6 +1799,7 @@ void* MediaSourceMem::Run(void* pArgs)
 
                 LOG(LOG_VERBOSE, "Creating %s media FIFO with %d entries of %d bytes", GetMediaTypeStr().c_str(), CalculateFrameBufferSize(), tChunkBufferSize);
                 mDecoderFifo = new MediaFifo(CalculateFrameBufferSize(), tChunkBufferSize, GetMediaTypeStr() + "-MediaSource" + GetSourceTypeStr());
+                SVC_MEDIA_MEMORY_BUDGET.AssignFifo(mDecoderFifo, this);
             }
 
             break;
@@ -1711,6 +1817,8 @@ void* MediaSourceMem::Run(void* pArgs)
 
             LOG(LOG_VERBOSE, "Creating %s media FIFO with %d entries of %d bytes", GetMediaTypeStr().c_str(), CalculateFrameBufferSize(), tChunkBufferSize);
             mDecoderFifo = new MediaFifo(CalculateFrameBufferSize(), tChunkBufferSize, GetMediaTypeStr() + "-MediaSource" + GetSourceTypeStr());
+            // one input frame may result in several output frames, the decoder would stall if the FIFO was shrunk
+            SVC_MEDIA_MEMORY_BUDGET.AssignFifo(mDecoderFifo, this, false);
 
             break;
         default:
@@ -1835,6 +1943,9 @@ void* MediaSourceMem::Run(void* pArgs)
                                 // ############################
                                 // ### DECODE FRAME
                                 // ############################
+                                // skip frames which aren't referenced by others as long as the grabber has to catch up
+                                mCodecContext->skip_frame = (mDecoderSkipNonReferenceFrames ? AVDISCARD_NONREF : AVDISCARD_DEFAULT);
+
                                 tFrameFinished = 0;
                                 tDecoderResult = HM_avcodec_decode_video(mCodecContext, tVideoSourceFrame, &tFrameFinished, tPacket);
 
@@ -1896,6 +2007,17 @@ void* MediaSourceMem::Run(void* pArgs)
                                     mSourceCodecId = mCodecContext->codec_id;
                                 }
 
+                                // ############################
+                                // ### check stream description
+                                // ############################
+                                // the video scaler was started with the described pixel format, a reset with probing is needed if the decoder delivers another one
+                                if ((mStreamDescribed) && (!mStreamDescriptionMismatch) && (mCodecContext->pix_fmt != mMediaStream->codec->pix_fmt))
+                                {
+                                    LOG(LOG_WARN, "Decoded video frame has pixel format %s instead of described %s, stream has to be probed", av_get_pix_fmt_name(mCodecContext->pix_fmt), av_get_pix_fmt_name(mMediaStream->codec->pix_fmt));
+                                    mStreamDescriptionMismatchCodecId = mSourceCodecId;
+                                    mStreamDescriptionMismatch = true;
+                                }
+
                                 // ############################
                                 // ### check video resolution
                                 // ############################
@@ -2132,9 +2254,17 @@ void* MediaSourceMem::Run(void* pArgs)
                                     }
                                 }else
                                 {// tFrameFinished != 1
-                                    LOG(LOG_WARN, "Video frame was buffered, FrameFinished: %d, codec context flags: 0x%X", tFrameFinished, mCodecContext->flags);
-                                    if (tPacket->data != NULL)
-                                        mDecoderOutputFrameDelay++;
+                                    if (mCodecContext->skip_frame == AVDISCARD_DEFAULT)
+                                    {
+                                        LOG(LOG_WARN, "Video frame was buffered, FrameFinished: %d, codec context flags: 0x%X", tFrameFinished, mCodecContext->flags);
+                                        if (tPacket->data != NULL)
+                                            mDecoderOutputFrameDelay++;
+                                    }else
+                                    {// frame was skipped during catch-up
+                                        #ifdef MSMEM_DEBUG_CATCH_UP
+                                            LOG(LOG_VERBOSE, "Skipped non-reference video frame during catch-up");
+                                        #endif
+                                    }
                                 }
                             }else
                             {// tDecoderResult < 0
@@ -2158,158 +2288,192 @@ void* MediaSourceMem::Run(void* pArgs)
                             int tOutputAudioBytesPerSample = av_get_bytes_per_sample(mOutputAudioFormat);
                             int tInputAudioBytesPerSample = av_get_bytes_per_sample(mInputAudioFormat);
 
-                            // Decode the next chunk of data
-                            tDecoderResult = avcodec_decode_audio4(mCodecContext, tAudioFrame, &tFrameFinished, tPacket);
-                            if (tDecoderResult >= 0)
+                            // Decode the next chunk of data, a packet may contain several audio frames (e.g., aggregated AMR-NB frames)
+                            uint8_t *tPacketData = tPacket->data;
+                            int tPacketSize = tPacket->size;
+                            while (true)
                             {
-                                if (tFrameFinished != 0)
+                                tDecodedAudioSamples = tChunkBuffer;
+                                tDecoderResult = avcodec_decode_audio4(mCodecContext, tAudioFrame, &tFrameFinished, tPacket);
+                                if (tDecoderResult >= 0)
                                 {
-                                    if ((!tAlreadyWarnedThatFrameSizeDiffers) && (tAudioFrame->nb_samples != mCodecContext->frame_size))
+                                    if (tFrameFinished != 0)
                                     {
-                                        tAlreadyWarnedThatFrameSizeDiffers = true;
-                                        LOG(LOG_WARN, "Audio frame size %d differs from the codec specific frame size %d, will ignore this in the future and prevent further warnings about this", tAudioFrame->nb_samples, mCodecContext->frame_size);
-                                    }
-
-                                    // ############################
-                                    // ### ANNOUNCE FRAME (statistics)
-                                    // ############################
-                                    AnnounceFrame(tAudioFrame);
-
-                                    // ############################
-                                    // ### RECORD FRAME
-                                    // ############################
-                                    // re-encode the frame and write it to file
-                                    if (mRecording)
-                                        RecordFrame(tAudioFrame);
-
-                                    #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
-                                        LOG(LOG_VERBOSE, "New audio frame..");
-                                        LOG(LOG_VERBOSE, "      ..pts: %"PRId64", original PTS: %.2f, BE PTS: %lld", tAudioFrame->pts, (float)tCurrentInputFrameTimestamp, av_frame_get_best_effort_timestamp(tAudioFrame));
-                                        LOG(LOG_VERBOSE, "      ..size: %d bytes (%d samples of format %s)", tAudioFrame->nb_samples * tOutputAudioBytesPerSample * mOutputAudioChannels, tAudioFrame->nb_samples, av_get_sample_fmt_name(mOutputAudioFormat));
-                                    #endif
-
-                                    if (mAudioResampleContext != NULL)
-                                    {// audio resampling needed: we have to insert an intermediate step, which resamples the audio chunk
+                                        if ((!tAlreadyWarnedThatFrameSizeDiffers) && (tAudioFrame->nb_samples != mCodecContext->frame_size))
+                                        {
+                                            tAlreadyWarnedThatFrameSizeDiffers = true;
+                                            LOG(LOG_WARN, "Audio frame size %d differs from the codec specific frame size %d, will ignore this in the future and prevent further warnings about this", tAudioFrame->nb_samples, mCodecContext->frame_size);
+                                        }
 
                                         // ############################
-                                        // ### RESAMPLE FRAME (CONVERT)
+                                        // ### check stream description
                                         // ############################
-                                        const uint8_t **tAudioFramePlanes = (const uint8_t **)tAudioFrame->extended_data;
-                                        int tResampledBytes = (tOutputAudioBytesPerSample * mOutputAudioChannels) * HM_swr_convert(mAudioResampleContext, (uint8_t**)&tDecodedAudioSamples /* only one plane because this is packed audio data */, AVCODEC_MAX_AUDIO_FRAME_SIZE / (tOutputAudioBytesPerSample * mOutputAudioChannels) /* amount of possible output samples */, (const uint8_t**)tAudioFramePlanes, tAudioFrame->nb_samples);
-                                        if(tResampledBytes > 0)
+                                        // the resampler was created with the described audio parameters, a reset with probing is needed if the decoder delivers other ones
+                                        if ((mStreamDescribed) && (!mStreamDescriptionMismatch) && ((mCodecContext->sample_rate != mInputAudioSampleRate) || (mCodecContext->channels != mInputAudioChannels) || (mCodecContext->sample_fmt != mInputAudioFormat)))
                                         {
-                                            tCurrentChunkSize = tResampledBytes;
-                                        }else
-                                        {
-                                            LOG(LOG_ERROR, "Amount of resampled bytes (%d) is invalid", tResampledBytes);
+                                            LOG(LOG_WARN, "Decoded audio frame has %d Hz, %d channels and format %s instead of described %d Hz, %d channels and format %s, stream has to be probed", mCodecContext->sample_rate, mCodecContext->channels, av_get_sample_fmt_name(mCodecContext->sample_fmt), mInputAudioSampleRate, mInputAudioChannels, av_get_sample_fmt_name(mInputAudioFormat));
+                                            mStreamDescriptionMismatchCodecId = mSourceCodecId;
+                                            mStreamDescriptionMismatch = true;
                                         }
-                                    }else
-                                    {// no audio resampling needed
-                                        // we can use the input buffer without modifications
-                                        tCurrentChunkSize = av_samples_get_buffer_size(NULL, mCodecContext->channels, tAudioFrame->nb_samples, (enum AVSampleFormat) tAudioFrame->format, 1);
-                                        tDecodedAudioSamples = tAudioFrame->data[0];
-                                    }
-
-                                    if (tCurrentChunkSize > 0)
-                                    {
-                                        // get the buffered samples (= pts)
-                                        int tAudioFifoBufferedSamples = av_fifo_size(mResampleFifo[0]) /* buffer sie in bytes */ / (tOutputAudioBytesPerSample * mOutputAudioChannels);
 
                                         // ############################
-                                        // ### WRITE FRAME TO FIFO
+                                        // ### ANNOUNCE FRAME (statistics)
                                         // ############################
-                                        #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
-                                            LOG(LOG_VERBOSE, "Adding %d bytes to AUDIO FIFO with buffer of %d bytes (%d samples), packet pts: %.2f", tCurrentChunkSize, av_fifo_size(mResampleFifo[0]), tAudioFifoBufferedSamples, (float)tCurrentInputFrameTimestamp);
-                                        #endif
-                                        // is there enough space in the FIFO?
-                                        if (av_fifo_space(mResampleFifo[0]) < tCurrentChunkSize)
-                                        {// no, we need reallocation
-                                            if (av_fifo_realloc2(mResampleFifo[0], av_fifo_size(mResampleFifo[0]) + tCurrentChunkSize - av_fifo_space(mResampleFifo[0])) < 0)
-                                            {
-                                                // acknowledge failed
-                                                LOG(LOG_ERROR, "Reallocation of FIFO audio buffer failed");
-                                            }
-                                        }
-
-                                        // write new samples into fifo buffer
-                                        av_fifo_generic_write(mResampleFifo[0], tDecodedAudioSamples, tCurrentChunkSize, NULL);
+                                        AnnounceFrame(tAudioFrame);
 
                                         // ############################
-                                        // ### calculate PTS value
+                                        // ### RECORD FRAME
                                         // ############################
-                                        // save PTS value to deliver it later to the frame grabbing thread
-                                        if ((tAudioFrame->pkt_dts != (int64_t)AV_NOPTS_VALUE) || (tAudioFrame->pkt_pts != (int64_t)AV_NOPTS_VALUE))
-                                        {// use PTS/DTS
-                                            tCurrentOutputFrameTimestamp = HM_av_frame_get_best_effort_timestamp(tAudioFrame);
-                                            #ifdef MSMEM_DEBUG_TIMING
-                                                LOG(LOG_VERBOSE, "Setting current frame PTS to frame packet BE PTS: %"PRId64, tCurrentOutputFrameTimestamp);
-                                            #endif
-                                        }else
-                                        {// fall back to packet's PTS value
-                                            #ifdef MSMEM_DEBUG_TIMING
-                                                LOG(LOG_VERBOSE, "Setting current frame PTS to packet PTS: %.2f", (float)tCurrentInputFrameTimestamp);
-                                            #endif
-                                            tCurrentOutputFrameTimestamp = tCurrentInputFrameTimestamp;
-                                        }
-
-                                        tCurrentOutputFrameNumber = CalculateOutputFrameNumber(tCurrentOutputFrameTimestamp) - (double)tAudioFifoBufferedSamples / MEDIA_SOURCE_SAMPLES_PER_BUFFER /* frame shift */;
-                                        //TODO: LOG(LOG_WARN, "%s: %.2f => %.2f", GetMediaTypeStr().c_str(), (float)tCurrentInputFrameTimestamp, (float)tCurrentOutputFrameNumber);
+                                        // re-encode the frame and write it to file
+                                        if (mRecording)
+                                            RecordFrame(tAudioFrame);
 
-                                        // save PTS value to deliver it later to the frame grabbing thread
                                         #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
-                                            LOG(LOG_VERBOSE, "Setting current frame nr. to %.2lf, packet PTS: %.2f", tCurrentOutputFrameNumber, (float)tCurrentInputFrameTimestamp);
+                                            LOG(LOG_VERBOSE, "New audio frame..");
+                                            LOG(LOG_VERBOSE, "      ..pts: %"PRId64", original PTS: %.2f, BE PTS: %lld", tAudioFrame->pts, (float)tCurrentInputFrameTimestamp, av_frame_get_best_effort_timestamp(tAudioFrame));
+                                            LOG(LOG_VERBOSE, "      ..size: %d bytes (%d samples of format %s)", tAudioFrame->nb_samples * tOutputAudioBytesPerSample * mOutputAudioChannels, tAudioFrame->nb_samples, av_get_sample_fmt_name(mOutputAudioFormat));
                                         #endif
 
-                                        // the amount of bytes we want to have in an output frame
-                                        int tDesiredOutputSize = MEDIA_SOURCE_SAMPLES_PER_BUFFER * tOutputAudioBytesPerSample * mOutputAudioChannels;
+                                        if (mAudioResampleContext != NULL)
+                                        {// audio resampling needed: we have to insert an intermediate step, which resamples the audio chunk
 
-                                        int tLoops = 0;
-                                        while (av_fifo_size(mResampleFifo[0]) >= MEDIA_SOURCE_SAMPLES_PER_BUFFER * tOutputAudioBytesPerSample * mOutputAudioChannels)
+                                            // ############################
+                                            // ### RESAMPLE FRAME (CONVERT)
+                                            // ############################
+                                            const uint8_t **tAudioFramePlanes = (const uint8_t **)tAudioFrame->extended_data;
+                                            int tResampledBytes = (tOutputAudioBytesPerSample * mOutputAudioChannels) * HM_swr_convert(mAudioResampleContext, (uint8_t**)&tDecodedAudioSamples /* only one plane because this is packed audio data */, AVCODEC_MAX_AUDIO_FRAME_SIZE / (tOutputAudioBytesPerSample * mOutputAudioChannels) /* amount of possible output samples */, (const uint8_t**)tAudioFramePlanes, tAudioFrame->nb_samples);
+                                            if(tResampledBytes > 0)
+                                            {
+                                                tCurrentChunkSize = tResampledBytes;
+                                            }else
+                                            {
+                                                LOG(LOG_ERROR, "Amount of resampled bytes (%d) is invalid", tResampledBytes);
+                                            }
+                                        }else
+                                        {// no audio resampling needed
+                                            // we can use the input buffer without modifications
+                                            tCurrentChunkSize = av_samples_get_buffer_size(NULL, mCodecContext->channels, tAudioFrame->nb_samples, (enum AVSampleFormat) tAudioFrame->format, 1);
+                                            tDecodedAudioSamples = tAudioFrame->data[0];
+                                        }
+
+                                        if (tCurrentChunkSize > 0)
                                         {
-                                            tLoops++;
+                                            // get the buffered samples (= pts)
+                                            int tAudioFifoBufferedSamples = av_fifo_size(mResampleFifo[0]) /* buffer sie in bytes */ / (tOutputAudioBytesPerSample * mOutputAudioChannels);
+
                                             // ############################
-                                            // ### READ FRAME FROM FIFO
+                                            // ### WRITE FRAME TO FIFO
                                             // ############################
                                             #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
-                                                LOG(LOG_VERBOSE, "Loop %d-Reading %d bytes from %d bytes of fifo, current frame nr.: %.2lf", tLoops, tDesiredOutputSize, av_fifo_size(mResampleFifo[0]), tCurrentOutputFrameNumber);
+                                                LOG(LOG_VERBOSE, "Adding %d bytes to AUDIO FIFO with buffer of %d bytes (%d samples), packet pts: %.2f", tCurrentChunkSize, av_fifo_size(mResampleFifo[0]), tAudioFifoBufferedSamples, (float)tCurrentInputFrameTimestamp);
                                             #endif
-                                            // read sample data from the fifo buffer
-                                            HM_av_fifo_generic_read(mResampleFifo[0], (void*)tChunkBuffer, tDesiredOutputSize);
-                                            tCurrentChunkSize = tDesiredOutputSize;
+                                            // is there enough space in the FIFO?
+                                            if (av_fifo_space(mResampleFifo[0]) < tCurrentChunkSize)
+                                            {// no, we need reallocation
+                                                if (av_fifo_realloc2(mResampleFifo[0], av_fifo_size(mResampleFifo[0]) + tCurrentChunkSize - av_fifo_space(mResampleFifo[0])) < 0)
+                                                {
+                                                    // acknowledge failed
+                                                    LOG(LOG_ERROR, "Reallocation of FIFO audio buffer failed");
+                                                }
+                                            }
+
+                                            // write new samples into fifo buffer
+                                            av_fifo_generic_write(mResampleFifo[0], tDecodedAudioSamples, tCurrentChunkSize, NULL);
 
                                             // ############################
-                                            // ### WRITE FRAME TO OUTPUT FIFO
+                                            // ### calculate PTS value
                                             // ############################
-                                            // add new chunk to FIFO
-                                            if (tCurrentChunkSize <= mDecoderFifo->GetEntrySize())
-                                            {
-                                                #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
-                                                    LOG(LOG_VERBOSE, "Writing %d %s bytes at %p to output FIFO with frame nr. %.2lf, remaining audio data: %d bytes", tCurrentChunkSize, GetMediaTypeStr().c_str(), tChunkBuffer, tCurrentOutputFrameNumber, av_fifo_size(mResampleFifo[0]));
+                                            // save PTS value to deliver it later to the frame grabbing thread
+                                            if ((tAudioFrame->pkt_dts != (int64_t)AV_NOPTS_VALUE) || (tAudioFrame->pkt_pts != (int64_t)AV_NOPTS_VALUE))
+                                            {// use PTS/DTS
+                                                tCurrentOutputFrameTimestamp = HM_av_frame_get_best_effort_timestamp(tAudioFrame);
+                                                #ifdef MSMEM_DEBUG_TIMING
+                                                    LOG(LOG_VERBOSE, "Setting current frame PTS to frame packet BE PTS: %"PRId64, tCurrentOutputFrameTimestamp);
                                                 #endif
-                                                WriteOutputChunk((char*)tChunkBuffer, tCurrentChunkSize, (int64_t)rint(tCurrentOutputFrameNumber));
+                                            }else
+                                            {// fall back to packet's PTS value
+                                                #ifdef MSMEM_DEBUG_TIMING
+                                                    LOG(LOG_VERBOSE, "Setting current frame PTS to packet PTS: %.2f", (float)tCurrentInputFrameTimestamp);
+                                                #endif
+                                                tCurrentOutputFrameTimestamp = tCurrentInputFrameTimestamp;
+                                            }
 
-                                                // prepare frame number for next loop
-                                                tCurrentOutputFrameNumber += 1;
+                                            tCurrentOutputFrameNumber = CalculateOutputFrameNumber(tCurrentOutputFrameTimestamp) - (double)tAudioFifoBufferedSamples / MEDIA_SOURCE_SAMPLES_PER_BUFFER /* frame shift */;
+                                            //TODO: LOG(LOG_WARN, "%s: %.2f => %.2f", GetMediaTypeStr().c_str(), (float)tCurrentInputFrameTimestamp, (float)tCurrentOutputFrameNumber);
 
-                                                #ifdef MSMEM_DEBUG_DECODER_STATE
-                                                    LOG(LOG_VERBOSE, "Successful audio buffer loop");
-                                                #endif
-                                            }else
+                                            // save PTS value to deliver it later to the frame grabbing thread
+                                            #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
+                                                LOG(LOG_VERBOSE, "Setting current frame nr. to %.2lf, packet PTS: %.2f", tCurrentOutputFrameNumber, (float)tCurrentInputFrameTimestamp);
+                                            #endif
+
+                                            // the amount of bytes we want to have in an output frame
+                                            int tDesiredOutputSize = MEDIA_SOURCE_SAMPLES_PER_BUFFER * tOutputAudioBytesPerSample * mOutputAudioChannels;
+
+                                            int tLoops = 0;
+                                            while (av_fifo_size(mResampleFifo[0]) >= MEDIA_SOURCE_SAMPLES_PER_BUFFER * tOutputAudioBytesPerSample * mOutputAudioChannels)
                                             {
-                                                LOG(LOG_ERROR, "Cannot write a %s chunk of %d bytes to the FIFO with %d bytes slots", GetMediaTypeStr().c_str(),  tCurrentChunkSize, mDecoderFifo->GetEntrySize());
+                                                tLoops++;
+                                                // ############################
+                                                // ### READ FRAME FROM FIFO
+                                                // ############################
+                                                #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
+                                                    LOG(LOG_VERBOSE, "Loop %d-Reading %d bytes from %d bytes of fifo, current frame nr.: %.2lf", tLoops, tDesiredOutputSize, av_fifo_size(mResampleFifo[0]), tCurrentOutputFrameNumber);
+                                                #endif
+                                                // read sample data from the fifo buffer
+                                                HM_av_fifo_generic_read(mResampleFifo[0], (void*)tChunkBuffer, tDesiredOutputSize);
+                                                tCurrentChunkSize = tDesiredOutputSize;
+
+                                                // ############################
+                                                // ### WRITE FRAME TO OUTPUT FIFO
+                                                // ############################
+                                                // add new chunk to FIFO
+                                                if (tCurrentChunkSize <= mDecoderFifo->GetEntrySize())
+                                                {
+                                                    #ifdef MSMEM_DEBUG_AUDIO_FRAME_RECEIVER
+                                                        LOG(LOG_VERBOSE, "Writing %d %s bytes at %p to output FIFO with frame nr. %.2lf, remaining audio data: %d bytes", tCurrentChunkSize, GetMediaTypeStr().c_str(), tChunkBuffer, tCurrentOutputFrameNumber, av_fifo_size(mResampleFifo[0]));
+                                                    #endif
+                                                    WriteOutputChunk((char*)tChunkBuffer, tCurrentChunkSize, (int64_t)rint(tCurrentOutputFrameNumber));
+
+                                                    // prepare frame number for next loop
+                                                    tCurrentOutputFrameNumber += 1;
+
+                                                    #ifdef MSMEM_DEBUG_DECODER_STATE
+                                                        LOG(LOG_VERBOSE, "Successful audio buffer loop");
+                                                    #endif
+                                                }else
+                                                {
+                                                    LOG(LOG_ERROR, "Cannot write a %s chunk of %d bytes to the FIFO with %d bytes slots", GetMediaTypeStr().c_str(),  tCurrentChunkSize, mDecoderFifo->GetEntrySize());
+                                                }
                                             }
                                         }
+                                    }else
+                                    {// audio frame was buffered by ffmpeg
+                                        LOG(LOG_VERBOSE, "Audio frame was buffered");
+                                        if (tPacket->data != NULL)
+                                            mDecoderOutputFrameDelay++;
                                     }
                                 }else
-                                {// audio frame was buffered by ffmpeg
-                                    LOG(LOG_VERBOSE, "Audio frame was buffered");
-                                    if (tPacket->data != NULL)
-                                        mDecoderOutputFrameDelay++;
+                                {// tDecoderResult < 0
+                                    LOG(LOG_WARN, "Couldn't decode audio samples %.2f because \"%s\"(%d)", (float)tCurrentInputFrameTimestamp, strerror(AVUNERROR(tDecoderResult)), AVUNERROR(tDecoderResult));
+                                }
+
+                                // continue with the next audio frame of the packet
+                                if ((tDecoderResult <= 0) || (tDecoderResult >= tPacket->size))
+                                    break;
+                                tPacket->data += tDecoderResult;
+                                tPacket->size -= tDecoderResult;
+                                if ((tFrameFinished != 0) && (mCodecContext->frame_size > 0))
+                                {// the PTS is given in audio frames
+                                    int64_t tFrameDuration = tAudioFrame->nb_samples / mCodecContext->frame_size;
+                                    if (tPacket->pts != (int64_t)AV_NOPTS_VALUE)
+                                        tPacket->pts += tFrameDuration;
+                                    if (tPacket->dts != (int64_t)AV_NOPTS_VALUE)
+                                        tPacket->dts += tFrameDuration;
+                                    tCurrentInputFrameTimestamp += tFrameDuration;
                                 }
-                            }else
-                            {// tDecoderResult < 0
-                                LOG(LOG_WARN, "Couldn't decode audio samples %.2f because \"%s\"(%d)", (float)tCurrentInputFrameTimestamp, strerror(AVUNERROR(tDecoderResult)), AVUNERROR(tDecoderResult));
                             }
+                            tPacket->data = tPacketData;
+                            tPacket->size = tPacketSize;
                         }
                         break;
                     default:
@@ -2600,6 +2764,79 @@ void MediaSourceMem::UpdateBufferTime()
     mDecoderFrameBufferTime = tBufferSize / GetOutputFrameRate();
 }
 
+bool MediaSourceMem::UsesAdaptivePreBuffering()
+{
+    // files are pre-buffered locally, only memory/network sources suffer from a fixed start-up delay
+    return ((GetSourceType() != SOURCE_FILE) && (mDecoderFramePreBufferTime > 0));
+}
+
+void MediaSourceMem::ResetAdaptivePreBuffering()
+{
+    mAdaptivePreBufferTime = MEDIA_SOURCE_MEM_FAST_START_PRE_BUFFER_TIME;
+    mAdaptivePreBufferUnderruns = 0;
+    mAdaptivePreBufferCatchUp = false;
+    mDecoderSkipNonReferenceFrames = false;
+    mTimeGrabbingStarted = Time::GetTimeStamp();
+    mTimeToFirstFrame = -1;
+}
+
+void MediaSourceMem::GrowAdaptivePreBuffering(float pLateness)
+{
+    float tOldPreBufferTime = GetFrameBufferActivePreBufferingTime();
+
+    mAdaptivePreBufferUnderruns++;
+
+    if (tOldPreBufferTime >= mDecoderFramePreBufferTime)
+    {// maximum reached
+        #ifdef MSMEM_DEBUG_PRE_BUFFERING
+            LOG(LOG_VERBOSE, "%s %s source detected underrun %d, pre-buffer time is already at its maximum of %.0f ms", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), mAdaptivePreBufferUnderruns, mDecoderFramePreBufferTime * 1000);
+        #endif
+        return;
+    }
+
+    // grow at least by one step, but enough to cover the lateness of the current frame
+    mAdaptivePreBufferTime = tOldPreBufferTime + ((pLateness > MEDIA_SOURCE_MEM_PRE_BUFFER_GROWTH_STEP) ? pLateness : MEDIA_SOURCE_MEM_PRE_BUFFER_GROWTH_STEP);
+    if (mAdaptivePreBufferTime > mDecoderFramePreBufferTime)
+        mAdaptivePreBufferTime = mDecoderFramePreBufferTime;
+
+    LOG(LOG_WARN, "%s %s source detected underrun %d (frame %.0f ms late), increasing pre-buffer time from %.0f ms to %.0f ms", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), mAdaptivePreBufferUnderruns, pLateness * 1000, tOldPreBufferTime * 1000, mAdaptivePreBufferTime * 1000);
+
+    // the next frame has to wait for the enlarged pre-buffer
+    mDecoderRecalibrateRTGrabbingAfterSeeking = true;
+}
+
+void MediaSourceMem::CatchUpRTGrabbing()
+{
+    float tExcessTime = mDecoderFrameBufferTime - GetFrameBufferActivePreBufferingTime();
+
+    if (tExcessTime > MEDIA_SOURCE_MEM_CATCH_UP_THRESHOLD)
+    {
+        if (!mAdaptivePreBufferCatchUp)
+        {
+            LOG(LOG_VERBOSE, "%s %s source buffers %.0f ms more than needed, catching up", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), tExcessTime * 1000);
+            mAdaptivePreBufferCatchUp = true;
+        }
+
+        // play slightly faster: present each frame a bit earlier than its nominal play-out time
+        mSourceStartTimeForRTGrabbing -= MEDIA_SOURCE_MEM_CATCH_UP_SPEED_UP * AV_TIME_BASE / GetOutputFrameRate();
+    }else
+    {
+        if (mAdaptivePreBufferCatchUp)
+        {
+            LOG(LOG_VERBOSE, "%s %s source has caught up, buffered: %.0f ms", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), mDecoderFrameBufferTime * 1000);
+            mAdaptivePreBufferCatchUp = false;
+        }
+    }
+
+    // far too deep buffer: additionally let the video decoder skip non-reference frames
+    bool tSkipNonReferenceFrames = ((mMediaType == MEDIA_VIDEO) && (tExcessTime > MEDIA_SOURCE_MEM_CATCH_UP_SKIP_THRESHOLD));
+    #ifdef MSMEM_DEBUG_CATCH_UP
+        if (tSkipNonReferenceFrames != mDecoderSkipNonReferenceFrames)
+            LOG(LOG_VERBOSE, "%s skipping of non-reference video frames, buffered: %.0f ms", tSkipNonReferenceFrames ? "Starting" : "Stopping", mDecoderFrameBufferTime * 1000);
+    #endif
+    mDecoderSkipNonReferenceFrames = tSkipNonReferenceFrames;
+}
+
 void MediaSourceMem::CalibrateRTGrabbing()
 {
     // adopt the stored pts value which represent the start of the media presentation in real-time useconds
@@ -2613,7 +2850,7 @@ void MediaSourceMem::CalibrateRTGrabbing()
         LOG(LOG_ERROR, "Found invalid relative PTS value of: %.2lf for frame index: %.2f", tRelativeTime, tRelativeFrameIndex);
         tRelativeTime = 0;
     }
-    mSourceStartTimeForRTGrabbing = av_gettime() - tRelativeTime  + mSourceTimeShiftForRTGrabbing + mDecoderFramePreBufferTime * AV_TIME_BASE;
+    mSourceStartTimeForRTGrabbing = av_gettime() - tRelativeTime  + mSourceTimeShiftForRTGrabbing + GetFrameBufferActivePreBufferingTime() * AV_TIME_BASE;
     #ifdef MSMEM_DEBUG_CALIBRATION
         LOG(LOG_WARN, "Calibrating %s RT playback: new PTS start: %.2f, rel. frame index: %.2f, rel. time: %.2f ms", GetMediaTypeStr().c_str(), mSourceStartTimeForRTGrabbing, tRelativeFrameIndex, (float)(tRelativeTime / 1000));
     #endif
@@ -2677,6 +2914,10 @@ bool MediaSourceMem::WaitForRTGrabbing()
     // calculate the PTS offset between the RTCP PTS reference and the last grabbed frame
     int64_t tDesiredPlayOutTime = 1000 * ((int64_t)tCurrentPtsFromGrabber); // in us
 
+    // catch up after bursts
+    if (UsesAdaptivePreBuffering())
+        CatchUpRTGrabbing();
+
     // calculate the current (normalized) play-out time of the current A/V stream
     int64_t tCurrentPlayOutTime = av_gettime() - (int64_t)mSourceStartTimeForRTGrabbing; // in us
 
@@ -2707,6 +2948,16 @@ bool MediaSourceMem::WaitForRTGrabbing()
     // calculate the time offset between the desired and current play-out time, which can be used for a wait cycle (Thread::Suspend)
     int64_t tResultingTimeOffset = tDesiredPlayOutTime - tCurrentPlayOutTime; // in us
 
+    // schedule the presentation against the master clock of the A/V synchronization
+    mSynchronizerMutex.lock();
+    if (mSynchronizer != NULL)
+    {
+        int64_t tPresentationShift = mSynchronizer->SchedulePresentation(GetSynchronizationTimestamp(), tResultingTimeOffset);
+        mSourceStartTimeForRTGrabbing += tPresentationShift;
+        tResultingTimeOffset += tPresentationShift;
+    }
+    mSynchronizerMutex.unlock();
+
     #ifdef MSMEM_DEBUG_WAITING_TIMING
         LOG(LOG_VERBOSE, "%s-current relative frame index: %f, relative time: %"PRIu64" ms (Fps: %3.2f), stream start time: %f us, time difference: %lld us", GetMediaTypeStr().c_str(), tNormalizedFrameIndexFromGrabber, tCurrentPtsFromGrabber, GetInputFrameRate(), (float)mInputStartPts, tResultingTimeOffset);
         LOG(LOG_WARN, "%s-%s-sleeping for %"PRId64" ms (%"PRId64" - %"PRId64") for frame %.2lf, RT ref. time: %.2lf", GetMediaTypeStr().c_str(), GetSourceTypeStr().c_str(), tResultingTimeOffset / 1000, tDesiredPlayOutTime, tCurrentPlayOutTime, mCurrentOutputFrameIndex, mSourceStartTimeForRTGrabbing);
@@ -2729,6 +2980,10 @@ bool MediaSourceMem::WaitForRTGrabbing()
     {// waiting time invalid, frame is too late
         float tDelay = (float)tResultingTimeOffset / (-1000);
 
+        // underrun: the frame wasn't available at its play-out time, the pre-buffer is too small for the current jitter
+        if ((UsesAdaptivePreBuffering()) && (tDelay > MEDIA_SOURCE_MEM_UNDERRUN_TOLERANCE * 1000))
+            GrowAdaptivePreBuffering(tDelay / 1000);
+
         if (mRtpActivated)
         {
             if (tDelay > MEDIA_SOURCE_MEM_DEFAULT_E2E_DELAY_JITER * 1000)
@@ -2775,7 +3030,7 @@ int64_t MediaSourceMem::GetSynchronizationTimestamp()
 {
     int64_t tResult = 0;
 
-    if ((mDecoderFifo != NULL) && (mDecoderFifo->GetUsage()) && (mCurrentOutputFrameIndex > 0))
+    if ((mDecoderFifo != NULL) && (!mDecoderRecalibrateRTGrabbingAfterSeeking) && (mCurrentOutputFrameIndex > 0))
     {// we have some first passed A/V frames, the decoder does not need to re-calibrate the RT grabber
         /******************************************
          * The following lines do the following:
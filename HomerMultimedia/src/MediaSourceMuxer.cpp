@@ -29,14 +29,19 @@
 #include <MediaSinkNet.h>
 #include <MediaSourceFile.h>
 #include <VideoScaler.h>
+#include <MediaMemoryBudget.h>
+#include <MediaDeviceRegistry.h>
+#include <MediaEncoderCalibration.h>
 #include <ProcessStatisticService.h>
 #include <HBSocket.h>
 #include <HBSystem.h>
+#include <HBCondition.h>
 #include <RTP.h>
 #include <Logger.h>
 
 #include <string>
 #include <stdint.h>
+#include <math.h>
 
 using namespace std;
 using namespace Homer::Monitor;
@@ -66,6 +71,135 @@ namespace Homer { namespace Multimedia {
 //HEVC default settings
 #define HEVC_DEFAULT_PRESET             "faster"
 
+//VP9 default settings (libvpx real-time mode)
+#define VP9_DEFAULT_DEADLINE            "realtime"
+#define VP9_DEFAULT_CPU_USED            "8"
+
+//AV1 default settings (libaom real-time mode, SVT-AV1 and rav1e speed presets)
+#define AV1_DEFAULT_AOM_USAGE           "realtime"
+#define AV1_DEFAULT_AOM_CPU_USED        "8"
+#define AV1_DEFAULT_SVT_PRESET          "10"
+#define AV1_DEFAULT_RAV1E_SPEED         "10"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Creates the encoders for live reconfigurations, neither the capture thread
+ * nor the encoder thread have to wait until a new encoder is opened.
+ */
+class VideoEncoderPreparer:
+    public Thread
+{
+public:
+    VideoEncoderPreparer(MediaSourceMuxer *pMediaSourceMuxer);
+
+    virtual ~VideoEncoderPreparer();
+
+    void StartPreparer();
+    void StopPreparer();
+
+    bool Prepare(); // a running preparation is repeated with the latest settings
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    MediaSourceMuxer    *mMediaSourceMuxer;
+    Mutex               mPreparerMutex;
+    Condition           mPreparerCondition;
+    bool                mPreparerNeeded;
+    bool                mPreparationRequested;
+};
+
+VideoEncoderPreparer::VideoEncoderPreparer(MediaSourceMuxer *pMediaSourceMuxer)
+{
+    mMediaSourceMuxer = pMediaSourceMuxer;
+    mPreparerNeeded = false;
+    mPreparationRequested = false;
+}
+
+VideoEncoderPreparer::~VideoEncoderPreparer()
+{
+}
+
+void VideoEncoderPreparer::StartPreparer()
+{
+    if (IsRunning())
+        return;
+
+    LOG(LOG_VERBOSE, "Starting %s encoder preparer", mMediaSourceMuxer->GetMediaTypeStr().c_str());
+
+    mPreparerNeeded = true;
+    mPreparationRequested = false;
+
+    StartThread();
+
+    // wait until thread is running
+    while (!IsRunning())
+        Suspend(5 * 1000);
+}
+
+void VideoEncoderPreparer::StopPreparer()
+{
+    int tSignalingRound = 0;
+
+    mPreparerMutex.lock();
+    mPreparerNeeded = false;
+    mPreparationRequested = false;
+    mPreparerMutex.unlock();
+
+    // wait for termination of preparer thread, a running preparation is finished before
+    while(IsRunning())
+    {
+        if(tSignalingRound > 0)
+            LOG(LOG_WARN, "Signaling attempt %d to stop %s encoder preparer", tSignalingRound, mMediaSourceMuxer->GetMediaTypeStr().c_str());
+        tSignalingRound++;
+
+        mPreparerCondition.Signal();
+
+        Suspend(25 * 1000);
+    }
+}
+
+bool VideoEncoderPreparer::Prepare()
+{
+    bool tResult = false;
+
+    mPreparerMutex.lock();
+    if (mPreparerNeeded)
+    {
+        mPreparationRequested = true;
+        mPreparerCondition.Signal();
+        tResult = true;
+    }
+    mPreparerMutex.unlock();
+
+    return tResult;
+}
+
+void* VideoEncoderPreparer::Run(void* /* pArgs */)
+{
+    SVC_PROCESS_STATISTIC.AssignThreadName("Video-EncoderPreparer");
+
+    mPreparerMutex.lock();
+    while (mPreparerNeeded)
+    {
+        if (!mPreparationRequested)
+        {
+            mPreparerCondition.Wait(&mPreparerMutex);
+            continue;
+        }
+        mPreparationRequested = false;
+
+        // new requests are queued while the encoder is opened
+        mPreparerMutex.unlock();
+        mMediaSourceMuxer->PrepareVideoEncoder();
+        mPreparerMutex.lock();
+    }
+    mPreparerMutex.unlock();
+
+    return NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 MediaSourceMuxer::MediaSourceMuxer(MediaSource *pMediaSource):
@@ -76,6 +210,10 @@ MediaSourceMuxer::MediaSourceMuxer(MediaSource *pMediaSource):
     SetOutgoingStream();
     mStreamCodecId = AV_CODEC_ID_NONE;
     mStreamMaxPacketSize = 500;
+    mStreamPathMaxPacketSize = 0;
+    mStreamPathMaxPacketSizeLastCheck = 0;
+    mAudioLowOverheadPacketization = false;
+    mAudioPacketizationModeLastCheck = 0;
     mStreamQuality = 20;
     mStreamBitRate = -1;
     mStreamMaxFps = 0;
@@ -93,8 +231,30 @@ MediaSourceMuxer::MediaSourceMuxer(MediaSource *pMediaSource):
     mStreamActivated = true;
     mRelayingSkipAudioSilence = false;
     mRelayingSkipAudioSilenceSkippedChunks = 0;
+    mRelayingSkipIdleFrames = false;
+    mRelayingSkipIdleFramesKeepAliveFps = MEDIA_SOURCE_MUX_IDLE_FRAMES_KEEP_ALIVE_FPS;
+    mRelayingSkipIdleFramesSkippedFrames = 0;
+    ResetIdleFrameDetection();
+    mRateControlRealtime = false;
+    mRateControlVbvBufferTime = MEDIA_SOURCE_MUX_DEFAULT_VBV_BUFFER_TIME;
+    mRateControlIntraRefresh = true;
+    ResetEncodedFrameStatistic();
     mEncoderThreadNeeded = true;
     mEncoderFifo = NULL;
+    mVideoEncoderPreparer = new VideoEncoderPreparer(this);
+    mVideoEncoderSwitchPending = false;
+    mVideoEncoderResetNeeded = false;
+    mVideoEncoderInputChangePending = false;
+    mVideoEncoderKeyFrameNeeded = false;
+    mVideoEncoderSwitchTime = 0;
+    mVideoEncoderSwitchGap = 0;
+    mLastOutputPacketTime = 0;
+    mPendingVideoEncoder.FormatContext = NULL;
+    mPendingVideoEncoder.MediaStream = NULL;
+    mPendingVideoEncoder.CodecContext = NULL;
+    mNextVideoEncoder.FormatContext = NULL;
+    mNextVideoEncoder.MediaStream = NULL;
+    mNextVideoEncoder.CodecContext = NULL;
 }
 
 MediaSourceMuxer::~MediaSourceMuxer()
@@ -107,6 +267,8 @@ MediaSourceMuxer::~MediaSourceMuxer()
     LOG(LOG_VERBOSE, "..stopping %s encoder", GetMediaTypeStr().c_str());
     StopEncoder();
 
+    delete mVideoEncoderPreparer;
+
     LOG(LOG_VERBOSE, "..freeing stream packet buffer");
     av_free(mStreamPacketBuffer);
     LOG(LOG_VERBOSE, "Destroyed");
@@ -122,8 +284,20 @@ int MediaSourceMuxer::FfmpegWriteOneOutputPacket(AVFormatContext *pFormatContext
     if (!tMuxer->mEncoderThreadNeeded)
         return 0;
 
+    // measure the gap in the outgoing stream which was caused by a live reconfiguration
+    int64_t tTime = Time::GetTimeStamp();
+    if (tMuxer->mVideoEncoderSwitchTime != 0)
+    {
+        tMuxer->mVideoEncoderSwitchGap = tTime - tMuxer->mVideoEncoderSwitchTime;
+        tMuxer->mVideoEncoderSwitchTime = 0;
+        LOGEX(MediaSourceMuxer, LOG_INFO, "First %s packet of the new encoder after a gap of %"PRId64" us", tMuxer->GetMediaTypeStr().c_str(), tMuxer->mVideoEncoderSwitchGap);
+    }
+    tMuxer->mLastOutputPacketTime = tTime;
+
     // log statistics
     tMuxer->AnnouncePacket(pAVPacket->size);
+    if (tMuxer->mMediaType == MEDIA_VIDEO)
+        tMuxer->AccountEncodedFrame(pAVPacket->size);
 
     //####################################################################
     // distribute frame among the registered media sinks
@@ -134,9 +308,9 @@ int MediaSourceMuxer::FfmpegWriteOneOutputPacket(AVFormatContext *pFormatContext
         {
             LOGEX(MediaSourceMuxer, LOG_WARN, "Encoded %s data of %d bytes is too big for network streaming", tMuxer->GetMediaTypeStr().c_str(), pAVPacket->size);
         }
-        if (pAVPacket->size > tMuxer->mStreamMaxPacketSize)
+        if (pAVPacket->size > tMuxer->GetStreamMaxPacketSize())
         {
-            LOGEX(MediaSourceMuxer, LOG_WARN, "Ffmpeg %s packet of %d bytes is bigger than maximum payload size of %d bytes, RTP packetizer will fragment to solve this", tMuxer->GetMediaTypeStr().c_str(), pAVPacket->size, tMuxer->mStreamMaxPacketSize);
+            LOGEX(MediaSourceMuxer, LOG_WARN, "Ffmpeg %s packet of %d bytes is bigger than maximum payload size of %d bytes, RTP packetizer will fragment to solve this", tMuxer->GetMediaTypeStr().c_str(), pAVPacket->size, tMuxer->GetStreamMaxPacketSize());
         }
     #endif
 
@@ -267,6 +441,10 @@ bool MediaSourceMuxer::SetOutputStreamPreferences(std::string pStreamCodec, int
         }
     }
 
+    // only the rate control settings of a running encoder can be changed without creating a new encoder
+    bool tOnlyRateChanged = (mStreamCodecId == tStreamCodecId) && (mStreamMaxFps == pMaxFps) && (mStreamMaxPacketSize == pMaxPacketSize) &&
+                            (mCurrentStreamingResX == pResX) && (mCurrentStreamingResY == pResY) && ((mStreamQuality == pMediaStreamQuality) || (mRateControlRealtime));
+
     if ((mStreamCodecId != tStreamCodecId) ||
            (mStreamMaxFps != pMaxFps) ||
         (mStreamQuality != pMediaStreamQuality) ||
@@ -310,9 +488,18 @@ bool MediaSourceMuxer::SetOutputStreamPreferences(std::string pStreamCodec, int
 
         if ((pDoReset) && (mMediaSourceOpened))
         {
-            LOG(LOG_VERBOSE, "Do reset now...");
+            if ((tOnlyRateChanged) && (ApplyLiveRateSettings()))
+            {
+                LOG(LOG_VERBOSE, "Applied new rate settings to the running %s encoder", GetMediaTypeStr().c_str());
+            }else if (ReconfigureVideoEncoder())
+            {
+                LOG(LOG_VERBOSE, "Prepared new %s encoder, switching on the fly..", GetMediaTypeStr().c_str());
+            }else
+            {
+                LOG(LOG_VERBOSE, "Do reset now...");
 
-            Reset();
+                Reset();
+            }
         }
     }else
         LOG(LOG_VERBOSE, "No settings were changed - ignoring");
@@ -380,8 +567,10 @@ void MediaSourceMuxer::ValidateVideoResolutionForEncoderCodec(int &pResX, int &p
                 break;
         case AV_CODEC_ID_H264:
         case AV_CODEC_ID_HEVC:
+        case AV_CODEC_ID_VP9:
+        case AV_CODEC_ID_AV1:
 
-                // for H.264/5 both width and height must be multiples of 2
+                // for H.264/5, VP9 and AV1 both width and height must be multiples of 2
                 pResX += 1;
                 pResX /= 2;
                 pResX *= 2;
@@ -401,12 +590,8 @@ void MediaSourceMuxer::ValidateVideoResolutionForEncoderCodec(int &pResX, int &p
 }
 
 
-bool MediaSourceMuxer::OpenVideoMuxer(int pResX, int pResY, float pFps)
+float MediaSourceMuxer::GetVideoMuxerFrameRate(float pFps)
 {
-    int                 tResult;
-    AVCodec             *tCodec;
-    AVDictionary        *tOptions = NULL;
-
     // use the frame rate from the base source in order to make the encoder produce the correct PTS values
     if (mMediaSource != NULL)
     {
@@ -430,6 +615,15 @@ bool MediaSourceMuxer::OpenVideoMuxer(int pResX, int pResY, float pFps)
     if (pFps < 5)
         pFps = 5;
 
+    return pFps;
+}
+
+bool MediaSourceMuxer::OpenVideoMuxer(int pResX, int pResY, float pFps)
+{
+    VideoEncoderDescriptor tEncoder;
+
+    pFps = GetVideoMuxerFrameRate(pFps);
+
     mMediaType = MEDIA_VIDEO;
 
     if (mStreamBitRate == -1)
@@ -461,11 +655,64 @@ bool MediaSourceMuxer::OpenVideoMuxer(int pResX, int pResY, float pFps)
         }
     #endif
 
+    // #########################################
+    // create output format
+    // #########################################
+    LOG(LOG_VERBOSE, "..creating new output format");
+    memset((void*)&mMuxerOutFormat, 0, sizeof(AVOutputFormat));
+    mMuxerOutFormat.name = "MediaSourceMuxer";
+    mMuxerOutFormat.long_name = "raw MediaSourceMuxer";
+    mMuxerOutFormat.mime_type = "";
+    mMuxerOutFormat.extensions = "";
+    mMuxerOutFormat.audio_codec = AV_CODEC_ID_NONE;
+    mMuxerOutFormat.video_codec = mStreamCodecId;
+    mMuxerOutFormat.priv_data_size = sizeof(void*);
+    mMuxerOutFormat.write_header = FfmpegForceOneOutputStream;
+    mMuxerOutFormat.write_packet = FfmpegWriteOneOutputPacket;
+    mMuxerOutFormat.flags = AVFMT_NOTIMESTAMPS;
+
+    if (!CreateVideoEncoder(tEncoder, mStreamCodecId, pFps))
+        return false;
+
+    mFormatContext = tEncoder.FormatContext;
+    mMediaStreamIndex = 0;
+    mMediaStream = tEncoder.MediaStream;
+    mCodecContext = tEncoder.CodecContext;
+    mCurrentStreamingResX = tEncoder.ResX;
+    mCurrentStreamingResY = tEncoder.ResY;
+
+    // init transcoder FIFO based for RGB32 pictures
+    StartEncoder();
+
+    //######################################################
+    //### give some verbose output
+    //######################################################
+    mStreamMaxFps_LastFrame_Timestamp = Time::GetTimeStamp();
+    MarkOpenGrabDeviceSuccessful();
+    LOG(LOG_INFO, "    ..max packet size: %d bytes (path limit: %d bytes)", mStreamMaxPacketSize, mStreamPathMaxPacketSize);
+    LOG(LOG_INFO, "  stream...");
+    LOG(LOG_INFO, "    ..AV stream context at: %p", mMediaStream);
+    LOG(LOG_INFO, "    ..AV stream codec is: %s(%d)", mMediaStream->codec->codec->name, mMediaStream->codec->codec_id);
+    LOG(LOG_INFO, "    ..AV stream codec context at: 0x%p", mMediaStream->codec);
+    LOG(LOG_INFO, "    ..AV stream codec codec context at: 0x%p", mMediaStream->codec->codec);
+
+    return true;
+}
+
+bool MediaSourceMuxer::CreateVideoEncoder(VideoEncoderDescriptor &pEncoder, enum AVCodecID pCodecId, float pFps)
+{
+    int                 tResult;
+    AVCodec             *tCodec;
+    AVDictionary        *tOptions = NULL;
+    AVFormatContext     *tFormatContext;
+    AVStream            *tMediaStream;
+    AVCodecContext      *tCodecContext;
+
     // #########################################
     // find the encoder for the video stream
     // #########################################
     LOG(LOG_VERBOSE, "..finding video encoder");
-    if ((tCodec = avcodec_find_encoder(mStreamCodecId)) == NULL)
+    if ((tCodec = avcodec_find_encoder(pCodecId)) == NULL)
     {
         LOG(LOG_ERROR, "Couldn't find a fitting video codec");
 
@@ -476,125 +723,136 @@ bool MediaSourceMuxer::OpenVideoMuxer(int pResX, int pResY, float pFps)
     // create new format context
     // #########################################
     LOG(LOG_VERBOSE, "..creating new format context");
-    mFormatContext = AV_NEW_FORMAT_CONTEXT();
+    tFormatContext = AV_NEW_FORMAT_CONTEXT();
     // verbose timestamp debugging
     if (LOGGER.GetLogLevel() == LOG_WORLD)
     {
         LOG(LOG_WARN, "Enabling ffmpeg timestamp debugging");
-        mFormatContext->debug = FF_FDEBUG_TS;
+        tFormatContext->debug = FF_FDEBUG_TS;
     }
-
-    // #########################################
-    // create output format
-    // #########################################
-    LOG(LOG_VERBOSE, "..creating new output format");
-    memset((void*)&mMuxerOutFormat, 0, sizeof(AVOutputFormat));
-    mMuxerOutFormat.name = "MediaSourceMuxer";
-    mMuxerOutFormat.long_name = "raw MediaSourceMuxer";
-    mMuxerOutFormat.mime_type = "";
-    mMuxerOutFormat.extensions = "";
-    mMuxerOutFormat.audio_codec = AV_CODEC_ID_NONE;
-    mMuxerOutFormat.video_codec = mStreamCodecId;
-    mMuxerOutFormat.priv_data_size = sizeof(void*);
-    mMuxerOutFormat.write_header = FfmpegForceOneOutputStream;
-    mMuxerOutFormat.write_packet = FfmpegWriteOneOutputPacket;
-    mMuxerOutFormat.flags = AVFMT_NOTIMESTAMPS;
-    mFormatContext->oformat = &mMuxerOutFormat;
+    tFormatContext->oformat = &mMuxerOutFormat;
 
     // #########################################
     // create new output stream
     // #########################################
     LOG(LOG_VERBOSE, "..creating new output stream");
-    mMediaStreamIndex = 0;
-    mMediaStream = HM_avformat_new_stream(mFormatContext, tCodec);
+    tMediaStream = HM_avformat_new_stream(tFormatContext, tCodec);
 
     // #########################################
     // create new output codec context
     // #########################################
     LOG(LOG_VERBOSE, "..creating new output codec context");
-    mCodecContext = mMediaStream->codec;
-    mCodecContext->codec_id = mStreamCodecId;
-    mCodecContext->codec_type = AVMEDIA_TYPE_VIDEO;
+    tCodecContext = tMediaStream->codec;
+    tCodecContext->codec_id = pCodecId;
+    tCodecContext->codec_type = AVMEDIA_TYPE_VIDEO;
     // set defaults and update them later with explicit values
-    if ((tResult = avcodec_get_context_defaults3(mCodecContext, tCodec)) < 0)
+    if ((tResult = avcodec_get_context_defaults3(tCodecContext, tCodec)) < 0)
     {
         LOG(LOG_ERROR, "Could not set defaults for codec context because \"%s\".", strerror(AVUNERROR(tResult)));
 
         // free codec and stream 0
-        av_freep(&mMediaStream->codec);
-        av_freep(&mMediaStream);
+        av_freep(&tMediaStream->codec);
+        av_freep(&tMediaStream);
 
         // Close the format context
-        av_free(mFormatContext);
+        av_free(tFormatContext);
 
         return false;
     }
-    mCodecContext->bit_rate = mStreamBitRate;
+    tCodecContext->bit_rate = mStreamBitRate;
     if (((mRequestedStreamingResX == -1) || (mRequestedStreamingResY == -1)) && (mMediaSource != NULL))
     {
-        mMediaSource->GetVideoSourceResolution(mCurrentStreamingResX, mCurrentStreamingResY);
+        mMediaSource->GetVideoSourceResolution(pEncoder.ResX, pEncoder.ResY);
     }else{
-        mCurrentStreamingResX = mRequestedStreamingResX;
-        mCurrentStreamingResY = mRequestedStreamingResY;
+        pEncoder.ResX = mRequestedStreamingResX;
+        pEncoder.ResY = mRequestedStreamingResY;
     }
-    ValidateVideoResolutionForEncoderCodec(mCurrentStreamingResX, mCurrentStreamingResY, mStreamCodecId);
-    mCodecContext->width = mCurrentStreamingResX;
-    mCodecContext->height = mCurrentStreamingResY;
-    LOG(LOG_VERBOSE, "Using in %s muxer a resolution %d * %d (requested: %d * %d) and %3.2f fps", GetMediaTypeStr().c_str(), mCurrentStreamingResX, mCurrentStreamingResY, mRequestedStreamingResX, mRequestedStreamingResY, pFps);
+    ValidateVideoResolutionForEncoderCodec(pEncoder.ResX, pEncoder.ResY, pCodecId);
+    tCodecContext->width = pEncoder.ResX;
+    tCodecContext->height = pEncoder.ResY;
+    LOG(LOG_VERBOSE, "Using in %s muxer a resolution %d * %d (requested: %d * %d) and %3.2f fps", GetMediaTypeStr().c_str(), pEncoder.ResX, pEncoder.ResY, mRequestedStreamingResX, mRequestedStreamingResY, pFps);
 
     // mpeg1/2 codecs support only non-rational frame rates
-    if (((mStreamCodecId == AV_CODEC_ID_MPEG1VIDEO) || (mStreamCodecId == AV_CODEC_ID_MPEG2VIDEO)) && (mInputFrameRate == 29.97))
+    if (((pCodecId == AV_CODEC_ID_MPEG1VIDEO) || (pCodecId == AV_CODEC_ID_MPEG2VIDEO)) && (pFps == 29.97))
     {
         //HACK: pretend a frame rate of 30 fps, the actual frame rate corresponds to the frame rate from the base media source
-        mCodecContext->time_base = (AVRational){100, (int)(30 * 100)};
-        mMediaStream->time_base = (AVRational){100, (int)(30 * 100)};
+        tCodecContext->time_base = (AVRational){100, (int)(30 * 100)};
+        tMediaStream->time_base = (AVRational){100, (int)(30 * 100)};
     }else
     {
-        mCodecContext->time_base = (AVRational){100, (int)(mInputFrameRate * 100)};
-        mMediaStream->time_base = (AVRational){100, (int)(mInputFrameRate * 100)};
+        tCodecContext->time_base = (AVRational){100, (int)(pFps * 100)};
+        tMediaStream->time_base = (AVRational){100, (int)(pFps * 100)};
     }
     // set i frame distance: GOP = group of pictures
-    if (mStreamCodecId != AV_CODEC_ID_THEORA)
-        mCodecContext->gop_size = (100 - mStreamQuality) / 5; // default is 12
+    if (pCodecId != AV_CODEC_ID_THEORA)
+        tCodecContext->gop_size = (100 - mStreamQuality) / 5; // default is 12
     else
-        mCodecContext->gop_size = 0; // force GOP size of 0 for THEORA
+        tCodecContext->gop_size = 0; // force GOP size of 0 for THEORA
 
-    mCodecContext->qmin = 1; // default is 2
-    mCodecContext->qmax = 2 +(100 - mStreamQuality) / 4; // default is 31
+    tCodecContext->qmin = 1; // default is 2
+    tCodecContext->qmax = 2 +(100 - mStreamQuality) / 4; // default is 31
 
     // set max. packet size for RTP based packets
-    mCodecContext->rtp_payload_size = mStreamMaxPacketSize;
+    tCodecContext->rtp_payload_size = GetStreamMaxPacketSize();
 
     // set pixel format
-    if (mStreamCodecId == AV_CODEC_ID_MJPEG)
-        mCodecContext->pix_fmt = PIX_FMT_YUVJ420P;
+    if (pCodecId == AV_CODEC_ID_MJPEG)
+        tCodecContext->pix_fmt = PIX_FMT_YUVJ420P;
     else
-        mCodecContext->pix_fmt = PIX_FMT_YUV420P;
+        tCodecContext->pix_fmt = PIX_FMT_YUV420P;
 
     // activate ffmpeg internal fps emulation
-    //mCodecContext->rate_emu = 1;
+    //tCodecContext->rate_emu = 1;
 
     // some formats want stream headers to be separate, but this produces some very small packets!
-    if(mFormatContext->oformat->flags & AVFMT_GLOBALHEADER)
-        mCodecContext->flags |= CODEC_FLAG_GLOBAL_HEADER;
+    if(tFormatContext->oformat->flags & AVFMT_GLOBALHEADER)
+        tCodecContext->flags |= CODEC_FLAG_GLOBAL_HEADER;
 
     // allow ffmpeg its speedup tricks
-    mCodecContext->flags2 |= CODEC_FLAG2_FAST;
+    tCodecContext->flags2 |= CODEC_FLAG2_FAST;
 
 
     // Dump information about device file
-    av_dump_format(mFormatContext, mMediaStreamIndex, "MediaSourceMuxer (video)", true);
+    av_dump_format(tFormatContext, 0, "MediaSourceMuxer (video)", true);
+
+    // speed setting and thread count from the encoder calibration of this host
+    EncoderSetting tCalibratedSetting;
+    bool tCalibratedRealtime = false;
+    bool tCalibrated = SVC_MEDIA_ENCODER_CALIBRATION.GetSetting(tCodec->name, pEncoder.ResX, pEncoder.ResY, pFps, tCalibratedSetting, tCalibratedRealtime);
+    if (tCalibrated)
+    {
+        LOG(LOG_INFO, "Using calibrated setting %s=%s with %d threads for encoder %s (%.1f ms per frame)", tCalibratedSetting.Option.c_str(), tCalibratedSetting.Value.c_str(), tCalibratedSetting.Threads, tCodec->name, tCalibratedSetting.FrameTime);
+        if (!tCalibratedRealtime)
+        {
+            int tMaxResX, tMaxResY;
+            if (SVC_MEDIA_ENCODER_CALIBRATION.GetMaxRealtimeResolution(tCodec->name, pFps, tMaxResX, tMaxResY))
+                LOG(LOG_WARN, "Encoder %s can't encode %d * %d at %3.2f fps in real-time on this host, calibrated limit: %d * %d", tCodec->name, pEncoder.ResX, pEncoder.ResY, pFps, tMaxResX, tMaxResY);
+            else
+                LOG(LOG_WARN, "Encoder %s can't encode %d * %d at %3.2f fps in real-time on this host", tCodec->name, pEncoder.ResX, pEncoder.ResY, pFps);
+        }
+    }
 
     #ifdef MEDIA_SOURCE_MUX_MULTI_THREADED_VIDEO_ENCODING
         if (tCodec->capabilities & (CODEC_CAP_FRAME_THREADS | CODEC_CAP_SLICE_THREADS))
         {// threading supported
             // active multi-threading per default for the video encoding: leave two cpus for concurrent tasks (video grabbing/decoding, audio tasks)
-            av_dict_set(&tOptions, "threads", "auto", 0);
-
-            // trigger MT usage during video encoding
-            int tThreadCount = System::GetMachineCores() - 2;
-            if (tThreadCount > 1)
-                mCodecContext->thread_count = tThreadCount;
+            // trigger MT usage during video encoding, based on the cores we may really use (affinity, cgroup quota) instead of "auto" which sees all host cores
+            int tEffectiveCores = System::GetEffectiveCores();
+            int tThreadCount = tEffectiveCores - 2;
+            if (tCalibrated)
+            {
+                // the calibration might have run with more cores (e.g., before the affinity or the cgroup quota was reduced)
+                tThreadCount = tCalibratedSetting.Threads;
+                if (tThreadCount > tEffectiveCores)
+                {
+                    LOG(LOG_WARN, "Calibrated %d threads for encoder %s exceed the %d usable cores, using %d threads", tThreadCount, tCodec->name, tEffectiveCores, tEffectiveCores);
+                    tThreadCount = tEffectiveCores;
+                }
+            }
+            if (tThreadCount < 1)
+                tThreadCount = 1;
+            tCodecContext->thread_count = tThreadCount;
+            av_dict_set(&tOptions, "threads", toString(tThreadCount).c_str(), 0);
         }else
         {// threading not supported
             LOG(LOG_WARN, "Multi-threading not supported for %s codec %s", GetMediaTypeStr().c_str(), tCodec->name);
@@ -602,12 +860,12 @@ bool MediaSourceMuxer::OpenVideoMuxer(int pResX, int pResY, float pFps)
     #endif
 
     // add some extra parameters depending on the selected codec
-    switch(mStreamCodecId)
+    switch(pCodecId)
     {
         case AV_CODEC_ID_MPEG2VIDEO:
                         // force low delay
                         if (tCodec->capabilities & CODEC_CAP_DELAY)
-                            mCodecContext->flags |= CODEC_FLAG_LOW_DELAY;
+                            tCodecContext->flags |= CODEC_FLAG_LOW_DELAY;
                         break;
         case AV_CODEC_ID_H263P:
                         // old codec codext flag CODEC_FLAG_H263P_SLICE_STRUCT
@@ -618,68 +876,302 @@ bool MediaSourceMuxer::OpenVideoMuxer(int pResX, int pResY, float pFps)
                         av_dict_set(&tOptions, "aiv", "1", 0);
         case AV_CODEC_ID_H263:
                         // emit macroblock info for RFC 2190 packetization
-                        av_dict_set(&tOptions, "mb_info", toString(mStreamMaxPacketSize).c_str(), 0);
+                        av_dict_set(&tOptions, "mb_info", toString(GetStreamMaxPacketSize()).c_str(), 0);
         case AV_CODEC_ID_MPEG4:
-                        mCodecContext->flags |= CODEC_FLAG_4MV | CODEC_FLAG_AC_PRED;
+                        tCodecContext->flags |= CODEC_FLAG_4MV | CODEC_FLAG_AC_PRED;
                         break;
         case AV_CODEC_ID_H264:
-                        mCodecContext->profile = H264_DEFAULT_PROFILE;
+                        tCodecContext->profile = H264_DEFAULT_PROFILE;
                         LOG(LOG_WARN, "Setting H.264 preset to: %s", H264_DEFAULT_PRESET);
-                        if ((tResult = av_opt_set(mCodecContext->priv_data, "preset", H264_DEFAULT_PRESET, 0)) < 0)
+                        if ((tResult = av_opt_set(tCodecContext->priv_data, "preset", H264_DEFAULT_PRESET, 0)) < 0)
                             LOG(LOG_ERROR, "Failed to set A/V option \"preset\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
                         break;
         case AV_CODEC_ID_HEVC:
                         LOG(LOG_WARN, "Setting HEVC preset to: %s", HEVC_DEFAULT_PRESET);
-                        if ((tResult = av_opt_set(mCodecContext->priv_data, "preset", HEVC_DEFAULT_PRESET, 0)) < 0)
+                        if ((tResult = av_opt_set(tCodecContext->priv_data, "preset", HEVC_DEFAULT_PRESET, 0)) < 0)
                             LOG(LOG_ERROR, "Failed to set A/V option \"preset\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
                         break;
+        case AV_CODEC_ID_VP9:
+                        // no look-ahead and no alt-ref frames: each packet contains exactly one frame which is displayed immediately
+                        LOG(LOG_VERBOSE, "Setting VP9 deadline to: %s, cpu-used: %s", VP9_DEFAULT_DEADLINE, VP9_DEFAULT_CPU_USED);
+                        av_dict_set(&tOptions, "deadline", VP9_DEFAULT_DEADLINE, 0);
+                        av_dict_set(&tOptions, "cpu-used", VP9_DEFAULT_CPU_USED, 0);
+                        av_dict_set(&tOptions, "lag-in-frames", "0", 0);
+                        av_dict_set(&tOptions, "auto-alt-ref", "0", 0);
+                        av_dict_set(&tOptions, "row-mt", "1", 0);
+                        av_dict_set(&tOptions, "tile-columns", "2", 0);
+                        // the decoder may continue after packet loss
+                        av_dict_set(&tOptions, "error-resilient", "1", 0);
+                        break;
+        case AV_CODEC_ID_AV1:
+                        // the options depend on the encoder library which was found for AV1
+                        if (strcmp(tCodec->name, "libsvtav1") == 0)
+                        {
+                            LOG(LOG_VERBOSE, "Setting SVT-AV1 preset to: %s", AV1_DEFAULT_SVT_PRESET);
+                            av_dict_set(&tOptions, "preset", AV1_DEFAULT_SVT_PRESET, 0);
+                            // low-delay prediction structure without look-ahead
+                            av_dict_set(&tOptions, "svtav1-params", "pred-struct=1:lookahead=0", 0);
+                        }else if (strcmp(tCodec->name, "librav1e") == 0)
+                        {
+                            LOG(LOG_VERBOSE, "Setting rav1e speed to: %s", AV1_DEFAULT_RAV1E_SPEED);
+                            av_dict_set(&tOptions, "speed", AV1_DEFAULT_RAV1E_SPEED, 0);
+                            av_dict_set(&tOptions, "rav1e-params", "low_latency=true", 0);
+                        }else
+                        {
+                            LOG(LOG_VERBOSE, "Setting AV1 usage to: %s, cpu-used: %s", AV1_DEFAULT_AOM_USAGE, AV1_DEFAULT_AOM_CPU_USED);
+                            av_dict_set(&tOptions, "usage", AV1_DEFAULT_AOM_USAGE, 0);
+                            av_dict_set(&tOptions, "cpu-used", AV1_DEFAULT_AOM_CPU_USED, 0);
+                            av_dict_set(&tOptions, "lag-in-frames", "0", 0);
+                            av_dict_set(&tOptions, "row-mt", "1", 0);
+                        }
+                        break;
     }
 
+    // the calibrated speed setting overrides the default preset from above
+    if (tCalibrated)
+        av_dict_set(&tOptions, tCalibratedSetting.Option.c_str(), tCalibratedSetting.Value.c_str(), 0);
+
+    // replace the quality driven settings by a bit rate target with VBV constraints
+    if (mRateControlRealtime)
+        ApplyRealtimeRateControl(tCodecContext, tCodec);
+
     // Open codec
     LOG(LOG_VERBOSE, "..opening video codec");
-    if ((tResult = HM_avcodec_open(mCodecContext, tCodec, &tOptions)) < 0)
+    if ((tResult = HM_avcodec_open(tCodecContext, tCodec, &tOptions)) < 0)
     {
         LOG(LOG_WARN, "Couldn't open video codec %s because \"%s\". Will try to open the video open codec without options and with disabled MT..", tCodec->name, strerror(AVUNERROR(tResult)));
 
         // maybe the encoder doesn't support multi-threading?
-        mCodecContext->thread_count = 1;
+        tCodecContext->thread_count = 1;
         AVDictionary *tNullOptions = NULL;
-        if ((tResult = HM_avcodec_open(mCodecContext, tCodec, &tNullOptions)) < 0)
+        if ((tResult = HM_avcodec_open(tCodecContext, tCodec, &tNullOptions)) < 0)
         {
             LOG(LOG_ERROR, "Couldn't open video codec because \"%s\".", strerror(AVUNERROR(tResult)));
 
             // free codec and stream 0
-            av_freep(&mMediaStream->codec);
-            av_freep(&mMediaStream);
+            av_freep(&tMediaStream->codec);
+            av_freep(&tMediaStream);
 
             // Close the format context
-            av_free(mFormatContext);
+            av_free(tFormatContext);
 
             return false;
         }
     }
 
     if (tCodec->capabilities & CODEC_CAP_DELAY)
-        LOG(LOG_VERBOSE, "%s encoder output might be delayed for %s codec", GetMediaTypeStr().c_str(), mCodecContext->codec->name);
+        LOG(LOG_VERBOSE, "%s encoder output might be delayed for %s codec", GetMediaTypeStr().c_str(), tCodecContext->codec->name);
 
-    // init transcoder FIFO based for RGB32 pictures
-    StartEncoder();
-
-    //######################################################
-    //### give some verbose output
-    //######################################################
-    mStreamMaxFps_LastFrame_Timestamp = Time::GetTimeStamp();
-    MarkOpenGrabDeviceSuccessful();
-    LOG(LOG_INFO, "    ..max packet size: %d bytes", mStreamMaxPacketSize);
-    LOG(LOG_INFO, "  stream...");
-    LOG(LOG_INFO, "    ..AV stream context at: %p", mMediaStream);
-    LOG(LOG_INFO, "    ..AV stream codec is: %s(%d)", mMediaStream->codec->codec->name, mMediaStream->codec->codec_id);
-    LOG(LOG_INFO, "    ..AV stream codec context at: 0x%p", mMediaStream->codec);
-    LOG(LOG_INFO, "    ..AV stream codec codec context at: 0x%p", mMediaStream->codec->codec);
+    pEncoder.FormatContext = tFormatContext;
+    pEncoder.MediaStream = tMediaStream;
+    pEncoder.CodecContext = tCodecContext;
+    pEncoder.CodecId = pCodecId;
+    pEncoder.Fps = pFps;
 
     return true;
 }
 
+void MediaSourceMuxer::DestroyVideoEncoder(VideoEncoderDescriptor &pEncoder)
+{
+    // Close the codec
+    pEncoder.MediaStream->discard = AVDISCARD_ALL;
+    avcodec_close(pEncoder.CodecContext);
+
+    // free codec and stream 0
+    av_freep(&pEncoder.MediaStream->codec);
+    av_freep(&pEncoder.MediaStream);
+
+    // Close the format context
+    av_free(pEncoder.FormatContext);
+
+    pEncoder.FormatContext = NULL;
+    pEncoder.CodecContext = NULL;
+}
+
+bool MediaSourceMuxer::ApplyLiveRateSettings()
+{
+    bool tResult = false;
+
+    // only x264 evaluates its rate control parameters again for each frame
+    if ((mMediaType != MEDIA_VIDEO) || (mCodecContext == NULL) || (mCodecContext->codec_id != AV_CODEC_ID_H264))
+        return false;
+
+    mEncoderSeekMutex.lock();
+
+    if ((mMediaSourceOpened) && (mCodecContext != NULL))
+    {
+        LOG(LOG_VERBOSE, "Changing bit rate of the running %s encoder from %d to %d bit/s", GetMediaTypeStr().c_str(), mCodecContext->bit_rate, mStreamBitRate);
+        mCodecContext->bit_rate = mStreamBitRate;
+        if (mRateControlRealtime)
+        {
+            int tVbvBufferSize = (int)((int64_t)mStreamBitRate * mRateControlVbvBufferTime / 1000);
+            mCodecContext->bit_rate_tolerance = tVbvBufferSize;
+            mCodecContext->rc_max_rate = mStreamBitRate;
+            mCodecContext->rc_buffer_size = tVbvBufferSize;
+        }
+        tResult = true;
+    }
+
+    mEncoderSeekMutex.unlock();
+
+    return tResult;
+}
+
+bool MediaSourceMuxer::ReconfigureVideoEncoder()
+{
+    if ((mMediaType != MEDIA_VIDEO) || (!mMediaSourceOpened) || (!IsRunning()))
+        return false;
+
+    // the new encoder is created in the background, the encoder thread continues with the old encoder in the meantime
+    return mVideoEncoderPreparer->Prepare();
+}
+
+void MediaSourceMuxer::PrepareVideoEncoder()
+{
+    VideoEncoderDescriptor tEncoder;
+
+    LOG(LOG_VERBOSE, "Creating new %s encoder for a live reconfiguration", GetMediaTypeStr().c_str());
+
+    if (!CreateVideoEncoder(tEncoder, mStreamCodecId, GetVideoMuxerFrameRate(mInputFrameRate)))
+    {
+        LOG(LOG_WARN, "Failed to create new %s encoder, a reset is needed", GetMediaTypeStr().c_str());
+
+        // the next grabbed chunk triggers the reset
+        mVideoEncoderResetNeeded = true;
+        return;
+    }
+
+    mVideoEncoderSwitchMutex.lock();
+
+    // an older encoder is replaced if the encoder thread hasn't picked it up yet
+    if (mVideoEncoderSwitchPending)
+        DestroyVideoEncoder(mPendingVideoEncoder);
+    mPendingVideoEncoder = tEncoder;
+    mVideoEncoderSwitchPending = true;
+
+    mVideoEncoderSwitchMutex.unlock();
+
+    // write fake data to awake encoder thread
+    mEncoderFifoState.lock();
+    if (mEncoderFifo != NULL)
+        mEncoderFifo->WriteFifo(NULL, 0, 0);
+    mEncoderFifoState.unlock();
+}
+
+VideoScaler* MediaSourceMuxer::RedirectVideoEncoderInput(VideoScaler *&pVideoScaler)
+{
+    VideoScaler *tOldVideoScaler = pVideoScaler;
+
+    mVideoEncoderSwitchMutex.lock();
+    if (!mVideoEncoderSwitchPending)
+    {
+        mVideoEncoderSwitchMutex.unlock();
+        return NULL;
+    }
+    mNextVideoEncoder = mPendingVideoEncoder;
+    mPendingVideoEncoder.FormatContext = NULL;
+    mPendingVideoEncoder.MediaStream = NULL;
+    mPendingVideoEncoder.CodecContext = NULL;
+    mVideoEncoderSwitchPending = false;
+    mVideoEncoderSwitchMutex.unlock();
+
+    LOG(LOG_VERBOSE, "Redirecting grabbed %s frames to the new encoder %s with resolution %d * %d and %3.2f fps", GetMediaTypeStr().c_str(), GetFormatName(mNextVideoEncoder.CodecId).c_str(), mNextVideoEncoder.ResX, mNextVideoEncoder.ResY, mNextVideoEncoder.Fps);
+
+    // #########################################
+    // new scaler for the new output format
+    // #########################################
+    int tSourceResX = mSourceResX;
+    int tSourceResY = mSourceResY;
+    VideoScaler *tNewVideoScaler = new VideoScaler(this, "Video-Encoder(" + GetFormatName(mNextVideoEncoder.CodecId) + ")");
+    if(tNewVideoScaler == NULL)
+        LOG(LOG_ERROR, "Invalid video scaler instance, possible out of memory");
+    tNewVideoScaler->StartScaler(MEDIA_SOURCE_MUX_INPUT_QUEUE_SIZE_LIMIT, tSourceResX, tSourceResY, PIX_FMT_RGB32, mNextVideoEncoder.ResX, mNextVideoEncoder.ResY, mNextVideoEncoder.CodecContext->pix_fmt);
+
+    mEncoderFifoAvailableMutex.lock();
+    mEncoderFifoState.lock();
+
+    mEncoderFifo = tNewVideoScaler;
+    pVideoScaler = tNewVideoScaler;
+
+    // frames of a changed grab resolution fit to the new scaler
+    if ((tSourceResX == mSourceResX) && (tSourceResY == mSourceResY))
+        mVideoEncoderInputChangePending = false;
+
+    mEncoderFifoState.unlock();
+    mEncoderFifoAvailableMutex.unlock();
+
+    // the old encoder finishes the frames which are still queued in the old scaler, the empty packet marks their end
+    tOldVideoScaler->WriteFifo(NULL, 0, 0);
+
+    return tOldVideoScaler;
+}
+
+void MediaSourceMuxer::SwitchVideoEncoder(VideoScaler *pOldVideoScaler)
+{
+    VideoEncoderDescriptor tOldEncoder, tNewEncoder;
+
+    tNewEncoder = mNextVideoEncoder;
+    mNextVideoEncoder.FormatContext = NULL;
+    mNextVideoEncoder.MediaStream = NULL;
+    mNextVideoEncoder.CodecContext = NULL;
+
+    LOG(LOG_VERBOSE, "Switching %s encoder on the fly to %s with resolution %d * %d and %3.2f fps", GetMediaTypeStr().c_str(), GetFormatName(tNewEncoder.CodecId).c_str(), tNewEncoder.ResX, tNewEncoder.ResY, tNewEncoder.Fps);
+
+    // #########################################
+    // replace the encoder
+    // #########################################
+    mEncoderSeekMutex.lock();
+
+    // push the frames out which are still buffered inside the old encoder
+    if (mCodecContext->codec->capabilities & CODEC_CAP_DELAY)
+    {
+        while ((mEncoderBufferedFrames > 0) && (EncodeAndWritePacket(mFormatContext, mCodecContext, NULL, mEncoderBufferedFrames)))
+            mEncoderBufferedFrames--;
+    }
+    av_write_trailer(mFormatContext);
+
+    tOldEncoder.FormatContext = mFormatContext;
+    tOldEncoder.MediaStream = mMediaStream;
+    tOldEncoder.CodecContext = mCodecContext;
+
+    mFormatContext = tNewEncoder.FormatContext;
+    mMediaStream = tNewEncoder.MediaStream;
+    mCodecContext = tNewEncoder.CodecContext;
+    mCurrentStreamingResX = tNewEncoder.ResX;
+    mCurrentStreamingResY = tNewEncoder.ResY;
+    mInputFrameRate = tNewEncoder.Fps;
+    mOutputFrameRate = tNewEncoder.Fps;
+    mMuxerOutFormat.video_codec = tNewEncoder.CodecId;
+    mEncoderBufferedFrames = 0;
+
+    // the media sinks detect the new stream when they receive its first packet
+    int tResult;
+    if ((tResult = avformat_write_header(mFormatContext, NULL)) < 0)
+        LOG(LOG_ERROR, "Couldn't write %s codec header because \"%s\".", GetMediaTypeStr().c_str(), strerror(AVUNERROR(tResult)));
+    // store the reference to this instance
+    *(void**)mFormatContext->priv_data = this;
+
+    // HINT: mFrameNumber and mEncoderStartTime are kept to continue with monotonic timestamps
+    mVideoEncoderSwitchTime = (mLastOutputPacketTime != 0) ? mLastOutputPacketTime : Time::GetTimeStamp();
+
+    // the receivers can decode the new stream from its first frame on
+    mVideoEncoderKeyFrameNeeded = true;
+
+    mEncoderSeekMutex.unlock();
+
+    DestroyVideoEncoder(tOldEncoder);
+
+    pOldVideoScaler->StopScaler();
+    delete pOldVideoScaler;
+
+    LOG(LOG_INFO, "%s encoder switched on the fly", GetMediaTypeStr().c_str());
+}
+
+int64_t MediaSourceMuxer::GetEncoderSwitchGap()
+{
+    return mVideoEncoderSwitchGap;
+}
+
 bool MediaSourceMuxer::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
 {
     bool tResult = false;
@@ -861,7 +1353,7 @@ bool MediaSourceMuxer::OpenAudioMuxer(int pSampleRate, int pChannels)
     mCodecContext->channel_layout = HM_av_get_default_channel_layout(mOutputAudioChannels);
     mCodecContext->sample_rate = mOutputAudioSampleRate;
     // set max. packet size for RTP based packets
-    mCodecContext->rtp_payload_size = mStreamMaxPacketSize;
+    mCodecContext->rtp_payload_size = GetStreamMaxPacketSize();
 
     // some formats want stream headers to be separate, but this produces some very small packets!
     if(mFormatContext->oformat->flags & AVFMT_GLOBALHEADER)
@@ -887,9 +1379,9 @@ bool MediaSourceMuxer::OpenAudioMuxer(int pSampleRate, int pChannels)
         return false;
     }
 
-    // fix frame size of 0 for some audio codecs
+    // fix frame size of 0 for some audio codecs: sample based codecs deliver frames of the default packetization time, the RTP packetizer aggregates them according to the negotiated one
     if (mCodecContext->frame_size < 32)
-        mCodecContext->frame_size = MEDIA_SOURCE_SAMPLES_PER_BUFFER;
+        mCodecContext->frame_size = mOutputAudioSampleRate * RTP_AUDIO_PTIME_DEFAULT / 1000;
 
     mOutputAudioFormat = mCodecContext->sample_fmt;
 
@@ -903,7 +1395,7 @@ bool MediaSourceMuxer::OpenAudioMuxer(int pSampleRate, int pChannels)
     //### give some verbose output
     //######################################################
     MarkOpenGrabDeviceSuccessful();
-    LOG(LOG_INFO, "    ..max packet size: %d bytes", mStreamMaxPacketSize);
+    LOG(LOG_INFO, "    ..max packet size: %d bytes (path limit: %d bytes)", mStreamMaxPacketSize, mStreamPathMaxPacketSize);
     LOG(LOG_INFO, "  stream...");
     LOG(LOG_INFO, "    ..AV stream context at: %p", mMediaStream);
     LOG(LOG_INFO, "    ..AV stream codec is: %s(%d)", mMediaStream->codec->codec->name, mMediaStream->codec->codec_id);
@@ -987,6 +1479,9 @@ bool MediaSourceMuxer::CloseMuxer()
 
     mFrameNumber = 0;
     mRelayingSkipAudioSilenceSkippedChunks = 0;
+    mRelayingSkipIdleFramesSkippedFrames = 0;
+    ResetIdleFrameDetection();
+    ResetEncodedFrameStatistic();
 
     return tResult;
 }
@@ -1240,7 +1735,17 @@ int MediaSourceMuxer::GrabChunk(void* pChunkBuffer, int& pChunkSize, bool pDropC
     // ###################################################################
     mEncoderFifoAvailableMutex.lock();
 
-    if ((BelowMaxFps(tResult) /* we have to call this function continuously */) && (mStreamActivated) && (!pDropChunk) && (tResult >= 0) && (pChunkSize > 0) && (tMediaSinks) && (mEncoderFifo != NULL))
+    bool tRelayChunk = (BelowMaxFps(tResult) /* we have to call this function continuously */) && (mStreamActivated) && (!pDropChunk) && (tResult >= 0) && (pChunkSize > 0) && (tMediaSinks) && (mEncoderFifo != NULL);
+
+    // the grab resolution has changed, the frames wait for the scaler of the prepared encoder
+    if ((tRelayChunk) && (mMediaType == MEDIA_VIDEO) && (mVideoEncoderInputChangePending))
+        tRelayChunk = false;
+
+    // unchanged video content is only encoded at the keep-alive rate
+    if ((tRelayChunk) && (mMediaType == MEDIA_VIDEO) && (mRelayingSkipIdleFrames) && (SkipIdleFrame(pChunkBuffer, pChunkSize)))
+        tRelayChunk = false;
+
+    if (tRelayChunk)
     {
         // we relay this chunk to all registered media sinks based on the dedicated relay thread
         int64_t tTime = Time::GetTimeStamp();
@@ -1263,6 +1768,21 @@ int MediaSourceMuxer::GrabChunk(void* pChunkBuffer, int& pChunkSize, bool pDropC
     // unlock grabbing
     mGrabMutex.unlock();
 
+    // adapt the packet size to the network paths towards the media sinks
+    if ((tMediaSinks) && (CheckPathMaxPacketSize()) && (!ReconfigureVideoEncoder()))
+        Reset();
+
+    // a live reconfiguration has failed in the background
+    if (mVideoEncoderResetNeeded)
+    {
+        mVideoEncoderResetNeeded = false;
+        Reset();
+    }
+
+    // adapt the audio packetization to the amount of media sinks
+    if ((tMediaSinks) && (mMediaType == MEDIA_AUDIO))
+        CheckAudioPacketizationMode();
+
     // acknowledge success
     MarkGrabChunkSuccessful(tResult);
 
@@ -1303,6 +1823,86 @@ bool MediaSourceMuxer::BelowMaxFps(int pFrameNumber)
     return false;
 }
 
+void MediaSourceMuxer::ResetIdleFrameDetection()
+{
+    mIdleFrameCount = 0;
+    mIdleFrameHash = 0;
+    mIdleFrameModifiers = -1;
+    mIdleFrameLastKeepAliveTime = 0;
+}
+
+uint64_t MediaSourceMuxer::CalculateFrameHash(void *pChunkBuffer, int pChunkSize)
+{
+    // FNV-1a over 64 bit words, the remaining bytes are added one by one
+    uint64_t tResult = 14695981039346656037ULL;
+    uint64_t *tWords = (uint64_t*)pChunkBuffer;
+    int tWordCount = pChunkSize / sizeof(uint64_t);
+    unsigned char *tBytes = (unsigned char*)pChunkBuffer + tWordCount * sizeof(uint64_t);
+
+    for (int i = 0; i < tWordCount; i++)
+        tResult = (tResult ^ tWords[i]) * 1099511628211ULL;
+    for (int i = 0; i < pChunkSize % (int)sizeof(uint64_t); i++)
+        tResult = (tResult ^ tBytes[i]) * 1099511628211ULL;
+
+    return tResult;
+}
+
+//HINT: call this function only for frames which would be relayed otherwise
+bool MediaSourceMuxer::SkipIdleFrame(void *pChunkBuffer, int pChunkSize)
+{
+    bool tUnchanged;
+    int64_t tCurrentTime = Time::GetTimeStamp();
+    // the muxer changes the frame content itself by flipping and the OSD
+    int tModifiers = (mVideoHFlip ? 1 : 0) | (mVideoVFlip ? 2 : 0) | (mMarkerActivated ? 4 : 0);
+
+    //####################################################################
+    // detect unchanged content: trust the hint of the base source, otherwise compare frame hashes
+    // ###################################################################
+    if ((tModifiers == mIdleFrameModifiers) && (!mMarkerActivated) && (mMediaSource->IsVideoFrameUnchanged()))
+    {
+        tUnchanged = true;
+    }else
+    {
+        uint64_t tHash = CalculateFrameHash(pChunkBuffer, pChunkSize);
+        tUnchanged = (tModifiers == mIdleFrameModifiers) && (tHash == mIdleFrameHash);
+        mIdleFrameHash = tHash;
+    }
+    mIdleFrameModifiers = tModifiers;
+
+    // content has changed: restore the full frame rate instantly
+    if (!tUnchanged)
+    {
+        if (mIdleFrameCount > MEDIA_SOURCE_MUX_IDLE_FRAMES_BEFORE_SUPPRESSION)
+            LOG(LOG_VERBOSE, "Video content changed after %d unchanged frames, restoring full frame rate", mIdleFrameCount);
+        mIdleFrameCount = 0;
+        return false;
+    }
+
+    mIdleFrameCount++;
+
+    // give the encoder some frames to refine the picture quality
+    if (mIdleFrameCount < MEDIA_SOURCE_MUX_IDLE_FRAMES_BEFORE_SUPPRESSION)
+        return false;
+
+    if (mIdleFrameCount == MEDIA_SOURCE_MUX_IDLE_FRAMES_BEFORE_SUPPRESSION)
+    {
+        LOG(LOG_VERBOSE, "Video content is unchanged, reducing frame rate to %.2f keep-alive frames per second", mRelayingSkipIdleFramesKeepAliveFps);
+        mIdleFrameLastKeepAliveTime = tCurrentTime;
+        return false;
+    }
+
+    // time for a keep-alive frame?
+    if ((mRelayingSkipIdleFramesKeepAliveFps > 0) && (tCurrentTime - mIdleFrameLastKeepAliveTime >= (int64_t)(1000 * 1000 / mRelayingSkipIdleFramesKeepAliveFps)))
+    {
+        mIdleFrameLastKeepAliveTime = tCurrentTime;
+        return false;
+    }
+
+    mRelayingSkipIdleFramesSkippedFrames++;
+
+    return true;
+}
+
 int64_t MediaSourceMuxer::CalculateEncoderPts(int pFrameNumber)
 {
     int64_t tResult = 0;
@@ -1331,6 +1931,9 @@ void MediaSourceMuxer::StartEncoder()
         Thread::Suspend(25 * 1000);
     }
 
+    if (mMediaType == MEDIA_VIDEO)
+        mVideoEncoderPreparer->StartPreparer();
+
     LOG(LOG_VERBOSE, "..%s transcoder started", GetMediaTypeStr().c_str());
 }
 
@@ -1340,6 +1943,10 @@ void MediaSourceMuxer::StopEncoder()
 
     LOG(LOG_VERBOSE, "Stopping %s transcoder", GetMediaTypeStr().c_str());
 
+    // the encoder thread drops an encoder which is prepared until now
+    mVideoEncoderPreparer->StopPreparer();
+    mVideoEncoderResetNeeded = false;
+
     while(IsRunning())
     {
         // tell transcoder thread it isn't needed anymore
@@ -1405,6 +2012,8 @@ void* MediaSourceMuxer::Run(void* pArgs)
     int                 tChunkBufferSize = 0;
     uint8_t             *tChunkBuffer;
     VideoScaler         *tVideoScaler = NULL;
+    VideoScaler         *tDrainedVideoScaler = NULL; // scaler of the old encoder during a live reconfiguration
+    MediaFifo           *tInputFifo;
     int                 tFrameFinished = 0;
     int64_t             tLastInputFrameTimestamp = -1;
     int64_t             tInputFrameTimestamp = 0;
@@ -1441,6 +2050,7 @@ void* MediaSourceMuxer::Run(void* pArgs)
 
             // set the video scaler as FIFO for the encoder
             mEncoderFifo = tVideoScaler;
+            mVideoEncoderInputChangePending = false;
 
             mEncoderFifoAvailableMutex.unlock();
 
@@ -1461,6 +2071,8 @@ void* MediaSourceMuxer::Run(void* pArgs)
             mEncoderFifo = new MediaFifo(MEDIA_SOURCE_MUX_INPUT_QUEUE_SIZE_LIMIT, MEDIA_SOURCE_SAMPLES_MULTI_BUFFER_SIZE * 2, "AUDIO-Encoder");
             if (mEncoderFifo == NULL)
                 LOG(LOG_ERROR, "Out of memory for encoder FIFO");
+            else
+                SVC_MEDIA_MEMORY_BUDGET.AssignFifo(mEncoderFifo, this, false);
 
             mEncoderFifoAvailableMutex.unlock();
 
@@ -1502,12 +2114,19 @@ void* MediaSourceMuxer::Run(void* pArgs)
         #ifdef MSM_DEBUG_TIMING
             LOG(LOG_VERBOSE, "%s-encoder loop", GetMediaTypeStr().c_str());
         #endif
-        if (mEncoderFifo != NULL)
+
+        // live reconfiguration: new frames go to the scaler of a prepared encoder, the old encoder finishes the frames which are queued already
+        if ((mMediaType == MEDIA_VIDEO) && (mVideoEncoderSwitchPending) && (tDrainedVideoScaler == NULL))
+            tDrainedVideoScaler = RedirectVideoEncoderInput(tVideoScaler);
+
+        tInputFifo = (tDrainedVideoScaler != NULL) ? tDrainedVideoScaler : mEncoderFifo;
+
+        if (tInputFifo != NULL)
         {
             //####################################################################
             //### get next frame data
             //###################################################################
-            tFifoEntry = mEncoderFifo->ReadFifoExclusive(&tBuffer, tBufferSize, tInputFrameTimestamp /* NTP time */);
+            tFifoEntry = tInputFifo->ReadFifoExclusive(&tBuffer, tBufferSize, tInputFrameTimestamp /* NTP time */);
             if ((tLastInputFrameTimestamp != -1) && (tInputFrameTimestamp != 0) && (tInputFrameTimestamp < tLastInputFrameTimestamp))
                 LOG(LOG_WARN, "Input %s frame timestamp is too low: %"PRId64" <= %"PRId64", diff: %"PRId64, GetMediaTypeStr().c_str(), tInputFrameTimestamp, tLastInputFrameTimestamp, tInputFrameTimestamp - tLastInputFrameTimestamp);
             tLastInputFrameTimestamp = tInputFrameTimestamp;
@@ -1546,8 +2165,8 @@ void* MediaSourceMuxer::Run(void* pArgs)
                                 #endif
 
                                 tEncoderOutputFrameTimestamp = (int64_t)rint(CalculateEncoderPts(mFrameNumber));
-                                if (mMediaSource->HasVariableOutputFrameRate())
-                                {// base source delivers a variable output frame rate (we cannot rely on equidistant times between two grabbed frames
+                                if ((mMediaSource->HasVariableOutputFrameRate()) || (mRelayingSkipIdleFrames))
+                                {// base source delivers a variable output frame rate or idle frames are skipped (we cannot rely on equidistant times between two grabbed frames
                                     if (mEncoderStartTime == 0)
                                     {
                                         LOG(LOG_WARN, "Encoder start time is still invalid, setting a default value");
@@ -1581,6 +2200,11 @@ void* MediaSourceMuxer::Run(void* pArgs)
                                 tYUVFrame->height = mCurrentStreamingResY;
                                 tYUVFrame->format = mCodecContext->pix_fmt;
                                 tYUVFrame->pict_type = AV_PICTURE_TYPE_NONE;
+                                if (mVideoEncoderKeyFrameNeeded)
+                                {// first frame of a new encoder after a live reconfiguration
+                                    tYUVFrame->pict_type = AV_PICTURE_TYPE_I;
+                                    mVideoEncoderKeyFrameNeeded = false;
+                                }
                                 tYUVFrame->coded_picture_number = mFrameNumber;
                                 tYUVFrame->coded_picture_number = mFrameNumber;
 
@@ -1832,10 +2456,18 @@ void* MediaSourceMuxer::Run(void* pArgs)
 
             // release FIFO entry lock
             if (tFifoEntry >= 0)
-                mEncoderFifo->ReadFifoExclusiveFinished(tFifoEntry);
+                tInputFifo->ReadFifoExclusiveFinished(tFifoEntry);
+
+            // the old scaler is drained, the new encoder continues with the frames of the new scaler
+            if ((tDrainedVideoScaler != NULL) && (tBufferSize == 0) && (tDrainedVideoScaler->GetUsage() == 0) && (mEncoderThreadNeeded))
+            {
+                SwitchVideoEncoder(tDrainedVideoScaler);
+                tDrainedVideoScaler = NULL;
+            }
 
             // is FIFO near overload situation?
-            if (mEncoderFifo->GetUsage() >= MEDIA_SOURCE_MUX_INPUT_QUEUE_SIZE_LIMIT - 4)
+            //HINT: a drained scaler is never cleared, this would remove the marker at the end of its frames
+            if ((tDrainedVideoScaler == NULL) && (mEncoderFifo->GetUsage() >= MEDIA_SOURCE_MUX_INPUT_QUEUE_SIZE_LIMIT - 4))
             {
                 LOG(LOG_WARN, "%s encoder FIFO with %d entries is near overload situation, deleting all stored frames", GetMediaTypeStr().c_str(), mEncoderFifo->GetSize());
 
@@ -1849,6 +2481,22 @@ void* MediaSourceMuxer::Run(void* pArgs)
         }
     }
 
+    // drop an encoder which was prepared but not used anymore
+    mVideoEncoderSwitchMutex.lock();
+    if (mVideoEncoderSwitchPending)
+    {
+        DestroyVideoEncoder(mPendingVideoEncoder);
+        mVideoEncoderSwitchPending = false;
+    }
+    mVideoEncoderSwitchMutex.unlock();
+    if (tDrainedVideoScaler != NULL)
+    {
+        DestroyVideoEncoder(mNextVideoEncoder);
+        tDrainedVideoScaler->StopScaler();
+        delete tDrainedVideoScaler;
+    }
+    mVideoEncoderKeyFrameNeeded = false;
+
     LOG(LOG_VERBOSE, "%s encoder left thread main loop", GetMediaTypeStr().c_str());
 
     mEncoderFifoAvailableMutex.lock();
@@ -2001,6 +2649,22 @@ float MediaSourceMuxer::GetFrameBufferTime()
         return mDecoderFrameBufferTime;
 }
 
+float MediaSourceMuxer::GetFrameBufferActivePreBufferingTime()
+{
+    if (mMediaSource != NULL)
+        return mMediaSource->GetFrameBufferActivePreBufferingTime();
+    else
+        return mDecoderFramePreBufferTime;
+}
+
+int MediaSourceMuxer::GetTimeToFirstFrame()
+{
+    if (mMediaSource != NULL)
+        return mMediaSource->GetTimeToFirstFrame();
+    else
+        return -1;
+}
+
 int MediaSourceMuxer::GetFrameBufferCounter()
 {
     if (mMediaSource != NULL)
@@ -2037,6 +2701,34 @@ int MediaSourceMuxer::GetDecoderOutputFrameDelay()
         return mDecoderOutputFrameDelay;
 }
 
+void MediaSourceMuxer::SetBackground(bool pBackground)
+{
+    MediaSources::iterator tIt;
+
+    MediaSource::SetBackground(pBackground);
+
+    // the FIFOs belong to the base media sources
+    mMediaSourcesMutex.lock();
+    for (tIt = mMediaSources.begin(); tIt != mMediaSources.end(); tIt++)
+        (*tIt)->SetBackground(pBackground);
+    mMediaSourcesMutex.unlock();
+}
+
+bool MediaSourceMuxer::IsBackground()
+{
+    return MediaSource::IsBackground();
+}
+
+int64_t MediaSourceMuxer::GetMemoryUsage()
+{
+    int64_t tResult = MediaSource::GetMemoryUsage();
+
+    if (mMediaSource != NULL)
+        tResult += mMediaSource->GetMemoryUsage();
+
+    return tResult;
+}
+
 void MediaSourceMuxer::SetVideoGrabResolution(int pResX, int pResY)
 {
     if (mMediaType == MEDIA_AUDIO)
@@ -2112,12 +2804,19 @@ void MediaSourceMuxer::SetVideoGrabResolution(int pResX, int pResY)
             // lock grabbing
             mGrabMutex.lock();
 
-            CloseMuxer();
-
             if (mMediaSource != NULL)
               mMediaSource->SetVideoGrabResolution(mSourceResX, mSourceResY);
 
-            OpenVideoMuxer(mSourceResX, mSourceResY, mInputFrameRate);
+            // the grabbed frames are held back until the encoder thread uses a scaler for the new resolution
+            mEncoderFifoAvailableMutex.lock();
+            mVideoEncoderInputChangePending = true;
+            mEncoderFifoAvailableMutex.unlock();
+
+            if (!ReconfigureVideoEncoder())
+            {
+                CloseMuxer();
+                OpenVideoMuxer(mSourceResX, mSourceResY, mInputFrameRate);
+            }
 
             // unlock grabbing
             mGrabMutex.unlock();
@@ -2375,6 +3074,250 @@ int MediaSourceMuxer::GetRelaySkipSilenceSkippedChunks()
     return mRelayingSkipAudioSilenceSkippedChunks;
 }
 
+void MediaSourceMuxer::SetRelaySkipIdleFrames(bool pState)
+{
+    if (mRelayingSkipIdleFrames != pState)
+    {
+        LOG(LOG_VERBOSE, "Setting \"relay skip idle frames\" activation to: %d", pState);
+        mRelayingSkipIdleFrames = pState;
+        ResetIdleFrameDetection();
+    }
+}
+
+void MediaSourceMuxer::SetRelaySkipIdleFramesKeepAliveFps(float pFps)
+{
+    if (mRelayingSkipIdleFramesKeepAliveFps != pFps)
+    {
+        LOG(LOG_VERBOSE, "Setting keep-alive rate for idle video frames to: %.2f", pFps);
+        mRelayingSkipIdleFramesKeepAliveFps = pFps;
+    }
+}
+
+float MediaSourceMuxer::GetRelaySkipIdleFramesKeepAliveFps()
+{
+    return mRelayingSkipIdleFramesKeepAliveFps;
+}
+
+int64_t MediaSourceMuxer::GetRelaySkipIdleFramesSkippedFrames()
+{
+    return mRelayingSkipIdleFramesSkippedFrames;
+}
+
+bool MediaSourceMuxer::IsRelayIdle()
+{
+    return (mRelayingSkipIdleFrames) && (mIdleFrameCount >= MEDIA_SOURCE_MUX_IDLE_FRAMES_BEFORE_SUPPRESSION);
+}
+
+bool MediaSourceMuxer::SetRealtimeRateControl(bool pState, int pVbvBufferTime, bool pIntraRefresh)
+{
+    bool tResult = false;
+
+    // the VBV buffer has to store at least one frame at the minimum frame rate of 5 fps
+    if (pVbvBufferTime < 200)
+        pVbvBufferTime = 200;
+
+    if ((mRateControlRealtime != pState) || (mRateControlVbvBufferTime != pVbvBufferTime) || (mRateControlIntraRefresh != pIntraRefresh))
+    {
+        LOG(LOG_VERBOSE, "Setting real-time rate control to: %d (VBV buffer: %d ms, intra refresh: %d)", pState, pVbvBufferTime, pIntraRefresh);
+        mRateControlRealtime = pState;
+        mRateControlVbvBufferTime = pVbvBufferTime;
+        mRateControlIntraRefresh = pIntraRefresh;
+        tResult = true;
+    }
+
+    return tResult;
+}
+
+bool MediaSourceMuxer::GetRealtimeRateControl()
+{
+    return mRateControlRealtime;
+}
+
+int MediaSourceMuxer::GetRealtimeRateControlVbvBufferTime()
+{
+    return mRateControlVbvBufferTime;
+}
+
+bool MediaSourceMuxer::GetRealtimeRateControlIntraRefresh()
+{
+    return mRateControlIntraRefresh;
+}
+
+void MediaSourceMuxer::ApplyRealtimeRateControl(AVCodecContext *pCodecContext, AVCodec *pCodec)
+{
+    int tResult;
+
+    // the VBV buffer limits the deviation from the target bit rate and thereby the size of each single frame
+    int tVbvBufferSize = (int)((int64_t)mStreamBitRate * mRateControlVbvBufferTime / 1000);
+    int tKeyFramePeriod = (int)(MEDIA_SOURCE_MUX_REALTIME_KEY_FRAME_PERIOD * pCodecContext->time_base.den / pCodecContext->time_base.num);
+    LOG(LOG_VERBOSE, "Using real-time rate control for %s codec %s: %d bit/s, VBV buffer of %d ms (%d bits), key frame period of %d frames", GetMediaTypeStr().c_str(), pCodec->name, mStreamBitRate, mRateControlVbvBufferTime, tVbvBufferSize, tKeyFramePeriod);
+
+    pCodecContext->bit_rate = mStreamBitRate;
+    pCodecContext->bit_rate_tolerance = tVbvBufferSize;
+    pCodecContext->rc_max_rate = mStreamBitRate;
+    pCodecContext->rc_buffer_size = tVbvBufferSize;
+    pCodecContext->rc_initial_buffer_occupancy = tVbvBufferSize * 3 / 4;
+
+    // the rate control needs the entire quantizer range
+    pCodecContext->qmin = 2;
+    pCodecContext->qmax = 31;
+
+    // no B-frames: they add delay and large reference frames
+    pCodecContext->max_b_frames = 0;
+
+    // key frames are needed only seldom
+    if (pCodecContext->codec_id != AV_CODEC_ID_THEORA)
+        pCodecContext->gop_size = tKeyFramePeriod;
+
+    switch(pCodecContext->codec_id)
+    {
+        case AV_CODEC_ID_H264:
+                        pCodecContext->qmax = 51;
+                        if ((tResult = av_opt_set(pCodecContext->priv_data, "tune", "zerolatency", 0)) < 0)
+                            LOG(LOG_WARN, "Failed to set A/V option \"tune\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
+                        // limit the size of each NAL unit to the RTP payload size
+                        if ((tResult = av_opt_set(pCodecContext->priv_data, "slice-max-size", toString(GetStreamMaxPacketSize()).c_str(), 0)) < 0)
+                            LOG(LOG_WARN, "Failed to set A/V option \"slice-max-size\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
+                        // replace periodic IDR frames by a column of intra blocks which wanders through the picture
+                        if (mRateControlIntraRefresh)
+                        {
+                            if ((tResult = av_opt_set(pCodecContext->priv_data, "intra-refresh", "1", 0)) < 0)
+                                LOG(LOG_WARN, "Failed to set A/V option \"intra-refresh\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
+                        }
+                        break;
+        case AV_CODEC_ID_HEVC:
+                        pCodecContext->qmax = 51;
+                        if ((tResult = av_opt_set(pCodecContext->priv_data, "tune", "zerolatency", 0)) < 0)
+                            LOG(LOG_WARN, "Failed to set A/V option \"tune\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
+                        if (mRateControlIntraRefresh)
+                        {
+                            if ((tResult = av_opt_set(pCodecContext->priv_data, "x265-params", "intra-refresh=1", 0)) < 0)
+                                LOG(LOG_WARN, "Failed to set A/V option \"x265-params\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
+                        }
+                        break;
+        case AV_CODEC_ID_VP9:
+        case AV_CODEC_ID_AV1:
+                        // libvpx and libaom use the quantizer range 0-63
+                        pCodecContext->qmax = 63;
+                        // cyclic refresh of intra blocks
+                        if (mRateControlIntraRefresh)
+                        {
+                            if ((tResult = av_opt_set(pCodecContext->priv_data, "aq-mode", "3", 0)) < 0)
+                                LOG(LOG_WARN, "Failed to set A/V option \"aq-mode\" because %s(0x%x)", strerror(AVUNERROR(tResult)), tResult);
+                        }
+                        break;
+        default:
+                        if (mRateControlIntraRefresh)
+                            LOG(LOG_VERBOSE, "Codec %s doesn't support intra refresh, using periodic key frames", pCodec->name);
+                        break;
+    }
+}
+
+int MediaSourceMuxer::GetStreamMaxPacketSize()
+{
+    // the configured packet size remains the upper limit, the network path may only reduce it
+    if ((mStreamPathMaxPacketSize > 0) && (mStreamPathMaxPacketSize < mStreamMaxPacketSize))
+        return mStreamPathMaxPacketSize;
+    else
+        return mStreamMaxPacketSize;
+}
+
+bool MediaSourceMuxer::CheckPathMaxPacketSize()
+{
+    int64_t tTime = Time::GetTimeStamp();
+    if (tTime - mStreamPathMaxPacketSizeLastCheck < MEDIA_SOURCE_MUX_PATH_MTU_CHECK_PERIOD * 1000 * 1000)
+        return false;
+    mStreamPathMaxPacketSizeLastCheck = tTime;
+
+    // determine the smallest packet size limit of all registered media sinks
+    int tPathMaxPacketSize = 0;
+    mMediaSinksMutex.lock();
+    for (MediaSinks::iterator tIt = mMediaSinks.begin(); tIt != mMediaSinks.end(); tIt++)
+    {
+        int tSinkMaxPacketSize = (*tIt)->GetPathMaxPacketSize();
+        if ((tSinkMaxPacketSize > 0) && ((tPathMaxPacketSize == 0) || (tSinkMaxPacketSize < tPathMaxPacketSize)))
+            tPathMaxPacketSize = tSinkMaxPacketSize;
+    }
+    mMediaSinksMutex.unlock();
+
+    // the RTP header of each packet has to fit into the path limit
+    if ((tPathMaxPacketSize > 0) && (tPathMaxPacketSize < RTP::GetHeaderSizeMax(mStreamCodecId) * 2))
+    {
+        LOG(LOG_WARN, "Path limit of %d bytes for %s packets is too small, ignoring it", tPathMaxPacketSize, GetMediaTypeStr().c_str());
+        tPathMaxPacketSize = 0;
+    }
+
+    if (tPathMaxPacketSize == mStreamPathMaxPacketSize)
+        return false;
+
+    int tOldStreamMaxPacketSize = GetStreamMaxPacketSize();
+    mStreamPathMaxPacketSize = tPathMaxPacketSize;
+    if (GetStreamMaxPacketSize() == tOldStreamMaxPacketSize)
+        return false;
+
+    LOG(LOG_INFO, "Max. %s packet size changed from %d to %d bytes due to the network path", GetMediaTypeStr().c_str(), tOldStreamMaxPacketSize, GetStreamMaxPacketSize());
+
+    return ((mCodecContext != NULL) && (mCodecContext->rtp_payload_size != GetStreamMaxPacketSize()));
+}
+
+void MediaSourceMuxer::CheckAudioPacketizationMode()
+{
+    int64_t tTime = Time::GetTimeStamp();
+    if (tTime - mAudioPacketizationModeLastCheck < MEDIA_SOURCE_MUX_AUDIO_PACKETIZATION_CHECK_PERIOD * 1000 * 1000)
+        return;
+    mAudioPacketizationModeLastCheck = tTime;
+
+    // each packet costs CPU time and header overhead per media sink, for many media sinks fewer but larger packets are preferred
+    mMediaSinksMutex.lock();
+    bool tLowOverhead = ((int)mMediaSinks.size() >= MEDIA_SOURCE_MUX_AUDIO_LOW_OVERHEAD_SINKS);
+    if (tLowOverhead != mAudioLowOverheadPacketization)
+        LOG(LOG_INFO, "Switching audio packetization to %s mode for %d media sinks", tLowOverhead ? "low-overhead" : "low-latency", (int)mMediaSinks.size());
+    mAudioLowOverheadPacketization = tLowOverhead;
+
+    // apply the mode also to media sinks which were registered since the last check
+    for (MediaSinks::iterator tIt = mMediaSinks.begin(); tIt != mMediaSinks.end(); tIt++)
+        (*tIt)->SetAudioLowOverheadPacketization(tLowOverhead);
+    mMediaSinksMutex.unlock();
+}
+
+void MediaSourceMuxer::AccountEncodedFrame(int pSize)
+{
+    // running mean and variance according to Welford
+    mEncodedFrames++;
+    double tDelta = pSize - mEncodedFrameSizeMean;
+    mEncodedFrameSizeMean += tDelta / mEncodedFrames;
+    mEncodedFrameSizeM2 += tDelta * (pSize - mEncodedFrameSizeMean);
+
+    if (mEncodedFrameSizePeak < pSize)
+        mEncodedFrameSizePeak = pSize;
+}
+
+void MediaSourceMuxer::ResetEncodedFrameStatistic()
+{
+    mEncodedFrames = 0;
+    mEncodedFrameSizeMean = 0;
+    mEncodedFrameSizeM2 = 0;
+    mEncodedFrameSizePeak = 0;
+}
+
+int MediaSourceMuxer::GetEncodedFrameSizeAverage()
+{
+    return (int)mEncodedFrameSizeMean;
+}
+
+int MediaSourceMuxer::GetEncodedFrameSizeDeviation()
+{
+    if (mEncodedFrames < 2)
+        return 0;
+
+    return (int)sqrt(mEncodedFrameSizeM2 / (mEncodedFrames - 1));
+}
+
+int MediaSourceMuxer::GetEncodedFrameSizePeak()
+{
+    return mEncodedFrameSizePeak;
+}
+
 string MediaSourceMuxer::GetSourceTypeStr()
 {
     if (mMediaSource != NULL)
@@ -2406,7 +3349,21 @@ void MediaSourceMuxer::getVideoDevices(VideoDevices &pVList)
     mMediaSourcesMutex.lock();
 
     for (tIt = mMediaSources.begin(); tIt != mMediaSources.end(); tIt++)
-        (*tIt)->getVideoDevices(pVList);
+    {
+        // device enumeration is expensive, the lists of device backends are cached until a device changes
+        if ((*tIt)->GetSourceType() == SOURCE_DEVICE)
+        {
+            string tBackend = GetObjectNameStr(*tIt);
+            if (!SVC_MEDIA_DEVICE_REGISTRY.GetCachedVideoDevices(tBackend, pVList))
+            {
+                VideoDevices tDevices;
+                (*tIt)->getVideoDevices(tDevices);
+                SVC_MEDIA_DEVICE_REGISTRY.CacheVideoDevices(tBackend, tDevices);
+                pVList.insert(pVList.end(), tDevices.begin(), tDevices.end());
+            }
+        }else
+            (*tIt)->getVideoDevices(pVList);
+    }
 
     // unlock
     mMediaSourcesMutex.unlock();
@@ -2428,7 +3385,21 @@ void MediaSourceMuxer::getAudioDevices(AudioDevices &pAList)
     mMediaSourcesMutex.lock();
 
     for (tIt = mMediaSources.begin(); tIt != mMediaSources.end(); tIt++)
-        (*tIt)->getAudioDevices(pAList);
+    {
+        // device enumeration is expensive, the lists of device backends are cached until a device changes
+        if ((*tIt)->GetSourceType() == SOURCE_DEVICE)
+        {
+            string tBackend = GetObjectNameStr(*tIt);
+            if (!SVC_MEDIA_DEVICE_REGISTRY.GetCachedAudioDevices(tBackend, pAList))
+            {
+                AudioDevices tDevices;
+                (*tIt)->getAudioDevices(tDevices);
+                SVC_MEDIA_DEVICE_REGISTRY.CacheAudioDevices(tBackend, tDevices);
+                pAList.insert(pAList.end(), tDevices.begin(), tDevices.end());
+            }
+        }else
+            (*tIt)->getAudioDevices(pAList);
+    }
 
      // unlock
     mMediaSourcesMutex.unlock();
@@ -2569,8 +3540,7 @@ bool MediaSourceMuxer::SelectDevice(std::string pDesiredDevice, enum MediaType p
 
     if(mMediaSource != tOldMediaSource)
     {
-        mMediaSource->mMediaFilters = tOldMediaSource->mMediaFilters;
-        tOldMediaSource->mMediaFilters.clear();
+        tOldMediaSource->mMediaFilterPipeline.MoveFilters(mMediaSource->mMediaFilterPipeline);
     }
 
     // unlock
@@ -2618,7 +3588,7 @@ bool MediaSourceMuxer::UnregisterMediaFilter(MediaFilter *pMediaFilter, bool pAu
         return false;
 }
 
-bool MediaSourceMuxer::RegisterMediaSource(MediaSource* pMediaSource)
+bool MediaSourceMuxer::RegisterMediaSource(MediaSource* pMediaSource, bool pPreferred)
 {
     MediaSources::iterator tIt;
     bool tFound = false;
@@ -2639,7 +3609,17 @@ bool MediaSourceMuxer::RegisterMediaSource(MediaSource* pMediaSource)
     }
 
     if (!tFound)
-        mMediaSources.push_back(pMediaSource);
+    {
+        // "auto" selects the first device of the first source which provides one
+        if (pPreferred)
+            mMediaSources.insert(mMediaSources.begin(), pMediaSource);
+        else
+            mMediaSources.push_back(pMediaSource);
+        if (mSynchronizer != NULL)
+            pMediaSource->SetSynchronizer(mSynchronizer);
+        if (IsBackground())
+            pMediaSource->SetBackground(true);
+    }
 
     if (mMediaSource == NULL)
         mMediaSource = pMediaSource;
@@ -2763,6 +3743,23 @@ bool MediaSourceMuxer::TimeShift(int64_t pOffset)
     return tResult;
 }
 
+void MediaSourceMuxer::SetSynchronizer(MediaSynchronizer *pSynchronizer)
+{
+    MediaSources::iterator tIt;
+
+    MediaSource::SetSynchronizer(pSynchronizer);
+
+    // lock
+    mMediaSourcesMutex.lock();
+
+    // all registered sources follow the synchronizer, the selected one may change later
+    for (tIt = mMediaSources.begin(); tIt != mMediaSources.end(); tIt++)
+        (*tIt)->SetSynchronizer(pSynchronizer);
+
+    // unlock
+    mMediaSourcesMutex.unlock();
+}
+
 int MediaSourceMuxer::GetOutputSampleRate()
 {
     return mOutputAudioSampleRate;
@@ -28,12 +28,16 @@
 
 #include <MediaSourceNet.h>
 #include <MediaSource.h>
+#include <MediaLoopback.h>
 #include <ProcessStatisticService.h>
 #include <RequirementTransmitBitErrors.h>
 #include <RTP.h>
 #include <Logger.h>
+#include <HBMutex.h>
 
 #include <string>
+#include <list>
+#include <map>
 
 namespace Homer { namespace Multimedia {
 
@@ -51,10 +55,10 @@ using namespace Homer::Base;
 ///////////////////////////////////////////////////////////////////////////////
 
 class NetworkListener :
-    public Thread
+    public Thread, public MediaLoopbackReceiver
 {
 public:
-    NetworkListener(MediaSourceNet *pMediaSourceNet, Socket *pDataSocket, bool pRtpActivated = true);
+    NetworkListener(MediaSourceNet *pMediaSourceNet, Socket *pDataSocket, bool pRtpActivated = true, Socket *pBundleSocket = NULL);
     NetworkListener(MediaSourceNet *pMediaSourceNet, unsigned int pPortNumber, enum TransportType pTransportType, bool pRtpActivated = true);
     NetworkListener(MediaSourceNet *pMediaSourceNet, std::string pLocalName, Requirements *pTransportRequirements, bool pRtpActivated = true);
 
@@ -75,6 +79,9 @@ private:
     void Init(Socket *pDataSocket, unsigned int pLocalPort, bool pRtpActivated = true);
     bool ReceivePacket(std::string &pSourceHost, unsigned int &pSourcePort, char* pData, int &pSize);
 
+    /* packets of a sender in this process */
+    virtual bool ReceiveLoopbackPacket(char *pData, int pSize);
+
     /* network listener */
     virtual void* Run(void* pArgs = NULL);
 
@@ -83,10 +90,13 @@ private:
 
     /* general transport */
     int                 mReceiveErrors;
-    int                 mPacketNumber;
+    int64_t             mPacketNumber; // numbers the fragments of both paths, socket and loopback
+    int64_t             mLoopbackPackets;
     bool                mListenerNeeded;
     bool                mListenerStopped;
     bool                mListenerSocketCreatedOutside;
+    bool                mListenerSocketShared;
+    Socket              *mBundleSocket;
     bool                mStreamedTransport;
     /* Berkeley sockets based transport */
     std::string         mPeerHost;
@@ -101,10 +111,360 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+typedef std::list<MediaSourceNet*> MediaSourceNets;
+typedef std::map<unsigned int, MediaSourceNet*> SourceIdentifierRoutes;
+
+/*
+ * Receiver for a socket which is shared by several network sources, e.g., audio
+ * and video of a bundled session: one thread receives all packets and routes
+ * them by their RTP synchronization source. Unknown synchronization sources
+ * are assigned by the payload type which was negotiated for a source, or else
+ * by Homer's preferred payload types. RTCP packets follow their RTP stream.
+ */
+class NetworkDemultiplexer :
+    public Thread, public MediaLoopbackReceiver
+{
+public:
+    static void Attach(Socket *pDataSocket, MediaSourceNet *pMediaSourceNet);
+    static void Detach(Socket *pDataSocket, MediaSourceNet *pMediaSourceNet);
+
+private:
+    NetworkDemultiplexer(Socket *pDataSocket);
+
+    virtual ~NetworkDemultiplexer();
+
+    void StartDemultiplexer();
+    void StopDemultiplexer();
+    MediaSourceNet* RoutePacket(char *pData, int pSize);
+
+    /* packets of a sender in this process */
+    virtual bool ReceiveLoopbackPacket(char *pData, int pSize);
+
+    /* network receiver */
+    virtual void* Run(void* pArgs = NULL);
+
+    Socket                  *mDataSocket;
+    bool                    mDemultiplexerNeeded;
+    int                     mReceiveErrors;
+    int64_t                 mUnroutablePackets;
+    int64_t                 mLoopbackPackets;
+    int64_t                 mPacketNumber; // numbers the fragments of both paths, socket and loopback
+    MediaSourceNets         mMediaSourceNets;
+    SourceIdentifierRoutes  mSourceIdentifierRoutes;
+    Mutex                   mMediaSourceNetsMutex;
+
+    static std::map<Socket*, NetworkDemultiplexer*> sDemultiplexers;
+    static Mutex            sDemultiplexersMutex;
+};
+
+std::map<Socket*, NetworkDemultiplexer*> NetworkDemultiplexer::sDemultiplexers;
+Mutex NetworkDemultiplexer::sDemultiplexersMutex;
+
+NetworkDemultiplexer::NetworkDemultiplexer(Socket *pDataSocket)
+{
+    mDataSocket = pDataSocket;
+    mDemultiplexerNeeded = false;
+    mReceiveErrors = 0;
+    mUnroutablePackets = 0;
+    mLoopbackPackets = 0;
+    mPacketNumber = 0;
+}
+
+NetworkDemultiplexer::~NetworkDemultiplexer()
+{
+    LOG(LOG_VERBOSE, "Destroyed demultiplexer for port %u, %"PRId64" packets couldn't be routed, %"PRId64" packets were received via loopback", mDataSocket->GetLocalPort(), mUnroutablePackets, mLoopbackPackets);
+}
+
+void NetworkDemultiplexer::Attach(Socket *pDataSocket, MediaSourceNet *pMediaSourceNet)
+{
+    NetworkDemultiplexer *tDemultiplexer;
+    MediaSourceNets::iterator tIt;
+    bool tFound = false;
+
+    sDemultiplexersMutex.lock();
+
+    if (sDemultiplexers.find(pDataSocket) == sDemultiplexers.end())
+    {
+        LOGEX(NetworkDemultiplexer, LOG_VERBOSE, "Creating demultiplexer for shared port %u", pDataSocket->GetLocalPort());
+        sDemultiplexers[pDataSocket] = new NetworkDemultiplexer(pDataSocket);
+    }
+    tDemultiplexer = sDemultiplexers[pDataSocket];
+
+    tDemultiplexer->mMediaSourceNetsMutex.lock();
+    for (tIt = tDemultiplexer->mMediaSourceNets.begin(); tIt != tDemultiplexer->mMediaSourceNets.end(); tIt++)
+    {
+        if (*tIt == pMediaSourceNet)
+            tFound = true;
+    }
+    if (!tFound)
+    {
+        LOGEX(NetworkDemultiplexer, LOG_VERBOSE, "Attaching %s source to shared port %u", pMediaSourceNet->GetMediaTypeStr().c_str(), pDataSocket->GetLocalPort());
+        tDemultiplexer->mMediaSourceNets.push_back(pMediaSourceNet);
+    }
+    tDemultiplexer->mMediaSourceNetsMutex.unlock();
+
+    tDemultiplexer->StartDemultiplexer();
+
+    sDemultiplexersMutex.unlock();
+}
+
+void NetworkDemultiplexer::Detach(Socket *pDataSocket, MediaSourceNet *pMediaSourceNet)
+{
+    NetworkDemultiplexer *tDemultiplexer;
+    MediaSourceNets::iterator tIt;
+    SourceIdentifierRoutes::iterator tRouteIt;
+    bool tUnused;
+
+    sDemultiplexersMutex.lock();
+
+    if (sDemultiplexers.find(pDataSocket) != sDemultiplexers.end())
+    {
+        tDemultiplexer = sDemultiplexers[pDataSocket];
+
+        tDemultiplexer->mMediaSourceNetsMutex.lock();
+        for (tIt = tDemultiplexer->mMediaSourceNets.begin(); tIt != tDemultiplexer->mMediaSourceNets.end(); tIt++)
+        {
+            if (*tIt == pMediaSourceNet)
+            {
+                LOGEX(NetworkDemultiplexer, LOG_VERBOSE, "Detaching %s source from shared port %u", pMediaSourceNet->GetMediaTypeStr().c_str(), pDataSocket->GetLocalPort());
+                tDemultiplexer->mMediaSourceNets.erase(tIt);
+                break;
+            }
+        }
+        tRouteIt = tDemultiplexer->mSourceIdentifierRoutes.begin();
+        while (tRouteIt != tDemultiplexer->mSourceIdentifierRoutes.end())
+        {
+            if (tRouteIt->second == pMediaSourceNet)
+                tDemultiplexer->mSourceIdentifierRoutes.erase(tRouteIt++);
+            else
+                tRouteIt++;
+        }
+        tUnused = tDemultiplexer->mMediaSourceNets.empty();
+        tDemultiplexer->mMediaSourceNetsMutex.unlock();
+
+        // the last source is gone: stop receiving from the shared socket
+        if (tUnused)
+        {
+            tDemultiplexer->StopDemultiplexer();
+            sDemultiplexers.erase(pDataSocket);
+            delete tDemultiplexer;
+        }
+    }
+
+    sDemultiplexersMutex.unlock();
+}
+
+void NetworkDemultiplexer::StartDemultiplexer()
+{
+    if (!IsRunning())
+    {
+        LOG(LOG_VERBOSE, "Starting demultiplexer for shared port %u", mDataSocket->GetLocalPort());
+
+        StartThread();
+
+        int tLoops = 0;
+
+        // wait until thread is running
+        while ((!IsRunning() /* wait until thread is started */) || (!mDemultiplexerNeeded /* wait until thread has finished the init. process */))
+        {
+            if (tLoops % 10 == 0)
+                LOG(LOG_VERBOSE, "Waiting for start of demultiplexer thread, loop count: %d", ++tLoops);
+            Thread::Suspend(25 * 1000);
+        }
+
+        SVC_MEDIA_LOOPBACK.RegisterReceiver(mDataSocket, this);
+    }
+}
+
+void NetworkDemultiplexer::StopDemultiplexer()
+{
+    int tSignalingRound = 0;
+
+    LOG(LOG_VERBOSE, "Stopping demultiplexer for shared port %u", mDataSocket->GetLocalPort());
+
+    // tell demultiplexer thread: it isn't needed anymore
+    mDemultiplexerNeeded = false;
+
+    // returns after a running loopback delivery finished
+    SVC_MEDIA_LOOPBACK.UnregisterReceiver(mDataSocket, this);
+
+    if (IsRunning())
+    {
+        mDataSocket->StopReceiving();
+
+        // wait for termination of demultiplexer thread
+        while(IsRunning())
+        {
+            if(tSignalingRound > 0)
+                LOG(LOG_WARN, "Signaling attempt %d to stop demultiplexer", tSignalingRound);
+            tSignalingRound++;
+
+            Suspend(25 * 1000);
+        }
+    }
+}
+
+MediaSourceNet* NetworkDemultiplexer::RoutePacket(char *pData, int pSize)
+{
+    MediaSourceNet *tResult = NULL;
+    SourceIdentifierRoutes::iterator tRouteIt;
+    MediaSourceNets::iterator tIt;
+
+    // we need at least a complete RTP header of version 2
+    if ((pSize < (int)RTP_HEADER_SIZE) || ((pData[0] & 0xC0) != 0x80))
+        return NULL;
+
+    unsigned int tPayloadType = (unsigned char)pData[1] & 0x7F;
+    //HINT: RTCP packets carry the synchronization source of their sender directly behind the common header
+    unsigned char *tSourceIdentifierData = (unsigned char*)pData + (IS_RTCP_TYPE(tPayloadType) ? 4 : 8);
+    unsigned int tSourceIdentifier = (tSourceIdentifierData[0] << 24) | (tSourceIdentifierData[1] << 16) | (tSourceIdentifierData[2] << 8) | tSourceIdentifierData[3];
+
+    tRouteIt = mSourceIdentifierRoutes.find(tSourceIdentifier);
+    if (tRouteIt != mSourceIdentifierRoutes.end())
+        return tRouteIt->second;
+
+    // RTCP from an unknown sender can't be assigned
+    if (IS_RTCP_TYPE(tPayloadType))
+        return NULL;
+
+    // assign the new synchronization source by the payload type which was negotiated via SDP
+    for (tIt = mMediaSourceNets.begin(); tIt != mMediaSourceNets.end(); tIt++)
+    {
+        if ((*tIt)->mNegotiatedPayloadId == (int)tPayloadType)
+        {
+            LOG(LOG_VERBOSE, "Routing synchronization source 0x%x with negotiated payload type %u to %s source", tSourceIdentifier, tPayloadType, (*tIt)->GetMediaTypeStr().c_str());
+            mSourceIdentifierRoutes[tSourceIdentifier] = *tIt;
+            return *tIt;
+        }
+    }
+
+    // fall back to our preferred payload types
+    enum AVMediaType tMediaType = RTP::GetMediaTypeFromPreferedPayloadID(tPayloadType);
+    for (tIt = mMediaSourceNets.begin(); tIt != mMediaSourceNets.end(); tIt++)
+    {
+        if (((tMediaType == AVMEDIA_TYPE_VIDEO) && ((*tIt)->GetMediaType() == MEDIA_VIDEO)) ||
+            ((tMediaType == AVMEDIA_TYPE_AUDIO) && ((*tIt)->GetMediaType() == MEDIA_AUDIO)))
+        {
+            LOG(LOG_VERBOSE, "Routing synchronization source 0x%x with payload type %u(%s) to %s source", tSourceIdentifier, tPayloadType, RTP::GetCodecFromPreferedPayloadID(tPayloadType).c_str(), (*tIt)->GetMediaTypeStr().c_str());
+            mSourceIdentifierRoutes[tSourceIdentifier] = *tIt;
+            tResult = *tIt;
+            break;
+        }
+    }
+
+    return tResult;
+}
+
+bool NetworkDemultiplexer::ReceiveLoopbackPacket(char *pData, int pSize)
+{
+    MediaSourceNet *tMediaSourceNet;
+
+    // an impaired socket has to see the packet
+    if (mDataSocket->GetImpairment(IMPAIRMENT_DIRECTION_RECEIVE) != NULL)
+        return false;
+
+    if (!mDemultiplexerNeeded)
+        return true;
+
+    mLoopbackPackets++;
+    mPacketNumber++;
+
+    mMediaSourceNetsMutex.lock();
+    tMediaSourceNet = RoutePacket(pData, pSize);
+    if (tMediaSourceNet != NULL)
+    {
+        #ifdef MSN_DEBUG_PACKETS
+            LOG(LOG_VERBOSE, "Routing loopback packet number %5"PRId64" with size %5d to %s source", mPacketNumber, pSize, tMediaSourceNet->GetMediaTypeStr().c_str());
+        #endif
+        if (!tMediaSourceNet->mGrabbingStopped)
+            tMediaSourceNet->WriteFragment(pData, pSize, mPacketNumber);
+    }else
+        mUnroutablePackets++;
+    mMediaSourceNetsMutex.unlock();
+
+    return true;
+}
+
+void* NetworkDemultiplexer::Run(void* pArgs)
+{
+    char                *tPacketBuffer = NULL;
+    string              tSourceHost = "";
+    unsigned int        tSourcePort = 0;
+    ssize_t             tDataSize;
+    MediaSourceNet      *tMediaSourceNet;
+
+    LOG(LOG_WARN, "Shared Socket-Listener for port %u started", mDataSocket->GetLocalPort());
+    SVC_PROCESS_STATISTIC.AssignThreadName("Shared-InputListener(NET," + toString(mDataSocket->GetLocalPort()) + ")");
+
+    tPacketBuffer = (char*)malloc(MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE);
+
+    // set marker to "active"
+    mDemultiplexerNeeded = true;
+
+    while (mDemultiplexerNeeded)
+    {
+        //####################################################################
+        // receive packet from network socket
+        // ###################################################################
+        tDataSize = MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE;
+        tSourceHost = "";
+        if (!mDataSocket->Receive(tSourceHost, tSourcePort, (void*)tPacketBuffer, tDataSize))
+        {// error occurred
+            if (mReceiveErrors == MEDIA_SOURCE_NET_MAX_RECEIVE_ERRORS)
+            {
+                LOG(LOG_ERROR, "Maximum number of continuous receive errors(%d) is exceeded, will stop demultiplexer", MEDIA_SOURCE_NET_MAX_RECEIVE_ERRORS);
+                break;
+            }else
+                mReceiveErrors++;
+        }else
+            mReceiveErrors = 0;
+
+        // stop loop if demultiplexer isn't needed anymore
+        if (!mDemultiplexerNeeded)
+            break;
+
+        if ((tDataSize > 0) && (tSourceHost != "") && (tSourcePort != 0))
+        {
+            mPacketNumber++;
+
+            mMediaSourceNetsMutex.lock();
+            tMediaSourceNet = RoutePacket(tPacketBuffer, (int)tDataSize);
+            if (tMediaSourceNet != NULL)
+            {
+                #ifdef MSN_DEBUG_PACKETS
+                    LOG(LOG_VERBOSE, "Routing packet number %5"PRId64" with size %5d from %s:%u to %s source", mPacketNumber, (int)tDataSize, tSourceHost.c_str(), tSourcePort, tMediaSourceNet->GetMediaTypeStr().c_str());
+                #endif
+                if (!tMediaSourceNet->mGrabbingStopped)
+                {
+                    // losses inside the receiving host
+                    tMediaSourceNet->SetReceiveQueueDropCount(mDataSocket->GetReceiveQueueDropCount());
+                    tMediaSourceNet->WriteFragment(tPacketBuffer, (int)tDataSize, mPacketNumber);
+                }
+            }else
+            {
+                mUnroutablePackets++;
+                #ifdef MSN_DEBUG_PACKETS
+                    LOG(LOG_VERBOSE, "Dropping unroutable packet number %5"PRId64" with size %5d from %s:%u", mPacketNumber, (int)tDataSize, tSourceHost.c_str(), tSourcePort);
+                #endif
+            }
+            mMediaSourceNetsMutex.unlock();
+        }
+    }
+
+    LOG(LOG_VERBOSE, "Shared Socket-Listener for port %u finished", mDataSocket->GetLocalPort());
+
+    free(tPacketBuffer);
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void NetworkListener::Init(Socket *pDataSocket, unsigned int pLocalPort, bool pRtpActivated)
 {
     mRtpActivated = pRtpActivated;
     mPacketNumber = 0;
+    mLoopbackPackets = 0;
     mPeerHost = "";
     mPeerPort = 0;
     mReceiveErrors = 0;
@@ -120,6 +480,9 @@ void NetworkListener::Init(Socket *pDataSocket, unsigned int pLocalPort, bool pR
         if (mDataSocket->GetTransportType() == SOCKET_UDP_LITE)
             mDataSocket->UDPLiteSetCheckLength(UDP_LITE_HEADER_SIZE + RTP_HEADER_SIZE);
 
+        // large receive buffer for bursts of key frame packets, count buffer overflows
+        mDataSocket->SetTuning(SOCKET_TUNING_PROFILE_MEDIA_RX);
+
         if (mDataSocket->GetTransportType() == SOCKET_TCP)
         {
             mStreamedTransport = true;
@@ -149,12 +512,18 @@ void NetworkListener::Init(Socket *pDataSocket, unsigned int pLocalPort, bool pR
     mMediaSourceNet->AssignStreamName(mMediaSourceNet->mCurrentDeviceName);
 }
 
-NetworkListener::NetworkListener(MediaSourceNet *pMediaSourceNet, Socket *pDataSocket, bool pRtpActivated)
+NetworkListener::NetworkListener(MediaSourceNet *pMediaSourceNet, Socket *pDataSocket, bool pRtpActivated, Socket *pBundleSocket)
 {
     mMediaSourceNet = pMediaSourceNet;
     LOG(LOG_VERBOSE, "Created with pre-defined socket object");
     mListenerSocketCreatedOutside = true;
     mStreamedTransport = (pDataSocket->GetTransportType() == SOCKET_TCP);
+    //HINT: a bundle socket is only supported for datagram based transport
+    mBundleSocket = (!mStreamedTransport) ? pBundleSocket : NULL;
+    if ((pBundleSocket != NULL) && (mBundleSocket == NULL))
+        LOG(LOG_WARN, "Streamed transport can't be bundled, using a dedicated listener");
+    //HINT: the bundle socket itself is received by the demultiplexer only, a source at another socket additionally gets its packets from the bundle
+    mListenerSocketShared = (mBundleSocket == pDataSocket);
 
     mNAPIUsed = false;
 
@@ -169,6 +538,8 @@ NetworkListener::NetworkListener(MediaSourceNet *pMediaSourceNet, unsigned int p
         LOG(LOG_ERROR, "Given port number is invalid");
 
     mListenerSocketCreatedOutside = false;
+    mListenerSocketShared = false;
+    mBundleSocket = NULL;
     mStreamedTransport = (pTransportType == SOCKET_TCP);
 
     mNAPIUsed = false;
@@ -183,6 +554,8 @@ NetworkListener::NetworkListener(MediaSourceNet *pMediaSourceNet, string pLocalN
     mMediaSourceNet = pMediaSourceNet;
     LOG(LOG_VERBOSE, "Created, using NAPI");
     mListenerSocketCreatedOutside = false;
+    mListenerSocketShared = false;
+    mBundleSocket = NULL;
     mNAPIBinding = NULL;
 
     unsigned int tLocalPort = 0;
@@ -252,7 +625,15 @@ void NetworkListener::StartListener()
         mMediaSourceNet->mDecoderFragmentFifo->ClearFifo();
     }
 
-    if (!IsRunning())
+    if (mListenerSocketShared)
+    {
+        // update category for packet statistics
+        mMediaSourceNet->ClassifyStream(mMediaSourceNet->GetDataType(), mDataSocket->GetTransportType(), mDataSocket->GetNetworkType());
+
+        // the receiver of the shared socket delivers our packets
+        NetworkDemultiplexer::Attach(mDataSocket, mMediaSourceNet);
+        mListenerNeeded = true;
+    }else if (!IsRunning())
     {
         // start decoder main loop
         StartThread();
@@ -266,6 +647,15 @@ void NetworkListener::StartListener()
                 LOG(LOG_VERBOSE, "Waiting for start of %s network listener thread, loop count: %d", mMediaSourceNet->GetMediaTypeStr().c_str(), ++tLoops);
             Thread::Suspend(25 * 1000);
         }
+
+        // senders in this process can bypass the network stack
+        if ((!mNAPIUsed) && (mDataSocket != NULL) && (!mStreamedTransport))
+            SVC_MEDIA_LOOPBACK.RegisterReceiver(mDataSocket, this);
+
+        // a remote side which accepts the bundle sends our packets to the bundle socket instead
+        //HINT: only one of both paths carries the medium at a time
+        if (mBundleSocket != NULL)
+            NetworkDemultiplexer::Attach(mBundleSocket, mMediaSourceNet);
     }
 }
 
@@ -278,8 +668,22 @@ void NetworkListener::StopListener()
     // tell network listener thread: it isn't needed anymore
     mListenerNeeded = false;
 
-    if(IsRunning())
+    if (mListenerSocketShared)
+    {
+        LOG(LOG_VERBOSE, "  ..detaching from shared socket");
+        NetworkDemultiplexer::Detach(mDataSocket, mMediaSourceNet);
+    }else if(IsRunning())
     {
+        if (mBundleSocket != NULL)
+        {
+            LOG(LOG_VERBOSE, "  ..detaching from bundle socket");
+            NetworkDemultiplexer::Detach(mBundleSocket, mMediaSourceNet);
+        }
+
+        // returns after a running loopback delivery finished
+        if ((!mNAPIUsed) && (mDataSocket != NULL))
+            SVC_MEDIA_LOOPBACK.UnregisterReceiver(mDataSocket, this);
+
         if (mNAPIUsed)
         {
             LOG(LOG_VERBOSE, "  ..canceling NAPI");
@@ -410,13 +814,31 @@ string NetworkListener::GetCurrentDevicePeerName()
     }
 }
 
+bool NetworkListener::ReceiveLoopbackPacket(char *pData, int pSize)
+{
+    // an impaired socket has to see the packet
+    if (mDataSocket->GetImpairment(IMPAIRMENT_DIRECTION_RECEIVE) != NULL)
+        return false;
+
+    if ((!mListenerNeeded) || (mMediaSourceNet->mGrabbingStopped))
+        return true;
+
+    mLoopbackPackets++;
+    mPacketNumber++;
+    #ifdef MSN_DEBUG_PACKETS
+        LOG(LOG_VERBOSE, "Received loopback packet number %5"PRId64" at %p with size: %5d", mPacketNumber, pData, pSize);
+    #endif
+    mMediaSourceNet->WriteFragment(pData, pSize, mPacketNumber);
+
+    return true;
+}
+
 void* NetworkListener::Run(void* pArgs)
 {
     char                *tPacketBuffer = NULL;
     string              tSourceHost = "";
     unsigned int        tSourcePort = 0;
     int                 tDataSize;
-    int64_t             tReceivedPackets = 0;
 
     LOG(LOG_WARN, "%s Socket-Listener for port %u started", mMediaSourceNet->GetMediaTypeStr().c_str(), GetListenerPort());
     mListenerStopped = false;
@@ -492,7 +914,10 @@ void* NetworkListener::Run(void* pArgs)
         }else
         {// everything is okay
             mReceiveErrors = 0;
-            tReceivedPackets++;
+            mPacketNumber++;
+            // losses inside the receiving host
+            if (mDataSocket != NULL)
+                mMediaSourceNet->SetReceiveQueueDropCount(mDataSocket->GetReceiveQueueDropCount());
         }
 
         // stop loop if listener isn't needed anymore
@@ -532,7 +957,7 @@ void* NetworkListener::Run(void* pArgs)
             }
 
             #ifdef MSN_DEBUG_PACKETS
-                LOG(LOG_VERBOSE, "Received packet number %5d at %p with size: %5d from %s:%u", (int)++mPacketNumber, tPacketBuffer, (int)tDataSize, tSourceHost.c_str(), tSourcePort);
+                LOG(LOG_VERBOSE, "Received packet number %5"PRId64" at %p with size: %5d from %s:%u", mPacketNumber, tPacketBuffer, (int)tDataSize, tSourceHost.c_str(), tSourcePort);
             #endif
 
             // for TCP-like transport we have to use a special fragment header!
@@ -564,13 +989,13 @@ void* NetworkListener::Run(void* pArgs)
                     //       -> picture errors occur if the video quality is high enough and causes a high data rate
                     tData += TCP_FRAGMENT_HEADER_SIZE;
                     tDataSize -= TCP_FRAGMENT_HEADER_SIZE;
-                    mMediaSourceNet->WriteFragment(tData, (int)tHeader->FragmentSize, tReceivedPackets);
+                    mMediaSourceNet->WriteFragment(tData, (int)tHeader->FragmentSize, mPacketNumber);
                     tData += tHeader->FragmentSize;
                     tDataSize -= tHeader->FragmentSize;
                 }
             }else
             {// UDP transport
-                mMediaSourceNet->WriteFragment(tPacketBuffer, (int)tDataSize, tReceivedPackets);
+                mMediaSourceNet->WriteFragment(tPacketBuffer, (int)tDataSize, mPacketNumber);
             }
         }else
         {
@@ -606,14 +1031,15 @@ void MediaSourceNet::Init()
     mOpenInputStream = false;
 
     mSourceCodecId = AV_CODEC_ID_NONE;
+    mNegotiatedPayloadId = -1;
 }
 
-MediaSourceNet::MediaSourceNet(Socket *pDataSocket):
+MediaSourceNet::MediaSourceNet(Socket *pDataSocket, Socket *pBundleSocket):
     MediaSourceMem("NET-IN:")
 {
-    LOG(LOG_VERBOSE, "Created with pre-defined socket object");
+    LOG(LOG_VERBOSE, "Created with pre-defined %s socket object", (pBundleSocket == pDataSocket) ? "bundle" : "dedicated");
 
-    mNetworkListener = new NetworkListener(this, pDataSocket);
+    mNetworkListener = new NetworkListener(this, pDataSocket, true, pBundleSocket);
 
     Init();
 }
@@ -677,6 +1103,12 @@ unsigned int MediaSourceNet::GetListenerPort()
         return 0;
 }
 
+void MediaSourceNet::SetNegotiatedPayloadId(unsigned int pPayloadId)
+{
+    LOG(LOG_VERBOSE, "Setting negotiated %s payload type to %u", GetMediaTypeStr().c_str(), pPayloadId);
+    mNegotiatedPayloadId = (int)pPayloadId;
+}
+
 bool MediaSourceNet::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
 {
     LOG(LOG_VERBOSE, "Trying to open the video source");
@@ -0,0 +1,517 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a shared memory based media source
+ * Since:   2014-02-08
+ */
+
+#include <MediaSourceShm.h>
+#include <MediaSinkShm.h>
+#include <ProcessStatisticService.h>
+#include <HBThread.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <string>
+#include <stdlib.h>
+
+namespace Homer { namespace Multimedia {
+
+using namespace std;
+using namespace Homer::Monitor;
+using namespace Homer::Base;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// how long do we wait for the producer to describe its stream?
+#define MEDIA_SOURCE_SHM_DESCRIPTION_TIMEOUT                    5000 // ms
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Feeds the encoded packets from the ring into the fragment FIFO of the source.
+ */
+class ShmListener :
+    public Thread
+{
+public:
+    ShmListener(MediaSourceShm *pMediaSourceShm);
+
+    virtual ~ShmListener();
+
+    void StartListener();
+    void StopListener();
+
+private:
+    virtual void* Run(void* pArgs = NULL);
+
+    MediaSourceShm      *mMediaSourceShm;
+    bool                mListenerNeeded;
+};
+
+ShmListener::ShmListener(MediaSourceShm *pMediaSourceShm)
+{
+    mMediaSourceShm = pMediaSourceShm;
+    mListenerNeeded = false;
+}
+
+ShmListener::~ShmListener()
+{
+}
+
+void ShmListener::StartListener()
+{
+    if (IsRunning())
+        return;
+
+    LOG(LOG_VERBOSE, "Starting %s shared memory listener for ring %s", mMediaSourceShm->GetMediaTypeStr().c_str(), mMediaSourceShm->mRing.GetName().c_str());
+
+    StartThread();
+
+    int tLoops = 0;
+
+    // wait until thread is running
+    while ((!IsRunning() /* wait until thread is started */) || (!mListenerNeeded /* wait until thread has finished the init. process */))
+    {
+        if (tLoops % 10 == 0)
+            LOG(LOG_VERBOSE, "Waiting for start of %s shared memory listener thread, loop count: %d", mMediaSourceShm->GetMediaTypeStr().c_str(), ++tLoops);
+        Thread::Suspend(25 * 1000);
+    }
+}
+
+void ShmListener::StopListener()
+{
+    int tSignalingRound = 0;
+
+    LOG(LOG_VERBOSE, "Stopping %s shared memory listener", mMediaSourceShm->GetMediaTypeStr().c_str());
+
+    // tell listener thread: it isn't needed anymore
+    mListenerNeeded = false;
+
+    // wait for termination of listener thread
+    while(IsRunning())
+    {
+        if(tSignalingRound > 0)
+            LOG(LOG_WARN, "Signaling attempt %d to stop %s shared memory listener", tSignalingRound, mMediaSourceShm->GetMediaTypeStr().c_str());
+        tSignalingRound++;
+
+        mMediaSourceShm->mRing.Interrupt();
+
+        Suspend(25 * 1000);
+    }
+}
+
+void* ShmListener::Run(void* pArgs)
+{
+    MediaShmRing        *tRing = &mMediaSourceShm->mRing;
+    char                *tPacketBuffer = NULL;
+    int                 tPacketBufferSize = tRing->GetSlotSize();
+    int64_t             tReceivedPackets = 0;
+    int64_t             tTimestamp;
+    int                 tFlags;
+    int                 tDataSize;
+    bool                tRtpPackets = (tRing->GetHeader()->Content == MEDIA_SHM_CONTENT_RTP_PACKETS);
+
+    SVC_PROCESS_STATISTIC.AssignThreadName(mMediaSourceShm->GetMediaTypeStr() + "-InputListener(SHM," + mMediaSourceShm->GetGuiNameFromCodecID(mMediaSourceShm->GetSourceCodec()) + ")");
+
+    tPacketBuffer = (char*)malloc(tPacketBufferSize);
+
+    // set marker to "active"
+    mListenerNeeded = true;
+
+    while ((mListenerNeeded) && (!mMediaSourceShm->mGrabbingStopped))
+    {
+        tDataSize = tRing->Read(tPacketBuffer, tPacketBufferSize, tTimestamp, tFlags, MEDIA_SOURCE_SHM_READ_TIMEOUT);
+
+        // stop loop if listener isn't needed anymore
+        if (!mListenerNeeded)
+            break;
+
+        if (tDataSize < 0)
+        {
+            if (!tRing->IsProducerAlive())
+            {
+                LOG(LOG_WARN, "Producer of ring %s is gone, stopping %s shared memory listener", tRing->GetName().c_str(), mMediaSourceShm->GetMediaTypeStr().c_str());
+
+                // add a zero byte packet to enable early decoder termination
+                mMediaSourceShm->WriteFragment(tPacketBuffer, 0, 0);
+                break;
+            }
+            continue;
+        }
+
+        tReceivedPackets++;
+
+        // losses inside the receiving host
+        mMediaSourceShm->SetReceiveQueueDropCount((uint64_t)tRing->GetLostSlotCount());
+
+        #ifdef MSSHM_DEBUG_PACKETS
+            LOG(LOG_VERBOSE, "Received packet number %5"PRId64" with size %5d from ring %s", tReceivedPackets, tDataSize, tRing->GetName().c_str());
+        #endif
+
+        if (tRtpPackets)
+        {// one RTP packet per fragment
+            mMediaSourceShm->WriteFragment(tPacketBuffer, tDataSize, tReceivedPackets);
+        }else
+        {// the decoder reads a byte stream, big packets are split into several fragments
+            for (int tOffset = 0; tOffset < tDataSize; tOffset += MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE)
+            {
+                int tFragmentSize = ((tDataSize - tOffset) < MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE) ? (tDataSize - tOffset) : MEDIA_SOURCE_MEM_FRAGMENT_BUFFER_SIZE;
+                mMediaSourceShm->WriteFragment(tPacketBuffer + tOffset, tFragmentSize, tReceivedPackets);
+            }
+        }
+    }
+
+    LOG(LOG_VERBOSE, "%s shared memory listener for ring %s finished", mMediaSourceShm->GetMediaTypeStr().c_str(), tRing->GetName().c_str());
+
+    free(tPacketBuffer);
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+MediaSourceShm::MediaSourceShm(string pName):
+    MediaSourceMem("SHM-IN:")
+{
+    mSourceType = SOURCE_MEMORY;
+    mRingName = pName;
+    mRawFrames = false;
+    mCurrentDeviceName = "SHM-IN: " + MediaSinkShm::CreateId(pName);
+    mShmListener = new ShmListener(this);
+    AssignStreamName(mCurrentDeviceName);
+}
+
+MediaSourceShm::~MediaSourceShm()
+{
+    LOG(LOG_VERBOSE, "Going to destroy shared memory based media source");
+
+    StopGrabbing();
+
+    if (mMediaSourceOpened)
+        CloseGrabDevice();
+
+    delete mShmListener;
+
+    mRing.Close();
+
+    LOG(LOG_VERBOSE, "Destroyed");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MediaSourceShm::AttachRing(enum MediaType pMediaType)
+{
+    if (!mRing.IsOpen())
+    {
+        if (!mRing.Attach(mRingName))
+            return false;
+    }
+
+    // the producer describes its stream with the first written data
+    int64_t tStartTime = Time::GetTimeStamp();
+    while ((mRing.GetHeader()->Content == MEDIA_SHM_CONTENT_UNKNOWN) && (mRing.IsProducerAlive()))
+    {
+        if (Time::GetTimeStamp() - tStartTime > MEDIA_SOURCE_SHM_DESCRIPTION_TIMEOUT * 1000)
+        {
+            LOG(LOG_ERROR, "Producer of ring %s hasn't described its stream within %d ms", mRing.GetName().c_str(), MEDIA_SOURCE_SHM_DESCRIPTION_TIMEOUT);
+            mRing.Close();
+            return false;
+        }
+        Thread::Suspend(25 * 1000);
+    }
+
+    const MediaShmRingHeader *tHeader = mRing.GetHeader();
+    if (tHeader->MediaType != pMediaType)
+    {
+        LOG(LOG_ERROR, "Ring %s contains no %s stream", mRing.GetName().c_str(), GetMediaTypeStr().c_str());
+        mRing.Close();
+        return false;
+    }
+
+    mRawFrames = (tHeader->Content == MEDIA_SHM_CONTENT_FRAMES);
+    if (!mRawFrames)
+    {
+        mSourceCodecId = (enum AVCodecID)tHeader->CodecId;
+        mRtpSourceCodecIdHint = mSourceCodecId;
+        mRtpActivated = (tHeader->Content == MEDIA_SHM_CONTENT_RTP_PACKETS);
+    }
+
+    LOG(LOG_VERBOSE, "Ring %s delivers %s %s with codec %d", mRing.GetName().c_str(), GetMediaTypeStr().c_str(), mRawFrames ? "raw frames" : (mRtpActivated ? "RTP packets" : "packets"), tHeader->CodecId);
+
+    return true;
+}
+
+bool MediaSourceShm::OpenRawFrames(int pResX, int pResY, float pFps, int pSampleRate, int pChannels)
+{
+    const MediaShmRingHeader *tHeader = mRing.GetHeader();
+
+    switch(mMediaType)
+    {
+        case MEDIA_VIDEO:
+            mSourceResX = tHeader->ResX;
+            mSourceResY = tHeader->ResY;
+            mTargetResX = pResX;
+            mTargetResY = pResY;
+            mInputFrameRate = pFps;
+            mOutputFrameRate = pFps;
+            SVC_PROCESS_STATISTIC.AssignThreadName("Video-Grabber(SHM)");
+            ClassifyStream(DATA_TYPE_VIDEO, SOCKET_RAW);
+            break;
+        case MEDIA_AUDIO:
+            // raw audio isn't resampled, the consumer gets the format of the producer
+            if ((tHeader->SampleRate != pSampleRate) || (tHeader->Channels != pChannels))
+                LOG(LOG_WARN, "Ring %s delivers audio with %d Hz and %d channels instead of %d Hz and %d channels", mRing.GetName().c_str(), tHeader->SampleRate, tHeader->Channels, pSampleRate, pChannels);
+            mInputAudioSampleRate = tHeader->SampleRate;
+            mInputAudioChannels = tHeader->Channels;
+            mOutputAudioSampleRate = tHeader->SampleRate;
+            mOutputAudioChannels = tHeader->Channels;
+            mOutputAudioFormat = AV_SAMPLE_FMT_S16;
+            SVC_PROCESS_STATISTIC.AssignThreadName("Audio-Grabber(SHM)");
+            ClassifyStream(DATA_TYPE_AUDIO, SOCKET_RAW);
+            break;
+        default:
+            LOG(LOG_ERROR, "Media type unknown");
+            return false;
+    }
+
+    MarkOpenGrabDeviceSuccessful();
+
+    return true;
+}
+
+bool MediaSourceShm::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
+{
+    bool tResult = false;
+
+    LOG(LOG_VERBOSE, "Trying to open the video source");
+
+    // setting this explicitly, otherwise the Run-method won't assign the thread name correctly
+    mMediaType = MEDIA_VIDEO;
+
+    mRingMutex.lock();
+
+    if (AttachRing(MEDIA_VIDEO))
+    {
+        if (mRawFrames)
+            tResult = OpenRawFrames(pResX, pResY, pFps, 0, 0);
+        else
+        {
+            // start ring listener
+            mShmListener->StartListener();
+
+            tResult = MediaSourceMem::OpenVideoGrabDevice(pResX, pResY, pFps);
+        }
+    }
+
+    mRingMutex.unlock();
+
+    if (tResult)
+        mCurrentDeviceName = "SHM-IN: " + MediaSinkShm::CreateId(mRingName);
+
+    return tResult;
+}
+
+bool MediaSourceShm::OpenAudioGrabDevice(int pSampleRate, int pChannels)
+{
+    bool tResult = false;
+
+    LOG(LOG_VERBOSE, "Trying to open the audio source");
+
+    // setting this explicitly, otherwise the Run-method won't assign the thread name correctly
+    mMediaType = MEDIA_AUDIO;
+
+    mRingMutex.lock();
+
+    if (AttachRing(MEDIA_AUDIO))
+    {
+        if (mRawFrames)
+            tResult = OpenRawFrames(0, 0, 0, pSampleRate, pChannels);
+        else
+        {
+            // start ring listener
+            mShmListener->StartListener();
+
+            tResult = MediaSourceMem::OpenAudioGrabDevice(pSampleRate, pChannels);
+        }
+    }
+
+    mRingMutex.unlock();
+
+    if (tResult)
+        mCurrentDeviceName = "SHM-IN: " + MediaSinkShm::CreateId(mRingName);
+
+    return tResult;
+}
+
+bool MediaSourceShm::CloseGrabDevice()
+{
+    bool tResult = false;
+
+    LOG(LOG_VERBOSE, "Going to close %s stream from shared memory", GetMediaTypeStr().c_str());
+
+    mRingMutex.lock();
+
+    mShmListener->StopListener();
+
+    if (mRawFrames)
+    {
+        if (mMediaSourceOpened)
+        {
+            mMediaSourceOpened = false;
+            tResult = true;
+        }
+        mGrabbingStopped = false;
+        ResetPacketStatistic();
+        mRawFrames = false;
+    }else
+        tResult = MediaSourceMem::CloseGrabDevice();
+
+    mRing.Close();
+
+    mRingMutex.unlock();
+
+    LOG(LOG_VERBOSE, "...%s stream from shared memory closed", GetMediaTypeStr().c_str());
+
+    return tResult;
+}
+
+void MediaSourceShm::StopGrabbing()
+{
+    if (!mRawFrames)
+    {
+        MediaSourceMem::StopGrabbing();
+        return;
+    }
+
+    LOG(LOG_VERBOSE, "Stopping grabber");
+
+    MediaSource::StopGrabbing();
+
+    // a grabbing thread might wait for the next raw frame
+    do{
+        mRing.Interrupt();
+    }while(!mGrabMutex.lock(250));
+
+    mGrabMutex.unlock();
+
+    LOG(LOG_VERBOSE, "Shared memory based %s source successfully stopped", GetMediaTypeStr().c_str());
+}
+
+int MediaSourceShm::GetChunkDropCounter()
+{
+    if (mRawFrames)
+        return (int)mRing.GetLostSlotCount();
+    else
+        return MediaSourceMem::GetChunkDropCounter();
+}
+
+int MediaSourceShm::GrabChunk(void* pChunkBuffer, int& pChunkSize, bool pDropChunk)
+{
+    if (!mRawFrames)
+        return MediaSourceMem::GrabChunk(pChunkBuffer, pChunkSize, pDropChunk);
+
+    if (pChunkBuffer == NULL)
+    {
+        // acknowledge failed"
+        MarkGrabChunkFailed(GetMediaTypeStr() + " grab buffer is NULL");
+
+        return GRAB_RES_INVALID;
+    }
+
+    while (true)
+    {
+        // lock grabbing
+        mGrabMutex.lock();
+
+        if (!mMediaSourceOpened)
+        {
+            // unlock grabbing
+            mGrabMutex.unlock();
+
+            // acknowledge failed"
+            MarkGrabChunkFailed(GetMediaTypeStr() + " source is closed");
+
+            return GRAB_RES_INVALID;
+        }
+
+        if (mGrabbingStopped)
+        {
+            // unlock grabbing
+            mGrabMutex.unlock();
+
+            // acknowledge failed"
+            MarkGrabChunkFailed(GetMediaTypeStr() + " source is paused");
+
+            return GRAB_RES_INVALID;
+        }
+
+        // HINT: the slots of a frame ring are never bigger than a chunk buffer
+        int64_t tTimestamp;
+        int tFlags;
+        int tSize = mRing.Read((char*)pChunkBuffer, mRing.GetSlotSize(), tTimestamp, tFlags, MEDIA_SOURCE_SHM_READ_TIMEOUT);
+        if (tSize >= 0)
+        {
+            const MediaShmRingHeader *tHeader = mRing.GetHeader();
+            if ((mMediaType == MEDIA_VIDEO) && ((tHeader->ResX != mSourceResX) || (tHeader->ResY != mSourceResY)))
+            {
+                LOG(LOG_INFO, "Resolution of ring %s changed from %d*%d to %d*%d", mRing.GetName().c_str(), mSourceResX, mSourceResY, tHeader->ResX, tHeader->ResY);
+                mSourceResX = tHeader->ResX;
+                mSourceResY = tHeader->ResY;
+            }
+
+            pChunkSize = tSize;
+            AnnouncePacket(tSize);
+            mFrameNumber++;
+
+            // unlock grabbing
+            mGrabMutex.unlock();
+
+            // acknowledge success
+            MarkGrabChunkSuccessful(mFrameNumber);
+
+            return mFrameNumber;
+        }
+
+        if (!mRing.IsProducerAlive())
+        {
+            // unlock grabbing
+            mGrabMutex.unlock();
+
+            LOG(LOG_WARN, "%s-Grabber reached EOF because the producer of ring %s is gone", GetMediaTypeStr().c_str(), mRing.GetName().c_str());
+
+            // acknowledge "success"
+            MarkGrabChunkSuccessful(mFrameNumber); // don't panic, it is only EOF
+
+            return GRAB_RES_EOF;
+        }
+
+        // unlock grabbing
+        mGrabMutex.unlock();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
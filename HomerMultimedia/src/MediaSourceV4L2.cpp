@@ -72,213 +72,197 @@ MediaSourceV4L2::~MediaSourceV4L2()
 
 void MediaSourceV4L2::getVideoDevices(VideoDevices &pVList)
 {
-    static bool tFirstCall = true;
-    struct v4l2_capability tV4L2Caps;
-    struct v4l2_input tV4L2Input;
-    struct v4l2_frmivalenum tV4L2FrameIntervals;
-    struct v4l2_frmsizeenum tV4L2FrameSizes;
+    SVC_MEDIA_DEVICE_REGISTRY.GetVideoDevices("video", ProbeVideoDevice, pVList);
+}
 
-    VideoDeviceDescriptor tDevice;
-    string tDeviceFile;
-    FILE *tFile;
-    int tFd;
+static string GetFourCCStr(uint32_t pFourCC)
+{
+    string tResult = "";
 
-    #ifdef MSV_DEBUG_PACKETS
-        tFirstCall = true;
-    #endif
+    for (int i = 0; i < 4; i++)
+    {
+        char tChar = (char)((pFourCC >> (8 * i)) & 0xFF);
+        if (tChar != ' ')
+            tResult += tChar;
+    }
+
+    return tResult;
+}
 
-    if (tFirstCall)
-        LOG(LOG_VERBOSE, "Enumerating hardware..");
+static void ProbeFrameRates(int pFd, uint32_t pPixelFormat, int pResX, int pResY, VideoDeviceCapability &pCapability)
+{
+    struct v4l2_frmivalenum tV4L2FrameIntervals;
 
-    for (int tDeviceId = 0; tDeviceId < 10; tDeviceId++)
+    for (int tIndex = 0; ; tIndex++)
     {
-        tDeviceFile = "/dev/video";
-        tDeviceFile += char(tDeviceId + 48);
-        if ((tFd = open(tDeviceFile.c_str(), O_RDONLY)) >= 0)
+        memset(&tV4L2FrameIntervals, 0, sizeof(tV4L2FrameIntervals));
+        tV4L2FrameIntervals.index = tIndex;
+        tV4L2FrameIntervals.pixel_format = pPixelFormat;
+        tV4L2FrameIntervals.width = pResX;
+        tV4L2FrameIntervals.height = pResY;
+        if (ioctl(pFd, VIDIOC_ENUM_FRAMEINTERVALS, &tV4L2FrameIntervals) < 0)
+            break;
+
+        switch(tV4L2FrameIntervals.type)
         {
-            string tDeviceIdStr = "";
-            tDeviceIdStr += char(tDeviceId + 48);
-            tDevice.Name = "V4L2 device " + tDeviceIdStr;
-            tDevice.Card = tDeviceFile;
-            tDevice.Desc = "V4L2 based video device " + tDeviceIdStr;
-            tDevice.Type = GeneralVideoDevice;
-
-            if (tFirstCall)
-            {
-                if (tDevice.Name.size())
-                {
-                    LOG(LOG_VERBOSE, "Found video device: %s (device file: %s)", tDevice.Name.c_str(), tDeviceFile.c_str());
-                }
-            }
+            case V4L2_FRMIVAL_TYPE_DISCRETE:
+                if (tV4L2FrameIntervals.discrete.numerator > 0)
+                    pCapability.Fps.push_back((float)tV4L2FrameIntervals.discrete.denominator / tV4L2FrameIntervals.discrete.numerator);
+                break;
+            case V4L2_FRMIVAL_TYPE_CONTINUOUS:
+            case V4L2_FRMIVAL_TYPE_STEPWISE:
+                // the minimum interval gives the maximum frame rate, the steps in between aren't listed
+                if (tV4L2FrameIntervals.stepwise.min.numerator > 0)
+                    pCapability.Fps.push_back((float)tV4L2FrameIntervals.stepwise.min.denominator / tV4L2FrameIntervals.stepwise.min.numerator);
+                if (tV4L2FrameIntervals.stepwise.max.numerator > 0)
+                    pCapability.Fps.push_back((float)tV4L2FrameIntervals.stepwise.max.denominator / tV4L2FrameIntervals.stepwise.max.numerator);
+                return;
+            default:
+                return;
+        }
+    }
+}
 
-            memset(&tV4L2Caps, 0, sizeof(tV4L2Caps));
-            LOG(LOG_VERBOSE, "(trying to query caps for: %s)", tDeviceFile.c_str());
-            if (ioctl(tFd, VIDIOC_QUERYCAP, &tV4L2Caps) < 0)
-                LOG(LOG_ERROR, "Can't get device capabilities for \"%s\" because of \"%s\"", tDeviceFile.c_str(), strerror(errno));
-            else
+static void ProbeCapabilities(int pFd, VideoDeviceCapabilities &pCapabilities)
+{
+    struct v4l2_fmtdesc tV4L2Format;
+    struct v4l2_frmsizeenum tV4L2FrameSizes;
+
+    for (int tFormatIndex = 0; ; tFormatIndex++)
+    {
+        memset(&tV4L2Format, 0, sizeof(tV4L2Format));
+        tV4L2Format.index = tFormatIndex;
+        tV4L2Format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (ioctl(pFd, VIDIOC_ENUM_FMT, &tV4L2Format) < 0)
+            break;
+
+        string tPixelFormat = GetFourCCStr(tV4L2Format.pixelformat);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..pixel format: %s (%s)", tPixelFormat.c_str(), tV4L2Format.description);
+
+        for (int tSizeIndex = 0; ; tSizeIndex++)
+        {
+            memset(&tV4L2FrameSizes, 0, sizeof(tV4L2FrameSizes));
+            tV4L2FrameSizes.index = tSizeIndex;
+            tV4L2FrameSizes.pixel_format = tV4L2Format.pixelformat;
+            if (ioctl(pFd, VIDIOC_ENUM_FRAMESIZES, &tV4L2FrameSizes) < 0)
+                break;
+
+            VideoDeviceCapability tCapability;
+            tCapability.PixelFormat = tPixelFormat;
+            if (tV4L2FrameSizes.type == V4L2_FRMSIZE_TYPE_DISCRETE)
             {
-                tDevice.Name = toString(tV4L2Caps.card) + " [" + tDeviceFile + "]";
-                tDevice.Desc += " \"" + toString(tV4L2Caps.card) + "\"";
-                if (tFirstCall)
-                {
-                    LOG(LOG_VERBOSE, "  ..driver name: %s", tV4L2Caps.driver);
-                    LOG(LOG_VERBOSE, "  ..card name: %s", tV4L2Caps.card);
-                    LOG(LOG_VERBOSE, "  ..connected at: %s", tV4L2Caps.bus_info);
-                    LOG(LOG_VERBOSE, "  ..driver version: %u.%u.%u", (tV4L2Caps.version >> 16) & 0xFF, (tV4L2Caps.version >> 8) & 0xFF, tV4L2Caps.version & 0xFF);
-                    if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_CAPTURE)
-                        LOG(LOG_VERBOSE, "  ..supporting video capture interface");
-                    if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_OUTPUT)
-                        LOG(LOG_VERBOSE, "  ..supporting video output interface");
-                    if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_OVERLAY)
-                        LOG(LOG_VERBOSE, "  ..supporting video overlay interface");
-                    if (tV4L2Caps.capabilities & V4L2_CAP_TUNER)
-                        LOG(LOG_VERBOSE, "  ..onboard tuner");
-                    if (tV4L2Caps.capabilities & V4L2_CAP_AUDIO)
-                        LOG(LOG_VERBOSE, "  ..onboard audio");
-                    if (tV4L2Caps.capabilities & V4L2_CAP_RDS_CAPTURE)
-                        LOG(LOG_VERBOSE, "  ..onboard RDS");
-                    if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_OUTPUT_OVERLAY)
-                        LOG(LOG_VERBOSE, "  ..supporting OnScreenDisplay (OSD)");
-                }
+                tCapability.ResX = tV4L2FrameSizes.discrete.width;
+                tCapability.ResY = tV4L2FrameSizes.discrete.height;
+                tCapability.Discrete = true;
+            }else{
+                tCapability.ResX = tV4L2FrameSizes.stepwise.max_width;
+                tCapability.ResY = tV4L2FrameSizes.stepwise.max_height;
+                tCapability.Discrete = false;
             }
+            ProbeFrameRates(pFd, tV4L2Format.pixelformat, tCapability.ResX, tCapability.ResY, tCapability);
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "    ..%s %d x %d with %d frame rates", tCapability.Discrete ? "resolution" : "resolutions up to", tCapability.ResX, tCapability.ResY, (int)tCapability.Fps.size());
+            pCapabilities.push_back(tCapability);
+
+            // stepwise and continuous frame sizes are described by one entry
+            if (!tCapability.Discrete)
+                break;
+        }
+    }
+}
+
+bool MediaSourceV4L2::ProbeVideoDevice(string pDeviceFile, VideoDeviceDescriptor &pDevice, VideoDeviceCapabilities &pCapabilities)
+{
+    struct v4l2_capability tV4L2Caps;
+    struct v4l2_input tV4L2Input;
+    int tFd;
 
-            int tIndex = 0;
-#if 0
-            for(;;)
+    if ((tFd = open(pDeviceFile.c_str(), O_RDONLY)) < 0)
+        return false;
+
+    string tDeviceIdStr = pDeviceFile.substr(pDeviceFile.rfind("video") + 5);
+    pDevice.Name = "V4L2 device " + tDeviceIdStr;
+    pDevice.Card = pDeviceFile;
+    pDevice.Desc = "V4L2 based video device " + tDeviceIdStr;
+    pDevice.Type = GeneralVideoDevice;
+
+    LOGEX(MediaSourceV4L2, LOG_VERBOSE, "Found video device: %s (device file: %s)", pDevice.Name.c_str(), pDeviceFile.c_str());
+
+    memset(&tV4L2Caps, 0, sizeof(tV4L2Caps));
+    LOGEX(MediaSourceV4L2, LOG_VERBOSE, "(trying to query caps for: %s)", pDeviceFile.c_str());
+    if (ioctl(tFd, VIDIOC_QUERYCAP, &tV4L2Caps) < 0)
+        LOGEX(MediaSourceV4L2, LOG_ERROR, "Can't get device capabilities for \"%s\" because of \"%s\"", pDeviceFile.c_str(), strerror(errno));
+    else
+    {
+        pDevice.Name = toString(tV4L2Caps.card) + " [" + pDeviceFile + "]";
+        pDevice.Desc += " \"" + toString(tV4L2Caps.card) + "\"";
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..driver name: %s", tV4L2Caps.driver);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..card name: %s", tV4L2Caps.card);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..connected at: %s", tV4L2Caps.bus_info);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..driver version: %u.%u.%u", (tV4L2Caps.version >> 16) & 0xFF, (tV4L2Caps.version >> 8) & 0xFF, tV4L2Caps.version & 0xFF);
+        if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_CAPTURE)
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..supporting video capture interface");
+        if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_OUTPUT)
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..supporting video output interface");
+        if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_OVERLAY)
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..supporting video overlay interface");
+        if (tV4L2Caps.capabilities & V4L2_CAP_TUNER)
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..onboard tuner");
+        if (tV4L2Caps.capabilities & V4L2_CAP_AUDIO)
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..onboard audio");
+        if (tV4L2Caps.capabilities & V4L2_CAP_RDS_CAPTURE)
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..onboard RDS");
+        if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_OUTPUT_OVERLAY)
+            LOGEX(MediaSourceV4L2, LOG_VERBOSE, "  ..supporting OnScreenDisplay (OSD)");
+
+        if (tV4L2Caps.capabilities & V4L2_CAP_VIDEO_CAPTURE)
+            ProbeCapabilities(tFd, pCapabilities);
+    }
+
+    for (int tIndex = 0; ; tIndex++)
+    {
+        memset(&tV4L2Input, 0, sizeof(tV4L2Input));
+        tV4L2Input.index = tIndex;
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "(trying to query inputs for: %s)", pDeviceFile.c_str());
+        if (ioctl(tFd, VIDIOC_ENUMINPUT, &tV4L2Input) < 0)
+            break;
+
+        // detect S-Video/Composite
+        if(tV4L2Input.std == 0 /* 0 means: no special TV-standard support -> not an analog video signal */)
+        {
+            switch(tV4L2Input.type)
             {
-                memset(&tV4L2FrameIntervals, 0, sizeof(tV4L2FrameIntervals));
-                tV4L2FrameIntervals.index = tIndex;
-                LOG(LOG_VERBOSE, "(trying to query frame intervals for: %s)", tDeviceFile.c_str());
-                if (ioctl(tFd, VIDIOC_ENUM_FRAMEINTERVALS, &tV4L2FrameIntervals) < 0)
-                    break;
-                else
-                {
-                    if (tFirstCall)
-                    {
-                        LOG(LOG_VERBOSE, "    ..format index: %u", tV4L2FrameIntervals.index);
-                        LOG(LOG_VERBOSE, "      ..pixel format: %u", tV4L2FrameIntervals.pixel_format);
-                        LOG(LOG_VERBOSE, "      ..width: %u", tV4L2FrameIntervals.width);
-                        LOG(LOG_VERBOSE, "      ..height: %u", tV4L2FrameIntervals.height);
-                        switch(tV4L2FrameIntervals.type)
-                        {
-                                case V4L2_FRMIVAL_TYPE_DISCRETE:
-                                    LOG(LOG_VERBOSE, "      ..interval type: DISCRETE");
-                                    LOG(LOG_VERBOSE, "        ..FPS: %u / %u", tV4L2FrameIntervals.discrete.numerator, tV4L2FrameIntervals.discrete.denominator);
-                                    break;
-                                case V4L2_FRMIVAL_TYPE_CONTINUOUS:
-                                    LOG(LOG_VERBOSE, "      ..interval type: CONTINUOUS");
-                                    break;
-                                case V4L2_FRMIVAL_TYPE_STEPWISE:
-                                    LOG(LOG_VERBOSE, "      ..interval type: STEPWISE");
-                                    LOG(LOG_VERBOSE, "        ..max: %u / %u", tV4L2FrameIntervals.stepwise.min.numerator, tV4L2FrameIntervals.stepwise.min.denominator);
-                                    LOG(LOG_VERBOSE, "        ..max: %u / %u", tV4L2FrameIntervals.stepwise.max.numerator, tV4L2FrameIntervals.stepwise.max.denominator);
-                                    LOG(LOG_VERBOSE, "        ..step: %u / %u", tV4L2FrameIntervals.stepwise.step.numerator, tV4L2FrameIntervals.stepwise.step.denominator);
-                                    break;
-                                default:
-                                    LOG(LOG_WARN, "      ..interval type: UNSUPPORTED");
-                        }
-                    }
-                }
-                tIndex++;
+                case V4L2_INPUT_TYPE_TUNER:
+                        pDevice.Type = Tv;
+                        break;
+                case V4L2_INPUT_TYPE_CAMERA:
+                        pDevice.Type = Camera;
+                        break;
             }
+        }else{
+            pDevice.Type = SVideoComp;
+        }
 
-            tIndex = 0;
-            for(;;)
-            {
-                memset(&tV4L2FrameSizes, 0, sizeof(tV4L2FrameSizes));
-                tV4L2FrameIntervals.index = tIndex;
-                tV4L2FrameIntervals.pixel_format = 0;
-                LOG(LOG_VERBOSE, "(trying to query frame sizes for: %s)", tDeviceFile.c_str());
-                if (ioctl(tFd, VIDIOC_ENUM_FRAMESIZES, &tV4L2FrameSizes) < 0)
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "    ..input index: %u", tV4L2Input.index);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input name: %s", tV4L2Input.name);
+        switch(tV4L2Input.type)
+        {
+            case V4L2_INPUT_TYPE_TUNER:
+                    LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input type: tuner");
                     break;
-                else
-                {
-                    if (tFirstCall)
-                    {
-                        LOG(LOG_VERBOSE, "    ..frame size index: %u", tV4L2FrameSizes.index);
-                        LOG(LOG_VERBOSE, "      ..pixel format: %u", tV4L2FrameSizes.pixel_format);
-                        switch(tV4L2FrameSizes.type)
-                        {
-                                case V4L2_FRMIVAL_TYPE_DISCRETE:
-                                    LOG(LOG_VERBOSE, "      ..frame size description: DISCRETE");
-                                    LOG(LOG_VERBOSE, "        ..width: %u", tV4L2FrameSizes.discrete.width);
-                                    LOG(LOG_VERBOSE, "        ..height: %u", tV4L2FrameSizes.discrete.height);
-                                    break;
-                                case V4L2_FRMIVAL_TYPE_CONTINUOUS:
-                                    LOG(LOG_VERBOSE, "      ..frame size description: CONTINUOUS");
-                                    break;
-                                case V4L2_FRMIVAL_TYPE_STEPWISE:
-                                    LOG(LOG_VERBOSE, "      ..frame size description: STEPWISE");
-                                    LOG(LOG_VERBOSE, "        ..width (min.): %u", tV4L2FrameSizes.stepwise.min_width);
-                                    LOG(LOG_VERBOSE, "        ..width (max.): %u", tV4L2FrameSizes.stepwise.max_width);
-                                    LOG(LOG_VERBOSE, "        ..width (step): %u", tV4L2FrameSizes.stepwise.step_width);
-                                    LOG(LOG_VERBOSE, "        ..height (min.): %u", tV4L2FrameSizes.stepwise.min_height);
-                                    LOG(LOG_VERBOSE, "        ..height (max.): %u", tV4L2FrameSizes.stepwise.max_height);
-                                    LOG(LOG_VERBOSE, "        ..height (step): %u", tV4L2FrameSizes.stepwise.step_height);
-                                    break;
-                                default:
-                                    LOG(LOG_WARN, "      ..interval type: UNSUPPORTED");
-                        }
-                    }
-                }
-                tIndex++;
-            }
-#endif
-            tIndex = 0;
-            for(;;)
-            {
-                memset(&tV4L2Input, 0, sizeof(tV4L2Input));
-                tV4L2Input.index = tIndex;
-                LOG(LOG_VERBOSE, "(trying to query inputs for: %s)", tDeviceFile.c_str());
-                if (ioctl(tFd, VIDIOC_ENUMINPUT, &tV4L2Input) < 0)
+            case V4L2_INPUT_TYPE_CAMERA:
+                    LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input type: camera");
                     break;
-                else
-                {
-                    // detect S-Video/Composite
-                    if(tV4L2Input.std == 0 /* 0 means: no special TV-standard support -> not an analog video signal */)
-                    {
-                        switch(tV4L2Input.type)
-                        {
-                            case V4L2_INPUT_TYPE_TUNER:
-                                    tDevice.Type = Tv;
-                                    break;
-                            case V4L2_INPUT_TYPE_CAMERA:
-                                    tDevice.Type = Camera;
-                                    break;
-                        }
-                    }else{
-                        tDevice.Type = SVideoComp;
-                    }
-
-                    if (tFirstCall)
-                    {
-                        LOG(LOG_VERBOSE, "    ..input index: %u", tV4L2Input.index);
-                        LOG(LOG_VERBOSE, "      ..input name: %u", tV4L2Input.name);
-                        switch(tV4L2Input.type)
-                        {
-                            case V4L2_INPUT_TYPE_TUNER:
-                                    LOG(LOG_VERBOSE, "      ..input type: tuner");
-                                    break;
-                            case V4L2_INPUT_TYPE_CAMERA:
-                                    LOG(LOG_VERBOSE, "      ..input type: camera");
-                                    break;
-                        }
-                        LOG(LOG_VERBOSE, "      ..input audio set: %u", tV4L2Input.audioset);
-                        LOG(LOG_VERBOSE, "      ..input tuner: %u", tV4L2Input.tuner);
-                        LOG(LOG_VERBOSE, "      ..input std: 0x%x", tV4L2Input.std);
-                        LOG(LOG_VERBOSE, "      ..input status: 0x%x", tV4L2Input.status);
-                        LOG(LOG_VERBOSE, "      ..input caps.: %u", tV4L2Input.capabilities);
-                    }
-                }
-                tIndex++;
-            }
-
-            close(tFd);
-
-            pVList.push_back(tDevice);
         }
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input audio set: %u", tV4L2Input.audioset);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input tuner: %u", tV4L2Input.tuner);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input std: 0x%x", tV4L2Input.std);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input status: 0x%x", tV4L2Input.status);
+        LOGEX(MediaSourceV4L2, LOG_VERBOSE, "      ..input caps.: %u", tV4L2Input.capabilities);
     }
-    tFirstCall = false;
+
+    close(tFd);
+
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -433,9 +417,13 @@ bool MediaSourceV4L2::OpenVideoGrabDevice(int pResX, int pResY, float pFps)
     {
         LOG(LOG_VERBOSE, "Auto-probing for VFL2 capture device");
         string tDesiredDevice;
-        for (int i = 0; i < 10; i++)
+        VideoDevices tProbeDevs;
+        VideoDevices::iterator tProbeDevIt;
+        // only the device files which are known as video devices are probed
+        getVideoDevices(tProbeDevs);
+        for (tProbeDevIt = tProbeDevs.begin(); tProbeDevIt != tProbeDevs.end(); tProbeDevIt++)
         {
-            tDesiredDevice = "/dev/video" + toString(i);
+            tDesiredDevice = tProbeDevIt->Card;
             tResult = 0;
             if (((tFile = fopen(tDesiredDevice.c_str(), "r")) != NULL) && (fclose(tFile) == 0) && ((tResult = avformat_open_input(&mFormatContext, tDesiredDevice.c_str(), tFormat, &tOptions)) == 0))
             {
@@ -777,6 +765,29 @@ GrabResolutions MediaSourceV4L2::GetSupportedVideoGrabResolutions()
             tFormat.ResX = 1920;
             tFormat.ResY = 1080;
             mSupportedVideoFormats.push_back(tFormat);
+
+            // restrict the list to the frame sizes which were reported by the device
+            VideoDeviceCapabilities tCapabilities;
+            if (SVC_MEDIA_DEVICE_REGISTRY.GetVideoDeviceCapabilities(mCurrentDevice, tCapabilities))
+            {
+                GrabResolutions tReportedFormats;
+                GrabResolutions::iterator tFormatIt;
+                VideoDeviceCapabilities::iterator tCapIt;
+                for (tFormatIt = mSupportedVideoFormats.begin(); tFormatIt != mSupportedVideoFormats.end(); tFormatIt++)
+                {
+                    for (tCapIt = tCapabilities.begin(); tCapIt != tCapabilities.end(); tCapIt++)
+                    {
+                        if (((tCapIt->Discrete) && (tCapIt->ResX == tFormatIt->ResX) && (tCapIt->ResY == tFormatIt->ResY)) ||
+                            ((!tCapIt->Discrete) && (tCapIt->ResX >= tFormatIt->ResX) && (tCapIt->ResY >= tFormatIt->ResY)))
+                        {
+                            tReportedFormats.push_back(*tFormatIt);
+                            break;
+                        }
+                    }
+                }
+                if (tReportedFormats.size() > 0)
+                    mSupportedVideoFormats = tReportedFormats;
+            }
         }
     }
 
@@ -0,0 +1,216 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2011 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+
+/*
+ * Purpose: Implementation of the A/V synchronization of media sources against a master clock
+ * Since:   2014-01-15
+ */
+
+#include <MediaSynchronizer.h>
+#include <MediaSource.h>
+#include <HBTime.h>
+#include <Logger.h>
+
+namespace Homer { namespace Multimedia {
+
+using namespace Homer::Base;
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+MediaSynchronizer::MediaSynchronizer(MediaSource *pMasterSource, string pName)
+{
+    mName = pName;
+    mMasterSource = pMasterSource;
+    mActive = true;
+    mTargetOffset = 0;
+    mLastMasterTimestamp = 0;
+    mTimeLastMasterProgress = 0;
+    mIncompatibleClocks = false;
+    mAdjustmentCounter = 0;
+    mResynchronizationCounter = 0;
+    ResetOffset();
+    LOG(LOG_VERBOSE, "Created A/V synchronizer for %s", mName.c_str());
+}
+
+MediaSynchronizer::~MediaSynchronizer()
+{
+    LOG(LOG_VERBOSE, "Destroyed A/V synchronizer for %s after %"PRId64" adjustments and %"PRId64" re-synchronizations", mName.c_str(), mAdjustmentCounter, mResynchronizationCounter);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MediaSynchronizer::SetActivation(bool pActive)
+{
+    mMutex.lock();
+    if (mActive != pActive)
+    {
+        LOG(LOG_VERBOSE, "Setting A/V synchronization for %s to: %d", mName.c_str(), pActive);
+        mActive = pActive;
+        ResetOffset();
+    }
+    mMutex.unlock();
+}
+
+bool MediaSynchronizer::GetActivation()
+{
+    return mActive;
+}
+
+void MediaSynchronizer::SetTargetOffset(int64_t pOffset)
+{
+    mMutex.lock();
+    if (mTargetOffset != pOffset)
+    {
+        #ifdef MSYNC_DEBUG
+            LOG(LOG_VERBOSE, "Setting A/V target offset for %s to: %"PRId64" ms", mName.c_str(), pOffset / 1000);
+        #endif
+        // the smoothed offset refers to the old target
+        if (mOffsetValid)
+            mOffset += mTargetOffset - pOffset;
+        mTargetOffset = pOffset;
+    }
+    mMutex.unlock();
+}
+
+void MediaSynchronizer::ResetOffset()
+{
+    mOffset = 0;
+    mOffsetValid = false;
+}
+
+int64_t MediaSynchronizer::SchedulePresentation(int64_t pSlaveSynchronizationTimestamp, int64_t pPresentationDelay)
+{
+    int64_t tResult = 0;
+
+    if ((!mActive) || (mMasterSource == NULL) || (pSlaveSynchronizationTimestamp == 0))
+        return 0;
+
+    // the master clock: sender time of the currently presented master frame
+    int64_t tMasterSynchronizationTimestamp = mMasterSource->GetSynchronizationTimestamp();
+    if (tMasterSynchronizationTimestamp == 0)
+    {// no valid reference yet, e.g., no RTCP sender report received
+        return 0;
+    }
+
+    int64_t tTime = Time::GetTimeStamp();
+
+    mMutex.lock();
+
+    // is the master clock still running?
+    if (tMasterSynchronizationTimestamp != mLastMasterTimestamp)
+    {
+        mLastMasterTimestamp = tMasterSynchronizationTimestamp;
+        mTimeLastMasterProgress = tTime;
+    }else
+    {
+        if (tTime - mTimeLastMasterProgress > MEDIA_SYNC_MASTER_TIMEOUT * 1000 * 1000)
+        {// master is paused or its stream was interrupted, we keep the slave untouched
+            ResetOffset();
+            mMutex.unlock();
+            return 0;
+        }
+    }
+
+    // compare the slave frame with the master clock at the time when the slave frame will be presented
+    int64_t tOffset = pSlaveSynchronizationTimestamp - (tMasterSynchronizationTimestamp + pPresentationDelay) - mTargetOffset;
+
+    // are both sources driven by the same clock?
+    if ((tOffset < -MEDIA_SYNC_MAX_OFFSET * 1000 * 1000) || (tOffset > MEDIA_SYNC_MAX_OFFSET * 1000 * 1000))
+    {
+        if (!mIncompatibleClocks)
+        {
+            LOG(LOG_WARN, "A/V offset of %"PRId64" ms for %s is out of range, sources seem to use different clocks, synchronization is suspended", tOffset / 1000, mName.c_str());
+            mIncompatibleClocks = true;
+        }
+        ResetOffset();
+        mMutex.unlock();
+        return 0;
+    }
+    if (mIncompatibleClocks)
+    {
+        LOG(LOG_VERBOSE, "A/V offset for %s is in range again, synchronization is resumed", mName.c_str());
+        mIncompatibleClocks = false;
+    }
+
+    // smooth the measurements to avoid jumps because of jitter
+    if (mOffsetValid)
+        mOffset += MEDIA_SYNC_SMOOTHING_FACTOR * ((double)tOffset - mOffset);
+    else
+    {
+        mOffset = tOffset;
+        mOffsetValid = true;
+    }
+
+    if ((mOffset < -MEDIA_SYNC_RESYNC_THRESHOLD * 1000 * 1000) || (mOffset > MEDIA_SYNC_RESYNC_THRESHOLD * 1000 * 1000))
+    {// large offset, e.g., after seeking in the master: shift the presentation at once
+        tResult = (int64_t)mOffset;
+        mResynchronizationCounter++;
+        LOG(LOG_WARN, "Large A/V offset of %"PRId64" ms for %s detected, shifting the presentation at once", tResult / 1000, mName.c_str());
+    }else if ((mOffset < -MEDIA_SYNC_DEAD_BAND * 1000 * 1000) || (mOffset > MEDIA_SYNC_DEAD_BAND * 1000 * 1000))
+    {// small offset: adjust the presentation of this frame slightly
+        tResult = (int64_t)mOffset;
+        if (tResult > MEDIA_SYNC_MAX_ADJUSTMENT_PER_FRAME * 1000 * 1000)
+            tResult = MEDIA_SYNC_MAX_ADJUSTMENT_PER_FRAME * 1000 * 1000;
+        if (tResult < -MEDIA_SYNC_MAX_ADJUSTMENT_PER_FRAME * 1000 * 1000)
+            tResult = -MEDIA_SYNC_MAX_ADJUSTMENT_PER_FRAME * 1000 * 1000;
+        mAdjustmentCounter++;
+    }
+
+    // the adjustment takes effect with this frame, the smoothed offset has to reflect this
+    mOffset -= tResult;
+
+    #ifdef MSYNC_DEBUG
+        LOG(LOG_VERBOSE, "A/V offset for %s: %"PRId64" ms (smoothed: %.2f ms), adjustment: %"PRId64" us", mName.c_str(), tOffset / 1000, (float)mOffset / 1000, tResult);
+    #endif
+
+    mMutex.unlock();
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+float MediaSynchronizer::GetOffset()
+{
+    float tResult;
+
+    mMutex.lock();
+    tResult = (float)(mOffset / 1000 / 1000);
+    mMutex.unlock();
+
+    return tResult;
+}
+
+int64_t MediaSynchronizer::GetAdjustmentCounter()
+{
+    return mAdjustmentCounter;
+}
+
+int64_t MediaSynchronizer::GetResynchronizationCounter()
+{
+    return mResynchronizationCounter;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
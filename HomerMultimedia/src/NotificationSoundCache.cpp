@@ -0,0 +1,209 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: Implementation of a cache of decoded notification sounds
+ * Since:   2014-01-25
+ */
+
+#include <NotificationSoundCache.h>
+#include <MediaSourceFile.h>
+#include <Logger.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace Homer { namespace Multimedia {
+
+using namespace Homer::Base;
+using namespace std;
+
+NotificationSoundCache sNotificationSoundCache;
+
+///////////////////////////////////////////////////////////////////////////////
+
+NotificationSoundCache::NotificationSoundCache()
+{
+}
+
+NotificationSoundCache::~NotificationSoundCache()
+{
+    NotificationSounds::iterator tIt;
+
+    for (tIt = mSounds.begin(); tIt != mSounds.end(); tIt++)
+    {
+        if (tIt->second != NULL)
+        {
+            free(tIt->second->Buffer);
+            delete tIt->second;
+        }
+    }
+}
+
+NotificationSoundCache& NotificationSoundCache::GetInstance()
+{
+    return sNotificationSoundCache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+NotificationSound* NotificationSoundCache::GetSound(string pFileName, int pSampleRate, int pChannels)
+{
+    NotificationSound *tResult = NULL;
+    NotificationSounds::iterator tIt;
+
+    if (pFileName == "")
+        return NULL;
+
+    string tKey = pFileName + "@" + toString(pSampleRate) + "/" + toString(pChannels);
+
+    mSoundsMutex.lock();
+
+    tIt = mSounds.find(tKey);
+    if (tIt != mSounds.end())
+    {
+        #ifdef NSC_DEBUG
+            LOG(LOG_VERBOSE, "Found sound %s in cache", tKey.c_str());
+        #endif
+        tResult = tIt->second;
+    }else
+    {
+        // failed files are cached as well, otherwise each notification would try to open them again
+        tResult = DecodeSound(pFileName, pSampleRate, pChannels);
+        mSounds[tKey] = tResult;
+    }
+
+    mSoundsMutex.unlock();
+
+    return tResult;
+}
+
+int NotificationSoundCache::GetSoundCount()
+{
+    int tResult;
+
+    mSoundsMutex.lock();
+    tResult = (int)mSounds.size();
+    mSoundsMutex.unlock();
+
+    return tResult;
+}
+
+int64_t NotificationSoundCache::GetMemoryUsage()
+{
+    int64_t tResult = 0;
+    NotificationSounds::iterator tIt;
+
+    mSoundsMutex.lock();
+    for (tIt = mSounds.begin(); tIt != mSounds.end(); tIt++)
+    {
+        if (tIt->second != NULL)
+            tResult += tIt->second->BufferSize;
+    }
+    mSoundsMutex.unlock();
+
+    return tResult;
+}
+
+NotificationSound* NotificationSoundCache::DecodeSound(string pFileName, int pSampleRate, int pChannels)
+{
+    NotificationSound *tResult = NULL;
+    int tMaxBufferSize = NOTIFICATION_SOUND_MAX_DURATION * pSampleRate * 2 /* 16 bit signed int LittleEndian */ * pChannels;
+    int tBufferSize = 0;
+    int tGrabFailures = 0;
+    char *tBuffer = NULL;
+
+    LOG(LOG_VERBOSE, "Decoding sound file %s with %d Hz and %d channels", pFileName.c_str(), pSampleRate, pChannels);
+
+    // grab as fast as possible
+    MediaSourceFile *tSource = new MediaSourceFile(pFileName, false);
+    if (!tSource->OpenAudioGrabDevice(pSampleRate, pChannels))
+    {
+        LOG(LOG_ERROR, "Couldn't open sound file %s", pFileName.c_str());
+        delete tSource;
+        return NULL;
+    }
+
+    char *tChunkBuffer = (char*)malloc(MEDIA_SOURCE_SAMPLES_MULTI_BUFFER_SIZE + FF_INPUT_BUFFER_PADDING_SIZE);
+    while (true)
+    {
+        int tChunkSize = MEDIA_SOURCE_SAMPLES_MULTI_BUFFER_SIZE + FF_INPUT_BUFFER_PADDING_SIZE;
+        int tChunkNumber = tSource->GrabChunk(tChunkBuffer, tChunkSize);
+        if (tChunkNumber == GRAB_RES_EOF)
+            break;
+        if ((tChunkNumber < 0) || (tChunkSize <= 0))
+        {
+            if (++tGrabFailures > NOTIFICATION_SOUND_MAX_GRAB_FAILURES)
+            {
+                LOG(LOG_WARN, "Too many grabbing failures for sound file %s, using the first %d bytes only", pFileName.c_str(), tBufferSize);
+                break;
+            }
+            continue;
+        }
+
+        if (tBufferSize + tChunkSize > tMaxBufferSize)
+        {
+            LOG(LOG_WARN, "Sound file %s is longer than %d seconds, using the first part only", pFileName.c_str(), NOTIFICATION_SOUND_MAX_DURATION);
+            tChunkSize = tMaxBufferSize - tBufferSize;
+        }
+
+        char *tNewBuffer = (char*)realloc(tBuffer, tBufferSize + tChunkSize);
+        if (tNewBuffer == NULL)
+        {
+            LOG(LOG_ERROR, "Couldn't allocate %d bytes for sound file %s", tBufferSize + tChunkSize, pFileName.c_str());
+            break;
+        }
+        tBuffer = tNewBuffer;
+        memcpy(tBuffer + tBufferSize, tChunkBuffer, tChunkSize);
+        tBufferSize += tChunkSize;
+
+        if (tBufferSize >= tMaxBufferSize)
+            break;
+    }
+    free(tChunkBuffer);
+
+    tSource->CloseGrabDevice();
+    delete tSource;
+
+    // align to entire sample frames
+    tBufferSize -= tBufferSize % (2 * pChannels);
+
+    if (tBufferSize > 0)
+    {
+        tResult = new NotificationSound();
+        tResult->FileName = pFileName;
+        tResult->SampleRate = pSampleRate;
+        tResult->Channels = pChannels;
+        tResult->Buffer = tBuffer;
+        tResult->BufferSize = tBufferSize;
+        LOG(LOG_VERBOSE, "Cached sound file %s with %d bytes PCM data", pFileName.c_str(), tBufferSize);
+    }else
+    {
+        LOG(LOG_ERROR, "Sound file %s doesn't contain any audio data", pFileName.c_str());
+        free(tBuffer);
+    }
+
+    return tResult;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -78,10 +78,6 @@ using namespace Homer::Monitor;
 
 ///////////////////////////////////////////////////////////////////////////////
 
-#define IS_RTCP_TYPE(x)                 ((x >= 72) && (x <= 76))
-
-///////////////////////////////////////////////////////////////////////////////
-
 #define RTP_PAYLOAD_TYPE_NONE                                            0x7F
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -447,6 +443,143 @@ union VP8ExtendedHeader{
     uint8_t Data[1];
 };
 
+// ########################## VP9 (RFC 9628) ###########################################
+/*
+    payload descriptor
+          0 1 2 3 4 5 6 7
+         +-+-+-+-+-+-+-+-+
+         |I|P|L|F|B|E|V|Z| (REQUIRED)
+         +-+-+-+-+-+-+-+-+
+    I:   |M| PICTURE ID  | (REQUIRED)
+         +-+-+-+-+-+-+-+-+
+    M:   | EXTENDED PID  | (RECOMMENDED)
+         +-+-+-+-+-+-+-+-+
+    L:   |  TID  |U| SID |D| (CONDITIONALLY RECOMMENDED)
+         +-+-+-+-+-+-+-+-+
+         |   TL0PICIDX   | (CONDITIONALLY REQUIRED, non-flexible mode)
+         +-+-+-+-+-+-+-+-+
+    P,F: | P_DIFF      |N| (CONDITIONALLY REQUIRED, up to 3 times)
+         +-+-+-+-+-+-+-+-+
+    V:   | SS            | (scalability structure)
+         | ..            |
+         +-+-+-+-+-+-+-+-+
+
+    scalability structure
+         +-+-+-+-+-+-+-+-+
+    V:   | N_S |Y|G|-|-|-|
+         +-+-+-+-+-+-+-+-+
+    Y:   |     WIDTH     | (16 bits, N_S + 1 times)
+         |     HEIGHT    | (16 bits, N_S + 1 times)
+         +-+-+-+-+-+-+-+-+
+    G:   |      N_G      |
+         +-+-+-+-+-+-+-+-+
+    N_G: |  T  |U| R |-|-| (N_G times)
+         |    P_DIFF     | (R times)
+         +-+-+-+-+-+-+-+-+
+ */
+union VP9Header{
+    struct{
+        unsigned int Z:1;                   /* not used for inter-layer prediction */
+        unsigned int V:1;                   /* scalability structure present */
+        unsigned int E:1;                   /* end of frame */
+        unsigned int B:1;                   /* beginning of frame */
+        unsigned int F:1;                   /* flexible mode */
+        unsigned int L:1;                   /* layer indices present */
+        unsigned int P:1;                   /* inter-picture predicted frame */
+        unsigned int I:1;                   /* picture ID present */
+    } __attribute__((__packed__));
+    uint8_t Data[1];
+};
+#define RTP_VP9_PAYLOAD_HEADER_SIZE         3 // descriptor and 15 bit picture ID
+#define RTP_VP9_SS_SIZE                     5 // one spatial layer with its resolution, no picture group description
+#define RTP_VP9_PAYLOAD_HEADER_SIZE_MAX     (RTP_VP9_PAYLOAD_HEADER_SIZE + RTP_VP9_SS_SIZE)
+
+// IVF framing of the depacketized VP9 stream, the ivf demuxer needs the frame size in front of each frame
+#define RTP_IVF_FILE_HEADER_SIZE            32
+#define RTP_IVF_FRAME_HEADER_SIZE           12
+
+// ########################## AV1 (AOM RTP payload format v1.0) ###########################################
+/*
+    aggregation header
+          0 1 2 3 4 5 6 7
+         +-+-+-+-+-+-+-+-+
+         |Z|Y| W |N|-|-|-|
+         +-+-+-+-+-+-+-+-+
+
+            Z: the first OBU element continues an OBU fragment of the previous packet
+            Y: the last OBU element continues in the next packet
+            W: number of OBU elements, 0 = each element is preceded by its LEB128 length
+            N: first packet of a coded video sequence
+
+    OBU element = OBU header (obu_has_size_field = 0) + OBU payload
+
+    OBU header
+          0 1 2 3 4 5 6 7
+         +-+-+-+-+-+-+-+-+
+         |F| TYPE  |X|S|-|
+         +-+-+-+-+-+-+-+-+
+ */
+#define RTP_AV1_AGGREGATION_HEADER_SIZE     1
+#define RTP_AV1_PAYLOAD_HEADER_SIZE_MAX     (RTP_AV1_AGGREGATION_HEADER_SIZE + 2 /* LEB128 length of one element up to 16 KB */)
+
+#define AV1_OBU_TYPE(x)                     ((x >> 3) & 0x0F)
+#define AV1_OBU_HAS_EXTENSION(x)            (x & 0x04)
+#define AV1_OBU_HAS_SIZE_FIELD(x)           (x & 0x02)
+#define AV1_OBU_SEQUENCE_HEADER             1
+#define AV1_OBU_TEMPORAL_DELIMITER          2
+#define AV1_OBU_TILE_LIST                   8
+#define AV1_OBU_PADDING                     15
+
+// VP9/AV1 frames are reassembled before they are handed over to the demuxer
+#define RTP_FRAME_REASSEMBLY_BUFFER_SIZE    (4 * 1024 * 1024)
+
+// returns the amount of read bytes, 0 if the buffer ends before the LEB128 value
+static int ReadLeb128(const uint8_t *pData, const uint8_t *pDataEnd, uint64_t &pValue)
+{
+    pValue = 0;
+    for (int i = 0; (i < 8) && (pData + i < pDataEnd); i++)
+    {
+        pValue |= (uint64_t)(pData[i] & 0x7F) << (i * 7);
+        if ((pData[i] & 0x80) == 0)
+            return i + 1;
+    }
+    return 0;
+}
+
+// returns the amount of written bytes
+static int WriteLeb128(uint8_t *pData, uint64_t pValue)
+{
+    int tResult = 0;
+    do{
+        pData[tResult] = pValue & 0x7F;
+        pValue >>= 7;
+        if (pValue > 0)
+            pData[tResult] |= 0x80;
+        tResult++;
+    }while(pValue > 0);
+    return tResult;
+}
+
+static int GetLeb128Size(uint64_t pValue)
+{
+    int tResult = 1;
+    while (pValue >= 0x80)
+    {
+        pValue >>= 7;
+        tResult++;
+    }
+    return tResult;
+}
+
+static void WriteLittleEndian(char *pData, uint64_t pValue, int pBytes)
+{
+    for (int i = 0; i < pBytes; i++)
+    {
+        pData[i] = pValue & 0xFF;
+        pValue >>= 8;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // NTP time handling
 
@@ -479,11 +612,28 @@ RTP::RTP()
     mLocalSourceIdentifier = 0;
     mPayloadId = RTP_PAYLOAD_TYPE_NONE;
     mPayloadIdNegotiatedByExternal = RTP_PAYLOAD_TYPE_NONE;
+    mAudioPtime = 0;
+    mAudioMaxPtime = 0;
+    mAudioPacketizationMode = RTP_AUDIO_PACKETIZATION_LOW_LATENCY;
+    mAudioAggregationBuffer[0] = NULL;
+    mAudioAggregationBuffer[1] = NULL;
+    mAudioAggregationBufferIndex = 0;
+    mAudioAggregationSize = 0;
+    mAudioAggregationSamples = 0;
+    mAudioAggregationPts = 0;
+    mInternalPayloadSizeMax = 0;
+    mInternalResX = 0;
+    mInternalResY = 0;
+    mVP9PictureId = 0;
+    mFrameReassemblyBuffer = NULL;
+    mAV1ObuBuffer = NULL;
     Init();
 }
 
 RTP::~RTP()
 {
+    free(mFrameReassemblyBuffer);
+    free(mAV1ObuBuffer);
     LOG(LOG_VERBOSE, "Destroyed");
 }
 
@@ -545,6 +695,13 @@ void RTP::Init()
     mH261H263EndByteBits = 0;
     mH261H263EndByte = 0;
     mHEVCIsUsingDonFields = false;
+    mFrameReassemblySize = 0;
+    mFrameReassemblyDropping = false;
+    mFrameReassemblyLastSequenceNumber = 0;
+    mVP9IvfFileHeaderDelivered = false;
+    mVP9ResX = 0;
+    mVP9ResY = 0;
+    mAV1ObuSize = 0;
 }
 
 bool RTP::ResetRrtpParser()
@@ -553,9 +710,9 @@ bool RTP::ResetRrtpParser()
     return true;
 }
 
-bool RTP::OpenRtpEncoderH261(string pTargetHost, unsigned int pTargetPort, AVStream *pInnerStream)
+bool RTP::OpenRtpEncoderInternal(string pTargetHost, unsigned int pTargetPort, AVStream *pInnerStream)
 {
-    LOG(LOG_VERBOSE, "Using lib internal rtp packetizer for H261 codec");
+    LOG(LOG_VERBOSE, "Using lib internal rtp packetizer for %s codec", HM_avcodec_get_name(mStreamCodecID));
     LOG(LOG_INFO, "Opened...");
     LOG(LOG_INFO, "    ..rtp target: %s:%u", pTargetHost.c_str(), pTargetPort);
     LOG(LOG_INFO, "    ..rtp header size: %d", RTP_HEADER_SIZE);
@@ -613,6 +770,18 @@ bool RTP::OpenRtpEncoder(string pTargetHost, unsigned int pTargetPort, AVStream
         LOG(LOG_ERROR, "Error when allocating memory for RTP packet buffer");
     else
         LOG(LOG_VERBOSE, "Created RTP packet buffer memory of %d bytes at %p", MEDIA_SOURCE_AV_CHUNK_BUFFER_SIZE, mRtpPacketBuffer);
+    if (IsAudioAggregationSupported(pInnerStream->codec->codec_id))
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            mAudioAggregationBuffer[i] = (char*)malloc(pInnerStream->codec->rtp_payload_size);
+            if (mAudioAggregationBuffer[i] == NULL)
+                LOG(LOG_ERROR, "Error when allocating memory for audio aggregation buffer %d", i);
+        }
+    }
+    mAudioAggregationBufferIndex = 0;
+    mAudioAggregationSize = 0;
+    mAudioAggregationSamples = 0;
 
     mTargetHost = pTargetHost;
     mTargetPort = pTargetPort;
@@ -634,6 +803,17 @@ bool RTP::OpenRtpEncoder(string pTargetHost, unsigned int pTargetPort, AVStream
     // set SRC ID
     mLocalSourceIdentifier = av_get_random_seed();
 
+    // ffmpeg lacks RTP support for VP9 and AV1 (or implements outdated drafts), hence we use the internal packetizer
+    if ((mStreamCodecID == AV_CODEC_ID_VP9) || (mStreamCodecID == AV_CODEC_ID_AV1))
+    {
+        mInternalPayloadSizeMax = pInnerStream->codec->rtp_payload_size;
+        mInternalResX = pInnerStream->codec->width;
+        mInternalResY = pInnerStream->codec->height;
+        mVP9PictureId = av_get_random_seed() & 0x7FFF;
+
+        return OpenRtpEncoderInternal(pTargetHost, pTargetPort, pInnerStream);
+    }
+
     // allocate new format context
     mRtpFormatContext = AV_NEW_FORMAT_CONTEXT();
 
@@ -690,7 +870,11 @@ bool RTP::OpenRtpEncoder(string pTargetHost, unsigned int pTargetPort, AVStream
     mRtpFormatContext->pb->max_packet_size = mAVIOContext->max_packet_size;
 
     mRtpFormatContext->start_time_realtime = av_gettime();
-    
+
+    // the RTP/AMR packetizer of FFmpeg aggregates as many frames as fit into the max. delay
+    if (mStreamCodecID == AV_CODEC_ID_AMR_NB)
+        mRtpFormatContext->max_delay = GetAudioPacketizationTime() * 1000;
+
     // make sure that the RTP/H.261 packetizer of FFmpeg gets started
     if (mStreamCodecID == AV_CODEC_ID_H261)
     {
@@ -740,7 +924,7 @@ bool RTP::OpenRtpEncoder(string pTargetHost, unsigned int pTargetPort, AVStream
             SetH261PayloadSizeMax(pInnerStream->codec->rtp_payload_size);
             pInnerStream->codec->rtp_payload_size = 0;
 
-            return OpenRtpEncoderH261(pTargetHost, pTargetPort, pInnerStream);
+            return OpenRtpEncoderInternal(pTargetHost, pTargetPort, pInnerStream);
         }
     }
 
@@ -785,6 +969,8 @@ bool RTP::OpenRtpEncoder(string pTargetHost, unsigned int pTargetPort, AVStream
     LOG(LOG_INFO, "    ..stream start real-time: %"PRId64, mRtpFormatContext->start_time_realtime);
     LOG(LOG_INFO, "    ..stream start time: %"PRId64, mRtpEncoderStream->start_time);
     LOG(LOG_INFO, "    ..max. delay: %d", mRtpFormatContext->max_delay);
+    if (pInnerStream->codec->codec_type == AVMEDIA_TYPE_AUDIO)
+        LOG(LOG_INFO, "    ..packetization time: %d ms (negotiated: %d ms, max.: %d ms)", GetAudioPacketizationTime(), mAudioPtime, mAudioMaxPtime);
     LOG(LOG_INFO, "    ..start A/V PTS: %"PRId64, tAVPacketPts);
 #if FF_API_R_FRAME_RATE
     LOG(LOG_INFO, "    ..stream rfps: %d/%d", mRtpEncoderStream->r_frame_rate.num, mRtpEncoderStream->r_frame_rate.den);
@@ -838,6 +1024,13 @@ bool RTP::CloseRtpEncoder()
             delete mRtpPacketStream;
             mRtpPacketStream = NULL;
         }
+        for (int i = 0; i < 2; i++)
+        {
+            free(mAudioAggregationBuffer[i]);
+            mAudioAggregationBuffer[i] = NULL;
+        }
+        mAudioAggregationSize = 0;
+        mAudioAggregationSamples = 0;
         LOG(LOG_INFO, "...closed");
     }else
         LOG(LOG_INFO, "...wasn't open");
@@ -885,6 +1078,9 @@ bool RTP::IsPayloadSupported(enum AVCodecID pId)
             case AV_CODEC_ID_VP8:
             case AV_CODEC_ID_ADPCM_G722:
 //            case AV_CODEC_ID_ADPCM_G726:
+            // internal packetizer
+            case AV_CODEC_ID_VP9:
+            case AV_CODEC_ID_AV1:
                             tResult = true;
                             break;
             default:
@@ -952,6 +1148,12 @@ int RTP::GetPayloadHeaderSizeMax(enum AVCodecID pCodec)
             case AV_CODEC_ID_VP8:
                 tResult = sizeof(VP8Header); // we neglect the extended header and the 3 other optional header bytes
                 break;
+            case AV_CODEC_ID_VP9:
+                tResult = RTP_VP9_PAYLOAD_HEADER_SIZE_MAX;
+                break;
+            case AV_CODEC_ID_AV1:
+                tResult = RTP_AV1_PAYLOAD_HEADER_SIZE_MAX;
+                break;
 //            case AV_CODEC_ID_ADPCM_G726:
             default:
                 tResult = 0;
@@ -1044,6 +1246,129 @@ void RTP::SetExternallyNegotiatedPayloadID(unsigned int pNewID)
     mPayloadIdNegotiatedByExternal = pNewID;
 }
 
+void RTP::SetAudioPacketizationTime(int pPtime, int pMaxPtime)
+{
+    LOG(LOG_VERBOSE, "Setting audio packetization time %d ms (max.: %d ms)", pPtime, pMaxPtime);
+    mAudioPtime = (pPtime > 0) ? pPtime : 0;
+    mAudioMaxPtime = (pMaxPtime > 0) ? pMaxPtime : 0;
+}
+
+void RTP::SetAudioPacketizationMode(enum RtpAudioPacketizationMode pMode)
+{
+    if (mAudioPacketizationMode != pMode)
+    {
+        mAudioPacketizationMode = pMode;
+        LOG(LOG_VERBOSE, "Switched audio packetization to %s mode, packetization time: %d ms", (pMode == RTP_AUDIO_PACKETIZATION_LOW_OVERHEAD) ? "low-overhead" : "low-latency", GetAudioPacketizationTime());
+    }
+}
+
+enum RtpAudioPacketizationMode RTP::GetAudioPacketizationMode()
+{
+    return mAudioPacketizationMode;
+}
+
+int RTP::GetAudioPacketizationTime()
+{
+    int tResult = (mAudioPtime > 0) ? mAudioPtime : RTP_AUDIO_PTIME_DEFAULT;
+    int tMaxPtime = ((mAudioMaxPtime > 0) && (mAudioMaxPtime < RTP_AUDIO_PTIME_MAX)) ? mAudioMaxPtime : RTP_AUDIO_PTIME_MAX;
+
+    if ((mAudioPacketizationMode == RTP_AUDIO_PACKETIZATION_LOW_OVERHEAD) && (tResult < RTP_AUDIO_PTIME_LOW_OVERHEAD))
+        tResult = RTP_AUDIO_PTIME_LOW_OVERHEAD;
+
+    if (tResult > tMaxPtime)
+        tResult = tMaxPtime;
+
+    return tResult;
+}
+
+bool RTP::IsAudioAggregationSupported(enum AVCodecID pCodec)
+{
+    // sample based codecs can be split at each sample, AMR-NB is aggregated by the FFmpeg packetizer
+    // and MP3 frames can't be aggregated because of the Mbz hack (see RtpCreate())
+    switch(pCodec)
+    {
+        case AV_CODEC_ID_PCM_ALAW:
+        case AV_CODEC_ID_PCM_MULAW:
+        case AV_CODEC_ID_PCM_S16BE:
+        case AV_CODEC_ID_ADPCM_G722:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool RTP::AggregateAudioFrame(AVPacket *pAVPacket, AVPacket *&pAggregatedPacket)
+{
+    AVCodecContext *tCodecContext = mRtpEncoderStream->codec;
+    int tBitsPerSample = av_get_bits_per_sample(mStreamCodecID) * tCodecContext->channels;
+    int tPayloadSizeMax = mAVIOContext->max_packet_size - RTP_HEADER_SIZE;
+
+    pAggregatedPacket = pAVPacket;
+
+    if ((tBitsPerSample <= 0) || (tCodecContext->sample_rate <= 0) || (mAudioAggregationBuffer[0] == NULL) || (mAudioAggregationBuffer[1] == NULL))
+        return true;
+
+    int tFrameSamples = pAVPacket->size * 8 / tBitsPerSample;
+    int tPtimeSamples = GetAudioPacketizationTime() * tCodecContext->sample_rate / 1000;
+
+    // frames which fill an entire RTP packet are packetized without aggregation
+    if ((mAudioAggregationSize == 0) && ((tFrameSamples >= tPtimeSamples) || (pAVPacket->size > tPayloadSizeMax)))
+        return true;
+
+    // the frame size of an audio stream is constant, a larger frame indicates a codec change
+    if (pAVPacket->size > tPayloadSizeMax)
+    {
+        LOG(LOG_WARN, "Dropping %d aggregated audio samples because frame size changed to %d bytes", mAudioAggregationSamples, pAVPacket->size);
+        mAudioAggregationSize = 0;
+        mAudioAggregationSamples = 0;
+        return true;
+    }
+
+    pAggregatedPacket = NULL;
+
+    // the collected frames are sent if the new frame doesn't fit or isn't contiguous, e.g., after suppressed silence
+    if ((mAudioAggregationSize > 0) && ((mAudioAggregationSize + pAVPacket->size > tPayloadSizeMax) || (pAVPacket->pts != mAudioAggregationPts + mAudioAggregationSamples)))
+    {
+        #ifdef RTP_DEBUG_PACKET_ENCODER
+            LOG(LOG_VERBOSE, "Sending %d aggregated audio samples early, next frame has PTS %"PRId64" and %d bytes", mAudioAggregationSamples, pAVPacket->pts, pAVPacket->size);
+        #endif
+        FinishAudioAggregation(pAVPacket);
+        pAggregatedPacket = &mAudioAggregationPacket;
+    }
+
+    // store the frame
+    if (mAudioAggregationSize == 0)
+        mAudioAggregationPts = pAVPacket->pts;
+    memcpy(mAudioAggregationBuffer[mAudioAggregationBufferIndex] + mAudioAggregationSize, pAVPacket->data, pAVPacket->size);
+    mAudioAggregationSize += pAVPacket->size;
+    mAudioAggregationSamples += tFrameSamples;
+
+    // the collected frames cover the packetization time: send them
+    if ((pAggregatedPacket == NULL) && (mAudioAggregationSamples >= tPtimeSamples))
+    {
+        FinishAudioAggregation(pAVPacket);
+        pAggregatedPacket = &mAudioAggregationPacket;
+    }
+
+    return (pAggregatedPacket != NULL);
+}
+
+void RTP::FinishAudioAggregation(AVPacket *pAVPacket)
+{
+    // describe the collected frames as one packet and continue with the other buffer
+    av_init_packet(&mAudioAggregationPacket);
+    mAudioAggregationPacket.data = (uint8_t*)mAudioAggregationBuffer[mAudioAggregationBufferIndex];
+    mAudioAggregationPacket.size = mAudioAggregationSize;
+    mAudioAggregationPacket.pts = mAudioAggregationPts;
+    mAudioAggregationPacket.dts = mAudioAggregationPts;
+    mAudioAggregationPacket.stream_index = pAVPacket->stream_index;
+    mAudioAggregationPacket.flags = pAVPacket->flags;
+
+    mAudioAggregationBufferIndex = 1 - mAudioAggregationBufferIndex;
+    mAudioAggregationSize = 0;
+    mAudioAggregationSamples = 0;
+}
+
 bool RTP::RtpCreate(AVPacket *pAVPacket, char *&pResultingOutputData, unsigned int &pResultingOutputDataSize)
 {
     int tResult = 0;
@@ -1063,18 +1388,31 @@ bool RTP::RtpCreate(AVPacket *pAVPacket, char *&pResultingOutputData, unsigned i
         return false;
 
     //####################################################################
-    // for H261 use the internal RTP implementation
+    // for H261, VP9 and AV1 use the internal RTP implementation
     //####################################################################
     if (mH261UseInternalEncoder)
     {
-        bool tResult = RtpCreateH261(tAVBuffer, tAVBufferSize, tAVBufferTimestamp);
+        bool tResult;
+        bool tKeyFrame = (pAVPacket->flags & AV_PKT_FLAG_KEY);
+        switch(mStreamCodecID)
+        {
+            case AV_CODEC_ID_VP9:
+                tResult = RtpCreateVP9(tAVBuffer, tAVBufferSize, tAVBufferTimestamp, tKeyFrame);
+                break;
+            case AV_CODEC_ID_AV1:
+                tResult = RtpCreateAV1(tAVBuffer, tAVBufferSize, tAVBufferTimestamp, tKeyFrame);
+                break;
+            default:
+                tResult = RtpCreateH261(tAVBuffer, tAVBufferSize, tAVBufferTimestamp);
+                break;
+        }
         pResultingOutputData = tAVBuffer;
         pResultingOutputDataSize = tAVBufferSize;
         return tResult;
     }
 
     //####################################################################
-    // for all non H261 codec use the ffmpeg RTP implementation
+    // for all other codecs use the ffmpeg RTP implementation
     //####################################################################
     if (mRtpFormatContext)
     {
@@ -1095,6 +1433,20 @@ bool RTP::RtpCreate(AVPacket *pAVPacket, char *&pResultingOutputData, unsigned i
         return true;
     }
 
+    //####################################################################
+    // aggregate several audio frames within one RTP packet
+    //####################################################################
+    if (IsAudioAggregationSupported(mStreamCodecID))
+    {
+        AVPacket *tAggregatedPacket = NULL;
+        if (!AggregateAudioFrame(pAVPacket, tAggregatedPacket))
+            return false;
+        pAVPacket = tAggregatedPacket;
+        tAVBuffer = (char*)pAVPacket->data;
+        tAVBufferSize = (unsigned int)pAVPacket->size;
+        tAVBufferTimestamp = pAVPacket->pts;
+    }
+
     // save the amount of bytes of the original codec packet
     // HINT: we use this to store the size of the original codec packet within MPA header's MBZ entry
     //       later we use this MBZ entry inside of MediaSourceNet to detect the fragment/packet boundaries
@@ -1461,6 +1813,271 @@ bool RTP::RtpCreateH261(char *&pData, unsigned int &pDataSize, int64_t pPacketPt
     return true;
 }
 
+// writes the size and the RTP header in front of a payload which was already stored in the RTP packet stream
+void RTP::RtpFinishInternalPacket(char *pPacket, unsigned int pPayloadSize, bool pMarked, int64_t pPacketPts)
+{
+    // set the current rtp packet's size within the resulting packet buffer
+    // HINT: convert from host to network byte order to pretend ffmpeg behavior
+    unsigned int *tRtpPacketSize = (unsigned int*)pPacket;
+    *tRtpPacketSize = htonl((uint32_t) RTP_HEADER_SIZE + pPayloadSize);
+
+    // get pointer to RTP header buffer
+    RtpHeader* tRtpHeader  = (RtpHeader*)(pPacket + 4);
+
+    tRtpHeader->Version = 2; // current RTP-rfc 3550 defines version 2
+    tRtpHeader->Padding = 0; // no padding octets
+    tRtpHeader->Extension = 0; // no extension header used
+    tRtpHeader->CsrcCount = 0; // no usage of CSRCs
+    tRtpHeader->Marked = pMarked ? 1 : 0; // 1 = last fragment, 0 = intermediate fragment
+    tRtpHeader->PayloadType = mPayloadId; // dynamic payload type
+    tRtpHeader->SequenceNumber = ++mH261LocalSequenceNumber; // monotonous growing
+    tRtpHeader->Timestamp = pPacketPts * CalculateClockRateFactor() /* 90 kHz clock rate */;
+    tRtpHeader->Ssrc = mLocalSourceIdentifier; // use the initially computed unique ID
+
+    // convert from host to network byte order
+    for (int i = 0; i < 3; i++)
+        tRtpHeader->Data[i] = htonl(tRtpHeader->Data[i]);
+
+    //increase packet counter
+    mH261SentPackets++;
+    mH261SentOctets += pPayloadSize;
+}
+
+// HINT: ffmpeg lacks support for rtp encapsulation for VP9 according to RFC 9628
+bool RTP::RtpCreateVP9(char *&pData, unsigned int &pDataSize, int64_t pPacketPts, bool pKeyFrame)
+{
+    if ((!mRtpEncoderOpened) || (mInternalPayloadSizeMax == 0))
+        return false;
+
+    #ifdef RTP_DEBUG_PACKET_ENCODER
+        LOG(LOG_VERBOSE, "Encapsulate %s frame with format vp9 of size: %u while maximum payload size is: %u", pKeyFrame ? "key" : "inter", pDataSize, mInternalPayloadSizeMax);
+    #endif
+
+    //HINT: the real-time encoder settings disable alt-ref frames, hence each encoder packet contains one frame and no superframe index
+
+    // calculate the amount of needed RTP packets to encapsulate the whole frame
+    unsigned int tPacketCount = (pDataSize + mInternalPayloadSizeMax - 1) / mInternalPayloadSizeMax;
+    unsigned int tRtpStreamDataSize = 0;
+
+    // get pointer to the current working address inside rtp packet stream
+    char *tCurrentRtpStreamData = mRtpPacketStream;
+    for (unsigned int tPacketIndex = 0; tPacketIndex < tPacketCount; tPacketIndex++)
+    {
+        // #############################################################
+        // create RTCP sender report
+        // #############################################################
+        RtcpCreateH261SenderReport(tCurrentRtpStreamData, tRtpStreamDataSize, pPacketPts);
+
+        // #############################################################
+        // create RTP packet with VP9 payload inside
+        // #############################################################
+        bool tFirstPacket = (tPacketIndex == 0);
+        bool tLastPacket = (tPacketIndex == tPacketCount - 1);
+        // key frames start with the scalability structure, it signals the resolution to the receiver
+        bool tScalabilityStructure = ((tFirstPacket) && (pKeyFrame));
+        unsigned int tHeaderSize = RTP_VP9_PAYLOAD_HEADER_SIZE + (tScalabilityStructure ? RTP_VP9_SS_SIZE : 0);
+        unsigned int tChunkSize = (pDataSize > mInternalPayloadSizeMax) ? mInternalPayloadSizeMax : pDataSize;
+
+        tRtpStreamDataSize += 4 + RTP_HEADER_SIZE + tHeaderSize + tChunkSize;
+        if (tRtpStreamDataSize > MEDIA_SOURCE_AV_CHUNK_BUFFER_SIZE)
+        {
+            LOG(LOG_ERROR, "RTP stream buffer is too small, stopping RTP encapsulation here");
+            return false;
+        }
+
+        // #############################################################
+        // HEADER: create VP9 payload descriptor
+        // #############################################################
+        uint8_t *tPayload = (uint8_t*)tCurrentRtpStreamData + 4 + RTP_HEADER_SIZE;
+        VP9Header* tVP9Header = (VP9Header*)tPayload;
+
+        tVP9Header->Data[0] = 0;
+        tVP9Header->I = 1; // picture ID present
+        tVP9Header->P = !pKeyFrame;
+        tVP9Header->L = 0; // neither temporal nor spatial layers
+        tVP9Header->F = 0; // non-flexible mode
+        tVP9Header->B = tFirstPacket;
+        tVP9Header->E = tLastPacket;
+        tVP9Header->V = tScalabilityStructure;
+        tVP9Header->Z = 0;
+        // 15 bit picture ID
+        tPayload[1] = 0x80 /* M bit */ | ((mVP9PictureId >> 8) & 0x7F);
+        tPayload[2] = mVP9PictureId & 0xFF;
+        if (tScalabilityStructure)
+        {
+            tPayload[3] = 0x10; // N_S = 0 (one spatial layer), Y = 1 (resolution present), G = 0 (no picture group description)
+            tPayload[4] = (mInternalResX >> 8) & 0xFF;
+            tPayload[5] = mInternalResX & 0xFF;
+            tPayload[6] = (mInternalResY >> 8) & 0xFF;
+            tPayload[7] = mInternalResY & 0xFF;
+        }
+
+        // #############################################################
+        // PAYLOAD: copy PAYLOAD to packet buffer
+        // #############################################################
+        memcpy(tPayload + tHeaderSize, pData, tChunkSize);
+        pData += tChunkSize;
+        pDataSize -= tChunkSize;
+
+        // #############################################################
+        // HEADER: create RTP header
+        // #############################################################
+        RtpFinishInternalPacket(tCurrentRtpStreamData, tHeaderSize + tChunkSize, tLastPacket, pPacketPts);
+
+        // go to the next packet header
+        tCurrentRtpStreamData += 4 + RTP_HEADER_SIZE + tHeaderSize + tChunkSize;
+    }
+    mVP9PictureId = (mVP9PictureId + 1) & 0x7FFF;
+
+    pData = mRtpPacketStream;
+    pDataSize = tRtpStreamDataSize;
+
+    return true;
+}
+
+// HINT: ffmpeg lacks support for rtp encapsulation for AV1 according to the AOM payload format
+bool RTP::RtpCreateAV1(char *&pData, unsigned int &pDataSize, int64_t pPacketPts, bool pKeyFrame)
+{
+    if ((!mRtpEncoderOpened) || (mInternalPayloadSizeMax == 0))
+        return false;
+
+    #ifdef RTP_DEBUG_PACKET_ENCODER
+        LOG(LOG_VERBOSE, "Encapsulate %s temporal unit with format av1 of size: %u while maximum payload size is: %u", pKeyFrame ? "key" : "inter", pDataSize, mInternalPayloadSizeMax);
+    #endif
+
+    const uint8_t *tObu = (const uint8_t*)pData;
+    const uint8_t *tTemporalUnitEnd = tObu + pDataSize;
+    // payload size of one packet: aggregation header, OBU elements and their length fields
+    unsigned int tPacketCapacity = mInternalPayloadSizeMax + RTP_AV1_PAYLOAD_HEADER_SIZE_MAX;
+    unsigned int tRtpStreamDataSize = 0;
+    char *tCurrentRtpStreamData = mRtpPacketStream;
+    char *tPacket = NULL; // the packet which is currently filled
+    uint8_t *tPacketPayload = NULL;
+    unsigned int tPacketPayloadSize = 0;
+    bool tFirstPacket = true;
+    bool tContinuedObu = false;
+
+    // the encoder delivers the low overhead bitstream format: each OBU has a size field
+    while (tObu < tTemporalUnitEnd)
+    {
+        // #############################################################
+        // parse the next OBU
+        // #############################################################
+        uint8_t tElementHeader[2];
+        tElementHeader[0] = tObu[0] & ~0x02; // RTP transports OBUs without size field
+        int tObuHeaderSize = AV1_OBU_HAS_EXTENSION(tObu[0]) ? 2 : 1;
+        if (tObu + tObuHeaderSize > tTemporalUnitEnd)
+        {
+            LOG(LOG_ERROR, "Invalid AV1 OBU header, stopping RTP encapsulation here");
+            break;
+        }
+        if (tObuHeaderSize > 1)
+            tElementHeader[1] = tObu[1];
+        uint64_t tObuPayloadSize = tTemporalUnitEnd - tObu - tObuHeaderSize;
+        int tObuSizeFieldSize = 0;
+        if (AV1_OBU_HAS_SIZE_FIELD(tObu[0]))
+        {
+            if ((tObuSizeFieldSize = ReadLeb128(tObu + tObuHeaderSize, tTemporalUnitEnd, tObuPayloadSize)) == 0)
+            {
+                LOG(LOG_ERROR, "Invalid AV1 OBU size field, stopping RTP encapsulation here");
+                break;
+            }
+        }
+        const uint8_t *tObuPayload = tObu + tObuHeaderSize + tObuSizeFieldSize;
+        if (tObuPayloadSize > (uint64_t)(tTemporalUnitEnd - tObuPayload))
+        {
+            LOG(LOG_ERROR, "Invalid AV1 OBU size of %"PRIu64" bytes, stopping RTP encapsulation here", tObuPayloadSize);
+            break;
+        }
+        int tObuType = AV1_OBU_TYPE(tObu[0]);
+        tObu = tObuPayload + tObuPayloadSize;
+
+        // temporal delimiters, tile lists and padding aren't transmitted
+        if ((tObuType == AV1_OBU_TEMPORAL_DELIMITER) || (tObuType == AV1_OBU_TILE_LIST) || (tObuType == AV1_OBU_PADDING))
+            continue;
+
+        // #############################################################
+        // distribute the OBU element among the packets
+        // #############################################################
+        uint64_t tElementSize = tObuHeaderSize + tObuPayloadSize;
+        uint64_t tElementOffset = 0;
+        while (tElementOffset < tElementSize)
+        {
+            // start a new packet
+            if (tPacket == NULL)
+            {
+                RtcpCreateH261SenderReport(tCurrentRtpStreamData, tRtpStreamDataSize, pPacketPts);
+                if (tRtpStreamDataSize + 4 + RTP_HEADER_SIZE + tPacketCapacity > MEDIA_SOURCE_AV_CHUNK_BUFFER_SIZE)
+                {
+                    LOG(LOG_ERROR, "RTP stream buffer is too small, stopping RTP encapsulation here");
+                    return false;
+                }
+                tPacket = tCurrentRtpStreamData;
+                tPacketPayload = (uint8_t*)tPacket + 4 + RTP_HEADER_SIZE;
+                // aggregation header: Z, W = 0 (each element has a length field), N
+                tPacketPayload[0] = (tContinuedObu ? 0x80 : 0x00) | (((tFirstPacket) && (pKeyFrame)) ? 0x08 : 0x00);
+                tPacketPayloadSize = RTP_AV1_AGGREGATION_HEADER_SIZE;
+            }
+
+            unsigned int tSpace = tPacketCapacity - tPacketPayloadSize;
+            if ((tSpace < 4) && (tElementOffset == 0))
+            {// not worth a fragment, the element starts in the next packet
+                RtpFinishInternalPacket(tPacket, tPacketPayloadSize, false, pPacketPts);
+                tRtpStreamDataSize += 4 + RTP_HEADER_SIZE + tPacketPayloadSize;
+                tCurrentRtpStreamData += 4 + RTP_HEADER_SIZE + tPacketPayloadSize;
+                tPacket = NULL;
+                tFirstPacket = false;
+                tContinuedObu = false;
+                continue;
+            }
+
+            // size of the element fragment which fits into this packet
+            uint64_t tChunkSize = tElementSize - tElementOffset;
+            if (GetLeb128Size(tChunkSize) + tChunkSize > tSpace)
+                tChunkSize = tSpace - GetLeb128Size(tSpace);
+            tPacketPayloadSize += WriteLeb128(tPacketPayload + tPacketPayloadSize, tChunkSize);
+
+            // copy the element fragment: header bytes without size field, afterwards the OBU payload
+            uint64_t tCopied = 0;
+            while ((tCopied < tChunkSize) && (tElementOffset + tCopied < (uint64_t)tObuHeaderSize))
+            {
+                tPacketPayload[tPacketPayloadSize++] = tElementHeader[tElementOffset + tCopied];
+                tCopied++;
+            }
+            if (tCopied < tChunkSize)
+            {
+                memcpy(tPacketPayload + tPacketPayloadSize, tObuPayload + (tElementOffset + tCopied - tObuHeaderSize), tChunkSize - tCopied);
+                tPacketPayloadSize += tChunkSize - tCopied;
+            }
+            tElementOffset += tChunkSize;
+
+            if (tElementOffset < tElementSize)
+            {// the OBU continues in the next packet
+                tPacketPayload[0] |= 0x40; // Y
+                RtpFinishInternalPacket(tPacket, tPacketPayloadSize, false, pPacketPts);
+                tRtpStreamDataSize += 4 + RTP_HEADER_SIZE + tPacketPayloadSize;
+                tCurrentRtpStreamData += 4 + RTP_HEADER_SIZE + tPacketPayloadSize;
+                tPacket = NULL;
+                tFirstPacket = false;
+                tContinuedObu = true;
+            }else
+                tContinuedObu = false;
+        }
+    }
+
+    // the last packet of the temporal unit gets the marker bit
+    if (tPacket != NULL)
+    {
+        RtpFinishInternalPacket(tPacket, tPacketPayloadSize, true, pPacketPts);
+        tRtpStreamDataSize += 4 + RTP_HEADER_SIZE + tPacketPayloadSize;
+    }
+
+    pData = mRtpPacketStream;
+    pDataSize = tRtpStreamDataSize;
+
+    return true;
+}
+
 unsigned int RTP::GetLostPacketsFromRTP()
 {
     return mLostPackets;
@@ -1575,6 +2192,10 @@ float RTP::CalculateClockRateFactor()
         case AV_CODEC_ID_VP8:
             tResult = 1; //TODO
             break;
+        case AV_CODEC_ID_VP9:
+        case AV_CODEC_ID_AV1:
+            tResult = 90;
+            break;
 //            case AV_CODEC_ID_MPEG2TS:
 //            case AV_CODEC_ID_VORBIS:
         default:
@@ -1632,6 +2253,8 @@ bool RTP::ReceivedCorrectPayload(unsigned int pType)
                 case AV_CODEC_ID_MPEG4:
                 case AV_CODEC_ID_THEORA:
                 case AV_CODEC_ID_VP8:
+                case AV_CODEC_ID_VP9:
+                case AV_CODEC_ID_AV1:
     //            case AV_CODEC_ID_MPEG2TS:
     //            case AV_CODEC_ID_VORBIS:
                                 if (pType >= 96)
@@ -1684,6 +2307,8 @@ bool RTP::RtpParse(char *&pData, int &pDataSize, bool &pIsLastFragment, enum Rtc
             case AV_CODEC_ID_MPEG4:
             case AV_CODEC_ID_THEORA:
             case AV_CODEC_ID_VP8:
+            case AV_CODEC_ID_VP9:
+            case AV_CODEC_ID_AV1:
 //            case AV_CODEC_ID_MPEG2TS:
 //            case AV_CODEC_ID_VORBIS:
                     break;
@@ -2094,6 +2719,9 @@ bool RTP::RtpParse(char *&pData, int &pDataSize, bool &pIsLastFragment, enum Rtc
     HEVCHeader* tHEVCHeader = (HEVCHeader*)pData;
     THEORAHeader* tTHEORAHeader = (THEORAHeader*)pData;
     VP8Header* tVP8Header = (VP8Header*)pData;
+    VP9Header* tVP9Header = (VP9Header*)pData;
+    bool tVP9FrameStart = false;
+    uint8_t tAV1AggregationHeader = 0;
     /********
      *  H.261/H.263 parsing
      ********/
@@ -2105,11 +2733,56 @@ bool RTP::RtpParse(char *&pData, int &pDataSize, bool &pIsLastFragment, enum Rtc
     {
             // audio
             case AV_CODEC_ID_AMR_NB:
-                            #ifdef RTP_DEBUG_PACKET_DECODER
-                                LOG(LOG_VERBOSE, "#################### AMR-NB header #######################");
-                                LOG(LOG_VERBOSE, "No additional information");//TODO
-                            #endif
-                            mIntermediateFragment = false;//TODO
+                            {
+                                // octet-aligned payload (rfc 3267, 4.4): CMR, table of contents and the speech frames of one or more frames
+                                // => converted in-place to the storage format (rfc 3267, 5.1) which the decoder expects: each speech frame is preceded by its TOC entry
+                                static const int sAmrNbFrameSizes[16] = {12, 13, 15, 17, 19, 20, 26, 31, 5, 0, 0, 0, 0, 0, 0, 0};
+                                char *tPayloadEnd = tRtpPacketStart + pDataSize;
+                                char tToc[32]; // up to 640 ms
+                                int tFrames = 0;
+
+                                // read the table of contents, the F bit signals further entries
+                                char *tPos = pData + 1;
+                                while ((tPos < tPayloadEnd) && (tFrames < (int)sizeof(tToc)))
+                                {
+                                    tToc[tFrames++] = *tPos;
+                                    if ((*tPos++ & 0x80) == 0)
+                                        break;
+                                }
+                                if ((tFrames > 0) && (tToc[tFrames - 1] & 0x80))
+                                {
+                                    LOG(LOG_WARN, "AMR-NB payload has an invalid or too long table of contents, ignoring it");
+                                    tFrames = 0;
+                                }
+
+                                // move each speech frame behind its TOC entry
+                                char *tOutput = pData + 1;
+                                for (int i = 0; i < tFrames; i++)
+                                {
+                                    int tFrameSize = sAmrNbFrameSizes[(tToc[i] >> 3) & 0x0F];
+                                    if (tPos + tFrameSize > tPayloadEnd)
+                                    {
+                                        LOG(LOG_WARN, "AMR-NB payload is truncated, ignoring %d of %d frames", tFrames - i, tFrames);
+                                        break;
+                                    }
+                                    *tOutput++ = tToc[i] & 0x7C;
+                                    memmove(tOutput, tPos, tFrameSize);
+                                    tOutput += tFrameSize;
+                                    tPos += tFrameSize;
+                                }
+
+                                #ifdef RTP_DEBUG_PACKET_DECODER
+                                    LOG(LOG_VERBOSE, "#################### AMR-NB header #######################");
+                                    LOG(LOG_VERBOSE, "CMR: %u", ((unsigned char)*pData) >> 4);
+                                    LOG(LOG_VERBOSE, "Frames: %d", tFrames);
+                                #endif
+
+                                // skip the CMR and cut the converted payload
+                                pData++;
+                                pDataSize = tOutput - tRtpPacketStart;
+
+                                mIntermediateFragment = false;
+                            }
                             break;
             case AV_CODEC_ID_PCM_ALAW:
                             #ifdef RTP_DEBUG_PACKET_DECODER
@@ -2854,6 +3527,88 @@ bool RTP::RtpParse(char *&pData, int &pDataSize, bool &pIsLastFragment, enum Rtc
                                 LOG(LOG_VERBOSE, "Start of partition: %d", tVP8Header->S);
                             #endif
                             break;
+            case AV_CODEC_ID_VP9:
+                            {
+                                char *tPayloadEnd = tRtpPacketStart + pDataSize;
+
+                                pData++; // payload descriptor = 1 byte
+
+                                // do we have a picture ID? (7 or 15 bits)
+                                if ((tVP9Header->I) && (pData < tPayloadEnd))
+                                    pData += (*pData & 0x80) ? 2 : 1;
+
+                                // do we have layer indices? (followed by TL0PICIDX in non-flexible mode)
+                                if (tVP9Header->L)
+                                    pData += (tVP9Header->F) ? 1 : 2;
+
+                                // do we have reference indices? (flexible mode, the N bit signals a further entry)
+                                if ((tVP9Header->F) && (tVP9Header->P))
+                                {
+                                    for (int i = 0; (i < 3) && (pData < tPayloadEnd); i++)
+                                    {
+                                        if ((*pData++ & 0x01) == 0)
+                                            break;
+                                    }
+                                }
+
+                                // do we have a scalability structure?
+                                if ((tVP9Header->V) && (pData < tPayloadEnd))
+                                {
+                                    int tSpatialLayers = ((*pData >> 5) & 0x07) + 1;
+                                    bool tResolutionsPresent = (*pData & 0x10);
+                                    bool tPictureGroupsPresent = (*pData & 0x08);
+                                    pData++;
+
+                                    if (tResolutionsPresent)
+                                    {
+                                        for (int i = 0; (i < tSpatialLayers) && (pData + 4 <= tPayloadEnd); i++)
+                                        {// the last one belongs to the highest spatial layer
+                                            mVP9ResX = (((uint8_t)pData[0]) << 8) | (uint8_t)pData[1];
+                                            mVP9ResY = (((uint8_t)pData[2]) << 8) | (uint8_t)pData[3];
+                                            pData += 4;
+                                        }
+                                    }
+                                    if ((tPictureGroupsPresent) && (pData < tPayloadEnd))
+                                    {
+                                        int tPictureGroups = (uint8_t)*pData;
+                                        pData++;
+                                        for (int i = 0; (i < tPictureGroups) && (pData < tPayloadEnd); i++)
+                                        {
+                                            int tReferences = (*pData >> 2) & 0x03;
+                                            pData += 1 + tReferences;
+                                        }
+                                    }
+                                }
+
+                                // the E bit marks the end of a frame, the marker bit would mark the end of a picture with all its spatial layers
+                                mIntermediateFragment = !tVP9Header->E;
+                                tVP9FrameStart = tVP9Header->B;
+
+                                #ifdef RTP_DEBUG_PACKET_DECODER
+                                    LOG(LOG_VERBOSE, "##################### VP9 header ########################");
+                                    LOG(LOG_VERBOSE, "Picture ID present: %d", tVP9Header->I);
+                                    LOG(LOG_VERBOSE, "Inter-picture predicted: %d", tVP9Header->P);
+                                    LOG(LOG_VERBOSE, "Layer indices present: %d", tVP9Header->L);
+                                    LOG(LOG_VERBOSE, "Flexible mode: %d", tVP9Header->F);
+                                    LOG(LOG_VERBOSE, "Start of frame: %d", tVP9Header->B);
+                                    LOG(LOG_VERBOSE, "End of frame: %d", tVP9Header->E);
+                                    LOG(LOG_VERBOSE, "Scalability structure: %d (resolution: %d*%d)", tVP9Header->V, mVP9ResX, mVP9ResY);
+                                #endif
+                            }
+                            break;
+            case AV_CODEC_ID_AV1:
+                            // the OBU elements are parsed during the reassembly of the temporal unit
+                            tAV1AggregationHeader = (uint8_t)*pData;
+                            pData += RTP_AV1_AGGREGATION_HEADER_SIZE;
+
+                            #ifdef RTP_DEBUG_PACKET_DECODER
+                                LOG(LOG_VERBOSE, "##################### AV1 header ########################");
+                                LOG(LOG_VERBOSE, "Continued OBU: %d", (tAV1AggregationHeader >> 7) & 0x01);
+                                LOG(LOG_VERBOSE, "Continuing OBU: %d", (tAV1AggregationHeader >> 6) & 0x01);
+                                LOG(LOG_VERBOSE, "OBU elements: %d", (tAV1AggregationHeader >> 4) & 0x03);
+                                LOG(LOG_VERBOSE, "New coded video sequence: %d", (tAV1AggregationHeader >> 3) & 0x01);
+                            #endif
+                            break;
 //            case AV_CODEC_ID_MPEG2TS:
 //            case AV_CODEC_ID_VORBIS:
             default:
@@ -2908,6 +3663,281 @@ bool RTP::RtpParse(char *&pData, int &pDataSize, bool &pIsLastFragment, enum Rtc
     // return if packet contains the last fragment of the current frame
     pIsLastFragment = !mIntermediateFragment;
 
+    // VP9/AV1: the demuxers need the size of each frame in front of its data, hence we deliver entire frames
+    if (!pLoggingOnly)
+    {
+        if (mStreamCodecID == AV_CODEC_ID_VP9)
+            return RtpReassembleVP9Frame(pData, pDataSize, tVP9FrameStart, pIsLastFragment);
+        if (mStreamCodecID == AV_CODEC_ID_AV1)
+            return RtpReassembleAV1TemporalUnit(pData, pDataSize, tAV1AggregationHeader, pIsLastFragment);
+    }
+
+    return true;
+}
+
+// a lost packet invalidates the frame which is currently reassembled, the loss itself was already announced by the RTP parser
+bool RTP::RtpReassemblyLostFragment()
+{
+    bool tResult = ((mFrameReassemblyLastSequenceNumber > 0 /* ignore stream resets */) && (mRemoteSequenceNumber != mFrameReassemblyLastSequenceNumber + 1));
+
+    mFrameReassemblyLastSequenceNumber = mRemoteSequenceNumber;
+
+    return tResult;
+}
+
+bool RTP::RtpReassembleVP9Frame(char *&pData, int &pDataSize, bool pFrameStart, bool &pIsLastFragment)
+{
+    bool tLastFragment = pIsLastFragment;
+
+    // only complete frames are signaled to the caller
+    pIsLastFragment = false;
+
+    if (mFrameReassemblyBuffer == NULL)
+    {
+        mFrameReassemblyBuffer = (char*)malloc(RTP_FRAME_REASSEMBLY_BUFFER_SIZE);
+        if (mFrameReassemblyBuffer == NULL)
+        {
+            LOG(LOG_ERROR, "Error when allocating memory for VP9 frame reassembly");
+            pDataSize = 0;
+            return false;
+        }
+    }
+
+    // the frame starts behind the space for the IVF headers
+    char *tFrame = mFrameReassemblyBuffer + RTP_IVF_FILE_HEADER_SIZE + RTP_IVF_FRAME_HEADER_SIZE;
+
+    if (RtpReassemblyLostFragment())
+    {
+        if (mFrameReassemblySize > 0)
+            LOG(LOG_WARN, "Dropping incomplete VP9 frame of %d bytes", mFrameReassemblySize);
+        mFrameReassemblySize = 0;
+        mFrameReassemblyDropping = true;
+    }
+    if (pFrameStart)
+    {
+        if (mFrameReassemblySize > 0)
+            LOG(LOG_WARN, "VP9 frame started before the last one was complete, dropping %d bytes", mFrameReassemblySize);
+        mFrameReassemblySize = 0;
+        mFrameReassemblyDropping = false;
+    }else if (mFrameReassemblySize == 0)
+    {// we missed the start of this frame
+        mFrameReassemblyDropping = true;
+    }
+
+    if (mFrameReassemblyDropping)
+    {
+        pDataSize = 0;
+        return true;
+    }
+
+    if (RTP_IVF_FILE_HEADER_SIZE + RTP_IVF_FRAME_HEADER_SIZE + mFrameReassemblySize + pDataSize > RTP_FRAME_REASSEMBLY_BUFFER_SIZE)
+    {
+        LOG(LOG_ERROR, "VP9 frame exceeds the reassembly buffer of %d bytes, dropping it", RTP_FRAME_REASSEMBLY_BUFFER_SIZE);
+        mFrameReassemblySize = 0;
+        mFrameReassemblyDropping = true;
+        pDataSize = 0;
+        return true;
+    }
+
+    // store the fragment
+    memcpy(tFrame + mFrameReassemblySize, pData, pDataSize);
+    mFrameReassemblySize += pDataSize;
+    pDataSize = 0;
+
+    if (!tLastFragment)
+        return true;
+
+    // IVF frame header: frame size and PTS
+    char *tFrameHeader = tFrame - RTP_IVF_FRAME_HEADER_SIZE;
+    WriteLittleEndian(tFrameHeader, mFrameReassemblySize, 4);
+    WriteLittleEndian(tFrameHeader + 4, mRemoteTimestamp, 8);
+    pData = tFrameHeader;
+    pDataSize = RTP_IVF_FRAME_HEADER_SIZE + mFrameReassemblySize;
+
+    // IVF file header in front of the first frame
+    if (!mVP9IvfFileHeaderDelivered)
+    {
+        char *tFileHeader = mFrameReassemblyBuffer;
+        memcpy(tFileHeader, "DKIF", 4);
+        WriteLittleEndian(tFileHeader + 4, 0, 2); // version
+        WriteLittleEndian(tFileHeader + 6, RTP_IVF_FILE_HEADER_SIZE, 2);
+        memcpy(tFileHeader + 8, "VP90", 4);
+        WriteLittleEndian(tFileHeader + 12, mVP9ResX, 2);
+        WriteLittleEndian(tFileHeader + 14, mVP9ResY, 2);
+        WriteLittleEndian(tFileHeader + 16, 90000, 4); // time base: RTP clock rate
+        WriteLittleEndian(tFileHeader + 20, 1, 4);
+        WriteLittleEndian(tFileHeader + 24, 0, 4); // frame count is unknown
+        WriteLittleEndian(tFileHeader + 28, 0, 4); // unused
+        pData = tFileHeader;
+        pDataSize += RTP_IVF_FILE_HEADER_SIZE;
+        mVP9IvfFileHeaderDelivered = true;
+    }
+
+    mFrameReassemblySize = 0;
+    pIsLastFragment = true;
+
+    return true;
+}
+
+// stores an OBU in the low overhead bitstream format, i.e., with size field
+bool RTP::RtpReassembleAV1Obu(const char *pObu, int pObuSize)
+{
+    uint8_t tObuHeader = (uint8_t)pObu[0];
+    int tObuHeaderSize = AV1_OBU_HAS_EXTENSION(tObuHeader) ? 2 : 1;
+
+    if (pObuSize < tObuHeaderSize)
+    {
+        LOG(LOG_WARN, "Invalid AV1 OBU of %d bytes", pObuSize);
+        return false;
+    }
+
+    // temporal delimiters are inserted by ourself, tile lists aren't allowed
+    if ((AV1_OBU_TYPE(tObuHeader) == AV1_OBU_TEMPORAL_DELIMITER) || (AV1_OBU_TYPE(tObuHeader) == AV1_OBU_TILE_LIST))
+        return true;
+
+    if (mFrameReassemblySize + pObuSize + 8 /* LEB128 */ > RTP_FRAME_REASSEMBLY_BUFFER_SIZE)
+    {
+        LOG(LOG_ERROR, "AV1 temporal unit exceeds the reassembly buffer of %d bytes", RTP_FRAME_REASSEMBLY_BUFFER_SIZE);
+        return false;
+    }
+
+    char *tOutput = mFrameReassemblyBuffer + mFrameReassemblySize;
+    if (AV1_OBU_HAS_SIZE_FIELD(tObuHeader))
+    {// the sender kept the size field
+        memcpy(tOutput, pObu, pObuSize);
+        mFrameReassemblySize += pObuSize;
+    }else
+    {
+        int tObuPayloadSize = pObuSize - tObuHeaderSize;
+        tOutput[0] = tObuHeader | 0x02;
+        if (tObuHeaderSize > 1)
+            tOutput[1] = pObu[1];
+        int tOutputHeaderSize = tObuHeaderSize + WriteLeb128((uint8_t*)tOutput + tObuHeaderSize, tObuPayloadSize);
+        memcpy(tOutput + tOutputHeaderSize, pObu + tObuHeaderSize, tObuPayloadSize);
+        mFrameReassemblySize += tOutputHeaderSize + tObuPayloadSize;
+    }
+
+    return true;
+}
+
+bool RTP::RtpReassembleAV1TemporalUnit(char *&pData, int &pDataSize, uint8_t pAggregationHeader, bool &pIsLastFragment)
+{
+    bool tLastFragment = pIsLastFragment;
+    bool tContinuedObu = (pAggregationHeader & 0x80);
+    bool tContinuingObu = (pAggregationHeader & 0x40);
+    int tElementCount = (pAggregationHeader >> 4) & 0x03;
+
+    // only complete temporal units are signaled to the caller
+    pIsLastFragment = false;
+
+    if (mFrameReassemblyBuffer == NULL)
+        mFrameReassemblyBuffer = (char*)malloc(RTP_FRAME_REASSEMBLY_BUFFER_SIZE);
+    if (mAV1ObuBuffer == NULL)
+        mAV1ObuBuffer = (char*)malloc(RTP_FRAME_REASSEMBLY_BUFFER_SIZE);
+    if ((mFrameReassemblyBuffer == NULL) || (mAV1ObuBuffer == NULL))
+    {
+        LOG(LOG_ERROR, "Error when allocating memory for AV1 temporal unit reassembly");
+        pDataSize = 0;
+        return false;
+    }
+
+    if (RtpReassemblyLostFragment())
+    {
+        if ((mFrameReassemblySize > 0) || (mAV1ObuSize > 0))
+            LOG(LOG_WARN, "Dropping incomplete AV1 temporal unit of %d bytes", mFrameReassemblySize + mAV1ObuSize);
+        mFrameReassemblySize = 0;
+        mAV1ObuSize = 0;
+        mFrameReassemblyDropping = true;
+    }
+
+    if (!mFrameReassemblyDropping)
+    {
+        // each temporal unit starts with a temporal delimiter
+        if (mFrameReassemblySize == 0)
+        {
+            mFrameReassemblyBuffer[0] = (AV1_OBU_TEMPORAL_DELIMITER << 3) | 0x02 /* with size field */;
+            mFrameReassemblyBuffer[1] = 0;
+            mFrameReassemblySize = 2;
+        }
+
+        const uint8_t *tElement = (const uint8_t*)pData;
+        const uint8_t *tPayloadEnd = tElement + pDataSize;
+        int tElementIndex = 0;
+        while ((tElement < tPayloadEnd) && (!mFrameReassemblyDropping))
+        {
+            tElementIndex++;
+
+            // the last of W elements has no length field
+            uint64_t tElementSize = tPayloadEnd - tElement;
+            if ((tElementCount == 0) || (tElementIndex < tElementCount))
+            {
+                int tLengthFieldSize = ReadLeb128(tElement, tPayloadEnd, tElementSize);
+                if ((tLengthFieldSize == 0) || (tElementSize > (uint64_t)(tPayloadEnd - tElement - tLengthFieldSize)))
+                {
+                    LOG(LOG_WARN, "Invalid AV1 OBU element length, dropping the temporal unit");
+                    mFrameReassemblyDropping = true;
+                    break;
+                }
+                tElement += tLengthFieldSize;
+            }
+            bool tFragmentedObu = ((tElementIndex == 1) && (tContinuedObu));
+            bool tObuContinues = ((tElement + tElementSize >= tPayloadEnd) && (tContinuingObu));
+
+            if ((tFragmentedObu) && (mAV1ObuSize == 0))
+            {
+                LOG(LOG_WARN, "Start of fragmented AV1 OBU is missing, dropping the temporal unit");
+                mFrameReassemblyDropping = true;
+                break;
+            }
+            if ((!tFragmentedObu) && (mAV1ObuSize > 0))
+            {
+                LOG(LOG_WARN, "Fragmented AV1 OBU wasn't continued, dropping %d bytes", mAV1ObuSize);
+                mAV1ObuSize = 0;
+            }
+
+            if ((tFragmentedObu) || (tObuContinues))
+            {// collect the fragments of the OBU
+                if (mAV1ObuSize + tElementSize > RTP_FRAME_REASSEMBLY_BUFFER_SIZE)
+                {
+                    LOG(LOG_ERROR, "AV1 OBU exceeds the reassembly buffer of %d bytes", RTP_FRAME_REASSEMBLY_BUFFER_SIZE);
+                    mFrameReassemblyDropping = true;
+                    break;
+                }
+                memcpy(mAV1ObuBuffer + mAV1ObuSize, tElement, tElementSize);
+                mAV1ObuSize += tElementSize;
+                if (!tObuContinues)
+                {
+                    if (!RtpReassembleAV1Obu(mAV1ObuBuffer, mAV1ObuSize))
+                        mFrameReassemblyDropping = true;
+                    mAV1ObuSize = 0;
+                }
+            }else
+            {
+                if ((tElementSize > 0) && (!RtpReassembleAV1Obu((const char*)tElement, tElementSize)))
+                    mFrameReassemblyDropping = true;
+            }
+
+            tElement += tElementSize;
+        }
+    }
+    pDataSize = 0;
+
+    if (!tLastFragment)
+        return true;
+
+    // end of the temporal unit
+    if ((!mFrameReassemblyDropping) && (mFrameReassemblySize > 2 /* more than the temporal delimiter */))
+    {
+        pData = mFrameReassemblyBuffer;
+        pDataSize = mFrameReassemblySize;
+        pIsLastFragment = true;
+    }
+    if (mAV1ObuSize > 0)
+        LOG(LOG_WARN, "AV1 temporal unit ended with an incomplete OBU, dropping %d bytes", mAV1ObuSize);
+    mFrameReassemblySize = 0;
+    mAV1ObuSize = 0;
+    mFrameReassemblyDropping = false;
+
     return true;
 }
 
@@ -2924,6 +3954,8 @@ bool RTP::RtpParse(char *&pData, int &pDataSize, bool &pIsLastFragment, enum Rtc
  *        theora                    122 (HC internal standard)
  *        vp8                       123 (HC internal standard)
  *        hevc/265                  124 (HC internal standard)
+ *        vp9                       125 (HC internal standard)
+ *        av1                       126 (HC internal standard)
  *
  *
  *  Audio codec name to RTP id mapping:
@@ -2961,6 +3993,10 @@ unsigned int RTP::GetPreferedRTPPayloadIDForCodec(std::string pName)
         tResult = 123;
     if ((pName == "h265") || (pName == "hevc"))
         tResult = 124;
+    if ((pName == "vp9") || (pName == "libvpx-vp9") /* delivered from AVCodec->name */)
+        tResult = 125;
+    if ((pName == "av1") || (pName == "libaom-av1") || (pName == "libsvtav1") || (pName == "librav1e") /* delivered from AVCodec->name */)
+        tResult = 126;
 
     //audio
     if (pName == "ulaw")
@@ -3020,6 +4056,12 @@ string RTP::GetCodecFromPreferedPayloadID(int pId)
         case 124:
                 tResult = "hevc/h265";
                 break;
+        case 125:
+                tResult = "vp9";
+                break;
+        case 126:
+                tResult = "av1";
+                break;
 
         //audio
         case 0:
@@ -3066,6 +4108,38 @@ string RTP::GetCodecFromPreferedPayloadID(int pId)
     return tResult;
 }
 
+enum AVMediaType RTP::GetMediaTypeFromPreferedPayloadID(int pId)
+{
+    enum AVMediaType tResult = AVMEDIA_TYPE_UNKNOWN;
+
+    switch(pId)
+    {
+        //video
+        case 31:
+        case 32:
+        case 34:
+        case 118 ... 126:
+                tResult = AVMEDIA_TYPE_VIDEO;
+                break;
+
+        //audio
+        case 0:
+        case 3:
+        case 8 ... 11:
+        case 14:
+        case 100:
+        case 101:
+                tResult = AVMEDIA_TYPE_AUDIO;
+                break;
+
+        //RTCP and dynamic payload types can't be assigned to a media type
+        default:
+                break;
+    }
+
+    return tResult;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////// RTCP handling ///////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
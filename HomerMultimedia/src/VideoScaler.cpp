@@ -31,6 +31,7 @@
 #include <RTP.h>
 #include <Logger.h>
 #include <MediaSource.h>
+#include <MediaMemoryBudget.h>
 
 #include <string>
 #include <stdint.h>
@@ -74,6 +75,7 @@ void VideoScaler::StartScaler(int pInputQueueSize, int pSourceResX, int pSourceR
     int tInputBufferSize = avpicture_get_size(mSourcePixelFormat, mSourceResX, mSourceResY) + FF_INPUT_BUFFER_PADDING_SIZE;
     //HINT: we have to allocate input FIFO here to make sure we can force a return from a read request inside StopScaler(), StartScaler() and StopScaler() should be called from the same thread/context!
     mInputFifo = new MediaFifo(mQueueSize, tInputBufferSize, "VIDEO-ScalerInput/" + mName);
+    SVC_MEDIA_MEMORY_BUDGET.AssignFifo(mInputFifo, mMediaSource);
 
     // start scaler main loop
     StartThread();
@@ -274,6 +276,7 @@ void* VideoScaler::Run(void* pArgs)
 
     LOG(LOG_VERBOSE, "..creating %s video scaler output FIFO", mName.c_str());
     mOutputFifo = new MediaFifo(mQueueSize, tOutputBufferSize, "VIDEO-ScalerOutput/" + mName);
+    SVC_MEDIA_MEMORY_BUDGET.AssignFifo(mOutputFifo, mMediaSource);
 
     mChunkNumber = 0;
     mScalerNeeded = true;
@@ -391,10 +394,13 @@ void* VideoScaler::Run(void* pArgs)
                         #endif
                         if (tCurrentChunkSize <= mOutputFifo->GetEntrySize())
                         {
+                            // the filter pipeline writes the chunk into the output FIFO after its filters finished, otherwise we write it here
+                            bool tDelivered = false;
                             if(mMediaSource != NULL)
-                                mMediaSource->RelayChunkToMediaFilters((char*)tOutputBuffer, tCurrentChunkSize, tInputFrameTimestamp);
+                                tDelivered = mMediaSource->RelayChunkToMediaFilters((char*)tOutputBuffer, tCurrentChunkSize, tInputFrameTimestamp, false, mOutputFifo);
 
-                            mOutputFifo->WriteFifo((char*)tOutputBuffer, tCurrentChunkSize, tInputFrameTimestamp);
+                            if (!tDelivered)
+                                mOutputFifo->WriteFifo((char*)tOutputBuffer, tCurrentChunkSize, tInputFrameTimestamp);
                             #ifdef VS_DEBUG_PACKETS
                                 LOG(LOG_VERBOSE, "SCALER-successful scaler loop");
                             #endif
@@ -410,8 +416,9 @@ void* VideoScaler::Run(void* pArgs)
                     {
                         LOG(LOG_VERBOSE, "Forwarding the empty packet from the scaler input FIFO to the scaler output FIFO");
 
-                        // forward the empty packet to the output FIFO
-                        mOutputFifo->WriteFifo(NULL, 0, 0);
+                        // forward the empty packet to the output FIFO, behind the chunks which are still in the filter pipeline
+                        if ((mMediaSource == NULL) || (!mMediaSource->RelayChunkToMediaFilters(NULL, 0, 0, false, mOutputFifo)))
+                            mOutputFifo->WriteFifo(NULL, 0, 0);
 
                         LOG(LOG_VERBOSE, "..forwarded the empty chunk from input to output");
                     }else
@@ -442,6 +449,10 @@ void* VideoScaler::Run(void* pArgs)
 
     LOG(LOG_VERBOSE, "Video scaler left thread main loop");
 
+    // the filter pipeline mustn't deliver into the output FIFO anymore
+    if (mMediaSource != NULL)
+        mMediaSource->mMediaFilterPipeline.CancelDelivery(mOutputFifo);
+
     mOutputFifoMutex.lock();
     delete mOutputFifo;
     mOutputFifo = NULL;
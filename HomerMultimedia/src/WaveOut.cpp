@@ -27,6 +27,7 @@
 #include <ProcessStatisticService.h>
 #include <WaveOut.h>
 #include <Logger.h>
+#include <HBTime.h>
 
 namespace Homer { namespace Multimedia {
 
@@ -44,13 +45,16 @@ WaveOut::WaveOut(string pName):
     mDesiredDevice = "";
     mCurrentDevice = "";
     mCurrentDeviceName = "";
+    mSampleRate = 44100;
     mAudioChannels = 2;
     mVolume = 100;
-    mFilePlaybackSource = NULL;
     mSampleFifo = NULL;
     mPlaybackGaps = 0;
     mPlaybackChunks = 0;
     mFilePlaybackNeeded = false;
+    mSoundsStopCounter = 0;
+    mSoundsIdleStop = false;
+    mLastExternalChunkTime = 0;
 
     LOG(LOG_VERBOSE, "Going to allocate playback FIFO");
     mPlaybackFifo = new MediaFifo(MEDIA_SOURCE_SAMPLES_PLAYBACK_FIFO_SIZE, MEDIA_SOURCE_SAMPLES_BUFFER_SIZE, "WaveOut");
@@ -123,7 +127,16 @@ void WaveOut::Stop()
 {
     LOG(LOG_VERBOSE, "Mark stream as stopped");
     mPlaybackStopped = true;
-    mFilePlaybackLoops = 0;
+
+    // an explicit stop also ends all notification sounds
+    mSoundsMutex.lock();
+    if (!mSoundsIdleStop)
+    {
+        mPendingSounds.clear();
+        mActiveSounds.clear();
+        mSoundsStopCounter++;
+    }
+    mSoundsMutex.unlock();
 }
 
 bool WaveOut::Play()
@@ -147,14 +160,10 @@ bool WaveOut::IsPlaying()
     if (!mPlaybackStopped)
         tResult = true;
 
-    mOpenNewFile.lock();
-
     // we were triggered to play a new file?
-    if ((mOpenNewFileAsap) || (mFilePlaybackLoops > 0))
+    if (HasSounds())
         tResult = true;
 
-    mOpenNewFile.unlock();
-
      return tResult;
 }
 
@@ -183,24 +192,46 @@ bool WaveOut::PlayFile(string pFileName, int pLoops)
         return false;
     }
 
-    mOpenNewFile.lock();
+    if (pLoops < 1)
+        pLoops = 1;
 
-    mFilePlaybackLoops = pLoops;
-    mFilePlaybackFileName = pFileName;
-    mOpenNewFileAsap = true;
+    // the sound is only queued here, decoding and mixing is done by the playback thread
+    WaveOutSound tSound;
+    tSound.FileName = pFileName;
+    tSound.Sound = NULL;
+    tSound.Position = 0;
+    tSound.Loops = pLoops;
+    tSound.StartTime = Time::GetTimeStamp();
+
+    mSoundsMutex.lock();
 
-    mOpenNewFile.unlock();
+    if (mPendingSounds.size() >= WAVEOUT_MAX_PENDING_SOUNDS)
+    {
+        mSoundsMutex.unlock();
+        LOG(LOG_WARN, "Too many pending sounds, ignoring playback of %s", pFileName.c_str());
+        return true;
+    }
+    mFilePlaybackFileName = pFileName;
+    mPendingSounds.push_back(tSound);
 
     if (!mFilePlaybackNeeded)
     {
+        mFilePlaybackNeeded = true;
+
+        mSoundsMutex.unlock();
+
         // start the playback thread for the first time
         LOG(LOG_VERBOSE, "Starting thread for file based audio playback");
         StartThread();
     }else
     {
         // send wake up
-        LOG(LOG_VERBOSE, "Sending thread for file based audio playback a wake up signal");
+        #ifdef WO_DEBUG_FILE
+            LOG(LOG_VERBOSE, "Sending thread for file based audio playback a wake up signal");
+        #endif
         mFilePlaybackCondition.Signal();
+
+        mSoundsMutex.unlock();
     }
 
     return true;
@@ -280,6 +311,59 @@ void WaveOut::AdjustVolume(void *pBuffer, int pBufferSize)
     }
 }
 
+void WaveOut::MixSounds(char *pChunkBuffer, int pChunkSize)
+{
+    WaveOutSounds::iterator tIt;
+    short int *tSamples = (short int*)pChunkBuffer;
+    int tSamplesCount = pChunkSize / 2;
+
+    mSoundsMutex.lock();
+
+    tIt = mActiveSounds.begin();
+    while (tIt != mActiveSounds.end())
+    {
+        short int *tSoundSamples = (short int*)tIt->Sound->Buffer;
+        int tSoundSamplesCount = tIt->Sound->BufferSize / 2;
+        int tPos = 0;
+
+        while ((tPos < tSamplesCount) && (tIt->Loops > 0))
+        {
+            int tCount = tSamplesCount - tPos;
+            if (tCount > tSoundSamplesCount - tIt->Position)
+                tCount = tSoundSamplesCount - tIt->Position;
+
+            for (int i = 0; i < tCount; i++)
+            {
+                int tNewSample = (int)tSamples[tPos + i] + (int)tSoundSamples[tIt->Position + i];
+                if (tNewSample < -32767)
+                    tNewSample = -32767;
+                if (tNewSample >  32767)
+                    tNewSample =  32767;
+                tSamples[tPos + i] = (short int)tNewSample;
+            }
+            tPos += tCount;
+            tIt->Position += tCount;
+
+            // end of sound reached?
+            if (tIt->Position >= tSoundSamplesCount)
+            {
+                tIt->Position = 0;
+                tIt->Loops--;
+                #ifdef WO_DEBUG_FILE
+                    LOG(LOG_VERBOSE, "End of sound %s reached, remaining loops: %d", tIt->FileName.c_str(), tIt->Loops);
+                #endif
+            }
+        }
+
+        if (tIt->Loops <= 0)
+            tIt = mActiveSounds.erase(tIt);
+        else
+            tIt++;
+    }
+
+    mSoundsMutex.unlock();
+}
+
 void WaveOut::StopFilePlayback()
 {
     // terminate possibly running main loop for file based playback
@@ -287,8 +371,10 @@ void WaveOut::StopFilePlayback()
     {
         LOG(LOG_VERBOSE, "Stopping file based playback");
 
+        mSoundsMutex.lock();
         mFilePlaybackNeeded = false;
         mFilePlaybackCondition.Signal();
+        mSoundsMutex.unlock();
         LOG(LOG_VERBOSE, "..loopback wake-up signal sent");
         StopThread(3000);
         LOG(LOG_VERBOSE, "..playback thread stopped");
@@ -304,45 +390,6 @@ void WaveOut::AssignThreadName()
     }
 }
 
-bool WaveOut::DoOpenNewFile()
-{
-    bool tResult = true;
-
-    LOG(LOG_VERBOSE, "Doing DoOpenNewFile() now..");
-    LOG(LOG_VERBOSE, "Try to play file: %s", mFilePlaybackFileName.c_str());
-
-    mOpenNewFile.lock();
-
-    mOpenNewFileAsap = false;
-
-    if (mFilePlaybackSource != NULL)
-    {
-        Stop();
-        mFilePlaybackSource->CloseGrabDevice();
-        delete mFilePlaybackSource;
-    }
-
-    LOG(LOG_VERBOSE, "..clearing FIFO buffer");
-    mPlaybackFifo->ClearFifo();
-
-    mFilePlaybackSource = new MediaSourceFile(mFilePlaybackFileName);
-    if (!mFilePlaybackSource->OpenAudioGrabDevice())
-    {
-        LOG(LOG_ERROR, "Couldn't open audio file for playback");
-        delete mFilePlaybackSource;
-        mFilePlaybackSource = NULL;
-        tResult = false;
-    }else
-    {
-        SVC_PROCESS_STATISTIC.AssignThreadName("Audio-Grabber(WAVEOUT)");
-
-        Play();
-    }
-
-    mOpenNewFile.unlock();
-    return tResult;
-}
-
 bool WaveOut::WriteChunk(void* pChunkBuffer, int pChunkSize)
 {
     mPlayMutex.lock();
@@ -371,7 +418,8 @@ bool WaveOut::WriteChunk(void* pChunkBuffer, int pChunkSize)
         }
     #endif
 
-    AdjustVolume(pChunkBuffer, pChunkSize);
+    // notification sounds are mixed into this stream from now on
+    mLastExternalChunkTime = Time::GetTimeStamp();
 
     #ifdef WOPA_DEBUG_PACKETS
         LOG(LOG_VERBOSE, "Got %d samples for audio output stream", pChunkSize / 4);
@@ -404,6 +452,8 @@ bool WaveOut::WriteChunk(void* pChunkBuffer, int pChunkSize)
                 LOG(LOG_VERBOSE, "Writing %d samples to audio output stream", tAudioBufferSize / (2 /* 16 bits per sample */ * mAudioChannels));
             #endif
 
+            MixSounds((char*)tAudioBuffer, tAudioBufferSize);
+            AdjustVolume(tAudioBuffer, tAudioBufferSize);
             DoWriteChunk((char*)tAudioBuffer, tAudioBufferSize);
 
             // log statistics about raw PCM audio data stream
@@ -415,7 +465,9 @@ bool WaveOut::WriteChunk(void* pChunkBuffer, int pChunkSize)
             LOG(LOG_VERBOSE, "Writing %d samples to audio output stream", pChunkSize / (2 /* 16 bits per sample */ * mAudioChannels));
         #endif
 
-            DoWriteChunk((char*)pChunkBuffer, pChunkSize);
+        MixSounds((char*)pChunkBuffer, pChunkSize);
+        AdjustVolume(pChunkBuffer, pChunkSize);
+        DoWriteChunk((char*)pChunkBuffer, pChunkSize);
 
         // log statistics about raw PCM audio data stream
         AnnouncePacket(pChunkSize);
@@ -430,91 +482,182 @@ void WaveOut::DoWriteChunk(char *pChunkBuffer, int pChunkSize)
     mPlaybackFifo->WriteFifo(pChunkBuffer, pChunkSize, ++mPlaybackChunks);
 }
 
-void* WaveOut::Run(void* pArgs)
+bool WaveOut::HasSounds()
 {
-    int tSamplesSize;
-    int tSampleNumber = -1, tLastSampleNumber = -1;
+    bool tResult;
 
-    mFilePlaybackNeeded = true;
+    mSoundsMutex.lock();
+    tResult = ((!mPendingSounds.empty()) || (!mActiveSounds.empty()));
+    mSoundsMutex.unlock();
 
-    LOG(LOG_VERBOSE, "Starting main loop for file based playback");
-    while(mFilePlaybackNeeded)
+    return tResult;
+}
+
+bool WaveOut::IsExternalStreamActive()
+{
+    return (Time::GetTimeStamp() - mLastExternalChunkTime < WAVEOUT_EXTERNAL_STREAM_TIMEOUT * 1000);
+}
+
+void WaveOut::StartPendingSounds()
+{
+    while (true)
     {
-        if (mOpenNewFileAsap)
-            DoOpenNewFile();
+        mSoundsMutex.lock();
+        if (mPendingSounds.empty())
+        {
+            mSoundsMutex.unlock();
+            break;
+        }
+        WaveOutSound tSound = mPendingSounds.front();
+        mPendingSounds.pop_front();
+        int64_t tStopCounter = mSoundsStopCounter;
+        mSoundsMutex.unlock();
+
+        // decodes the file only if it isn't cached yet
+        tSound.Sound = SVC_NOTIFICATION_SOUND_CACHE.GetSound(tSound.FileName, mSampleRate, mAudioChannels);
+        if (tSound.Sound == NULL)
+        {
+            LOG(LOG_ERROR, "Couldn't play sound file %s", tSound.FileName.c_str());
+            continue;
+        }
+
+        mSoundsMutex.lock();
 
-        if (mFilePlaybackSource != NULL)
+        // was the playback stopped in the meantime?
+        if (tStopCounter != mSoundsStopCounter)
         {
-            // get new samples from audio file
-            tSamplesSize = MEDIA_SOURCE_SAMPLES_MULTI_BUFFER_SIZE + FF_INPUT_BUFFER_PADDING_SIZE;
-            tSampleNumber = mFilePlaybackSource->GrabChunk(mFilePlaybackBuffer, tSamplesSize);
+            mSoundsMutex.unlock();
+            continue;
+        }
 
-            if ((tSampleNumber >= 0) && (!mPlaybackStopped))
+        // is the sound already playing?
+        WaveOutSounds::iterator tIt;
+        for (tIt = mActiveSounds.begin(); tIt != mActiveSounds.end(); tIt++)
+        {
+            if (tIt->Sound == tSound.Sound)
+                break;
+        }
+        if (tIt != mActiveSounds.end())
+        {
+            if (tSound.StartTime - tIt->StartTime < WAVEOUT_SOUND_MIN_INTERVAL * 1000)
             {
                 #ifdef WO_DEBUG_FILE
-                    LOG(LOG_VERBOSE, "Sending audio chunk %d of %d bytes from file to playback device", tSampleNumber, tSamplesSize);
+                    LOG(LOG_VERBOSE, "Ignoring repeated start of sound %s", tSound.FileName.c_str());
                 #endif
-
-                // wait
-                // HINT: we use 2 additional zero buffers after EOF was detected!
-                while ((GetQueueUsage() > MEDIA_SOURCE_SAMPLES_PLAYBACK_FIFO_SIZE - 4) && (MEDIA_SOURCE_SAMPLES_PLAYBACK_FIFO_SIZE > 4))
-                {
-                    #ifdef WO_DEBUG_FILE
-                        LOG(LOG_VERBOSE, "Playback FIFO is filled, waiting some time");
-                    #endif
-                    Thread::Suspend(10 * 1000); //TODO: use a condition here
-                }
-
-                WriteChunk(mFilePlaybackBuffer, tSamplesSize);
+            }else
+            {
+                // restart the sound
+                *tIt = tSound;
+            }
+        }else
+        {
+            if (mActiveSounds.size() >= WAVEOUT_MAX_SOUNDS)
+            {
+                LOG(LOG_VERBOSE, "Polyphony limit reached, dropping sound %s", mActiveSounds.front().FileName.c_str());
+                mActiveSounds.pop_front();
             }
+            mActiveSounds.push_back(tSound);
+        }
+
+        mSoundsMutex.unlock();
+    }
+}
+
+void* WaveOut::Run(void* pArgs)
+{
+    int64_t tChunkDuration = 1000000LL * MEDIA_SOURCE_SAMPLES_PER_BUFFER / mSampleRate; // in us
+    int64_t tNextChunkTime = 0;
 
-            // if we have reached EOF then we wait until next file is scheduled for playback
-            if (tSampleNumber == GRAB_RES_EOF)
+    SVC_PROCESS_STATISTIC.AssignThreadName("WaveOut-Sounds");
+
+    LOG(LOG_VERBOSE, "Starting main loop for file based playback");
+    while(mFilePlaybackNeeded)
+    {
+        if (!HasSounds())
+        {
+            // wait until last chunk is played
+            if ((!IsExternalStreamActive()) && (!mPlaybackStopped))
             {
-                // add 2 more zero buffers to audio output queue
-                char *tZeroBuffer = (char*)malloc(MEDIA_SOURCE_SAMPLES_BUFFER_SIZE);
-                memset(tZeroBuffer, 0, MEDIA_SOURCE_SAMPLES_BUFFER_SIZE);
-                WriteChunk(tZeroBuffer, MEDIA_SOURCE_SAMPLES_BUFFER_SIZE);
-                free(tZeroBuffer);
-
-                mFilePlaybackLoops--;
-
-                // should we loop the file?
-                if (mFilePlaybackLoops > 0)
-                {// repeat file
-                    LOG(LOG_VERBOSE, "Looping %s, remaining loops: %d", mFilePlaybackFileName.c_str(), mFilePlaybackLoops - 1);
-                    mFilePlaybackSource->Seek(0);
-                }else
-                {// passive waiting until next trigger is received
-                    // wait until last chunk is played
-                    LOG(LOG_VERBOSE, "EOF reached, waiting for playback end");
-                    while(mPlaybackFifo->GetUsage() > 0)
-                        Suspend(50 * 1000);
-
-                    // stop playback
-                    Stop();
-
-                    // wait for next trigger
-                    mFilePlaybackCondition.Wait();
-                    LOG(LOG_VERBOSE, "Continuing after last file based playback has finished");
-                    if ((!mOpenNewFileAsap) && (!mPlaybackStopped))
-                        LOG(LOG_ERROR, "Error in state machine of file based audio playback thread");
-                    Play();
-                }
+                LOG(LOG_VERBOSE, "End of sounds reached, waiting for playback end");
+                int64_t tRemainingTime = tNextChunkTime - Time::GetTimeStamp();
+                if (tRemainingTime > 0)
+                    Suspend(tRemainingTime);
+                while((mPlaybackFifo->GetUsage() > 0) && (!mPlaybackStopped))
+                    Suspend(50 * 1000);
+
+                // stop playback, this doesn't affect sounds which are started in the meantime
+                mSoundsMutex.lock();
+                mSoundsIdleStop = true;
+                mSoundsMutex.unlock();
+                Stop();
+                mSoundsMutex.lock();
+                mSoundsIdleStop = false;
+                mSoundsMutex.unlock();
             }
-        }else
+
+            // passive waiting until next trigger is received
+            mSoundsMutex.lock();
+            if ((mPendingSounds.empty()) && (mActiveSounds.empty()) && (mFilePlaybackNeeded))
+                mFilePlaybackCondition.Wait(&mSoundsMutex);
+            mSoundsMutex.unlock();
+            LOG(LOG_VERBOSE, "Continuing after last file based playback has finished");
+            continue;
+        }
+
+        StartPendingSounds();
+
+        // an external stream mixes the sounds itself
+        if (IsExternalStreamActive())
         {
-            // wait for next trigger
-            mFilePlaybackCondition.Wait();
-            LOG(LOG_VERBOSE, "Continuing after last file based playback was invalid");
+            Suspend(10 * 1000);
+            continue;
         }
+
+        if (!HasSounds())
+            continue;
+
+        if (mPlaybackStopped)
+        {
+            Play();
+            tNextChunkTime = 0;
+        }
+
+        // write only some chunks ahead of the real time
+        int64_t tNow = Time::GetTimeStamp();
+        if (tNextChunkTime < tNow)
+            tNextChunkTime = tNow;
+        if (tNextChunkTime - tNow > WAVEOUT_SOUND_PREBUFFER_CHUNKS * tChunkDuration)
+            Suspend(tNextChunkTime - tNow - WAVEOUT_SOUND_PREBUFFER_CHUNKS * tChunkDuration);
+
+        int tChunkSize = MEDIA_SOURCE_SAMPLES_PER_BUFFER * 2 /* 16 bits per sample */ * mAudioChannels;
+        memset(mFilePlaybackBuffer, 0, tChunkSize);
+
+        mPlayMutex.lock();
+        if (mWaveOutOpened)
+        {
+            MixSounds(mFilePlaybackBuffer, tChunkSize);
+            AdjustVolume(mFilePlaybackBuffer, tChunkSize);
+
+            #ifdef WO_DEBUG_FILE
+                LOG(LOG_VERBOSE, "Sending mixed audio chunk of %d bytes to playback device", tChunkSize);
+            #endif
+            DoWriteChunk(mFilePlaybackBuffer, tChunkSize);
+
+            // log statistics about raw PCM audio data stream
+            AnnouncePacket(tChunkSize);
+        }
+        mPlayMutex.unlock();
+
+        tNextChunkTime += tChunkDuration;
     }
 
     LOG(LOG_WARN, "End of thread for file based audio playback reached, playback needed: %d", mFilePlaybackNeeded);
 
     // reset the state variables
-    mOpenNewFileAsap = false;
-    mFilePlaybackLoops = 0;
+    mSoundsMutex.lock();
+    mPendingSounds.clear();
+    mActiveSounds.clear();
+    mSoundsMutex.unlock();
 
     return NULL;
 }
@@ -436,7 +436,7 @@ void WaveOutPortAudio::AssignThreadName()
 {
     if (mHaveToAssignThreadName)
     {
-        if (mFilePlaybackLoops)
+        if (mFilePlaybackNeeded)
             SVC_PROCESS_STATISTIC.AssignThreadName("WaveOutPortAudio-File");
         else
             SVC_PROCESS_STATISTIC.AssignThreadName("WaveOutPortAudio-Mem");
@@ -564,7 +564,6 @@ void WaveOutPortAudio::Stop()
     }
 
     WaveOut::Stop();
-    mFilePlaybackLoops = 0;
 
     // make sure no one waits for audio anymore -> send an empty buffer to FIFO and force a return from a possible ReadFifo() call
     LOG(LOG_VERBOSE, "..writing an empty packet to FIFO to force wake up");
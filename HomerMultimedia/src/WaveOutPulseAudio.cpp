@@ -286,7 +286,6 @@ void WaveOutPulseAudio::Stop()
     }
 
     WaveOut::Stop();
-    mFilePlaybackLoops = 0;
 
     if (mOutputStream != NULL)
     {
@@ -0,0 +1,217 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: reliable datagram transport with selective acknowledgements
+ * Since:   2014-01-19
+ */
+
+#ifndef _NAPI_RELIABLE_DATAGRAM_TRANSPORT_
+#define _NAPI_RELIABLE_DATAGRAM_TRANSPORT_
+
+#include <HBSocket.h>
+#include <HBThread.h>
+#include <HBMutex.h>
+#include <HBCondition.h>
+
+#include <stdint.h>
+#include <string>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace Homer { namespace Base {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the following de/activates debugging of transmitted packets
+//#define RDT_DEBUG_PACKETS
+
+// packet types
+#define RDT_PACKET_DATA                             1
+#define RDT_PACKET_ACK                              2
+
+// packet flags
+#define RDT_FLAG_ORDERED                            0x01
+
+// maximum payload per datagram, fits into the usual path MTU including IPv6 and UDP headers
+#define RDT_MAX_PAYLOAD_SIZE                        1200
+// how many packets are covered by the selective acknowledgement bitmap
+#define RDT_SACK_RANGE                              32
+// how many later packets have to be acknowledged before a missing one is retransmitted
+#define RDT_FAST_RETRANSMIT_THRESHOLD               3
+
+// congestion window limits in packets
+#define RDT_INITIAL_WINDOW                          2
+#define RDT_INITIAL_SLOW_START_THRESHOLD            64
+#define RDT_MAX_WINDOW                              256
+
+// retransmission timer in ms
+#define RDT_INITIAL_RTO                             500
+#define RDT_MIN_RTO                                 100
+#define RDT_MAX_RTO                                 8000
+
+// how long unacknowledged data is kept alive when the transport is stopped in ms
+#define RDT_LINGER_TIME                             2000
+
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma pack(push, 1)
+struct ReliableDatagramHeader
+{
+    uint8_t     Type; /* RDT_PACKET_* */
+    uint8_t     Flags; /* RDT_FLAG_* */
+    uint16_t    Domain; /* ordering domain of the message */
+    uint32_t    Sequence; /* data: packet sequence number, ack: next expected packet sequence number */
+    uint32_t    Message; /* data: message number within the ordering domain, ack: bitmap of received packets after the next expected one */
+    uint16_t    Fragment; /* data: index of this fragment */
+    uint16_t    Fragments; /* data: amount of fragments of the message */
+};
+#pragma pack(pop)
+
+#define RDT_HEADER_SIZE                             ((int)sizeof(ReliableDatagramHeader))
+
+// sequence numbers wrap around, hence they are compared by serial number arithmetic (RFC 1982)
+inline bool IsRdtSequenceBefore(uint32_t pSequence, uint32_t pReference)
+{
+    return ((int32_t)(pSequence - pReference) < 0);
+}
+
+struct ReliableDatagramSequenceOrder
+{
+    bool operator()(uint32_t pSequence1, uint32_t pSequence2) const
+    {
+        return IsRdtSequenceBefore(pSequence1, pSequence2);
+    }
+};
+
+// all stored sequence numbers lie within a few windows, so the serial order is a strict weak ordering among them
+typedef std::set<uint32_t, ReliableDatagramSequenceOrder> ReliableDatagramSequences;
+
+struct ReliableDatagramPacket
+{
+    std::string     Data; /* header and payload */
+    int64_t         SendTime; /* in us */
+    int             Transmissions;
+    int             LaterAcknowledged; /* how many later packets were acknowledged up to now */
+};
+
+typedef std::map<uint32_t, ReliableDatagramPacket, ReliableDatagramSequenceOrder> ReliableDatagramWindow;
+
+struct ReliableDatagramMessage
+{
+    std::vector<std::string> Fragments;
+    int             ReceivedFragments;
+    bool            Ordered;
+    bool            Complete;
+    bool            Delivered; /* unordered messages are delivered before their predecessors */
+};
+
+// messages are identified by ordering domain and message number
+typedef std::map<uint64_t, ReliableDatagramMessage> ReliableDatagramMessages;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Transports messages over an unreliable datagram socket towards a single peer.
+ * Messages are split into fragments which are acknowledged selectively and
+ * retransmitted if they got lost. The amount of packets in flight is limited by
+ * an AIMD congestion window. Ordered messages are delivered in sequence within
+ * their ordering domain, so a lost message blocks only its own domain.
+ */
+class ReliableDatagramTransport:
+    public Thread
+{
+public:
+    ReliableDatagramTransport(Socket *pSocket, std::string pPeerHost = "", unsigned int pPeerPort = 0);
+
+    virtual ~ReliableDatagramTransport();
+
+    /* each of both calls may be used by one thread at a time */
+    /* blocks until the message is within the send window */
+    bool Send(char *pBuffer, int pBufferSize, int pDomain = 0, bool pOrdered = true);
+    /* blocks until a complete message is available, a message which exceeds the buffer is continued by the next calls */
+    bool Receive(char *pBuffer, int &pBufferSize);
+    int AvailableBytes();
+    void Stop();
+
+    std::string GetPeerHost();
+    unsigned int GetPeerPort();
+
+    /* statistic */
+    int GetRoundTripTime(); // in ms
+    int GetCongestionWindow(); // in packets
+    int64_t GetRetransmittedPackets();
+
+private:
+    /* retransmission timer */
+    virtual void* Run(void* pArgs = NULL);
+
+    /* receiver */
+    friend class ReliableDatagramReceiver;
+    void ReceiveLoop();
+    void HandleData(ReliableDatagramHeader *pHeader, char *pPayload, int pPayloadSize);
+    void HandleAck(ReliableDatagramHeader *pHeader);
+    void DeliverMessage(ReliableDatagramMessage &pMessage);
+    void DeliverMessages(uint16_t pDomain);
+    void SendAck();
+
+    /* sender */
+    bool SendPacket(ReliableDatagramPacket &pPacket);
+    void AcknowledgePacket(uint32_t pSequence, int64_t pNow);
+    void ReduceCongestionWindow(uint32_t pLostSequence);
+    void CalculateRto();
+
+    Socket                      *mSocket;
+    std::string                 mPeerHost;
+    unsigned int                mPeerPort;
+    bool                        mTransportNeeded;
+    Thread                      *mReceiver;
+    Mutex                       mMutex;
+    Condition                   mTimerCondition;
+    /* sender */
+    Condition                   mSendWindowCondition;
+    ReliableDatagramWindow      mSendWindow;
+    uint32_t                    mSendNextSequence;
+    std::map<uint16_t, uint32_t> mSendNextMessage; // per ordering domain
+    float                       mCongestionWindow; // in packets
+    float                       mSlowStartThreshold; // in packets
+    uint32_t                    mRecoverySequence; // window is reduced only once per loss event
+    int                         mSmoothedRtt; // in us
+    int                         mRttVariation; // in us
+    int                         mRto; // in ms
+    int64_t                     mRetransmissionTimer; // start time in us
+    int64_t                     mRetransmittedPackets;
+    /* receiver */
+    Condition                   mReceiveCondition;
+    uint32_t                    mReceiveNextSequence;
+    ReliableDatagramSequences   mReceivedOutOfOrder;
+    ReliableDatagramMessages    mReceivedMessages;
+    std::map<uint16_t, uint32_t> mReceiveNextMessage; // per ordering domain
+    std::list<std::string>      mReceiveQueue;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
@@ -30,6 +30,7 @@
 #include <HBSocket.h>
 
 #include <Requirements.h>
+#include <Berkeley/ReliableDatagramTransport.h>
 
 namespace Homer { namespace Base {
 
@@ -56,10 +57,17 @@ public:
     virtual Requirements* getRequirements();
     virtual Events getEvents();
 
+    /* selects the socket tuning profile which fits the requirements */
+    static std::string getTuningProfile(Requirements *pRequirements, bool pIncoming);
+    /* do the requirements ask for lossless or ordered chunks on top of UDP? */
+    static bool needsReliableDatagrams(Requirements *pRequirements);
+
 private:
+    bool		    mIncoming;
     bool		    mBlockingMode;
     Requirements    *mRequirements;
     Socket		    *mSocket;
+    ReliableDatagramTransport *mReliableTransport;
     bool            mIsClosed;
     std::string     mPeerHost;
     unsigned int    mPeerPort;
@@ -47,6 +47,9 @@ namespace Homer { namespace Base {
 #define REQUIREMENT_LIMIT_DELAY                         0x0201
 #define REQUIREMENT_LIMIT_DATARATE                      0x0202
 
+// debugging attributes
+#define REQUIREMENT_SIMULATE_IMPAIRMENT                 0x0301
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class IRequirement
@@ -62,6 +65,7 @@ public:
     }
 
     virtual std::string getDescription() = 0;
+    virtual IRequirement* clone() = 0;
     virtual int getType()const
     {
         return mType;
@@ -89,6 +93,11 @@ public:
     {
         return pType;
     }
+
+    virtual IRequirement* clone()
+    {
+        return new DerivedClass(*(DerivedClass*)this);
+    }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
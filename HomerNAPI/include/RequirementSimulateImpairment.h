@@ -0,0 +1,56 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2013 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: RequirementSimulateImpairment to apply a deterministic network impairment to the transport
+ * Since:   2014-01-11
+ */
+
+#ifndef _NAPI_REQUIREMENT_SIMULATE_IMPAIRMENT_
+#define _NAPI_REQUIREMENT_SIMULATE_IMPAIRMENT_
+
+#include <IRequirement.h>
+#include <HBSocketImpairment.h>
+#include <Logger.h>
+
+namespace Homer { namespace Base {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class RequirementSimulateImpairment:
+    public TRequirement<RequirementSimulateImpairment, REQUIREMENT_SIMULATE_IMPAIRMENT>
+{
+public:
+    RequirementSimulateImpairment(const ImpairmentSettings &pSettings):mSettings(pSettings){ }
+
+    virtual std::string getDescription(){ return "Requ(SimulateImpairment[" + SocketImpairment::GetDescription(mSettings) + "])"; }
+
+    ImpairmentSettings getSettings(){ return mSettings; }
+
+private:
+    ImpairmentSettings mSettings;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespaces
+
+#endif
@@ -37,7 +37,15 @@ class RequirementTransmitOrdered:
     public TRequirement<RequirementTransmitOrdered, REQUIREMENT_TRANSMIT_ORDERED>
 {
 public:
-    virtual std::string getDescription(){ return "Requ(TransmitOrdered)"; }
+    RequirementTransmitOrdered(int pDomain = 0):mDomain(pDomain){ }
+
+    virtual std::string getDescription(){ return "Requ(TransmitOrdered[" + toString(mDomain) + "])"; }
+
+    /* messages are ordered only relative to messages of the same domain */
+    int getDomain(){ return mDomain; }
+
+private:
+    int mDomain;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -36,6 +36,7 @@
 #include <RequirementTransmitOrdered.h>
 #include <RequirementLimitDelay.h>
 #include <RequirementLimitDataRate.h>
+#include <RequirementSimulateImpairment.h>
 
 #include <IRequirement.h>
 #include <HBMutex.h>
@@ -54,9 +55,12 @@ class Requirements
 {
 public:
     Requirements();
+    Requirements(const Requirements &pRequirements);
 
     virtual ~Requirements();
 
+    Requirements& operator=(const Requirements &pRequirements);
+
     virtual std::string getDescription();
 
     /* manipulation */
@@ -68,6 +72,7 @@ public:
 
 private:
     void delAll();
+    void addCopies(const Requirements &pRequirements);
 
     RequirementSet      mRequirementSet;
     Mutex               mRequirementSetMutex;
@@ -0,0 +1,618 @@
+/*****************************************************************************
+ *
+ * Copyright (C) 2014 Thomas Volkert <thomas@homer-conferencing.com>
+ *
+ * This software is free software.
+ * Your are allowed to redistribute it and/or modify it under the terms of
+ * the GNU General Public License version 2 as published by the Free Software
+ * Foundation.
+ *
+ * This source is published in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License version 2
+ * along with this program. Otherwise, you can write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ * Alternatively, you find an online version of the license text under
+ * http://www.gnu.org/licenses/gpl-2.0.html.
+ *
+ *****************************************************************************/
+
+/*
+ * Purpose: reliable datagram transport with selective acknowledgements
+ * Since:   2014-01-19
+ */
+
+#include <Berkeley/ReliableDatagramTransport.h>
+
+#include <HBTime.h>
+#include <Logger.h>
+
+#include <string.h>
+#include <string>
+
+namespace Homer { namespace Base {
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+class ReliableDatagramReceiver:
+    public Thread
+{
+public:
+    ReliableDatagramReceiver(ReliableDatagramTransport *pTransport):mTransport(pTransport){ }
+
+    virtual ~ReliableDatagramReceiver(){ }
+
+    virtual void* Run(void* /* pArgs */ = NULL)
+    {
+        mTransport->ReceiveLoop();
+        return NULL;
+    }
+
+private:
+    ReliableDatagramTransport   *mTransport;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+ReliableDatagramTransport::ReliableDatagramTransport(Socket *pSocket, string pPeerHost, unsigned int pPeerPort)
+{
+    mSocket = pSocket;
+    mPeerHost = pPeerHost;
+    mPeerPort = pPeerPort;
+    mSendNextSequence = 0;
+    mCongestionWindow = RDT_INITIAL_WINDOW;
+    mSlowStartThreshold = RDT_INITIAL_SLOW_START_THRESHOLD;
+    mRecoverySequence = 0;
+    mSmoothedRtt = 0;
+    mRttVariation = 0;
+    mRto = RDT_INITIAL_RTO;
+    mRetransmissionTimer = 0;
+    mRetransmittedPackets = 0;
+    mReceiveNextSequence = 0;
+    mTransportNeeded = true;
+
+    LOG(LOG_VERBOSE, "Starting reliable datagram transport towards %s<%u>", mPeerHost.c_str(), mPeerPort);
+    mReceiver = new ReliableDatagramReceiver(this);
+    mReceiver->StartThread();
+    StartThread();
+}
+
+ReliableDatagramTransport::~ReliableDatagramTransport()
+{
+    Stop();
+
+    delete mReceiver;
+
+    LOG(LOG_VERBOSE, "Destroyed");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ReliableDatagramTransport::Stop()
+{
+    mMutex.lock();
+
+    if (mTransportNeeded)
+    {
+        // give the peer the chance to acknowledge the last messages
+        int64_t tStartTime = Time::GetTimeStamp();
+        while ((mTransportNeeded) && (!mSendWindow.empty()) && (Time::GetTimeStamp() - tStartTime < RDT_LINGER_TIME * 1000))
+        {
+            mMutex.unlock();
+            Thread::Suspend(10 * 1000);
+            mMutex.lock();
+        }
+        if (!mSendWindow.empty())
+            LOG(LOG_WARN, "Stopping reliable datagram transport with %d unacknowledged packets", (int)mSendWindow.size());
+    }
+
+    mTransportNeeded = false;
+    mSendWindowCondition.Signal();
+    mReceiveCondition.Signal();
+    mTimerCondition.Signal();
+
+    mMutex.unlock();
+
+    mSocket->StopReceiving();
+    StopThread();
+    mReceiver->StopThread();
+}
+
+string ReliableDatagramTransport::GetPeerHost()
+{
+    return mPeerHost;
+}
+
+unsigned int ReliableDatagramTransport::GetPeerPort()
+{
+    return mPeerPort;
+}
+
+int ReliableDatagramTransport::GetRoundTripTime()
+{
+    return mSmoothedRtt / 1000;
+}
+
+int ReliableDatagramTransport::GetCongestionWindow()
+{
+    return (int)mCongestionWindow;
+}
+
+int64_t ReliableDatagramTransport::GetRetransmittedPackets()
+{
+    return mRetransmittedPackets;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// SENDER
+///////////////////////////////////////////////////////////////////////////////
+
+bool ReliableDatagramTransport::Send(char *pBuffer, int pBufferSize, int pDomain, bool pOrdered)
+{
+    int tFragments = (pBufferSize + RDT_MAX_PAYLOAD_SIZE - 1) / RDT_MAX_PAYLOAD_SIZE;
+    if (tFragments < 1)
+        tFragments = 1;
+    if (tFragments > 0xFFFF)
+    {
+        LOG(LOG_ERROR, "Message of %d bytes is too big for reliable datagram transport", pBufferSize);
+        return false;
+    }
+
+    mMutex.lock();
+
+    if ((mPeerHost == "") || (mPeerPort == 0))
+    {
+        mMutex.unlock();
+        LOG(LOG_ERROR, "Peer of reliable datagram transport is still unknown");
+        return false;
+    }
+
+    uint16_t tDomain = (uint16_t)pDomain;
+    uint32_t tMessage = mSendNextMessage[tDomain]++;
+    for (int i = 0; i < tFragments; i++)
+    {
+        // wait for space within the congestion window
+        while ((mTransportNeeded) && ((int)mSendWindow.size() >= (int)mCongestionWindow))
+            mSendWindowCondition.Wait(&mMutex);
+        if (!mTransportNeeded)
+        {
+            mMutex.unlock();
+            return false;
+        }
+
+        int tOffset = i * RDT_MAX_PAYLOAD_SIZE;
+        int tPayloadSize = pBufferSize - tOffset;
+        if (tPayloadSize > RDT_MAX_PAYLOAD_SIZE)
+            tPayloadSize = RDT_MAX_PAYLOAD_SIZE;
+
+        ReliableDatagramHeader tHeader;
+        tHeader.Type = RDT_PACKET_DATA;
+        tHeader.Flags = (pOrdered ? RDT_FLAG_ORDERED : 0);
+        tHeader.Domain = htons(tDomain);
+        tHeader.Sequence = htonl(mSendNextSequence);
+        tHeader.Message = htonl(tMessage);
+        tHeader.Fragment = htons((uint16_t)i);
+        tHeader.Fragments = htons((uint16_t)tFragments);
+
+        // the retransmission timer runs as long as unacknowledged data exists
+        if (mSendWindow.empty())
+            mRetransmissionTimer = Time::GetTimeStamp();
+
+        ReliableDatagramPacket &tPacket = mSendWindow[mSendNextSequence];
+        tPacket.Data.assign((char*)&tHeader, RDT_HEADER_SIZE);
+        if (tPayloadSize > 0)
+            tPacket.Data.append(pBuffer + tOffset, tPayloadSize);
+        tPacket.Transmissions = 0;
+        tPacket.LaterAcknowledged = 0;
+        mSendNextSequence++;
+
+        if (!SendPacket(tPacket))
+        {
+            mMutex.unlock();
+            return false;
+        }
+    }
+
+    mMutex.unlock();
+
+    return true;
+}
+
+bool ReliableDatagramTransport::SendPacket(ReliableDatagramPacket &pPacket)
+{
+    #ifdef RDT_DEBUG_PACKETS
+        ReliableDatagramHeader *tHeader = (ReliableDatagramHeader*)pPacket.Data.data();
+        LOG(LOG_VERBOSE, "Sending packet %u (transmission %d), window: %.2f, RTO: %d ms", ntohl(tHeader->Sequence), pPacket.Transmissions + 1, mCongestionWindow, mRto);
+    #endif
+
+    pPacket.SendTime = Time::GetTimeStamp();
+    pPacket.Transmissions++;
+
+    return mSocket->Send(mPeerHost, mPeerPort, (void*)pPacket.Data.data(), (ssize_t)pPacket.Data.size());
+}
+
+void ReliableDatagramTransport::HandleAck(ReliableDatagramHeader *pHeader)
+{
+    uint32_t tNextSequence = ntohl(pHeader->Sequence);
+    uint32_t tBitmap = ntohl(pHeader->Message);
+    int64_t tNow = Time::GetTimeStamp();
+    size_t tUnacknowledged = mSendWindow.size();
+
+    // cumulative acknowledgement
+    while ((!mSendWindow.empty()) && (IsRdtSequenceBefore(mSendWindow.begin()->first, tNextSequence)))
+        AcknowledgePacket(mSendWindow.begin()->first, tNow);
+
+    // selective acknowledgement
+    for (int i = 0; i < RDT_SACK_RANGE; i++)
+    {
+        if (tBitmap & ((uint32_t)1 << i))
+            AcknowledgePacket(tNextSequence + 1 + i, tNow);
+    }
+
+    // restart the retransmission timer whenever new data was acknowledged, the back-off of a previous timeout isn't needed anymore
+    if (mSendWindow.size() < tUnacknowledged)
+    {
+        mRetransmissionTimer = tNow;
+        CalculateRto();
+    }
+
+    // retransmit packets which were overtaken by enough later ones
+    if (tBitmap != 0)
+    {
+        ReliableDatagramWindow::iterator tIt;
+        for (tIt = mSendWindow.begin(); (tIt != mSendWindow.end()) && ((uint32_t)(tIt->first - tNextSequence) <= RDT_SACK_RANGE); tIt++)
+        {
+            // count the acknowledged packets behind this one
+            int tLaterAcknowledged = 0;
+            for (int i = (int)(tIt->first - tNextSequence); i < RDT_SACK_RANGE; i++)
+            {
+                if (tBitmap & ((uint32_t)1 << i))
+                    tLaterAcknowledged++;
+            }
+            tIt->second.LaterAcknowledged = tLaterAcknowledged;
+
+            // one retransmission per round trip
+            if ((tLaterAcknowledged >= RDT_FAST_RETRANSMIT_THRESHOLD) && (tNow - tIt->second.SendTime > mSmoothedRtt))
+            {
+                ReduceCongestionWindow(tIt->first);
+                mRetransmittedPackets++;
+                SendPacket(tIt->second);
+            }
+        }
+    }
+
+    mSendWindowCondition.Signal();
+}
+
+void ReliableDatagramTransport::AcknowledgePacket(uint32_t pSequence, int64_t pNow)
+{
+    ReliableDatagramWindow::iterator tIt = mSendWindow.find(pSequence);
+    if (tIt == mSendWindow.end())
+        return;
+
+    // use only unambiguous samples for the RTT estimation (Karn)
+    if (tIt->second.Transmissions == 1)
+    {
+        int tSample = (int)(pNow - tIt->second.SendTime);
+        if (mSmoothedRtt == 0)
+        {
+            mSmoothedRtt = tSample;
+            mRttVariation = tSample / 2;
+        }else
+        {
+            int tDeviation = mSmoothedRtt - tSample;
+            if (tDeviation < 0)
+                tDeviation = -tDeviation;
+            mRttVariation = (3 * mRttVariation + tDeviation) / 4;
+            mSmoothedRtt = (7 * mSmoothedRtt + tSample) / 8;
+        }
+    }
+
+    // slow start, afterwards additive increase
+    if (mCongestionWindow < mSlowStartThreshold)
+        mCongestionWindow += 1;
+    else
+        mCongestionWindow += 1 / mCongestionWindow;
+    if (mCongestionWindow > RDT_MAX_WINDOW)
+        mCongestionWindow = RDT_MAX_WINDOW;
+
+    mSendWindow.erase(tIt);
+}
+
+void ReliableDatagramTransport::CalculateRto()
+{
+    // without any RTT sample the initial value is kept
+    if (mSmoothedRtt == 0)
+        return;
+
+    mRto = (mSmoothedRtt + 4 * mRttVariation) / 1000;
+    if (mRto < RDT_MIN_RTO)
+        mRto = RDT_MIN_RTO;
+    if (mRto > RDT_MAX_RTO)
+        mRto = RDT_MAX_RTO;
+}
+
+void ReliableDatagramTransport::ReduceCongestionWindow(uint32_t pLostSequence)
+{
+    // react only once per window of data
+    if (IsRdtSequenceBefore(pLostSequence, mRecoverySequence))
+        return;
+
+    mSlowStartThreshold = mCongestionWindow / 2;
+    if (mSlowStartThreshold < 2)
+        mSlowStartThreshold = 2;
+    mCongestionWindow = mSlowStartThreshold;
+    mRecoverySequence = mSendNextSequence;
+
+    #ifdef RDT_DEBUG_PACKETS
+        LOG(LOG_VERBOSE, "Packet %u lost, reducing congestion window to %.2f", pLostSequence, mCongestionWindow);
+    #endif
+}
+
+void* ReliableDatagramTransport::Run(void* /* pArgs */)
+{
+    mMutex.lock();
+
+    while (mTransportNeeded)
+    {
+        int64_t tNow = Time::GetTimeStamp();
+        int64_t tExpiry = mRetransmissionTimer + mRto * 1000;
+
+        if ((!mSendWindow.empty()) && (tExpiry <= tNow))
+        {
+            // the network is assumed to be congested: restart with slow start and back off the timer
+            mSlowStartThreshold = mCongestionWindow / 2;
+            if (mSlowStartThreshold < 2)
+                mSlowStartThreshold = 2;
+            mCongestionWindow = 1;
+            mRecoverySequence = mSendNextSequence;
+            LOG(LOG_VERBOSE, "Retransmission timeout for packet %u, new RTO: %d ms", mSendWindow.begin()->first, (mRto * 2 > RDT_MAX_RTO) ? RDT_MAX_RTO : mRto * 2);
+
+            // repeat every packet which has been waiting for its acknowledgement for a whole RTO
+            ReliableDatagramWindow::iterator tIt;
+            for (tIt = mSendWindow.begin(); tIt != mSendWindow.end(); tIt++)
+            {
+                if ((tIt == mSendWindow.begin()) || (tNow - tIt->second.SendTime >= mRto * 1000))
+                {
+                    mRetransmittedPackets++;
+                    SendPacket(tIt->second);
+                }
+            }
+            mRto *= 2;
+            if (mRto > RDT_MAX_RTO)
+                mRto = RDT_MAX_RTO;
+            mRetransmissionTimer = tNow;
+            tExpiry = tNow + mRto * 1000;
+        }
+        if (mSendWindow.empty())
+            tExpiry = tNow + mRto * 1000;
+
+        int tWaitTime = (int)((tExpiry - tNow) / 1000);
+        mTimerCondition.Wait(&mMutex, (tWaitTime > 0) ? tWaitTime : 1);
+    }
+
+    mMutex.unlock();
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// RECEIVER
+///////////////////////////////////////////////////////////////////////////////
+
+bool ReliableDatagramTransport::Receive(char *pBuffer, int &pBufferSize)
+{
+    mMutex.lock();
+
+    while ((mTransportNeeded) && (mReceiveQueue.empty()))
+        mReceiveCondition.Wait(&mMutex);
+
+    if (mReceiveQueue.empty())
+    {
+        mMutex.unlock();
+        pBufferSize = 0;
+        return false;
+    }
+
+    string &tMessage = mReceiveQueue.front();
+    if ((int)tMessage.size() > pBufferSize)
+    {// the remainder of the message is delivered by the next call
+        #ifdef RDT_DEBUG_PACKETS
+            LOG(LOG_VERBOSE, "Receive buffer of %d bytes is too small for message of %d bytes, keeping the remainder", pBufferSize, (int)tMessage.size());
+        #endif
+        memcpy(pBuffer, tMessage.data(), pBufferSize);
+        tMessage.erase(0, pBufferSize);
+    }else
+    {
+        pBufferSize = (int)tMessage.size();
+        memcpy(pBuffer, tMessage.data(), pBufferSize);
+        mReceiveQueue.pop_front();
+    }
+
+    mMutex.unlock();
+
+    return true;
+}
+
+int ReliableDatagramTransport::AvailableBytes()
+{
+    int tResult = 0;
+
+    mMutex.lock();
+    if (!mReceiveQueue.empty())
+        tResult = (int)mReceiveQueue.front().size();
+    mMutex.unlock();
+
+    return tResult;
+}
+
+void ReliableDatagramTransport::ReceiveLoop()
+{
+    char tBuffer[RDT_HEADER_SIZE + RDT_MAX_PAYLOAD_SIZE];
+
+    while (mTransportNeeded)
+    {
+        string tSourceHost;
+        unsigned int tSourcePort = 0;
+        ssize_t tBufferSize = sizeof(tBuffer);
+        if (!mSocket->Receive(tSourceHost, tSourcePort, (void*)tBuffer, tBufferSize))
+        {
+            mMutex.lock();
+            if (mTransportNeeded)
+            {
+                LOG(LOG_ERROR, "Receiving failed, reliable datagram transport is closed");
+                mTransportNeeded = false;
+                mSendWindowCondition.Signal();
+                mReceiveCondition.Signal();
+                mTimerCondition.Signal();
+            }
+            mMutex.unlock();
+            break;
+        }
+        if (tBufferSize < RDT_HEADER_SIZE)
+        {
+            LOG(LOG_WARN, "Dropping packet of %d bytes from %s<%u>, it is too short", (int)tBufferSize, tSourceHost.c_str(), tSourcePort);
+            continue;
+        }
+
+        mMutex.lock();
+
+        // incoming associations learn the peer from the first packet
+        if ((mPeerHost == "") || (mPeerPort == 0))
+        {
+            LOG(LOG_VERBOSE, "Reliable datagram transport has peer %s<%u>", tSourceHost.c_str(), tSourcePort);
+            mPeerHost = tSourceHost;
+            mPeerPort = tSourcePort;
+        }
+
+        ReliableDatagramHeader *tHeader = (ReliableDatagramHeader*)tBuffer;
+        switch(tHeader->Type)
+        {
+            case RDT_PACKET_DATA:
+                HandleData(tHeader, tBuffer + RDT_HEADER_SIZE, (int)tBufferSize - RDT_HEADER_SIZE);
+                SendAck();
+                break;
+            case RDT_PACKET_ACK:
+                HandleAck(tHeader);
+                break;
+            default:
+                LOG(LOG_WARN, "Dropping packet of unknown type %d", tHeader->Type);
+                break;
+        }
+
+        mMutex.unlock();
+    }
+}
+
+void ReliableDatagramTransport::HandleData(ReliableDatagramHeader *pHeader, char *pPayload, int pPayloadSize)
+{
+    uint32_t tSequence = ntohl(pHeader->Sequence);
+
+    // duplicate? the acknowledgement is repeated anyway
+    if ((IsRdtSequenceBefore(tSequence, mReceiveNextSequence)) || (mReceivedOutOfOrder.find(tSequence) != mReceivedOutOfOrder.end()))
+        return;
+
+    // beyond every possible send window?
+    if ((uint32_t)(tSequence - mReceiveNextSequence) >= RDT_MAX_WINDOW * 2)
+    {
+        LOG(LOG_WARN, "Dropping packet %u, expected was %u", tSequence, mReceiveNextSequence);
+        return;
+    }
+
+    #ifdef RDT_DEBUG_PACKETS
+        LOG(LOG_VERBOSE, "Received packet %u, expected was %u", tSequence, mReceiveNextSequence);
+    #endif
+
+    if (tSequence == mReceiveNextSequence)
+    {
+        mReceiveNextSequence++;
+        while (mReceivedOutOfOrder.erase(mReceiveNextSequence) > 0)
+            mReceiveNextSequence++;
+    }else
+        mReceivedOutOfOrder.insert(tSequence);
+
+    uint16_t tDomain = ntohs(pHeader->Domain);
+    uint16_t tFragment = ntohs(pHeader->Fragment);
+    uint16_t tFragments = ntohs(pHeader->Fragments);
+    if ((tFragments == 0) || (tFragment >= tFragments))
+    {
+        LOG(LOG_WARN, "Dropping packet %u with invalid fragment %d of %d", tSequence, tFragment, tFragments);
+        return;
+    }
+
+    uint64_t tKey = ((uint64_t)tDomain << 32) | ntohl(pHeader->Message);
+    ReliableDatagramMessage &tMessage = mReceivedMessages[tKey];
+    if (tMessage.Fragments.empty())
+    {
+        tMessage.Fragments.resize(tFragments);
+        tMessage.Ordered = ((pHeader->Flags & RDT_FLAG_ORDERED) != 0);
+    }
+    if (tFragment < tMessage.Fragments.size())
+    {
+        tMessage.Fragments[tFragment].assign(pPayload, pPayloadSize);
+        tMessage.ReceivedFragments++;
+    }
+
+    if (tMessage.ReceivedFragments == (int)tMessage.Fragments.size())
+    {
+        tMessage.Complete = true;
+
+        // unordered messages don't have to wait for their predecessors
+        if (!tMessage.Ordered)
+            DeliverMessage(tMessage);
+
+        DeliverMessages(tDomain);
+    }
+}
+
+void ReliableDatagramTransport::DeliverMessage(ReliableDatagramMessage &pMessage)
+{
+    string tData;
+    vector<string>::iterator tIt;
+    for (tIt = pMessage.Fragments.begin(); tIt != pMessage.Fragments.end(); tIt++)
+        tData += *tIt;
+
+    mReceiveQueue.push_back(tData);
+    mReceiveCondition.Signal();
+
+    pMessage.Fragments.clear();
+    pMessage.Delivered = true;
+}
+
+void ReliableDatagramTransport::DeliverMessages(uint16_t pDomain)
+{
+    uint32_t &tNextMessage = mReceiveNextMessage[pDomain];
+
+    ReliableDatagramMessages::iterator tIt;
+    while (((tIt = mReceivedMessages.find(((uint64_t)pDomain << 32) | tNextMessage)) != mReceivedMessages.end()) && (tIt->second.Complete))
+    {
+        if (!tIt->second.Delivered)
+            DeliverMessage(tIt->second);
+        mReceivedMessages.erase(tIt);
+        tNextMessage++;
+    }
+}
+
+void ReliableDatagramTransport::SendAck()
+{
+    ReliableDatagramHeader tHeader;
+    memset(&tHeader, 0, RDT_HEADER_SIZE);
+    tHeader.Type = RDT_PACKET_ACK;
+    tHeader.Sequence = htonl(mReceiveNextSequence);
+
+    uint32_t tBitmap = 0;
+    ReliableDatagramSequences::iterator tIt;
+    for (tIt = mReceivedOutOfOrder.begin(); (tIt != mReceivedOutOfOrder.end()) && ((uint32_t)(*tIt - mReceiveNextSequence) <= RDT_SACK_RANGE); tIt++)
+        tBitmap |= (uint32_t)1 << (uint32_t)(*tIt - mReceiveNextSequence - 1);
+    tHeader.Message = htonl(tBitmap);
+
+    mSocket->Send(mPeerHost, mPeerPort, (void*)&tHeader, RDT_HEADER_SIZE);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} //namespace
@@ -215,6 +215,8 @@ bool SocketBinding::changeRequirements(Requirements *pRequirements)
 
     if (mConnection != NULL)
         tResult = mConnection->changeRequirements(pRequirements);
+    else if (mSocket != NULL)
+        mSocket->SetTuning(SocketConnection::getTuningProfile(pRequirements, true));
 
     if (tResult)
         mRequirements = pRequirements;
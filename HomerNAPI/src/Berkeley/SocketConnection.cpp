@@ -28,12 +28,14 @@
 #include <Berkeley/SocketName.h>
 #include <Berkeley/SocketConnection.h>
 #include <RequirementTransmitLossless.h>
+#include <RequirementTransmitOrdered.h>
 #include <RequirementTransmitChunks.h>
 #include <RequirementTransmitStream.h>
 #include <RequirementTransmitBitErrors.h>
 #include <RequirementTargetPort.h>
 #include <RequirementLimitDelay.h>
 #include <RequirementLimitDataRate.h>
+#include <RequirementSimulateImpairment.h>
 
 #include <HBSocket.h>
 #include <HBSocketQoSSettings.h>
@@ -47,12 +49,14 @@ namespace Homer { namespace Base {
 using namespace std;
 
 ///////////////////////////////////////////////////////////////////////////////
-//HINT: lossless transmission is not implemented by using TCP but by rely on a reaction by the network
+//HINT: lossless transmission of chunks is not implemented by using TCP but by the reliable datagram transport on top of UDP
 SocketConnection::SocketConnection(std::string pTarget, Requirements *pRequirements)
 {
     bool tFoundTransport = false;
     mSocket = NULL;
+    mReliableTransport = NULL;
 
+    mIncoming = false;
     mBlockingMode = true;
     mPeerHost = pTarget;
     RequirementTargetPort *tRequPort = (RequirementTargetPort*)pRequirements->get(RequirementTargetPort::type());
@@ -130,6 +134,8 @@ SocketConnection::SocketConnection(Socket *pSocket)
 {
     mIsClosed = false;
     mSocket = pSocket;
+    mReliableTransport = NULL;
+    mIncoming = true;
     mBlockingMode = true;
     mPeerHost = "";
     mPeerPort = 0;
@@ -149,6 +155,13 @@ SocketConnection::~SocketConnection()
 		cancel();
 	}
 
+	if (mReliableTransport != NULL)
+	{
+		LOG(LOG_VERBOSE, "..destroying the reliable datagram transport");
+		delete mReliableTransport;
+		mReliableTransport = NULL;
+	}
+
 	LOG(LOG_VERBOSE, "..destroying the Berkeley socket");
     delete mSocket;
     mSocket = NULL;
@@ -165,12 +178,25 @@ bool SocketConnection::isClosed()
 
 int SocketConnection::availableBytes()
 {
+	if (mReliableTransport != NULL)
+		return mReliableTransport->AvailableBytes();
+
 	return 0; //TODO
 }
 
 void SocketConnection::read(char* pBuffer, int &pBufferSize)
 {
-    if (mSocket != NULL)
+    if (mReliableTransport != NULL)
+    {
+        bool tRes = mReliableTransport->Receive(pBuffer, pBufferSize);
+        if ((!tRes) && (!mIsClosed))
+        {
+            LOG(LOG_ERROR, "NAPI connection marked as closed");
+            mIsClosed = true;
+        }
+        mPeerHost = mReliableTransport->GetPeerHost();
+        mPeerPort = mReliableTransport->GetPeerPort();
+    }else if (mSocket != NULL)
     {
         string tSourceHost;
         unsigned int tSourcePort;
@@ -191,7 +217,13 @@ void SocketConnection::read(char* pBuffer, int &pBufferSize)
 
 void SocketConnection::write(char* pBuffer, int pBufferSize)
 {
-    if (mSocket != NULL)
+    if (mReliableTransport != NULL)
+    {
+        RequirementTransmitOrdered *tReqOrdered = (RequirementTransmitOrdered*)mRequirements->get(RequirementTransmitOrdered::type());
+        mIsClosed = !mReliableTransport->Send(pBuffer, pBufferSize, (tReqOrdered != NULL) ? tReqOrdered->getDomain() : 0, (tReqOrdered != NULL));
+        if (mIsClosed)
+            LOG(LOG_ERROR, "NAPI connection marked as closed");
+    }else if (mSocket != NULL)
     {
         if ((mPeerHost != "") && (mPeerPort != 0))
         mIsClosed = !mSocket->Send(mPeerHost, mPeerPort, (void*)pBuffer, (ssize_t) pBufferSize);
@@ -218,7 +250,10 @@ void SocketConnection::cancel()
     {
         LOG(LOG_VERBOSE, "Connection for local %s will be canceled now", getName()->toString().c_str());
         mIsClosed = true;
-        mSocket->StopReceiving();
+        if (mReliableTransport != NULL)
+            mReliableTransport->Stop();
+        else
+            mSocket->StopReceiving();
     }
     LOG(LOG_VERBOSE, "Canceled");
 }
@@ -287,6 +322,30 @@ bool SocketConnection::changeRequirements(Requirements *pRequirements)
         tResult = mSocket->SetQoS(tQoSSettings);
     }
 
+    /* socket tuning */
+    mSocket->SetTuning(getTuningProfile(pRequirements, mIncoming));
+
+    /* reliable datagram transport */
+    if (needsReliableDatagrams(pRequirements))
+    {
+        if ((mReliableTransport == NULL) && (mSocket->GetTransportType() == SOCKET_UDP))
+        {
+            LOG(LOG_VERBOSE, "Using reliable datagram transport for requirements %s", pRequirements->getDescription().c_str());
+            mReliableTransport = new ReliableDatagramTransport(mSocket, mPeerHost, mPeerPort);
+        }
+    }else
+    {
+        if (mReliableTransport != NULL)
+            LOG(LOG_WARN, "Reliable datagram transport can't be deactivated for an existing connection");
+    }
+
+    /* debugging requirements */
+    if (pRequirements->contains(RequirementSimulateImpairment::type()))
+    {
+        RequirementSimulateImpairment* tReqImpairment = (RequirementSimulateImpairment*)pRequirements->get(RequirementSimulateImpairment::type());
+        mSocket->SetImpairment(tReqImpairment->getSettings());
+    }
+
     mRequirements = pRequirements; //TODO: maybe some requirements were dropped?
 
     return tResult;
@@ -306,6 +365,27 @@ Events SocketConnection::getEvents()
 	return tResult;
 }
 
+string SocketConnection::getTuningProfile(Requirements *pRequirements, bool pIncoming)
+{
+    // lossless transmissions are assumed to be file transfers
+    if (pRequirements->contains(RequirementTransmitLossless::type()))
+        return SOCKET_TUNING_PROFILE_BULK;
+
+    // everything else is treated as real-time media
+    return pIncoming ? SOCKET_TUNING_PROFILE_MEDIA_RX : SOCKET_TUNING_PROFILE_MEDIA_TX;
+}
+
+bool SocketConnection::needsReliableDatagrams(Requirements *pRequirements)
+{
+    // UDP-Lite and TCP are used as they are
+    if ((!pRequirements->contains(RequirementTransmitChunks::type())) ||
+        (pRequirements->contains(RequirementTransmitStream::type())) ||
+        (pRequirements->contains(RequirementTransmitBitErrors::type())))
+        return false;
+
+    return ((pRequirements->contains(RequirementTransmitLossless::type())) || (pRequirements->contains(RequirementTransmitOrdered::type())));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }} //namespace
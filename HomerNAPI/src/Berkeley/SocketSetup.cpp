@@ -29,6 +29,7 @@
 #include <Berkeley/SocketBinding.h>
 #include <Berkeley/SocketConnection.h>
 
+#include <HBSocket.h>
 #include <Logger.h>
 
 #include <string>
@@ -64,7 +65,15 @@ Requirements SocketSetup::getCapabilities(Name *pName, Requirements *pImportantR
 {
 	Requirements tResult;
 
-	//TODO:
+	// TCP
+	tResult.add(new RequirementTransmitStream());
+	// UDP, lossless and ordered chunks are provided by the reliable datagram transport
+	tResult.add(new RequirementTransmitChunks());
+	tResult.add(new RequirementTransmitLossless());
+	tResult.add(new RequirementTransmitOrdered());
+	// UDP-Lite
+	if (Socket::IsTransportSupported(SOCKET_UDP_LITE))
+	    tResult.add(new RequirementTransmitBitErrors(UDP_LITE_HEADER_SIZE));
 
 	return tResult;
 }
@@ -42,11 +42,27 @@ Requirements::Requirements()
 {
 }
 
+Requirements::Requirements(const Requirements &pRequirements)
+{
+    addCopies(pRequirements);
+}
+
 Requirements::~Requirements()
 {
 	delAll();
 }
 
+Requirements& Requirements::operator=(const Requirements &pRequirements)
+{
+    if (this != &pRequirements)
+    {
+        delAll();
+        addCopies(pRequirements);
+    }
+
+    return *this;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 string Requirements::getDescription()
@@ -155,13 +171,25 @@ void Requirements::delAll()
     tIt = mRequirementSet.begin();
     while (tIt != mRequirementSet.end())
     {
+        IRequirement *tRequirement = (*tIt);
         mRequirementSet.erase(tIt);
-    	delete (*tIt);
+    	delete tRequirement;
         tIt = mRequirementSet.begin();
     }
 
     mRequirementSetMutex.unlock();
 }
+
+void Requirements::addCopies(const Requirements &pRequirements)
+{
+    RequirementSet::const_iterator tIt;
+
+    // every requirement object is owned by exactly one set
+    for(tIt = pRequirements.mRequirementSet.begin(); tIt != pRequirements.mRequirementSet.end(); tIt++)
+    {
+        add((*tIt)->clone());
+    }
+}
 ///////////////////////////////////////////////////////////////////////////////
 
 }} //namespace